@@ -793,6 +793,7 @@ _DSceneViewerFrame::_DSceneViewerFrame(wxWindow* parent, wxWindowID id)
 
 _DSceneViewerFrame::~_DSceneViewerFrame()
 {
+	stopChunkedLoader();
 	theWindow = nullptr;
 
 	//(*Destroy(_DSceneViewerFrame)
@@ -807,6 +808,9 @@ void _DSceneViewerFrame::OnAbout(wxCommandEvent&)
 
 void _DSceneViewerFrame::OnNewScene(wxCommandEvent& event)
 {
+	// Objects of a chunked file must not be inserted in the new scene:
+	stopChunkedLoader();
+
 	auto openGLSceneRef = m_canvas->getOpenGLSceneRef();
 	openGLSceneRef->clear();
 
@@ -860,6 +864,13 @@ void _DSceneViewerFrame::OnOpenFile(wxCommandEvent& event)
 	}
 }
 
+// CCamera objects in chunked files are loaded with the skeleton of the scene,
+// since loadFromFile() needs them to set the view:
+static bool isTopLevelCamera(const CChunkedSceneFile::ObjectEntry& e)
+{
+	return e.parent < 0 && e.className == CCamera::className;
+}
+
 void _DSceneViewerFrame::loadFromFile(
 	const std::string& fil, bool isInASequence)
 {
@@ -869,7 +880,8 @@ void _DSceneViewerFrame::loadFromFile(
 		// Save the path
 		saveLastUsedDirectoryToCfgFile(fil);
 
-		CFileGZInputStream f(fil);
+		stopChunkedLoader();
+		const bool chunked = CChunkedSceneFile::IsChunkedSceneFile(fil);
 
 		const auto oldCanvasCamera = m_canvas->cameraParams();
 
@@ -881,14 +893,34 @@ void _DSceneViewerFrame::loadFromFile(
 			tictac.Tic();
 
 			openGLSceneRef->clear();
-			mrpt::serialization::archiveFrom(f) >> *openGLSceneRef;
+			if (chunked)
+			{
+				// Only show the viewports and cameras by now. Objects are
+				// inserted later on by startChunkedLoader().
+				m_chunkedFile = std::make_shared<CChunkedSceneFile>(fil);
+				m_chunkedFile->loadSkeleton(*openGLSceneRef);
+				const auto& objs = m_chunkedFile->objects();
+				for (size_t i = 0; i < objs.size(); i++)
+					if (isTopLevelCamera(objs[i]))
+						m_chunkedFile->insertObject(
+							*openGLSceneRef, i, m_chunkedFile->loadObject(i));
+			}
+			else
+			{
+				CFileGZInputStream f(fil);
+				mrpt::serialization::archiveFrom(f) >> *openGLSceneRef;
+			}
 		}
 
 		double timeToLoad = tictac.Tac();
 
+		const bool isEmpty = chunked
+			? m_chunkedFile->objects().empty()
+			: (openGLSceneRef->getViewport("main") &&
+			   openGLSceneRef->getViewport("main")->size() == 0);
+
 		if (openGLSceneRef->viewportsCount() == 0 ||
-			!openGLSceneRef->getViewport("main") ||
-			openGLSceneRef->getViewport("main")->size() == 0)
+			!openGLSceneRef->getViewport("main") || isEmpty)
 		{
 			wxMessageBox(
 				_("File is empty or format unrecognized."), _("Warning"), wxOK,
@@ -947,6 +979,8 @@ void _DSceneViewerFrame::loadFromFile(
 		theWindow->StatusBar1->SetStatusText(
 			(format("File loaded in %.03fs", timeToLoad).c_str()), 0);
 
+		if (chunked) startChunkedLoader(timeToLoad);
+
 		Refresh(false);
 		Update();
 	}
@@ -958,6 +992,70 @@ void _DSceneViewerFrame::loadFromFile(
 	WX_END_TRY
 }
 
+void _DSceneViewerFrame::startChunkedLoader(double timeToLoadSkeleton)
+{
+	m_chunkedLoaderCancel = false;
+	m_chunkedLoader = std::thread([this, file = m_chunkedFile,
+								   timeToLoadSkeleton]() {
+		const auto t0 = mrpt::Clock::now();
+		const auto& objs = file->objects();
+		const size_t BATCH_SIZE = 1024;
+
+		for (size_t first = 0; first < objs.size() && !m_chunkedLoaderCancel;
+			 first += BATCH_SIZE)
+		{
+			const size_t last = std::min(first + BATCH_SIZE, objs.size());
+			std::vector<CRenderizable::Ptr> batch;
+			try
+			{
+				batch = file->loadObjects(first, last);
+			}
+			catch (const std::exception& e)
+			{
+				const std::string msg = mrpt::exception_to_str(e);
+				CallAfter([msg]() { wxLogError(wxString(msg)); });
+				return;
+			}
+			const double elapsed = timeToLoadSkeleton +
+				mrpt::system::timeDifference(t0, mrpt::Clock::now());
+
+			// Insert into the scene from the GUI thread:
+			CallAfter([this, file, first, last, batch, elapsed]() {
+				// Another file was loaded meanwhile?
+				if (file != m_chunkedFile) return;
+				const auto& objs = file->objects();
+				{
+					std::lock_guard<std::mutex> lock(critSec_UpdateScene);
+					auto& scene = m_canvas->getOpenGLSceneRef();
+					for (size_t i = first; i < last; i++)
+					{
+						// Cameras were already loaded in loadFromFile()
+						if (isTopLevelCamera(objs[i])) continue;
+						file->insertObject(*scene, i, batch[i - first]);
+					}
+				}
+				StatusBar1->SetStatusText(
+					last < objs.size()
+						? format(
+							  "Loading objects: %u/%u",
+							  static_cast<unsigned>(last),
+							  static_cast<unsigned>(objs.size()))
+							  .c_str()
+						: format("File loaded in %.03fs", elapsed).c_str(),
+					0);
+				m_canvas->Refresh(false);
+			});
+		}
+	});
+}
+
+void _DSceneViewerFrame::stopChunkedLoader()
+{
+	m_chunkedLoaderCancel = true;
+	if (m_chunkedLoader.joinable()) m_chunkedLoader.join();
+	m_chunkedFile.reset();
+}
+
 void _DSceneViewerFrame::updateTitle()
 {
 	SetTitle((format(
@@ -1389,6 +1487,7 @@ void _DSceneViewerFrame::OnMenuAddSICK(wxCommandEvent& event)
 
 void _DSceneViewerFrame::OnMenuDeleteAll(wxCommandEvent& event)
 {
+	stopChunkedLoader();
 	m_canvas->getOpenGLSceneRef()->clear();
 	m_canvas->Refresh();
 }
@@ -12,6 +12,7 @@
 
 #include <mrpt/gui/CWxGLCanvasBase.h>
 #include <mrpt/gui/WxUtils.h>
+#include <mrpt/opengl/CChunkedSceneFile.h>
 #include <mrpt/system/datetime.h>
 #include <wx/artprov.h>
 #include <wx/bitmap.h>
@@ -27,7 +28,10 @@
 #include <wx/timer.h>
 #include <wx/toolbar.h>
 
+#include <atomic>
+#include <memory>
 #include <optional>
+#include <thread>
 
 class CDlgCamTracking;
 class CMyGLCanvas : public mrpt::gui::CWxGLCanvasBase
@@ -225,6 +229,14 @@ class _DSceneViewerFrame : public wxFrame
 
 	CDlgCamTracking* m_dlg_tracking;
 
+	/** Objects of chunked scene files are loaded in this thread, and
+	 * inserted into the scene as they come, after its skeleton is shown */
+	std::shared_ptr<mrpt::opengl::CChunkedSceneFile> m_chunkedFile;
+	std::thread m_chunkedLoader;
+	std::atomic_bool m_chunkedLoaderCancel{false};
+	void startChunkedLoader(double timeToLoadSkeleton);
+	void stopChunkedLoader();
+
 	DECLARE_EVENT_TABLE()
 };
 
@@ -47,6 +47,14 @@ void register_tests_atan2lut();
 void register_tests_strings();
 void register_tests_octomaps();
 void register_tests_yaml();
+void register_tests_comms();
+void register_tests_config();
+void register_tests_expr();
+void register_tests_rtti();
+void register_tests_containers();
+void register_tests_opengl();
+void register_tests_system();
+void register_tests_core();
 // -------------------------------------------------
 
 using TestFunctor =
@@ -11,9 +11,17 @@
 #include <mrpt/obs/CObservation3DRangeScan.h>
 #include <mrpt/random.h>
 #include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/CGenericMemoryPool.h>
+#include <mrpt/system/CSizeClassMemoryPool.h>
+#include <mrpt/system/CTicTac.h>
 #include <mrpt/system/CTimeLogger.h>
 #include <mrpt/system/filesystem.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "common.h"
 
 using namespace mrpt;
@@ -123,11 +131,180 @@ double obs3d_test_depth_to_2d_scan(int useMinFilter, int useMaxFilter)
 	return t;
 }
 
+// Allocate and free 640x480 observations, as a RGBD driver would do:
+double obs3d_test_alloc_free(int nPasses, int)
+{
+	const int W = 640, H = 480;
+	CTimeLogger timlog;
+	for (int i = 0; i < nPasses; i++)
+	{
+		timlog.enter("run");
+		{
+			CObservation3DRangeScan obs;
+			obs.rangeImage_setSize(H, W);
+			obs.resizePoints3DVectors(W * H);
+			obs.rangeImage(H / 2, W / 2) = 1;
+		}
+		timlog.leave("run");
+	}
+	const double t = timlog.getMeanTime("run");
+	timlog.clear(true);
+	return t;
+}
+
+// Observations created in one thread and destroyed in another one:
+double obs3d_test_alloc_free_2threads(int nPasses, int)
+{
+	const int W = 640, H = 480;
+	std::deque<CObservation3DRangeScan::Ptr> queue;
+	std::mutex queueMtx;
+	std::condition_variable queueCv;
+
+	std::thread consumer([&]() {
+		for (int i = 0; i < nPasses; i++)
+		{
+			std::unique_lock<std::mutex> lck(queueMtx);
+			queueCv.wait(lck, [&]() { return !queue.empty(); });
+			auto obs = std::move(queue.front());
+			queue.pop_front();
+			lck.unlock();
+			obs.reset();  // Free in this thread
+		}
+	});
+
+	CTicTac tictac;
+	for (int i = 0; i < nPasses; i++)
+	{
+		auto obs = CObservation3DRangeScan::Create();
+		obs->rangeImage_setSize(H, W);
+		obs->resizePoints3DVectors(W * H);
+		std::unique_lock<std::mutex> lck(queueMtx);
+		queue.push_back(std::move(obs));
+		queueCv.notify_one();
+	}
+	consumer.join();
+	return tictac.Tac() / nPasses;
+}
+
+// Pool blocks of 640x480 floats, with the memory touched as a sensor would:
+struct PerfMemPoolParams
+{
+	size_t len = 0;
+	size_t size() const { return len * sizeof(float); }
+	bool isSuitable(const PerfMemPoolParams& req) const
+	{
+		return len == req.len;
+	}
+};
+struct PerfMemPoolData
+{
+	std::vector<float> data;
+};
+
+template <class POOL>
+PerfMemPoolData* perf_mempool_alloc(POOL* pool, const PerfMemPoolParams& p)
+{
+	PerfMemPoolData* b = pool ? pool->request_memory(p) : nullptr;
+	if (!b)
+	{
+		b = new PerfMemPoolData;
+		b->data.resize(p.len);
+	}
+	// Write one float per memory page:
+	for (size_t k = 0; k < p.len; k += 1024)
+		b->data[k] = 1.0f;
+	return b;
+}
+
+// usePool: 0=none, 1=CGenericMemoryPool, 2=CSizeClassMemoryPool
+template <int usePool>
+double mempool_test_producer_consumer(int nThreadPairs, int nPasses)
+{
+	using generic_pool_t =
+		mrpt::system::CGenericMemoryPool<PerfMemPoolParams, PerfMemPoolData>;
+	using sizeclass_pool_t =
+		mrpt::system::CSizeClassMemoryPool<PerfMemPoolParams, PerfMemPoolData>;
+
+	PerfMemPoolParams p;
+	p.len = 640 * 480;
+
+	auto task = [&]() {
+		std::deque<PerfMemPoolData*> queue;
+		std::mutex queueMtx;
+		std::condition_variable queueCv;
+
+		std::thread consumer([&]() {
+			for (int i = 0; i < nPasses; i++)
+			{
+				std::unique_lock<std::mutex> lck(queueMtx);
+				queueCv.wait(lck, [&]() { return !queue.empty(); });
+				PerfMemPoolData* b = queue.front();
+				queue.pop_front();
+				lck.unlock();
+				if constexpr (usePool == 1)
+					generic_pool_t::getInstance()->dump_to_pool(p, b);
+				else if constexpr (usePool == 2)
+					sizeclass_pool_t::getInstance()->dump_to_pool(p, b);
+				else
+					delete b;
+			}
+		});
+		for (int i = 0; i < nPasses; i++)
+		{
+			PerfMemPoolData* b;
+			if constexpr (usePool == 1)
+				b = perf_mempool_alloc(generic_pool_t::getInstance(), p);
+			else if constexpr (usePool == 2)
+				b = perf_mempool_alloc(sizeclass_pool_t::getInstance(), p);
+			else
+				b = perf_mempool_alloc<generic_pool_t>(nullptr, p);
+
+			std::unique_lock<std::mutex> lck(queueMtx);
+			queue.push_back(b);
+			queueCv.notify_one();
+		}
+		consumer.join();
+	};
+
+	CTicTac tictac;
+	std::vector<std::thread> producers;
+	for (int i = 0; i < nThreadPairs; i++)
+		producers.emplace_back(task);
+	for (auto& t : producers)
+		t.join();
+	return tictac.Tac() / (nPasses * nThreadPairs);
+}
+
 // ------------------------------------------------------
 // register_tests_CObservation3DRangeScan
 // ------------------------------------------------------
 void register_tests_CObservation3DRangeScan()
 {
+	lstTests.emplace_back(
+		"3DRangeScan: 640x480 alloc/free", obs3d_test_alloc_free, 200);
+	lstTests.emplace_back(
+		"3DRangeScan: 640x480 alloc/free in 2 threads",
+		obs3d_test_alloc_free_2threads, 200);
+
+	lstTests.emplace_back(
+		"MemPool: 1.2MB blocks, 1 producer/consumer (no pool)",
+		mempool_test_producer_consumer<0>, 1, 200);
+	lstTests.emplace_back(
+		"MemPool: 1.2MB blocks, 1 producer/consumer (CGenericMemoryPool)",
+		mempool_test_producer_consumer<1>, 1, 200);
+	lstTests.emplace_back(
+		"MemPool: 1.2MB blocks, 1 producer/consumer (CSizeClassMemoryPool)",
+		mempool_test_producer_consumer<2>, 1, 200);
+	lstTests.emplace_back(
+		"MemPool: 1.2MB blocks, 4 producers/consumers (no pool)",
+		mempool_test_producer_consumer<0>, 4, 100);
+	lstTests.emplace_back(
+		"MemPool: 1.2MB blocks, 4 producers/consumers (CGenericMemoryPool)",
+		mempool_test_producer_consumer<1>, 4, 100);
+	lstTests.emplace_back(
+		"MemPool: 1.2MB blocks, 4 producers/consumers (CSizeClassMemoryPool)",
+		mempool_test_producer_consumer<2>, 4, 100);
+
 	if (mrpt::system::fileExists(rgbd_test_rawlog_file))
 	{
 		lstTests.emplace_back(
@@ -0,0 +1,170 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/comms/CAsyncTCPServer.h>
+#include <mrpt/comms/CAsyncTCPSocket.h>
+#include <mrpt/comms/CClientTCPSocket.h>
+#include <mrpt/comms/CServerTCPSocket.h>
+#include <mrpt/config.h>
+#include <mrpt/serialization/CMessage.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "common.h"
+
+using namespace mrpt::comms;
+using mrpt::serialization::CMessage;
+
+#if defined(MRPT_OS_LINUX)
+
+namespace
+{
+// Port for the blocking socket tests:
+const unsigned short TEST_PORT = 15001;
+
+CMessage testMessage(size_t len)
+{
+	CMessage m;
+	m.type = 0x10;
+	m.content.assign(len, 0x55);
+	return m;
+}
+
+// Accepts one connection, keeping it alive until destruction
+struct AsyncTestServer
+{
+	std::mutex mtx;
+	std::condition_variable cv;
+	CAsyncTCPSocket::Ptr conn;
+	CAsyncTCPServer::Ptr server;
+
+	explicit AsyncTestServer(CAsyncTCPSocket::on_message_callback_t onMsg)
+	{
+		server = CAsyncTCPServer::Create(0, [this, onMsg](const auto& s) {
+			s->setOnMessageCallback(onMsg);
+			std::lock_guard<std::mutex> lck(mtx);
+			conn = s;
+			cv.notify_all();
+		});
+	}
+	void waitConnection()
+	{
+		std::unique_lock<std::mutex> lck(mtx);
+		cv.wait(lck, [this]() { return conn != nullptr; });
+	}
+};
+}  // namespace
+
+// ------------------------------------------------------
+//  Throughput: time per message, from sending the first one
+//  until all have been received and parsed on the other side.
+// ------------------------------------------------------
+double comms_async_throughput(int msgLen, int N)
+{
+	int received = 0;
+	std::mutex mtx;
+	std::condition_variable cv;
+
+	AsyncTestServer srv([&](CAsyncTCPSocket&, uint32_t, auto&&) {
+		// Under the lock, so the notification cannot be missed between the
+		// check of the waiting thread and its going to sleep:
+		std::lock_guard<std::mutex> lck(mtx);
+		if (++received == N) cv.notify_all();
+	});
+	auto client =
+		CAsyncTCPSocket::Connect("127.0.0.1", srv.server->getListenPort());
+	srv.waitConnection();
+
+	CTicTac tictac;
+	for (int i = 0; i < N; i++)
+		client->sendMessage(testMessage(msgLen));
+
+	std::unique_lock<std::mutex> lck(mtx);
+	cv.wait(lck, [&]() { return received == N; });
+	return tictac.Tac() / N;
+}
+
+double comms_blocking_throughput(int msgLen, int N)
+{
+	CServerTCPSocket server(TEST_PORT, "127.0.0.1", 10, mrpt::system::LVL_ERROR);
+
+	std::thread rxThread([&]() {
+		auto conn = server.accept(2000);
+		if (!conn) return;
+		CMessage rx;
+		for (int i = 0; i < N; i++)
+			if (!conn->receiveMessage(rx, 2000, 2000)) break;
+	});
+
+	CClientTCPSocket client;
+	client.connect("127.0.0.1", TEST_PORT, 2000);
+
+	CTicTac tictac;
+	for (int i = 0; i < N; i++)
+		client.sendMessage(testMessage(msgLen));
+	// Close this side first, so the server port does not stay in TIME_WAIT:
+	client.close();
+	rxThread.join();
+	return tictac.Tac() / N;
+}
+
+// ------------------------------------------------------
+//  Latency: round-trip time of one message echoed back.
+// ------------------------------------------------------
+double comms_async_roundtrip(int msgLen, int N)
+{
+	AsyncTestServer srv(
+		[](CAsyncTCPSocket& s, uint32_t type, std::vector<uint8_t>&& data) {
+			s.sendSharedMessage(
+				type, std::make_shared<const std::vector<uint8_t>>(
+						  std::move(data)),
+				0);
+		});
+	auto client =
+		CAsyncTCPSocket::Connect("127.0.0.1", srv.server->getListenPort());
+	srv.waitConnection();
+
+	CMessage rx;
+	CTicTac tictac;
+	for (int i = 0; i < N; i++)
+	{
+		client->sendMessage(testMessage(msgLen));
+		if (!client->receiveMessage(rx, 2000))
+			THROW_EXCEPTION("Timeout waiting for echo");
+	}
+	return tictac.Tac() / N;
+}
+
+// ------------------------------------------------------
+// register_tests_comms
+// ------------------------------------------------------
+void register_tests_comms()
+{
+	lstTests.emplace_back(
+		"comms: CClientTCPSocket loopback msg 100B", comms_blocking_throughput,
+		100, 100000);
+	lstTests.emplace_back(
+		"comms: CAsyncTCPSocket loopback msg 100B", comms_async_throughput,
+		100, 100000);
+	lstTests.emplace_back(
+		"comms: CClientTCPSocket loopback msg 64kB",
+		comms_blocking_throughput, 64 * 1024, 5000);
+	lstTests.emplace_back(
+		"comms: CAsyncTCPSocket loopback msg 64kB", comms_async_throughput,
+		64 * 1024, 5000);
+	lstTests.emplace_back(
+		"comms: CAsyncTCPSocket loopback round-trip 100B",
+		comms_async_roundtrip, 100, 10000);
+}
+
+#else
+void register_tests_comms() {}
+#endif
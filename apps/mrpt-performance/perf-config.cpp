@@ -0,0 +1,102 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "common.h"
+//
+#include <mrpt/config/CConfigFileMemory.h>
+#include <mrpt/slam/CICP.h>
+
+#include <sstream>
+
+// A config file with `nSections` sections of `nKeys` keys each:
+static std::string makeConfigText(int nSections, int nKeys)
+{
+	std::stringstream ss;
+	for (int s = 0; s < nSections; s++)
+	{
+		ss << "[section" << s << "]\n";
+		for (int k = 0; k < nKeys; k++)
+			ss << "key" << k << " = " << 0.5 * k << "  // comment\n";
+	}
+	return ss.str();
+}
+
+double config_read_double(int useCache, int nKeys)
+{
+	const int nSections = 10;
+	mrpt::config::CConfigFileMemory cfg(makeConfigText(nSections, nKeys));
+	cfg.setValuesCacheEnabled(useCache != 0);
+
+	std::vector<std::string> keyNames;
+	for (int k = 0; k < nKeys; k++)
+		keyNames.push_back(mrpt::format("key%i", k));
+
+	double sum = 0;
+	CTicTac tictac;
+	const int N = 20;
+	for (int i = 0; i < N; i++)
+		for (int s = 0; s < nSections; s++)
+		{
+			const auto sect = mrpt::format("section%i", s);
+			for (const auto& k : keyNames)
+				sum += cfg.read_double(sect, k, .0);
+		}
+	const double t = tictac.Tac() / (N * nSections * nKeys);
+	ASSERT_GT_(sum, .0);
+	return t;
+}
+
+double config_load_icp_params(int useCache, int)
+{
+	mrpt::config::CConfigFileMemory cfg(
+		"[ICP]\n"
+		"maxIterations = 50\n"
+		"minAbsStep_trans = 1e-6\n"
+		"minAbsStep_rot = 1e-6\n"
+		"thresholdDist = 0.3\n"
+		"thresholdAng_DEG = 5\n"
+		"ALFA = 0.8\n"
+		"smallestThresholdDist = 0.05\n"
+		"onlyUniqueRobust = false\n"
+		"ICP_algorithm = icpClassic\n"
+		"ICP_covariance_method = icpCovFiniteDifferences\n");
+	cfg.setValuesCacheEnabled(useCache != 0);
+
+	mrpt::slam::CICP::TConfigParams params;
+	CTicTac tictac;
+	const int N = 1000;
+	for (int i = 0; i < N; i++)
+		params.loadFromConfigFile(cfg, "ICP");
+	return tictac.Tac() / N;
+}
+
+// ------------------------------------------------------
+// register_tests_config
+// ------------------------------------------------------
+void register_tests_config()
+{
+	lstTests.emplace_back(
+		"config: read_double() 10x100 keys, no cache", config_read_double, 0,
+		100);
+	lstTests.emplace_back(
+		"config: read_double() 10x100 keys, cached", config_read_double, 1,
+		100);
+	lstTests.emplace_back(
+		"config: read_double() 10x1000 keys, no cache", config_read_double, 0,
+		1000);
+	lstTests.emplace_back(
+		"config: read_double() 10x1000 keys, cached", config_read_double, 1,
+		1000);
+	lstTests.emplace_back(
+		"config: CICP::TConfigParams::loadFromConfigFile(), no cache",
+		config_load_icp_params, 0);
+	lstTests.emplace_back(
+		"config: CICP::TConfigParams::loadFromConfigFile(), cached",
+		config_load_icp_params, 1);
+}
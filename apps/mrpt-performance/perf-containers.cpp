@@ -0,0 +1,119 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "common.h"
+//
+#include <mrpt/containers/concurrent_hash_map.h>
+
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Baseline: one std::unordered_map protected by one mutex.
+class LockedUnorderedMap
+{
+   public:
+	bool find(const std::string& key, double& out) const
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		auto it = m_map.find(key);
+		if (it == m_map.end()) return false;
+		out = it->second;
+		return true;
+	}
+	void insert_or_assign(const std::string& key, double value)
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		m_map[key] = value;
+	}
+
+   private:
+	std::unordered_map<std::string, double> m_map;
+	mutable std::mutex m_mtx;
+};
+
+class ConcurrentMap
+{
+   public:
+	bool find(const std::string& key, double& out) const
+	{
+		return m_map.visit(key, [&](double v) { out = v; });
+	}
+	void insert_or_assign(const std::string& key, double value)
+	{
+		m_map.insert_or_assign(key, value);
+	}
+
+   private:
+	mrpt::containers::concurrent_hash_map<std::string, double> m_map;
+};
+
+// Each thread runs a mix of lookups and insertions/updates on random keys of
+// a set of 10000 keys, half of them initially in the map. Returns the time
+// per operation, including thread creation.
+template <class MAP>
+double containers_map_rw(int nThreads, int writesPercent)
+{
+	const size_t nKeys = 10000, nOpsPerThread = 200000;
+	std::vector<std::string> keys;
+	for (size_t i = 0; i < nKeys; i++)
+		keys.push_back(mrpt::format("mrpt::perf::key%06u", unsigned(i)));
+
+	MAP m;
+	for (size_t i = 0; i < nKeys; i += 2)
+		m.insert_or_assign(keys[i], 1.0 * i);
+
+	CTicTac tictac;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < nThreads; t++)
+	{
+		threads.emplace_back([&, t]() {
+			uint32_t rnd = 12345 + t;
+			double sum = 0;
+			for (size_t i = 0; i < nOpsPerThread; i++)
+			{
+				rnd = rnd * 1664525 + 1013904223;  // fast LCG
+				const auto& key = keys[(rnd >> 8) % nKeys];
+				if (int((rnd >> 4) % 100) < writesPercent)
+					m.insert_or_assign(key, 1.0 * i);
+				else if (double v; m.find(key, v))
+					sum += v;
+			}
+			if (sum < 0) std::cout << "unexpected\n";
+		});
+	}
+	for (auto& th : threads)
+		th.join();
+	return tictac.Tac() / (nThreads * nOpsPerThread);
+}
+
+// ------------------------------------------------------
+// register_tests_containers
+// ------------------------------------------------------
+void register_tests_containers()
+{
+	lstTests.emplace_back(
+		"containers: unordered_map+mutex, 1 thread, 5% writes",
+		containers_map_rw<LockedUnorderedMap>, 1, 5);
+	lstTests.emplace_back(
+		"containers: concurrent_hash_map, 1 thread, 5% writes",
+		containers_map_rw<ConcurrentMap>, 1, 5);
+	lstTests.emplace_back(
+		"containers: unordered_map+mutex, 4 threads, 5% writes",
+		containers_map_rw<LockedUnorderedMap>, 4, 5);
+	lstTests.emplace_back(
+		"containers: concurrent_hash_map, 4 threads, 5% writes",
+		containers_map_rw<ConcurrentMap>, 4, 5);
+	lstTests.emplace_back(
+		"containers: unordered_map+mutex, 4 threads, 50% writes",
+		containers_map_rw<LockedUnorderedMap>, 4, 50);
+	lstTests.emplace_back(
+		"containers: concurrent_hash_map, 4 threads, 50% writes",
+		containers_map_rw<ConcurrentMap>, 4, 50);
+}
@@ -0,0 +1,57 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "common.h"
+//
+#include <mrpt/core/WorkerThreadsPool.h>
+
+#include <cmath>
+#include <future>
+
+// Fine-grained parallelism: one task per item with enqueue() (grain=0),
+// or parallel_for() with a given grain size (0: automatic).
+double workerthreadspool_tasks(int useParallelFor, int grain)
+{
+	const std::size_t nThreads = 4, N = 20000;
+	mrpt::WorkerThreadsPool pool(nThreads);
+	std::vector<double> out(N);
+	auto work = [&](std::size_t i) { out[i] = std::sqrt(double(i)); };
+
+	CTicTac tictac;
+	if (useParallelFor)
+		pool.parallel_for(0, N, work, grain);
+	else
+	{
+		std::vector<std::future<void>> futs;
+		futs.reserve(N);
+		for (std::size_t i = 0; i < N; i++)
+			futs.emplace_back(pool.enqueue(work, i));
+		for (auto& f : futs)
+			f.wait();
+	}
+	const double t = tictac.Tac() / N;
+	ASSERT_EQUAL_(out[N - 1], std::sqrt(double(N - 1)));
+	return t;
+}
+
+// ------------------------------------------------------
+// register_tests_core
+// ------------------------------------------------------
+void register_tests_core()
+{
+	lstTests.emplace_back(
+		"core: WorkerThreadsPool, 4 threads, enqueue() per item",
+		workerthreadspool_tasks, 0, 0);
+	lstTests.emplace_back(
+		"core: WorkerThreadsPool, 4 threads, parallel_for(grain=1) per item",
+		workerthreadspool_tasks, 1, 1);
+	lstTests.emplace_back(
+		"core: WorkerThreadsPool, 4 threads, parallel_for(auto grain)",
+		workerthreadspool_tasks, 1, 0);
+}
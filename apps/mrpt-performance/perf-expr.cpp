@@ -0,0 +1,79 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "common.h"
+//
+#include <mrpt/expr/CRuntimeCompiledExpression.h>
+
+#include <cmath>
+
+// Formulas similar to those used in CPTG_Holo_Blend and in
+// CMultiObjMotionOpt_Scalarization:
+static const char* benchmarkFormulas[] = {
+	"V_MAX * (1 - abs(dir) / M_PI)",
+	"x * y^2 + if(x > 0.95, 10 * (1 - x), 0) + max(0.2 - y, 0)",
+	"sin(x) * exp(-y) + atan2(y, x) * hypot(x, y)",
+};
+
+static double expr_eval(int batched, int formulaIdx)
+{
+	const size_t N = 10000;
+	std::vector<double> xs(N), ys(N), out(N);
+	for (size_t i = 0; i < N; i++)
+	{
+		xs[i] = std::cos(i * 1e-3);
+		ys[i] = 0.1 * (i % 10);
+	}
+
+	std::map<std::string, double> vars = {
+		{"x", 0}, {"y", 0}, {"dir", 0}, {"V_MAX", 1.0}};
+	mrpt::expr::CRuntimeCompiledExpression expr;
+	expr.compile(benchmarkFormulas[formulaIdx], vars);
+	const std::vector<std::pair<std::string, const double*>> inputs = {
+		{"x", xs.data()}, {"y", ys.data()}, {"dir", xs.data()}};
+
+	double &x = vars["x"], &y = vars["y"], &dir = vars["dir"];
+
+	CTicTac tictac;
+	const int REPS = 20;
+	for (int r = 0; r < REPS; r++)
+	{
+		if (batched)
+			expr.eval_batch(inputs, N, out.data());
+		else
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				x = dir = xs[i];
+				y = ys[i];
+				out[i] = expr.eval();
+			}
+		}
+	}
+	return tictac.Tac() / (REPS * N);
+}
+
+// ------------------------------------------------------
+// register_tests_expr
+// ------------------------------------------------------
+void register_tests_expr()
+{
+	lstTests.emplace_back(
+		"expr: eval() loop, PTG speed formula", expr_eval, 0, 0);
+	lstTests.emplace_back(
+		"expr: eval_batch(), PTG speed formula", expr_eval, 1, 0);
+	lstTests.emplace_back(
+		"expr: eval() loop, scalarization formula", expr_eval, 0, 1);
+	lstTests.emplace_back(
+		"expr: eval_batch(), scalarization formula", expr_eval, 1, 1);
+	lstTests.emplace_back(
+		"expr: eval() loop, math functions", expr_eval, 0, 2);
+	lstTests.emplace_back(
+		"expr: eval_batch(), math functions", expr_eval, 1, 2);
+}
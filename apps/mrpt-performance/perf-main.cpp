@@ -142,6 +142,14 @@ int main(int argc, char** argv)
 		register_tests_strings();
 		register_tests_octomaps();
 		register_tests_yaml();
+		register_tests_comms();
+		register_tests_config();
+		register_tests_expr();
+		register_tests_rtti();
+		register_tests_containers();
+		register_tests_opengl();
+		register_tests_system();
+		register_tests_core();
 
 		if (doLog)
 		{
@@ -10,6 +10,7 @@
 #include <mrpt/maps/COctoMap.h>
 #include <mrpt/obs/CObservation2DRangeScan.h>
 #include <mrpt/obs/stock_observations.h>
+#include <mrpt/opengl/COctoMapVoxels.h>
 #include <mrpt/random.h>
 
 #include "common.h"
@@ -60,6 +61,83 @@ double octomap_insert2Dscan(int resolution_cm, int num_reps)
 	return tictac.Tac() / num_reps;
 }
 
+// Time to update the voxels of a map after inserting one more scan, and
+// their triangles. incremental: 0=getAsOctoMapVoxels(),
+// 1=updateOctoMapVoxels()
+double octomap_updateVoxels(int resolution_cm, int incremental)
+{
+	auto& rnd = mrpt::random::getRandomGenerator();
+
+	mrpt::obs::CObservation2DRangeScan scan1;
+	mrpt::obs::stock_observations::example2DRangeScan(scan1);
+
+	const double L = 10.0;	// [meters]
+
+	mrpt::maps::COctoMap map(resolution_cm * 0.01);
+	const auto randomPose = [&]() {
+		return mrpt::poses::CPose3D(
+			rnd.drawUniform(-L, L), rnd.drawUniform(-L, L),
+			rnd.drawUniform(-L * 0.1, L * 0.1), rnd.drawUniform(-M_PI, M_PI), 0,
+			0);
+	};
+	for (int n = 0; n < 200; n++)
+		map.insertObservation(scan1, randomPose());
+
+	mrpt::opengl::COctoMapVoxels gl_obj;
+	map.updateOctoMapVoxels(gl_obj);
+	gl_obj.updateCPUBuffers();
+
+	const int num_reps = 10;
+	double t = 0;
+	for (int n = 0; n < num_reps; n++)
+	{
+		map.insertObservation(scan1, randomPose());
+
+		mrpt::system::CTicTac tictac;
+		if (incremental) map.updateOctoMapVoxels(gl_obj);
+		else
+			map.getAsOctoMapVoxels(gl_obj);
+		gl_obj.updateCPUBuffers();
+		t += tictac.Tac();
+	}
+	std::cout << "(" << gl_obj.getVoxelCount(mrpt::opengl::VOXEL_SET_OCCUPIED)
+			  << " occupied voxels) ";
+	return t / num_reps;
+}
+
+// Time to build the triangles of the occupied voxels of a map
+double octomap_voxelTriangles(int resolution_cm, int greedyMeshing)
+{
+	auto& rnd = mrpt::random::getRandomGenerator();
+
+	mrpt::obs::CObservation2DRangeScan scan1;
+	mrpt::obs::stock_observations::example2DRangeScan(scan1);
+
+	const double L = 10.0;	// [meters]
+
+	mrpt::maps::COctoMap map(resolution_cm * 0.01);
+	map.renderingOptions.generateFreeVoxels = false;
+	for (int n = 0; n < 200; n++)
+		map.insertObservation(
+			scan1,
+			mrpt::poses::CPose3D(
+				rnd.drawUniform(-L, L), rnd.drawUniform(-L, L),
+				rnd.drawUniform(-L * 0.1, L * 0.1),
+				rnd.drawUniform(-M_PI, M_PI), 0, 0));
+
+	mrpt::opengl::COctoMapVoxels gl_obj;
+	gl_obj.enableGreedyMeshing(greedyMeshing != 0);
+	map.getAsOctoMapVoxels(gl_obj);
+
+	mrpt::system::CTicTac tictac;
+	gl_obj.updateCPUBuffers();
+	const double t = tictac.Tac();
+
+	std::cout << "(" << gl_obj.shaderTexturedTrianglesBuffer().size()
+			  << " triangles) ";
+	return t;
+}
+
 // ------------------------------------------------------
 // register_tests_octomaps
 // ------------------------------------------------------
@@ -81,4 +159,17 @@ void register_tests_octomaps()
 		"octomap: insert2Dscan(), voxel=0.10m", octomap_insert2Dscan, 10, 100);
 	lstTests.emplace_back(
 		"octomap: insert2Dscan(), voxel=0.25m", octomap_insert2Dscan, 25, 100);
+
+	lstTests.emplace_back(
+		"octomap: getAsOctoMapVoxels() after a new scan, voxel=0.05m",
+		octomap_updateVoxels, 5, 0);
+	lstTests.emplace_back(
+		"octomap: updateOctoMapVoxels() after a new scan, voxel=0.05m",
+		octomap_updateVoxels, 5, 1);
+	lstTests.emplace_back(
+		"octomap: COctoMapVoxels triangles, voxel=0.05m",
+		octomap_voxelTriangles, 5, 0);
+	lstTests.emplace_back(
+		"octomap: COctoMapVoxels triangles, greedy meshing, voxel=0.05m",
+		octomap_voxelTriangles, 5, 1);
 }
@@ -0,0 +1,482 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "common.h"
+//
+#include <mrpt/math/geometry.h>
+#include <mrpt/opengl/CAxis.h>
+#include <mrpt/opengl/CBox.h>
+#include <mrpt/opengl/CEllipsoid3D.h>
+#include <mrpt/opengl/CMesh.h>
+#include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/opengl/CPointCloud.h>
+#include <mrpt/opengl/CSetOfTriangles.h>
+#include <mrpt/opengl/PointCloudLODOctree.h>
+#include <mrpt/opengl/RenderQueue.h>
+#include <mrpt/opengl/SoftwareRasterizer.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/system/string_utils.h>
+
+#include <map>
+
+using namespace mrpt::opengl;
+
+// A synthetic environment: a bumpy terrain of 2*N*N triangles, 50m x 50m,
+// plus some boxes standing on it. Used instead of a model loaded with
+// CAssimpModel, so the benchmarks do not depend on Assimp nor on model files
+// not shipped with MRPT. Both classes trace rays with the same TriangleBVH.
+static std::vector<TTriangle> terrainTriangles(size_t N)
+{
+	const double side = 50.0, step = side / N;
+	auto z = [](double x, double y) {
+		return 0.5 * std::sin(0.3 * x) * std::cos(0.2 * y);
+	};
+	std::vector<TTriangle> tris;
+	for (size_t i = 0; i < N; i++)
+	{
+		for (size_t j = 0; j < N; j++)
+		{
+			const double x0 = -0.5 * side + i * step,
+						 y0 = -0.5 * side + j * step;
+			const double x1 = x0 + step, y1 = y0 + step;
+			const mrpt::math::TPoint3Df p00(x0, y0, z(x0, y0)),
+				p10(x1, y0, z(x1, y0)), p01(x0, y1, z(x0, y1)),
+				p11(x1, y1, z(x1, y1));
+			tris.emplace_back(p00, p10, p11);
+			tris.emplace_back(p00, p11, p01);
+		}
+	}
+	return tris;
+}
+
+static COpenGLScene buildScene(size_t N)
+{
+	COpenGLScene scene;
+	auto terrain = CSetOfTriangles::Create();
+	terrain->insertTriangles(terrainTriangles(N));
+	scene.insert(terrain);
+
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(1234);
+	for (int i = 0; i < 40; i++)
+	{
+		const double x = rng.drawUniform(-20.0, 20.0),
+					 y = rng.drawUniform(-20.0, 20.0);
+		scene.insert(CBox::Create(
+			mrpt::math::TPoint3D(x, y, 0),
+			mrpt::math::TPoint3D(
+				x + rng.drawUniform(0.5, 3.0), y + rng.drawUniform(0.5, 3.0),
+				rng.drawUniform(0.5, 4.0))));
+	}
+	return scene;
+}
+
+// A 64-beam lidar sweep, 2m above the ground, with beams from 25 deg below
+// to 15 deg above the horizon (positive pitch looks downwards).
+static std::vector<mrpt::poses::CPose3D> lidarRays(size_t nAzimuths)
+{
+	std::vector<mrpt::poses::CPose3D> rays;
+	for (size_t i = 0; i < nAzimuths; i++)
+		for (int j = 0; j < 64; j++)
+			rays.emplace_back(
+				0.0, 0.0, 2.0, 2 * M_PI * i / nAzimuths,
+				mrpt::DEG2RAD(25.0 - 40.0 * j / 63), 0.0);
+	return rays;
+}
+
+// Baseline: linear search over all polygons of the terrain, one ray at a time.
+double opengl_traceray_linear(int N, int nAzimuths)
+{
+	std::vector<mrpt::math::TPolygonWithPlane> polys;
+	for (const auto& t : terrainTriangles(N))
+	{
+		mrpt::math::TPolygon3D p(3);
+		for (int i = 0; i < 3; i++)
+			p[i] = t.vertex(i);
+		polys.emplace_back(p);
+	}
+	const auto rays = lidarRays(nAzimuths);
+
+	CTicTac tictac;
+	size_t nHits = 0;
+	for (const auto& ray : rays)
+	{
+		double d;
+		if (mrpt::math::traceRay(polys, ray.asTPose(), d)) nHits++;
+	}
+	const double t = tictac.Tac();
+	if (!nHits) std::cout << "unexpected\n";
+	return t / rays.size();
+}
+
+// COpenGLScene::traceRay(), one ray at a time.
+double opengl_traceray_scene(int N, int nAzimuths)
+{
+	const auto scene = buildScene(N);
+	const auto rays = lidarRays(nAzimuths);
+	double d;
+	scene.traceRay(rays[0], d);	 // build the BVHs first
+
+	CTicTac tictac;
+	size_t nHits = 0;
+	for (const auto& ray : rays)
+		if (scene.traceRay(ray, d)) nHits++;
+	const double t = tictac.Tac();
+	if (!nHits) std::cout << "unexpected\n";
+	return t / rays.size();
+}
+
+// COpenGLScene::traceRays(), the whole sweep at once.
+double opengl_traceray_batch(int N, int nAzimuths)
+{
+	const auto scene = buildScene(N);
+	const auto rays = lidarRays(nAzimuths);
+	scene.traceRays({rays[0]});	 // build the BVHs first
+
+	CTicTac tictac;
+	const auto dists = scene.traceRays(rays);
+	const double t = tictac.Tac();
+	if (!dists[0]) std::cout << "unexpected\n";
+	return t / rays.size();
+}
+
+// A LOD octree file for a synthetic survey of the terrain above, with N
+// million points.
+static std::string lodOctreeFile(int N)
+{
+	static struct TempFiles
+	{
+		std::map<int, std::string> files;
+		~TempFiles()
+		{
+			for (const auto& f : files)
+				mrpt::system::deleteFile(f.second);
+		}
+	} tmp;
+	auto& files = tmp.files;
+	if (auto it = files.find(N); it != files.end()) return it->second;
+
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(1234);
+	std::vector<PointCloudLODOctree::point_t> pts(N * 1000000);
+	for (auto& p : pts)
+	{
+		const float x = rng.drawUniform(-500.0f, 500.0f),
+					y = rng.drawUniform(-500.0f, 500.0f);
+		p = {x,
+			 y,
+			 5.0f * std::sin(0.03f * x) * std::cos(0.02f * y),
+			 static_cast<uint8_t>(x),
+			 static_cast<uint8_t>(y),
+			 0x80};
+	}
+	const auto fil = mrpt::system::getTempFileName();
+	PointCloudLODOctree::Build(pts, fil);
+	return files[N] = fil;
+}
+
+// A walk over the terrain, 20m above the ground, looking ahead and down.
+static mrpt::opengl::TRenderMatrices lodCamera(int i, int nViews)
+{
+	const double a = 2 * M_PI * i / nViews;
+	mrpt::opengl::TRenderMatrices rm;
+	rm.viewport_width = 1920;
+	rm.viewport_height = 1080;
+	rm.FOV = 60;
+	rm.eye = {300 * std::cos(a), 300 * std::sin(a), 20};
+	rm.pointing = {
+		rm.eye.x - 100 * std::sin(a), rm.eye.y + 100 * std::cos(a), 0};
+	rm.up = {0, 0, 1};
+	rm.computeProjectionMatrix(0.1f, 5000.0f);
+	rm.applyLookAt();
+	rm.mv_matrix.setIdentity();
+	rm.pmv_matrix = rm.p_matrix;
+	return rm;
+}
+
+// PointCloudLODOctree::selectNodes() (per view)
+double opengl_lod_select(int N, int nViews)
+{
+	PointCloudLODOctree lod;
+	lod.open(lodOctreeFile(N));
+
+	std::vector<uint32_t> ids;
+	size_t nPoints = 0;
+	CTicTac tictac;
+	for (int i = 0; i < nViews; i++)
+	{
+		lod.selectNodes(lodCamera(i, nViews), ids);
+		for (const auto id : ids)
+			nPoints += lod.nodes()[id].pointCount;
+	}
+	const double t = tictac.Tac();
+	std::cout << "(" << lod.nodes().size() << " nodes, "
+			  << mrpt::system::unitsFormat(nPoints / nViews)
+			  << " points/view) ";
+	return t / nViews;
+}
+
+// Selection plus loading the nodes from disk, with a memory budget (per
+// view)
+double opengl_lod_stream(int N, int nViews)
+{
+	PointCloudLODOctree lod;
+	lod.setMemoryBudget(size_t(256) << 20);
+	lod.open(lodOctreeFile(N));
+
+	std::vector<uint32_t> ids;
+	size_t maxResident = 0;
+	CTicTac tictac;
+	for (int i = 0; i < nViews; i++)
+	{
+		lod.selectNodes(lodCamera(i, nViews), ids);
+		lod.requestNodes(ids);
+		lod.waitForPendingLoads();
+		maxResident = std::max(maxResident, lod.residentMemory());
+	}
+	const double t = tictac.Tac();
+	std::cout << "(cloud: "
+			  << mrpt::system::unitsFormat(
+					 sizeof(PointCloudLODOctree::point_t) *
+					 lod.totalPointCount())
+			  << "B, max resident: "
+			  << mrpt::system::unitsFormat(maxResident) << "B) ";
+	return t / nViews;
+}
+
+// CPU preparation of the GPU buffers of a growing point cloud, colored by
+// height, after appending each new 1000-point scan (per scan)
+double opengl_pointcloud_append(int nInitialK, int fullUpdate)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(123);
+	auto appendScan = [&](CPointCloud& pc, size_t n) {
+		const float x0 = rng.drawUniform(-50.0f, 50.0f);
+		for (size_t i = 0; i < n; i++)
+			pc.insertPoint(
+				x0 + rng.drawUniform(-10.0f, 10.0f),
+				rng.drawUniform(-10.0f, 10.0f), rng.drawUniform(0.0f, 5.0f));
+	};
+
+	CPointCloud pc;
+	pc.enableColorFromZ();
+	appendScan(pc, nInitialK * 1000);
+	pc.prepareBuffers_Points();
+
+	const int nScans = 200;
+	size_t uploaded = 0;
+	double t = 0;
+	for (int i = 0; i < nScans; i++)
+	{
+		appendScan(pc, 1000);
+		// resize() marks all points as new, as any change did formerly:
+		if (fullUpdate) pc.resize(pc.size());
+
+		CTicTac tictac;
+		const auto [first, last] = pc.prepareBuffers_Points();
+		t += tictac.Tac();
+		uploaded += last - first;
+	}
+	const size_t bytesPerPoint =
+		sizeof(mrpt::math::TPoint3Df) + sizeof(mrpt::img::TColor);
+	std::cout << "("
+			  << mrpt::system::unitsFormat(bytesPerPoint * uploaded / nScans)
+			  << "B to upload/scan) ";
+	return t / nScans;
+}
+
+// A camera walking around the scene, 10m above the ground, looking at its
+// center.
+static mrpt::opengl::TRenderMatrices renderQueueCamera(int i, int nViews)
+{
+	const double a = 2 * M_PI * i / nViews;
+	mrpt::opengl::TRenderMatrices rm;
+	rm.viewport_width = 1920;
+	rm.viewport_height = 1080;
+	rm.FOV = 60;
+	rm.eye = {50 * std::cos(a), 50 * std::sin(a), 10};
+	rm.pointing = {0, 0, 0};
+	rm.up = {0, 0, 1};
+	rm.computeProjectionMatrix(0.1f, 5000.0f);
+	rm.applyLookAt();
+	rm.mv_matrix.setIdentity();
+	rm.pmv_matrix = rm.p_matrix;
+	return rm;
+}
+
+// Building the render queue of a scene with thousands of small objects: the
+// pose uncertainty of landmarks and their reference frames. Buffer updates are
+// deferred, so no OpenGL context is needed (per frame).
+double opengl_render_queue(int nK, int mode)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(123);
+
+	CListOpenGLObjects objs;
+	for (int i = 0; i < nK * 1000; i++)
+	{
+		CRenderizable::Ptr o;
+		if (i % 2)
+		{
+			auto e = CEllipsoid3D::Create();
+			mrpt::math::CMatrixDouble33 cov;
+			cov.setDiagonal(std::vector<double>{
+				rng.drawUniform(0.01, 0.1), rng.drawUniform(0.01, 0.1),
+				rng.drawUniform(0.001, 0.01)});
+			e->setCovMatrix(cov);
+			o = e;
+		}
+		else
+			o = CAxis::Create(0, 0, 0, 0.5, 0.5, 0.5, 0.25, 1, false);
+		o->setLocation(
+			rng.drawUniform(-100.0, 100.0), rng.drawUniform(-100.0, 100.0),
+			rng.drawUniform(0.0, 5.0));
+		objs.push_back(o);
+	}
+
+	RenderInstancingCache cache;
+	const int nViews = 100;
+	size_t nQueued = 0, nCulled = 0, nBuffers = 0;
+	CTicTac tictac;
+	for (int i = 0; i < nViews; i++)
+	{
+		RenderQueue rq;
+		rq.deferBufferUpdates = true;
+		rq.frustumCulling = mode >= 1;
+		rq.instancing = mode >= 1 ? &cache : nullptr;
+		rq.parallel = mode >= 2;
+		cache.beginFrame();
+		enqueForRendering(objs, renderQueueCamera(i, nViews), rq);
+		rq.sorted();
+		nQueued += rq.size();
+		nCulled += rq.culledObjects;
+		// Objects with their own OpenGL buffers, all of them updated in the
+		// first frame:
+		if (i == 0) nBuffers = rq.pendingBufferUpdates.size();
+	}
+	const double t = tictac.Tac();
+	std::cout << "(" << nBuffers << " buffer sets, " << nQueued / nViews
+			  << " queued, " << nCulled / nViews << " culled/view) ";
+	return t / nViews;
+}
+
+// Synthetic RGB+D camera images of the terrain scene (2*N*N triangles) with
+// the CPU rasterizer, at VGA resolution, from a camera orbiting around it
+// (per frame).
+double opengl_software_render(int N, int nThreads)
+{
+	COpenGLScene scene = buildScene(N);
+	auto& cam = scene.getViewport()->getCamera();
+	cam.setPointingAt(0, 0, 0);
+	cam.setZoomDistance(30);
+	cam.setElevationDegrees(20);
+
+	SoftwareRasterizer sr(640, 480, nThreads);
+	mrpt::img::CImage rgb;
+	mrpt::math::CMatrixFloat depth;
+	const int nFrames = 50;
+	CTicTac tictac;
+	for (int i = 0; i < nFrames; i++)
+	{
+		cam.setAzimuthDegrees(360.0f * i / nFrames);
+		sr.render(*scene.getViewport(), rgb, depth);
+	}
+	const double t = tictac.Tac() / nFrames;
+	std::cout << "(" << sr.lastRenderStats().triangles << " triangles, "
+			  << mrpt::format("%.1f", 1.0 / t) << " frames/s) ";
+	return t;
+}
+
+// Triangles and normals of an N x N elevation map, half of it flat ground
+// (per build)
+double opengl_mesh_build(int N, int quadMerging)
+{
+	mrpt::math::CMatrixFloat Z(N, N);
+	for (int r = 0; r < N; r++)
+		for (int c = 0; c < N; c++)
+			Z(r, c) = std::max(0.0, std::sin(0.02 * r) * std::cos(0.03 * c));
+
+	CMesh mesh(false, -50.0f, 50.0f, -50.0f, 50.0f);
+	mesh.enableColorFromZ(true);
+	mesh.enableQuadMerging(quadMerging != 0);
+
+	const int nBuilds = 5;
+	CTicTac tictac;
+	for (int i = 0; i < nBuilds; i++)
+	{
+		mesh.setZ(Z);
+		mesh.updateCPUBuffers();
+	}
+	const double t = tictac.Tac() / nBuilds;
+	std::cout << "(" << mesh.shaderTexturedTrianglesBuffer().size()
+			  << " triangles) ";
+	return t;
+}
+
+// ------------------------------------------------------
+// register_tests_opengl
+// ------------------------------------------------------
+void register_tests_opengl()
+{
+	lstTests.emplace_back(
+		"opengl: linear traceRay, 5k triangles (per ray)",
+		opengl_traceray_linear, 50, 50);
+	lstTests.emplace_back(
+		"opengl: COpenGLScene::traceRay, 5k triangles (per ray)",
+		opengl_traceray_scene, 50, 1024);
+	lstTests.emplace_back(
+		"opengl: COpenGLScene::traceRays, 5k triangles (per ray)",
+		opengl_traceray_batch, 50, 1024);
+	lstTests.emplace_back(
+		"opengl: COpenGLScene::traceRay, 500k triangles (per ray)",
+		opengl_traceray_scene, 500, 1024);
+	lstTests.emplace_back(
+		"opengl: COpenGLScene::traceRays, 500k triangles (per ray)",
+		opengl_traceray_batch, 500, 1024);
+	lstTests.emplace_back(
+		"opengl: PointCloudLODOctree::selectNodes, 20M points (per view)",
+		opengl_lod_select, 20, 100);
+	lstTests.emplace_back(
+		"opengl: PointCloudLODOctree select+load, 20M points (per view)",
+		opengl_lod_stream, 20, 100);
+	lstTests.emplace_back(
+		"opengl: CPointCloud 1M pts, append scan, full buffers update",
+		opengl_pointcloud_append, 1000, 1);
+	lstTests.emplace_back(
+		"opengl: CPointCloud 1M pts, append scan, incremental update",
+		opengl_pointcloud_append, 1000, 0);
+	lstTests.emplace_back(
+		"opengl: RenderQueue 10k objects (per frame)", opengl_render_queue, 10,
+		0);
+	lstTests.emplace_back(
+		"opengl: RenderQueue 10k objects, culling+instancing (per frame)",
+		opengl_render_queue, 10, 1);
+	lstTests.emplace_back(
+		"opengl: RenderQueue 10k objects, culling+instancing+parallel",
+		opengl_render_queue, 10, 2);
+	lstTests.emplace_back(
+		"opengl: SoftwareRasterizer VGA RGB+D, 80k triangles, 1 thread",
+		opengl_software_render, 200, 1);
+	lstTests.emplace_back(
+		"opengl: SoftwareRasterizer VGA RGB+D, 80k triangles, 2 threads",
+		opengl_software_render, 200, 2);
+	lstTests.emplace_back(
+		"opengl: SoftwareRasterizer VGA RGB+D, 80k triangles, 4 threads",
+		opengl_software_render, 200, 4);
+	lstTests.emplace_back(
+		"opengl: SoftwareRasterizer VGA RGB+D, 80k triangles, 8 threads",
+		opengl_software_render, 200, 8);
+	lstTests.emplace_back(
+		"opengl: CMesh 1000x1000 elevation map, build triangles",
+		opengl_mesh_build, 1000, 0);
+	lstTests.emplace_back(
+		"opengl: CMesh 1000x1000 elevation map, with quad merging",
+		opengl_mesh_build, 1000, 1);
+}
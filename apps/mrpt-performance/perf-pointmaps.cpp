@@ -12,6 +12,7 @@
 #include <mrpt/obs/stock_observations.h>
 #include <mrpt/poses/CPose2D.h>
 #include <mrpt/random.h>
+#include <mrpt/system/filesystem.h>
 
 #include "common.h"
 
@@ -256,6 +257,99 @@ double pointmap_test_5(int a1, int a2)
 	return tictac.Tac() / a2;
 }
 
+// Point cloud file formats, for pointmap_test_6/7:
+enum class CloudFileFormat : int
+{
+	Text = 0,
+	PCD_ASCII,
+	PCD_Binary,
+	PCD_BinaryCompressed,
+	PLY_Binary,
+	PLY_Binary_Generic
+};
+
+static bool saveCloud(
+	const CSimplePointsMap& m, const std::string& fil, CloudFileFormat fmt)
+{
+	switch (fmt)
+	{
+		case CloudFileFormat::Text: return m.save3D_to_text_file(fil);
+		case CloudFileFormat::PCD_ASCII:
+			return m.savePCDFile(fil, CPointsMap::PCDFormat::ASCII);
+		case CloudFileFormat::PCD_Binary:
+			return m.savePCDFile(fil, CPointsMap::PCDFormat::Binary);
+		case CloudFileFormat::PCD_BinaryCompressed:
+			return m.savePCDFile(fil, CPointsMap::PCDFormat::BinaryCompressed);
+		case CloudFileFormat::PLY_Binary: return m.savePLYFile(fil);
+		case CloudFileFormat::PLY_Binary_Generic:
+			return m.saveToPlyFile(fil, true);
+	};
+	return false;
+}
+
+static bool loadCloud(
+	CSimplePointsMap& m, const std::string& fil, CloudFileFormat fmt)
+{
+	switch (fmt)
+	{
+		case CloudFileFormat::Text: return m.load3D_from_text_file(fil);
+		case CloudFileFormat::PCD_ASCII:
+		case CloudFileFormat::PCD_Binary:
+		case CloudFileFormat::PCD_BinaryCompressed: return m.loadPCDFile(fil);
+		case CloudFileFormat::PLY_Binary: return m.loadPLYFile(fil);
+		case CloudFileFormat::PLY_Binary_Generic:
+			return m.loadFromPlyFile(fil);
+	};
+	return false;
+}
+
+static CSimplePointsMap randomCloud(size_t N)
+{
+	auto& rng = getRandomGenerator();
+	rng.randomize(1234);
+	CSimplePointsMap m;
+	m.reserve(N);
+	for (size_t i = 0; i < N; i++)
+		m.insertPointFast(
+			rng.drawUniform(-100.f, 100.f), rng.drawUniform(-100.f, 100.f),
+			rng.drawUniform(-5.f, 5.f));
+	return m;
+}
+
+double pointmap_test_6(int format, int nPoints)
+{
+	// test 6: load a point cloud file
+	// ----------------------------------------
+	const auto fmt = static_cast<CloudFileFormat>(format);
+	const auto fil = mrpt::system::getTempFileName();
+	if (!saveCloud(randomCloud(nPoints), fil, fmt))
+		THROW_EXCEPTION("Error saving file");
+
+	CSimplePointsMap m;
+	CTicTac tictac;
+	const bool ok = loadCloud(m, fil, fmt);
+	const double t = tictac.Tac();
+	mrpt::system::deleteFile(fil);
+	ASSERT_(ok && m.size() == static_cast<size_t>(nPoints));
+	return t;
+}
+
+double pointmap_test_7(int format, int nPoints)
+{
+	// test 7: save a point cloud file
+	// ----------------------------------------
+	const auto fmt = static_cast<CloudFileFormat>(format);
+	const auto fil = mrpt::system::getTempFileName();
+	const auto m = randomCloud(nPoints);
+
+	CTicTac tictac;
+	const bool ok = saveCloud(m, fil, fmt);
+	const double t = tictac.Tac();
+	mrpt::system::deleteFile(fil);
+	ASSERT_(ok);
+	return t;
+}
+
 // ------------------------------------------------------
 // register_tests_pointmaps
 // ------------------------------------------------------
@@ -311,4 +405,40 @@ void register_tests_pointmaps()
 		"pointmap: boundingBox (10 scans)", pointmap_test_5, 10, 50000);
 	lstTests.emplace_back(
 		"pointmap: boundingBox (1000 scans)", pointmap_test_5, 1000, 5000);
+
+	const int NPTS = 1000000;
+	lstTests.emplace_back(
+		"pointmap: load 1M pts, text", pointmap_test_6,
+		int(CloudFileFormat::Text), NPTS);
+	lstTests.emplace_back(
+		"pointmap: load 1M pts, PCD ascii", pointmap_test_6,
+		int(CloudFileFormat::PCD_ASCII), NPTS);
+	lstTests.emplace_back(
+		"pointmap: load 1M pts, PCD binary", pointmap_test_6,
+		int(CloudFileFormat::PCD_Binary), NPTS);
+	lstTests.emplace_back(
+		"pointmap: load 1M pts, PCD binary_compressed", pointmap_test_6,
+		int(CloudFileFormat::PCD_BinaryCompressed), NPTS);
+	lstTests.emplace_back(
+		"pointmap: load 1M pts, PLY binary (loadPLYFile)", pointmap_test_6,
+		int(CloudFileFormat::PLY_Binary), NPTS);
+	lstTests.emplace_back(
+		"pointmap: load 1M pts, PLY binary (loadFromPlyFile)", pointmap_test_6,
+		int(CloudFileFormat::PLY_Binary_Generic), NPTS);
+
+	lstTests.emplace_back(
+		"pointmap: save 1M pts, text", pointmap_test_7,
+		int(CloudFileFormat::Text), NPTS);
+	lstTests.emplace_back(
+		"pointmap: save 1M pts, PCD binary", pointmap_test_7,
+		int(CloudFileFormat::PCD_Binary), NPTS);
+	lstTests.emplace_back(
+		"pointmap: save 1M pts, PCD binary_compressed", pointmap_test_7,
+		int(CloudFileFormat::PCD_BinaryCompressed), NPTS);
+	lstTests.emplace_back(
+		"pointmap: save 1M pts, PLY binary (savePLYFile)", pointmap_test_7,
+		int(CloudFileFormat::PLY_Binary), NPTS);
+	lstTests.emplace_back(
+		"pointmap: save 1M pts, PLY binary (saveToPlyFile)", pointmap_test_7,
+		int(CloudFileFormat::PLY_Binary_Generic), NPTS);
 }
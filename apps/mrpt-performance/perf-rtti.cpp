@@ -0,0 +1,91 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "common.h"
+//
+#include <mrpt/rtti/CObject.h>
+
+#include <deque>
+#include <map>
+
+// Synthetic classes, registered as the MRPT libraries do at startup:
+static const std::vector<mrpt::rtti::TRuntimeClassId>& syntheticClassIds(
+	int nClasses)
+{
+	static std::deque<std::string> names;
+	static std::map<int, std::vector<mrpt::rtti::TRuntimeClassId>> ids;
+	auto& v = ids[nClasses];
+	if (v.empty())
+	{
+		for (int i = 0; i < nClasses; i++)
+		{
+			const auto& n = names.emplace_back(
+				mrpt::format("mrpt::perf%i::CSyntheticClass%04i", nClasses, i));
+			v.push_back({n.c_str(), nullptr, nullptr});
+		}
+	}
+	return v;
+}
+
+double rtti_register_classes(int nClasses, int)
+{
+	const auto& ids = syntheticClassIds(nClasses);
+	const std::string lastName = ids.back().className;
+
+	CTicTac tictac;
+	for (const auto& id : ids)
+		mrpt::rtti::registerClass(&id);
+	// Includes building the lookup tables:
+	const auto* found = mrpt::rtti::findRegisteredClass(lastName);
+	const double t = tictac.Tac();
+	ASSERT_(found == &ids.back());
+	return t;
+}
+
+double rtti_find_class(int withNamespace, int)
+{
+	const auto classes = mrpt::rtti::getAllRegisteredClasses();
+	std::vector<std::string> names;
+	for (const auto* c : classes)
+	{
+		std::string n = c->className;
+		if (!withNamespace)
+			if (auto p = n.rfind("::"); p != std::string::npos)
+				n = n.substr(p + 2);
+		names.push_back(n);
+	}
+	ASSERT_(!names.empty());
+
+	size_t nFound = 0;
+	CTicTac tictac;
+	const int N = 100;
+	for (int i = 0; i < N; i++)
+		for (const auto& n : names)
+			if (mrpt::rtti::findRegisteredClass(n)) nFound++;
+	const double t = tictac.Tac() / (N * names.size());
+	ASSERT_EQUAL_(nFound, N * names.size());
+	return t;
+}
+
+// ------------------------------------------------------
+// register_tests_rtti
+// ------------------------------------------------------
+void register_tests_rtti()
+{
+	lstTests.emplace_back(
+		"rtti: register 500 classes (startup) and first lookup",
+		rtti_register_classes, 500);
+	lstTests.emplace_back(
+		"rtti: register 2000 classes (startup) and first lookup",
+		rtti_register_classes, 2000);
+	lstTests.emplace_back(
+		"rtti: findRegisteredClass() with namespace", rtti_find_class, 1);
+	lstTests.emplace_back(
+		"rtti: findRegisteredClass() without namespace", rtti_find_class, 0);
+}
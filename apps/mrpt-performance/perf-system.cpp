@@ -0,0 +1,54 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "common.h"
+
+// Cost of one enter()/leave() pair, through CTimeLoggerEntry:
+double timelogger_scope(int profilerMode, int byName)
+{
+	CTimeLogger tl;
+	if (profilerMode) tl.enableProfilerMode();
+
+	const int N = 200000;
+	CTicTac tictac;
+	if (byName)
+	{
+		for (int i = 0; i < N; i++)
+		{
+			mrpt::system::CTimeLoggerEntry tle(tl, "scope");
+		}
+	}
+	else
+	{
+		for (int i = 0; i < N; i++)
+		{
+			MRPT_PROFILE_SCOPE(tl, "scope");
+		}
+	}
+	const double t = tictac.Tac() / N;
+	tl.clear(true);	 // Do not dump stats at destruction
+	return t;
+}
+
+// ------------------------------------------------------
+// register_tests_system
+// ------------------------------------------------------
+void register_tests_system()
+{
+	lstTests.emplace_back(
+		"system: CTimeLoggerEntry scope (by name)", timelogger_scope, 0, 1);
+	lstTests.emplace_back(
+		"system: CTimeLoggerEntry scope (by name, profiler mode)",
+		timelogger_scope, 1, 1);
+	lstTests.emplace_back(
+		"system: MRPT_PROFILE_SCOPE()", timelogger_scope, 0, 0);
+	lstTests.emplace_back(
+		"system: MRPT_PROFILE_SCOPE() (profiler mode)", timelogger_scope, 1,
+		0);
+}
@@ -35,6 +35,32 @@ myMap:
     c: 3
 )xxx");
 
+// A big document (~2 MB) with the structure of a calibration or map metadata
+// file: one map per entry, with nested maps, scalars and short sequences.
+static const std::string& bigSyntheticYamlText()
+{
+	static const std::string txt = []() {
+		std::stringstream ss;
+		ss << "entries:\n";
+		for (int i = 0; i < 10000; i++)
+		{
+			ss << "  entry_" << i << ":\n"
+			   << "    name: \"sensor_" << i << "\"\n"
+			   << "    enabled: true\n"
+			   << "    rate: " << 10 + i % 7 << "\n"
+			   << "    pose: [" << 0.1 * i << ", -1.25, 0.5, 0, 0, "
+			   << 0.01 * i << "]\n"
+			   << "    intrinsics:\n"
+			   << "      fx: 525.0  # focal length\n"
+			   << "      fy: 525.0\n"
+			   << "      cx: 319.5\n"
+			   << "      cy: 239.5\n";
+		}
+		return ss.str();
+	}();
+	return txt;
+}
+
 static bool prepareYamlTestFile()
 {
 	bool err = false;
@@ -172,6 +198,82 @@ double yaml_iterate(int, int)
 	return r;
 }
 
+double yaml_big_FromText(int, int)
+{
+	const auto& txt = bigSyntheticYamlText();
+	mrpt::system::CTimeLogger tl;
+	for (unsigned int i = 0; i < 5; i++)
+	{
+		tl.enter("t");
+		auto doc = mrpt::containers::yaml::FromText(txt);
+		tl.leave("t");
+	}
+	double r = tl.getMeanTime("t");
+	tl.clear(true);	 // deep clear to silent dtor stats
+	return r;
+}
+
+double yaml_big_query(int, int)
+{
+	const auto doc = mrpt::containers::yaml::FromText(bigSyntheticYamlText());
+
+	std::vector<std::string> names;
+	for (int i = 0; i < 10000; i++)
+		names.push_back(mrpt::format("entry_%i", i));
+
+	double sum = 0;
+	CTicTac tictac;
+	const unsigned int reps = 100000;
+	for (unsigned int i = 0; i < reps; i++)
+	{
+		const auto e = doc["entries"][names[(i * 7919) % names.size()]];
+		sum += e["intrinsics"]["fx"].as<double>() + e["rate"].as<int>() +
+			e["pose"](0).as<double>();
+	}
+	const double r = tictac.Tac() / reps;
+	ASSERT_GT_(sum, .0);
+	return r;
+}
+
+double yaml_big_iterate(int, int)
+{
+	const auto doc = mrpt::containers::yaml::FromText(bigSyntheticYamlText());
+
+	size_t nEnabled = 0;
+	CTicTac tictac;
+	const unsigned int reps = 10;
+	for (unsigned int i = 0; i < reps; i++)
+	{
+		for (const auto& kv : doc["entries"].asMap())
+		{
+			const auto& entry = kv.second.asMap();
+			if (entry.find(std::string("enabled"))->second.as<bool>())
+				nEnabled++;
+		}
+	}
+	const double r = tictac.Tac() / reps;
+	ASSERT_EQUAL_(nEnabled, 10000U * reps);
+	return r;
+}
+
+double yaml_big_emit(int, int)
+{
+	const auto doc = mrpt::containers::yaml::FromText(bigSyntheticYamlText());
+
+	size_t len = 0;
+	CTicTac tictac;
+	const unsigned int reps = 5;
+	for (unsigned int i = 0; i < reps; i++)
+	{
+		std::stringstream ss;
+		doc.printAsYAML(ss);
+		len += ss.str().size();
+	}
+	const double r = tictac.Tac() / reps;
+	ASSERT_GT_(len, 0U);
+	return r;
+}
+
 #ifdef RUN_YAMLCPP_COMPARISON
 double yaml_yamlcpp_FromFile(int, int)
 {
@@ -268,6 +370,14 @@ void register_tests_yaml()
 	lstTests.emplace_back("yaml: FromText() small", &yaml_FromText);
 	lstTests.emplace_back("yaml: query in a big doc", &yaml_query);
 	lstTests.emplace_back("yaml: iterate a big doc", &yaml_iterate);
+	lstTests.emplace_back(
+		"yaml: FromText() synthetic 2MB doc", &yaml_big_FromText);
+	lstTests.emplace_back(
+		"yaml: query+as<>() in synthetic 2MB doc", &yaml_big_query);
+	lstTests.emplace_back(
+		"yaml: iterate synthetic 2MB doc", &yaml_big_iterate);
+	lstTests.emplace_back(
+		"yaml: printAsYAML() synthetic 2MB doc", &yaml_big_emit);
 
 #ifdef RUN_YAMLCPP_COMPARISON
 	lstTests.emplace_back(
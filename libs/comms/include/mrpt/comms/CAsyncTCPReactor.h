@@ -0,0 +1,85 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/core/pimpl.h>
+
+#include <cstddef>
+#include <memory>
+
+namespace mrpt::comms
+{
+/** An event loop which owns one background thread dispatching the readiness
+ * events (via `epoll`) of many non-blocking socket descriptors to their
+ * handlers. It is the engine behind CAsyncTCPSocket and CAsyncTCPServer,
+ * and normally does not need to be used directly.
+ *
+ * Handlers are held by weak references, so registering a descriptor does
+ * not extend the lifetime of its owner. All handler methods are invoked from
+ * the reactor thread, and must return quickly.
+ *
+ * \note Only available in Linux (epoll). In other platforms, the
+ * constructor throws.
+ * \sa CSerialPortReactor
+ * \ingroup mrpt_comms_grp
+ */
+class CAsyncTCPReactor
+{
+   public:
+	/** The interface of objects receiving events for one descriptor */
+	class Handler
+	{
+	   public:
+		virtual ~Handler() = default;
+
+		/** There is data to be read (or a pending connection to accept) */
+		virtual void onReadable() = 0;
+		/** The descriptor can be written to without blocking */
+		virtual void onWritable() = 0;
+		/** The peer hung up, or an error was reported for the descriptor */
+		virtual void onHangup() = 0;
+	};
+
+	/** Creates the reactor and launches its thread.
+	 * \exception std::exception If epoll is not available. */
+	CAsyncTCPReactor();
+	~CAsyncTCPReactor();
+
+	CAsyncTCPReactor(const CAsyncTCPReactor&) = delete;
+	CAsyncTCPReactor& operator=(const CAsyncTCPReactor&) = delete;
+
+	/** A process-wide reactor shared by all sockets, created upon first use */
+	static CAsyncTCPReactor& Instance();
+
+	/** Starts monitoring a non-blocking descriptor, initially only for
+	 * readability.
+	 * \exception std::exception On epoll errors. */
+	void add(int fd, const std::weak_ptr<Handler>& handler);
+
+	/** Selects which events are monitored for an already added descriptor.
+	 *  Safe to call from any thread, including from within handlers. */
+	void setInterest(int fd, bool read, bool write);
+
+	/** Stops monitoring the descriptor. This must be called before closing
+	 * it. Upon return, it is guaranteed that no handler of this descriptor is
+	 * running in the reactor thread (unless called from that handler). */
+	void remove(int fd);
+
+	/** Number of currently registered descriptors */
+	size_t size() const;
+
+	/** Whether the caller is the reactor thread */
+	bool isReactorThread() const;
+
+   private:
+	struct Impl;
+	spimpl::unique_impl_ptr<Impl> m_impl;
+};
+
+}  // namespace mrpt::comms
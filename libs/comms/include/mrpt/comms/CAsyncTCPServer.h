@@ -0,0 +1,76 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/comms/CAsyncTCPReactor.h>
+#include <mrpt/comms/CAsyncTCPSocket.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace mrpt::comms
+{
+/** An event-driven TCP server: incoming connections are accepted in the
+ * thread of a CAsyncTCPReactor and handed to a user callback as
+ * CAsyncTCPSocket objects.
+ *
+ * The user must keep a copy of the smart pointer of each new connection as
+ * long as it should remain open. Since the callback runs in the reactor
+ * thread, it is safe to install the socket message callbacks there, before
+ * any data is dispatched for the new connection.
+ *
+ * \note Only available in Linux (epoll).
+ * \sa CAsyncTCPSocket, CServerTCPSocket
+ * \ingroup mrpt_comms_grp
+ */
+class CAsyncTCPServer : public CAsyncTCPReactor::Handler
+{
+   public:
+	using Ptr = std::shared_ptr<CAsyncTCPServer>;
+	using on_connection_callback_t =
+		std::function<void(const CAsyncTCPSocket::Ptr& newConnection)>;
+
+	/** Creates the socket, binds it and starts listening.
+	 *  \param listenPort The port to bound to. Use 0 to let the OS pick a
+	 * free one, then retrieve it with getListenPort().
+	 *  \param IPaddress The interface to bound the socket to. By default is
+	 * 127.0.0.1 for localhost, for all network interfaces use 0.0.0.0.
+	 * \exception std::exception On any error creating the socket.
+	 */
+	static Ptr Create(
+		unsigned short listenPort, on_connection_callback_t onNewConnection,
+		const std::string& IPaddress = std::string("127.0.0.1"),
+		int maxConnectionsWaiting = 50,
+		CAsyncTCPReactor& reactor = CAsyncTCPReactor::Instance());
+
+	/** Stops listening. Already accepted connections are not affected. */
+	~CAsyncTCPServer() override;
+
+	CAsyncTCPServer(const CAsyncTCPServer&) = delete;
+	CAsyncTCPServer& operator=(const CAsyncTCPServer&) = delete;
+
+	/** The actual port the server is listening on */
+	unsigned short getListenPort() const { return m_listenPort; }
+
+   private:
+	CAsyncTCPServer(
+		int fd, on_connection_callback_t cb, CAsyncTCPReactor& reactor);
+
+	void onReadable() override;
+	void onWritable() override {}
+	void onHangup() override {}
+
+	const int m_fd;
+	on_connection_callback_t m_onNewConnection;
+	CAsyncTCPReactor& m_reactor;
+	unsigned short m_listenPort = 0;
+};
+
+}  // namespace mrpt::comms
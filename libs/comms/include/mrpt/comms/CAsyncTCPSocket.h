@@ -0,0 +1,264 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/comms/CAsyncTCPReactor.h>
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace mrpt::comms
+{
+/** An event-driven TCP connection exchanging messages (e.g.
+ * mrpt::serialization::CMessage) with the same wire format than
+ * CClientTCPSocket::sendMessage() and CClientTCPSocket::receiveMessage(), so
+ * both classes can talk to each other.
+ *
+ * Reception and transmission run in the thread of a CAsyncTCPReactor:
+ *  - Outgoing messages are appended to a send queue without copying their
+ * payloads (moved, or shared among many sockets with sendSharedMessage()),
+ * and all queued messages are written with one scatter/gather system call
+ * whenever the socket is writable.
+ *  - The send queue is bounded (setMaxSendQueueBytes()): once full,
+ * sendMessage() blocks (backpressure) until there is room or its timeout
+ * expires, so slow receivers cannot make memory grow without limits.
+ *  - Incoming messages are either delivered to a callback
+ * (setOnMessageCallback()), or stored in a bounded queue to be retrieved with
+ * receiveMessage(). When this queue is full, reading from the socket is
+ * paused, so the peer is throttled by TCP flow control.
+ *
+ * Usage:
+ * \code
+ *  auto sock = CAsyncTCPSocket::Connect("127.0.0.1", 5000);
+ *  mrpt::serialization::CMessage msg;
+ *  msg.type = 0x10;
+ *  msg.serializeObject(&obs);
+ *  sock->sendMessage(std::move(msg));
+ * \endcode
+ *
+ * \note Only available in Linux (epoll).
+ * \sa CAsyncTCPServer, CAsyncTCPReactor
+ * \ingroup mrpt_comms_grp
+ */
+class CAsyncTCPSocket : public CAsyncTCPReactor::Handler
+{
+   public:
+	using Ptr = std::shared_ptr<CAsyncTCPSocket>;
+	using payload_t = std::vector<uint8_t>;
+	using shared_payload_t = std::shared_ptr<const payload_t>;
+
+	/** Message type + content, as sent on the wire */
+	using on_message_callback_t = std::function<void(
+		CAsyncTCPSocket& sock, uint32_t type, payload_t&& content)>;
+	using on_disconnect_callback_t = std::function<void(CAsyncTCPSocket&)>;
+
+	/** Transfer statistics \sa getStats() */
+	struct TStats
+	{
+		uint64_t messages_sent = 0, messages_received = 0;
+		uint64_t bytes_sent = 0, bytes_received = 0;
+		/** Number of scatter/gather write system calls */
+		uint64_t write_calls = 0;
+		/** Number of sendMessage() calls which had to wait for room in the
+		 * send queue, and those that timed out */
+		uint64_t backpressure_waits = 0, backpressure_rejected = 0;
+		/** Bytes skipped while looking for a valid message header */
+		uint64_t rx_bytes_discarded = 0;
+		/** Headers announcing a content larger than the limit set with
+		 * setMaxReceiveMessageBytes(). The connection is closed then. */
+		uint64_t rx_messages_too_large = 0;
+	};
+
+	/** Connects to a TCP server.
+	 * \param timeout_ms Timeout for the connection (0: no timeout)
+	 * \exception std::exception On DNS, connection or timeout errors */
+	static Ptr Connect(
+		const std::string& remotePartAddress, unsigned short remotePartTCPPort,
+		unsigned int timeout_ms = 0,
+		CAsyncTCPReactor& reactor = CAsyncTCPReactor::Instance());
+
+	/** Takes ownership of an already connected socket descriptor (e.g. from
+	 * accept()). Used by CAsyncTCPServer. */
+	static Ptr FromDescriptor(
+		int fd, CAsyncTCPReactor& reactor = CAsyncTCPReactor::Instance());
+
+	/** Closes the connection */
+	~CAsyncTCPSocket() override;
+
+	CAsyncTCPSocket(const CAsyncTCPSocket&) = delete;
+	CAsyncTCPSocket& operator=(const CAsyncTCPSocket&) = delete;
+
+	/** Queues a message for transmission. Blocks while the send queue is
+	 * full, up to `timeout_ms` (<0: wait forever, 0: do not wait).
+	 *
+	 * When called from the reactor thread (i.e. from any callback, like
+	 * the message one), it never waits, since that thread is the one
+	 * emptying the queue: the message is queued even if the queue is full.
+	 * \return false if the connection is closed, or on timeout.
+	 * \tparam MESSAGE can be mrpt::serialization::CMessage. If passed as an
+	 * rvalue, its content is moved (not copied) into the queue.
+	 */
+	template <
+		class MESSAGE,
+		typename = std::enable_if_t<!std::is_lvalue_reference_v<MESSAGE>>>
+	bool sendMessage(MESSAGE&& msg, int timeout_ms = -1)
+	{
+		return sendSharedMessage(
+			msg.type, std::make_shared<const payload_t>(std::move(msg.content)),
+			timeout_ms);
+	}
+	/** \overload Copies the message content */
+	template <class MESSAGE>
+	bool sendMessage(const MESSAGE& msg, int timeout_ms = -1)
+	{
+		return sendSharedMessage(
+			msg.type, std::make_shared<const payload_t>(msg.content),
+			timeout_ms);
+	}
+
+	/** Queues a message whose content may be shared (without copies) with
+	 * other sockets, e.g. to broadcast the same serialized observation to
+	 * many clients. \sa sendMessage */
+	bool sendSharedMessage(
+		uint32_t type, shared_payload_t content, int timeout_ms = -1);
+
+	/** Blocks until all queued messages have been handed to the OS, the
+	 * connection is closed, or the timeout expires (<0: wait forever).
+	 * \return true if the send queue is empty. */
+	bool flush(int timeout_ms = -1);
+
+	/** Retrieves the next received message, waiting for up to `timeout_ms`
+	 * (<0: wait forever). Not usable if a message callback has been set.
+	 * \return false on timeout or if the connection was closed.
+	 * \tparam MESSAGE can be mrpt::serialization::CMessage
+	 */
+	template <class MESSAGE>
+	bool receiveMessage(MESSAGE& msg, int timeout_ms = -1)
+	{
+		return receiveRaw(msg.type, msg.content, timeout_ms);
+	}
+	/** \overload */
+	bool receiveRaw(uint32_t& type, payload_t& content, int timeout_ms = -1);
+
+	/** Sets a callback invoked from the reactor thread for each received
+	 * message, instead of storing them for receiveMessage(). */
+	void setOnMessageCallback(on_message_callback_t callback);
+
+	/** Sets a callback invoked from the reactor thread when the peer closes
+	 * the connection or it fails. */
+	void setOnDisconnectCallback(on_disconnect_callback_t callback);
+
+	/** Maximum number of bytes (headers + payloads) waiting in the send queue
+	 * before sendMessage() blocks. A single message larger than this is
+	 * accepted if the queue is empty. Default: 16 MiB */
+	void setMaxSendQueueBytes(size_t maxBytes);
+	size_t getMaxSendQueueBytes() const;
+
+	/** Maximum size of the content of received messages. Headers announcing
+	 * larger ones are taken as a corrupt stream or a hostile peer, and the
+	 * connection is closed, before allocating any memory for them.
+	 * Default: 64 MiB */
+	void setMaxReceiveMessageBytes(size_t maxBytes);
+
+	/** Maximum number of received messages waiting for receiveMessage()
+	 * before reading from the socket is paused. Default: 1024 */
+	void setMaxReceiveQueueMessages(size_t maxMessages);
+
+	/** Number of bytes waiting in the send queue */
+	size_t sendQueueBytes() const;
+
+	/** Number of messages waiting for receiveMessage() */
+	size_t receiveQueueSize() const;
+
+	bool isConnected() const;
+
+	/** Closes the connection. Pending outgoing messages are discarded (call
+	 * flush() first to avoid it). */
+	void close();
+
+	TStats getStats() const;
+
+	/** The IP address and port of the remote part of the connection */
+	const std::string& getRemoteAddress() const { return m_remoteIP; }
+	unsigned short getRemotePort() const { return m_remotePort; }
+
+	/** Number of bytes of the header preceding each message content */
+	static constexpr size_t HEADER_LENGTH = 11 + 4 + 4;
+
+   private:
+	CAsyncTCPSocket(int fd, CAsyncTCPReactor& reactor);
+
+	void onReadable() override;
+	void onWritable() override;
+	void onHangup() override;
+
+	struct TOutMsg
+	{
+		std::array<uint8_t, HEADER_LENGTH> header;
+		shared_payload_t content;
+		/** Bytes of header+content already written */
+		size_t written = 0;
+		size_t totalLength() const { return HEADER_LENGTH + content->size(); }
+	};
+
+	/** Writes as much of the send queue as possible. Must be called with
+	 * m_mtx locked. \return false on a socket error */
+	bool writePending();
+	/** Updates the events monitored by the reactor. Must be called with
+	 * m_mtx locked. */
+	void updateInterest();
+	/** Reads once from the socket. \return the number of read bytes, 0 on
+	 * EOF or error, or <0 if there is nothing to read now. */
+	long readOnce();
+	/** Makes room for at least `minFree` more bytes in m_rxBuf */
+	void reserveRx(size_t minFree);
+	/** \return false if a message exceeds the maximum size */
+	bool parseReceived();
+	/** Whether close() was called, or the disconnection was handled */
+	bool isClosed() const;
+	/** Only called from the reactor thread */
+	void handleDisconnection();
+
+	const int m_fd;
+	CAsyncTCPReactor& m_reactor;
+	std::string m_remoteIP;
+	unsigned short m_remotePort = 0;
+
+	mutable std::mutex m_mtx;
+	std::condition_variable m_txCond, m_rxCond;
+	bool m_connected = true;
+	bool m_disconnectHandled = false, m_fdClosed = false;
+	bool m_wantWrite = false, m_readPaused = false;
+
+	std::deque<TOutMsg> m_txQueue;
+	size_t m_txQueueBytes = 0, m_maxTxQueueBytes = 16 * 1024 * 1024;
+
+	/** Raw received bytes. Only accessed from the reactor thread */
+	payload_t m_rxBuf;
+	size_t m_rxBegin = 0, m_rxEnd = 0;
+
+	std::deque<std::pair<uint32_t, payload_t>> m_rxQueue;
+	size_t m_maxRxQueueMessages = 1024;
+	size_t m_maxRxMessageBytes = 64 * 1024 * 1024;
+
+	on_message_callback_t m_onMessage;
+	on_disconnect_callback_t m_onDisconnect;
+
+	TStats m_stats;
+};
+
+}  // namespace mrpt::comms
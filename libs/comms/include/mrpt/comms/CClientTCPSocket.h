@@ -165,24 +165,30 @@ class CClientTCPSocket : public mrpt::io::CStream
 	template <class MESSAGE>
 	bool sendMessage(const MESSAGE& outMsg, const int timeout_ms = -1)
 	{
-		// (1) Send a "magic word":
+		// (1) Send the header in one write: a "magic word", the message type
+		// and the message's content length:
 		const char* magic = "MRPTMessage";
-		uint32_t toWrite = strlen(magic);
-		uint32_t written = writeAsync(magic, toWrite, timeout_ms);
+		const uint32_t magicLen = strlen(magic);
+		const uint32_t contentLen = outMsg.content.size();
+		uint8_t header[32];
+		static_assert(
+			sizeof(header) >= 11 + sizeof(outMsg.type) + sizeof(contentLen));
+		uint32_t toWrite = 0;
+		std::memcpy(header, magic, magicLen);
+		toWrite += magicLen;
+		std::memcpy(header + toWrite, &outMsg.type, sizeof(outMsg.type));
+		toWrite += sizeof(outMsg.type);
+		std::memcpy(header + toWrite, &contentLen, sizeof(contentLen));
+		toWrite += sizeof(contentLen);
+		uint32_t written = writeAsync(header, toWrite, timeout_ms);
 		if (written != toWrite) return false;  // Error!
-		// (2) Send the message type:
-		toWrite = sizeof(outMsg.type);
-		written = writeAsync(&outMsg.type, toWrite, timeout_ms);
-		if (written != toWrite) return false;  // Error!
-		// (3) Send the message's content length:
-		uint32_t contentLen = outMsg.content.size();
-		toWrite = sizeof(contentLen);
-		written = writeAsync(&contentLen, toWrite, timeout_ms);
-		if (written != toWrite) return false;  // Error!
-		// (4) Send the message's contents:
+
+		// (2) Send the message's contents:
 		toWrite = contentLen;
+		if (!toWrite) return true;
 		written = writeAsync(&outMsg.content[0], toWrite, timeout_ms);
 		if (written != toWrite) return false;  // Error!
+
 		return true;
 	}
 
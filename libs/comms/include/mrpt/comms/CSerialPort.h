@@ -8,6 +8,7 @@
    +------------------------------------------------------------------------+ */
 #pragma once
 
+#include <mrpt/comms/CSerialPortReactor.h>
 #include <mrpt/io/CStream.h>
 #include <mrpt/system/CTicTac.h>
 
@@ -29,6 +30,10 @@ namespace mrpt::comms
  * If the name string does not start with "/" (an absolute path), the
  * constructor will assume the prefix "/dev/".
  *
+ *  In Linux, reception can be optionally delegated to a CSerialPortReactor
+ * shared by all ports in the process (see useReactor()), which avoids the
+ * per-port busy polling of the classic implementation.
+ *
  *  History:
  *    - 1/DEC/2005:  (JLBC) First version
  *    - 20/DEC/2006: (JLBC) Integration into the MRPT framework
@@ -139,6 +144,37 @@ class CSerialPort : public mrpt::io::CStream
 
 	// See base class docs
 	size_t Write(const void* Buffer, size_t Count) override;
+	/** Enables or disables the reception of this port through an epoll-based
+	 * CSerialPortReactor (Linux only). When enabled, a background thread owned
+	 * by the reactor fills a ring buffer with incoming data, and Read() and
+	 * ReadString() block on it instead of polling the port. It can be called
+	 * before or after opening the port.
+	 * \param reactor The reactor to use. If nullptr, the process-wide
+	 * CSerialPortReactor::Instance() is used.
+	 * \note The default for new ports can be changed with
+	 * setDefaultUseReactor() or the environment variable
+	 * `MRPT_SERIAL_USE_REACTOR`.
+	 * \note In platforms without reactor support this is silently ignored.
+	 */
+	void useReactor(bool enable = true, CSerialPortReactor* reactor = nullptr);
+
+	/** Returns true if the port is open and its reception is being handled by
+	 * a reactor \sa useReactor() */
+	bool isUsingReactor() const { return m_rxChannel != nullptr; }
+
+	/** Access to the reactor reception channel, e.g. to install a data
+	 * callback. nullptr if not isUsingReactor(). */
+	CSerialPortReactor::ChannelPtr reactorChannel() const
+	{
+		return m_rxChannel;
+	}
+
+	/** Changes whether newly created CSerialPort objects will use the shared
+	 * reactor. The initial value is read from the environment variable
+	 * `MRPT_SERIAL_USE_REACTOR` (default: false). \sa useReactor() */
+	static void setDefaultUseReactor(bool enable);
+	static bool defaultUseReactor();
+
 	/** not applicable in a serial port */
 	uint64_t Seek(
 		int64_t off, CStream::TSeekOrigin o = sFromBeginning) override;
@@ -155,6 +191,15 @@ class CSerialPort : public mrpt::io::CStream
 	int m_baudRate{0};
 	int m_totalTimeout_ms{0}, m_interBytesTimeout_ms{0};
 	mrpt::system::CTicTac m_timer;
+
+	bool m_useReactor = defaultUseReactor();
+	/** nullptr: use CSerialPortReactor::Instance() */
+	CSerialPortReactor* m_reactor = nullptr;
+	/** Non-null while open and attached to a reactor */
+	CSerialPortReactor::ChannelPtr m_rxChannel;
+
+	void attachToReactor();
+	void detachFromReactor();
 #ifdef _WIN32
 	// WINDOWS
 	void* hCOM{nullptr};
@@ -0,0 +1,133 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/containers/circular_buffer.h>
+#include <mrpt/core/pimpl.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace mrpt::comms
+{
+/** An I/O reactor which owns one background thread multiplexing the
+ * reception of many file descriptors (typically, serial ports) via `epoll`,
+ * so that N devices do not require N threads busy-polling their ports.
+ *
+ * Incoming bytes are moved by the reactor thread into a per-descriptor ring
+ * buffer (a Channel), and any thread blocked in Channel::read() or
+ * Channel::waitForData() is woken up as soon as data arrives. Optionally, a
+ * callback can be attached to each channel to push data into a parser.
+ *
+ * Users normally do not need to use this class directly: just call
+ * CSerialPort::useReactor() (or set the environment variable
+ * `MRPT_SERIAL_USE_REACTOR=1` to enable it for all serial ports in the
+ * process) and the existing blocking `CSerialPort::Read()` and
+ * `CSerialPort::ReadString()` methods will transparently wait on the
+ * reactor instead of polling the port every millisecond.
+ *
+ * \note Only available in Linux (epoll). In other platforms, the
+ * constructor throws and CSerialPort keeps its classic behavior.
+ * \ingroup mrpt_comms_grp
+ */
+class CSerialPortReactor
+{
+   public:
+	/** The reception buffer of one file descriptor attached to the reactor.
+	 *  All methods are thread-safe. */
+	class Channel
+	{
+		friend class CSerialPortReactor;
+
+	   public:
+		Channel(int fd, size_t rxBufferSize);
+
+		/** Reads up to `count` bytes, blocking until `count` bytes are
+		 * available, or `total_timeout_ms` elapses, or no new byte arrived
+		 * for `interbyte_timeout_ms` after a first one was received.
+		 * \return The number of actually read bytes (may be 0 on timeout or
+		 * if the descriptor was closed). */
+		size_t read(
+			void* buf, size_t count, int total_timeout_ms,
+			int interbyte_timeout_ms);
+
+		/** Blocks until at least one byte is available, the channel is
+		 * closed, or the timeout elapses (<0: wait forever).
+		 * \return true if there is data to be read. */
+		bool waitForData(int timeout_ms);
+
+		/** Number of bytes ready to be read without blocking. */
+		size_t available() const;
+
+		/** Discards all buffered data. */
+		void purge();
+
+		/** Whether the descriptor reported a hang-up or I/O error (e.g. USB
+		 * serial adapter unplugged) */
+		bool isClosed() const;
+
+		/** Number of received bytes discarded due to a full ring buffer */
+		uint64_t droppedBytes() const;
+
+		/** Sets a callback to be invoked from the reactor thread right after
+		 * new data is appended to the buffer. It must return quickly, since it
+		 * delays the reception of all other channels. */
+		void setOnDataCallback(std::function<void(Channel&)> callback);
+
+		int fd() const { return m_fd; }
+
+	   private:
+		const int m_fd;
+		mutable std::mutex m_mtx;
+		std::condition_variable m_cv;
+		mrpt::containers::circular_buffer<uint8_t> m_rx;
+		bool m_closed = false;
+		uint64_t m_dropped = 0;
+		std::function<void(Channel&)> m_onData;
+
+		/** Called from the reactor thread */
+		void onReceived(const uint8_t* data, size_t len);
+		void onClosed();
+	};
+
+	using ChannelPtr = std::shared_ptr<Channel>;
+
+	/** Creates the reactor and launches its thread.
+	 * \param rxBufferSize Size in bytes of each per-channel ring buffer.
+	 * \exception std::exception If epoll is not available. */
+	explicit CSerialPortReactor(size_t rxBufferSize = 64 * 1024);
+	~CSerialPortReactor();
+
+	CSerialPortReactor(const CSerialPortReactor&) = delete;
+	CSerialPortReactor& operator=(const CSerialPortReactor&) = delete;
+
+	/** A process-wide reactor shared by all ports, created upon first use */
+	static CSerialPortReactor& Instance();
+
+	/** Starts monitoring the given (non-blocking) descriptor. From now on,
+	 * the descriptor must not be read by anyone else but the reactor.
+	 * \exception std::exception On epoll errors. */
+	ChannelPtr attach(int fd);
+
+	/** Stops monitoring the descriptor of the given channel. This must be
+	 * called before closing the descriptor. Pending readers are woken up. */
+	void detach(const ChannelPtr& channel);
+
+	/** Number of currently attached channels */
+	size_t channelCount() const;
+
+   private:
+	struct Impl;
+	spimpl::unique_impl_ptr<Impl> m_impl;
+};
+
+}  // namespace mrpt::comms
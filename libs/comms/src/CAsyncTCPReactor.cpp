@@ -0,0 +1,228 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "comms-precomp.h"	// Precompiled headers
+//
+#include <mrpt/comms/CAsyncTCPReactor.h>
+#include <mrpt/config.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/system/thread_name.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(MRPT_OS_LINUX)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#define MRPT_TCP_REACTOR_HAS_EPOLL
+#endif
+
+using namespace mrpt::comms;
+
+struct CAsyncTCPReactor::Impl
+{
+	mutable std::mutex handlers_mtx;
+	std::map<int, std::weak_ptr<Handler>> handlers;
+	/** Descriptors removed since the current batch of events was returned by
+	 * epoll_wait(). Protected by handlers_mtx */
+	std::vector<int> removedInBatch;
+
+	/** Held by the reactor thread while dispatching events, so remove() can
+	 * make sure no handler is running for a descriptor about to be closed.
+	 * Recursive to allow remove() from within a handler. */
+	std::recursive_mutex dispatch_mtx;
+
+	std::atomic_bool quit{false};
+	std::thread thread;
+
+#if defined(MRPT_TCP_REACTOR_HAS_EPOLL)
+	int epfd = -1, wakefd = -1;
+
+	Impl()
+	{
+		epfd = ::epoll_create1(EPOLL_CLOEXEC);
+		if (epfd < 0)
+			THROW_EXCEPTION_FMT("epoll_create1() failed: %s", strerror(errno));
+		wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (wakefd < 0)
+		{
+			::close(epfd);
+			THROW_EXCEPTION_FMT("eventfd() failed: %s", strerror(errno));
+		}
+		epoll_event ev{};
+		ev.events = EPOLLIN;
+		ev.data.fd = wakefd;
+		::epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev);
+
+		thread = std::thread(&Impl::run, this);
+		mrpt::system::thread_name("tcpReactor", thread);
+	}
+
+	~Impl()
+	{
+		quit = true;
+		const uint64_t one = 1;
+		[[maybe_unused]] auto r = ::write(wakefd, &one, sizeof(one));
+		if (thread.joinable()) thread.join();
+		::close(wakefd);
+		::close(epfd);
+	}
+
+	void run()
+	{
+		std::array<epoll_event, 64> evs;
+
+		while (!quit)
+		{
+			const int n =
+				::epoll_wait(epfd, evs.data(), static_cast<int>(evs.size()), -1);
+			if (n < 0)
+			{
+				if (errno == EINTR) continue;
+				break;
+			}
+
+			std::lock_guard<std::recursive_mutex> dispLck(dispatch_mtx);
+			for (int i = 0; i < n; i++)
+			{
+				const int fd = evs[i].data.fd;
+				if (fd == wakefd)
+				{
+					uint64_t dummy;
+					[[maybe_unused]] auto r = ::read(wakefd, &dummy, sizeof(dummy));
+					continue;
+				}
+
+				std::shared_ptr<Handler> h;
+				{
+					std::lock_guard<std::mutex> lck(handlers_mtx);
+					if (auto it = handlers.find(fd); it != handlers.end())
+						h = it->second.lock();
+				}
+				if (!h) continue;  // removed or destroyed meanwhile
+
+				// A handler may close its own descriptor, or others', from
+				// any callback. Drop the rest of its events in this batch:
+				const auto wasRemoved = [&]() {
+					std::lock_guard<std::mutex> lck(handlers_mtx);
+					return std::find(
+							   removedInBatch.begin(), removedInBatch.end(),
+							   fd) != removedInBatch.end();
+				};
+				if (wasRemoved()) continue;
+
+				const auto e = evs[i].events;
+				if (e & EPOLLOUT) h->onWritable();
+				if ((e & EPOLLIN) && !wasRemoved()) h->onReadable();
+				if ((e & (EPOLLERR | EPOLLHUP)) && !wasRemoved())
+					h->onHangup();
+			}
+			std::lock_guard<std::mutex> lck(handlers_mtx);
+			removedInBatch.clear();
+		}
+	}
+
+	void add(int fd, const std::weak_ptr<Handler>& handler)
+	{
+		ASSERT_(fd >= 0);
+		{
+			std::lock_guard<std::mutex> lck(handlers_mtx);
+			ASSERTMSG_(
+				handlers.count(fd) == 0, "File descriptor already registered");
+			handlers[fd] = handler;
+			// If the number was just reused, the new handler may get some
+			// spurious (harmless) events of the former one, but not lose its
+			// own:
+			removedInBatch.erase(
+				std::remove(removedInBatch.begin(), removedInBatch.end(), fd),
+				removedInBatch.end());
+		}
+		epoll_event ev{};
+		ev.events = EPOLLIN;
+		ev.data.fd = fd;
+		if (::epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+		{
+			std::lock_guard<std::mutex> lck(handlers_mtx);
+			handlers.erase(fd);
+			THROW_EXCEPTION_FMT(
+				"epoll_ctl(ADD) failed for fd=%i: %s", fd, strerror(errno));
+		}
+	}
+
+	void setInterest(int fd, bool read, bool write)
+	{
+		epoll_event ev{};
+		ev.events = (read ? EPOLLIN : 0U) | (write ? EPOLLOUT : 0U);
+		ev.data.fd = fd;
+		::epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+	}
+
+	void remove(int fd)
+	{
+		::epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+		{
+			std::lock_guard<std::mutex> lck(handlers_mtx);
+			handlers.erase(fd);
+			removedInBatch.push_back(fd);
+		}
+		// Wait for any ongoing dispatch to finish:
+		std::lock_guard<std::recursive_mutex> dispLck(dispatch_mtx);
+	}
+#else
+	Impl() { THROW_EXCEPTION("CAsyncTCPReactor is only available in Linux"); }
+	void add(int, const std::weak_ptr<Handler>&) {}
+	void setInterest(int, bool, bool) {}
+	void remove(int) {}
+#endif
+};
+
+CAsyncTCPReactor::CAsyncTCPReactor()
+	: m_impl(spimpl::make_unique_impl<CAsyncTCPReactor::Impl>())
+{
+}
+
+CAsyncTCPReactor::~CAsyncTCPReactor() = default;
+
+CAsyncTCPReactor& CAsyncTCPReactor::Instance()
+{
+	static CAsyncTCPReactor reactor;
+	return reactor;
+}
+
+void CAsyncTCPReactor::add(int fd, const std::weak_ptr<Handler>& handler)
+{
+	m_impl->add(fd, handler);
+}
+
+void CAsyncTCPReactor::setInterest(int fd, bool read, bool write)
+{
+	m_impl->setInterest(fd, read, write);
+}
+
+void CAsyncTCPReactor::remove(int fd) { m_impl->remove(fd); }
+
+size_t CAsyncTCPReactor::size() const
+{
+	std::lock_guard<std::mutex> lck(m_impl->handlers_mtx);
+	return m_impl->handlers.size();
+}
+
+bool CAsyncTCPReactor::isReactorThread() const
+{
+	return std::this_thread::get_id() == m_impl->thread.get_id();
+}
@@ -0,0 +1,127 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "comms-precomp.h"	// Precompiled headers
+//
+#include <mrpt/comms/CAsyncTCPServer.h>
+#include <mrpt/config.h>
+#include <mrpt/core/exceptions.h>
+
+#include <iostream>
+
+#if defined(MRPT_OS_LINUX)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace mrpt::comms;
+
+CAsyncTCPServer::CAsyncTCPServer(
+	int fd, on_connection_callback_t cb, CAsyncTCPReactor& reactor)
+	: m_fd(fd), m_onNewConnection(std::move(cb)), m_reactor(reactor)
+{
+}
+
+#if defined(MRPT_OS_LINUX)
+
+CAsyncTCPServer::Ptr CAsyncTCPServer::Create(
+	unsigned short listenPort, on_connection_callback_t onNewConnection,
+	const std::string& IPaddress, int maxConnectionsWaiting,
+	CAsyncTCPReactor& reactor)
+{
+	MRPT_START
+
+	ASSERT_(onNewConnection);
+
+	const int fd =
+		::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		THROW_EXCEPTION_FMT("Error creating server socket: %s", strerror(errno));
+
+	const int one = 1;
+	::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(listenPort);
+	if (::inet_pton(AF_INET, IPaddress.c_str(), &addr.sin_addr) != 1)
+	{
+		::close(fd);
+		THROW_EXCEPTION_FMT("Invalid IP address: %s", IPaddress.c_str());
+	}
+
+	if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) <
+			0 ||
+		::listen(fd, maxConnectionsWaiting) < 0)
+	{
+		const int err = errno;
+		::close(fd);
+		THROW_EXCEPTION_FMT(
+			"Error listening on %s:%hu: %s", IPaddress.c_str(), listenPort,
+			strerror(err));
+	}
+
+	Ptr s(new CAsyncTCPServer(fd, std::move(onNewConnection), reactor));
+
+	socklen_t addrLen = sizeof(addr);
+	if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addrLen) == 0)
+		s->m_listenPort = ntohs(addr.sin_port);
+
+	reactor.add(fd, s);
+	return s;
+
+	MRPT_END
+}
+
+CAsyncTCPServer::~CAsyncTCPServer()
+{
+	m_reactor.remove(m_fd);
+	::close(m_fd);
+}
+
+void CAsyncTCPServer::onReadable()
+{
+	for (;;)
+	{
+		const int fd =
+			::accept4(m_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			break;	// EAGAIN: no more pending connections, or error
+		}
+		try
+		{
+			m_onNewConnection(CAsyncTCPSocket::FromDescriptor(fd, m_reactor));
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "[CAsyncTCPServer] Error handling new connection: "
+					  << e.what() << "\n";
+		}
+	}
+}
+
+#else  // MRPT_OS_LINUX
+
+CAsyncTCPServer::Ptr CAsyncTCPServer::Create(
+	unsigned short, on_connection_callback_t, const std::string&, int,
+	CAsyncTCPReactor&)
+{
+	THROW_EXCEPTION("CAsyncTCPServer is only available in Linux");
+}
+CAsyncTCPServer::~CAsyncTCPServer() = default;
+void CAsyncTCPServer::onReadable() {}
+
+#endif	// MRPT_OS_LINUX
@@ -0,0 +1,617 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "comms-precomp.h"	// Precompiled headers
+//
+#include <mrpt/comms/CAsyncTCPSocket.h>
+#include <mrpt/comms/CClientTCPSocket.h>
+#include <mrpt/comms/net_utils.h>
+#include <mrpt/config.h>
+#include <mrpt/core/exceptions.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#if defined(MRPT_OS_LINUX)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+using namespace mrpt::comms;
+
+namespace
+{
+// Must match CClientTCPSocket::sendMessage():
+constexpr char MAGIC[] = "MRPTMessage";
+constexpr size_t MAGIC_LEN = 11;
+static_assert(sizeof(MAGIC) == MAGIC_LEN + 1);
+
+// Minimum free space for each read() call:
+constexpr size_t RX_CHUNK = 64 * 1024;
+// Maximum number of buffers in one scatter/gather write:
+constexpr size_t MAX_IOV = 64;
+}  // namespace
+
+#if defined(MRPT_OS_LINUX)
+
+// ------------------------------------------------------
+//   CAsyncTCPSocket
+// ------------------------------------------------------
+CAsyncTCPSocket::CAsyncTCPSocket(int fd, CAsyncTCPReactor& reactor)
+	: m_fd(fd), m_reactor(reactor)
+{
+	m_rxBuf.resize(RX_CHUNK);
+}
+
+CAsyncTCPSocket::~CAsyncTCPSocket() { close(); }
+
+CAsyncTCPSocket::Ptr CAsyncTCPSocket::FromDescriptor(
+	int fd, CAsyncTCPReactor& reactor)
+{
+	ASSERT_(fd >= 0);
+	const int flags = ::fcntl(fd, F_GETFL, 0);
+	if (flags >= 0 && !(flags & O_NONBLOCK))
+		::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+	// Writes are already batched by us, so disable Nagle to reduce latency:
+	const int one = 1;
+	::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	Ptr s(new CAsyncTCPSocket(fd, reactor));
+
+	sockaddr_in addr{};
+	socklen_t addrLen = sizeof(addr);
+	if (::getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &addrLen) == 0 &&
+		addr.sin_family == AF_INET)
+	{
+		char buf[INET_ADDRSTRLEN];
+		if (::inet_ntop(AF_INET, &addr.sin_addr, buf, sizeof(buf)))
+			s->m_remoteIP = buf;
+		s->m_remotePort = ntohs(addr.sin_port);
+	}
+
+	reactor.add(fd, s);
+	return s;
+}
+
+CAsyncTCPSocket::Ptr CAsyncTCPSocket::Connect(
+	const std::string& remotePartAddress, unsigned short remotePartTCPPort,
+	unsigned int timeout_ms, CAsyncTCPReactor& reactor)
+{
+	MRPT_START
+
+	std::string solved_IP;
+	if (!net::DNS_resolve_async(
+			remotePartAddress, solved_IP,
+			CClientTCPSocket::DNS_LOOKUP_TIMEOUT_MS))
+		THROW_EXCEPTION_FMT(
+			"DNS lookup failed for '%s'", remotePartAddress.c_str());
+
+	sockaddr_in otherAddress{};
+	otherAddress.sin_family = AF_INET;
+	otherAddress.sin_port = htons(remotePartTCPPort);
+	if (::inet_pton(AF_INET, solved_IP.c_str(), &otherAddress.sin_addr) != 1)
+		THROW_EXCEPTION_FMT(
+			"Invalid IP address provided: %s", solved_IP.c_str());
+
+	const int fd =
+		::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		THROW_EXCEPTION_FMT(
+			"Error creating new client socket: %s", strerror(errno));
+
+	int r = ::connect(
+		fd, reinterpret_cast<const sockaddr*>(&otherAddress),
+		sizeof(otherAddress));
+	int err = (r < 0) ? errno : 0;
+	if (r < 0 && err == EINPROGRESS)
+	{
+		pollfd pfd{};
+		pfd.fd = fd;
+		pfd.events = POLLOUT;
+		do
+		{
+			r = ::poll(&pfd, 1, timeout_ms == 0 ? -1 : int(timeout_ms));
+		} while (r < 0 && errno == EINTR);
+
+		if (r == 0)
+		{
+			::close(fd);
+			THROW_EXCEPTION_FMT(
+				"Timeout connecting to '%s:%hu'", remotePartAddress.c_str(),
+				remotePartTCPPort);
+		}
+		err = errno;
+		if (r > 0)
+		{
+			socklen_t errLen = sizeof(err);
+			::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen);
+		}
+	}
+	if (err != 0)
+	{
+		::close(fd);
+		THROW_EXCEPTION_FMT(
+			"Error connecting to %s:%hu. Error: %s [%d]",
+			remotePartAddress.c_str(), remotePartTCPPort, strerror(err), err);
+	}
+
+	return FromDescriptor(fd, reactor);
+
+	MRPT_END
+}
+
+bool CAsyncTCPSocket::sendSharedMessage(
+	uint32_t type, shared_payload_t content, int timeout_ms)
+{
+	ASSERT_(content);
+	ASSERT_LT_(content->size(), std::numeric_limits<uint32_t>::max());
+
+	TOutMsg m;
+	const auto contentLen = static_cast<uint32_t>(content->size());
+	std::memcpy(m.header.data(), MAGIC, MAGIC_LEN);
+	std::memcpy(m.header.data() + MAGIC_LEN, &type, sizeof(type));
+	std::memcpy(
+		m.header.data() + MAGIC_LEN + sizeof(type), &contentLen,
+		sizeof(contentLen));
+	m.content = std::move(content);
+	const size_t len = m.totalLength();
+
+	std::unique_lock<std::mutex> lck(m_mtx);
+
+	const auto hasRoom = [&]() {
+		return !m_connected || m_txQueueBytes == 0 ||
+			m_txQueueBytes + len <= m_maxTxQueueBytes;
+	};
+	// The reactor thread is the one draining the queue, so it must never
+	// wait for room (e.g. when replying from a message callback):
+	if (!hasRoom() && !m_reactor.isReactorThread())
+	{
+		m_stats.backpressure_waits++;
+		bool ok = true;
+		if (timeout_ms < 0) m_txCond.wait(lck, hasRoom);
+		else
+			ok = m_txCond.wait_for(
+				lck, std::chrono::milliseconds(timeout_ms), hasRoom);
+		if (!ok)
+		{
+			m_stats.backpressure_rejected++;
+			return false;
+		}
+	}
+	if (!m_connected) return false;
+
+	const bool wasEmpty = m_txQueue.empty();
+	m_txQueue.push_back(std::move(m));
+	m_txQueueBytes += len;
+
+	// If nothing was waiting for the socket to become writable, try to send
+	// right now from this thread to save latency. Otherwise, this message
+	// will be written together with the rest of the queue by the reactor.
+	if (wasEmpty && !writePending())
+	{
+		// The reactor will report the error and handle the disconnection.
+		m_connected = false;
+		m_txQueue.clear();
+		m_txQueueBytes = 0;
+		lck.unlock();
+		m_txCond.notify_all();
+		m_rxCond.notify_all();
+		return false;
+	}
+	updateInterest();
+	return true;
+}
+
+bool CAsyncTCPSocket::writePending()
+{
+	while (!m_txQueue.empty())
+	{
+		std::array<iovec, MAX_IOV> iov;
+		size_t nIov = 0, requested = 0;
+		for (auto it = m_txQueue.begin();
+			 it != m_txQueue.end() && nIov + 2 <= MAX_IOV; ++it)
+		{
+			size_t off = it->written;
+			if (off < HEADER_LENGTH)
+			{
+				iov[nIov].iov_base = it->header.data() + off;
+				iov[nIov].iov_len = HEADER_LENGTH - off;
+				requested += iov[nIov++].iov_len;
+				off = 0;
+			}
+			else
+				off -= HEADER_LENGTH;
+
+			if (it->content->size() > off)
+			{
+				iov[nIov].iov_base =
+					const_cast<uint8_t*>(it->content->data()) + off;
+				iov[nIov].iov_len = it->content->size() - off;
+				requested += iov[nIov++].iov_len;
+			}
+		}
+
+		msghdr mh{};
+		mh.msg_iov = iov.data();
+		mh.msg_iovlen = nIov;
+		const ssize_t w = ::sendmsg(m_fd, &mh, MSG_NOSIGNAL);
+		if (w < 0)
+		{
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			return false;
+		}
+		m_stats.write_calls++;
+		m_stats.bytes_sent += w;
+
+		// Remove fully-sent messages:
+		for (size_t left = static_cast<size_t>(w); left > 0;)
+		{
+			auto& f = m_txQueue.front();
+			const size_t remaining = f.totalLength() - f.written;
+			if (left < remaining)
+			{
+				f.written += left;
+				break;
+			}
+			left -= remaining;
+			m_txQueueBytes -= f.totalLength();
+			m_txQueue.pop_front();
+			m_stats.messages_sent++;
+		}
+		m_txCond.notify_all();
+
+		if (static_cast<size_t>(w) < requested) break;	// Socket buffer full
+	}
+	return true;
+}
+
+void CAsyncTCPSocket::updateInterest()
+{
+	if (m_fdClosed || m_disconnectHandled) return;
+
+	const bool wantWrite = m_connected && !m_txQueue.empty();
+	const bool wantRead = m_onMessage || m_rxQueue.size() < m_maxRxQueueMessages;
+	if (wantWrite == m_wantWrite && !wantRead == m_readPaused) return;
+
+	m_wantWrite = wantWrite;
+	m_readPaused = !wantRead;
+	m_reactor.setInterest(m_fd, wantRead, wantWrite);
+}
+
+void CAsyncTCPSocket::onWritable()
+{
+	std::unique_lock<std::mutex> lck(m_mtx);
+	if (!m_connected) return;
+	if (!writePending())
+	{
+		lck.unlock();
+		handleDisconnection();
+		return;
+	}
+	updateInterest();
+}
+
+void CAsyncTCPSocket::reserveRx(size_t minFree)
+{
+	if (m_rxBegin == m_rxEnd) m_rxBegin = m_rxEnd = 0;
+	if (m_rxBuf.size() - m_rxEnd >= minFree) return;
+
+	// Move pending data to the beginning, and grow if still needed:
+	if (m_rxBegin > 0)
+	{
+		std::memmove(
+			m_rxBuf.data(), m_rxBuf.data() + m_rxBegin, m_rxEnd - m_rxBegin);
+		m_rxEnd -= m_rxBegin;
+		m_rxBegin = 0;
+	}
+	if (m_rxBuf.size() - m_rxEnd < minFree) m_rxBuf.resize(m_rxEnd + minFree);
+}
+
+long CAsyncTCPSocket::readOnce()
+{
+	reserveRx(RX_CHUNK);
+	for (;;)
+	{
+		const ssize_t r = ::read(
+			m_fd, m_rxBuf.data() + m_rxEnd, m_rxBuf.size() - m_rxEnd);
+		if (r > 0)
+		{
+			m_rxEnd += static_cast<size_t>(r);
+			{
+				std::lock_guard<std::mutex> lck(m_mtx);
+				m_stats.bytes_received += r;
+			}
+			if (!parseReceived())
+			{
+				// Corrupt stream, or a hostile peer: drop the connection.
+				std::cerr << "[CAsyncTCPSocket] Closing connection from "
+						  << m_remoteIP
+						  << ": received a message larger than the limit "
+							 "set with setMaxReceiveMessageBytes()\n";
+				::shutdown(m_fd, SHUT_RDWR);
+				return 0;
+			}
+			return static_cast<long>(r);
+		}
+		if (r < 0 && errno == EINTR) continue;
+		if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return -1;
+		return 0;  // EOF or error
+	}
+}
+
+bool CAsyncTCPSocket::isClosed() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_fdClosed || m_disconnectHandled;
+}
+
+void CAsyncTCPSocket::onReadable()
+{
+	if (isClosed()) return;
+	// Level-triggered: one read per event is enough, and gives other
+	// sockets a chance to be served.
+	if (readOnce() == 0) handleDisconnection();
+}
+
+void CAsyncTCPSocket::onHangup()
+{
+	if (isClosed()) return;
+	// Get whatever the peer sent before hanging up:
+	while (readOnce() > 0)
+	{
+	}
+	handleDisconnection();
+}
+
+bool CAsyncTCPSocket::parseReceived()
+{
+	std::vector<std::pair<uint32_t, payload_t>> msgs;
+	uint64_t discarded = 0;
+	bool tooLarge = false;
+	size_t maxContentLen;
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		maxContentLen = m_maxRxMessageBytes;
+	}
+
+	while (m_rxEnd - m_rxBegin >= HEADER_LENGTH)
+	{
+		const uint8_t* p = m_rxBuf.data() + m_rxBegin;
+		if (std::memcmp(p, MAGIC, MAGIC_LEN) != 0)
+		{
+			// Out of sync: look for the next header.
+			m_rxBegin++;
+			discarded++;
+			continue;
+		}
+		uint32_t type, contentLen;
+		std::memcpy(&type, p + MAGIC_LEN, sizeof(type));
+		std::memcpy(&contentLen, p + MAGIC_LEN + sizeof(type), sizeof(contentLen));
+		if (contentLen > maxContentLen)
+		{
+			tooLarge = true;
+			break;
+		}
+
+		const size_t msgLen = HEADER_LENGTH + contentLen;
+		if (m_rxEnd - m_rxBegin < msgLen)
+		{
+			// Wait for the rest of the message, with room for it:
+			reserveRx(msgLen - (m_rxEnd - m_rxBegin));
+			break;
+		}
+		msgs.emplace_back(
+			type, payload_t(p + HEADER_LENGTH, p + HEADER_LENGTH + contentLen));
+		m_rxBegin += msgLen;
+	}
+
+	on_message_callback_t cb;
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		m_stats.messages_received += msgs.size();
+		m_stats.rx_bytes_discarded += discarded;
+		if (tooLarge) m_stats.rx_messages_too_large++;
+		cb = m_onMessage;
+		if (!cb)
+		{
+			for (auto& m : msgs)
+				m_rxQueue.push_back(std::move(m));
+			updateInterest();
+		}
+	}
+	if (cb)
+	{
+		for (auto& m : msgs)
+			cb(*this, m.first, std::move(m.second));
+	}
+	else if (!msgs.empty())
+		m_rxCond.notify_all();
+
+	return !tooLarge;
+}
+
+void CAsyncTCPSocket::handleDisconnection()
+{
+	on_disconnect_callback_t cb;
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		if (m_disconnectHandled || m_fdClosed) return;
+		m_disconnectHandled = true;
+		m_connected = false;
+		m_txQueue.clear();
+		m_txQueueBytes = 0;
+		cb = m_onDisconnect;
+	}
+	// We are in the reactor thread, so this cannot race with close():
+	// Stop monitoring, since hang-ups are reported for ever otherwise.
+	m_reactor.remove(m_fd);
+
+	m_txCond.notify_all();
+	m_rxCond.notify_all();
+	if (cb) cb(*this);
+}
+
+void CAsyncTCPSocket::close()
+{
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		if (m_fdClosed) return;
+		m_fdClosed = true;
+		m_connected = false;
+		m_txQueue.clear();
+		m_txQueueBytes = 0;
+	}
+	m_reactor.remove(m_fd);
+	::close(m_fd);
+
+	m_txCond.notify_all();
+	m_rxCond.notify_all();
+}
+
+#else  // MRPT_OS_LINUX
+
+CAsyncTCPSocket::CAsyncTCPSocket(int fd, CAsyncTCPReactor& reactor)
+	: m_fd(fd), m_reactor(reactor)
+{
+}
+CAsyncTCPSocket::~CAsyncTCPSocket() = default;
+CAsyncTCPSocket::Ptr CAsyncTCPSocket::FromDescriptor(int, CAsyncTCPReactor&)
+{
+	THROW_EXCEPTION("CAsyncTCPSocket is only available in Linux");
+}
+CAsyncTCPSocket::Ptr CAsyncTCPSocket::Connect(
+	const std::string&, unsigned short, unsigned int, CAsyncTCPReactor&)
+{
+	THROW_EXCEPTION("CAsyncTCPSocket is only available in Linux");
+}
+bool CAsyncTCPSocket::sendSharedMessage(uint32_t, shared_payload_t, int)
+{
+	return false;
+}
+bool CAsyncTCPSocket::writePending() { return false; }
+void CAsyncTCPSocket::updateInterest() {}
+void CAsyncTCPSocket::onWritable() {}
+void CAsyncTCPSocket::reserveRx(size_t) {}
+long CAsyncTCPSocket::readOnce() { return 0; }
+void CAsyncTCPSocket::onReadable() {}
+void CAsyncTCPSocket::onHangup() {}
+bool CAsyncTCPSocket::parseReceived() { return true; }
+bool CAsyncTCPSocket::isClosed() const { return true; }
+void CAsyncTCPSocket::handleDisconnection() {}
+void CAsyncTCPSocket::close() {}
+
+#endif	// MRPT_OS_LINUX
+
+// Platform-independent methods:
+bool CAsyncTCPSocket::flush(int timeout_ms)
+{
+	std::unique_lock<std::mutex> lck(m_mtx);
+	const auto pred = [this]() { return m_txQueue.empty() || !m_connected; };
+	if (timeout_ms < 0) m_txCond.wait(lck, pred);
+	else
+		m_txCond.wait_for(lck, std::chrono::milliseconds(timeout_ms), pred);
+	return m_txQueue.empty();
+}
+
+bool CAsyncTCPSocket::receiveRaw(
+	uint32_t& type, payload_t& content, int timeout_ms)
+{
+	std::unique_lock<std::mutex> lck(m_mtx);
+	const auto pred = [this]() { return !m_rxQueue.empty() || !m_connected; };
+	if (timeout_ms < 0) m_rxCond.wait(lck, pred);
+	else
+		m_rxCond.wait_for(lck, std::chrono::milliseconds(timeout_ms), pred);
+
+	// Messages received before a disconnection can still be retrieved:
+	if (m_rxQueue.empty()) return false;
+
+	type = m_rxQueue.front().first;
+	content = std::move(m_rxQueue.front().second);
+	m_rxQueue.pop_front();
+	updateInterest();  // Resume reading, if it was paused
+	return true;
+}
+
+void CAsyncTCPSocket::setOnMessageCallback(on_message_callback_t callback)
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	m_onMessage = std::move(callback);
+	updateInterest();
+}
+
+void CAsyncTCPSocket::setOnDisconnectCallback(on_disconnect_callback_t callback)
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	m_onDisconnect = std::move(callback);
+}
+
+void CAsyncTCPSocket::setMaxSendQueueBytes(size_t maxBytes)
+{
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		m_maxTxQueueBytes = maxBytes;
+	}
+	m_txCond.notify_all();
+}
+
+size_t CAsyncTCPSocket::getMaxSendQueueBytes() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_maxTxQueueBytes;
+}
+
+void CAsyncTCPSocket::setMaxReceiveMessageBytes(size_t maxBytes)
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	m_maxRxMessageBytes = maxBytes;
+}
+
+void CAsyncTCPSocket::setMaxReceiveQueueMessages(size_t maxMessages)
+{
+	ASSERT_GT_(maxMessages, 0U);
+	std::lock_guard<std::mutex> lck(m_mtx);
+	m_maxRxQueueMessages = maxMessages;
+	updateInterest();
+}
+
+size_t CAsyncTCPSocket::sendQueueBytes() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_txQueueBytes;
+}
+
+size_t CAsyncTCPSocket::receiveQueueSize() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_rxQueue.size();
+}
+
+bool CAsyncTCPSocket::isConnected() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_connected;
+}
+
+CAsyncTCPSocket::TStats CAsyncTCPSocket::getStats() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_stats;
+}
@@ -0,0 +1,244 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/comms/CAsyncTCPServer.h>
+#include <mrpt/comms/CAsyncTCPSocket.h>
+#include <mrpt/comms/CClientTCPSocket.h>
+#include <mrpt/config.h>
+#include <mrpt/serialization/CMessage.h>
+
+#if defined(MRPT_OS_LINUX)
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace mrpt::comms;
+using mrpt::serialization::CMessage;
+
+namespace
+{
+// A server on an ephemeral loopback port, keeping all accepted connections
+struct TestServer
+{
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::vector<CAsyncTCPSocket::Ptr> conns;
+	CAsyncTCPServer::Ptr server;
+
+	TestServer()
+	{
+		server = CAsyncTCPServer::Create(0, [this](const auto& s) {
+			{
+				std::lock_guard<std::mutex> lck(mtx);
+				conns.push_back(s);
+			}
+			cv.notify_all();
+		});
+	}
+
+	CAsyncTCPSocket::Ptr waitForConnection(size_t idx = 0)
+	{
+		std::unique_lock<std::mutex> lck(mtx);
+		cv.wait_for(lck, std::chrono::seconds(5), [&]() {
+			return conns.size() > idx;
+		});
+		return conns.size() > idx ? conns[idx] : nullptr;
+	}
+};
+
+CMessage makeMessage(uint32_t type, size_t len)
+{
+	CMessage m;
+	m.type = type;
+	m.content.resize(len);
+	for (size_t i = 0; i < len; i++)
+		m.content[i] = static_cast<uint8_t>(type + i);
+	return m;
+}
+}  // namespace
+
+TEST(CAsyncTCPSocket, sendReceiveInOrder)
+{
+	TestServer srv;
+	auto client =
+		CAsyncTCPSocket::Connect("127.0.0.1", srv.server->getListenPort());
+	auto conn = srv.waitForConnection();
+	ASSERT_TRUE(conn);
+	EXPECT_EQ(conn->getRemoteAddress(), "127.0.0.1");
+
+	const uint32_t N = 1000;
+	for (uint32_t i = 0; i < N; i++)
+		ASSERT_TRUE(client->sendMessage(makeMessage(i, (i * 37) % 5000)));
+
+	for (uint32_t i = 0; i < N; i++)
+	{
+		CMessage rx;
+		ASSERT_TRUE(conn->receiveMessage(rx, 5000)) << "i=" << i;
+		const auto expected = makeMessage(i, (i * 37) % 5000);
+		EXPECT_EQ(rx.type, expected.type);
+		EXPECT_EQ(rx.content, expected.content);
+	}
+
+	EXPECT_TRUE(client->flush(1000));
+	const auto st = client->getStats();
+	EXPECT_EQ(st.messages_sent, N);
+	EXPECT_LE(st.write_calls, N);
+	EXPECT_EQ(conn->getStats().messages_received, N);
+}
+
+TEST(CAsyncTCPSocket, callbacksAndDisconnection)
+{
+	TestServer srv;
+	auto client =
+		CAsyncTCPSocket::Connect("127.0.0.1", srv.server->getListenPort());
+	auto conn = srv.waitForConnection();
+	ASSERT_TRUE(conn);
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::vector<uint32_t> rxTypes;
+	bool disconnected = false;
+
+	conn->setOnMessageCallback(
+		[&](CAsyncTCPSocket&, uint32_t type, std::vector<uint8_t>&&) {
+			std::lock_guard<std::mutex> lck(mtx);
+			rxTypes.push_back(type);
+			cv.notify_all();
+		});
+	conn->setOnDisconnectCallback([&](CAsyncTCPSocket&) {
+		std::lock_guard<std::mutex> lck(mtx);
+		disconnected = true;
+		cv.notify_all();
+	});
+
+	// The same payload, shared by several messages:
+	const auto payload =
+		std::make_shared<const std::vector<uint8_t>>(1000, uint8_t(0xAA));
+	for (uint32_t i = 0; i < 10; i++)
+		ASSERT_TRUE(client->sendSharedMessage(i, payload));
+	ASSERT_TRUE(client->flush(1000));
+	client->close();
+	EXPECT_FALSE(client->isConnected());
+
+	std::unique_lock<std::mutex> lck(mtx);
+	cv.wait_for(lck, std::chrono::seconds(5), [&]() { return disconnected; });
+	EXPECT_TRUE(disconnected);
+	ASSERT_EQ(rxTypes.size(), 10U);
+	for (uint32_t i = 0; i < 10; i++)
+		EXPECT_EQ(rxTypes[i], i);
+}
+
+TEST(CAsyncTCPSocket, interoperatesWithCClientTCPSocket)
+{
+	TestServer srv;
+	CClientTCPSocket legacy;
+	legacy.connect("127.0.0.1", srv.server->getListenPort(), 2000);
+	auto conn = srv.waitForConnection();
+	ASSERT_TRUE(conn);
+
+	ASSERT_TRUE(conn->sendMessage(makeMessage(7, 12345)));
+	CMessage rx;
+	ASSERT_TRUE(legacy.receiveMessage(rx, 2000, 2000));
+	EXPECT_EQ(rx.type, 7U);
+	EXPECT_EQ(rx.content, makeMessage(7, 12345).content);
+
+	ASSERT_TRUE(legacy.sendMessage(makeMessage(9, 100)));
+	ASSERT_TRUE(conn->receiveMessage(rx, 2000));
+	EXPECT_EQ(rx.type, 9U);
+	EXPECT_EQ(rx.content, makeMessage(9, 100).content);
+}
+
+TEST(CAsyncTCPSocket, backpressure)
+{
+	TestServer srv;
+	auto client =
+		CAsyncTCPSocket::Connect("127.0.0.1", srv.server->getListenPort());
+	auto conn = srv.waitForConnection();
+	ASSERT_TRUE(conn);
+
+	// The receiver does not consume messages, so its socket stops being read
+	// and eventually the sender queue gets full:
+	conn->setMaxReceiveQueueMessages(1);
+	client->setMaxSendQueueBytes(256 * 1024);
+
+	bool rejected = false;
+	for (int i = 0; i < 1000 && !rejected; i++)
+		rejected = !client->sendMessage(makeMessage(1, 100 * 1024), 10);
+
+	EXPECT_TRUE(rejected);
+	EXPECT_TRUE(client->isConnected());
+	EXPECT_LE(client->sendQueueBytes(), client->getMaxSendQueueBytes());
+	EXPECT_GT(client->getStats().backpressure_rejected, 0U);
+
+	// Draining the receiver must unblock the sender:
+	CMessage rx;
+	while (conn->receiveMessage(rx, 200))
+	{
+	}
+	EXPECT_TRUE(client->flush(5000));
+}
+
+TEST(CAsyncTCPSocket, replyFromCallbackNeverBlocks)
+{
+	TestServer srv;
+	auto client =
+		CAsyncTCPSocket::Connect("127.0.0.1", srv.server->getListenPort());
+	auto conn = srv.waitForConnection();
+	ASSERT_TRUE(conn);
+
+	// The client does not read replies, so the send queue of the server
+	// side gets full. Replies are sent from the reactor thread, which would
+	// deadlock if it waited for room:
+	client->setMaxReceiveQueueMessages(1);
+	conn->setMaxSendQueueBytes(64 * 1024);
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	size_t replied = 0;
+	conn->setOnMessageCallback(
+		[&](CAsyncTCPSocket& s, uint32_t type, std::vector<uint8_t>&&) {
+			s.sendMessage(makeMessage(type, 100 * 1024));
+			std::lock_guard<std::mutex> lck(mtx);
+			replied++;
+			cv.notify_all();
+		});
+
+	const size_t N = 50;
+	for (uint32_t i = 0; i < N; i++)
+		ASSERT_TRUE(client->sendMessage(makeMessage(i, 10)));
+
+	std::unique_lock<std::mutex> lck(mtx);
+	cv.wait_for(lck, std::chrono::seconds(5), [&]() { return replied == N; });
+	EXPECT_EQ(replied, N);
+}
+
+TEST(CAsyncTCPSocket, tooLargeMessageClosesConnection)
+{
+	TestServer srv;
+	auto client =
+		CAsyncTCPSocket::Connect("127.0.0.1", srv.server->getListenPort());
+	auto conn = srv.waitForConnection();
+	ASSERT_TRUE(conn);
+	conn->setMaxReceiveMessageBytes(1000);
+
+	ASSERT_TRUE(client->sendMessage(makeMessage(1, 1000)));
+	CMessage rx;
+	ASSERT_TRUE(conn->receiveMessage(rx, 5000));
+
+	ASSERT_TRUE(client->sendMessage(makeMessage(2, 1001)));
+	EXPECT_FALSE(conn->receiveMessage(rx, 5000));
+	EXPECT_FALSE(conn->isConnected());
+	EXPECT_EQ(conn->getStats().rx_messages_too_large, 1U);
+}
+
+#endif
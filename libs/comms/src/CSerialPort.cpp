@@ -11,6 +11,7 @@
 //
 #include <mrpt/comms/CSerialPort.h>
 #include <mrpt/core/exceptions.h>
+#include <mrpt/core/get_env.h>
 #include <mrpt/system/os.h>
 
 #if defined(MRPT_OS_LINUX) || defined(__APPLE__)
@@ -41,6 +42,7 @@
 #include <windows.h>
 #endif
 
+#include <atomic>
 #include <iostream>
 #include <thread>
 
@@ -50,6 +52,19 @@ using namespace mrpt::io;
 using namespace std;
 using namespace std::literals;
 
+static std::atomic_bool& defaultUseReactorFlag()
+{
+	static std::atomic_bool flag{
+		mrpt::get_env<bool>("MRPT_SERIAL_USE_REACTOR", false)};
+	return flag;
+}
+
+void CSerialPort::setDefaultUseReactor(bool enable)
+{
+	defaultUseReactorFlag() = enable;
+}
+bool CSerialPort::defaultUseReactor() { return defaultUseReactorFlag(); }
+
 // ctor
 CSerialPort::CSerialPort(const string& portName, bool openNow)
 	: m_serialName(portName)
@@ -179,11 +194,50 @@ void CSerialPort::open()
 	// Do NOT block on read.
 	fcntl(hCOM, F_SETFL, FNDELAY);
 
+	if (m_useReactor) attachToReactor();
+
 // Success!
 #endif
 	MRPT_END
 }
 
+void CSerialPort::useReactor(bool enable, CSerialPortReactor* reactor)
+{
+	if (m_rxChannel && (!enable || reactor != m_reactor)) detachFromReactor();
+
+	m_useReactor = enable;
+	m_reactor = reactor;
+
+	if (m_useReactor && isOpen() && !m_rxChannel) attachToReactor();
+}
+
+void CSerialPort::attachToReactor()
+{
+#if defined(MRPT_OS_LINUX)
+	try
+	{
+		auto& r = m_reactor ? *m_reactor : CSerialPortReactor::Instance();
+		m_rxChannel = r.attach(hCOM);
+	}
+	catch (const std::exception& e)
+	{
+		// Fall back to the classic polling implementation:
+		std::cerr << "[CSerialPort] Cannot use reactor for '" << m_serialName
+				  << "':\n"
+				  << mrpt::exception_to_str(e);
+		m_rxChannel.reset();
+	}
+#endif
+}
+
+void CSerialPort::detachFromReactor()
+{
+	if (!m_rxChannel) return;
+	auto& r = m_reactor ? *m_reactor : CSerialPortReactor::Instance();
+	r.detach(m_rxChannel);
+	m_rxChannel.reset();
+}
+
 /* -----------------------------------------------------
 				isOpen
    ----------------------------------------------------- */
@@ -537,6 +591,9 @@ void CSerialPort::close()
 #else
 	if (hCOM < 0) return;  // Already closed
 
+	// Must be done before closing the file descriptor:
+	detachFromReactor();
+
 	//    PosixSignalDispatcher& signal_dispatcher =
 	//    PosixSignalDispatcher::Instance() ;
 	//    signal_dispatcher.DetachHandler( SIGIO, *this ) ;
@@ -576,6 +633,16 @@ size_t CSerialPort::Read(void* Buffer, size_t Count)
 
 	if (!Count) return 0;
 
+	if (m_rxChannel)
+	{
+		const size_t nRead = m_rxChannel->read(
+			Buffer, Count, std::max(0, m_totalTimeout_ms),
+			m_interBytesTimeout_ms);
+		// The port has been disconnect (for USB ports)?
+		if (nRead < Count && m_rxChannel->isClosed()) this->close();
+		return nRead;
+	}
+
 	// Use the "m_totalTimeout_ms" global timeout
 	//  and the "m_interBytesTimeout_ms" for inter-bytes:
 	m_timer.Tic();
@@ -686,6 +753,27 @@ std::string CSerialPort::ReadString(
 		std::this_thread::sleep_for(
 			1ms);  // Wait 1 more ms for new data to arrive.
 #else
+		if (m_rxChannel)
+		{
+			// Block on the reactor buffer until the next byte arrives:
+			const int leftTime_ms = total_timeout_ms < 0
+				? -1
+				: std::max(0, total_timeout_ms - int(m_timer.Tac() * 1e3));
+			char c;
+			if (m_rxChannel->read(&c, 1, leftTime_ms, 0) == 1)
+			{
+				if (!strchr(eol_chars, c)) receivedStr.push_back(c);
+				else
+					return receivedStr;	 // end of string!
+			}
+			else if (m_rxChannel->isClosed())
+			{
+				this->close();
+				THROW_EXCEPTION("Error reading port before end of line");
+			}
+			continue;
+		}
+
 		// Bytes waiting in the queue?
 		// Check if we are still connected or there is an error...
 		int waiting_bytes = 0;
@@ -814,6 +902,7 @@ void CSerialPort::purgeBuffers()
 	/* Flush the input buffer associated with the port. */
 	if (tcflush(hCOM, TCIFLUSH) < 0)
 		THROW_EXCEPTION_FMT("Cannot flush serial port: %s", strerror(errno));
+	if (m_rxChannel) m_rxChannel->purge();
 #endif
 
 	MRPT_END
@@ -0,0 +1,353 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "comms-precomp.h"	// Precompiled headers
+//
+#include <mrpt/comms/CSerialPortReactor.h>
+#include <mrpt/config.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/system/thread_name.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+#if defined(MRPT_OS_LINUX)
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#define MRPT_SERIAL_REACTOR_HAS_EPOLL
+#endif
+
+using namespace mrpt::comms;
+
+// ------------------------------------------------------
+//   Channel
+// ------------------------------------------------------
+CSerialPortReactor::Channel::Channel(int fd, size_t rxBufferSize)
+	: m_fd(fd), m_rx(rxBufferSize)
+{
+}
+
+void CSerialPortReactor::Channel::onReceived(const uint8_t* data, size_t len)
+{
+	std::function<void(Channel&)> cb;
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		const size_t n = std::min(len, m_rx.available());
+		for (size_t i = 0; i < n; i++)
+			m_rx.push(data[i]);
+		m_dropped += len - n;
+		cb = m_onData;
+	}
+	m_cv.notify_all();
+	if (cb) cb(*this);
+}
+
+void CSerialPortReactor::Channel::onClosed()
+{
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		m_closed = true;
+	}
+	m_cv.notify_all();
+}
+
+size_t CSerialPortReactor::Channel::read(
+	void* buf, size_t count, int total_timeout_ms, int interbyte_timeout_ms)
+{
+	using clock = std::chrono::steady_clock;
+
+	auto* out = reinterpret_cast<uint8_t*>(buf);
+	size_t done = 0;
+
+	const bool waitForever = total_timeout_ms < 0;
+	const auto totalDeadline =
+		clock::now() + std::chrono::milliseconds(std::max(0, total_timeout_ms));
+	auto deadline = totalDeadline;
+
+	std::unique_lock<std::mutex> lck(m_mtx);
+	for (;;)
+	{
+		const size_t n = std::min(count - done, m_rx.size());
+		if (n)
+		{
+			m_rx.pop_many(out + done, n);
+			done += n;
+			// Reset inter-bytes timer, but never beyond the total timeout:
+			deadline = std::min(
+				totalDeadline,
+				std::max(
+					deadline,
+					clock::now() +
+						std::chrono::milliseconds(interbyte_timeout_ms)));
+		}
+		if (done == count || m_closed) break;
+
+		if (waitForever)
+			m_cv.wait(lck);
+		else if (
+			m_cv.wait_until(lck, deadline) == std::cv_status::timeout &&
+			m_rx.size() == 0)
+			break;
+	}
+	return done;
+}
+
+bool CSerialPortReactor::Channel::waitForData(int timeout_ms)
+{
+	std::unique_lock<std::mutex> lck(m_mtx);
+	const auto pred = [this]() { return m_rx.size() != 0 || m_closed; };
+	if (timeout_ms < 0) m_cv.wait(lck, pred);
+	else
+		m_cv.wait_for(lck, std::chrono::milliseconds(timeout_ms), pred);
+	return m_rx.size() != 0;
+}
+
+size_t CSerialPortReactor::Channel::available() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_rx.size();
+}
+
+void CSerialPortReactor::Channel::purge()
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	m_rx.clear();
+}
+
+bool CSerialPortReactor::Channel::isClosed() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_closed;
+}
+
+uint64_t CSerialPortReactor::Channel::droppedBytes() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_dropped;
+}
+
+void CSerialPortReactor::Channel::setOnDataCallback(
+	std::function<void(Channel&)> callback)
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	m_onData = std::move(callback);
+}
+
+// ------------------------------------------------------
+//   CSerialPortReactor
+// ------------------------------------------------------
+struct CSerialPortReactor::Impl
+{
+	size_t rxBufferSize;
+
+	mutable std::mutex channels_mtx;
+	std::map<int, ChannelPtr> channels;
+
+	/** Held by the reactor thread while dispatching events, so detach() can
+	 * make sure no read() is in progress on a descriptor about to be closed.
+	 * Recursive to allow detach() from within a data callback. */
+	std::recursive_mutex dispatch_mtx;
+
+	std::atomic_bool quit{false};
+	std::thread thread;
+
+#if defined(MRPT_SERIAL_REACTOR_HAS_EPOLL)
+	int epfd = -1, wakefd = -1;
+
+	Impl(size_t bufSize) : rxBufferSize(bufSize)
+	{
+		epfd = ::epoll_create1(EPOLL_CLOEXEC);
+		if (epfd < 0)
+			THROW_EXCEPTION_FMT("epoll_create1() failed: %s", strerror(errno));
+		wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (wakefd < 0)
+		{
+			::close(epfd);
+			THROW_EXCEPTION_FMT("eventfd() failed: %s", strerror(errno));
+		}
+		epoll_event ev{};
+		ev.events = EPOLLIN;
+		ev.data.fd = wakefd;
+		::epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev);
+
+		thread = std::thread(&Impl::run, this);
+		mrpt::system::thread_name("serialReactor", thread);
+	}
+
+	~Impl()
+	{
+		quit = true;
+		const uint64_t one = 1;
+		[[maybe_unused]] auto r = ::write(wakefd, &one, sizeof(one));
+		if (thread.joinable()) thread.join();
+		::close(wakefd);
+		::close(epfd);
+	}
+
+	void run()
+	{
+		std::array<epoll_event, 32> evs;
+		std::vector<uint8_t> tmp(4096);
+
+		while (!quit)
+		{
+			const int n =
+				::epoll_wait(epfd, evs.data(), static_cast<int>(evs.size()), -1);
+			if (n < 0)
+			{
+				if (errno == EINTR) continue;
+				break;
+			}
+
+			std::lock_guard<std::recursive_mutex> dispLck(dispatch_mtx);
+			for (int i = 0; i < n; i++)
+			{
+				const int fd = evs[i].data.fd;
+				if (fd == wakefd)
+				{
+					uint64_t dummy;
+					[[maybe_unused]] auto r = ::read(wakefd, &dummy, sizeof(dummy));
+					continue;
+				}
+
+				ChannelPtr ch;
+				{
+					std::lock_guard<std::mutex> lck(channels_mtx);
+					if (auto it = channels.find(fd); it != channels.end())
+						ch = it->second;
+				}
+				if (!ch) continue;	// detached meanwhile
+
+				bool closed = (evs[i].events & EPOLLERR) != 0;
+				if (evs[i].events & (EPOLLIN | EPOLLHUP))
+				{
+					for (;;)
+					{
+						const ssize_t nRead = ::read(fd, tmp.data(), tmp.size());
+						if (nRead > 0)
+						{
+							ch->onReceived(tmp.data(), static_cast<size_t>(nRead));
+							if (static_cast<size_t>(nRead) < tmp.size()) break;
+						}
+						else if (nRead < 0 && errno == EINTR)
+							continue;
+						else
+						{
+							// 0: EOF; <0: EAGAIN (nothing else to read now) or
+							// a real error (e.g. EIO for unplugged USB ports)
+							if (nRead == 0 ||
+								(errno != EAGAIN && errno != EWOULDBLOCK))
+								closed = true;
+							break;
+						}
+					}
+				}
+				if (closed)
+				{
+					::epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+					{
+						std::lock_guard<std::mutex> lck(channels_mtx);
+						channels.erase(fd);
+					}
+					ch->onClosed();
+				}
+			}
+		}
+	}
+
+	ChannelPtr attach(int fd)
+	{
+		ASSERT_(fd >= 0);
+		// The reactor relies on non-blocking reads:
+		const int flags = ::fcntl(fd, F_GETFL, 0);
+		if (flags >= 0 && !(flags & O_NONBLOCK))
+			::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+		auto ch = std::make_shared<Channel>(fd, rxBufferSize);
+		{
+			std::lock_guard<std::mutex> lck(channels_mtx);
+			ASSERTMSG_(
+				channels.count(fd) == 0, "File descriptor already attached");
+			channels[fd] = ch;
+		}
+		epoll_event ev{};
+		ev.events = EPOLLIN;
+		ev.data.fd = fd;
+		if (::epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+		{
+			std::lock_guard<std::mutex> lck(channels_mtx);
+			channels.erase(fd);
+			THROW_EXCEPTION_FMT(
+				"epoll_ctl(ADD) failed for fd=%i: %s", fd, strerror(errno));
+		}
+		return ch;
+	}
+
+	void detach(const ChannelPtr& ch)
+	{
+		if (!ch) return;
+		::epoll_ctl(epfd, EPOLL_CTL_DEL, ch->fd(), nullptr);
+		{
+			std::lock_guard<std::mutex> lck(channels_mtx);
+			if (auto it = channels.find(ch->fd());
+				it != channels.end() && it->second == ch)
+				channels.erase(it);
+		}
+		// Wait for any ongoing dispatch using this fd to finish:
+		std::lock_guard<std::recursive_mutex> dispLck(dispatch_mtx);
+		ch->onClosed();
+	}
+#else
+	Impl(size_t bufSize) : rxBufferSize(bufSize)
+	{
+		THROW_EXCEPTION("CSerialPortReactor is only available in Linux");
+	}
+	ChannelPtr attach(int) { return {}; }
+	void detach(const ChannelPtr&) {}
+#endif
+};
+
+CSerialPortReactor::CSerialPortReactor(size_t rxBufferSize)
+	: m_impl(spimpl::make_unique_impl<CSerialPortReactor::Impl>(rxBufferSize))
+{
+}
+
+CSerialPortReactor::~CSerialPortReactor() = default;
+
+CSerialPortReactor& CSerialPortReactor::Instance()
+{
+	static CSerialPortReactor reactor;
+	return reactor;
+}
+
+CSerialPortReactor::ChannelPtr CSerialPortReactor::attach(int fd)
+{
+	return m_impl->attach(fd);
+}
+
+void CSerialPortReactor::detach(const ChannelPtr& channel)
+{
+	m_impl->detach(channel);
+}
+
+size_t CSerialPortReactor::channelCount() const
+{
+	std::lock_guard<std::mutex> lck(m_impl->channels_mtx);
+	return m_impl->channels.size();
+}
@@ -0,0 +1,164 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/comms/CSerialPort.h>
+#include <mrpt/comms/CSerialPortReactor.h>
+#include <mrpt/config.h>
+
+#if defined(MRPT_OS_LINUX)
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace
+{
+// A pseudo-terminal pair, used as a local stand-in for a serial device:
+struct PseudoTerminal
+{
+	int master = -1;
+	std::string slaveName;
+
+	PseudoTerminal()
+	{
+		master = ::posix_openpt(O_RDWR | O_NOCTTY);
+		if (master < 0 || ::grantpt(master) != 0 || ::unlockpt(master) != 0)
+			return;
+		slaveName = ::ptsname(master);
+	}
+	~PseudoTerminal()
+	{
+		if (master >= 0) ::close(master);
+	}
+	bool ok() const { return master >= 0 && !slaveName.empty(); }
+	void send(const std::string& s)
+	{
+		[[maybe_unused]] auto r = ::write(master, s.data(), s.size());
+	}
+};
+}  // namespace
+
+TEST(CSerialPortReactor, ReadThroughSerialPort)
+{
+	PseudoTerminal pty;
+	if (!pty.ok())
+	{
+		std::cerr << "WARNING: Skipping test, cannot create a pty\n";
+		return;
+	}
+
+	mrpt::comms::CSerialPortReactor reactor;
+
+	mrpt::comms::CSerialPort port;
+	port.useReactor(true, &reactor);
+	port.open(pty.slaveName);
+	ASSERT_TRUE(port.isUsingReactor());
+	EXPECT_EQ(reactor.channelCount(), 1U);
+
+	// Raw (non-canonical) mode, so line endings are not altered:
+	port.setConfig(115200);
+	port.setTimeouts(1, 0, 500, 0, 0);
+
+	pty.send("HELLO\nWORLD!");
+
+	bool timeout = true;
+	EXPECT_EQ(port.ReadString(500, &timeout), "HELLO");
+	EXPECT_FALSE(timeout);
+
+	char buf[6];
+	ASSERT_EQ(port.Read(buf, sizeof(buf)), sizeof(buf));
+	EXPECT_EQ(std::string(buf, sizeof(buf)), "WORLD!");
+
+	// Timeout with no data:
+	EXPECT_EQ(port.Read(buf, sizeof(buf)), 0U);
+
+	port.close();
+	EXPECT_EQ(reactor.channelCount(), 0U);
+}
+
+TEST(CSerialPortReactor, ReadHonorsTotalTimeout)
+{
+	PseudoTerminal pty;
+	if (!pty.ok())
+	{
+		std::cerr << "WARNING: Skipping test, cannot create a pty\n";
+		return;
+	}
+
+	mrpt::comms::CSerialPortReactor reactor;
+	mrpt::comms::CSerialPort port;
+	port.useReactor(true, &reactor);
+	port.open(pty.slaveName);
+	port.setConfig(115200);
+
+	// One byte every 10 ms, for 1 s:
+	std::thread sender([&]() {
+		for (int i = 0; i < 100; i++)
+		{
+			pty.send("x");
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	});
+
+	// Bytes keep arriving before the inter-byte timeout, but the read must
+	// still end once the total timeout elapses:
+	char buf[1000];
+	const auto t0 = std::chrono::steady_clock::now();
+	const size_t n = port.reactorChannel()->read(buf, sizeof(buf), 100, 50);
+	const auto dt = std::chrono::steady_clock::now() - t0;
+	sender.join();
+
+	EXPECT_GT(n, 0U);
+	EXPECT_LT(n, 100U);
+	EXPECT_LT(dt, std::chrono::milliseconds(500));
+}
+
+TEST(CSerialPortReactor, ManyPortsAndCallbacks)
+{
+	constexpr size_t N = 10;
+	PseudoTerminal ptys[N];
+	for (const auto& p : ptys)
+		if (!p.ok())
+		{
+			std::cerr << "WARNING: Skipping test, cannot create a pty\n";
+			return;
+		}
+
+	mrpt::comms::CSerialPortReactor reactor;
+	mrpt::comms::CSerialPort ports[N];
+	std::atomic_int callbacks{0};
+
+	for (size_t i = 0; i < N; i++)
+	{
+		ports[i].useReactor(true, &reactor);
+		ports[i].open(ptys[i].slaveName);
+		ports[i].setConfig(115200);
+		ports[i].setTimeouts(1, 0, 1000, 0, 0);
+		ports[i].reactorChannel()->setOnDataCallback(
+			[&](mrpt::comms::CSerialPortReactor::Channel&) { callbacks++; });
+	}
+	EXPECT_EQ(reactor.channelCount(), N);
+
+	for (size_t i = 0; i < N; i++)
+		ptys[i].send(std::to_string(i) + "\n");
+
+	for (size_t i = 0; i < N; i++)
+		EXPECT_EQ(ports[i].ReadString(1000), std::to_string(i));
+
+	EXPECT_GE(callbacks.load(), static_cast<int>(N));
+}
+
+#endif
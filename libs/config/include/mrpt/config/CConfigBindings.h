@@ -0,0 +1,147 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/config/CConfigFileBase.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace mrpt::config
+{
+/** A list of the configuration keys of the fields of a struct, used to load
+ * all of them from a configuration file at once.
+ *
+ * The list is meant to be built once per struct type (e.g. as a static
+ * local variable in `loadFromConfigFile()`), instead of writing one
+ * `MRPT_LOAD_CONFIG_VAR()` per field:
+ *
+ * \code
+ * void TMyOptions::loadFromConfigFile(
+ *     const mrpt::config::CConfigFileBase& c, const std::string& s)
+ * {
+ *     static const auto bindings =
+ *         mrpt::config::CConfigBindings<TMyOptions>()
+ *             .bind("resolution", &TMyOptions::resolution)
+ *             .bind("algorithm", &TMyOptions::algorithm) // an enum
+ *             .bindDegrees("maxAngle_DEG", &TMyOptions::maxAngle)
+ *             .bind("mapFile", &TMyOptions::mapFile, true); // required
+ *     bindings.load(c, s, *this);
+ * }
+ * \endcode
+ *
+ * Each field is read with the CConfigFileBase method for its type:
+ * read_bool(), read_int() (integer types, except 64-bit unsigned ones, read
+ * with read_uint64_t()), read_float(), read_double(), read_string(),
+ * read_enum() and read_vector(). Fields not found in the configuration keep
+ * their current values, unless marked as required, in which case an
+ * exception is thrown.
+ *
+ * \ingroup mrpt_config_grp
+ */
+template <class T>
+class CConfigBindings
+{
+   public:
+	/** Binds the key `name` to the field `member`.
+	 * \param required If true, load() throws if the key is not found.
+	 */
+	template <typename V>
+	CConfigBindings& bind(
+		const std::string& name, V T::*member, bool required = false)
+	{
+		m_bindings.push_back(
+			{name, [member, required](
+					   const CConfigFileBase& c, const std::string& s,
+					   const std::string& n, T& obj) {
+				 V& v = obj.*member;
+				 v = readValue<V>(c, s, n, v, required);
+			 }});
+		return *this;
+	}
+
+	/** Binds the key `name`, written in degrees in the configuration file, to
+	 * the field `member` (in radians). */
+	template <typename V>
+	CConfigBindings& bindDegrees(
+		const std::string& name, V T::*member, bool required = false)
+	{
+		static_assert(
+			std::is_floating_point_v<V>,
+			"bindDegrees() requires a floating point field");
+		m_bindings.push_back(
+			{name, [member, required](
+					   const CConfigFileBase& c, const std::string& s,
+					   const std::string& n, T& obj) {
+				 V& v = obj.*member;
+				 v = mrpt::DEG2RAD(
+					 readValue<V>(c, s, n, mrpt::RAD2DEG(v), required));
+			 }});
+		return *this;
+	}
+
+	/** Loads all bound fields of `obj` from the given section. */
+	void load(
+		const CConfigFileBase& c, const std::string& section, T& obj) const
+	{
+		for (const auto& b : m_bindings)
+			b.load(c, section, b.name, obj);
+	}
+
+	/** Number of bound fields */
+	size_t size() const { return m_bindings.size(); }
+
+   private:
+	struct TBinding
+	{
+		std::string name;
+		std::function<void(
+			const CConfigFileBase&, const std::string&, const std::string&,
+			T&)>
+			load;
+	};
+	std::vector<TBinding> m_bindings;
+
+	template <typename V>
+	static V readValue(
+		const CConfigFileBase& c, const std::string& s, const std::string& n,
+		const V& defaultValue, bool required)
+	{
+		if constexpr (std::is_same_v<V, bool>)
+			return c.read_bool(s, n, defaultValue, required);
+		else if constexpr (std::is_enum_v<V>)
+			return c.read_enum<V>(s, n, defaultValue, required);
+		else if constexpr (std::is_same_v<V, float>)
+			return c.read_float(s, n, defaultValue, required);
+		else if constexpr (std::is_floating_point_v<V>)
+			return static_cast<V>(c.read_double(s, n, defaultValue, required));
+		else if constexpr (
+			std::is_integral_v<V> && std::is_unsigned_v<V> && sizeof(V) == 8)
+			return static_cast<V>(
+				c.read_uint64_t(s, n, defaultValue, required));
+		else if constexpr (std::is_integral_v<V>)
+			return static_cast<V>(
+				c.read_int(s, n, static_cast<int>(defaultValue), required));
+		else if constexpr (std::is_same_v<V, std::string>)
+			return c.read_string(s, n, defaultValue, required);
+		else
+		{
+			V ret;
+			c.read_vector(s, n, defaultValue, ret, required);
+			return ret;
+		}
+	}
+};
+
+}  // namespace mrpt::config
@@ -53,6 +53,10 @@ class CConfigFile : public CConfigFileBase
 		const std::string& defaultStr,
 		bool failIfNotFound = false) const override;
 
+	bool readStringIfExists(
+		const std::string& section, const std::string& name,
+		std::string& out) const override;
+
    public:
 	/** Constructor associating with a given configuration filename.
 	 * If the file exists, it loads and parses its contents; otherwise, it
@@ -12,6 +12,7 @@
 #include <mrpt/core/exceptions.h>
 #include <mrpt/system/string_utils.h>  // tokenize
 
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -39,6 +40,13 @@ int MRPT_SAVE_VALUE_PADDING();
  *   This is a virtual class, use only as a pointer to an implementation of one
  * of the derived classes.
  *
+ * Derived classes which support it (CConfigFile, CConfigFileMemory) keep a
+ * cache of the values already read, indexed by a hash of the section and key
+ * names, together with their parsed numeric values, so reading the same keys
+ * again (e.g. when re-initializing objects in a loop) does not involve
+ * searching or parsing strings. The cache is cleared on any write. See
+ * setValuesCacheEnabled().
+ *
  * See: \ref config_file_format
  * \ingroup mrpt_config_grp
  */
@@ -67,10 +75,45 @@ class CConfigFileBase
 		const std::string& section, const std::string& name,
 		const std::string& defaultStr, bool failIfNotFound = false) const = 0;
 
+	/** Reads a generic string, as readString() does, returning false if the
+	 * key does not exist. Used to fill the cache of values. The default
+	 * implementation relies on keyExists() and readString(). */
+	virtual bool readStringIfExists(
+		const std::string& section, const std::string& name,
+		std::string& out) const;
+
+	/** Removes a trailing comment ("//" preceded by a whitespace) from a
+	 * value read from a file, as readString() implementations must do. */
+	static void stripValueComment(std::string& value);
+
+	/** Like readString(), but through the cache of values, if enabled. */
+	std::string readCachedString(
+		const std::string& section, const std::string& name,
+		const std::string& defaultStr, bool failIfNotFound = false) const;
+
+	/** Derived classes must call this method from their constructors to allow
+	 * caching values, and then call invalidateValuesCache() upon any change
+	 * of their contents. */
+	void enableValuesCacheSupport();
+
+	/** Clears the cache of values. \sa enableValuesCacheSupport() */
+	void invalidateValuesCache();
+
    public:
+	CConfigFileBase();
+	/** Copy ctor. The cache of values is not copied. */
+	CConfigFileBase(const CConfigFileBase& o);
+	CConfigFileBase& operator=(const CConfigFileBase& o);
+
 	/** dtor */
 	virtual ~CConfigFileBase();
 
+	/** Enables or disables the cache of values (Default: enabled). It has no
+	 * effect in derived classes without support for it. */
+	void setValuesCacheEnabled(bool enabled);
+	/** Whether values are being cached (enabled and supported) */
+	bool isValuesCacheEnabled() const;
+
 	/** Returns a list with all the section names. */
 	virtual void getAllSections(std::vector<std::string>& sections) const = 0;
 
@@ -197,7 +240,7 @@ class CConfigFileBase
 		const VECTOR_TYPE& defaultValue, VECTOR_TYPE& outValues,
 		bool failIfNotFound = false) const
 	{
-		std::string aux(readString(section, name, "", failIfNotFound));
+		std::string aux(readCachedString(section, name, "", failIfNotFound));
 		// Parse the text into a vector:
 		std::vector<std::string> tokens;
 		mrpt::system::tokenize(aux, "[], \t", tokens);
@@ -231,7 +274,7 @@ class CConfigFileBase
 		const MATRIX_TYPE& defaultMatrix = MATRIX_TYPE(),
 		bool failIfNotFound = false) const
 	{
-		std::string aux = readString(section, name, "", failIfNotFound);
+		std::string aux = readCachedString(section, name, "", failIfNotFound);
 		if (aux.empty()) outMatrix = defaultMatrix;
 		else
 		{
@@ -292,6 +335,17 @@ class CConfigFileBase
 		MRPT_END
 	}
 	/** @} */
+
+   private:
+	struct ValuesCache;
+	mutable std::unique_ptr<ValuesCache> m_cache;
+	bool m_cacheSupported = false, m_cacheEnabled = true;
+
+	/** Looks up (or creates) the cache entry of a key, and applies `f` to it
+	 * with the cache locked. Returns false if the cache is not in use. */
+	template <class FUNCTOR>
+	bool withCacheEntry(
+		const std::string& section, const std::string& name, FUNCTOR f) const;
 };	// End of class def.
 
 /** An useful macro for loading variables stored in a INI-like file under a key
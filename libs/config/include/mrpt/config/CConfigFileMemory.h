@@ -86,6 +86,10 @@ class CConfigFileMemory : public CConfigFileBase
 		const std::string& defaultStr,
 		bool failIfNotFound = false) const override;
 
+	bool readStringIfExists(
+		const std::string& section, const std::string& name,
+		std::string& out) const override;
+
 };	// End of class def.
 
 }  // namespace mrpt::config
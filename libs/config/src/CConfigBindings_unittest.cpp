@@ -0,0 +1,90 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/config/CConfigBindings.h>
+#include <mrpt/config/CConfigFileMemory.h>
+#include <mrpt/typemeta/TEnumType.h>
+
+namespace
+{
+enum class TestMode
+{
+	Fast = 0,
+	Precise
+};
+}  // namespace
+
+MRPT_ENUM_TYPE_BEGIN(TestMode)
+MRPT_FILL_ENUM_MEMBER(TestMode, Fast);
+MRPT_FILL_ENUM_MEMBER(TestMode, Precise);
+MRPT_ENUM_TYPE_END()
+
+namespace
+{
+struct TestOptions
+{
+	double resolution = 0.1;
+	float maxAngle = 0.5f;
+	int n = 3;
+	unsigned int decimation = 1;
+	uint64_t bigNumber = 0;
+	bool enabled = false;
+	std::string file = "none";
+	TestMode mode = TestMode::Fast;
+	std::vector<double> weights{1.0};
+
+	void loadFromConfigFile(
+		const mrpt::config::CConfigFileBase& c, const std::string& s)
+	{
+		static const auto bindings =
+			mrpt::config::CConfigBindings<TestOptions>()
+				.bind("resolution", &TestOptions::resolution)
+				.bindDegrees("maxAngle_DEG", &TestOptions::maxAngle)
+				.bind("n", &TestOptions::n)
+				.bind("decimation", &TestOptions::decimation)
+				.bind("bigNumber", &TestOptions::bigNumber)
+				.bind("enabled", &TestOptions::enabled)
+				.bind("file", &TestOptions::file, true /*required*/)
+				.bind("mode", &TestOptions::mode)
+				.bind("weights", &TestOptions::weights);
+		bindings.load(c, s, *this);
+	}
+};
+}  // namespace
+
+TEST(CConfigBindings, load)
+{
+	mrpt::config::CConfigFileMemory cfg(
+		"[opts]\n"
+		"resolution = 0.05\n"
+		"maxAngle_DEG = 90\n"
+		"decimation = 4\n"
+		"bigNumber = 10000000000\n"
+		"enabled = true\n"
+		"file = map.txt  // comment\n"
+		"mode = Precise\n"
+		"weights = [0.5 0.25]\n");
+
+	TestOptions o;
+	o.loadFromConfigFile(cfg, "opts");
+	EXPECT_DOUBLE_EQ(o.resolution, 0.05);
+	EXPECT_NEAR(o.maxAngle, M_PI / 2, 1e-6);
+	EXPECT_EQ(o.n, 3);	// Not found: unchanged
+	EXPECT_EQ(o.decimation, 4U);
+	EXPECT_EQ(o.bigNumber, 10000000000ULL);
+	EXPECT_TRUE(o.enabled);
+	EXPECT_EQ(o.file, "map.txt");
+	EXPECT_EQ(o.mode, TestMode::Precise);
+	EXPECT_EQ(o.weights, std::vector<double>({0.5, 0.25}));
+
+	// Missing required key:
+	TestOptions o2;
+	EXPECT_THROW(o2.loadFromConfigFile(cfg, "other"), std::exception);
+}
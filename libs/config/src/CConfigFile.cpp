@@ -66,6 +66,7 @@ CConfigFile::CConfigFile(const std::string& fileName)
 {
 	MRPT_START
 
+	enableValuesCacheSupport();
 	m_file = fileName;
 	m_modified = false;
 
@@ -83,6 +84,7 @@ CConfigFile::CConfigFile() : m_impl(mrpt::make_impl<CConfigFile::Impl>())
 {
 	MRPT_START
 
+	enableValuesCacheSupport();
 	m_file = "";
 	m_modified = false;
 
@@ -99,6 +101,7 @@ void CConfigFile::setFileName(const std::string& fil_path)
 	m_file = fil_path;
 	m_modified = false;
 
+	invalidateValuesCache();
 	m_impl->ini->LoadFile(fil_path.c_str());
 	MRPT_END
 }
@@ -142,6 +145,7 @@ void CConfigFile::writeString(
 	MRPT_START
 
 	m_modified = true;
+	invalidateValuesCache();
 
 	if (0 > m_impl->ini->SetValue(
 				section.c_str(), name.c_str(), str.c_str(), nullptr))
@@ -173,17 +177,26 @@ std::string CConfigFile::readString(
 		THROW_EXCEPTION(tmpStr);
 	}
 
-	// Remove possible comments: "//"
 	std::string ret = aux;
-	size_t pos;
-	if ((pos = ret.find("//")) != string::npos && pos > 0 &&
-		isspace(ret[pos - 1]))
-		ret = ret.substr(0, pos);
+	stripValueComment(ret);
 	return ret;
 
 	MRPT_END
 }
 
+bool CConfigFile::readStringIfExists(
+	const std::string& section, const std::string& name,
+	std::string& out) const
+{
+	const char* aux = m_impl->ini->GetValue(
+		section.c_str(), name.c_str(), nullptr, nullptr);
+	if (!aux) return false;
+
+	out = aux;
+	stripValueComment(out);
+	return true;
+}
+
 /*---------------------------------------------------------------
 					 getAllSections
  ---------------------------------------------------------------*/
@@ -215,4 +228,8 @@ void CConfigFile::getAllKeys(
 		*s = n->pItem;
 }
 
-void CConfigFile::clear() { m_impl->ini->Reset(); }
+void CConfigFile::clear()
+{
+	invalidateValuesCache();
+	m_impl->ini->Reset();
+}
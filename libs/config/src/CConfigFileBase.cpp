@@ -16,7 +16,10 @@
 #include <mrpt/system/os.h>
 #include <mrpt/system/string_utils.h>
 
+#include <cctype>
 #include <cmath>  // abs()
+#include <mutex>
+#include <unordered_map>
 
 using namespace std;
 using namespace mrpt::config;
@@ -31,7 +34,163 @@ int mrpt::config::MRPT_SAVE_VALUE_PADDING()
 	return ::MRPT_SAVE_VALUE_PADDING;
 }
 
+struct CConfigFileBase::ValuesCache
+{
+	struct Entry
+	{
+		std::string section, name;
+		bool found = false;
+		/** As returned by readString() */
+		std::string value;
+
+		/** Parsed values: computed on first use */
+		enum : uint8_t
+		{
+			HAS_DOUBLE = 0x01,
+			HAS_INT = 0x02,
+			HAS_UINT64 = 0x04,
+			HAS_BOOL = 0x08,
+			HAS_TRIMMED = 0x10
+		};
+		uint8_t parsed = 0;
+		double d = 0;
+		int i = 0;
+		uint64_t u = 0;
+		bool b = false;
+		std::string trimmed;
+	};
+
+	std::mutex mtx;
+	/** Indexed by a case-insensitive hash of section and key names */
+	std::unordered_multimap<size_t, Entry> entries;
+
+	static size_t hash(const std::string& section, const std::string& name)
+	{
+		// FNV-1a:
+		size_t h = 14695981039346656037ULL & ~size_t(0);
+		const auto add = [&h](const std::string& s) {
+			for (const char c : s)
+			{
+				h ^= static_cast<unsigned char>(::tolower(c));
+				h *= 1099511628211ULL & ~size_t(0);
+			}
+		};
+		add(section);
+		h ^= 0xff;	// separator
+		add(name);
+		return h;
+	}
+};
+
+template <class FUNCTOR>
+bool CConfigFileBase::withCacheEntry(
+	const std::string& section, const std::string& name, FUNCTOR f) const
+{
+	if (!m_cache) return false;
+
+	std::lock_guard<std::mutex> lck(m_cache->mtx);
+	const size_t h = ValuesCache::hash(section, name);
+	auto range = m_cache->entries.equal_range(h);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		auto& e = it->second;
+		if (!os::_strcmpi(e.name.c_str(), name.c_str()) &&
+			!os::_strcmpi(e.section.c_str(), section.c_str()))
+		{
+			f(e);
+			return true;
+		}
+	}
+	// Not cached yet:
+	auto& e = m_cache->entries.emplace(h, ValuesCache::Entry())->second;
+	e.section = section;
+	e.name = name;
+	e.found = readStringIfExists(section, name, e.value);
+	f(e);
+	return true;
+}
+
+CConfigFileBase::CConfigFileBase() = default;
+CConfigFileBase::CConfigFileBase(const CConfigFileBase& o)
+	: m_cacheSupported(o.m_cacheSupported), m_cacheEnabled(o.m_cacheEnabled)
+{
+	if (o.m_cache) m_cache = std::make_unique<ValuesCache>();
+}
+CConfigFileBase& CConfigFileBase::operator=(const CConfigFileBase& o)
+{
+	if (this != &o)
+	{
+		m_cacheSupported = o.m_cacheSupported;
+		m_cacheEnabled = o.m_cacheEnabled;
+		m_cache.reset();
+		if (o.m_cache) m_cache = std::make_unique<ValuesCache>();
+	}
+	return *this;
+}
 CConfigFileBase::~CConfigFileBase() = default;
+
+void CConfigFileBase::enableValuesCacheSupport()
+{
+	m_cacheSupported = true;
+	setValuesCacheEnabled(m_cacheEnabled);
+}
+
+void CConfigFileBase::invalidateValuesCache()
+{
+	if (!m_cache) return;
+	std::lock_guard<std::mutex> lck(m_cache->mtx);
+	m_cache->entries.clear();
+}
+
+void CConfigFileBase::setValuesCacheEnabled(bool enabled)
+{
+	m_cacheEnabled = enabled;
+	// Created here, not on first use, so concurrent reads are safe:
+	if (enabled && m_cacheSupported && !m_cache)
+		m_cache = std::make_unique<ValuesCache>();
+	if (!enabled) m_cache.reset();
+}
+bool CConfigFileBase::isValuesCacheEnabled() const { return !!m_cache; }
+
+void CConfigFileBase::stripValueComment(std::string& value)
+{
+	const size_t pos = value.find("//");
+	if (pos != std::string::npos && pos > 0 && isspace(value[pos - 1]))
+		value.resize(pos);
+}
+
+bool CConfigFileBase::readStringIfExists(
+	const std::string& section, const std::string& name,
+	std::string& out) const
+{
+	// Not using keyExists(), which may call this method via the cache:
+	std::vector<std::string> keys;
+	getAllKeys(section, keys);
+	for (const auto& k : keys)
+	{
+		if (os::_strcmpi(name.c_str(), k.c_str())) continue;
+		out = readString(section, name, std::string());
+		return true;
+	}
+	return false;
+}
+
+std::string CConfigFileBase::readCachedString(
+	const std::string& section, const std::string& name,
+	const std::string& defaultStr, bool failIfNotFound) const
+{
+	std::string ret;
+	bool found = false;
+	if (withCacheEntry(section, name, [&](const ValuesCache::Entry& e) {
+			found = e.found;
+			if (found) ret = e.value;
+		}) &&
+		found)
+		return ret;
+
+	// Not cached, or not found: defaults and errors are handled here
+	return readString(section, name, defaultStr, failIfNotFound);
+}
 void CConfigFileBase::write(
 	const std::string& section, const std::string& name, double value,
 	const int name_padding_width, const int value_padding_width,
@@ -104,6 +263,22 @@ double CConfigFileBase::read_double(
 	const std::string& section, const std::string& name, double defaultValue,
 	bool failIfNotFound) const
 {
+	double ret = defaultValue;
+	bool found = false;
+	if (withCacheEntry(section, name, [&](ValuesCache::Entry& e) {
+			if (!(found = e.found)) return;
+			if (!(e.parsed & ValuesCache::Entry::HAS_DOUBLE))
+			{
+				e.d = atof(e.value.c_str());
+				e.parsed |= ValuesCache::Entry::HAS_DOUBLE;
+			}
+			ret = e.d;
+		}))
+	{
+		if (!found && failIfNotFound) readString(section, name, "", true);
+		return ret;
+	}
+
 	return atof(
 		readString(section, name, format("%.16e", defaultValue), failIfNotFound)
 			.c_str());
@@ -116,6 +291,10 @@ float CConfigFileBase::read_float(
 	const std::string& section, const std::string& name, float defaultValue,
 	bool failIfNotFound) const
 {
+	if (isValuesCacheEnabled())
+		return static_cast<float>(
+			read_double(section, name, defaultValue, failIfNotFound));
+
 	return (float)atof(
 		readString(section, name, format("%.10e", defaultValue), failIfNotFound)
 			.c_str());
@@ -128,6 +307,22 @@ int CConfigFileBase::read_int(
 	const std::string& section, const std::string& name, int defaultValue,
 	bool failIfNotFound) const
 {
+	int ret = defaultValue;
+	bool found = false;
+	if (withCacheEntry(section, name, [&](ValuesCache::Entry& e) {
+			if (!(found = e.found)) return;
+			if (!(e.parsed & ValuesCache::Entry::HAS_INT))
+			{
+				e.i = atoi(e.value.c_str());
+				e.parsed |= ValuesCache::Entry::HAS_INT;
+			}
+			ret = e.i;
+		}))
+	{
+		if (!found && failIfNotFound) readString(section, name, "", true);
+		return ret;
+	}
+
 	return atoi(
 		readString(section, name, format("%i", defaultValue), failIfNotFound)
 			.c_str());
@@ -140,6 +335,22 @@ uint64_t CConfigFileBase::read_uint64_t(
 	const std::string& section, const std::string& name, uint64_t defaultValue,
 	bool failIfNotFound) const
 {
+	uint64_t ret = defaultValue;
+	bool found = false;
+	if (withCacheEntry(section, name, [&](ValuesCache::Entry& e) {
+			if (!(found = e.found)) return;
+			if (!(e.parsed & ValuesCache::Entry::HAS_UINT64))
+			{
+				e.u = os::_strtoull(e.value.c_str(), nullptr, 0);
+				e.parsed |= ValuesCache::Entry::HAS_UINT64;
+			}
+			ret = e.u;
+		}))
+	{
+		if (!found && failIfNotFound) readString(section, name, "", true);
+		return ret;
+	}
+
 	string s = readString(
 		section, name, format("%lu", (long unsigned int)defaultValue),
 		failIfNotFound);
@@ -149,12 +360,9 @@ uint64_t CConfigFileBase::read_uint64_t(
 /*---------------------------------------------------------------
 					read_bool
  ---------------------------------------------------------------*/
-bool CConfigFileBase::read_bool(
-	const std::string& section, const std::string& name, bool defaultValue,
-	bool failIfNotFound) const
+static bool parse_bool(const std::string& str)
 {
-	const string s = mrpt::system::lowerCase(trim(readString(
-		section, name, string(defaultValue ? "1" : "0"), failIfNotFound)));
+	const string s = mrpt::system::lowerCase(trim(str));
 	if (s == "true") return true;
 	if (s == "false") return false;
 	if (s == "yes") return true;
@@ -162,6 +370,30 @@ bool CConfigFileBase::read_bool(
 	return (0 != atoi(s.c_str()));
 }
 
+bool CConfigFileBase::read_bool(
+	const std::string& section, const std::string& name, bool defaultValue,
+	bool failIfNotFound) const
+{
+	bool ret = defaultValue;
+	bool found = false;
+	if (withCacheEntry(section, name, [&](ValuesCache::Entry& e) {
+			if (!(found = e.found)) return;
+			if (!(e.parsed & ValuesCache::Entry::HAS_BOOL))
+			{
+				e.b = parse_bool(e.value);
+				e.parsed |= ValuesCache::Entry::HAS_BOOL;
+			}
+			ret = e.b;
+		}))
+	{
+		if (!found && failIfNotFound) readString(section, name, "", true);
+		return ret;
+	}
+
+	return parse_bool(readString(
+		section, name, string(defaultValue ? "1" : "0"), failIfNotFound));
+}
+
 /*---------------------------------------------------------------
 					read_string
  ---------------------------------------------------------------*/
@@ -169,6 +401,20 @@ std::string CConfigFileBase::read_string(
 	const std::string& section, const std::string& name,
 	const std::string& defaultValue, bool failIfNotFound) const
 {
+	std::string ret;
+	bool found = false;
+	if (withCacheEntry(section, name, [&](ValuesCache::Entry& e) {
+			if (!(found = e.found)) return;
+			if (!(e.parsed & ValuesCache::Entry::HAS_TRIMMED))
+			{
+				e.trimmed = mrpt::system::trim(e.value);
+				e.parsed |= ValuesCache::Entry::HAS_TRIMMED;
+			}
+			ret = e.trimmed;
+		}) &&
+		found)
+		return ret;
+
 	return mrpt::system::trim(
 		readString(section, name, defaultValue, failIfNotFound));
 }
@@ -180,7 +426,7 @@ std::string CConfigFileBase::read_string_first_word(
 	const std::string& section, const std::string& name,
 	const std::string& defaultValue, bool failIfNotFound) const
 {
-	string s = readString(section, name, defaultValue, failIfNotFound);
+	string s = readCachedString(section, name, defaultValue, failIfNotFound);
 	std::vector<std::string> auxStrs;
 	mrpt::system::tokenize(s, "[], \t", auxStrs);
 	if (auxStrs.empty())
@@ -212,6 +458,12 @@ bool CConfigFileBase::sectionExists(const std::string& section_name) const
 bool CConfigFileBase::keyExists(
 	const std::string& section, const std::string& key) const
 {
+	bool found = false;
+	if (withCacheEntry(section, key, [&](const ValuesCache::Entry& e) {
+			found = e.found;
+		}))
+		return found;
+
 	std::vector<std::string> keys;
 	getAllKeys(section, keys);
 	for (auto& k : keys)
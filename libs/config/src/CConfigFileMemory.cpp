@@ -41,6 +41,7 @@ struct CConfigFileMemory::Impl
 CConfigFileMemory::CConfigFileMemory(const std::vector<std::string>& stringList)
 	: m_impl(mrpt::make_impl<CConfigFileMemory::Impl>())
 {
+	enableValuesCacheSupport();
 	// Load the strings:
 	setContent(stringList);
 }
@@ -48,6 +49,7 @@ CConfigFileMemory::CConfigFileMemory(const std::vector<std::string>& stringList)
 CConfigFileMemory::CConfigFileMemory(const std::string& str)
 	: m_impl(mrpt::make_impl<CConfigFileMemory::Impl>())
 {
+	enableValuesCacheSupport();
 	setContent(str);
 }
 
@@ -57,6 +59,7 @@ CConfigFileMemory::CConfigFileMemory(const std::string& str)
 CConfigFileMemory::CConfigFileMemory()
 	: m_impl(mrpt::make_impl<CConfigFileMemory::Impl>())
 {
+	enableValuesCacheSupport();
 }
 
 void CConfigFileMemory::setContent(const std::vector<std::string>& stringList)
@@ -65,12 +68,14 @@ void CConfigFileMemory::setContent(const std::vector<std::string>& stringList)
 	std::string aux;
 	mrpt::system::stringListAsString(stringList, aux);
 	const auto sOut = mrpt::config::config_parser(aux);
+	invalidateValuesCache();
 	m_impl->ini->LoadData(sOut);
 }
 
 void CConfigFileMemory::setContent(const std::string& str)
 {
 	const auto sOut = mrpt::config::config_parser(str);
+	invalidateValuesCache();
 	m_impl->ini->LoadData(sOut);
 }
 
@@ -85,6 +90,7 @@ void CConfigFileMemory::writeString(
 {
 	MRPT_START
 
+	invalidateValuesCache();
 	SI_Error ret = m_impl->ini->SetValue(
 		section.c_str(), name.c_str(), str.c_str(), nullptr);
 	if (ret < 0) THROW_EXCEPTION("Error changing value in INI-style file!");
@@ -112,16 +118,25 @@ std::string CConfigFileMemory::readString(
 		THROW_EXCEPTION(tmpStr);
 	}
 
-	// Remove possible comments: "//"
 	std::string ret = aux;
-	size_t pos;
-	if ((pos = ret.find("//")) != string::npos && pos > 0 &&
-		isspace(ret[pos - 1]))
-		ret = ret.substr(0, pos);
+	stripValueComment(ret);
 	return ret;
 	MRPT_END
 }
 
+bool CConfigFileMemory::readStringIfExists(
+	const std::string& section, const std::string& name,
+	std::string& out) const
+{
+	const char* aux = m_impl->ini->GetValue(
+		section.c_str(), name.c_str(), nullptr, nullptr);
+	if (!aux) return false;
+
+	out = aux;
+	stripValueComment(out);
+	return true;
+}
+
 void CConfigFileMemory::getAllSections(std::vector<std::string>& sections) const
 {
 	CSimpleIniA::TNamesDepend names;
@@ -147,4 +162,8 @@ void CConfigFileMemory::getAllKeys(
 		*s = n->pItem;
 }
 
-void CConfigFileMemory::clear() { m_impl->ini->Reset(); }
+void CConfigFileMemory::clear()
+{
+	invalidateValuesCache();
+	m_impl->ini->Reset();
+}
@@ -145,3 +145,62 @@ TEST(CConfigFileMemory, parseVariables)
 	EXPECT_NEAR(cfg.read_double("test", "var6", .0), 2.0, 1e-6);
 	EXPECT_EQ(cfg.read_string("test", "varstr1", ""), std::string("MAXSPEED"));
 }
+
+TEST(CConfigFileMemory, valuesCache)
+{
+	const std::string txt =
+		"[test]\n"
+		"d = 1e3 // a comment\n"
+		"b = yes\n"
+		"u = 0x10\n"
+		"s =  some text  \n"
+		"v = [1 2 3]\n";
+
+	// Same results with and without cache:
+	for (const bool useCache : {false, true})
+	{
+		mrpt::config::CConfigFileMemory cfg(txt);
+		cfg.setValuesCacheEnabled(useCache);
+		EXPECT_EQ(cfg.isValuesCacheEnabled(), useCache);
+
+		for (int pass = 0; pass < 2; pass++)
+		{
+			EXPECT_DOUBLE_EQ(cfg.read_double("test", "d", 0), 1000.0);
+			EXPECT_FLOAT_EQ(cfg.read_float("TEST", "D", 0), 1000.0f);
+			EXPECT_EQ(cfg.read_int("test", "d", 0), 1);
+			EXPECT_TRUE(cfg.read_bool("test", "b", false));
+			EXPECT_EQ(cfg.read_uint64_t("test", "u", 0), 16U);
+			EXPECT_EQ(cfg.read_string("test", "s", ""), "some text");
+			EXPECT_EQ(cfg.read_string_first_word("test", "s", ""), "some");
+			std::vector<int> v;
+			cfg.read_vector("test", "v", std::vector<int>(), v);
+			EXPECT_EQ(v, std::vector<int>({1, 2, 3}));
+
+			// Defaults:
+			EXPECT_DOUBLE_EQ(cfg.read_double("test", "x", 0.1), 0.1);
+			EXPECT_FLOAT_EQ(cfg.read_float("test", "x", 0.1f), 0.1f);
+			EXPECT_EQ(cfg.read_int("test", "x", -3), -3);
+			EXPECT_EQ(cfg.read_uint64_t("test", "x", 7), 7U);
+			EXPECT_EQ(cfg.read_string("test", "x", " def "), "def");
+			EXPECT_THROW(cfg.read_double("test", "x", 0, true), std::exception);
+			EXPECT_THROW(cfg.read_int("test", "x", 0, true), std::exception);
+			EXPECT_THROW(
+				cfg.read_string("test", "x", "", true), std::exception);
+
+			EXPECT_TRUE(cfg.keyExists("Test", "U"));
+			EXPECT_FALSE(cfg.keyExists("test", "x"));
+		}
+
+		// Changes are visible:
+		cfg.write("test", "d", 2.5);
+		EXPECT_DOUBLE_EQ(cfg.read_double("test", "d", 0), 2.5);
+		cfg.write("test", "x", 4);
+		EXPECT_TRUE(cfg.keyExists("test", "x"));
+		EXPECT_EQ(cfg.read_int("test", "x", 0), 4);
+		cfg.setContent(std::string("[test]\nd=-1\n"));
+		EXPECT_EQ(cfg.read_int("test", "d", 0), -1);
+		cfg.clear();
+		EXPECT_EQ(cfg.read_int("test", "d", 0), 0);
+		EXPECT_FALSE(cfg.keyExists("test", "x"));
+	}
+}
@@ -0,0 +1,490 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace mrpt::containers
+{
+namespace internal
+{
+/** Default hash functor of concurrent_hash_map: std::hash<KEY>, except for
+ * std::string keys, which are hashed as std::string_view so they can be
+ * looked up from string views and literals without allocating strings. */
+template <typename KEY>
+struct concurrent_hash : std::hash<KEY>
+{
+};
+template <>
+struct concurrent_hash<std::string>
+{
+	size_t operator()(std::string_view s) const noexcept
+	{
+		return std::hash<std::string_view>()(s);
+	}
+};
+}  // namespace internal
+
+/** A thread-safe hash map, split into `NUM_SHARDS` independent shards (chosen
+ * from the hash of each key), each one with its own reader-writer lock, so
+ * threads accessing different shards never contend and any number of threads
+ * may read from the same shard at once. Each shard is a separate-chaining
+ * hash table which grows as needed, so, unlike ts_hash_map, there is no limit
+ * in the number of elements or of hash collisions.
+ *
+ * Lookups may use any key type accepted by `HASH` and comparable to `KEY`,
+ * e.g. a `std::string_view` for a map with `std::string` keys.
+ *
+ * Elements are stored in separate nodes, so pointers returned by
+ * find_or_alloc() and find_ptr() remain valid while the map grows, until the
+ * element is erased or the map cleared. Note that the map only protects its
+ * own structure: accesses to values through those pointers must be
+ * synchronized by the user. The methods find(), visit(), update() and
+ * get_or_insert() do run under the shard lock, hence they are the safe way to
+ * share values like cached computation results between threads.
+ *
+ *  Usage example:
+ *
+ * \code
+ * mrpt::containers::concurrent_hash_map<std::string, double> cache;
+ *
+ * // Any thread:
+ * const double v = cache.get_or_insert("key", []() { return compute(); });
+ * if (auto val = cache.find("other"); val) { ... }
+ * cache.update("key", [](double& v) { v += 1.0; });
+ * \endcode
+ *
+ * \note Defined in #include <mrpt/containers/concurrent_hash_map.h>
+ * \ingroup mrpt_containers_grp
+ */
+template <
+	typename KEY, typename VALUE,
+	typename HASH = internal::concurrent_hash<KEY>, size_t NUM_SHARDS = 16>
+class concurrent_hash_map
+{
+	static_assert(
+		NUM_SHARDS > 0 && (NUM_SHARDS & (NUM_SHARDS - 1)) == 0,
+		"NUM_SHARDS must be a power of 2");
+
+   public:
+	/** @name Types
+		@{ */
+	using key_type = KEY;
+	using mapped_type = VALUE;
+	using hasher = HASH;
+	/** @} */
+
+	/** @name Constructors and general operations
+		@{ */
+	/** Default constructor. Optionally, reserve space for `expectedSize`
+	 * elements */
+	explicit concurrent_hash_map(size_t expectedSize = 0)
+	{
+		if (expectedSize) reserve(expectedSize);
+	}
+	~concurrent_hash_map() { clear(); }
+
+	concurrent_hash_map(const concurrent_hash_map& o) { *this = o; }
+	concurrent_hash_map(concurrent_hash_map&& o) { *this = std::move(o); }
+
+	concurrent_hash_map& operator=(const concurrent_hash_map& o)
+	{
+		if (this == &o) return *this;
+		clear();
+		for (size_t s = 0; s < NUM_SHARDS; s++)
+		{
+			const Shard& src = o.m_shards[s];
+			Shard& dst = m_shards[s];
+			std::shared_lock<std::shared_mutex> lckSrc(src.mtx);
+			std::unique_lock<std::shared_mutex> lckDst(dst.mtx);
+			dst.rehash(src.buckets.size());
+			for (const Node* n : src.buckets)
+				for (; n; n = n->next)
+					dst.link(new Node(n->hash, n->kv.first, n->kv.second));
+		}
+		return *this;
+	}
+	concurrent_hash_map& operator=(concurrent_hash_map&& o)
+	{
+		if (this == &o) return *this;
+		clear();
+		for (size_t s = 0; s < NUM_SHARDS; s++)
+		{
+			Shard& src = o.m_shards[s];
+			Shard& dst = m_shards[s];
+			std::unique_lock<std::shared_mutex> lckSrc(src.mtx);
+			std::unique_lock<std::shared_mutex> lckDst(dst.mtx);
+			std::swap(dst.buckets, src.buckets);
+			std::swap(dst.count, src.count);
+		}
+		return *this;
+	}
+
+	/** Returns the number of elements. If other threads are modifying the
+	 * map, this is only a snapshot. */
+	size_t size() const
+	{
+		size_t n = 0;
+		for (const Shard& s : m_shards)
+		{
+			std::shared_lock<std::shared_mutex> lck(s.mtx);
+			n += s.count;
+		}
+		return n;
+	}
+	bool empty() const { return size() == 0; }
+
+	/** Removes all elements */
+	void clear()
+	{
+		for (Shard& s : m_shards)
+		{
+			std::unique_lock<std::shared_mutex> lck(s.mtx);
+			s.destroyAll();
+		}
+	}
+
+	/** Preallocates buckets for `n` elements in total, to avoid rehashing
+	 * while the map grows */
+	void reserve(size_t n)
+	{
+		const size_t perShard = (n + NUM_SHARDS - 1) / NUM_SHARDS;
+		for (Shard& s : m_shards)
+		{
+			std::unique_lock<std::shared_mutex> lck(s.mtx);
+			s.rehash(perShard);
+		}
+	}
+	/** @} */
+
+	/** @name Read access (shared locks)
+		@{ */
+	template <typename K>
+	bool contains(const K& key) const
+	{
+		const size_t h = hashOf(key);
+		const Shard& s = shardOf(h);
+		std::shared_lock<std::shared_mutex> lck(s.mtx);
+		return s.lookup(h, key) != nullptr;
+	}
+
+	/** Returns a copy of the value associated to `key`, or an empty optional
+	 * if there is no such key */
+	template <typename K>
+	std::optional<VALUE> find(const K& key) const
+	{
+		const size_t h = hashOf(key);
+		const Shard& s = shardOf(h);
+		std::shared_lock<std::shared_mutex> lck(s.mtx);
+		if (const Node* n = s.lookup(h, key); n) return n->kv.second;
+		return std::nullopt;
+	}
+
+	/** Calls `f(const VALUE&)` with the value associated to `key`, while
+	 * holding a shared lock of its shard. Returns false (without calling `f`)
+	 * if there is no such key. */
+	template <typename K, typename F>
+	bool visit(const K& key, F&& f) const
+	{
+		const size_t h = hashOf(key);
+		const Shard& s = shardOf(h);
+		std::shared_lock<std::shared_mutex> lck(s.mtx);
+		const Node* n = s.lookup(h, key);
+		if (!n) return false;
+		f(n->kv.second);
+		return true;
+	}
+
+	/** Returns a pointer to the value associated to `key`, or nullptr. See
+	 * notes on pointer validity in the class description. */
+	template <typename K>
+	const VALUE* find_ptr(const K& key) const
+	{
+		const size_t h = hashOf(key);
+		const Shard& s = shardOf(h);
+		std::shared_lock<std::shared_mutex> lck(s.mtx);
+		const Node* n = s.lookup(h, key);
+		return n ? &n->kv.second : nullptr;
+	}
+
+	/** Calls `f(const KEY&, const VALUE&)` for all elements, shard by shard,
+	 * holding the shared lock of each shard meanwhile. */
+	template <typename F>
+	void for_each(F&& f) const
+	{
+		for (const Shard& s : m_shards)
+		{
+			std::shared_lock<std::shared_mutex> lck(s.mtx);
+			for (const Node* n : s.buckets)
+				for (; n; n = n->next)
+					f(n->kv.first, n->kv.second);
+		}
+	}
+	/** @} */
+
+	/** @name Write access (exclusive locks)
+		@{ */
+	/** Inserts a new element. Returns false, leaving the map unmodified, if
+	 * the key already exists. */
+	template <typename K, typename V>
+	bool insert(const K& key, V&& value)
+	{
+		const size_t h = hashOf(key);
+		Shard& s = shardOf(h);
+		std::unique_lock<std::shared_mutex> lck(s.mtx);
+		if (s.lookup(h, key)) return false;
+		s.insert(new Node(h, KEY(key), std::forward<V>(value)));
+		return true;
+	}
+
+	/** Inserts a new element or overwrites the value of an existing key.
+	 * Returns true if a new element was inserted. */
+	template <typename K, typename V>
+	bool insert_or_assign(const K& key, V&& value)
+	{
+		const size_t h = hashOf(key);
+		Shard& s = shardOf(h);
+		std::unique_lock<std::shared_mutex> lck(s.mtx);
+		if (Node* n = s.lookup(h, key); n)
+		{
+			n->kv.second = std::forward<V>(value);
+			return false;
+		}
+		s.insert(new Node(h, KEY(key), std::forward<V>(value)));
+		return true;
+	}
+
+	/** Returns (a copy of) the value of `key`, first inserting the result of
+	 * `factory()` if it does not exist yet. The common case of the key being
+	 * found only takes a shared lock. `factory()` is called without holding
+	 * any lock, so several threads may compute the value of the same new key
+	 * concurrently, but only the first one to finish is inserted and returned
+	 * to all of them. */
+	template <typename K, typename F>
+	VALUE get_or_insert(const K& key, F&& factory)
+	{
+		const size_t h = hashOf(key);
+		Shard& s = shardOf(h);
+		{
+			std::shared_lock<std::shared_mutex> lck(s.mtx);
+			if (const Node* n = s.lookup(h, key); n) return n->kv.second;
+		}
+		VALUE v = factory();
+		std::unique_lock<std::shared_mutex> lck(s.mtx);
+		if (const Node* n = s.lookup(h, key); n) return n->kv.second;
+		return s.insert(new Node(h, KEY(key), std::move(v)))->kv.second;
+	}
+
+	/** Returns a pointer to the value of `key`, inserting a default
+	 * constructed value if it does not exist yet. See notes on pointer
+	 * validity in the class description. Never returns nullptr (the signature
+	 * mimics that of ts_hash_map) */
+	template <typename K>
+	VALUE* find_or_alloc(const K& key)
+	{
+		const size_t h = hashOf(key);
+		Shard& s = shardOf(h);
+		{
+			std::shared_lock<std::shared_mutex> lck(s.mtx);
+			if (Node* n = s.lookup(h, key); n) return &n->kv.second;
+		}
+		std::unique_lock<std::shared_mutex> lck(s.mtx);
+		if (Node* n = s.lookup(h, key); n) return &n->kv.second;
+		return &s.insert(new Node(h, KEY(key), VALUE()))->kv.second;
+	}
+
+	/** Calls `f(VALUE&)` with the value associated to `key`, while holding
+	 * the exclusive lock of its shard. Returns false (without calling `f`) if
+	 * there is no such key. */
+	template <typename K, typename F>
+	bool update(const K& key, F&& f)
+	{
+		const size_t h = hashOf(key);
+		Shard& s = shardOf(h);
+		std::unique_lock<std::shared_mutex> lck(s.mtx);
+		Node* n = s.lookup(h, key);
+		if (!n) return false;
+		f(n->kv.second);
+		return true;
+	}
+
+	/** Removes an element. Returns false if the key did not exist. */
+	template <typename K>
+	bool erase(const K& key)
+	{
+		const size_t h = hashOf(key);
+		Shard& s = shardOf(h);
+		std::unique_lock<std::shared_mutex> lck(s.mtx);
+		return s.erase(h, key);
+	}
+
+	/** Calls `f(const KEY&, VALUE&)` for all elements, shard by shard,
+	 * holding the exclusive lock of each shard meanwhile. */
+	template <typename F>
+	void for_each(F&& f)
+	{
+		for (Shard& s : m_shards)
+		{
+			std::unique_lock<std::shared_mutex> lck(s.mtx);
+			for (Node* n : s.buckets)
+				for (; n; n = n->next)
+					f(n->kv.first, n->kv.second);
+		}
+	}
+	/** @} */
+
+   private:
+	struct Node
+	{
+		template <typename V>
+		Node(size_t h, KEY&& k, V&& v)
+			: hash(h), kv(std::move(k), std::forward<V>(v))
+		{
+		}
+		Node(size_t h, const KEY& k, const VALUE& v) : hash(h), kv(k, v) {}
+
+		size_t hash;
+		std::pair<const KEY, VALUE> kv;
+		Node* next = nullptr;
+	};
+
+	/** Max. average number of elements per bucket */
+	constexpr static size_t MAX_LOAD_FACTOR = 1;
+	constexpr static size_t MIN_BUCKETS = 8;
+
+	// Aligned to a cache line, so locking a shard does not invalidate the
+	// cached mutex of its neighbors in other cores:
+	struct alignas(64) Shard
+	{
+		mutable std::shared_mutex mtx;
+		/** Number of buckets: always 0 or a power of 2 */
+		std::vector<Node*> buckets;
+		size_t count = 0;
+
+		template <typename K>
+		Node* lookup(size_t h, const K& key) const
+		{
+			if (buckets.empty()) return nullptr;
+			for (Node* n = buckets[bucketOf(h, buckets.size())]; n; n = n->next)
+				if (n->hash == h && n->kv.first == key) return n;
+			return nullptr;
+		}
+
+		Node* insert(Node* n)
+		{
+			if (count + 1 > buckets.size() * MAX_LOAD_FACTOR)
+				rehash(count + 1);
+			link(n);
+			return n;
+		}
+
+		/** Inserts a node without checking the load factor */
+		void link(Node* n)
+		{
+			auto& b = buckets[bucketOf(n->hash, buckets.size())];
+			n->next = b;
+			b = n;
+			count++;
+		}
+
+		template <typename K>
+		bool erase(size_t h, const K& key)
+		{
+			if (buckets.empty()) return false;
+			for (Node** p = &buckets[bucketOf(h, buckets.size())]; *p;
+				 p = &(*p)->next)
+			{
+				if ((*p)->hash != h || !((*p)->kv.first == key)) continue;
+				Node* n = *p;
+				*p = n->next;
+				delete n;
+				count--;
+				return true;
+			}
+			return false;
+		}
+
+		/** Ensures there are enough buckets for `n` elements */
+		void rehash(size_t n)
+		{
+			size_t nb = buckets.empty() ? MIN_BUCKETS : buckets.size();
+			while (nb * MAX_LOAD_FACTOR < n)
+				nb *= 2;
+			if (nb == buckets.size()) return;
+
+			std::vector<Node*> newBuckets(nb, nullptr);
+			for (Node* n : buckets)
+			{
+				while (n)
+				{
+					Node* next = n->next;
+					auto& b = newBuckets[bucketOf(n->hash, nb)];
+					n->next = b;
+					b = n;
+					n = next;
+				}
+			}
+			buckets = std::move(newBuckets);
+		}
+
+		void destroyAll()
+		{
+			for (Node* n : buckets)
+			{
+				while (n)
+				{
+					Node* next = n->next;
+					delete n;
+					n = next;
+				}
+			}
+			buckets.clear();
+			count = 0;
+		}
+	};
+
+	std::array<Shard, NUM_SHARDS> m_shards;
+
+	/** Mixes the bits of the user hash, since std::hash<> of integers is
+	 * usually the identity. The upper half of the bits selects the shard, the
+	 * lower one the bucket within the shard. */
+	template <typename K>
+	static size_t hashOf(const K& key)
+	{
+		uint64_t h = static_cast<uint64_t>(HASH()(key));
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		return static_cast<size_t>(h);
+	}
+	static size_t bucketOf(size_t h, size_t numBuckets)
+	{
+		return h & (numBuckets - 1);
+	}
+	const Shard& shardOf(size_t h) const
+	{
+		return m_shards[(h >> (sizeof(size_t) * 4)) & (NUM_SHARDS - 1)];
+	}
+	Shard& shardOf(size_t h)
+	{
+		return m_shards[(h >> (sizeof(size_t) * 4)) & (NUM_SHARDS - 1)];
+	}
+};
+
+}  // namespace mrpt::containers
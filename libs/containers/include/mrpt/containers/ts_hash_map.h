@@ -67,6 +67,9 @@ void reduced_hash(const std::string_view& value, uint64_t& hash);
  *  standard vector<> or to a deque<> (to avoid memory reallocations) by
  * changing the template parameter \a VECTOR_T.
  *
+ * \sa concurrent_hash_map, which has no limit in the number of elements and
+ * allows concurrent writers.
+ *
  * \note Defined in #include <mrpt/containers/ts_hash_map.h>
  * \ingroup mrpt_containers_grp
  */
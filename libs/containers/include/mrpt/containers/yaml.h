@@ -183,15 +183,17 @@ class yaml
 
 		const std::string_view internalAsStr() const
 		{
-			ASSERT_(isScalar());
-			if (const char* const* s = std::any_cast<const char*>(&asScalar());
+			const scalar_t* sc = std::get_if<scalar_t>(&d);
+			ASSERT_(sc != nullptr);
+			// Most common case first (keys loaded from YAML text):
+			if (const std::string* s = std::any_cast<std::string>(sc);
 				s != nullptr)
 			{ return {*s}; }
-			if (const std::string* s = std::any_cast<std::string>(&asScalar());
+			if (const char* const* s = std::any_cast<const char*>(sc);
 				s != nullptr)
 			{ return {*s}; }
 			if (const std::string_view* s =
-					std::any_cast<std::string_view>(&asScalar());
+					std::any_cast<std::string_view>(sc);
 				s != nullptr)
 			{ return {*s}; }
 			THROW_EXCEPTION_FMT(
@@ -479,7 +481,7 @@ class yaml
 				n->typeName().c_str());
 
 		const map_t& m = std::get<map_t>(n->d);
-		auto it = m.find(key);
+		auto it = internalFindKey(m, key);
 		if (m.end() == it) return defaultValue;
 		try
 		{
@@ -537,6 +539,11 @@ class yaml
 	const node_t* dereferenceProxy() const;
 	node_t* dereferenceProxy();
 
+	/** Looks up `key` in `m` without copying it into a temporary node_t */
+	static map_t::const_iterator internalFindKey(
+		const map_t& m, const std::string& key);
+	static map_t::iterator internalFindKey(map_t& m, const std::string& key);
+
 	explicit yaml(
 		internal::tag_as_proxy_t, node_t& val, const std::string& name)
 		: isProxy_(true),
@@ -1099,6 +1106,15 @@ inline bool operator<(const yaml::node_t& lhs, const yaml::node_t& rhs)
 
 namespace mrpt::containers::internal
 {
+/** Parses `s` if it is a plain decimal number (e.g. `-1.5e3`, but not hex,
+ * `inf`, `nan`, or with any extra character), with the same result than
+ * reading it from a std::istream, but faster.
+ * \return false if `s` is not such a number, or it is out of range.
+ */
+bool parsePlainDecimal(const std::string& s, double& val);
+/** \overload */
+bool parsePlainDecimal(const std::string& s, float& val);
+
 template <typename T>
 T implAnyAsGetter(const mrpt::containers::yaml::scalar_t& s)
 {
@@ -1116,9 +1132,13 @@ T implAnyAsGetter(const mrpt::containers::yaml::scalar_t& s)
 		else if (storedType == typeid(float))
 			return static_cast<T>(implAnyAsGetter<float>(s));
 
+		T ret;
+		if (const auto* str = std::any_cast<std::string>(&s);
+			str && parsePlainDecimal(*str, ret))
+			return ret;
+
 		std::stringstream ss;
 		yaml::internalPrintAsYAML(s, ss, {}, {});
-		T ret;
 		ss >> ret;
 		if (!ss.fail()) return ret;
 	}
@@ -1126,9 +1146,18 @@ T implAnyAsGetter(const mrpt::containers::yaml::scalar_t& s)
 	// 3) Integers. Recognize hex or octal prefixes with strtol()
 	if constexpr (std::is_convertible_v<int, T>)
 	{
-		std::stringstream ss;
-		yaml::internalPrintAsYAML(s, ss, {}, {});
-		const std::string str = ss.str();
+		// Single-line strings are printed as they are: skip printing them.
+		const std::string* strPtr = std::any_cast<std::string>(&s);
+		std::string printed;
+		if (!strPtr || strPtr->empty() ||
+			strPtr->find('\n') != std::string::npos)
+		{
+			std::stringstream ss;
+			yaml::internalPrintAsYAML(s, ss, {}, {});
+			printed = ss.str();
+			strPtr = &printed;
+		}
+		const std::string& str = *strPtr;
 
 		char* retStr = nullptr;
 		const long long ret =
@@ -0,0 +1,135 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/containers/concurrent_hash_map.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+TEST(concurrent_hash_map, stdstring_key)
+{
+	mrpt::containers::concurrent_hash_map<std::string, double> m;
+
+	EXPECT_TRUE(m.empty());
+	EXPECT_TRUE(m.insert("uno", 1.0));
+	EXPECT_FALSE(m.insert("uno", 10.0));
+	EXPECT_TRUE(m.insert(std::string("dos"), 2.0));
+	EXPECT_TRUE(m.insert_or_assign("tres", 0.0));
+	EXPECT_FALSE(m.insert_or_assign("tres", 3.0));
+	EXPECT_EQ(m.size(), 3U);
+
+	EXPECT_EQ(*m.find("uno"), 1.0);
+	EXPECT_EQ(*m.find(std::string_view("dos")), 2.0);
+	EXPECT_EQ(*m.find(std::string("tres")), 3.0);
+	EXPECT_FALSE(m.find("pepe").has_value());
+	EXPECT_TRUE(m.contains("uno"));
+	EXPECT_FALSE(m.contains("pepe"));
+
+	EXPECT_TRUE(m.update("tres", [](double& v) { v++; }));
+	EXPECT_FALSE(m.update("pepe", [](double& v) { v++; }));
+	double val = 0;
+	EXPECT_TRUE(m.visit("tres", [&](const double& v) { val = v; }));
+	EXPECT_EQ(val, 4.0);
+
+	*m.find_or_alloc("cuatro") = 4.0;
+	EXPECT_EQ(*m.find_ptr("cuatro"), 4.0);
+	EXPECT_EQ(m.find_ptr("pepe"), nullptr);
+
+	EXPECT_EQ(m.get_or_insert("uno", []() { return 100.0; }), 1.0);
+	EXPECT_EQ(m.get_or_insert("cinco", []() { return 5.0; }), 5.0);
+
+	double sum = 0;
+	m.for_each([&](const std::string&, const double& v) { sum += v; });
+	EXPECT_NEAR(sum, 1.0 + 2.0 + 4.0 + 4.0 + 5.0, 1e-10);
+
+	EXPECT_TRUE(m.erase("dos"));
+	EXPECT_FALSE(m.erase("dos"));
+	EXPECT_FALSE(m.contains("dos"));
+	EXPECT_EQ(m.size(), 4U);
+
+	m.clear();
+	EXPECT_TRUE(m.empty());
+	EXPECT_FALSE(m.contains("uno"));
+}
+
+TEST(concurrent_hash_map, growth_and_copies)
+{
+	mrpt::containers::concurrent_hash_map<int, int, std::hash<int>, 4> m;
+	const int N = 20000;
+
+	const int* p0 = nullptr;
+	for (int i = 0; i < N; i++)
+	{
+		int* p = m.find_or_alloc(i);
+		*p = 2 * i;
+		if (i == 0) p0 = p;
+	}
+	EXPECT_EQ(m.size(), static_cast<size_t>(N));
+	// Values do not move while the map grows:
+	EXPECT_EQ(m.find_ptr(0), p0);
+	for (int i = 0; i < N; i++)
+		EXPECT_EQ(*m.find(i), 2 * i);
+
+	for (int i = 0; i < N; i += 2)
+		EXPECT_TRUE(m.erase(i));
+	EXPECT_EQ(m.size(), static_cast<size_t>(N / 2));
+
+	auto m2 = m;
+	m.clear();
+	EXPECT_EQ(m2.size(), static_cast<size_t>(N / 2));
+	for (int i = 0; i < N; i++)
+		EXPECT_EQ(m2.contains(i), i % 2 == 1);
+
+	auto m3 = std::move(m2);
+	EXPECT_TRUE(m2.empty());
+	EXPECT_EQ(m3.size(), static_cast<size_t>(N / 2));
+	EXPECT_EQ(*m3.find(N - 1), 2 * (N - 1));
+}
+
+TEST(concurrent_hash_map, concurrent_readers_writers)
+{
+	mrpt::containers::concurrent_hash_map<std::string, int> m;
+	const int nThreads = 4, nKeys = 2000;
+	std::atomic<int> nFactoryCalls{0}, nWrongValues{0};
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < nThreads; t++)
+	{
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < nKeys; i++)
+			{
+				// All threads try to create the same keys:
+				const std::string key = "key" + std::to_string(i);
+				const int v = m.get_or_insert(key, [&]() {
+					nFactoryCalls++;
+					return i;
+				});
+				if (v != i) nWrongValues++;
+				m.update(key, [](int& x) { x += 0; });
+
+				// ...and each one also writes its own ones:
+				const std::string own =
+					"t" + std::to_string(t) + "_" + std::to_string(i);
+				m.insert_or_assign(own, t);
+				if (m.find(own).value_or(-1) != t) nWrongValues++;
+				if (i % 2) m.erase(own);
+			}
+		});
+	}
+	for (auto& t : threads)
+		t.join();
+
+	EXPECT_EQ(nWrongValues, 0);
+	EXPECT_GE(nFactoryCalls, nKeys);
+	EXPECT_EQ(m.size(), static_cast<size_t>(nKeys + nThreads * nKeys / 2));
+	for (int i = 0; i < nKeys; i++)
+		EXPECT_EQ(*m.find("key" + std::to_string(i)), i);
+}
@@ -15,6 +15,9 @@
 #include <mrpt/core/get_env.h>
 
 #include <algorithm>
+#include <cerrno>
+#include <clocale>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <istream>
@@ -182,7 +185,7 @@ bool yaml::has(const std::string& key) const
 {
 	if (isNullNode()) return false;
 	const map_t& m = this->asMap();
-	return m.end() != m.find(key);
+	return m.end() != internalFindKey(m, key);
 }
 
 const std::type_info& yaml::scalarType() const
@@ -222,6 +225,70 @@ yaml::node_t* yaml::dereferenceProxy()
 	MRPT_END
 }
 
+template <typename T>
+static bool implParsePlainDecimal(const std::string& s, T& val)
+{
+	const char* p = s.c_str();
+	if (*p == '+' || *p == '-') p++;
+	size_t nDigits = 0;
+	for (; *p >= '0' && *p <= '9'; p++)
+		nDigits++;
+	if (*p == '.')
+		for (p++; *p >= '0' && *p <= '9'; p++)
+			nDigits++;
+	if (!nDigits) return false;
+	if (*p == 'e' || *p == 'E')
+	{
+		p++;
+		if (*p == '+' || *p == '-') p++;
+		if (*p < '0' || *p > '9') return false;
+		while (*p >= '0' && *p <= '9')
+			p++;
+	}
+	if (*p != '\0') return false;
+	// strtod() uses the C locale, unlike C++ streams:
+	if (std::localeconv()->decimal_point[0] != '.') return false;
+
+	errno = 0;
+	if constexpr (std::is_same_v<T, float>)
+		val = std::strtof(s.c_str(), nullptr);
+	else
+		val = std::strtod(s.c_str(), nullptr);
+	return errno != ERANGE;
+}
+
+bool mrpt::containers::internal::parsePlainDecimal(
+	const std::string& s, double& val)
+{
+	return implParsePlainDecimal(s, val);
+}
+bool mrpt::containers::internal::parsePlainDecimal(
+	const std::string& s, float& val)
+{
+	return implParsePlainDecimal(s, val);
+}
+
+// A key node pointing to the caller string, instead of holding a copy of it
+// (a `const char*` fits into std::any without memory allocations). It compares
+// with operator< like a node holding a std::string. Only valid while `key`
+// lives.
+static yaml::node_t keyForLookup(const std::string& key)
+{
+	yaml::node_t k;
+	k.d.emplace<yaml::scalar_t>(key.c_str());
+	return k;
+}
+
+yaml::map_t::const_iterator yaml::internalFindKey(
+	const map_t& m, const std::string& key)
+{
+	return m.find(keyForLookup(key));
+}
+yaml::map_t::iterator yaml::internalFindKey(map_t& m, const std::string& key)
+{
+	return m.find(keyForLookup(key));
+}
+
 bool yaml::empty() const
 {
 	auto n = dereferenceProxy();
@@ -284,7 +351,11 @@ yaml yaml::operator[](const std::string& s)
 	if (!n->isMap())
 		THROW_EXCEPTION("write operator[] not applicable to non-map nodes.");
 
-	return yaml(internal::tag_as_proxy_t(), std::get<map_t>(n->d)[s], s);
+	map_t& m = std::get<map_t>(n->d);
+	auto it = internalFindKey(m, s);
+	if (it == m.end()) it = m.emplace(s, node_t()).first;
+
+	return yaml(internal::tag_as_proxy_t(), it->second, s);
 }
 
 const yaml yaml::operator[](const std::string& s) const
@@ -296,7 +367,7 @@ const yaml yaml::operator[](const std::string& s) const
 		THROW_EXCEPTION("read operator[] only available for map nodes.");
 
 	const map_t& m = std::get<map_t>(n->d);
-	auto it = m.find(s);
+	auto it = internalFindKey(m, s);
 	if (m.end() == it)
 		THROW_EXCEPTION_FMT("Access non-existing map key `%s`", s.c_str());
 
@@ -699,11 +770,16 @@ bool yaml::internalPrintAsYAML(
 
 	if (v.type() == typeid(yaml))
 		return internalPrintNodeAsYAML(
-			*std::any_cast<yaml>(v).dereferenceProxy(), o, ps);
+			*std::any_cast<yaml>(&v)->dereferenceProxy(), o, ps);
 
 	if (ps.needsSpace) o << " ";
 
-	if (v.type() == typeid(bool))
+	// Most common case first (all scalars loaded from YAML text):
+	if (const auto* str = std::any_cast<std::string>(&v); str)
+	{
+		if (internalPrintStringScalar(*str, o, ps, cs)) return true;
+	}
+	else if (v.type() == typeid(bool))
 		o << (std::any_cast<bool>(v) ? "true" : "false");
 	else if (v.type() == typeid(uint64_t))
 		o << std::any_cast<uint64_t>(v);
@@ -722,11 +798,6 @@ bool yaml::internalPrintAsYAML(
 		if (internalPrintStringScalar(std::any_cast<const char*>(v), o, ps, cs))
 			return true;
 	}
-	else if (v.type() == typeid(std::string))
-	{
-		if (internalPrintStringScalar(std::any_cast<std::string>(v), o, ps, cs))
-			return true;
-	}
 	else if (v.type() == typeid(float))
 		o << mrpt::format("%.16g", std::any_cast<float>(v));
 	else if (v.type() == typeid(double))
@@ -764,7 +835,7 @@ yaml yaml::FromText(const std::string& yamlTextBlock)
 }
 
 // TODO: Allow users to add custom filters?
-static yaml::scalar_t textToScalar(const std::string& s)
+static yaml::scalar_t textToScalar(std::string&& s)
 {
 	// tag:yaml.org,2002:null
 	// https://yaml.org/spec/1.2/spec.html#id2803362
@@ -772,7 +843,7 @@ static yaml::scalar_t textToScalar(const std::string& s)
 
 	// TODO: Try to parse to int or double?
 
-	return {s};
+	return {std::move(s)};
 }
 
 #if MRPT_HAS_FYAML
@@ -872,12 +943,12 @@ static std::optional<yaml::node_t> recursiveParse(struct fy_parser* p)
 		case FYET_MAPPING_START:
 		{
 			PARSER_DBG_OUT("Event: MAP START");
-			fy_parser_event_free(p, event);	 // free event
 
 			yaml::node_t n;
 			yaml::map_t& m = n.d.emplace<yaml::map_t>();
 
 			parseTokenComments(event->scalar.value, n);
+			fy_parser_event_free(p, event);	 // free event
 
 			for (;;)
 			{
@@ -888,14 +959,13 @@ static std::optional<yaml::node_t> recursiveParse(struct fy_parser* p)
 
 				ASSERT_(nKey->isScalar());
 
-				// Move comments from key:
-				yaml::node_t& val = m[*nKey];
-
 				// and next event is mapped content:
 				auto nVal = recursiveParse(p);
 				ASSERT_(nVal.has_value());
 
-				val = std::move(nVal.value());
+				// Move key (with its comments) and value into the map:
+				m.insert_or_assign(
+					std::move(nKey.value()), std::move(nVal.value()));
 			}
 
 			return n;
@@ -911,11 +981,11 @@ static std::optional<yaml::node_t> recursiveParse(struct fy_parser* p)
 		case FYET_SEQUENCE_START:
 		{
 			PARSER_DBG_OUT("Event: SEQ START");
-			fy_parser_event_free(p, event);	 // free event
 			yaml::node_t n;
 			yaml::sequence_t& s = n.d.emplace<yaml::sequence_t>();
 
 			parseTokenComments(event->scalar.value, n);
+			fy_parser_event_free(p, event);	 // free event
 
 			for (;;)
 			{
@@ -939,7 +1009,7 @@ static std::optional<yaml::node_t> recursiveParse(struct fy_parser* p)
 			size_t strValueLen = 0;
 			const char* strValue =
 				fy_token_get_text(event->scalar.value, &strValueLen);
-			const std::string sValue(strValue, strValueLen);
+			std::string sValue(strValue, strValueLen);
 
 			PARSER_DBG_OUT(
 				"token: " << reinterpret_cast<void*>(event->scalar.value)
@@ -953,7 +1023,7 @@ static std::optional<yaml::node_t> recursiveParse(struct fy_parser* p)
 			if (event->scalar.value)
 			{
 				yaml::node_t n;
-				n.d.emplace<yaml::scalar_t>(textToScalar(sValue));
+				n.d.emplace<yaml::scalar_t>(textToScalar(std::move(sValue)));
 
 				parseTokenComments(event->scalar.value, n);
 
@@ -1120,15 +1190,13 @@ void yaml::comment(const std::string& c, CommentPosition position)
 
 // --- key node comments API ---
 const yaml::node_t& findKeyNode(
-	const yaml::node_t* me, const std::string_view& key)
+	const yaml::node_t* me, const std::string& key)
 {
 	const auto& m = me->asMap();
-	auto itK = m.find(key);
+	auto itK = m.find(keyForLookup(key));
 	ASSERTMSG_(
 		itK != m.end(),
-		mrpt::format(
-			"key '%.*s' not present in map", static_cast<int>(key.size()),
-			key.data()));
+		mrpt::format("key '%s' not present in map", key.c_str()));
 	return itK->first;
 }
 
@@ -497,6 +497,72 @@ void foo(mrpt::containers::yaml& p)
 	p["N"] = 2;
 }
 
+MRPT_TEST(yaml, stringToNumberConversions)
+{
+	mrpt::containers::yaml p;
+	p["a"] = "1.5e3";
+	p["b"] = "-.25";
+	p["c"] = "0x10";
+	p["d"] = "3 m";
+	p["e"] = "1e999";
+	p["f"] = "42";
+	p["g"] = "0.1";
+
+	EXPECT_DOUBLE_EQ(p["a"].as<double>(), 1500.0);
+	EXPECT_DOUBLE_EQ(p["b"].as<double>(), -0.25);
+	EXPECT_EQ(p["b"].as<float>(), -0.25f);
+	EXPECT_EQ(p["g"].as<float>(), 0.1f);
+	EXPECT_EQ(p["g"].as<double>(), 0.1);
+	// Same results than parsing with std::istream:
+	EXPECT_DOUBLE_EQ(p["c"].as<double>(), 0.0);
+	EXPECT_DOUBLE_EQ(p["d"].as<double>(), 3.0);
+	EXPECT_EQ(p["c"].as<int>(), 16);
+	EXPECT_EQ(p["d"].as<int>(), 3);
+	EXPECT_EQ(p["f"].as<uint8_t>(), 42);
+	EXPECT_EQ(p["f"].as<double>(), 42.0);
+	EXPECT_EQ(p["e"].as<int>(), 1);
+}
+MRPT_TEST_END()
+
+MRPT_TEST(yaml, mapKeyLookups)
+{
+	mrpt::containers::yaml p;
+	for (int i = 0; i < 100; i++)
+		p[mrpt::format("a_quite_long_key_name_%03i", i)] = i;
+
+	const auto& m = p.asMap();
+	EXPECT_EQ(m.size(), 100U);
+	EXPECT_TRUE(p.has("a_quite_long_key_name_042"));
+	EXPECT_FALSE(p.has("a_quite_long_key_name_100"));
+	EXPECT_TRUE(p.has("a_quite_long_key_name_099"));
+	EXPECT_EQ(p.getOrDefault("a_quite_long_key_name_042", 0), 42);
+	EXPECT_EQ(p.getOrDefault("a_quite_long_key_name_100", -1), -1);
+	EXPECT_EQ(
+		p.keyNode("a_quite_long_key_name_007").as<std::string>(),
+		"a_quite_long_key_name_007");
+
+	// Overwrite existing keys:
+	p["a_quite_long_key_name_005"] = "five";
+	EXPECT_EQ(p.size(), 100U);
+	EXPECT_EQ(p["a_quite_long_key_name_005"].as<std::string>(), "five");
+
+	// Key names in error messages, from a temporary key string:
+	const auto& cp = p;
+	try
+	{
+		const auto& v = cp[std::string("a_quite_long_key_name_005")];
+		(void)v.asRef<double>();
+		GTEST_FAIL() << "Exception expected";
+	}
+	catch (const std::exception& e)
+	{
+		const std::string msg = e.what();
+		EXPECT_NE(msg.find("a_quite_long_key_name_005"), std::string::npos)
+			<< msg;
+	}
+}
+MRPT_TEST_END()
+
 MRPT_TEST(yaml, assignmentsInCallee)
 {
 	mrpt::containers::yaml p;
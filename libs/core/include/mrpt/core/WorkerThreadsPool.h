@@ -15,14 +15,19 @@
  * @date   Dec 6, 2018
  */
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace mrpt
@@ -31,6 +36,33 @@ namespace mrpt
  * @{ */
 
 /** A thread pool.
+ *
+ * Two kinds of work can be submitted to the pool:
+ *  - Independent tasks, via enqueue(), which returns a std::future. These are
+ *    kept in one shared queue and follow the selected queue_policy_t.
+ *  - Fine-grained, fork-join parallelism, via parallel_for(),
+ *    parallel_reduce() and TaskGroup. These are handled by a work-stealing
+ *    scheduler: each worker thread has its own task deque, where it pushes
+ *    and pops work without contending with other threads, and idle threads
+ *    steal the oldest (largest) tasks from others. Threads waiting for
+ *    parallel work to finish execute pending tasks meanwhile, so these calls
+ *    can be safely nested (e.g. a parallel_for() inside a TaskGroup task).
+ *
+ * Library algorithms should use the process-wide pool returned by Default(),
+ * instead of creating their own threads.
+ *
+ * \code
+ * auto& pool = mrpt::WorkerThreadsPool::Default();
+ * pool.parallel_for(0, N, [&](std::size_t i) { out[i] = f(in[i]); });
+ *
+ * const double sum = pool.parallel_reduce(
+ *     0, N, 0.0,
+ *     [&](std::size_t first, std::size_t last, double acc) {
+ *         for (auto i = first; i < last; i++) acc += in[i];
+ *         return acc;
+ *     },
+ *     std::plus<double>());
+ * \endcode
  *
  * \note Partly based on: https://github.com/progschj/ThreadPool (ZLib license)
  *
@@ -39,6 +71,8 @@ namespace mrpt
 class WorkerThreadsPool
 {
    public:
+	class TaskGroup;
+
 	enum queue_policy_t : uint8_t
 	{
 		/** Default policy: *all* tasks are executed in FIFO order. No drops. */
@@ -58,10 +92,26 @@ class WorkerThreadsPool
 		name(threadsName);
 	}
 	~WorkerThreadsPool() { clear(); }
+
+	WorkerThreadsPool(const WorkerThreadsPool&) = delete;
+	WorkerThreadsPool& operator=(const WorkerThreadsPool&) = delete;
+
+	/** Adds `num_threads` new worker threads to the pool.
+	 * \note Must not be called while parallel work is running on the pool.
+	 */
 	void resize(std::size_t num_threads);
 	/** Stops and deletes all worker threads */
 	void clear();
 
+	/** Returns the number of worker threads in the pool */
+	std::size_t size() const { return threads_.size(); }
+
+	/** A process-wide pool, with as many threads as hardware threads,
+	 * intended to be shared by all library algorithms. Created on first use.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	static WorkerThreadsPool& Default();
+
 	/** Enqueue one new working item, to be executed by threads when any is
 	 * available. */
 	template <class F, class... Args>
@@ -72,6 +122,38 @@ class WorkerThreadsPool
 	 * working thread to process them.  */
 	std::size_t pendingTasks() const noexcept;
 
+	/** Calls `f(i)` for all `i` in the range `[first,last)`, in parallel.
+	 * The range is recursively split in halves down to chunks of
+	 * `grainSize` indices, which are distributed among the worker threads
+	 * and the calling thread. The call returns when all indices have been
+	 * processed.
+	 *
+	 * \param grainSize The minimum number of consecutive indices processed
+	 * as one task. Use 0 for an automatic value, based on the range length
+	 * and the number of threads. Increase it if `f` is very cheap.
+	 * \exception Any exception thrown by `f` is re-thrown here, after all
+	 * running tasks have finished. Remaining chunks are skipped.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	template <class F>
+	void parallel_for(
+		std::size_t first, std::size_t last, F&& f, std::size_t grainSize = 0);
+
+	/** Parallel reduction of the range `[first,last)`.
+	 * The range is split into chunks as in parallel_for(), `body` is called
+	 * for each chunk as `T body(std::size_t first, std::size_t last, T init)`
+	 * with `init=identity`, and the partial results are combined with
+	 * `T reduce(T a, T b)`, which must be associative. Partial results are
+	 * combined in the order of their ranges, so non-commutative operations
+	 * are allowed.
+	 *
+	 * \note (New in MRPT 2.4.2)
+	 */
+	template <class T, class Body, class Reduce>
+	T parallel_reduce(
+		std::size_t first, std::size_t last, const T& identity, Body&& body,
+		Reduce&& reduce, std::size_t grainSize = 0);
+
 	/** Sets the private thread names of threads in this pool.
 	 * Names can be seen from debuggers, profilers, etc. and will follow
 	 * the format `${name}[i]` with `${name}` the value supplied in this method
@@ -85,11 +167,109 @@ class WorkerThreadsPool
    private:
 	std::vector<std::thread> threads_;
 	std::atomic_bool do_stop_{false};
-	std::mutex queue_mutex_;
+	mutable std::mutex queue_mutex_;
 	std::condition_variable condition_;
 	std::queue<std::function<void()>> tasks_;
 	queue_policy_t policy_{POLICY_FIFO};
 	std::string name_{"WorkerThreadsPool"};
+
+	/** @name Work-stealing scheduler
+	 * @{ */
+
+	/** A task: calls `run(ctx, first, last)`. No dynamic memory involved. */
+	struct ws_task_t
+	{
+		void (*run)(void* ctx, std::size_t first, std::size_t last) = nullptr;
+		void* ctx = nullptr;
+		std::size_t first = 0, last = 0;
+	};
+
+	struct ws_queue_t
+	{
+		std::mutex mtx;
+		std::deque<ws_task_t> tasks;
+	};
+
+	/** A parallel_for() job. Only the leaves of the recursive range splitting
+	 * decrement `remaining`, so when it reaches zero no queued task refers
+	 * to the job anymore. */
+	struct ws_range_job_t
+	{
+		WorkerThreadsPool* pool = nullptr;
+		void (*body)(void* user, std::size_t first, std::size_t last) =
+			nullptr;
+		void* user = nullptr;
+		std::size_t grain = 1;
+		std::atomic_size_t remaining{0};
+		std::atomic_bool failed{false};
+		std::exception_ptr error;
+	};
+
+	/** The first queue holds tasks submitted from threads not in this pool,
+	 * then there is one queue per worker thread. */
+	std::vector<std::unique_ptr<ws_queue_t>> ws_queues_;
+	std::atomic_size_t ws_pending_{0};
+	std::atomic_size_t ws_sleeping_{0};
+
+	void ws_push(const ws_task_t& t);
+	bool ws_pop(ws_task_t& t);
+	/** Runs pending tasks until `counter` reaches zero */
+	void ws_help_while_nonzero(const std::atomic_size_t& counter);
+	std::size_t ws_default_grain(std::size_t n) const;
+	void ws_run_range_job(
+		ws_range_job_t& job, std::size_t first, std::size_t last);
+	static void ws_execute_range(
+		void* job, std::size_t first, std::size_t last);
+	/** @} */
+};
+
+/** A group of tasks, run in a WorkerThreadsPool, whose completion can be
+ * waited for. Tasks may create and wait for nested groups.
+ *
+ * \code
+ * mrpt::WorkerThreadsPool::TaskGroup g;
+ * g.run([&]() { processLeft(); });
+ * g.run([&]() { processRight(); });
+ * g.wait();
+ * \endcode
+ *
+ * \note (New in MRPT 2.4.2)
+ */
+class WorkerThreadsPool::TaskGroup
+{
+   public:
+	explicit TaskGroup(WorkerThreadsPool& pool = WorkerThreadsPool::Default())
+		: pool_(pool)
+	{
+	}
+	/** Waits for all tasks, ignoring their exceptions, if any. */
+	~TaskGroup();
+
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator=(const TaskGroup&) = delete;
+
+	/** Submits a new task `f()`. If the pool has no threads, it is run
+	 * immediately in the calling thread. */
+	template <class F>
+	void run(F&& f)
+	{
+		run_function(std::function<void()>(std::forward<F>(f)));
+	}
+
+	/** Waits until all tasks submitted so far have finished, running pending
+	 * pool tasks meanwhile.
+	 * \exception The first exception thrown by any task, if any.
+	 */
+	void wait();
+
+   private:
+	WorkerThreadsPool& pool_;
+	std::atomic_size_t pending_{0};
+	std::mutex error_mtx_;
+	std::exception_ptr error_;
+
+	void run_function(std::function<void()>&& f);
+	static void execute(void* task, std::size_t, std::size_t);
 };
 
 template <class F, class... Args>
@@ -124,5 +304,67 @@ auto WorkerThreadsPool::enqueue(F&& f, Args&&... args)
 	return res;
 }
 
+template <class F>
+void WorkerThreadsPool::parallel_for(
+	std::size_t first, std::size_t last, F&& f, std::size_t grainSize)
+{
+	if (last <= first) return;
+	if (grainSize == 0) grainSize = ws_default_grain(last - first);
+
+	// Run in this thread if there is nothing to split:
+	if (threads_.empty() || last - first <= grainSize)
+	{
+		for (std::size_t i = first; i < last; i++)
+			f(i);
+		return;
+	}
+
+	using functor_t = std::remove_reference_t<F>;
+
+	ws_range_job_t job;
+	job.grain = grainSize;
+	job.user = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+	job.body = [](void* user, std::size_t a, std::size_t b) {
+		auto& fn = *static_cast<functor_t*>(user);
+		for (std::size_t i = a; i < b; i++)
+			fn(i);
+	};
+	ws_run_range_job(job, first, last);
+}
+
+template <class T, class Body, class Reduce>
+T WorkerThreadsPool::parallel_reduce(
+	std::size_t first, std::size_t last, const T& identity, Body&& body,
+	Reduce&& reduce, std::size_t grainSize)
+{
+	if (last <= first) return identity;
+	if (grainSize == 0) grainSize = ws_default_grain(last - first);
+
+	// One partial result per chunk, combined in order at the end:
+	const std::size_t nChunks = (last - first + grainSize - 1) / grainSize;
+	if (threads_.empty() || nChunks == 1)
+		return body(first, last, identity);
+
+	// (wrapped in a struct to avoid std::vector<bool>)
+	struct partial_t
+	{
+		T value;
+	};
+	std::vector<partial_t> partials(nChunks, partial_t{identity});
+	parallel_for(
+		0, nChunks,
+		[&](std::size_t chunk) {
+			const std::size_t a = first + chunk * grainSize;
+			const std::size_t b = std::min(a + grainSize, last);
+			partials[chunk].value = body(a, b, identity);
+		},
+		1);
+
+	T result = std::move(partials[0].value);
+	for (std::size_t i = 1; i < nChunks; i++)
+		result = reduce(std::move(result), std::move(partials[i].value));
+	return result;
+}
+
 /** @} */
 }  // namespace mrpt
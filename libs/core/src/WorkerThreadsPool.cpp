@@ -19,6 +19,7 @@
 #include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/core/exceptions.h>
 
+#include <chrono>
 #include <iostream>
 
 // for SetThreadDescription()
@@ -29,6 +30,10 @@
 
 using namespace mrpt;
 
+// The pool (if any) the current thread is a worker of, and its task queue:
+static thread_local WorkerThreadsPool* tl_pool = nullptr;
+static thread_local std::size_t tl_queue = 0;
+
 void WorkerThreadsPool::clear()
 {
 	{
@@ -50,24 +55,55 @@ void WorkerThreadsPool::clear()
 
 std::size_t WorkerThreadsPool::pendingTasks() const noexcept
 {
-	return tasks_.size();
+	std::unique_lock<std::mutex> lock(queue_mutex_);
+	return tasks_.size() + ws_pending_;
+}
+
+WorkerThreadsPool& WorkerThreadsPool::Default()
+{
+	static WorkerThreadsPool pool(
+		std::max(1U, std::thread::hardware_concurrency()), POLICY_FIFO,
+		"mrptPool");
+	return pool;
 }
 
 void WorkerThreadsPool::resize(std::size_t num_threads)
 {
+	// Queue for tasks from external threads:
+	if (ws_queues_.empty()) ws_queues_.emplace_back(new ws_queue_t);
+
 	for (std::size_t i = 0; i < num_threads; ++i)
-		threads_.emplace_back([this] {
+	{
+		const std::size_t queueIdx = ws_queues_.size();
+		ws_queues_.emplace_back(new ws_queue_t);
+
+		threads_.emplace_back([this, queueIdx] {
+			tl_pool = this;
+			tl_queue = queueIdx;
+
 			for (;;)
 			{
 				try
 				{
+					// Fork-join tasks first:
+					ws_task_t wsTask;
+					if (ws_pop(wsTask))
+					{
+						wsTask.run(wsTask.ctx, wsTask.first, wsTask.last);
+						continue;
+					}
+
 					std::function<void()> task;
 					{
 						std::unique_lock<std::mutex> lock(queue_mutex_);
+						ws_sleeping_++;
 						condition_.wait(lock, [this] {
-							return do_stop_ || !tasks_.empty();
+							return do_stop_ || !tasks_.empty() ||
+								ws_pending_ != 0;
 						});
+						ws_sleeping_--;
 						if (do_stop_) return;
+						if (tasks_.empty()) continue;
 						task = std::move(tasks_.front());
 						tasks_.pop();
 					}
@@ -82,6 +118,203 @@ void WorkerThreadsPool::resize(std::size_t num_threads)
 				}
 			}
 		});
+	}
+}
+
+void WorkerThreadsPool::ws_push(const ws_task_t& t)
+{
+	// Increment before actually pushing, so ws_pending_ is never lower than
+	// the number of queued tasks:
+	ws_pending_++;
+	{
+		auto& q = *ws_queues_[tl_pool == this ? tl_queue : 0];
+		std::lock_guard<std::mutex> lck(q.mtx);
+		q.tasks.push_back(t);
+	}
+	// Wake up one idle worker, if any. Taking the mutex makes sure it is
+	// either already waiting, or will see ws_pending_!=0 before waiting:
+	if (ws_sleeping_ != 0)
+	{
+		{
+			std::lock_guard<std::mutex> lck(queue_mutex_);
+		}
+		condition_.notify_one();
+	}
+}
+
+bool WorkerThreadsPool::ws_pop(ws_task_t& t)
+{
+	if (ws_pending_ == 0) return false;
+
+	const bool isWorker = (tl_pool == this);
+
+	// Own tasks first, newest first (smaller, and hot in cache):
+	if (isWorker)
+	{
+		auto& q = *ws_queues_[tl_queue];
+		std::lock_guard<std::mutex> lck(q.mtx);
+		if (!q.tasks.empty())
+		{
+			t = q.tasks.back();
+			q.tasks.pop_back();
+			ws_pending_--;
+			return true;
+		}
+	}
+
+	// Otherwise, steal the oldest (largest) task from other queues, starting
+	// at a different one each time to spread contention:
+	static thread_local std::size_t nextVictim = 0;
+	const std::size_t nQueues = ws_queues_.size();
+	for (std::size_t k = 0; k < nQueues; k++)
+	{
+		const std::size_t idx = (nextVictim + k) % nQueues;
+		if (isWorker && idx == tl_queue) continue;
+
+		auto& q = *ws_queues_[idx];
+		std::lock_guard<std::mutex> lck(q.mtx);
+		if (q.tasks.empty()) continue;
+
+		t = q.tasks.front();
+		q.tasks.pop_front();
+		ws_pending_--;
+		nextVictim = idx + 1;
+		return true;
+	}
+	return false;
+}
+
+void WorkerThreadsPool::ws_help_while_nonzero(const std::atomic_size_t& counter)
+{
+	unsigned int idleLoops = 0;
+	while (counter.load(std::memory_order_acquire) != 0)
+	{
+		ws_task_t t;
+		if (ws_pop(t))
+		{
+			t.run(t.ctx, t.first, t.last);
+			idleLoops = 0;
+		}
+		else if (++idleLoops < 64)
+			std::this_thread::yield();
+		else  // Remaining tasks are running in other threads:
+			std::this_thread::sleep_for(std::chrono::microseconds(20));
+	}
+}
+
+std::size_t WorkerThreadsPool::ws_default_grain(std::size_t n) const
+{
+	// Some chunks per thread, so fast threads can steal from slow ones:
+	const std::size_t nChunks = 8 * (threads_.size() + 1);
+	return std::max<std::size_t>(1, (n + nChunks - 1) / nChunks);
+}
+
+void WorkerThreadsPool::ws_run_range_job(
+	ws_range_job_t& job, std::size_t first, std::size_t last)
+{
+	job.pool = this;
+	job.remaining = last - first;
+
+	// Split and run the range, then help with the pieces not stolen yet:
+	ws_execute_range(&job, first, last);
+	ws_help_while_nonzero(job.remaining);
+
+	if (job.error) std::rethrow_exception(job.error);
+}
+
+void WorkerThreadsPool::ws_execute_range(
+	void* ctx, std::size_t first, std::size_t last)
+{
+	auto& job = *static_cast<ws_range_job_t*>(ctx);
+
+	// Keep the first half, and leave the other half for others to steal:
+	while (last - first > job.grain)
+	{
+		const std::size_t mid = first + (last - first) / 2;
+		job.pool->ws_push(ws_task_t{&ws_execute_range, ctx, mid, last});
+		last = mid;
+	}
+
+	if (!job.failed.load(std::memory_order_relaxed))
+	{
+		try
+		{
+			job.body(job.user, first, last);
+		}
+		catch (...)
+		{
+			if (!job.failed.exchange(true))
+				job.error = std::current_exception();
+		}
+	}
+
+	// This must be the last access to `job`: it may be destroyed right after.
+	job.remaining.fetch_sub(last - first, std::memory_order_acq_rel);
+}
+
+namespace
+{
+struct group_task_t
+{
+	std::function<void()> f;
+	WorkerThreadsPool::TaskGroup* group;
+};
+}  // namespace
+
+WorkerThreadsPool::TaskGroup::~TaskGroup()
+{
+	pool_.ws_help_while_nonzero(pending_);
+}
+
+void WorkerThreadsPool::TaskGroup::run_function(std::function<void()>&& f)
+{
+	if (pool_.threads_.empty())
+	{
+		try
+		{
+			f();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lck(error_mtx_);
+			if (!error_) error_ = std::current_exception();
+		}
+		return;
+	}
+
+	pending_++;
+	auto* task = new group_task_t{std::move(f), this};
+	pool_.ws_push(ws_task_t{&TaskGroup::execute, task, 0, 0});
+}
+
+void WorkerThreadsPool::TaskGroup::execute(void* ctx, std::size_t, std::size_t)
+{
+	std::unique_ptr<group_task_t> task(static_cast<group_task_t*>(ctx));
+	TaskGroup& g = *task->group;
+	try
+	{
+		task->f();
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lck(g.error_mtx_);
+		if (!g.error_) g.error_ = std::current_exception();
+	}
+	// Destroy the functor before signaling completion:
+	task.reset();
+	g.pending_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void WorkerThreadsPool::TaskGroup::wait()
+{
+	pool_.ws_help_while_nonzero(pending_);
+
+	std::exception_ptr e;
+	{
+		std::lock_guard<std::mutex> lck(error_mtx_);
+		std::swap(e, error_);
+	}
+	if (e) std::rethrow_exception(e);
 }
 
 // code partially replicated from mrpt::system for convenience (avoid dep)
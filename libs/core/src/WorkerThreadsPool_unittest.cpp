@@ -10,6 +10,10 @@
 #include <gtest/gtest.h>
 #include <mrpt/core/WorkerThreadsPool.h>
 
+#include <atomic>
+#include <string>
+#include <vector>
+
 TEST(WorkerThreadsPool, runTasks)
 {
 	//
@@ -34,3 +38,148 @@ TEST(WorkerThreadsPool, runTasks)
 	}
 	EXPECT_EQ(accum, 6);
 }
+
+TEST(WorkerThreadsPool, parallelFor)
+{
+	for (const std::size_t nThreads : {0U, 1U, 4U})
+	{
+		mrpt::WorkerThreadsPool pool(nThreads);
+
+		for (const std::size_t grain : {0U, 1U, 7U, 1000U})
+		{
+			const std::size_t N = 10000;
+			std::vector<int> hits(N, 0);
+
+			pool.parallel_for(
+				0, N, [&](std::size_t i) { hits[i]++; }, grain);
+
+			for (std::size_t i = 0; i < N; i++)
+				EXPECT_EQ(hits[i], 1) << "i=" << i << " grain=" << grain
+									  << " nThreads=" << nThreads;
+		}
+
+		// Empty range:
+		pool.parallel_for(5, 5, [](std::size_t) { FAIL(); });
+	}
+}
+
+TEST(WorkerThreadsPool, parallelReduce)
+{
+	mrpt::WorkerThreadsPool pool(4);
+
+	const std::size_t N = 100000;
+	const auto sum = pool.parallel_reduce(
+		0, N, uint64_t(0),
+		[](std::size_t first, std::size_t last, uint64_t acc) {
+			for (auto i = first; i < last; i++)
+				acc += i;
+			return acc;
+		},
+		std::plus<uint64_t>());
+	EXPECT_EQ(sum, uint64_t(N) * (N - 1) / 2);
+
+	// Non-commutative reduction: partial results are combined in order.
+	const auto str = pool.parallel_reduce(
+		0, 26, std::string(),
+		[](std::size_t first, std::size_t last, std::string acc) {
+			for (auto i = first; i < last; i++)
+				acc += static_cast<char>('a' + i);
+			return acc;
+		},
+		[](std::string a, const std::string& b) { return a + b; }, 3);
+	EXPECT_EQ(str, "abcdefghijklmnopqrstuvwxyz");
+}
+
+namespace
+{
+uint64_t fib(mrpt::WorkerThreadsPool& pool, unsigned int n)
+{
+	if (n < 2) return n;
+	if (n < 12) return fib(pool, n - 1) + fib(pool, n - 2);
+
+	uint64_t a = 0, b = 0;
+	mrpt::WorkerThreadsPool::TaskGroup g(pool);
+	g.run([&]() { a = fib(pool, n - 1); });
+	g.run([&]() { b = fib(pool, n - 2); });
+	g.wait();
+	return a + b;
+}
+}  // namespace
+
+TEST(WorkerThreadsPool, nestedTaskGroups)
+{
+	// Nested waits must not deadlock, even with a single worker thread:
+	for (const std::size_t nThreads : {1U, 3U})
+	{
+		mrpt::WorkerThreadsPool pool(nThreads);
+		EXPECT_EQ(fib(pool, 22), 17711U);
+	}
+
+	// parallel_for() inside tasks:
+	mrpt::WorkerThreadsPool pool(2);
+	std::atomic_int total{0};
+	mrpt::WorkerThreadsPool::TaskGroup g(pool);
+	for (int t = 0; t < 8; t++)
+		g.run([&]() {
+			pool.parallel_for(0, 1000, [&](std::size_t) { total++; });
+		});
+	g.wait();
+	EXPECT_EQ(total, 8000);
+}
+
+TEST(WorkerThreadsPool, exceptions)
+{
+	mrpt::WorkerThreadsPool pool(2);
+
+	EXPECT_THROW(
+		pool.parallel_for(
+			0, 1000,
+			[](std::size_t i) {
+				if (i == 500) throw std::runtime_error("error");
+			},
+			10),
+		std::runtime_error);
+
+	mrpt::WorkerThreadsPool::TaskGroup g(pool);
+	g.run([]() { throw std::runtime_error("error"); });
+	g.run([]() {});
+	EXPECT_THROW(g.wait(), std::runtime_error);
+
+	// The pool remains usable:
+	std::atomic_int n{0};
+	pool.parallel_for(0, 100, [&](std::size_t) { n++; });
+	EXPECT_EQ(n, 100);
+}
+
+TEST(WorkerThreadsPool, defaultPool)
+{
+	auto& pool = mrpt::WorkerThreadsPool::Default();
+	EXPECT_EQ(&pool, &mrpt::WorkerThreadsPool::Default());
+	EXPECT_GE(pool.size(), 1U);
+
+	std::vector<double> v(1000);
+	pool.parallel_for(0, v.size(), [&](std::size_t i) { v[i] = i; });
+	EXPECT_EQ(v[999], 999.0);
+}
+
+// Fine-grained parallelism: one task per item with enqueue() and
+// parallel_for(). See apps/mrpt-performance for their timings.
+TEST(WorkerThreadsPool, fineGrainedTasks)
+{
+	const std::size_t N = 20000;
+	mrpt::WorkerThreadsPool pool(4);
+	std::vector<std::size_t> out(N, 0);
+	auto work = [&](std::size_t i) { out[i]++; };
+
+	std::vector<std::future<void>> futs;
+	futs.reserve(N);
+	for (std::size_t i = 0; i < N; i++)
+		futs.emplace_back(pool.enqueue(work, i));
+	for (auto& f : futs)
+		f.wait();
+	pool.parallel_for(0, N, work, 1 /*grain: one item per task*/);
+	pool.parallel_for(0, N, work);
+
+	for (std::size_t i = 0; i < N; i++)
+		EXPECT_EQ(out[i], 3U) << i;
+}
@@ -13,6 +13,8 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "mrpt-expr_export.h"
 
@@ -53,8 +55,14 @@ namespace expr
  * substrings) any of the terms will be traced.
  * Example: `MRPT_EXPR_VERBOSE="cos|sin|speed|if (x>0)"`.
  *
+ * To evaluate a formula for many values of some of its variables, use
+ * eval_batch() instead of setting the variables and calling `eval()` in a
+ * loop: formulas using only operators, conditionals and the common math
+ * functions are evaluated by a vectorized interpreter, several times faster.
+ *
  * \note (New in MRPT 1.5.0)
  * \note (`MRPT_EXPR_VERBOSE` new in MRPT 1.5.7)
+ * \note (`eval_batch()` new in MRPT 2.4.2)
  * \ingroup mrpt_expr_grp
  */
 // Note: Leave the MRPT_EXPR_EXPORT macro in mrpt-expr, to avoid exporting ALL
@@ -97,6 +105,28 @@ class MRPT_EXPR_EXPORT CRuntimeCompiledExpression
 	 */
 	double eval() const;
 
+	/** Evaluates the formula `N` times, with the i-th value of each array in
+	 * `inputs` (pairs of `variable name` -> `pointer to N values`) and the
+	 * current value of the rest of variables, writing the results to
+	 * `out[0:N-1]`. It is equivalent to (but faster than) setting the
+	 * variables and calling eval() for each `i`, and leaves the variables in
+	 * `inputs` with their last values, too.
+	 *
+	 * Formulas with only number literals, variables, the arithmetic,
+	 * comparison and logical operators, `if()` and `?:`, and the most common
+	 * math functions (`abs`, `sqrt`, `exp`, `log`, trigonometric functions,
+	 * `min`, `max`, `pow`, `atan2`, `hypot`, `clamp`, `floor`, `round`...)
+	 * are evaluated for blocks of values at once by a vectorized interpreter.
+	 * Any other formula, or those traced with `MRPT_EXPR_VERBOSE`, are
+	 * evaluated one element after another with eval().
+	 *
+	 * \exception std::runtime_error If the formula has not been compiled yet,
+	 * or any name in `inputs` is not one of its variables.
+	 */
+	void eval_batch(
+		const std::vector<std::pair<std::string, const double*>>& inputs,
+		size_t N, double* out) const;
+
 	/** Returns true if compile() was called and ended without errors. */
 	bool is_compiled() const;
 	/** Returns the original formula passed to compile(), or an empty string if
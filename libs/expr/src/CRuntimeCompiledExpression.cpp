@@ -27,6 +27,8 @@
 #define exprtk_disable_rtl_io_file
 #include <mrpt/3rdparty/exprtk.hpp>
 
+#include "CRuntimeCompiledExpression_vectorized.h"
+
 using namespace mrpt;
 using namespace mrpt::expr;
 
@@ -38,6 +40,7 @@ struct CRuntimeCompiledExpression::ExprVerbose
 		return obj;
 	}
 	void process(const CRuntimeCompiledExpression& rce, const double ret);
+	bool isTraced(const CRuntimeCompiledExpression& rce) const;
 
    private:
 	bool m_verbose_always_enabled{false};
@@ -63,7 +66,43 @@ struct CRuntimeCompiledExpression::Impl
 {
 	exprtk::expression<double> m_compiled_formula;
 	std::string m_original_expr_str;
+	bool m_is_compiled = false;
+	/** Same symbol tables registered in m_compiled_formula */
+	std::vector<exprtk::symbol_table<double>> m_symbol_tables;
+	/** The formula for eval_batch(), or nullptr if it is out of the subset
+	 * supported by the vectorized interpreter */
+	std::shared_ptr<const mrpt::expr::internal::VectorizedProgram> m_vectorized;
+};
+
+namespace
+{
+// Symbols are looked up in the same tables than the exprtk formula:
+struct ExprtkSymbolResolver
+	: public mrpt::expr::internal::VectorizedSymbolResolver
+{
+	const std::vector<exprtk::symbol_table<double>>& tables;
+
+	explicit ExprtkSymbolResolver(
+		const std::vector<exprtk::symbol_table<double>>& t)
+		: tables(t)
+	{
+	}
+
+	const double* variable(const std::string& name) const override
+	{
+		for (const auto& st : tables)
+			if (auto* v = st.get_variable(name); v) return &v->ref();
+		return nullptr;
+	}
+	double number(const std::string& literal) const override
+	{
+		double v = 0;
+		if (!exprtk::details::string_to_real(literal, v))
+			THROW_EXCEPTION_FMT("Invalid number: `%s`", literal.c_str());
+		return v;
+	}
 };
+}  // namespace
 
 CRuntimeCompiledExpression::CRuntimeCompiledExpression()
 	: m_impl(mrpt::make_impl<CRuntimeCompiledExpression::Impl>())
@@ -84,6 +123,7 @@ void CRuntimeCompiledExpression::compile(
 	const std::string& expr_name_for_error_reporting)
 {
 	m_impl->m_original_expr_str = expression;
+	m_impl->m_is_compiled = false;
 
 	exprtk::symbol_table<double> symbol_table;
 	for (const auto& v : variables)
@@ -95,6 +135,7 @@ void CRuntimeCompiledExpression::compile(
 	symbol_table.add_constants();
 
 	m_impl->m_compiled_formula.register_symbol_table(symbol_table);
+	m_impl->m_symbol_tables.push_back(symbol_table);
 
 	// Compile user-given expressions:
 	exprtk::parser<double> parser;
@@ -103,6 +144,10 @@ void CRuntimeCompiledExpression::compile(
 			"Error compiling expression (name=`%s`): `%s`. Error: `%s`",
 			expr_name_for_error_reporting.c_str(), expression.c_str(),
 			parser.error().c_str());
+
+	m_impl->m_vectorized = mrpt::expr::internal::VectorizedProgram::compile(
+		expression, ExprtkSymbolResolver(m_impl->m_symbol_tables));
+	m_impl->m_is_compiled = true;
 }
 
 double CRuntimeCompiledExpression::eval() const
@@ -113,6 +158,48 @@ double CRuntimeCompiledExpression::eval() const
 	return ret;
 }
 
+void CRuntimeCompiledExpression::eval_batch(
+	const std::vector<std::pair<std::string, const double*>>& inputs,
+	size_t N, double* out) const
+{
+	ASSERT_(m_impl);
+	ASSERTMSG_(is_compiled(), "eval_batch() called before compile()");
+
+	const ExprtkSymbolResolver symbols(m_impl->m_symbol_tables);
+	std::vector<std::pair<double*, const double*>> columns;
+	columns.reserve(inputs.size());
+	for (const auto& in : inputs)
+	{
+		const double* var = symbols.variable(in.first);
+		if (!var)
+			THROW_EXCEPTION_FMT(
+				"Unknown variable `%s` in formula `%s`", in.first.c_str(),
+				m_impl->m_original_expr_str.c_str());
+		columns.emplace_back(const_cast<double*>(var), in.second);
+	}
+	if (N == 0) return;
+
+	if (m_impl->m_vectorized && !ExprVerbose::Instance().isTraced(*this))
+	{
+		std::vector<std::pair<const double*, const double*>> cols(
+			columns.begin(), columns.end());
+		m_impl->m_vectorized->eval(cols, N, out);
+	}
+	else
+	{
+		for (size_t i = 0; i < N; i++)
+		{
+			for (const auto& c : columns)
+				*c.first = c.second[i];
+			out[i] = eval();
+		}
+	}
+
+	// Leave variables as after evaluating the last element one by one:
+	for (const auto& c : columns)
+		*c.first = c.second[N - 1];
+}
+
 void CRuntimeCompiledExpression::register_symbol_table(
 	/** [in] Map of variables/constants by `name` ->  `value`. The
 	   references to the values in this map **must** be ensured to be valid
@@ -126,6 +213,7 @@ void CRuntimeCompiledExpression::register_symbol_table(
 		symbol_table.add_variable(v.first, *var);
 	}
 	m_impl->m_compiled_formula.register_symbol_table(symbol_table);
+	m_impl->m_symbol_tables.push_back(symbol_table);
 }
 
 exprtk::expression<double>& CRuntimeCompiledExpression::get_raw_exprtk_expr()
@@ -143,34 +231,31 @@ const exprtk::expression<double>&
 bool CRuntimeCompiledExpression::is_compiled() const
 {
 	ASSERT_(m_impl);
-	return m_impl->m_compiled_formula;
+	return m_impl->m_is_compiled;
 }
 const std::string& CRuntimeCompiledExpression::get_original_expression() const
 {
 	return m_impl->m_original_expr_str;
 }
 
+bool CRuntimeCompiledExpression::ExprVerbose::isTraced(
+	const CRuntimeCompiledExpression& rce) const
+{
+	if (m_verbose_always_enabled) return true;
+
+	for (const auto& s : m_verbose_matches)
+		if (rce.m_impl->m_original_expr_str.find(s) != std::string::npos)
+			return true;
+	return false;
+}
+
 void CRuntimeCompiledExpression::ExprVerbose::process(
 	const CRuntimeCompiledExpression& rce, const double ret)
 {
-	if (!m_verbose_always_enabled && m_verbose_matches.empty()) return;
+	if (!isTraced(rce)) return;
 
 	const auto& exp = *rce.m_impl.get();
 
-	if (!m_verbose_matches.empty())
-	{
-		bool matched = false;
-		for (const auto& s : m_verbose_matches)
-		{
-			if (exp.m_original_expr_str.find(s) != std::string::npos)
-			{
-				matched = true;
-				break;
-			}
-		}
-		if (!matched) return;
-	}
-
 	std::vector<std::pair<std::string, double>> lst;
 	exp.m_compiled_formula.get_symbol_table().get_variable_list(lst);
 	// clang-format off
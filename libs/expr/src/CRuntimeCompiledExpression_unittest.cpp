@@ -11,6 +11,8 @@
 #include <gtest/gtest.h>
 #include <mrpt/expr/CRuntimeCompiledExpression.h>
 
+#include <cmath>
+
 template class mrpt::CTraitsTest<mrpt::expr::CRuntimeCompiledExpression>;
 
 TEST(RuntimeCompiledExpression, SimpleTest)
@@ -25,3 +27,68 @@ TEST(RuntimeCompiledExpression, SimpleTest)
 	EXPECT_NEAR(
 		expr.eval(), vars["x"] * vars["x"] + vars["x"] * vars["y"] + 1.0, 1e-9);
 }
+
+TEST(RuntimeCompiledExpression, eval_batch)
+{
+	// Both, formulas supported by the vectorized interpreter and others:
+	const std::vector<std::string> formulas = {
+		"x^2+x*y+1",
+		"-x^2 + 2^(-y) - (-x) + -3^2",
+		"2^3^0.5 * x / y % 0.7",
+		"x > y ? sin(x) : cos(y) + 1",
+		"x>0 and y<0.5 or not(x*y > 0.3)",
+		"if(x < 0, abs(x), sqrt(x)) + if((y), 1, 2)",
+		"min(x, y, 0.2) + max(x, 1) - clamp(-0.5, x*y, 0.5)",
+		"atan2(y, x) + hypot(x, y) + exp(-abs(y)) + log(1.5+x)",
+		"floor(x*10) + ceil(y*3) + round(-2.5*x) + trunc(y) + frac(x*y)",
+		"sgn(x) * deg2rad(30) + rad2deg(M_PI / 4) * pi / sum(x, y, z)",
+		"avg(x, y) + tanh(x) + [y - {x}] + 3.5e-2*z + .5 + 1E1",
+		"x == y | z <> 4 & x != 1",
+		"var k := x + y; k * 2",
+		"var a := x; for (var i := 0; i < 3; i += 1) { a += y; }; a",
+		"2x + 3(y)",
+	};
+
+	const size_t N = 1000;
+	std::vector<double> xs(N), ys(N);
+	for (size_t i = 0; i < N; i++)
+	{
+		xs[i] = -2.0 + 4.0 * i / N;
+		ys[i] = std::sin(i * 0.37);
+	}
+	xs[10] = ys[10] = 0;
+	xs[20] = ys[20] = 0.5;
+
+	for (const auto& f : formulas)
+	{
+		std::map<std::string, double> vars = {{"x", 0}, {"y", 0}, {"z", 4}};
+		mrpt::expr::CRuntimeCompiledExpression expr;
+		expr.compile(f, vars);
+
+		std::vector<double> batch(N);
+		expr.eval_batch({{"x", xs.data()}, {"Y", ys.data()}}, N, batch.data());
+		EXPECT_EQ(vars["x"], xs.back());
+		EXPECT_EQ(vars["y"], ys.back());
+
+		for (size_t i = 0; i < N; i++)
+		{
+			vars["x"] = xs[i];
+			vars["y"] = ys[i];
+			const double v = expr.eval();
+			if (std::isnan(v))
+				EXPECT_TRUE(std::isnan(batch[i])) << "formula: " << f;
+			else if (std::isinf(v))
+				EXPECT_EQ(v, batch[i]) << "formula: " << f;
+			else
+				EXPECT_NEAR(v, batch[i], 1e-12 * std::max(1.0, std::abs(v)))
+					<< "formula: " << f << "\n i=" << i;
+		}
+	}
+
+	mrpt::expr::CRuntimeCompiledExpression expr;
+	std::vector<double> out(N);
+	EXPECT_ANY_THROW(expr.eval_batch({}, N, out.data()));
+	std::map<std::string, double> vars = {{"x", 0}};
+	expr.compile("x+1", vars);
+	EXPECT_ANY_THROW(expr.eval_batch({{"foo", xs.data()}}, N, out.data()));
+}
@@ -0,0 +1,623 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "expr-precomp.h"  // Precompiled headers
+//
+#include <mrpt/core/exceptions.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include "CRuntimeCompiledExpression_vectorized.h"
+
+using namespace mrpt::expr::internal;
+
+namespace
+{
+using Op = VectorizedProgram::Op;
+
+// Same values than exprtk::details::numeric::constant:
+constexpr double pi_180 = 0.01745329251994329576923690768488612713442871888542;
+constexpr double _180_pi = 57.29577951308232087679815481410517033240547246656443;
+constexpr double log_2 = 0.69314718055994530941723212145817656807550013436026;
+
+struct Token
+{
+	enum Kind
+	{
+		End,
+		Number,
+		Symbol,
+		Operator,
+		Invalid
+	};
+	Kind kind = End;
+	std::string text;
+};
+
+class Lexer
+{
+   public:
+	explicit Lexer(const std::string& s) : m_s(s) { next(); }
+
+	const Token& current() const { return m_tok; }
+
+	void next()
+	{
+		while (m_pos < m_s.size() &&
+			   std::isspace(static_cast<unsigned char>(m_s[m_pos])))
+			m_pos++;
+
+		m_tok.text.clear();
+		if (m_pos >= m_s.size())
+		{
+			m_tok.kind = Token::End;
+			return;
+		}
+		const size_t start = m_pos;
+		const char c = m_s[m_pos];
+		if (isDigit(c) || (c == '.' && m_pos + 1 < m_s.size() &&
+						   isDigit(m_s[m_pos + 1])))
+		{
+			m_tok.kind = lexNumber() ? Token::Number : Token::Invalid;
+		}
+		else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+		{
+			while (m_pos < m_s.size() &&
+				   (std::isalnum(static_cast<unsigned char>(m_s[m_pos])) ||
+					m_s[m_pos] == '_' || m_s[m_pos] == '.'))
+				m_pos++;
+			m_tok.kind = Token::Symbol;
+		}
+		else
+		{
+			static const char* twoChars[] = {"<=", ">=", "==", "!=", "<>"};
+			m_tok.kind = Token::Operator;
+			bool found = false;
+			for (const char* op : twoChars)
+				if (m_s.compare(m_pos, 2, op) == 0)
+				{
+					m_pos += 2;
+					found = true;
+					break;
+				}
+			if (!found)
+			{
+				// ":=" is an assignment; anything else not listed here is
+				// out of the supported subset:
+				if (std::strchr("+-*/%^<>=()[]{},?&|", c) != nullptr ||
+					(c == ':' && m_s.compare(m_pos, 2, ":=") != 0))
+					m_pos++;
+				else
+					m_tok.kind = Token::Invalid;
+			}
+		}
+		m_tok.text = m_s.substr(start, m_pos - start);
+	}
+
+   private:
+	const std::string& m_s;
+	size_t m_pos = 0;
+	Token m_tok;
+
+	static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+	bool lexNumber()
+	{
+		while (m_pos < m_s.size() && isDigit(m_s[m_pos]))
+			m_pos++;
+		if (m_pos < m_s.size() && m_s[m_pos] == '.')
+		{
+			m_pos++;
+			while (m_pos < m_s.size() && isDigit(m_s[m_pos]))
+				m_pos++;
+		}
+		if (m_pos < m_s.size() && (m_s[m_pos] == 'e' || m_s[m_pos] == 'E'))
+		{
+			m_pos++;
+			if (m_pos < m_s.size() && (m_s[m_pos] == '+' || m_s[m_pos] == '-'))
+				m_pos++;
+			if (m_pos >= m_s.size() || !isDigit(m_s[m_pos])) return false;
+			while (m_pos < m_s.size() && isDigit(m_s[m_pos]))
+				m_pos++;
+		}
+		return true;
+	}
+};
+
+// Binary operator precedence levels, with the same (left,right) values used
+// by exprtk::parser::parse_expression():
+struct BinaryOp
+{
+	Op op;
+	int left, right;
+};
+
+bool findBinaryOp(const Token& t, BinaryOp& bo)
+{
+	static const std::map<std::string, BinaryOp> ops = {
+		{"or", {Op::Or, 1, 2}},	   {"|", {Op::Or, 1, 2}},
+		{"and", {Op::And, 3, 4}},  {"&", {Op::And, 3, 4}},
+		{"<", {Op::Lt, 5, 6}},	   {"<=", {Op::Lte, 5, 6}},
+		{">", {Op::Gt, 5, 6}},	   {">=", {Op::Gte, 5, 6}},
+		{"==", {Op::Eq, 5, 6}},	   {"=", {Op::Eq, 5, 6}},
+		{"!=", {Op::Ne, 5, 6}},	   {"<>", {Op::Ne, 5, 6}},
+		{"+", {Op::Add, 7, 8}},	   {"-", {Op::Sub, 7, 8}},
+		{"*", {Op::Mul, 10, 11}},  {"/", {Op::Div, 10, 11}},
+		{"%", {Op::Mod, 10, 11}},  {"^", {Op::Pow, 12, 12}}};
+
+	if (t.kind != Token::Operator && t.kind != Token::Symbol) return false;
+	std::string s = t.text;
+	std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+	const auto it = ops.find(s);
+	if (it == ops.end()) return false;
+	bo = it->second;
+	return true;
+}
+
+struct FunctionDef
+{
+	Op op;
+	/** Number of arguments, or 0 for a variable number (at least 1) */
+	int numArgs;
+};
+
+const std::map<std::string, FunctionDef>& functions()
+{
+	static const std::map<std::string, FunctionDef> fns = {
+		{"abs", {Op::Abs, 1}},		   {"sqrt", {Op::Sqrt, 1}},
+		{"exp", {Op::Exp, 1}},		   {"log", {Op::Log, 1}},
+		{"log10", {Op::Log10, 1}},	   {"log2", {Op::Log2, 1}},
+		{"sin", {Op::Sin, 1}},		   {"cos", {Op::Cos, 1}},
+		{"tan", {Op::Tan, 1}},		   {"asin", {Op::Asin, 1}},
+		{"acos", {Op::Acos, 1}},	   {"atan", {Op::Atan, 1}},
+		{"sinh", {Op::Sinh, 1}},	   {"cosh", {Op::Cosh, 1}},
+		{"tanh", {Op::Tanh, 1}},	   {"floor", {Op::Floor, 1}},
+		{"ceil", {Op::Ceil, 1}},	   {"round", {Op::Round, 1}},
+		{"trunc", {Op::Trunc, 1}},	   {"frac", {Op::Frac, 1}},
+		{"sgn", {Op::Sgn, 1}},		   {"deg2rad", {Op::Deg2Rad, 1}},
+		{"rad2deg", {Op::Rad2Deg, 1}}, {"not", {Op::Not, 1}},
+		{"pow", {Op::Pow, 2}},		   {"atan2", {Op::Atan2, 2}},
+		{"hypot", {Op::Hypot, 2}},	   {"if", {Op::Select, 3}},
+		{"clamp", {Op::Clamp, 3}},	   {"min", {Op::Min, 0}},
+		{"max", {Op::Max, 0}},		   {"sum", {Op::Sum, 0}},
+		{"avg", {Op::Avg, 0}}};
+	return fns;
+}
+
+// Thrown while compiling formulas out of the supported subset:
+struct Unsupported
+{
+};
+
+}  // namespace
+
+namespace mrpt::expr::internal
+{
+/** Recursive descent parser emitting postfix bytecode */
+class VectorizedCompiler
+{
+   public:
+	VectorizedCompiler(
+		const std::string& expr, const VectorizedSymbolResolver& symbols,
+		VectorizedProgram& prog)
+		: m_lex(expr), m_symbols(symbols), m_prog(prog)
+	{
+	}
+
+	void run()
+	{
+		parseExpression(0);
+		if (m_lex.current().kind != Token::End) throw Unsupported();
+	}
+
+   private:
+	Lexer m_lex;
+	const VectorizedSymbolResolver& m_symbols;
+	VectorizedProgram& m_prog;
+	size_t m_stack = 0;
+
+	bool isOperator(const char* s) const
+	{
+		const Token& t = m_lex.current();
+		return t.kind == Token::Operator && t.text == s;
+	}
+	void expect(const char* s)
+	{
+		if (!isOperator(s)) throw Unsupported();
+		m_lex.next();
+	}
+
+	void emit(Op op, int32_t arg, int stackChange)
+	{
+		m_prog.m_code.push_back({op, arg});
+		m_stack += stackChange;
+		m_prog.m_maxStack = std::max(m_prog.m_maxStack, m_stack);
+	}
+	void emitConst(double v)
+	{
+		m_prog.m_consts.push_back(v);
+		emit(Op::PushConst, int32_t(m_prog.m_consts.size() - 1), +1);
+	}
+	bool lastIsConst(double& v) const
+	{
+		if (m_prog.m_code.empty() || m_prog.m_code.back().op != Op::PushConst)
+			return false;
+		v = m_prog.m_consts[m_prog.m_code.back().arg];
+		return true;
+	}
+
+	void parseExpression(int precedence)
+	{
+		parseBranch();
+		if (precedence == 0) parseTernary();
+
+		for (;;)
+		{
+			BinaryOp bo;
+			if (!findBinaryOp(m_lex.current(), bo) || bo.left < precedence)
+				break;
+			m_lex.next();
+			parseExpression(bo.right);
+
+			// x^k, with a small integer constant k: use multiplications
+			double k;
+			if (bo.op == Op::Pow && lastIsConst(k) && k == std::trunc(k) &&
+				std::abs(k) <= 64)
+			{
+				m_prog.m_code.back() = {Op::PowInt, int32_t(k)};
+				m_prog.m_consts.pop_back();
+				m_stack--;
+			}
+			else
+				emit(bo.op, 0, -1);
+
+			if (precedence == 0) parseTernary();
+		}
+	}
+
+	void parseTernary()
+	{
+		if (!isOperator("?")) return;
+		m_lex.next();
+		parseExpression(0);
+		expect(":");
+		parseExpression(0);
+		emit(Op::Select, 0, -2);
+	}
+
+	void parseBranch()
+	{
+		const Token t = m_lex.current();
+		switch (t.kind)
+		{
+			case Token::Number:
+				m_lex.next();
+				emitConst(m_symbols.number(t.text));
+				return;
+			case Token::Symbol:
+				m_lex.next();
+				parseSymbol(t.text);
+				return;
+			case Token::Operator:
+				break;
+			default:
+				throw Unsupported();
+		};
+
+		if (t.text == "(" || t.text == "[" || t.text == "{")
+		{
+			m_lex.next();
+			parseExpression(0);
+			expect(t.text == "(" ? ")" : (t.text == "[" ? "]" : "}"));
+		}
+		else if (t.text == "-")
+		{
+			m_lex.next();
+			parseExpression(11);
+			double v;
+			if (lastIsConst(v))
+				m_prog.m_consts[m_prog.m_code.back().arg] = -v;
+			else
+				emit(Op::Neg, 0, 0);
+		}
+		else if (t.text == "+")
+		{
+			m_lex.next();
+			parseExpression(13);
+		}
+		else
+			throw Unsupported();
+	}
+
+	void parseSymbol(std::string name)
+	{
+		std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+		if (isOperator("("))
+		{
+			const auto it = functions().find(name);
+			if (it == functions().end()) throw Unsupported();
+			m_lex.next();
+			int n = 0;
+			if (!isOperator(")"))
+			{
+				for (;;)
+				{
+					parseExpression(0);
+					n++;
+					if (!isOperator(",")) break;
+					m_lex.next();
+				}
+			}
+			expect(")");
+
+			const FunctionDef& f = it->second;
+			if ((f.numArgs != 0 && n != f.numArgs) || n == 0)
+				throw Unsupported();
+			emit(f.op, n, 1 - n);
+			return;
+		}
+
+		if (name == "true" || name == "false")
+		{
+			emitConst(name == "true" ? 1.0 : 0.0);
+			return;
+		}
+
+		const double* var = m_symbols.variable(name);
+		if (!var) throw Unsupported();
+		auto& vars = m_prog.m_vars;
+		auto it = std::find(vars.begin(), vars.end(), var);
+		if (it == vars.end()) it = vars.insert(vars.end(), var);
+		emit(Op::PushVar, int32_t(it - vars.begin()), +1);
+	}
+};
+}  // namespace mrpt::expr::internal
+
+std::shared_ptr<const VectorizedProgram> VectorizedProgram::compile(
+	const std::string& expression, const VectorizedSymbolResolver& symbols)
+{
+	auto prog = std::make_shared<VectorizedProgram>();
+	try
+	{
+		VectorizedCompiler(expression, symbols, *prog).run();
+	}
+	catch (const Unsupported&)
+	{
+		return {};
+	}
+	return prog;
+}
+
+namespace
+{
+inline double powInt(double x, int32_t k)
+{
+	const bool inv = k < 0;
+	auto e = static_cast<uint32_t>(inv ? -k : k);
+	double r = 1.0;
+	while (e)
+	{
+		if (e & 1) r *= x;
+		x *= x;
+		e >>= 1;
+	}
+	return inv ? 1.0 / r : r;
+}
+
+template <typename F>
+inline void unaryLoop(const double* a, double* out, size_t n, F f)
+{
+	for (size_t i = 0; i < n; i++)
+		out[i] = f(a[i]);
+}
+
+template <typename F>
+inline void binaryLoop(
+	const double* a, const double* b, double* out, size_t n, F f)
+{
+	for (size_t i = 0; i < n; i++)
+		out[i] = f(a[i], b[i]);
+}
+
+template <typename F>
+inline void naryLoop(
+	const double* const* args, int32_t nArgs, double* out, size_t n, F f)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		double v = args[0][i];
+		for (int32_t k = 1; k < nArgs; k++)
+			v = f(v, args[k][i]);
+		out[i] = v;
+	}
+}
+}  // namespace
+
+void VectorizedProgram::eval(
+	const std::vector<std::pair<const double*, const double*>>& columns,
+	size_t N, double* out) const
+{
+	constexpr size_t B = BLOCK;
+
+	// Scratch space: one block per stack level, plus broadcasted values of
+	// constants and non-batched variables:
+	std::vector<double> scratch(B * (m_maxStack + m_consts.size()));
+	double* stackBufs = scratch.data();
+	double* constBufs = stackBufs + B * m_maxStack;
+	for (size_t i = 0; i < m_consts.size(); i++)
+		std::fill(constBufs + i * B, constBufs + (i + 1) * B, m_consts[i]);
+
+	std::vector<const double*> varColumn(m_vars.size(), nullptr);
+	std::vector<double> varBufs;
+	for (size_t i = 0; i < m_vars.size(); i++)
+		for (const auto& c : columns)
+			if (c.first == m_vars[i]) varColumn[i] = c.second;
+	for (size_t i = 0; i < m_vars.size(); i++)
+	{
+		if (varColumn[i]) continue;
+		varBufs.resize(varBufs.size() + B, *m_vars[i]);
+	}
+	std::vector<const double*> varBlock(m_vars.size());
+	for (size_t i = 0, j = 0; i < m_vars.size(); i++)
+		if (!varColumn[i]) varBlock[i] = varBufs.data() + B * (j++);
+
+	std::vector<const double*> stack(m_maxStack);
+
+	for (size_t i0 = 0; i0 < N; i0 += B)
+	{
+		const size_t n = std::min(B, N - i0);
+		for (size_t i = 0; i < m_vars.size(); i++)
+			if (varColumn[i]) varBlock[i] = varColumn[i] + i0;
+
+		// The result at stack position `sp` is always stored in
+		// stackBufs[sp], so in-place operations never overwrite another
+		// operand:
+		size_t sp = 0;
+		for (const Instr& ins : m_code)
+		{
+			switch (ins.op)
+			{
+				case Op::PushVar:
+					stack[sp++] = varBlock[ins.arg];
+					continue;
+				case Op::PushConst:
+					stack[sp++] = constBufs + B * ins.arg;
+					continue;
+				default:
+					break;
+			};
+
+			if (ins.op < Op::Add)
+			{
+				const double* a = stack[sp - 1];
+				double* o = stackBufs + B * (sp - 1);
+				stack[sp - 1] = o;
+				switch (ins.op)
+				{
+					// clang-format off
+					case Op::Neg: unaryLoop(a, o, n, [](double x) { return -x; }); break;
+					case Op::Not: unaryLoop(a, o, n, [](double x) { return x != 0 ? 0.0 : 1.0; }); break;
+					case Op::Abs: unaryLoop(a, o, n, [](double x) { return std::abs(x); }); break;
+					case Op::Sqrt: unaryLoop(a, o, n, [](double x) { return std::sqrt(x); }); break;
+					case Op::Exp: unaryLoop(a, o, n, [](double x) { return std::exp(x); }); break;
+					case Op::Log: unaryLoop(a, o, n, [](double x) { return std::log(x); }); break;
+					case Op::Log10: unaryLoop(a, o, n, [](double x) { return std::log10(x); }); break;
+					case Op::Log2: unaryLoop(a, o, n, [](double x) { return std::log(x) / log_2; }); break;
+					case Op::Sin: unaryLoop(a, o, n, [](double x) { return std::sin(x); }); break;
+					case Op::Cos: unaryLoop(a, o, n, [](double x) { return std::cos(x); }); break;
+					case Op::Tan: unaryLoop(a, o, n, [](double x) { return std::tan(x); }); break;
+					case Op::Asin: unaryLoop(a, o, n, [](double x) { return std::asin(x); }); break;
+					case Op::Acos: unaryLoop(a, o, n, [](double x) { return std::acos(x); }); break;
+					case Op::Atan: unaryLoop(a, o, n, [](double x) { return std::atan(x); }); break;
+					case Op::Sinh: unaryLoop(a, o, n, [](double x) { return std::sinh(x); }); break;
+					case Op::Cosh: unaryLoop(a, o, n, [](double x) { return std::cosh(x); }); break;
+					case Op::Tanh: unaryLoop(a, o, n, [](double x) { return std::tanh(x); }); break;
+					case Op::Floor: unaryLoop(a, o, n, [](double x) { return std::floor(x); }); break;
+					case Op::Ceil: unaryLoop(a, o, n, [](double x) { return std::ceil(x); }); break;
+					case Op::Round: unaryLoop(a, o, n, [](double x) { return x < 0 ? std::ceil(x - 0.5) : std::floor(x + 0.5); }); break;
+					case Op::Trunc: unaryLoop(a, o, n, [](double x) { return double(static_cast<long long>(x)); }); break;
+					case Op::Frac: unaryLoop(a, o, n, [](double x) { return x - static_cast<long long>(x); }); break;
+					case Op::Sgn: unaryLoop(a, o, n, [](double x) { return x > 0 ? 1.0 : (x < 0 ? -1.0 : 0.0); }); break;
+					case Op::Deg2Rad: unaryLoop(a, o, n, [](double x) { return x * pi_180; }); break;
+					case Op::Rad2Deg: unaryLoop(a, o, n, [](double x) { return x * _180_pi; }); break;
+					case Op::PowInt: { const int32_t k = ins.arg; unaryLoop(a, o, n, [k](double x) { return powInt(x, k); }); } break;
+					// clang-format on
+					default:
+						THROW_EXCEPTION("Unexpected opcode");
+				};
+			}
+			else if (ins.op < Op::Select)
+			{
+				const double* a = stack[sp - 2];
+				const double* b = stack[sp - 1];
+				double* o = stackBufs + B * (sp - 2);
+				stack[sp - 2] = o;
+				sp--;
+				switch (ins.op)
+				{
+					// clang-format off
+					case Op::Add: binaryLoop(a, b, o, n, [](double x, double y) { return x + y; }); break;
+					case Op::Sub: binaryLoop(a, b, o, n, [](double x, double y) { return x - y; }); break;
+					case Op::Mul: binaryLoop(a, b, o, n, [](double x, double y) { return x * y; }); break;
+					case Op::Div: binaryLoop(a, b, o, n, [](double x, double y) { return x / y; }); break;
+					case Op::Mod: binaryLoop(a, b, o, n, [](double x, double y) { return std::fmod(x, y); }); break;
+					case Op::Pow: binaryLoop(a, b, o, n, [](double x, double y) { return std::pow(x, y); }); break;
+					case Op::Lt: binaryLoop(a, b, o, n, [](double x, double y) { return x < y ? 1.0 : 0.0; }); break;
+					case Op::Lte: binaryLoop(a, b, o, n, [](double x, double y) { return x <= y ? 1.0 : 0.0; }); break;
+					case Op::Gt: binaryLoop(a, b, o, n, [](double x, double y) { return x > y ? 1.0 : 0.0; }); break;
+					case Op::Gte: binaryLoop(a, b, o, n, [](double x, double y) { return x >= y ? 1.0 : 0.0; }); break;
+					case Op::Eq: binaryLoop(a, b, o, n, [](double x, double y) { return x == y ? 1.0 : 0.0; }); break;
+					case Op::Ne: binaryLoop(a, b, o, n, [](double x, double y) { return x != y ? 1.0 : 0.0; }); break;
+					case Op::And: binaryLoop(a, b, o, n, [](double x, double y) { return x != 0 && y != 0 ? 1.0 : 0.0; }); break;
+					case Op::Or: binaryLoop(a, b, o, n, [](double x, double y) { return x != 0 || y != 0 ? 1.0 : 0.0; }); break;
+					case Op::Atan2: binaryLoop(a, b, o, n, [](double x, double y) { return std::atan2(x, y); }); break;
+					case Op::Hypot: binaryLoop(a, b, o, n, [](double x, double y) { return std::sqrt(x * x + y * y); }); break;
+					// clang-format on
+					default:
+						THROW_EXCEPTION("Unexpected opcode");
+				};
+			}
+			else if (ins.op < Op::Min)
+			{
+				const double* a = stack[sp - 3];
+				const double* b = stack[sp - 2];
+				const double* c = stack[sp - 1];
+				double* o = stackBufs + B * (sp - 3);
+				stack[sp - 3] = o;
+				sp -= 2;
+				if (ins.op == Op::Select)
+				{
+					for (size_t i = 0; i < n; i++)
+						o[i] = a[i] != 0 ? b[i] : c[i];
+				}
+				else  // clamp(lo, x, hi)
+				{
+					for (size_t i = 0; i < n; i++)
+						o[i] = b[i] < a[i] ? a[i] : (b[i] > c[i] ? c[i] : b[i]);
+				}
+			}
+			else
+			{
+				const int32_t nArgs = ins.arg;
+				const double* const* args = &stack[sp - nArgs];
+				double* o = stackBufs + B * (sp - nArgs);
+				switch (ins.op)
+				{
+					case Op::Min:
+						naryLoop(args, nArgs, o, n, [](double x, double y) {
+							return std::min(x, y);
+						});
+						break;
+					case Op::Max:
+						naryLoop(args, nArgs, o, n, [](double x, double y) {
+							return std::max(x, y);
+						});
+						break;
+					default:
+						naryLoop(args, nArgs, o, n, [](double x, double y) {
+							return x + y;
+						});
+						if (ins.op == Op::Avg)
+							for (size_t i = 0; i < n; i++)
+								o[i] /= nArgs;
+						break;
+				};
+				sp -= nArgs - 1;
+				stack[sp - 1] = o;
+			}
+		}
+		ASSERT_EQUAL_(sp, 1U);
+		std::copy(stack[0], stack[0] + n, out + i0);
+	}
+}
@@ -0,0 +1,136 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mrpt::expr::internal
+{
+/** Used by VectorizedProgram::compile() to look up symbols and parse number
+ * literals exactly as exprtk does. */
+struct VectorizedSymbolResolver
+{
+	virtual ~VectorizedSymbolResolver() = default;
+	/** Returns the storage of a variable or constant (case insensitive), or
+	 * nullptr if it is not defined. */
+	virtual const double* variable(const std::string& name) const = 0;
+	/** Converts a number literal into its value */
+	virtual double number(const std::string& literal) const = 0;
+};
+
+/** A formula compiled into a stack bytecode that is evaluated for a whole
+ * array of variable values at once, in blocks of `BLOCK` elements: each
+ * instruction runs a tight loop over a block, so the interpretation overhead
+ * is paid once per block instead of once per element.
+ *
+ * Only a subset of the exprtk language is supported: number literals,
+ * variables and constants, the arithmetic (`+ - * / % ^`), comparison and
+ * logical (`and or & |`) operators, the ternary `c ? a : b` and `if(c,a,b)`,
+ * and the usual math functions. Any other formula makes compile() return
+ * nullptr, so the caller falls back to evaluating it element by element.
+ * Operator precedence and associativity replicate those of exprtk.
+ */
+class VectorizedProgram
+{
+   public:
+	constexpr static size_t BLOCK = 256;
+
+	/** Returns nullptr if the expression has any unsupported feature or
+	 * syntax error. */
+	static std::shared_ptr<const VectorizedProgram> compile(
+		const std::string& expression, const VectorizedSymbolResolver& symbols);
+
+	/** Evaluates the program for `N` elements. Variables found in `columns`
+	 * (pairs of `variable storage` -> `array of N values`) take one value
+	 * per element; all others keep their current value for all elements. */
+	void eval(
+		const std::vector<std::pair<const double*, const double*>>& columns,
+		size_t N, double* out) const;
+
+	enum class Op : uint8_t
+	{
+		PushVar,
+		PushConst,
+		// Unary:
+		Neg,
+		Not,
+		Abs,
+		Sqrt,
+		Exp,
+		Log,
+		Log10,
+		Log2,
+		Sin,
+		Cos,
+		Tan,
+		Asin,
+		Acos,
+		Atan,
+		Sinh,
+		Cosh,
+		Tanh,
+		Floor,
+		Ceil,
+		Round,
+		Trunc,
+		Frac,
+		Sgn,
+		Deg2Rad,
+		Rad2Deg,
+		PowInt,
+		// Binary:
+		Add,
+		Sub,
+		Mul,
+		Div,
+		Mod,
+		Pow,
+		Lt,
+		Lte,
+		Gt,
+		Gte,
+		Eq,
+		Ne,
+		And,
+		Or,
+		Atan2,
+		Hypot,
+		// Ternary:
+		Select,
+		Clamp,
+		// N-ary:
+		Min,
+		Max,
+		Sum,
+		Avg
+	};
+
+	struct Instr
+	{
+		Op op;
+		/** Variable or constant index, integer exponent (PowInt) or number
+		 * of arguments (N-ary) */
+		int32_t arg = 0;
+	};
+
+   private:
+	std::vector<Instr> m_code;
+	std::vector<const double*> m_vars;
+	std::vector<double> m_consts;
+	size_t m_maxStack = 0;
+
+	friend class VectorizedCompiler;
+};
+
+}  // namespace mrpt::expr::internal
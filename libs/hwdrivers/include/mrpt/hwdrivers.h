@@ -63,6 +63,7 @@ MRPT_WARNING(
 #include <mrpt/hwdrivers/CServoeNeck.h>
 #include <mrpt/hwdrivers/CSickLaserSerial.h>
 #include <mrpt/hwdrivers/CSickLaserUSB.h>
+#include <mrpt/hwdrivers/CSimulatedSensor.h>
 #include <mrpt/hwdrivers/CSkeletonTracker.h>
 #include <mrpt/hwdrivers/CStereoGrabber_Bumblebee_libdc1394.h>
 #include <mrpt/hwdrivers/CStereoGrabber_SVS.h>
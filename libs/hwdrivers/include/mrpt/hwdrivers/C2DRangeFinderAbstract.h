@@ -16,6 +16,9 @@
 #include <mrpt/serialization/CArchive.h>
 #include <mrpt/system/COutputLogger.h>
 
+#include <memory>
+#include <mutex>
+
 namespace mrpt::hwdrivers
 {
 /** This is the base, abstract class for "software drivers" interfaces to 2D
@@ -52,6 +55,21 @@ class C2DRangeFinderAbstract : public mrpt::system::COutputLogger,
 	/** A dynamic object used as buffer in doProcess */
 	mrpt::obs::CObservation2DRangeScan::Ptr m_nextObservation;
 
+	/** Observations released by their last owner, to be reused by
+	 * doProcess(). Shared with the deleter of the emitted smart pointers,
+	 * which may outlive this object. \sa enableObservationRecycling */
+	struct TObsPool
+	{
+		std::mutex mtx;
+		std::vector<std::unique_ptr<mrpt::obs::CObservation2DRangeScan>> free;
+		size_t maxSize = 0;
+	};
+	std::shared_ptr<TObsPool> m_obsPool = std::make_shared<TObsPool>();
+
+	/** Returns a recycled observation from m_obsPool, if available, or a new
+	 * one otherwise. */
+	mrpt::obs::CObservation2DRangeScan::Ptr newObservation();
+
 	/** A list of optional exclusion polygons, in coordinates relative to the
 	 * vehicle, that is, taking into account the "sensorPose". */
 	mrpt::obs::CObservation2DRangeScan::TListExclusionAreasWithRanges
@@ -115,6 +133,18 @@ class C2DRangeFinderAbstract : public mrpt::system::COutputLogger,
 
 	/** Enables GUI visualization in real-time */
 	void showPreview(bool enable = true) { m_showPreview = enable; }
+
+	/** If enabled, observations emitted by doProcess() are returned to a
+	 * pool of up to `poolSize` objects when their last smart pointer is
+	 * released, and those objects (together with their already-allocated
+	 * range buffers) are reused for new scans.
+	 * This avoids one allocation per scan and per buffer for high-rate
+	 * sensors. Disabled by default, except in drivers where stated.
+	 * \note Do not keep raw pointers or references to observations returned
+	 * by getObservations() after dropping the smart pointers, since the
+	 * object may be overwritten with a new scan.
+	 */
+	void enableObservationRecycling(bool enable = true, size_t poolSize = 8);
 	/** Binds the object to a given I/O channel.
 	 *  The stream object must not be deleted before the destruction of this
 	 * class.
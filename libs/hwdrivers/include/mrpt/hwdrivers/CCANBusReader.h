@@ -10,24 +10,33 @@
 
 #include <mrpt/comms/CSerialPort.h>
 #include <mrpt/hwdrivers/CGenericSensor.h>
+#include <mrpt/io/CTextFileLinesParser.h>
 #include <mrpt/obs/CObservationCANBusJ1939.h>
+#include <mrpt/obs/CObservationCANBusJ1939Batch.h>
 #include <mrpt/system/COutputLogger.h>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace mrpt::hwdrivers
 {
-/** This "software driver" implements the communication protocol for interfacing
- * a SICK LMS 2XX laser scanners through a standard RS232 serial port (or a
- * USB2SERIAL converter).
+/** This "software driver" implements the communication protocol for
+ * interfacing a CAN BUS (J1939 protocol) through a serial-port CAN
+ * converter which outputs frames in ASCII format ("T" + ID + DLC + data).
  *   The serial port is opened upon the first call to "doProcess" or
- * "initialize", so you must call "loadConfig" before
- *   this, or manually call "setSerialPort". Another alternative is to call the
- * base class method C2DRangeFinderAbstract::bindIO,
- *   but the "setSerialPort" interface is probably much simpler to use.
+ * "initialize", so you must call "loadConfig" before this, or manually call
+ * "setSerialPort".
+ *
+ * By default, one mrpt::obs::CObservationCANBusJ1939 is generated per frame.
+ * At high bus loads, enable the batch mode (see setBatchMode()) to group
+ * many frames into each mrpt::obs::CObservationCANBusJ1939Batch instead.
+ * Frame ID filters (see setFrameFilters()) are applied before any
+ * observation is created, so discarded frames cost no memory allocations.
  *
- *   For an example of usage see the example in
- * "samples/SICK_laser_serial_test".
- *   See also the example configuration file for rawlog-grabber in
- * "share/mrpt/config_files/rawlog-grabber".
+ * Instead of reading from a serial port, frames can be replayed from a text
+ * file in the format of the Linux can-utils `candump` program (see
+ * setReplayFile()), which is useful for testing without hardware.
  *
  *  \code
  *  PARAMETERS IN THE ".INI"-LIKE CONFIGURATION STRINGS:
@@ -35,37 +44,79 @@ namespace mrpt::hwdrivers
  *   [supplied_section_name]
  *   COM_port_WIN = COM1   // Serial port to connect to
  *   COM_port_LIN = ttyS0
+ *   COM_baudRate = 57600  // Possible values: 9600, 38400, 57600, 500000
+ *   nTries_connect = 1
+ *   CANBusSpeed  = 250000 // CAN bus speed (bps)
  *
- *   COM_baudRate = 38400 // Possible values: 9600 (default), 38400, 5000000
- *   mm_mode      = 1/0   // 1: millimeter mode, 0:centimeter mode (Default=0)
- *   FOV          = 180   // Field of view: 100 or 180 degrees (Default=180)
- *   resolution   =  50   // Scanning resolution, in units of 1/100 degree.
- * Valid values: 25,50,100 (Default=50)
+ *   // Optional: frame ID filters, in `candump` syntax:
+ *   //  <id>:<mask>  accepts frames with (frame_id & mask) == (id & mask)
+ *   //  <id>~<mask>  accepts frames with (frame_id & mask) != (id & mask)
+ *   //  <id>         accepts only the given ID.
+ *   // A frame is accepted if it passes any of the filters. Default: all.
+ *   frame_filters = 18FEF100:00FFFF00, 0CF00400
  *
+ *   batch_mode       = false // true: generate CObservationCANBusJ1939Batch
+ *   batch_max_frames = 256   // Maximum number of frames per batch
+ *   batch_max_period = 0.1   // Maximum time (seconds) collecting one batch
  *
- *   pose_x=0.21	// Laser range scaner 3D position in the robot (meters)
- *   pose_y=0
- *   pose_z=0.34
- *   pose_yaw=0	// Angles in degrees
- *   pose_pitch=0
- *   pose_roll=0
+ *   // Optional: replay frames from a `candump -l` log file instead of
+ *   // reading a serial port:
+ *   replay_file  = can_log.log
+ *   replay_speed = 1.0  // Time scale factor. 0: as fast as possible.
  *  \endcode
  *
- * \sa C2DRangeFinderAbstract
  * \ingroup mrpt_hwdrivers_grp
  */
 class CCANBusReader : public mrpt::system::COutputLogger, public CGenericSensor
 {
 	DEFINE_GENERIC_SENSOR(CCANBusReader)
 
+   public:
+	/** One CAN frame, as decoded from the serial converter or a log file */
+	struct TFrame
+	{
+		/** Frame identifier, including the
+		 * mrpt::obs::CObservationCANBusJ1939Batch::EXTENDED_ID_FLAG bit */
+		uint32_t id = 0;
+		mrpt::Clock::time_point timestamp;
+		/** Number of valid bytes in `data` */
+		uint8_t dlc = 0;
+		uint8_t data[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	};
+
+	/** A frame ID filter, with the same semantics than Linux SocketCAN
+	 * filters: a frame passes if `(frame_id & mask) == (id & mask)`, or if
+	 * they differ and `invert` is true. IDs do not include the
+	 * extended-frame flag bit. */
+	struct TFrameFilter
+	{
+		TFrameFilter() = default;
+		TFrameFilter(uint32_t id_, uint32_t mask_, bool invert_ = false)
+			: id(id_), mask(mask_), invert(invert_)
+		{
+		}
+
+		uint32_t id = 0;
+		uint32_t mask = 0x1FFFFFFF;
+		bool invert = false;
+
+		bool matches(uint32_t frameId) const
+		{
+			return (((frameId ^ id) & mask) == 0) != invert;
+		}
+	};
+
    private:
 	/** Tries to open the com port and setup all the LMS protocol. Returns true
 	 * if OK or already open. */
 	bool tryToOpenComms(std::string* err_msg = nullptr);
-	bool waitContinuousSampleFrame(
-		uint8_t& out_prio, uint8_t& out_pdu_format, uint8_t& out_pdu_spec,
-		uint8_t& out_src_address, uint8_t& out_data_length, uint16_t& out_pgn,
-		std::vector<uint8_t>& out_data, std::vector<char>& out_raw_frame);
+	/** Reads one frame from the serial port. The ASCII frame is kept in
+	 * m_last_raw_frame. */
+	bool waitContinuousSampleFrame(TFrame& out);
+	/** Reads the next frame from the serial port or the replay file */
+	bool readNextFrame(TFrame& out);
+	bool readNextReplayFrame(TFrame& out);
+	void doProcessBatch();
 
 	/** Sends the specified speed to the CAN Converter. */
 	bool sendCANBusReaderSpeed();
@@ -104,6 +155,26 @@ class CCANBusReader : public mrpt::system::COutputLogger, public CGenericSensor
 	bool m_CANBusChannel_isOpen{
 		false};	 // if the can bus channel is open or not
 
+	std::vector<TFrameFilter> m_frame_filters;
+	bool m_batch_mode{false};
+	size_t m_batch_max_frames{256};
+	double m_batch_max_period{0.1};
+	/** The ASCII contents of the last frame read from the serial port */
+	std::vector<char> m_last_raw_frame;
+	size_t m_frames_received{0}, m_frames_filtered{0};
+
+	std::string m_replay_file;
+	double m_replay_speed{1.0};
+	mrpt::io::CTextFileLinesParser m_replay_parser;
+	bool m_replay_open{false}, m_replay_eof{false};
+	/** Read-ahead frame, waiting for its replay time */
+	TFrame m_replay_next;
+	bool m_replay_has_next{false};
+	bool m_replay_started{false};
+	double m_replay_t0_file{0};
+	mrpt::Clock::time_point m_replay_t0_wall;
+	std::string m_replay_line;
+
    protected:
 	/** See the class documentation at the top for expected parameters */
 	void loadConfig_sensorSpecific(
@@ -169,6 +240,65 @@ class CCANBusReader : public mrpt::system::COutputLogger, public CGenericSensor
 
 	void doProcess() override;
 
+	/** Sets the frame ID filters (see TFrameFilter). A frame is accepted if
+	 * it passes any of them. An empty list (default) accepts all frames.
+	 *  \sa parseFrameFilters */
+	void setFrameFilters(const std::vector<TFrameFilter>& filters)
+	{
+		m_frame_filters = filters;
+	}
+	const std::vector<TFrameFilter>& getFrameFilters() const
+	{
+		return m_frame_filters;
+	}
+	/** Checks a frame ID (with or without the extended-frame flag) against
+	 * the current filters */
+	bool isFrameAccepted(uint32_t frameId) const;
+
+	/** Enables generating one mrpt::obs::CObservationCANBusJ1939Batch per
+	 * call to doProcess(), with up to `maxFrames` frames, or those received
+	 * during `maxPeriod_s` seconds, whatever happens first.
+	 * Otherwise (default), one mrpt::obs::CObservationCANBusJ1939 is
+	 * generated per frame. */
+	void setBatchMode(
+		bool enable, size_t maxFrames = 256, double maxPeriod_s = 0.1);
+	bool getBatchMode() const { return m_batch_mode; }
+
+	/** Reads frames from the given `candump` log file instead of the serial
+	 * port (call prior to 'doProcess').
+	 * \param replaySpeed Time scale factor (2.0=twice faster). Frame
+	 * timestamps are shifted to the present time. Use 0 to read frames as
+	 * fast as possible, keeping their original timestamps.
+	 */
+	void setReplayFile(
+		const std::string& candumpFile, double replaySpeed = 1.0);
+
+	/** Number of frames read so far, and how many of them were discarded by
+	 * the ID filters. */
+	size_t getFramesReceived() const { return m_frames_received; }
+	size_t getFramesFiltered() const { return m_frames_filtered; }
+
+	/** Parses a list of frame filters in the `candump` syntax, separated by
+	 * commas or spaces, e.g. `"18FEF100:00FFFF00,0CF00400~1FFFFFFF,123"`.
+	 * IDs and masks are in hexadecimal.
+	 * \exception std::exception On syntax errors. */
+	static std::vector<TFrameFilter> parseFrameFilters(const std::string& s);
+
+	/** Parses one line of a `candump` text log, either in the log file
+	 * format (`candump -l`), e.g. `(1436509052.249713) can0 18FEF100#0102`,
+	 * or the timestamped console format (`candump -ta`), e.g.
+	 * `(1436509052.249713) can0 18FEF100 [2] 01 02`. IDs with more than 3
+	 * hexadecimal digits are taken as extended ones.
+	 * \return false if the line is not a valid classic CAN data frame.
+	 */
+	static bool parseCandumpLine(const std::string& line, TFrame& out);
+
+	/** Decodes one ASCII frame from the serial converter
+	 * ("T" + 8 hex ID + 1 hex DLC + 2*DLC hex data + [CR]).
+	 * \return false if the frame is malformed. */
+	static bool decodeSerialFrame(
+		const uint8_t* buf, size_t len, TFrame& out);
+
 };	// End of class
 
 }  // namespace mrpt::hwdrivers
@@ -258,6 +258,20 @@ class CHokuyoURG : public C2DRangeFinderAbstract
 
 	void sendCmd(const char* str);
 
+	/** Decodes the SCIP 2.0 3-character encoded ranges (and, optionally,
+	 * interleaved intensities) of one scan directly into the existing
+	 * buffers of `out`, which is resized to `nRanges` (a no-op, without any
+	 * memory allocation, if it already had that size).
+	 * Ranges below 20 mm or beyond `out.maxRange` are marked as invalid.
+	 * \param data Pointer to the first encoded range, i.e. right after the
+	 * 4-byte timestamp. Line feeds must have been already removed.
+	 * \param len Number of bytes available in `data`.
+	 * \exception std::exception If `len` is too small for `nRanges`.
+	 */
+	static void decodeScanData(
+		const char* data, size_t len, size_t nRanges, bool withIntensity,
+		mrpt::obs::CObservation2DRangeScan& out);
+
    protected:
 	/** temp buffer for incoming data packets */
 	std::string m_rcv_data;
@@ -0,0 +1,224 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#pragma once
+
+#include <mrpt/core/Clock.h>
+#include <mrpt/hwdrivers/CGenericSensor.h>
+#include <mrpt/io/CFileGZInputStream.h>
+#include <mrpt/obs/CObservation.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace mrpt::hwdrivers
+{
+/** A hardware-agnostic "virtual sensor", useful to load-test rawlog-grabber
+ * (mrpt::apps::RawlogGrabberApp) and any other consumer of
+ * CGenericSensor::getObservations() without real devices.
+ *
+ * Observations are either replayed from an existing rawlog file, or
+ * synthesized (2D lidar scans, IMU readings or camera images) at a
+ * configurable rate and size. Emission times follow a nominal period plus
+ * zero-mean Gaussian jitter (clamped to +-3 sigma, and never reordering
+ * observations), and "bursts" (several observations held back and then
+ * delivered at once, as happens with buffered USB/Ethernet drivers) can be
+ * randomly injected.
+ *
+ * Timing is decoupled from `process_rate`: each call to doProcess() emits
+ * all observations whose delivery time has already elapsed, so `process_rate`
+ * only needs to be high enough to resolve the desired timing accuracy. Since
+ * no extra threads are created, dozens of instances can be run within one
+ * process.
+ *
+ * Use getStats() to retrieve the achieved output rate and the worst delivery
+ * backlog, which can be used to find the throughput ceiling of the
+ * acquisition pipeline.
+ *
+ *  \code
+ *  PARAMETERS IN THE ".INI"-LIKE CONFIGURATION STRINGS:
+ * -------------------------------------------------------
+ *   [supplied_section_name]
+ *    driver        = CSimulatedSensor
+ *    process_rate  = 200            // Hz: doProcess() call rate
+ *    sensorLabel   = SIM_LIDAR1
+ *
+ *    # One of: LIDAR_2D, IMU, CAMERA, RAWLOG
+ *    simulation_mode = LIDAR_2D
+ *
+ *    rate_hz          = 40     // (Synthetic modes) Nominal output rate
+ *    jitter_std_ms    = 0.5    // Std. dev. of emission time jitter
+ *    burst_probability= 0.01   // Probability of starting a burst
+ *    burst_length     = 5      // Number of observations in each burst
+ *    random_seed      = -1     // <0: random seed from the clock
+ *
+ *    # LIDAR_2D mode:
+ *    scan_rays        = 1081
+ *    scan_aperture_deg= 270
+ *    scan_max_range   = 30.0
+ *
+ *    # CAMERA mode:
+ *    image_width      = 640
+ *    image_height     = 480
+ *
+ *    # RAWLOG mode:
+ *    rawlog_file        = dataset.rawlog
+ *    rawlog_sensor_label=          // Optional: only replay this sensor
+ *    replay_speed       = 1.0      // Time scale factor (2.0=twice faster)
+ *    replay_loop        = true     // Restart the rawlog when reaching EOF
+ *
+ *    pose_x=0 pose_y=0 pose_z=0 pose_yaw=0 pose_pitch=0 pose_roll=0 // (deg)
+ *  \endcode
+ *
+ * Observations generated in synthetic modes have their timestamps set to the
+ * (jittered) acquisition time. Replayed observations keep their relative
+ * timing, scaled by `replay_speed`, but timestamps are shifted to the
+ * present time. They also keep their original `sensorLabel`, unless
+ * `sensorLabel` is given in the configuration block (or the stored label is
+ * empty), in which case they are all relabeled. If the rawlog cannot be
+ * reopened to loop over it, doProcess() throws and the sensor enters the
+ * error state (see getState()), emitting nothing else until initialize()
+ * succeeds again.
+ *
+ * \ingroup mrpt_hwdrivers_grp
+ */
+class CSimulatedSensor : public mrpt::hwdrivers::CGenericSensor
+{
+	DEFINE_GENERIC_SENSOR(CSimulatedSensor)
+
+   public:
+	/** Source of the observations emitted by the simulator */
+	enum TSimulationMode
+	{
+		smLIDAR_2D = 0,
+		smIMU,
+		smCAMERA,
+		smRAWLOG
+	};
+
+	/** Output statistics \sa getStats() */
+	struct TStats
+	{
+		/** Number of observations emitted so far */
+		size_t num_observations = 0;
+		/** Number of emission bursts so far */
+		size_t num_bursts = 0;
+		/** Seconds since initialize() */
+		double elapsed_time = 0;
+		/** Average achieved rate [Hz] since initialize() */
+		double achieved_rate_hz = 0;
+		/** Worst observed delay [s] between the ideal delivery time of an
+		 * observation and the moment it was actually emitted. Large values
+		 * mean doProcess() is not being called often enough. */
+		double max_delivery_delay = 0;
+	};
+
+	CSimulatedSensor();
+	~CSimulatedSensor() override = default;
+
+	void initialize() override;
+	void doProcess() override;
+
+	/** Returns a copy of the current statistics (thread-safe) */
+	TStats getStats() const;
+
+	/** @name Programmatic configuration (alternative to loadConfig())
+		@{ */
+	void setSimulationMode(TSimulationMode mode) { m_mode = mode; }
+	TSimulationMode getSimulationMode() const { return m_mode; }
+	void setRate(double rate_hz) { m_rate_hz = rate_hz; }
+	void setJitter(double jitter_std_ms) { m_jitter_std_ms = jitter_std_ms; }
+	void setBurstiness(double burst_probability, size_t burst_length)
+	{
+		m_burst_probability = burst_probability;
+		m_burst_length = burst_length;
+	}
+	void setRawlogFile(
+		const std::string& file, double replay_speed = 1.0, bool loop = true)
+	{
+		m_rawlog_file = file;
+		m_replay_speed = replay_speed;
+		m_replay_loop = loop;
+	}
+	void setRandomSeed(int seed) { m_random_seed = seed; }
+	/** @} */
+
+   protected:
+	void loadConfig_sensorSpecific(
+		const mrpt::config::CConfigFileBase& configSource,
+		const std::string& section) override;
+
+   private:
+	TSimulationMode m_mode = smLIDAR_2D;
+	double m_rate_hz = 10.0;
+	double m_jitter_std_ms = 0;
+	double m_burst_probability = 0;
+	size_t m_burst_length = 5;
+	int m_random_seed = -1;
+
+	size_t m_scan_rays = 361;
+	double m_scan_aperture = M_PI;
+	float m_scan_max_range = 30.0f;
+
+	unsigned int m_image_width = 640, m_image_height = 480;
+
+	std::string m_rawlog_file, m_rawlog_sensor_label;
+	double m_replay_speed = 1.0;
+	bool m_replay_loop = true;
+	/** Whether `sensorLabel` was set in the configuration block */
+	bool m_label_configured = false;
+
+	mrpt::poses::CPose3D m_sensorPose;
+
+	/** One observation scheduled for emission */
+	struct TPending
+	{
+		/** Acquisition time, relative to m_start_time [s] */
+		double t_acquired = 0;
+		/** Delivery time, relative to m_start_time [s] */
+		double t_deliver = 0;
+		/** Only used in RAWLOG mode */
+		mrpt::obs::CObservation::Ptr obs;
+	};
+	std::deque<TPending> m_pending;
+
+	mrpt::random::CRandomGenerator m_rng;
+	mrpt::Clock::time_point m_start_time;
+	size_t m_next_index = 0;
+	/** Acquisition time of the last scheduled observation [s] */
+	double m_last_t_acquired = 0;
+
+	// RAWLOG mode:
+	mrpt::io::CFileGZInputStream m_rawlog_in;
+	std::deque<mrpt::obs::CObservation::Ptr> m_rawlog_sf_queue;
+	std::optional<mrpt::Clock::time_point> m_rawlog_first_stamp;
+	double m_rawlog_loop_offset = 0, m_rawlog_last_t = 0;
+
+	mutable std::mutex m_stats_mtx;
+	TStats m_stats;
+
+	/** Fills m_pending with the next observation, or the next burst of them.
+	 * \return false if there is nothing else to emit (end of rawlog). */
+	bool scheduleNext();
+	mrpt::obs::CObservation::Ptr nextRawlogObservation();
+	mrpt::obs::CObservation::Ptr createSynthetic(double t_acquired);
+};	// End of class def.
+
+}  // namespace mrpt::hwdrivers
+
+MRPT_ENUM_TYPE_BEGIN(mrpt::hwdrivers::CSimulatedSensor::TSimulationMode)
+using namespace mrpt::hwdrivers;
+MRPT_FILL_ENUM_CUSTOM_NAME(CSimulatedSensor::smLIDAR_2D, "LIDAR_2D");
+MRPT_FILL_ENUM_CUSTOM_NAME(CSimulatedSensor::smIMU, "IMU");
+MRPT_FILL_ENUM_CUSTOM_NAME(CSimulatedSensor::smCAMERA, "CAMERA");
+MRPT_FILL_ENUM_CUSTOM_NAME(CSimulatedSensor::smRAWLOG, "RAWLOG");
+MRPT_ENUM_TYPE_END()
@@ -63,8 +63,7 @@ void C2DRangeFinderAbstract::doProcess()
 {
 	bool thereIs, hwError;
 
-	if (!m_nextObservation)
-		m_nextObservation = std::make_shared<CObservation2DRangeScan>();
+	if (!m_nextObservation) m_nextObservation = newObservation();
 
 	doProcessSimple(thereIs, *m_nextObservation, hwError);
 
@@ -84,6 +83,52 @@ void C2DRangeFinderAbstract::doProcess()
 	}
 }
 
+void C2DRangeFinderAbstract::enableObservationRecycling(
+	bool enable, size_t poolSize)
+{
+	std::lock_guard<std::mutex> lck(m_obsPool->mtx);
+	m_obsPool->maxSize = enable ? poolSize : 0;
+	if (m_obsPool->free.size() > m_obsPool->maxSize)
+		m_obsPool->free.resize(m_obsPool->maxSize);
+}
+
+CObservation2DRangeScan::Ptr C2DRangeFinderAbstract::newObservation()
+{
+	std::unique_ptr<CObservation2DRangeScan> o;
+	{
+		std::lock_guard<std::mutex> lck(m_obsPool->mtx);
+		if (!m_obsPool->maxSize)
+			return std::make_shared<CObservation2DRangeScan>();
+		if (!m_obsPool->free.empty())
+		{
+			o = std::move(m_obsPool->free.back());
+			m_obsPool->free.pop_back();
+		}
+	}
+	if (o)
+	{
+		// Reset all fields, but keep the capacity of the range buffers
+		// (hence copy-assign from an lvalue, instead of moving):
+		static const CObservation2DRangeScan blank;
+		*o = blank;
+	}
+	else
+		o = std::make_unique<CObservation2DRangeScan>();
+
+	// Give the object back to the pool once the last owner releases it:
+	std::weak_ptr<TObsPool> wp = m_obsPool;
+	return CObservation2DRangeScan::Ptr(
+		o.release(), [wp](CObservation2DRangeScan* obs) {
+			std::unique_ptr<CObservation2DRangeScan> up(obs);
+			if (auto pool = wp.lock())
+			{
+				std::lock_guard<std::mutex> lck(pool->mtx);
+				if (pool->free.size() < pool->maxSize)
+					pool->free.push_back(std::move(up));
+			}
+		});
+}
+
 void C2DRangeFinderAbstract::internal_notifyGoodScanNow()
 {
 	const auto new_t = mrpt::system::now();
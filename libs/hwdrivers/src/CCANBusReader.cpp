@@ -16,8 +16,11 @@
 #include <mrpt/system/CTicTac.h>
 #include <mrpt/system/crc.h>
 #include <mrpt/system/os.h>
+#include <mrpt/system/string_utils.h>
 
+#include <cctype>
 #include <cstdio>  // printf
+#include <cstdlib>
 #include <cstring>	// memset
 #include <iostream>
 #include <thread>
@@ -47,6 +50,51 @@ char hexCharToInt(char n)
 		return 0;
 }
 
+namespace
+{
+// Returns -1 for non hexadecimal characters
+int hexDigit(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return -1;
+}
+
+const char* skipSpaces(const char* p)
+{
+	while (*p && std::isspace(static_cast<unsigned char>(*p)))
+		++p;
+	return p;
+}
+
+// Parses two hexadecimal digits as one byte
+bool parseHexByte(const char* p, uint8_t& out)
+{
+	const int hi = hexDigit(p[0]);
+	if (hi < 0) return false;
+	const int lo = hexDigit(p[1]);
+	if (lo < 0) return false;
+	out = static_cast<uint8_t>((hi << 4) | lo);
+	return true;
+}
+
+void frameToObservation(
+	const CCANBusReader::TFrame& f, CObservationCANBusJ1939& obs)
+{
+	const uint32_t id =
+		f.id & ~CObservationCANBusJ1939Batch::EXTENDED_ID_FLAG;
+	obs.timestamp = f.timestamp;
+	obs.m_priority = (id >> 26) & 0x07;
+	obs.m_pdu_format = (id >> 16) & 0xFF;
+	obs.m_pdu_spec = (id >> 8) & 0xFF;
+	obs.m_src_address = id & 0xFF;
+	obs.m_pgn = (id >> 8) & 0xFFFF;
+	obs.m_data_length = f.dlc;
+	obs.m_data.assign(f.data, f.data + f.dlc);
+}
+}  // namespace
+
 /*-------------------------------------------------------------
 						CCANBusReader
 -------------------------------------------------------------*/
@@ -83,15 +131,280 @@ CCANBusReader::~CCANBusReader()
 
 void CCANBusReader::doProcess()
 {
-	mrpt::obs::CObservationCANBusJ1939::Ptr obs =
-		mrpt::obs::CObservationCANBusJ1939::Create();
-	bool thereIsObservation;
-	bool hardwareError;
+	if (m_batch_mode)
+	{
+		doProcessBatch();
+		return;
+	}
 
-	doProcessSimple(thereIsObservation, *obs, hardwareError);
-	if (thereIsObservation) appendObservation(obs);
-	else
-		cout << "No frame received" << endl;
+	if (!tryToOpenComms())
+	{
+		m_state = ssError;
+		return;
+	}
+	m_state = ssWorking;
+
+	// Decode and filter the frame before creating any observation:
+	TFrame frame;
+	if (!readNextFrame(frame))
+	{
+		MRPT_LOG_DEBUG("No frame received");
+		return;
+	}
+	if (!isFrameAccepted(frame.id)) return;
+
+	auto obs = mrpt::obs::CObservationCANBusJ1939::Create();
+	frameToObservation(frame, *obs);
+	obs->sensorLabel = m_sensorLabel;
+	obs->m_raw_frame = m_last_raw_frame;
+	appendObservation(obs);
+}
+
+void CCANBusReader::doProcessBatch()
+{
+	if (!tryToOpenComms())
+	{
+		m_state = ssError;
+		return;
+	}
+	m_state = ssWorking;
+
+	auto obs = mrpt::obs::CObservationCANBusJ1939Batch::Create();
+	obs->sensorLabel = m_sensorLabel;
+	obs->reserve(m_batch_max_frames);
+
+	TFrame frame;
+	CTicTac tictac;
+	while (obs->size() < m_batch_max_frames &&
+		   tictac.Tac() < m_batch_max_period)
+	{
+		if (!readNextFrame(frame)) break;
+		if (!isFrameAccepted(frame.id)) continue;
+		obs->push_back(frame.id, frame.timestamp, frame.dlc, frame.data);
+	}
+
+	if (!obs->empty()) appendObservation(obs);
+}
+
+bool CCANBusReader::isFrameAccepted(uint32_t frameId) const
+{
+	if (m_frame_filters.empty()) return true;
+
+	const uint32_t id =
+		frameId & ~CObservationCANBusJ1939Batch::EXTENDED_ID_FLAG;
+	for (const auto& f : m_frame_filters)
+		if (f.matches(id)) return true;
+
+	return false;
+}
+
+void CCANBusReader::setBatchMode(
+	bool enable, size_t maxFrames, double maxPeriod_s)
+{
+	ASSERT_GT_(maxFrames, 0U);
+	ASSERT_GT_(maxPeriod_s, 0);
+	m_batch_mode = enable;
+	m_batch_max_frames = maxFrames;
+	m_batch_max_period = maxPeriod_s;
+}
+
+void CCANBusReader::setReplayFile(
+	const std::string& candumpFile, double replaySpeed)
+{
+	ASSERT_GE_(replaySpeed, 0);
+	m_replay_file = candumpFile;
+	m_replay_speed = replaySpeed;
+	m_replay_open = false;
+	m_replay_eof = false;
+	m_replay_has_next = false;
+	m_replay_started = false;
+}
+
+bool CCANBusReader::readNextFrame(TFrame& out)
+{
+	const bool ok = m_replay_file.empty() ? waitContinuousSampleFrame(out)
+										  : readNextReplayFrame(out);
+	if (!ok) return false;
+
+	m_frames_received++;
+	if (!isFrameAccepted(out.id)) m_frames_filtered++;
+	return true;
+}
+
+bool CCANBusReader::readNextReplayFrame(TFrame& out)
+{
+	if (!m_replay_has_next)
+	{
+		if (m_replay_eof) return false;
+		for (;;)
+		{
+			if (!m_replay_parser.getNextLine(m_replay_line))
+			{
+				m_replay_eof = true;
+				MRPT_LOG_INFO_FMT(
+					"End of replay file '%s'", m_replay_file.c_str());
+				return false;
+			}
+			if (parseCandumpLine(m_replay_line, m_replay_next)) break;
+
+			MRPT_LOG_WARN_FMT(
+				"Ignoring invalid line %u in '%s'",
+				static_cast<unsigned>(m_replay_parser.getCurrentLineNumber()),
+				m_replay_file.c_str());
+		}
+		m_replay_has_next = true;
+	}
+
+	if (m_replay_speed > 0)
+	{
+		// Keep the original relative timing:
+		const double tFile = mrpt::Clock::toDouble(m_replay_next.timestamp);
+		if (!m_replay_started)
+		{
+			m_replay_started = true;
+			m_replay_t0_file = tFile;
+			m_replay_t0_wall = mrpt::Clock::now();
+		}
+		const auto due = m_replay_t0_wall +
+			std::chrono::microseconds(static_cast<int64_t>(
+				1e6 * (tFile - m_replay_t0_file) / m_replay_speed));
+
+		if (mrpt::Clock::now() < due) return false;	 // Not yet.
+		m_replay_next.timestamp = due;
+	}
+
+	out = m_replay_next;
+	m_replay_has_next = false;
+	m_last_raw_frame.clear();
+	return true;
+}
+
+std::vector<CCANBusReader::TFrameFilter> CCANBusReader::parseFrameFilters(
+	const std::string& s)
+{
+	std::vector<TFrameFilter> filters;
+
+	std::vector<std::string> tokens;
+	mrpt::system::tokenize(s, ", \t", tokens);
+	for (const auto& tok : tokens)
+	{
+		TFrameFilter f;
+		const char* p = tok.c_str();
+		char* end;
+		f.id = std::strtoul(p, &end, 16);
+		if (end == p)
+			THROW_EXCEPTION_FMT("Invalid CAN frame filter: '%s'", tok.c_str());
+
+		if (*end == ':' || *end == '~')
+		{
+			f.invert = (*end == '~');
+			p = end + 1;
+			f.mask = std::strtoul(p, &end, 16);
+			if (end == p)
+				THROW_EXCEPTION_FMT(
+					"Invalid CAN frame filter mask: '%s'", tok.c_str());
+		}
+		if (*end != '\0')
+			THROW_EXCEPTION_FMT("Invalid CAN frame filter: '%s'", tok.c_str());
+
+		filters.push_back(f);
+	}
+	return filters;
+}
+
+bool CCANBusReader::parseCandumpLine(const std::string& line, TFrame& out)
+{
+	const char* p = skipSpaces(line.c_str());
+	char* end;
+
+	// "(timestamp)":
+	if (*p != '(') return false;
+	const double t = std::strtod(p + 1, &end);
+	if (end == p + 1 || *end != ')') return false;
+	p = skipSpaces(end + 1);
+
+	// Interface name:
+	if (!*p) return false;
+	while (*p && !std::isspace(static_cast<unsigned char>(*p)))
+	{
+		// Log format without interface name?
+		if (*p == '#') return false;
+		++p;
+	}
+	p = skipSpaces(p);
+
+	// Frame ID:
+	const char* idStart = p;
+	while (hexDigit(*p) >= 0)
+		++p;
+	const size_t idLen = p - idStart;
+	if (idLen == 0 || idLen > 8) return false;
+	const uint32_t id = std::strtoul(idStart, nullptr, 16);
+
+	out.id = idLen > 3 ? (id | CObservationCANBusJ1939Batch::EXTENDED_ID_FLAG)
+					   : id;
+	out.timestamp = mrpt::Clock::fromDouble(t);
+	out.dlc = 0;
+
+	if (*p == '#')
+	{
+		// Log format: "ID#DATA". CAN FD ("##") and remote ("#R") frames are
+		// not supported.
+		++p;
+		while (hexDigit(*p) >= 0)
+		{
+			if (out.dlc >= CObservationCANBusJ1939Batch::MAX_DATA_LENGTH ||
+				!parseHexByte(p, out.data[out.dlc]))
+				return false;
+			out.dlc++;
+			p += 2;
+		}
+		return *skipSpaces(p) == '\0';
+	}
+
+	// Console format: "ID [N] B0 B1 ...":
+	p = skipSpaces(p);
+	if (*p != '[') return false;
+	const unsigned long n = std::strtoul(p + 1, &end, 10);
+	if (end == p + 1 || *end != ']' ||
+		n > CObservationCANBusJ1939Batch::MAX_DATA_LENGTH)
+		return false;
+	p = end + 1;
+	for (unsigned long k = 0; k < n; k++)
+	{
+		p = skipSpaces(p);
+		if (!parseHexByte(p, out.data[k])) return false;
+		p += 2;
+	}
+	out.dlc = static_cast<uint8_t>(n);
+	return true;
+}
+
+bool CCANBusReader::decodeSerialFrame(
+	const uint8_t* buf, size_t len, TFrame& out)
+{
+	if (len < 11 || buf[0] != 'T') return false;
+
+	uint32_t id = 0;
+	for (int k = 1; k <= 8; k++)
+	{
+		const int d = hexDigit(buf[k]);
+		if (d < 0) return false;
+		id = (id << 4) | static_cast<uint32_t>(d);
+	}
+	const int dlc = hexDigit(buf[9]);
+	if (dlc < 0 || dlc > int(CObservationCANBusJ1939Batch::MAX_DATA_LENGTH) ||
+		len != 10U + 2 * dlc + 1U || buf[len - 1] != 0x0D)
+		return false;
+
+	for (int k = 0; k < dlc; k++)
+		if (!parseHexByte(reinterpret_cast<const char*>(buf) + 10 + 2 * k,
+							out.data[k]))
+			return false;
+
+	out.id = id | CObservationCANBusJ1939Batch::EXTENDED_ID_FLAG;
+	out.dlc = static_cast<uint8_t>(dlc);
+	return true;
 }
 
 /*-------------------------------------------------------------
@@ -112,38 +425,14 @@ void CCANBusReader::doProcessSimple(
 
 	m_state = ssWorking;
 
-	// Wait for a scan:
-	uint8_t out_prio, out_pdu_format, out_pdu_spec, out_src_address,
-		out_data_length;
-	uint16_t out_pgn;
-	vector<uint8_t> out_data;
-	vector<char> out_raw_frame;
-	if (!waitContinuousSampleFrame(
-			out_prio, out_pdu_format, out_pdu_spec, out_src_address,
-			out_data_length, out_pgn, out_data, out_raw_frame))
-		return;
+	// Wait for a frame:
+	TFrame frame;
+	if (!readNextFrame(frame) || !isFrameAccepted(frame.id)) return;
 
-	// Yes, we have a new scan:
-	//    cout << "we've got a frame" << endl;
-	// -----------------------------------------------
-	//   Extract the observation:
-	// -----------------------------------------------
-	outObservation.timestamp = mrpt::system::now();
-	outObservation.sensorLabel = m_sensorLabel;	 // Set label
-
-	// And the scan ranges:
-	outObservation.m_priority = out_prio;
-	outObservation.m_pdu_spec = out_pdu_spec;
-	outObservation.m_pdu_format = out_pdu_format;
-	outObservation.m_src_address = out_src_address;
-	outObservation.m_pgn = out_pgn;
-	outObservation.m_data_length = out_data_length;
-	outObservation.m_data.resize(out_data.size());
-	for (size_t k = 0; k < out_data.size(); ++k)
-		outObservation.m_data[k] = out_data[k];
-	outObservation.m_raw_frame.resize(out_raw_frame.size());
-	for (size_t k = 0; k < out_raw_frame.size(); ++k)
-		outObservation.m_raw_frame[k] = out_raw_frame[k];
+	// Yes, we have a new frame:
+	frameToObservation(frame, outObservation);
+	outObservation.sensorLabel = m_sensorLabel;  // Set label
+	outObservation.m_raw_frame = m_last_raw_frame;
 
 	// we've got a new observation
 	outThereIsObservation = true;
@@ -173,6 +462,24 @@ void CCANBusReader::loadConfig_sensorSpecific(
 		configSource.read_int(iniSection, "COM_baudRate", m_com_baudRate);
 	m_nTries_connect =
 		configSource.read_int(iniSection, "nTries_connect", m_nTries_connect);
+
+	m_frame_filters = parseFrameFilters(
+		configSource.read_string(iniSection, "frame_filters", ""));
+
+	setBatchMode(
+		configSource.read_bool(iniSection, "batch_mode", m_batch_mode),
+		configSource.read_uint64_t(
+			iniSection, "batch_max_frames", m_batch_max_frames),
+		configSource.read_double(
+			iniSection, "batch_max_period", m_batch_max_period));
+
+	const auto replayFile =
+		configSource.read_string(iniSection, "replay_file", "");
+	if (!replayFile.empty())
+		setReplayFile(
+			replayFile,
+			configSource.read_double(
+				iniSection, "replay_speed", m_replay_speed));
 }
 
 /*-------------------------------------------------------------
@@ -184,6 +491,17 @@ bool CCANBusReader::tryToOpenComms(std::string* err_msg)
 	if (err_msg) *err_msg = "";
 	try
 	{
+		if (!m_replay_file.empty())
+		{
+			if (!m_replay_open)
+			{
+				// will raise an exception on error:
+				m_replay_parser.open(m_replay_file);
+				m_replay_open = true;
+			}
+			return true;
+		}
+
 		if (!m_mySerialPort)
 		{
 			// There is no COMMS port open yet...
@@ -344,10 +662,7 @@ bool CCANBusReader::CANBusPoll()
 /*-------------------------------------------------------------
 					waitContinuousSampleFrame
 -------------------------------------------------------------*/
-bool CCANBusReader::waitContinuousSampleFrame(
-	uint8_t& out_prio, uint8_t& out_pdu_format, uint8_t& out_pdu_spec,
-	uint8_t& out_src_address, uint8_t& out_data_length, uint16_t& out_pgn,
-	vector<uint8_t>& out_data, vector<char>& out_raw_frame)
+bool CCANBusReader::waitContinuousSampleFrame(TFrame& out)
 {
 	size_t nRead, nBytesToRead;
 	size_t nFrameBytes = 0;
@@ -413,36 +728,22 @@ bool CCANBusReader::waitContinuousSampleFrame(
 		}
 	}  // end while
 
-	// Process frame
-	// convert ASCII text into integer
-	vector<uint8_t> aux;
-	out_raw_frame.resize(nFrameBytes);
-	for (uint8_t k = 0; k < nFrameBytes; ++k)
-	{
-		aux.push_back(hexCharToInt(buf[k]));
-		out_raw_frame[k] = buf[k];
-	}
-
-	out_prio = (aux[1] << 2) | (aux[2] >> 2);
-	out_pdu_format = (aux[3] << 4) | aux[4];
-	out_pdu_spec = (aux[5] << 4) | aux[6];
-	out_src_address = (aux[7] << 4) | aux[8];
-	out_data_length = aux[9];
-	out_pgn = uint16_t(out_pdu_format) << 8 | uint16_t(out_pdu_spec);
-	out_data.resize(out_data_length);
-	for (uint8_t k = 0, k2 = 0; k < 2 * out_data_length; k += 2, k2++)
-		out_data[k2] = (aux[10 + k] << 4) | aux[11 + k];
+	// Process frame:
+	m_last_raw_frame.assign(buf, buf + nFrameBytes);
 
 	if (buf[nFrameBytes - 1] != 0x0D)
 	{
 		cout << format(
 					"[CCANBusReader::waitContinuousSampleFrame] expected 0x0D "
 					"ending flag, 0x%X found instead",
-					buf[nFrameBytes])
+					buf[nFrameBytes - 1])
 			 << endl;
 		return false;  // Bad ending flag
 	}
 
+	if (!decodeSerialFrame(buf, nFrameBytes, out)) return false;
+	out.timestamp = mrpt::system::now();
+
 	// All OK
 	return true;
 }
@@ -0,0 +1,182 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/hwdrivers/CCANBusReader.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/obs/CObservationCANBusJ1939Batch.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/filesystem.h>
+
+#include <fstream>
+
+using namespace mrpt::hwdrivers;
+using mrpt::obs::CObservationCANBusJ1939;
+using mrpt::obs::CObservationCANBusJ1939Batch;
+
+namespace
+{
+const uint32_t EXT = CObservationCANBusJ1939Batch::EXTENDED_ID_FLAG;
+}
+
+TEST(CCANBusReader, parseCandumpLine)
+{
+	CCANBusReader::TFrame f;
+
+	// candump -l format:
+	ASSERT_TRUE(CCANBusReader::parseCandumpLine(
+		"(1436509052.249713) can0 18FEF100#0102030405060708", f));
+	EXPECT_EQ(f.id, 0x18FEF100U | EXT);
+	EXPECT_NEAR(mrpt::Clock::toDouble(f.timestamp), 1436509052.249713, 1e-5);
+	ASSERT_EQ(f.dlc, 8);
+	for (uint8_t k = 0; k < 8; k++)
+		EXPECT_EQ(f.data[k], k + 1);
+
+	ASSERT_TRUE(CCANBusReader::parseCandumpLine("(1.5) vcan0 123#", f));
+	EXPECT_EQ(f.id, 0x123U);
+	EXPECT_EQ(f.dlc, 0);
+
+	// candump -ta format:
+	ASSERT_TRUE(CCANBusReader::parseCandumpLine(
+		" (1436509052.000001)  can0  0CF00400   [3]  AA bb 0C", f));
+	EXPECT_EQ(f.id, 0x0CF00400U | EXT);
+	ASSERT_EQ(f.dlc, 3);
+	EXPECT_EQ(f.data[0], 0xAA);
+	EXPECT_EQ(f.data[1], 0xBB);
+	EXPECT_EQ(f.data[2], 0x0C);
+
+	// Invalid, remote or CAN FD frames:
+	EXPECT_FALSE(CCANBusReader::parseCandumpLine("", f));
+	EXPECT_FALSE(CCANBusReader::parseCandumpLine("can0 123#00", f));
+	EXPECT_FALSE(CCANBusReader::parseCandumpLine("(1.0) can0 123#R", f));
+	EXPECT_FALSE(CCANBusReader::parseCandumpLine("(1.0) can0 123##1000", f));
+	EXPECT_FALSE(CCANBusReader::parseCandumpLine(
+		"(1.0) can0 123#000102030405060708", f));
+	EXPECT_FALSE(CCANBusReader::parseCandumpLine("(1.0) can0 123 [2] 01", f));
+}
+
+TEST(CCANBusReader, decodeSerialFrame)
+{
+	const std::string s = "T18FEF1003A1B2C3\r";
+	CCANBusReader::TFrame f;
+	ASSERT_TRUE(CCANBusReader::decodeSerialFrame(
+		reinterpret_cast<const uint8_t*>(s.data()), s.size(), f));
+	EXPECT_EQ(f.id, 0x18FEF100U | EXT);
+	ASSERT_EQ(f.dlc, 3);
+	EXPECT_EQ(f.data[0], 0xA1);
+	EXPECT_EQ(f.data[1], 0xB2);
+	EXPECT_EQ(f.data[2], 0xC3);
+
+	// Wrong length:
+	EXPECT_FALSE(CCANBusReader::decodeSerialFrame(
+		reinterpret_cast<const uint8_t*>(s.data()), s.size() - 1, f));
+}
+
+TEST(CCANBusReader, frameFilters)
+{
+	CCANBusReader reader;
+	EXPECT_TRUE(reader.isFrameAccepted(0x123));
+
+	reader.setFrameFilters(
+		CCANBusReader::parseFrameFilters("18FEF100:00FFFF00, 0CF00400"));
+	ASSERT_EQ(reader.getFrameFilters().size(), 2U);
+
+	// Any source address or priority of PGN 0xFEF1:
+	EXPECT_TRUE(reader.isFrameAccepted(0x18FEF100));
+	EXPECT_TRUE(reader.isFrameAccepted(0x0CFEF1AA | EXT));
+	// Exact ID:
+	EXPECT_TRUE(reader.isFrameAccepted(0x0CF00400));
+	EXPECT_FALSE(reader.isFrameAccepted(0x0CF00401));
+	EXPECT_FALSE(reader.isFrameAccepted(0x123));
+
+	// Inverted filter: anything not in 0x7xx
+	reader.setFrameFilters(CCANBusReader::parseFrameFilters("7FF~700"));
+	EXPECT_TRUE(reader.isFrameAccepted(0x123));
+	EXPECT_FALSE(reader.isFrameAccepted(0x7FF));
+
+	EXPECT_THROW(CCANBusReader::parseFrameFilters("12G"), std::exception);
+	EXPECT_THROW(CCANBusReader::parseFrameFilters("123:"), std::exception);
+}
+
+TEST(CCANBusReader, replayBatchWithFilters)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	const int N = 1000;
+	{
+		std::ofstream f(fil);
+		f << "# A comment line\n";
+		for (int i = 0; i < N; i++)
+			f << mrpt::format(
+				"(%.06f) can0 %08X#%02X%02X\n", 1000.0 + i * 1e-3,
+				(i % 2) ? 0x18FEF100 + (i % 16) : 0x0CF00400, i & 0xFF,
+				(i >> 8) & 0xFF);
+	}
+
+	CCANBusReader reader;
+	reader.setReplayFile(fil, 0 /*as fast as possible*/);
+	reader.setBatchMode(true, 300, 10.0);
+	reader.setFrameFilters(
+		{CCANBusReader::TFrameFilter(0x00FEF100, 0x00FFFF00)});
+
+	std::vector<CObservationCANBusJ1939Batch::Ptr> batches;
+	for (int iter = 0; iter < 10; iter++)
+	{
+		reader.doProcess();
+		for (const auto& o : reader.getObservations())
+		{
+			auto b = std::dynamic_pointer_cast<CObservationCANBusJ1939Batch>(
+				o.second);
+			ASSERT_TRUE(b);
+			batches.push_back(b);
+		}
+	}
+	mrpt::system::deleteFile(fil);
+
+	EXPECT_EQ(reader.getFramesReceived(), size_t(N));
+	EXPECT_EQ(reader.getFramesFiltered(), size_t(N / 2));
+
+	ASSERT_FALSE(batches.empty());
+	size_t total = 0;
+	for (const auto& b : batches)
+	{
+		EXPECT_LE(b->size(), 300U);
+		total += b->size();
+	}
+	EXPECT_EQ(total, size_t(N / 2));
+
+	// Check the contents of the first frames:
+	auto& b = batches.front();
+	ASSERT_GT(b->size(), 2U);
+	EXPECT_EQ(b->pgn(0), 0xFEF1);
+	EXPECT_EQ(b->priority(0), 6);
+	EXPECT_EQ(b->srcAddress(1), 3);
+	EXPECT_EQ(b->frameDataLengths[1], 2);
+	EXPECT_EQ(b->data(1)[0], 3);
+	EXPECT_NEAR(mrpt::Clock::toDouble(b->frameTimestamps[1]), 1000.003, 1e-5);
+	EXPECT_EQ(b->timestamp, b->frameTimestamps[0]);
+
+	CObservationCANBusJ1939 single;
+	b->getFrame(1, single);
+	EXPECT_EQ(single.m_pgn, 0xFEF1);
+	EXPECT_EQ(single.m_src_address, 3);
+	ASSERT_EQ(single.m_data.size(), 2U);
+	EXPECT_EQ(single.m_data[0], 3);
+
+	// Serialization round-trip:
+	mrpt::io::CMemoryStream buf;
+	auto arch = mrpt::serialization::archiveFrom(buf);
+	arch << *b;
+	buf.Seek(0);
+	CObservationCANBusJ1939Batch b2;
+	arch >> b2;
+	EXPECT_EQ(b2.frameIds, b->frameIds);
+	EXPECT_EQ(b2.frameTimestamps, b->frameTimestamps);
+	EXPECT_EQ(b2.frameDataLengths, b->frameDataLengths);
+	EXPECT_EQ(b2.frameData, b->frameData);
+}
@@ -28,7 +28,12 @@ using namespace std;
 
 const int MINIMUM_PACKETS_TO_SET_TIMESTAMP_REFERENCE = 10;
 
-CHokuyoURG::CHokuyoURG() : m_rx_buffer(40000) { m_sensorLabel = "Hokuyo"; }
+CHokuyoURG::CHokuyoURG() : m_rx_buffer(40000)
+{
+	m_sensorLabel = "Hokuyo";
+	// Reuse observation objects at high scan rates:
+	enableObservationRecycling();
+}
 
 CHokuyoURG::~CHokuyoURG()
 {
@@ -181,33 +186,9 @@ void CHokuyoURG::doProcessSimple(
 	outObservation.sensorPose = m_sensorPose;
 	outObservation.sensorLabel = m_sensorLabel;
 
-	outObservation.resizeScan(nRanges);
-	char* ptr = (char*)&m_rcv_data[4];
-
-	if (m_intensity) outObservation.setScanHasIntensity(true);
-
-	for (int i = 0; i < nRanges; i++)
-	{
-		int b1 = (*ptr++) - 0x30;
-		int b2 = (*ptr++) - 0x30;
-		int b3 = (*ptr++) - 0x30;
-
-		int range_mm = ((b1 << 12) | (b2 << 6) | b3);
-
-		outObservation.setScanRange(i, range_mm * 0.001f);
-		outObservation.setScanRangeValidity(
-			i,
-			range_mm >= 20 &&
-				(outObservation.getScanRange(i) <= outObservation.maxRange));
-
-		if (m_intensity)
-		{
-			int b4 = (*ptr++) - 0x30;
-			int b5 = (*ptr++) - 0x30;
-			int b6 = (*ptr++) - 0x30;
-			outObservation.setScanIntensity(i, ((b4 << 12) | (b5 << 6) | b6));
-		}
-	}
+	decodeScanData(
+		m_rcv_data.data() + 4, m_rcv_data.size() - 4, nRanges, m_intensity,
+		outObservation);
 
 	// Do filter:
 	C2DRangeFinderAbstract::filterByExclusionAreas(outObservation);
@@ -219,6 +200,47 @@ void CHokuyoURG::doProcessSimple(
 	internal_notifyGoodScanNow();
 }
 
+void CHokuyoURG::decodeScanData(
+	const char* data, size_t len, size_t nRanges, bool withIntensity,
+	mrpt::obs::CObservation2DRangeScan& out)
+{
+	const size_t stride = withIntensity ? 6 : 3;
+	ASSERT_GE_(len, nRanges * stride);
+
+	out.resizeScan(nRanges);
+	out.setScanHasIntensity(withIntensity);
+	if (!nRanges) return;
+
+	// Plain loops over raw pointers, without branches or calls to the
+	// setters, so the compiler can vectorize the 6-bit character decoding:
+	const auto* p = reinterpret_cast<const uint8_t*>(data);
+	float* ranges = &out.getScanRange(0);
+	for (size_t i = 0; i < nRanges; i++)
+	{
+		const uint8_t* c = p + i * stride;
+		const uint32_t range_mm = ((uint32_t(c[0]) - 0x30) << 12) |
+			((uint32_t(c[1]) - 0x30) << 6) | (uint32_t(c[2]) - 0x30);
+		ranges[i] = range_mm * 0.001f;
+	}
+	if (withIntensity)
+	{
+		int32_t* intensities = &out.getScanIntensity(0);
+		for (size_t i = 0; i < nRanges; i++)
+		{
+			const uint8_t* c = p + i * stride + 3;
+			intensities[i] = static_cast<int32_t>(
+				((uint32_t(c[0]) - 0x30) << 12) |
+				((uint32_t(c[1]) - 0x30) << 6) | (uint32_t(c[2]) - 0x30));
+		}
+	}
+
+	// Minimum valid range: 20 mm (with some margin for float rounding)
+	const float minRange = 0.0195f, maxRange = out.maxRange;
+	for (size_t i = 0; i < nRanges; i++)
+		out.setScanRangeValidity(
+			i, ranges[i] >= minRange && ranges[i] <= maxRange);
+}
+
 /*-------------------------------------------------------------
 						loadConfig_sensorSpecific
 -------------------------------------------------------------*/
@@ -539,22 +561,24 @@ bool CHokuyoURG::parseResponse(bool additionalWaitForData)
 		//  times
 		//  the read method with only 1 byte each time:
 		// -----------------------------------------------------------------------------
+		// The frame is directly decoded into m_rcv_data, whose capacity is
+		// kept between calls to avoid reallocations for each scan.
 		bool lastWasLF = false;
-		std::string tmp_rx;
 		for (;;)
 		{
 			if (!ensureBufferHasBytes(peekIdx + 1, additionalWaitForData))
 			{
 				// Do not empty the queue, it seems we need to wait for more
 				// data:
+				m_rcv_data.clear();
 				return false;
 			}
-			tmp_rx.push_back(m_rx_buffer.peek(peekIdx++));
+			m_rcv_data.push_back(m_rx_buffer.peek(peekIdx++));
 
 			// No data?
-			if (tmp_rx.size() == 1 && tmp_rx[0] == 0x0A)
+			if (m_rcv_data.size() == 1 && m_rcv_data[0] == 0x0A)
 			{
-				tmp_rx.clear();
+				m_rcv_data.clear();
 				m_rcv_status0 = tmp_rcv_status0;
 				m_rcv_status1 = tmp_rcv_status1;
 				// Empty read bytes so far:
@@ -564,7 +588,7 @@ bool CHokuyoURG::parseResponse(bool additionalWaitForData)
 			}
 
 			// Is it a LF?
-			if (*tmp_rx.rbegin() != 0x0A)
+			if (m_rcv_data.back() != 0x0A)
 			{
 				lastWasLF = false;
 				continue;
@@ -574,18 +598,17 @@ bool CHokuyoURG::parseResponse(bool additionalWaitForData)
 			if (!lastWasLF)
 			{
 				// Discard SUM+LF
-				ASSERT_(tmp_rx.size() >= 2);
-				tmp_rx.resize(tmp_rx.size() - 2);
+				ASSERT_(m_rcv_data.size() >= 2);
+				m_rcv_data.resize(m_rcv_data.size() - 2);
 			}
 			else
 			{
 				// This was a double LF.
 
 				// Discard this last LF:
-				tmp_rx.resize(tmp_rx.size() - 1);
+				m_rcv_data.pop_back();
 
 				// Done!
-				m_rcv_data = tmp_rx;
 				m_rcv_status0 = tmp_rcv_status0;
 				m_rcv_status1 = tmp_rcv_status1;
 
@@ -613,10 +636,12 @@ bool CHokuyoURG::parseResponse(bool additionalWaitForData)
 	catch (const std::exception& e)
 	{
 		MRPT_LOG_ERROR_FMT("[Hokuyo] parseResponse() Exception: %s", e.what());
+		m_rcv_data.clear();
 		return false;
 	}
 	catch (...)
 	{
+		m_rcv_data.clear();
 		return false;  // Serial port timeout,...
 	}
 }
@@ -0,0 +1,134 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/hwdrivers/CHokuyoURG.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+
+#include <string>
+
+using namespace mrpt::hwdrivers;
+using mrpt::obs::CObservation2DRangeScan;
+
+namespace
+{
+// SCIP 2.0 3-character encoding of an 18-bit value:
+std::string scipEncode(uint32_t v)
+{
+	std::string s(3, '\0');
+	s[0] = static_cast<char>(((v >> 12) & 0x3f) + 0x30);
+	s[1] = static_cast<char>(((v >> 6) & 0x3f) + 0x30);
+	s[2] = static_cast<char>((v & 0x3f) + 0x30);
+	return s;
+}
+
+// A fake scanner, always returning a new scan:
+class DummyScanner : public C2DRangeFinderAbstract
+{
+   public:
+	const TSensorClassId* GetRuntimeClass() const override { return nullptr; }
+	void loadConfig_sensorSpecific(
+		const mrpt::config::CConfigFileBase&, const std::string&) override
+	{
+	}
+	void doProcessSimple(
+		bool& thereIsObs, CObservation2DRangeScan& obs,
+		bool& hardwareError) override
+	{
+		obs.resizeScanAndAssign(1081, 1.0f, true);
+		thereIsObs = true;
+		hardwareError = false;
+	}
+	bool turnOn() override { return true; }
+	bool turnOff() override { return true; }
+};
+}  // namespace
+
+TEST(CHokuyoURG, decodeScanData)
+{
+	const uint32_t ranges_mm[] = {0, 19, 20, 1234, 30000, 262143};
+	const size_t N = sizeof(ranges_mm) / sizeof(ranges_mm[0]);
+
+	for (const bool withIntensity : {false, true})
+	{
+		std::string data;
+		for (size_t i = 0; i < N; i++)
+		{
+			data += scipEncode(ranges_mm[i]);
+			if (withIntensity) data += scipEncode(1000 + i);
+		}
+
+		CObservation2DRangeScan obs;
+		obs.maxRange = 60.0f;
+		CHokuyoURG::decodeScanData(
+			data.data(), data.size(), N, withIntensity, obs);
+
+		ASSERT_EQ(obs.getScanSize(), N);
+		EXPECT_EQ(obs.hasIntensity(), withIntensity);
+		for (size_t i = 0; i < N; i++)
+		{
+			EXPECT_NEAR(obs.getScanRange(i), ranges_mm[i] * 1e-3f, 1e-6f);
+			const bool expectedValid =
+				ranges_mm[i] >= 20 && ranges_mm[i] * 1e-3f <= obs.maxRange;
+			EXPECT_EQ(obs.getScanRangeValidity(i), expectedValid) << i;
+			if (withIntensity)
+				EXPECT_EQ(obs.getScanIntensity(i), static_cast<int>(1000 + i));
+		}
+	}
+
+	// Not enough data:
+	CObservation2DRangeScan obs;
+	const std::string data = scipEncode(100);
+	EXPECT_ANY_THROW(
+		CHokuyoURG::decodeScanData(data.data(), data.size(), 2, false, obs));
+}
+
+TEST(CHokuyoURG, observationRecycling)
+{
+	DummyScanner scanner;
+	scanner.enableObservationRecycling(true, 2);
+
+	scanner.doProcess();
+	const CObservation2DRangeScan* firstObs = nullptr;
+	{
+		const auto lst = scanner.getObservations();
+		ASSERT_EQ(lst.size(), 1U);
+		firstObs = dynamic_cast<const CObservation2DRangeScan*>(
+			lst.begin()->second.get());
+		ASSERT_TRUE(firstObs != nullptr);
+		EXPECT_EQ(firstObs->getScanSize(), 1081U);
+	}
+
+	// The first object was released, so it must be reused:
+	scanner.doProcess();
+	auto lst2 = scanner.getObservations();
+	ASSERT_EQ(lst2.size(), 1U);
+	EXPECT_EQ(lst2.begin()->second.get(), firstObs);
+
+	// ... but not while still held by the user:
+	scanner.doProcess();
+	const auto lst3 = scanner.getObservations();
+	ASSERT_EQ(lst3.size(), 1U);
+	EXPECT_NE(lst3.begin()->second.get(), lst2.begin()->second.get());
+
+	// Observations may outlive the driver:
+	CObservation2DRangeScan::Ptr kept;
+	{
+		DummyScanner scanner2;
+		scanner2.enableObservationRecycling(true, 2);
+		scanner2.doProcess();
+		const auto lst = scanner2.getObservations();
+		ASSERT_EQ(lst.size(), 1U);
+		kept = std::dynamic_pointer_cast<CObservation2DRangeScan>(
+			lst.begin()->second);
+	}
+	ASSERT_TRUE(kept);
+	EXPECT_EQ(kept->getScanSize(), 1081U);
+	kept.reset();
+}
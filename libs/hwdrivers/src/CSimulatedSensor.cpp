@@ -0,0 +1,311 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "hwdrivers-precomp.h"	// Precompiled headers
+//
+#include <mrpt/core/bits_math.h>
+#include <mrpt/hwdrivers/CSimulatedSensor.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/obs/CObservationIMU.h>
+#include <mrpt/obs/CObservationImage.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/datetime.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace mrpt::hwdrivers;
+using namespace mrpt::obs;
+
+IMPLEMENTS_GENERIC_SENSOR(CSimulatedSensor, mrpt::hwdrivers)
+
+CSimulatedSensor::CSimulatedSensor() { m_sensorLabel = "SIMULATED"; }
+
+void CSimulatedSensor::loadConfig_sensorSpecific(
+	const mrpt::config::CConfigFileBase& c, const std::string& s)
+{
+	m_mode = c.read_enum<TSimulationMode>(s, "simulation_mode", m_mode);
+	m_label_configured = c.keyExists(s, "sensorLabel");
+
+	m_rate_hz = c.read_double(s, "rate_hz", m_rate_hz);
+	m_jitter_std_ms = c.read_double(s, "jitter_std_ms", m_jitter_std_ms);
+	m_burst_probability =
+		c.read_double(s, "burst_probability", m_burst_probability);
+	m_burst_length = c.read_uint64_t(s, "burst_length", m_burst_length);
+	m_random_seed = c.read_int(s, "random_seed", m_random_seed);
+
+	m_scan_rays = c.read_uint64_t(s, "scan_rays", m_scan_rays);
+	m_scan_aperture = mrpt::DEG2RAD(c.read_double(
+		s, "scan_aperture_deg", mrpt::RAD2DEG(m_scan_aperture)));
+	m_scan_max_range = c.read_float(s, "scan_max_range", m_scan_max_range);
+
+	m_image_width = c.read_uint64_t(s, "image_width", m_image_width);
+	m_image_height = c.read_uint64_t(s, "image_height", m_image_height);
+
+	m_rawlog_file =
+		c.read_string(s, "rawlog_file", m_rawlog_file, m_mode == smRAWLOG);
+	m_rawlog_sensor_label =
+		c.read_string(s, "rawlog_sensor_label", m_rawlog_sensor_label);
+	m_replay_speed = c.read_double(s, "replay_speed", m_replay_speed);
+	m_replay_loop = c.read_bool(s, "replay_loop", m_replay_loop);
+
+	m_sensorPose.setFromValues(
+		c.read_double(s, "pose_x", 0), c.read_double(s, "pose_y", 0),
+		c.read_double(s, "pose_z", 0),
+		mrpt::DEG2RAD(c.read_double(s, "pose_yaw", 0)),
+		mrpt::DEG2RAD(c.read_double(s, "pose_pitch", 0)),
+		mrpt::DEG2RAD(c.read_double(s, "pose_roll", 0)));
+}
+
+void CSimulatedSensor::initialize()
+{
+	MRPT_START
+
+	ASSERT_GT_(m_replay_speed, 0);
+	if (m_mode != smRAWLOG) ASSERT_GT_(m_rate_hz, 0);
+
+	if (m_random_seed >= 0)
+		m_rng.randomize(static_cast<uint32_t>(m_random_seed));
+	else
+		m_rng.randomize();
+
+	if (m_mode == smRAWLOG)
+	{
+		if (!m_rawlog_in.open(m_rawlog_file))
+			THROW_EXCEPTION_FMT(
+				"Cannot open rawlog file: '%s'", m_rawlog_file.c_str());
+		m_rawlog_sf_queue.clear();
+		m_rawlog_first_stamp.reset();
+		m_rawlog_loop_offset = 0;
+		m_rawlog_last_t = 0;
+	}
+
+	m_pending.clear();
+	m_next_index = 0;
+	m_last_t_acquired = 0;
+	m_start_time = mrpt::Clock::now();
+	{
+		std::lock_guard<std::mutex> lck(m_stats_mtx);
+		m_stats = TStats();
+	}
+	m_state = ssWorking;
+
+	MRPT_END
+}
+
+CObservation::Ptr CSimulatedSensor::nextRawlogObservation()
+{
+	for (bool rewound = false;;)
+	{
+		while (!m_rawlog_sf_queue.empty())
+		{
+			auto obs = m_rawlog_sf_queue.front();
+			m_rawlog_sf_queue.pop_front();
+			if (!obs) continue;
+			if (!m_rawlog_sensor_label.empty() &&
+				obs->sensorLabel != m_rawlog_sensor_label)
+				continue;
+			return obs;
+		}
+
+		mrpt::serialization::CSerializable::Ptr obj;
+		try
+		{
+			auto arch = mrpt::serialization::archiveFrom(m_rawlog_in);
+			arch >> obj;
+		}
+		catch (const mrpt::serialization::CExceptionEOF&)
+		{
+			// Avoid an endless loop for rawlogs without usable observations:
+			if (!m_replay_loop || rewound) return {};
+			rewound = true;
+			m_rawlog_in.close();
+			if (!m_rawlog_in.open(m_rawlog_file))
+			{
+				m_state = ssError;
+				THROW_EXCEPTION_FMT(
+					"Cannot reopen rawlog file: '%s'", m_rawlog_file.c_str());
+			}
+			// Resume the replay right after the last emitted observation:
+			m_rawlog_loop_offset = m_rawlog_last_t;
+			m_rawlog_first_stamp.reset();
+			continue;
+		}
+
+		if (auto sf = std::dynamic_pointer_cast<CSensoryFrame>(obj); sf)
+			m_rawlog_sf_queue.insert(
+				m_rawlog_sf_queue.end(), sf->begin(), sf->end());
+		else if (auto o = std::dynamic_pointer_cast<CObservation>(obj); o)
+			m_rawlog_sf_queue.push_back(o);
+		// Actions are ignored.
+	}
+}
+
+bool CSimulatedSensor::scheduleNext()
+{
+	const double jitter_std = m_jitter_std_ms * 1e-3;
+
+	const bool startBurst = m_burst_length > 1 && m_burst_probability > 0 &&
+		m_rng.drawUniform(0.0, 1.0) < m_burst_probability;
+	const size_t nObs = startBurst ? m_burst_length : 1;
+
+	for (size_t i = 0; i < nObs; i++)
+	{
+		TPending p;
+		if (m_mode == smRAWLOG)
+		{
+			p.obs = nextRawlogObservation();
+			if (!p.obs) break;
+
+			const auto stamp = p.obs->timestamp;
+			if (!m_rawlog_first_stamp) m_rawlog_first_stamp = stamp;
+			p.t_acquired = m_rawlog_loop_offset +
+				mrpt::system::timeDifference(*m_rawlog_first_stamp, stamp) /
+					m_replay_speed;
+			m_rawlog_last_t = p.t_acquired;
+		}
+		else
+		{
+			p.t_acquired = m_next_index++ / m_rate_hz;
+		}
+		if (jitter_std > 0)
+		{
+			// Zero-mean, clamped to +-3 sigma, and never reordering
+			// observations:
+			const double jitter = mrpt::saturate_val(
+				m_rng.drawGaussian1D(0, jitter_std), -3 * jitter_std,
+				3 * jitter_std);
+			p.t_acquired = std::max(p.t_acquired + jitter, m_last_t_acquired);
+		}
+		m_last_t_acquired = p.t_acquired;
+		p.t_deliver = p.t_acquired;
+		m_pending.push_back(std::move(p));
+	}
+	if (m_pending.empty()) return false;
+
+	if (startBurst)
+	{
+		// All observations in the burst are delivered with the last one:
+		const double tLast = m_pending.back().t_deliver;
+		for (auto& p : m_pending) p.t_deliver = tLast;
+
+		std::lock_guard<std::mutex> lck(m_stats_mtx);
+		m_stats.num_bursts++;
+	}
+	return true;
+}
+
+CObservation::Ptr CSimulatedSensor::createSynthetic(double t)
+{
+	switch (m_mode)
+	{
+		case smLIDAR_2D:
+		{
+			auto obs = CObservation2DRangeScan::Create();
+			obs->aperture = static_cast<float>(m_scan_aperture);
+			obs->maxRange = m_scan_max_range;
+			obs->rightToLeft = true;
+			obs->resizeScan(m_scan_rays);
+			// A smoothly-changing, room-like profile plus some noise:
+			const double phase = 0.5 * t;
+			for (size_t i = 0; i < m_scan_rays; i++)
+			{
+				const double a = -0.5 * m_scan_aperture +
+					m_scan_aperture * i / std::max<size_t>(1, m_scan_rays - 1);
+				const double r = 0.3 * m_scan_max_range +
+					0.1 * m_scan_max_range * std::sin(3 * a + phase) +
+					m_rng.drawGaussian1D(0, 0.01);
+				obs->setScanRange(
+					i, static_cast<float>(
+						   mrpt::saturate_val<double>(r, 0, m_scan_max_range)));
+				obs->setScanRangeValidity(i, true);
+			}
+			obs->setSensorPose(m_sensorPose);
+			return obs;
+		}
+		case smIMU:
+		{
+			auto obs = CObservationIMU::Create();
+			obs->set(IMU_X_ACC, m_rng.drawGaussian1D(0, 0.05));
+			obs->set(IMU_Y_ACC, m_rng.drawGaussian1D(0, 0.05));
+			obs->set(IMU_Z_ACC, 9.81 + m_rng.drawGaussian1D(0, 0.05));
+			obs->set(IMU_WX, m_rng.drawGaussian1D(0, 1e-3));
+			obs->set(IMU_WY, m_rng.drawGaussian1D(0, 1e-3));
+			obs->set(IMU_WZ, 0.1 * std::sin(t) + m_rng.drawGaussian1D(0, 1e-3));
+			obs->setSensorPose(m_sensorPose);
+			return obs;
+		}
+		case smCAMERA:
+		{
+			auto obs = CObservationImage::Create();
+			obs->image = mrpt::img::CImage(
+				m_image_width, m_image_height, mrpt::img::CH_RGB);
+			// Touch all pixels, as a real grabber would do:
+			const auto shade = static_cast<uint8_t>(m_next_index & 0xff);
+			for (unsigned int y = 0; y < m_image_height; y++)
+				std::memset(
+					obs->image.ptrLine<uint8_t>(y),
+					static_cast<uint8_t>(shade + y), m_image_width * 3);
+			obs->cameraParams.ncols = m_image_width;
+			obs->cameraParams.nrows = m_image_height;
+			obs->setSensorPose(m_sensorPose);
+			return obs;
+		}
+		default:
+			THROW_EXCEPTION("Unexpected simulation mode");
+	};
+}
+
+void CSimulatedSensor::doProcess()
+{
+	if (m_state == ssInitializing || m_state == ssUninitialized)
+		initialize();
+	if (m_state == ssError) return;
+
+	const auto now = mrpt::Clock::now();
+	const double tNow =
+		std::chrono::duration<double>(now - m_start_time).count();
+
+	size_t nEmitted = 0;
+	double maxDelay = 0;
+
+	for (;;)
+	{
+		if (m_pending.empty() && !scheduleNext()) break;	// EOF
+
+		const TPending& p = m_pending.front();
+		if (p.t_deliver > tNow) break;
+
+		auto obs = (m_mode == smRAWLOG) ? p.obs : createSynthetic(p.t_acquired);
+		obs->timestamp = mrpt::system::timestampAdd(
+			m_start_time, p.t_acquired);
+		if (m_mode != smRAWLOG || m_label_configured ||
+			obs->sensorLabel.empty())
+			obs->sensorLabel = m_sensorLabel;
+		appendObservation(obs);
+
+		maxDelay = std::max(maxDelay, tNow - p.t_deliver);
+		nEmitted++;
+		m_pending.pop_front();
+	}
+
+	std::lock_guard<std::mutex> lck(m_stats_mtx);
+	m_stats.num_observations += nEmitted;
+	m_stats.elapsed_time = tNow;
+	m_stats.achieved_rate_hz = tNow > 0 ? m_stats.num_observations / tNow : 0;
+	mrpt::keep_max(m_stats.max_delivery_delay, maxDelay);
+}
+
+CSimulatedSensor::TStats CSimulatedSensor::getStats() const
+{
+	std::lock_guard<std::mutex> lck(m_stats_mtx);
+	return m_stats;
+}
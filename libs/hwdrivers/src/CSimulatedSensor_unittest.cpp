@@ -0,0 +1,161 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/config/CConfigFileMemory.h>
+#include <mrpt/hwdrivers/CSimulatedSensor.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/system/filesystem.h>
+#include <test_mrpt_common.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace mrpt::hwdrivers;
+using namespace std::chrono_literals;
+
+TEST(CSimulatedSensor, factory)
+{
+	auto sensor = CGenericSensor::createSensorPtr("CSimulatedSensor");
+	ASSERT_TRUE(sensor);
+	EXPECT_TRUE(SENSOR_IS_CLASS(sensor, CSimulatedSensor));
+}
+
+TEST(CSimulatedSensor, synthetic_lidar_rate)
+{
+	CSimulatedSensor sim;
+	sim.setSimulationMode(CSimulatedSensor::smLIDAR_2D);
+	sim.setRate(500);
+	sim.setRandomSeed(123);
+	sim.initialize();
+
+	std::this_thread::sleep_for(100ms);
+	sim.doProcess();
+
+	const auto lst = sim.getObservations();
+	const auto stats = sim.getStats();
+
+	EXPECT_EQ(lst.size(), stats.num_observations);
+	EXPECT_GT(stats.num_observations, 20U);
+	EXPECT_GT(stats.achieved_rate_hz, 0);
+
+	ASSERT_FALSE(lst.empty());
+	const auto scan =
+		std::dynamic_pointer_cast<mrpt::obs::CObservation2DRangeScan>(
+			lst.begin()->second);
+	ASSERT_TRUE(scan);
+	EXPECT_EQ(scan->getScanSize(), 361U);
+}
+
+TEST(CSimulatedSensor, bursts)
+{
+	CSimulatedSensor sim;
+	sim.setSimulationMode(CSimulatedSensor::smIMU);
+	sim.setRate(1000);
+	sim.setBurstiness(1.0 /*always*/, 10);
+	sim.setRandomSeed(123);
+	sim.initialize();
+
+	std::this_thread::sleep_for(50ms);
+	sim.doProcess();
+
+	const auto stats = sim.getStats();
+	EXPECT_GT(stats.num_bursts, 0U);
+	// Observations can only be released in complete bursts:
+	EXPECT_EQ(stats.num_observations % 10, 0U);
+}
+
+TEST(CSimulatedSensor, rawlog_replay)
+{
+	const std::string fil =
+		mrpt::UNITTEST_BASEDIR + std::string("/tests/test-imu-obs-format4.rawlog");
+	if (!mrpt::system::fileExists(fil))
+	{
+		std::cerr << "WARNING: Skipping test due to missing file: " << fil
+				  << "\n";
+		return;
+	}
+
+	CSimulatedSensor sim;
+	sim.setSimulationMode(CSimulatedSensor::smRAWLOG);
+	sim.setRawlogFile(fil, 1e6 /*replay speed*/, false /*loop*/);
+	sim.initialize();
+
+	std::this_thread::sleep_for(20ms);
+	sim.doProcess();
+
+	const auto lst = sim.getObservations();
+	EXPECT_GT(lst.size(), 0U);
+	for (const auto& o : lst)
+	{
+		const auto obs =
+			std::dynamic_pointer_cast<mrpt::obs::CObservation>(o.second);
+		ASSERT_TRUE(obs);
+		// The original labels are kept:
+		EXPECT_FALSE(obs->sensorLabel.empty());
+		EXPECT_NE(obs->sensorLabel, sim.getSensorLabel());
+	}
+
+	// No more data after EOF:
+	sim.doProcess();
+	EXPECT_TRUE(sim.getObservations().empty());
+
+	// Relabeled if a label is given in the config file:
+	mrpt::config::CConfigFileMemory cfg;
+	cfg.write("SIM", "sensorLabel", "REPLAY");
+	cfg.write("SIM", "simulation_mode", "RAWLOG");
+	cfg.write("SIM", "rawlog_file", fil);
+	cfg.write("SIM", "replay_speed", 1e6);
+	cfg.write("SIM", "replay_loop", false);
+	CSimulatedSensor sim2;
+	sim2.loadConfig(cfg, "SIM");
+	sim2.initialize();
+
+	std::this_thread::sleep_for(20ms);
+	sim2.doProcess();
+
+	const auto lst2 = sim2.getObservations();
+	EXPECT_EQ(lst2.size(), lst.size());
+	for (const auto& o : lst2)
+	{
+		const auto obs =
+			std::dynamic_pointer_cast<mrpt::obs::CObservation>(o.second);
+		ASSERT_TRUE(obs);
+		EXPECT_EQ(obs->sensorLabel, "REPLAY");
+	}
+}
+
+TEST(CSimulatedSensor, rawlog_reopen_error)
+{
+	const std::string fil =
+		mrpt::UNITTEST_BASEDIR + std::string("/tests/test-imu-obs-format4.rawlog");
+	if (!mrpt::system::fileExists(fil))
+	{
+		std::cerr << "WARNING: Skipping test due to missing file: " << fil
+				  << "\n";
+		return;
+	}
+	const std::string tmpFil = mrpt::system::getTempFileName();
+	ASSERT_TRUE(mrpt::system::copyFile(fil, tmpFil));
+
+	CSimulatedSensor sim;
+	sim.setSimulationMode(CSimulatedSensor::smRAWLOG);
+	sim.setRawlogFile(tmpFil, 1e6 /*replay speed*/, true /*loop*/);
+	sim.initialize();
+
+	// The file is gone when the replay loops back to its beginning:
+	mrpt::system::deleteFile(tmpFil);
+	std::this_thread::sleep_for(20ms);
+	EXPECT_ANY_THROW(sim.doProcess());
+	EXPECT_EQ(sim.getState(), CGenericSensor::ssError);
+	EXPECT_GT(sim.getObservations().size(), 0U);
+
+	EXPECT_NO_THROW(sim.doProcess());
+	EXPECT_TRUE(sim.getObservations().empty());
+}
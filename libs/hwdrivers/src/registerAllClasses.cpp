@@ -48,5 +48,6 @@ MRPT_INITIALIZER(registerAllClasses_mrpt_hwdrivers)
 	CSkeletonTracker::doRegister();
 	CVelodyneScanner::doRegister();
 	CSICKTim561Eth::doRegister();
+	CSimulatedSensor::doRegister();
 #endif
 }
@@ -0,0 +1,76 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace mrpt::io
+{
+/** A read-only view of a whole file mapped into memory, so its contents can
+ * be parsed in place without copying them into a buffer first. The OS loads
+ * pages on demand while they are accessed.
+ *
+ * Usage:
+ * \code
+ * mrpt::io::CMemoryMappedFile f;
+ * if (!f.open("cloud.pcd")) { ... error ... }
+ * const uint8_t* data = f.data(); // f.size() bytes
+ * \endcode
+ *
+ * \ingroup mrpt_io_grp
+ * \note (New in MRPT 2.4.2)
+ */
+class CMemoryMappedFile
+{
+   public:
+	CMemoryMappedFile() = default;
+	/** Constructor which calls open(), and throws on error */
+	explicit CMemoryMappedFile(const std::string& fileName);
+	~CMemoryMappedFile();
+
+	CMemoryMappedFile(const CMemoryMappedFile&) = delete;
+	CMemoryMappedFile& operator=(const CMemoryMappedFile&) = delete;
+	CMemoryMappedFile(CMemoryMappedFile&& o) noexcept;
+	CMemoryMappedFile& operator=(CMemoryMappedFile&& o) noexcept;
+
+	/** Maps the given file, closing the former one, if any.
+	 * \return false on any error opening or mapping the file. */
+	bool open(const std::string& fileName);
+	/** Unmaps the file, if any. Pointers returned by data() are invalid
+	 * afterwards. */
+	void close();
+
+	bool isOpen() const { return m_isOpen; }
+
+	/** The file contents, or nullptr for empty files. */
+	const uint8_t* data() const { return m_data; }
+	/** The file size, in bytes */
+	size_t size() const { return m_size; }
+
+	std::string_view asStringView() const
+	{
+		return {reinterpret_cast<const char*>(m_data), m_size};
+	}
+
+   private:
+	const uint8_t* m_data = nullptr;
+	size_t m_size = 0;
+	bool m_isOpen = false;
+#ifdef _WIN32
+	void* m_hFile = nullptr;
+	void* m_hMapping = nullptr;
+#endif
+
+	void swap(CMemoryMappedFile& o) noexcept;
+};
+
+}  // namespace mrpt::io
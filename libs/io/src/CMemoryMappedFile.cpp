@@ -0,0 +1,147 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "io-precomp.h"	 // Precompiled headers
+//
+#include <mrpt/core/exceptions.h>
+#include <mrpt/io/CMemoryMappedFile.h>
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace mrpt::io;
+
+CMemoryMappedFile::CMemoryMappedFile(const std::string& fileName)
+{
+	if (!open(fileName))
+		THROW_EXCEPTION_FMT("Error mapping file: '%s'", fileName.c_str());
+}
+
+CMemoryMappedFile::~CMemoryMappedFile() { close(); }
+
+CMemoryMappedFile::CMemoryMappedFile(CMemoryMappedFile&& o) noexcept
+{
+	swap(o);
+}
+
+CMemoryMappedFile& CMemoryMappedFile::operator=(CMemoryMappedFile&& o) noexcept
+{
+	if (this != &o)
+	{
+		close();
+		swap(o);
+	}
+	return *this;
+}
+
+void CMemoryMappedFile::swap(CMemoryMappedFile& o) noexcept
+{
+	std::swap(m_data, o.m_data);
+	std::swap(m_size, o.m_size);
+	std::swap(m_isOpen, o.m_isOpen);
+#ifdef _WIN32
+	std::swap(m_hFile, o.m_hFile);
+	std::swap(m_hMapping, o.m_hMapping);
+#endif
+}
+
+bool CMemoryMappedFile::open(const std::string& fileName)
+{
+	close();
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(
+		fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize))
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+	m_hFile = hFile;
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	m_isOpen = true;
+	if (m_size == 0) return true;  // Empty files cannot be mapped
+
+	HANDLE hMapping =
+		CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!hMapping)
+	{
+		close();
+		return false;
+	}
+	m_hMapping = hMapping;
+	m_data = static_cast<const uint8_t*>(
+		MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_data)
+	{
+		close();
+		return false;
+	}
+#else
+	const int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+	{
+		::close(fd);
+		return false;
+	}
+	m_size = static_cast<size_t>(st.st_size);
+	m_isOpen = true;
+	if (m_size == 0)
+	{
+		// Empty files cannot be mapped
+		::close(fd);
+		return true;
+	}
+
+	void* p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping remains valid after closing the descriptor:
+	::close(fd);
+	if (p == MAP_FAILED)
+	{
+		m_size = 0;
+		m_isOpen = false;
+		return false;
+	}
+	// Files are mostly parsed from start to end:
+	::madvise(p, m_size, MADV_SEQUENTIAL);
+	m_data = static_cast<const uint8_t*>(p);
+#endif
+	return true;
+}
+
+void CMemoryMappedFile::close()
+{
+#ifdef _WIN32
+	if (m_data) UnmapViewOfFile(m_data);
+	if (m_hMapping) CloseHandle(static_cast<HANDLE>(m_hMapping));
+	if (m_hFile) CloseHandle(static_cast<HANDLE>(m_hFile));
+	m_hMapping = nullptr;
+	m_hFile = nullptr;
+#else
+	if (m_data) ::munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_isOpen = false;
+}
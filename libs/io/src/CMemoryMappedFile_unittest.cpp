@@ -0,0 +1,50 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/CMemoryMappedFile.h>
+#include <mrpt/system/filesystem.h>
+
+TEST(CMemoryMappedFile, readContents)
+{
+	const auto fil = mrpt::system::getTempFileName();
+	const std::string contents = "Hello, memory-mapped world!\n";
+	{
+		mrpt::io::CFileOutputStream f(fil);
+		f.Write(contents.data(), contents.size());
+	}
+
+	mrpt::io::CMemoryMappedFile m;
+	EXPECT_FALSE(m.isOpen());
+	ASSERT_TRUE(m.open(fil));
+	EXPECT_TRUE(m.isOpen());
+	EXPECT_EQ(m.size(), contents.size());
+	EXPECT_EQ(m.asStringView(), contents);
+
+	// Moving transfers the mapping:
+	mrpt::io::CMemoryMappedFile m2 = std::move(m);
+	EXPECT_FALSE(m.isOpen());
+	EXPECT_EQ(m2.asStringView(), contents);
+	m2.close();
+	EXPECT_FALSE(m2.isOpen());
+	EXPECT_EQ(m2.data(), nullptr);
+
+	// Empty files:
+	{
+		mrpt::io::CFileOutputStream f(fil);
+	}
+	EXPECT_TRUE(m.open(fil));
+	EXPECT_EQ(m.size(), 0U);
+	m.close();
+
+	mrpt::system::deleteFile(fil);
+	EXPECT_FALSE(m.open(fil));
+	EXPECT_THROW(mrpt::io::CMemoryMappedFile m3(fil), std::exception);
+}
@@ -82,6 +82,8 @@ class CColouredOctoMap
 	TColourUpdate getVoxelColourMethod() { return m_colour_method; }
 	void getAsOctoMapVoxels(
 		mrpt::opengl::COctoMapVoxels& gl_obj) const override;
+	void updateOctoMapVoxels(
+		mrpt::opengl::COctoMapVoxels& gl_obj) const override;
 
 	MAP_DEFINITION_START(CColouredOctoMap)
 	double resolution{
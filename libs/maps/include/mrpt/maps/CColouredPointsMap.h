@@ -172,6 +172,35 @@ class CColouredPointsMap : public CPointsMap
 
 	/** Returns true if the point map has a color field for each point */
 	bool hasColorPoints() const override { return true; }
+
+	const mrpt::aligned_std_vector<float>* getPointsBufferRef_color_R()
+		const override
+	{
+		return &m_color_R;
+	}
+	const mrpt::aligned_std_vector<float>* getPointsBufferRef_color_G()
+		const override
+	{
+		return &m_color_G;
+	}
+	const mrpt::aligned_std_vector<float>* getPointsBufferRef_color_B()
+		const override
+	{
+		return &m_color_B;
+	}
+	mrpt::aligned_std_vector<float>* getPointsBufferRef_color_R() override
+	{
+		return &m_color_R;
+	}
+	mrpt::aligned_std_vector<float>* getPointsBufferRef_color_G() override
+	{
+		return &m_color_G;
+	}
+	mrpt::aligned_std_vector<float>* getPointsBufferRef_color_B() override
+	{
+		return &m_color_B;
+	}
+
 	/** Override of the default 3D scene builder to account for the individual
 	 * points' color.
 	 */
@@ -228,47 +257,6 @@ class CColouredPointsMap : public CPointsMap
 	/** @name PCL library support
 		@{ */
 
-#if defined(PCL_LINEAR_VERSION)
-	/** Save the point cloud as a PCL PCD file, in either ASCII or binary format
-	 * \return false on any error */
-	inline bool savePCDFile(
-		const std::string& filename, bool save_as_binary) const
-	{
-		pcl::PointCloud<pcl::PointXYZRGB> cloud;
-
-		const size_t nThis = this->size();
-
-		// Fill in the cloud data
-		cloud.width = nThis;
-		cloud.height = 1;
-		cloud.is_dense = false;
-		cloud.points.resize(cloud.width * cloud.height);
-
-		const float f = 255.f;
-
-		union myaux_t
-		{
-			uint8_t rgb[4];
-			float f;
-		} aux_val;
-
-		for (size_t i = 0; i < nThis; ++i)
-		{
-			cloud.points[i].x = m_x[i];
-			cloud.points[i].y = m_y[i];
-			cloud.points[i].z = m_z[i];
-
-			aux_val.rgb[0] = static_cast<uint8_t>(this->m_color_B[i] * f);
-			aux_val.rgb[1] = static_cast<uint8_t>(this->m_color_G[i] * f);
-			aux_val.rgb[2] = static_cast<uint8_t>(this->m_color_R[i] * f);
-
-			cloud.points[i].rgb = aux_val.f;
-		}
-
-		return 0 == pcl::io::savePCDFile(filename, cloud, save_as_binary);
-	}
-#endif
-
 	/** Loads a PCL point cloud (WITH RGB information) into this MRPT class (for
 	 * clouds without RGB data, see CPointsMap::setFromPCLPointCloud() ).
 	 *  Usage example:
@@ -47,6 +47,8 @@ class COctoMap : public COctoMapBase<octomap::OcTree, octomap::OcTreeNode>
 
 	void getAsOctoMapVoxels(
 		mrpt::opengl::COctoMapVoxels& gl_obj) const override;
+	void updateOctoMapVoxels(
+		mrpt::opengl::COctoMapVoxels& gl_obj) const override;
 
 	MAP_DEFINITION_START(COctoMap)
 	double resolution{
@@ -56,10 +56,13 @@ class COctoMapBase : public mrpt::maps::CMetricMap
 	 *  mrpt::maps::COctoMap  map;
 	 *  octomap::OcTree &om = map.getOctomap<octomap::OcTree>();
 	 * \endcode
+	 * Since the octomap may be modified through this reference, the next
+	 * call to updateOctoMapVoxels() regenerates all voxels.
 	 */
 	template <class OCTOMAP_CLASS>
 	inline OCTOMAP_CLASS& getOctomap()
 	{
+		internal_markAllModified();
 		return m_impl->m_octomap;
 	}
 
@@ -304,6 +307,29 @@ class COctoMapBase : public mrpt::maps::CMetricMap
 	virtual void getAsOctoMapVoxels(
 		mrpt::opengl::COctoMapVoxels& gl_obj) const = 0;
 
+	/** Like getAsOctoMapVoxels(), but only regenerates the voxels of the
+	 * parts of the map modified since the previous call to this method,
+	 * reusing the rest. Intended for live views of a map being built, where
+	 * this is much faster than regenerating the whole map.
+	 *
+	 * The map keeps track of the keys of modified voxels, grouped into blocks
+	 * of 16x16x16 voxels, each stored as a block of `gl_obj` (see
+	 * mrpt::opengl::COctoMapVoxels::setVoxelBlock()), so only the voxels and
+	 * triangles of modified blocks are regenerated and copied to the GPU.
+	 * Everything is regenerated if the rendering options change, if `gl_obj`
+	 * was modified by other means since the last call (e.g. its colors or
+	 * visualization mode) or is a different object, after clear(), or after
+	 * calling getOctomap(). With height-based coloring modes, it is also
+	 * regenerated each time the height of the map changes.
+	 *
+	 * \note (New in MRPT 2.4.2)
+	 */
+	virtual void updateOctoMapVoxels(
+		mrpt::opengl::COctoMapVoxels& gl_obj) const
+	{
+		getAsOctoMapVoxels(gl_obj);
+	}
+
 	/** Get the occupancy probability [0,1] of a point
 	 * \return false if the point is not mapped, in which case the returned
 	 * "prob" is undefined. */
@@ -375,6 +401,38 @@ class COctoMapBase : public mrpt::maps::CMetricMap
 		const std::optional<const mrpt::poses::CPose3D>& robotPose,
 		octomap_point3d& sensorPt, octomap_pointcloud& scan) const;
 
+	/** Marks the voxel with the given key (an octomap::OcTreeKey) as
+	 * modified, for updateOctoMapVoxels() */
+	template <class octomap_key>
+	void internal_markModified(const octomap_key& key);
+	/** Makes the next updateOctoMapVoxels() regenerate all voxels */
+	void internal_markAllModified();
+
+	/** Integrates a scan into the octomap like octomap::insertPointCloud(),
+	 * keeping track of modified voxels */
+	template <class octomap_point3d, class octomap_pointcloud>
+	void internal_insertPointCloud(
+		const octomap_pointcloud& scan, const octomap_point3d& sensorPt,
+		bool lazyEval);
+	/** Integrates a ray into the octomap like octomap::insertRay(), keeping
+	 * track of modified voxels */
+	template <class octomap_point3d>
+	void internal_insertRay(
+		const octomap_point3d& sensorPt, const octomap_point3d& endPt);
+
+	/** Implementation of getAsOctoMapVoxels() and updateOctoMapVoxels() for
+	 * derived classes, where voxels differ only in their color.
+	 * \param[in] voxelColor A functor `mrpt::img::TColor(const
+	 * octree_node_t& node, const mrpt::math::TPoint3D& center)`
+	 * \param[in] colorParams All the values voxel colors depend on, apart
+	 * from the node itself. Voxels are regenerated if they change.
+	 */
+	template <class COLOR_FUNCTOR>
+	void internal_getAsOctoMapVoxels(
+		mrpt::opengl::COctoMapVoxels& gl_obj, bool incremental,
+		const COLOR_FUNCTOR& voxelColor,
+		const std::vector<double>& colorParams) const;
+
 	struct Impl;
 
 	mrpt::pimpl<Impl> m_impl;
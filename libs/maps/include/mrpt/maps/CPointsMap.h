@@ -428,31 +428,66 @@ class CPointsMap : public CMetricMap,
 		save3D_to_text_file(fil);
 	}
 
-	/** Save the point cloud as a PCL PCD file, in either ASCII or binary format
-	 * \note This method requires user code to include PCL before MRPT headers.
-	 * \return false on any error */
-#if defined(PCL_LINEAR_VERSION)
-	inline bool savePCDFile(
-		const std::string& filename, bool save_as_binary) const
-	{
-		pcl::PointCloud<pcl::PointXYZ> cloud;
-		this->getPCLPointCloud(cloud);
-		return 0 == pcl::io::savePCDFile(filename, cloud, save_as_binary);
-	}
-#endif
+	/** Encodings of the point data in PCD files \sa savePCDFile() */
+	enum class PCDFormat : uint8_t
+	{
+		ASCII = 0,
+		Binary,
+		/** LZF-compressed binary, as written by PCL. Limited to 4 GiB of
+		 * point data: larger clouds are saved as `Binary` instead. */
+		BinaryCompressed
+	};
 
-	/** Load the point cloud from a PCL PCD file.
-	 * \note This method requires user code to include PCL before MRPT headers.
-	 * \return false on any error */
-#if defined(PCL_LINEAR_VERSION)
-	inline bool loadPCDFile(const std::string& filename)
+	/** Saves the point cloud as a PCD file (the format of the Point Cloud
+	 * Library), without depending on PCL. Besides `x y z`, an `intensity`
+	 * field is written for maps with intensity (e.g. CPointsMapXYZI), and a
+	 * packed `rgb` field for maps with color (CColouredPointsMap).
+	 * \return false on any error
+	 * \sa loadPCDFile(), savePLYFile()
+	 */
+	bool savePCDFile(const std::string& filename, PCDFormat format) const;
+
+	/** \overload Saves in either ASCII or uncompressed binary format */
+	bool savePCDFile(const std::string& filename, bool save_as_binary) const
 	{
-		pcl::PointCloud<pcl::PointXYZ> cloud;
-		if (0 != pcl::io::loadPCDFile(filename, cloud)) return false;
-		this->getPCLPointCloud(cloud);
-		return true;
+		return savePCDFile(
+			filename, save_as_binary ? PCDFormat::Binary : PCDFormat::ASCII);
 	}
-#endif
+
+	/** Loads the point cloud from a PCD file (the format of the Point Cloud
+	 * Library), in any of its `ascii`, `binary` or `binary_compressed`
+	 * encodings, without depending on PCL.
+	 *
+	 * The file is memory-mapped and the fields `x y z`, and `intensity` and
+	 * `rgb`/`rgba` if this class stores them, are copied straight into the
+	 * point buffers. Other fields are ignored. Points are loaded as they are,
+	 * including those with NaN coordinates in organized clouds.
+	 * \return false on any error, described in `outErrorMsg` if provided.
+	 */
+	bool loadPCDFile(
+		const std::string& filename,
+		mrpt::optional_ref<std::string> outErrorMsg = std::nullopt);
+
+	/** Saves the point cloud as a binary little-endian PLY file, with float
+	 * `x y z` vertex properties, plus `intensity` (float) or `red green blue`
+	 * (uchar) if this class stores them. It is much faster than the generic
+	 * PLY_Exporter::saveToPlyFile().
+	 * \return false on any error
+	 * \sa loadPLYFile()
+	 */
+	bool savePLYFile(const std::string& filename) const;
+
+	/** Loads the point cloud from a PLY file. Binary files whose vertex
+	 * properties are all scalars are memory-mapped and parsed straight into
+	 * the point buffers, reading `x y z`, `intensity` and `red green blue`
+	 * (those stored by this class). Other files (ASCII, or with list
+	 * properties before the vertices) are loaded with the generic
+	 * PLY_Importer::loadFromPlyFile().
+	 * \return false on any error, described in `outErrorMsg` if provided.
+	 */
+	bool loadPLYFile(
+		const std::string& filename,
+		mrpt::optional_ref<std::string> outErrorMsg = std::nullopt);
 
 	/** @} */  // End of: File input/output methods
 	// --------------------------------------------------
@@ -580,6 +615,52 @@ class CPointsMap : public CMetricMap,
 	{
 		return m_z;
 	}
+	/** Provides a direct access to the intensity buffer, or nullptr if this
+	 * class does not store intensity. */
+	virtual const mrpt::aligned_std_vector<float>*
+		getPointsBufferRef_intensity() const
+	{
+		return nullptr;
+	}
+	/** \overload */
+	virtual mrpt::aligned_std_vector<float>* getPointsBufferRef_intensity()
+	{
+		return nullptr;
+	}
+	/** Provides a direct access to the color buffers (values in [0,1]), or
+	 * nullptr if this class does not store color. */
+	virtual const mrpt::aligned_std_vector<float>* getPointsBufferRef_color_R()
+		const
+	{
+		return nullptr;
+	}
+	/** \overload */
+	virtual const mrpt::aligned_std_vector<float>* getPointsBufferRef_color_G()
+		const
+	{
+		return nullptr;
+	}
+	/** \overload */
+	virtual const mrpt::aligned_std_vector<float>* getPointsBufferRef_color_B()
+		const
+	{
+		return nullptr;
+	}
+	/** \overload */
+	virtual mrpt::aligned_std_vector<float>* getPointsBufferRef_color_R()
+	{
+		return nullptr;
+	}
+	/** \overload */
+	virtual mrpt::aligned_std_vector<float>* getPointsBufferRef_color_G()
+	{
+		return nullptr;
+	}
+	/** \overload */
+	virtual mrpt::aligned_std_vector<float>* getPointsBufferRef_color_B()
+	{
+		return nullptr;
+	}
 	/** Returns a copy of the 2D/3D points as a std::vector of float
 	 * coordinates.
 	 * If decimation is greater than 1, only 1 point out of that number will be
@@ -171,6 +171,16 @@ class CPointsMapXYZI : public CPointsMap
 	/** Returns true if the point map has a color field for each point */
 	bool hasColorPoints() const override { return true; }
 
+	const mrpt::aligned_std_vector<float>* getPointsBufferRef_intensity()
+		const override
+	{
+		return &m_intensity;
+	}
+	mrpt::aligned_std_vector<float>* getPointsBufferRef_intensity() override
+	{
+		return &m_intensity;
+	}
+
 	/** Override of the default 3D scene builder to account for the individual
 	 * points' color.
 	 */
@@ -180,35 +190,6 @@ class CPointsMapXYZI : public CPointsMap
 	/** @name PCL library support
 		@{ */
 
-	/** Save the point cloud as a PCL PCD file, in either ASCII or binary format
-	 * \note This method requires user code to include PCL before MRPT headers.
-	 * \return false on any error */
-#if defined(PCL_LINEAR_VERSION)
-	inline bool savePCDFile(
-		const std::string& filename, bool save_as_binary) const
-	{
-		pcl::PointCloud<pcl::PointXYZI> cloud;
-
-		const size_t nThis = this->size();
-
-		// Fill in the cloud data
-		cloud.width = nThis;
-		cloud.height = 1;
-		cloud.is_dense = false;
-		cloud.points.resize(cloud.width * cloud.height);
-
-		for (size_t i = 0; i < nThis; ++i)
-		{
-			cloud.points[i].x = m_x[i];
-			cloud.points[i].y = m_y[i];
-			cloud.points[i].z = m_z[i];
-			cloud.points[i].intensity = this->m_intensity[i];
-		}
-
-		return 0 == pcl::io::savePCDFile(filename, cloud, save_as_binary);
-	}
-#endif
-
 	/** Loads a PCL point cloud (WITH XYZI information) into this MRPT class.
 	 *  Usage example:
 	 *  \code
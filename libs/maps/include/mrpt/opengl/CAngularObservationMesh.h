@@ -283,9 +283,10 @@ class CAngularObservationMesh : public CRenderizableShaderTriangles,
 	/** Actual set of triangles to be displayed. */
 	mutable std::vector<mrpt::opengl::TTriangle> triangles;
 	/** Internal method to add a triangle to the mutable mesh. */
-	void addTriangle(
-		const mrpt::math::TPoint3D& p1, const mrpt::math::TPoint3D& p2,
-		const mrpt::math::TPoint3D& p3) const;
+	[[deprecated("Unused since the mesh is generated in parallel")]] void
+		addTriangle(
+			const mrpt::math::TPoint3D& p1, const mrpt::math::TPoint3D& p2,
+			const mrpt::math::TPoint3D& p3) const;
 	/** Whether the mesh will be displayed wireframe or solid. */
 	bool m_Wireframe{true};
 	/** Mutable variable which controls if the object has suffered any change
@@ -356,6 +357,7 @@ class CAngularObservationMesh : public CRenderizableShaderTriangles,
 	}
 	void onUpdateBuffers_Wireframe() override;
 	void onUpdateBuffers_Triangles() override;
+	void onUpdateCPUBuffers() override;
 	/** @} */
 
 	/**
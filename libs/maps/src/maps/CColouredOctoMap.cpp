@@ -192,9 +192,7 @@ bool CColouredOctoMap::internal_insertObservation(
 		}
 
 		// Insert rays:
-		m_impl->m_octomap.insertPointCloud(
-			scan, sensorPt, insertionOptions.maxrange,
-			insertionOptions.pruning);
+		internal_insertPointCloud(scan, sensorPt, insertionOptions.pruning);
 		return true;
 	}
 	else if (IS_CLASS(obs, CObservation3DRangeScan))
@@ -234,20 +232,7 @@ bool CColouredOctoMap::internal_insertObservation(
 		}
 
 		// Insert rays:
-		octomap::KeySet free_cells, occupied_cells;
-		m_impl->m_octomap.computeUpdate(
-			scan, sensorPt, free_cells, occupied_cells,
-			insertionOptions.maxrange);
-
-		// insert data into tree  -----------------------
-		for (const auto& free_cell : free_cells)
-		{
-			m_impl->m_octomap.updateNode(free_cell, false, false);
-		}
-		for (const auto& occupied_cell : occupied_cells)
-		{
-			m_impl->m_octomap.updateNode(occupied_cell, true, false);
-		}
+		internal_insertPointCloud(scan, sensorPt, false);
 
 		// Update color -----------------------
 		for (size_t i = 0; i < sizeRangeScan; i++)
@@ -299,6 +284,10 @@ void CColouredOctoMap::updateVoxelColour(
 	const double x, const double y, const double z, const uint8_t r,
 	const uint8_t g, const uint8_t b)
 {
+	octomap::OcTreeKey key;
+	if (m_impl->m_octomap.coordToKeyChecked(octomap::point3d(x, y, z), key))
+		internal_markModified(key);
+
 	switch (m_colour_method)
 	{
 		case INTEGRATE:
@@ -312,107 +301,44 @@ void CColouredOctoMap::updateVoxelColour(
 	}
 }
 
+// Voxels have the colors of their nodes:
+static mrpt::img::TColor voxelColor(
+	const octomap::ColorOcTreeNode& node, const TPoint3D&)
+{
+	const octomap::ColorOcTreeNode::Color node_color = node.getColor();
+	return TColor(node_color.r, node_color.g, node_color.b);
+}
+
 /** Builds a renderizable representation of the octomap as a
  * mrpt::opengl::COctoMapVoxels object. */
 void CColouredOctoMap::getAsOctoMapVoxels(
 	mrpt::opengl::COctoMapVoxels& gl_obj) const
 {
-	// Go thru all voxels:
-
-	// OcTreeVolume voxel; // current voxel, possibly transformed
-	octomap::ColorOcTree::tree_iterator it_end = m_impl->m_octomap.end_tree();
-
-	const unsigned char max_depth = 0;	// all
-	const TColorf general_color = gl_obj.getColor();
-	const TColor general_color_u(
-		general_color.R * 255, general_color.G * 255, general_color.B * 255,
-		general_color.A * 255);
-
-	gl_obj.clear();
-	gl_obj.reserveGridCubes(this->calcNumNodes());
-
-	gl_obj.resizeVoxelSets(2);	// 2 sets of voxels: occupied & free
-
-	gl_obj.showVoxels(
-		VOXEL_SET_OCCUPIED, renderingOptions.visibleOccupiedVoxels);
-	gl_obj.showVoxels(VOXEL_SET_FREESPACE, renderingOptions.visibleFreeVoxels);
-
-	const size_t nLeafs = this->getNumLeafNodes();
-	gl_obj.reserveVoxels(VOXEL_SET_OCCUPIED, nLeafs);
-	gl_obj.reserveVoxels(VOXEL_SET_FREESPACE, nLeafs);
-
-	double xmin, xmax, ymin, ymax, zmin, zmax;
-	this->getMetricMin(xmin, ymin, zmin);
-	this->getMetricMax(xmax, ymax, zmax);
-
-	for (octomap::ColorOcTree::tree_iterator it =
-			 m_impl->m_octomap.begin_tree(max_depth);
-		 it != it_end; ++it)
-	{
-		const octomap::point3d vx_center = it.getCoordinate();
-		const double vx_length = it.getSize();
-		const double L = 0.5 * vx_length;
-
-		if (it.isLeaf())
-		{
-			// voxels for leaf nodes
-			const double occ = it->getOccupancy();
-			if ((occ >= 0.5 && renderingOptions.generateOccupiedVoxels) ||
-				(occ < 0.5 && renderingOptions.generateFreeVoxels))
-			{
-				mrpt::img::TColor vx_color;
-				octomap::ColorOcTreeNode::Color node_color = it->getColor();
-				vx_color = TColor(node_color.r, node_color.g, node_color.b);
-
-				const size_t vx_set = (m_impl->m_octomap.isNodeOccupied(*it))
-					? VOXEL_SET_OCCUPIED
-					: VOXEL_SET_FREESPACE;
-
-				gl_obj.push_back_Voxel(
-					vx_set,
-					COctoMapVoxels::TVoxel(
-						TPoint3D(vx_center.x(), vx_center.y(), vx_center.z()),
-						vx_length, vx_color));
-			}
-		}
-		else if (renderingOptions.generateGridLines)
-		{
-			// Not leaf-nodes:
-			const mrpt::math::TPoint3D pt_min(
-				vx_center.x() - L, vx_center.y() - L, vx_center.z() - L);
-			const mrpt::math::TPoint3D pt_max(
-				vx_center.x() + L, vx_center.y() + L, vx_center.z() + L);
-			gl_obj.push_back_GridCube(
-				COctoMapVoxels::TGridCube(pt_min, pt_max));
-		}
-	}  // end for each voxel
-
-	// if we use transparency, sort cubes by "Z" as an approximation to
-	// far-to-near render ordering:
-	if (gl_obj.isCubeTransparencyEnabled()) gl_obj.sort_voxels_by_z();
+	internal_getAsOctoMapVoxels(gl_obj, false, voxelColor, {});
+}
 
-	// Set bounding box:
-	{
-		mrpt::math::TPoint3D bbmin, bbmax;
-		this->getMetricMin(bbmin.x, bbmin.y, bbmin.z);
-		this->getMetricMax(bbmax.x, bbmax.y, bbmax.z);
-		gl_obj.setBoundingBox(bbmin, bbmax);
-	}
+void CColouredOctoMap::updateOctoMapVoxels(
+	mrpt::opengl::COctoMapVoxels& gl_obj) const
+{
+	internal_getAsOctoMapVoxels(gl_obj, true, voxelColor, {});
 }
 
 void CColouredOctoMap::insertRay(
 	const float end_x, const float end_y, const float end_z,
 	const float sensor_x, const float sensor_y, const float sensor_z)
 {
-	m_impl->m_octomap.insertRay(
+	internal_insertRay(
 		octomap::point3d(sensor_x, sensor_y, sensor_z),
-		octomap::point3d(end_x, end_y, end_z), insertionOptions.maxrange,
-		insertionOptions.pruning);
+		octomap::point3d(end_x, end_y, end_z));
 }
 void CColouredOctoMap::updateVoxel(
 	const double x, const double y, const double z, bool occupied)
 {
-	m_impl->m_octomap.updateNode(x, y, z, occupied);
+	octomap::OcTreeKey key;
+	if (!m_impl->m_octomap.coordToKeyChecked(octomap::point3d(x, y, z), key))
+		return;
+	m_impl->m_octomap.updateNode(key, occupied);
+	internal_markModified(key);
 }
 bool CColouredOctoMap::isPointWithinOctoMap(
 	const float x, const float y, const float z) const
@@ -478,6 +404,7 @@ size_t CColouredOctoMap::getNumLeafNodes() const
 void CColouredOctoMap::setOccupancyThres(double prob)
 {
 	m_impl->m_octomap.setOccupancyThres(prob);
+	internal_markAllModified();
 }
 void CColouredOctoMap::setProbHit(double prob)
 {
@@ -535,4 +462,8 @@ float CColouredOctoMap::getClampingThresMaxLog() const
 {
 	return m_impl->m_octomap.getClampingThresMaxLog();
 }
-void CColouredOctoMap::internal_clear() { m_impl->m_octomap.clear(); }
+void CColouredOctoMap::internal_clear()
+{
+	m_impl->m_octomap.clear();
+	internal_markAllModified();
+}
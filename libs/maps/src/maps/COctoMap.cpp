@@ -143,155 +143,120 @@ bool COctoMap::internal_insertObservation(
 			obs, robotPose, sensorPt, scan))
 		return false;  // Nothing to do.
 	// Insert rays:
-	m_impl->m_octomap.insertPointCloud(
-		scan, sensorPt, insertionOptions.maxrange, insertionOptions.pruning);
+	internal_insertPointCloud(scan, sensorPt, insertionOptions.pruning);
 	return true;
 }
 
-/** Builds a renderizable representation of the octomap as a
- * mrpt::opengl::COctoMapVoxels object. */
-void COctoMap::getAsOctoMapVoxels(mrpt::opengl::COctoMapVoxels& gl_obj) const
+// Returns the functor with the color of each voxel for COctoMapVoxels, and
+// the parameters these colors depend on.
+static auto voxelColors(
+	const COctoMap& map, const COctoMapVoxels& gl_obj,
+	std::vector<double>& colorParams)
 {
-	// Go thru all voxels:
-	// OcTreeVolume voxel; // current voxel, possibly transformed
-	octomap::OcTree::tree_iterator it_end = m_impl->m_octomap.end_tree();
-
-	const unsigned char max_depth = 0;	// all
+	const auto mode = gl_obj.getVisualizationMode();
 	const TColorf general_color = gl_obj.getColor();
 	const TColor general_color_u(
 		general_color.R * 255, general_color.G * 255, general_color.B * 255,
 		general_color.A * 255);
 
-	gl_obj.clear();
-	gl_obj.reserveGridCubes(this->calcNumNodes());
-
-	gl_obj.resizeVoxelSets(2);	// 2 sets of voxels: occupied & free
+	double xmin, xmax, ymin, ymax, zmin, zmax;
+	map.getMetricMin(xmin, ymin, zmin);
+	map.getMetricMax(xmax, ymax, zmax);
+	const double inv_dz = 1 / (zmax - zmin + 0.01);
 
-	gl_obj.showVoxels(
-		VOXEL_SET_OCCUPIED, renderingOptions.visibleOccupiedVoxels);
-	gl_obj.showVoxels(VOXEL_SET_FREESPACE, renderingOptions.visibleFreeVoxels);
-
-	const size_t nLeafs = this->getNumLeafNodes();
-	gl_obj.reserveVoxels(VOXEL_SET_OCCUPIED, nLeafs);
-	gl_obj.reserveVoxels(VOXEL_SET_FREESPACE, nLeafs);
-
-	double xmin, xmax, ymin, ymax, zmin, zmax, inv_dz;
-	this->getMetricMin(xmin, ymin, zmin);
-	this->getMetricMax(xmax, ymax, zmax);
-	inv_dz = 1 / (zmax - zmin + 0.01);
-
-	for (octomap::OcTree::tree_iterator it =
-			 m_impl->m_octomap.begin_tree(max_depth);
-		 it != it_end; ++it)
+	colorParams = {
+		static_cast<double>(mode), general_color.R, general_color.G,
+		general_color.B, general_color.A};
+	if (mode == COctoMapVoxels::COLOR_FROM_HEIGHT ||
+		mode == COctoMapVoxels::MIXED)
 	{
-		const octomap::point3d vx_center = it.getCoordinate();
-		const double vx_length = it.getSize();
-		const double L = 0.5 * vx_length;
-
-		if (it.isLeaf())
-		{
-			// voxels for leaf nodes
-			const double occ = it->getOccupancy();
-			if ((occ >= 0.5 && renderingOptions.generateOccupiedVoxels) ||
-				(occ < 0.5 && renderingOptions.generateFreeVoxels))
-			{
-				mrpt::img::TColor vx_color;
-				double coefc, coeft;
-				switch (gl_obj.getVisualizationMode())
-				{
-					case COctoMapVoxels::FIXED:
-						vx_color = general_color_u;
-						break;
-					case COctoMapVoxels::COLOR_FROM_HEIGHT:
-						coefc = 255 * inv_dz * (vx_center.z() - zmin);
-						vx_color = TColor(
-							coefc * general_color.R, coefc * general_color.G,
-							coefc * general_color.B, 255.0 * general_color.A);
-						break;
-
-					case COctoMapVoxels::COLOR_FROM_OCCUPANCY:
-						coefc = 240 * (1 - occ) + 15;
-						vx_color = TColor(
-							coefc * general_color.R, coefc * general_color.G,
-							coefc * general_color.B, 255.0 * general_color.A);
-						break;
-
-					case COctoMapVoxels::TRANSPARENCY_FROM_OCCUPANCY:
-						coeft = 255 - 510 * (1 - occ);
-						if (coeft < 0) { coeft = 0; }
-						vx_color = TColor(
-							255 * general_color.R, 255 * general_color.G,
-							255 * general_color.B, coeft);
-						break;
-
-					case COctoMapVoxels::TRANS_AND_COLOR_FROM_OCCUPANCY:
-						coefc = 240 * (1 - occ) + 15;
-						vx_color = TColor(
-							coefc * general_color.R, coefc * general_color.G,
-							coefc * general_color.B, 50);
-						break;
-
-					case COctoMapVoxels::MIXED:
-						coefc = 255 * inv_dz * (vx_center.z() - zmin);
-						coeft = 255 - 510 * (1 - occ);
-						if (coeft < 0) { coeft = 0; }
-						vx_color = TColor(
-							coefc * general_color.R, coefc * general_color.G,
-							coefc * general_color.B, coeft);
-						break;
-
-					default: THROW_EXCEPTION("Unknown coloring scheme!");
-				}
-
-				const size_t vx_set = (m_impl->m_octomap.isNodeOccupied(*it))
-					? VOXEL_SET_OCCUPIED
-					: VOXEL_SET_FREESPACE;
+		colorParams.push_back(zmin);
+		colorParams.push_back(zmax);
+	}
 
-				gl_obj.push_back_Voxel(
-					vx_set,
-					COctoMapVoxels::TVoxel(
-						TPoint3D(vx_center.x(), vx_center.y(), vx_center.z()),
-						vx_length, vx_color));
-			}
-		}
-		else if (renderingOptions.generateGridLines)
+	return [=](const octomap::OcTreeNode& node, const TPoint3D& vx_center) {
+		const double occ = node.getOccupancy();
+		mrpt::img::TColor vx_color;
+		double coefc, coeft;
+		switch (mode)
 		{
-			// Not leaf-nodes:
-			const mrpt::math::TPoint3D pt_min(
-				vx_center.x() - L, vx_center.y() - L, vx_center.z() - L);
-			const mrpt::math::TPoint3D pt_max(
-				vx_center.x() + L, vx_center.y() + L, vx_center.z() + L);
-			gl_obj.push_back_GridCube(
-				COctoMapVoxels::TGridCube(pt_min, pt_max));
+			case COctoMapVoxels::FIXED: vx_color = general_color_u; break;
+			case COctoMapVoxels::COLOR_FROM_HEIGHT:
+				coefc = 255 * inv_dz * (vx_center.z - zmin);
+				vx_color = TColor(
+					coefc * general_color.R, coefc * general_color.G,
+					coefc * general_color.B, 255.0 * general_color.A);
+				break;
+
+			case COctoMapVoxels::COLOR_FROM_OCCUPANCY:
+				coefc = 240 * (1 - occ) + 15;
+				vx_color = TColor(
+					coefc * general_color.R, coefc * general_color.G,
+					coefc * general_color.B, 255.0 * general_color.A);
+				break;
+
+			case COctoMapVoxels::TRANSPARENCY_FROM_OCCUPANCY:
+				coeft = 255 - 510 * (1 - occ);
+				if (coeft < 0) { coeft = 0; }
+				vx_color = TColor(
+					255 * general_color.R, 255 * general_color.G,
+					255 * general_color.B, coeft);
+				break;
+
+			case COctoMapVoxels::TRANS_AND_COLOR_FROM_OCCUPANCY:
+				coefc = 240 * (1 - occ) + 15;
+				vx_color = TColor(
+					coefc * general_color.R, coefc * general_color.G,
+					coefc * general_color.B, 50);
+				break;
+
+			case COctoMapVoxels::MIXED:
+				coefc = 255 * inv_dz * (vx_center.z - zmin);
+				coeft = 255 - 510 * (1 - occ);
+				if (coeft < 0) { coeft = 0; }
+				vx_color = TColor(
+					coefc * general_color.R, coefc * general_color.G,
+					coefc * general_color.B, coeft);
+				break;
+
+			default: THROW_EXCEPTION("Unknown coloring scheme!");
 		}
-	}  // end for each voxel
+		return vx_color;
+	};
+}
 
-	// if we use transparency, sort cubes by "Z" as an approximation to
-	// far-to-near render ordering:
-	if (gl_obj.isCubeTransparencyEnabled()) gl_obj.sort_voxels_by_z();
+/** Builds a renderizable representation of the octomap as a
+ * mrpt::opengl::COctoMapVoxels object. */
+void COctoMap::getAsOctoMapVoxels(mrpt::opengl::COctoMapVoxels& gl_obj) const
+{
+	std::vector<double> colorParams;
+	const auto colors = voxelColors(*this, gl_obj, colorParams);
+	internal_getAsOctoMapVoxels(gl_obj, false, colors, colorParams);
+}
 
-	// Set bounding box:
-	{
-		mrpt::math::TPoint3D bbmin, bbmax;
-		this->getMetricMin(bbmin.x, bbmin.y, bbmin.z);
-		this->getMetricMax(bbmax.x, bbmax.y, bbmax.z);
-		gl_obj.setBoundingBox(bbmin, bbmax);
-	}
+void COctoMap::updateOctoMapVoxels(mrpt::opengl::COctoMapVoxels& gl_obj) const
+{
+	std::vector<double> colorParams;
+	const auto colors = voxelColors(*this, gl_obj, colorParams);
+	internal_getAsOctoMapVoxels(gl_obj, true, colors, colorParams);
 }
 
 void COctoMap::insertRay(
 	const float end_x, const float end_y, const float end_z,
 	const float sensor_x, const float sensor_y, const float sensor_z)
 {
-	m_impl->m_octomap.insertRay(
+	internal_insertRay(
 		octomap::point3d(sensor_x, sensor_y, sensor_z),
-		octomap::point3d(end_x, end_y, end_z), insertionOptions.maxrange,
-		insertionOptions.pruning);
+		octomap::point3d(end_x, end_y, end_z));
 }
 void COctoMap::updateVoxel(
 	const double x, const double y, const double z, bool occupied)
 {
-	m_impl->m_octomap.updateNode(x, y, z, occupied);
+	octomap::OcTreeKey key;
+	if (!m_impl->m_octomap.coordToKeyChecked(octomap::point3d(x, y, z), key))
+		return;
+	m_impl->m_octomap.updateNode(key, occupied);
+	internal_markModified(key);
 }
 bool COctoMap::isPointWithinOctoMap(
 	const float x, const float y, const float z) const
@@ -354,6 +319,7 @@ size_t COctoMap::getNumLeafNodes() const
 void COctoMap::setOccupancyThres(double prob)
 {
 	m_impl->m_octomap.setOccupancyThres(prob);
+	internal_markAllModified();
 }
 void COctoMap::setProbHit(double prob) { m_impl->m_octomap.setProbHit(prob); }
 void COctoMap::setProbMiss(double prob) { m_impl->m_octomap.setProbMiss(prob); }
@@ -399,4 +365,8 @@ float COctoMap::getClampingThresMaxLog() const
 {
 	return m_impl->m_octomap.getClampingThresMaxLog();
 }
-void COctoMap::internal_clear() { m_impl->m_octomap.clear(); }
+void COctoMap::internal_clear()
+{
+	m_impl->m_octomap.clear();
+	internal_markAllModified();
+}
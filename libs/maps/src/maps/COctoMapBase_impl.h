@@ -8,6 +8,7 @@
    +------------------------------------------------------------------------+ */
 
 // This file is to be included from <mrpt/maps/COctoMapBase.h>
+#include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/io/CFileOutputStream.h>
 #include <mrpt/maps/CPointsMap.h>
 #include <mrpt/obs/CObservation2DRangeScan.h>
@@ -16,12 +17,78 @@
 #include <mrpt/obs/CObservationVelodyneScan.h>
 #include <mrpt/serialization/CArchive.h>
 
+#include <algorithm>
+#include <array>
+#include <unordered_set>
+
 namespace mrpt::maps
 {
+namespace internal
+{
+// Voxels are tracked and regenerated in blocks of (2^OCTOMAP_BLOCK_BITS)^3
+// voxels, the subtrees of the octree at a depth of OCTOMAP_BLOCK_BITS
+// levels above the leaves of finest resolution.
+constexpr unsigned OCTOMAP_BLOCK_BITS = 4;
+
+// Key of the minimum corner of an octree node:
+using octomap_node_key_t = std::array<unsigned int, 3>;
+
+// ID of the COctoMapVoxels block with the nodes larger than blocks:
+constexpr uint64_t OCTOMAP_BIG_NODES_BLOCK = ~uint64_t(0);
+
+template <class octomap_key>
+uint64_t octomapBlockOf(const octomap_key& k)
+{
+	return (static_cast<uint64_t>(k[0] >> OCTOMAP_BLOCK_BITS) << 32) |
+		(static_cast<uint64_t>(k[1] >> OCTOMAP_BLOCK_BITS) << 16) |
+		static_cast<uint64_t>(k[2] >> OCTOMAP_BLOCK_BITS);
+}
+
+// Visits `node`, whose minimum corner has the key `key`, and its descendants
+// down to `maxDepth`, calling `f(node, key, depth, isLeaf)`.
+template <class OCTREE, class NODE, class FUNCTOR>
+void octomapVisitNodes(
+	const OCTREE& om, const NODE* node, const octomap_node_key_t& key,
+	unsigned int depth, unsigned int maxDepth, FUNCTOR& f)
+{
+	const bool hasChildren = om.nodeHasChildren(node);
+	f(node, key, depth, !hasChildren);
+	if (!hasChildren || depth >= maxDepth) return;
+
+	// Child i is at +x if (i & 1), +y if (i & 2), +z if (i & 4):
+	const unsigned int half = 1U << (om.getTreeDepth() - depth - 1);
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		if (!om.nodeChildExists(node, i)) continue;
+		octomap_node_key_t childKey = key;
+		for (unsigned int axis = 0; axis < 3; axis++)
+			if (i & (1U << axis)) childKey[axis] += half;
+		octomapVisitNodes(
+			om, om.getNodeChild(node, i), childKey, depth + 1, maxDepth, f);
+	}
+}
+}  // namespace internal
+
 template <class OCTREE, class OCTREE_NODE>
 struct mrpt::maps::COctoMapBase<OCTREE, OCTREE_NODE>::Impl
 {
 	OCTREE m_octomap;
+
+	/** Preallocated ray, for internal_insertRay() */
+	octomap::KeyRay m_keyRay;
+
+	/** Blocks of voxels modified since the last call to
+	 * updateOctoMapVoxels() (see internal::octomapBlockOf()), or all of them
+	 * if m_allModified */
+	mutable std::unordered_set<uint64_t> m_modifiedBlocks;
+	mutable bool m_allModified = true;
+
+	/** The parameters the voxels were generated with in the last call to
+	 * updateOctoMapVoxels(), and COctoMapVoxels::changeGeneration() of the
+	 * object they were written to, so the blocks it holds are only reused if
+	 * neither changed. */
+	mutable std::vector<double> m_voxelBlocksParams;
+	mutable uint64_t m_voxelBlocksGeneration = 0;
 };
 
 template <class OCTREE, class OCTREE_NODE>
@@ -263,12 +330,307 @@ void COctoMapBase<OCTREE, OCTREE_NODE>::insertPointCloud(
 	const float *xs, *ys, *zs;
 	ptMap.getPointsBuffer(N, xs, ys, zs);
 	for (size_t i = 0; i < N; i++)
-		m_impl->m_octomap.insertRay(
-			sensorPt, octomap::point3d(xs[i], ys[i], zs[i]),
-			insertionOptions.maxrange, insertionOptions.pruning);
+		internal_insertRay(sensorPt, octomap::point3d(xs[i], ys[i], zs[i]));
 	MRPT_END
 }
 
+template <class OCTREE, class OCTREE_NODE>
+template <class octomap_key>
+void COctoMapBase<OCTREE, OCTREE_NODE>::internal_markModified(
+	const octomap_key& key)
+{
+	if (!m_impl->m_allModified)
+		m_impl->m_modifiedBlocks.insert(internal::octomapBlockOf(key));
+}
+
+template <class OCTREE, class OCTREE_NODE>
+void COctoMapBase<OCTREE, OCTREE_NODE>::internal_markAllModified()
+{
+	m_impl->m_allModified = true;
+	m_impl->m_modifiedBlocks.clear();
+}
+
+template <class OCTREE, class OCTREE_NODE>
+template <class octomap_point3d, class octomap_pointcloud>
+void COctoMapBase<OCTREE, OCTREE_NODE>::internal_insertPointCloud(
+	const octomap_pointcloud& scan, const octomap_point3d& sensorPt,
+	bool lazyEval)
+{
+	// Same than octomap::OccupancyOcTreeBase::insertPointCloud():
+	auto& om = m_impl->m_octomap;
+	octomap::KeySet free_cells, occupied_cells;
+	om.computeUpdate(
+		scan, sensorPt, free_cells, occupied_cells, insertionOptions.maxrange);
+
+	for (const auto& free_cell : free_cells)
+	{
+		om.updateNode(free_cell, false, lazyEval);
+		internal_markModified(free_cell);
+	}
+	for (const auto& occupied_cell : occupied_cells)
+	{
+		om.updateNode(occupied_cell, true, lazyEval);
+		internal_markModified(occupied_cell);
+	}
+}
+
+template <class OCTREE, class OCTREE_NODE>
+template <class octomap_point3d>
+void COctoMapBase<OCTREE, OCTREE_NODE>::internal_insertRay(
+	const octomap_point3d& sensorPt, const octomap_point3d& endPt)
+{
+	// Same than octomap::OccupancyOcTreeBase::insertRay():
+	auto& om = m_impl->m_octomap;
+	const bool lazyEval = insertionOptions.pruning;
+	const double maxrange = insertionOptions.maxrange;
+
+	// Cut the ray at maxrange, without a hit at its end:
+	const bool cut = maxrange > 0 && (endPt - sensorPt).norm() > maxrange;
+	const octomap_point3d end = cut
+		? sensorPt + (endPt - sensorPt).normalized() * float(maxrange)
+		: endPt;
+
+	auto& ray = m_impl->m_keyRay;
+	if (!om.computeRayKeys(sensorPt, end, ray)) return;
+	for (const auto& free_cell : ray)
+	{
+		om.updateNode(free_cell, false, lazyEval);
+		internal_markModified(free_cell);
+	}
+	if (cut) return;
+
+	octomap::OcTreeKey key;
+	if (om.coordToKeyChecked(end, key))
+	{
+		om.updateNode(key, true, lazyEval);
+		internal_markModified(key);
+	}
+}
+
+template <class OCTREE, class OCTREE_NODE>
+template <class COLOR_FUNCTOR>
+void COctoMapBase<OCTREE, OCTREE_NODE>::internal_getAsOctoMapVoxels(
+	mrpt::opengl::COctoMapVoxels& gl_obj, bool incremental,
+	const COLOR_FUNCTOR& voxelColor,
+	const std::vector<double>& colorParams) const
+{
+	using mrpt::opengl::COctoMapVoxels;
+	using mrpt::opengl::VOXEL_SET_FREESPACE;
+	using mrpt::opengl::VOXEL_SET_OCCUPIED;
+	using VoxelBlock = COctoMapVoxels::TVoxelBlock;
+
+	const auto& om = m_impl->m_octomap;
+	const unsigned int treeDepth = om.getTreeDepth();
+	const unsigned int blockDepth = treeDepth - internal::OCTOMAP_BLOCK_BITS;
+	const double res = om.getResolution();
+	// Key of the origin of coordinates:
+	const int originKey = 1 << (treeDepth - 1);
+
+	// Voxels or grid cubes of one node:
+	const auto addNode = [&](const OCTREE_NODE* node,
+							 const internal::octomap_node_key_t& key,
+							 unsigned int depth, bool isLeaf,
+							 VoxelBlock& out) {
+		const double vx_length = res * (1U << (treeDepth - depth));
+		const double L = 0.5 * vx_length;
+		const mrpt::math::TPoint3D vx_center(
+			(static_cast<int>(key[0]) - originKey) * res + L,
+			(static_cast<int>(key[1]) - originKey) * res + L,
+			(static_cast<int>(key[2]) - originKey) * res + L);
+
+		if (isLeaf)
+		{
+			// voxels for leaf nodes
+			const double occ = node->getOccupancy();
+			if ((occ >= 0.5 && renderingOptions.generateOccupiedVoxels) ||
+				(occ < 0.5 && renderingOptions.generateFreeVoxels))
+			{
+				const size_t vx_set = om.isNodeOccupied(node)
+					? VOXEL_SET_OCCUPIED
+					: VOXEL_SET_FREESPACE;
+				out.voxels[vx_set].emplace_back(
+					vx_center, vx_length, voxelColor(*node, vx_center));
+			}
+		}
+		else if (renderingOptions.generateGridLines)
+		{
+			// Not leaf-nodes:
+			const mrpt::math::TPoint3D pt_min(
+				vx_center.x - L, vx_center.y - L, vx_center.z - L);
+			const mrpt::math::TPoint3D pt_max(
+				vx_center.x + L, vx_center.y + L, vx_center.z + L);
+			out.gridCubes.emplace_back(pt_min, pt_max);
+		}
+	};
+
+	// Nodes larger than blocks, and the roots of all blocks:
+	VoxelBlock bigNodes;
+	bigNodes.voxels.resize(2);
+	std::vector<std::pair<uint64_t, internal::octomap_node_key_t>> blockRoots;
+	std::vector<const OCTREE_NODE*> blockRootNodes;
+	if (const OCTREE_NODE* root = om.getRoot(); root)
+	{
+		auto visitor = [&](const OCTREE_NODE* node,
+						   const internal::octomap_node_key_t& key,
+						   unsigned int depth, bool isLeaf) {
+			if (depth < blockDepth) addNode(node, key, depth, isLeaf, bigNodes);
+			else
+			{
+				blockRoots.emplace_back(internal::octomapBlockOf(key), key);
+				blockRootNodes.push_back(node);
+			}
+		};
+		internal::octomapVisitNodes(
+			om, root, internal::octomap_node_key_t({0, 0, 0}), 0, blockDepth,
+			visitor);
+	}
+
+	// Regenerates the i-th block in blockRoots:
+	const auto generateBlock = [&](size_t i, VoxelBlock& b) {
+		b.voxels.resize(2);
+		auto visitor = [&](const OCTREE_NODE* node,
+						   const internal::octomap_node_key_t& key,
+						   unsigned int depth, bool isLeaf) {
+			addNode(node, key, depth, isLeaf, b);
+		};
+		internal::octomapVisitNodes(
+			om, blockRootNodes[i], blockRoots[i].second, blockDepth,
+			treeDepth, visitor);
+	};
+
+	if (incremental)
+	{
+		// Reuse the blocks of the last call, if possible:
+		std::vector<double> params = colorParams;
+		params.push_back(renderingOptions.generateGridLines);
+		params.push_back(renderingOptions.generateOccupiedVoxels);
+		params.push_back(renderingOptions.generateFreeVoxels);
+
+		const bool reuse = !m_impl->m_allModified &&
+			params == m_impl->m_voxelBlocksParams &&
+			gl_obj.changeGeneration() == m_impl->m_voxelBlocksGeneration &&
+			gl_obj.getVoxelSetCount() == 2;
+		if (!reuse)
+		{
+			gl_obj.clear();
+			gl_obj.resizeVoxelSets(2);	// 2 sets of voxels: occupied & free
+		}
+		if (gl_obj.areVoxelsVisible(VOXEL_SET_OCCUPIED) !=
+			renderingOptions.visibleOccupiedVoxels)
+			gl_obj.showVoxels(
+				VOXEL_SET_OCCUPIED, renderingOptions.visibleOccupiedVoxels);
+		if (gl_obj.areVoxelsVisible(VOXEL_SET_FREESPACE) !=
+			renderingOptions.visibleFreeVoxels)
+			gl_obj.showVoxels(
+				VOXEL_SET_FREESPACE, renderingOptions.visibleFreeVoxels);
+
+		// Remove blocks which no longer exist, e.g. after pruning:
+		std::unordered_set<uint64_t> liveBlocks;
+		for (const auto& id_key : blockRoots)
+			liveBlocks.insert(id_key.first);
+		liveBlocks.insert(internal::OCTOMAP_BIG_NODES_BLOCK);
+		std::unordered_set<uint64_t> existingBlocks;
+		for (const uint64_t id : gl_obj.getVoxelBlockIDs())
+		{
+			if (liveBlocks.count(id)) existingBlocks.insert(id);
+			else
+				gl_obj.removeVoxelBlock(id);
+		}
+
+		// Only new and modified blocks are regenerated, in parallel:
+		std::vector<size_t> toUpdate;
+		for (size_t i = 0; i < blockRoots.size(); i++)
+		{
+			const uint64_t id = blockRoots[i].first;
+			if (!existingBlocks.count(id) || m_impl->m_modifiedBlocks.count(id))
+				toUpdate.push_back(i);
+		}
+
+		// if we use transparency, sort cubes by "Z" as an approximation to
+		// far-to-near render ordering, within each block:
+		const bool sortByZ = gl_obj.isCubeTransparencyEnabled();
+		const auto sortBlock = [sortByZ](VoxelBlock& b) {
+			if (!sortByZ) return;
+			for (auto& voxels : b.voxels)
+				std::sort(
+					voxels.begin(), voxels.end(),
+					[](const COctoMapVoxels::TVoxel& v1,
+					   const COctoMapVoxels::TVoxel& v2) {
+						return v1.coords.z < v2.coords.z;
+					});
+		};
+
+		std::vector<VoxelBlock> newBlocks(toUpdate.size());
+		mrpt::WorkerThreadsPool::Default().parallel_for(
+			0, toUpdate.size(), [&](size_t k) {
+				generateBlock(toUpdate[k], newBlocks[k]);
+				sortBlock(newBlocks[k]);
+			});
+		for (size_t k = 0; k < toUpdate.size(); k++)
+			gl_obj.setVoxelBlock(
+				blockRoots[toUpdate[k]].first, std::move(newBlocks[k]));
+		sortBlock(bigNodes);
+		gl_obj.setVoxelBlock(
+			internal::OCTOMAP_BIG_NODES_BLOCK, std::move(bigNodes));
+
+		m_impl->m_modifiedBlocks.clear();
+		m_impl->m_allModified = false;
+		m_impl->m_voxelBlocksParams = params;
+		m_impl->m_voxelBlocksGeneration = gl_obj.changeGeneration();
+	}
+	else
+	{
+		// Regenerate all blocks in parallel:
+		std::vector<VoxelBlock> blocks(blockRoots.size());
+		mrpt::WorkerThreadsPool::Default().parallel_for(
+			0, blockRoots.size(),
+			[&](size_t i) { generateBlock(i, blocks[i]); });
+
+		// Put all together:
+		gl_obj.clear();
+		gl_obj.resizeVoxelSets(2);	// 2 sets of voxels: occupied & free
+
+		gl_obj.showVoxels(
+			VOXEL_SET_OCCUPIED, renderingOptions.visibleOccupiedVoxels);
+		gl_obj.showVoxels(
+			VOXEL_SET_FREESPACE, renderingOptions.visibleFreeVoxels);
+
+		std::array<size_t, 2> nVoxels = {0, 0};
+		size_t nGridCubes = 0;
+		blocks.push_back(std::move(bigNodes));
+		for (const VoxelBlock& b : blocks)
+		{
+			for (size_t set = 0; set < 2; set++)
+				nVoxels[set] += b.voxels[set].size();
+			nGridCubes += b.gridCubes.size();
+		}
+		for (size_t set = 0; set < 2; set++)
+			gl_obj.reserveVoxels(set, nVoxels[set]);
+		gl_obj.reserveGridCubes(nGridCubes);
+
+		for (const VoxelBlock& b : blocks)
+		{
+			for (size_t set = 0; set < 2; set++)
+				for (const auto& vx : b.voxels[set])
+					gl_obj.push_back_Voxel(set, vx);
+			for (const auto& gc : b.gridCubes)
+				gl_obj.push_back_GridCube(gc);
+		}
+
+		// if we use transparency, sort cubes by "Z" as an approximation to
+		// far-to-near render ordering:
+		if (gl_obj.isCubeTransparencyEnabled()) gl_obj.sort_voxels_by_z();
+	}
+
+	// Set bounding box:
+	{
+		mrpt::math::TPoint3D bbmin, bbmax;
+		om.getMetricMin(bbmin.x, bbmin.y, bbmin.z);
+		om.getMetricMax(bbmax.x, bbmax.y, bbmax.z);
+		gl_obj.setBoundingBox(bbmin, bbmax);
+	}
+}
+
 template <class OCTREE, class OCTREE_NODE>
 bool COctoMapBase<OCTREE, OCTREE_NODE>::castRay(
 	const mrpt::math::TPoint3D& origin, const mrpt::math::TPoint3D& direction,
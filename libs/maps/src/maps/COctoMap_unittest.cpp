@@ -12,6 +12,9 @@
 #include <mrpt/obs/CObservation2DRangeScan.h>
 #include <mrpt/obs/stock_observations.h>
 
+#include <algorithm>
+#include <array>
+
 using namespace mrpt;
 using namespace mrpt::maps;
 using namespace mrpt::obs;
@@ -60,3 +63,65 @@ TEST(COctoMapTests, insert2DScan)
 		map.insertObservation(scan1);
 	}
 }
+
+// All voxels of a set, sorted:
+static std::vector<std::array<double, 8>> sortedVoxels(
+	const mrpt::opengl::COctoMapVoxels& gl, size_t set)
+{
+	std::vector<std::array<double, 8>> vxs;
+	for (size_t i = 0; i < gl.getVoxelCount(set); i++)
+	{
+		const auto& v = gl.getVoxel(set, i);
+		vxs.push_back(
+			{v.coords.x, v.coords.y, v.coords.z, v.side_length,
+			 double(v.color.R), double(v.color.G), double(v.color.B),
+			 double(v.color.A)});
+	}
+	std::sort(vxs.begin(), vxs.end());
+	return vxs;
+}
+
+TEST(COctoMapTests, updateOctoMapVoxels)
+{
+	mrpt::obs::CObservation2DRangeScan scan1;
+	stock_observations::example2DRangeScan(scan1);
+
+	using mrpt::opengl::COctoMapVoxels;
+	using mrpt::opengl::VOXEL_SET_FREESPACE;
+	using mrpt::opengl::VOXEL_SET_OCCUPIED;
+
+	COctoMap map(0.2);
+	map.renderingOptions.generateGridLines = true;
+
+	COctoMapVoxels incr, full;
+	map.updateOctoMapVoxels(incr);
+	EXPECT_EQ(incr.getVoxelCount(VOXEL_SET_OCCUPIED), 0U);
+
+	// The incremental update always gives the same voxels than the full one:
+	for (int i = 0; i < 4; i++)
+	{
+		map.insertObservation(
+			scan1, CPose3D(0.5 * i, 0.1 * i, 0, 0.2 * i, 0, 0));
+		map.updateVoxel(-1, -1, 1, i % 2 == 0);
+
+		map.updateOctoMapVoxels(incr);
+		map.getAsOctoMapVoxels(full);
+		ASSERT_GT(full.getVoxelCount(VOXEL_SET_OCCUPIED), 0U);
+		for (size_t set : {VOXEL_SET_OCCUPIED, VOXEL_SET_FREESPACE})
+			EXPECT_EQ(sortedVoxels(incr, set), sortedVoxels(full, set));
+		EXPECT_EQ(incr.getGridCubeCount(), full.getGridCubeCount());
+	}
+
+	// Changes of the visualization parameters are detected, too:
+	incr.setVisualizationMode(COctoMapVoxels::COLOR_FROM_HEIGHT);
+	full.setVisualizationMode(COctoMapVoxels::COLOR_FROM_HEIGHT);
+	map.updateOctoMapVoxels(incr);
+	map.getAsOctoMapVoxels(full);
+	EXPECT_EQ(
+		sortedVoxels(incr, VOXEL_SET_OCCUPIED),
+		sortedVoxels(full, VOXEL_SET_OCCUPIED));
+
+	map.clear();
+	map.updateOctoMapVoxels(incr);
+	EXPECT_EQ(incr.getVoxelCount(VOXEL_SET_OCCUPIED), 0U);
+}
@@ -0,0 +1,1062 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h"  // Precomp header
+//
+#include <mrpt/config.h>
+#include <mrpt/core/format.h>
+#include <mrpt/core/reverse_bytes.h>
+#include <mrpt/io/CMemoryMappedFile.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/system/os.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+using namespace mrpt::maps;
+
+// Native (PCL-free) readers and writers of binary point cloud formats.
+// Readers memory-map the file and copy each field into the point buffers
+// in blocks of points, so the data is read from the mapped pages once.
+
+namespace
+{
+// Number of points processed at once when copying fields.
+constexpr size_t BLOCK_POINTS = 4096;
+
+enum class ScalarType : uint8_t
+{
+	Unknown = 0,
+	Int8,
+	UInt8,
+	Int16,
+	UInt16,
+	Int32,
+	UInt32,
+	Int64,
+	UInt64,
+	Float32,
+	Float64
+};
+
+size_t scalarSize(ScalarType t)
+{
+	switch (t)
+	{
+		case ScalarType::Int8:
+		case ScalarType::UInt8: return 1;
+		case ScalarType::Int16:
+		case ScalarType::UInt16: return 2;
+		case ScalarType::Int32:
+		case ScalarType::UInt32:
+		case ScalarType::Float32: return 4;
+		case ScalarType::Int64:
+		case ScalarType::UInt64:
+		case ScalarType::Float64: return 8;
+		default: return 0;
+	};
+}
+
+template <typename T>
+void copyColumnAs(
+	const uint8_t* src, size_t stride, size_t n, float* dst, float scale,
+	bool swapBytes)
+{
+	for (size_t i = 0; i < n; i++, src += stride)
+	{
+		T v;
+		std::memcpy(&v, src, sizeof(T));
+		if (swapBytes) mrpt::reverseBytesInPlace(v);
+		dst[i] = static_cast<float>(v) * scale;
+	}
+}
+
+// Copies `n` values of type `t`, `stride` bytes apart, into dst[0:n-1].
+void copyColumn(
+	ScalarType t, const uint8_t* src, size_t stride, size_t n, float* dst,
+	float scale = 1.0f, bool swapBytes = false)
+{
+	switch (t)
+	{
+		case ScalarType::Int8:
+			return copyColumnAs<int8_t>(src, stride, n, dst, scale, swapBytes);
+		case ScalarType::UInt8:
+			return copyColumnAs<uint8_t>(src, stride, n, dst, scale, swapBytes);
+		case ScalarType::Int16:
+			return copyColumnAs<int16_t>(src, stride, n, dst, scale, swapBytes);
+		case ScalarType::UInt16:
+			return copyColumnAs<uint16_t>(
+				src, stride, n, dst, scale, swapBytes);
+		case ScalarType::Int32:
+			return copyColumnAs<int32_t>(src, stride, n, dst, scale, swapBytes);
+		case ScalarType::UInt32:
+			return copyColumnAs<uint32_t>(
+				src, stride, n, dst, scale, swapBytes);
+		case ScalarType::Int64:
+			return copyColumnAs<int64_t>(src, stride, n, dst, scale, swapBytes);
+		case ScalarType::UInt64:
+			return copyColumnAs<uint64_t>(
+				src, stride, n, dst, scale, swapBytes);
+		case ScalarType::Float32:
+			return copyColumnAs<float>(src, stride, n, dst, scale, swapBytes);
+		case ScalarType::Float64:
+			return copyColumnAs<double>(src, stride, n, dst, scale, swapBytes);
+		default: THROW_EXCEPTION("Unknown scalar type");
+	};
+}
+
+// Unpacks PCL "rgb" values (0x00RRGGBB, stored as a 4-byte float or uint).
+void copyPackedRGB(
+	const uint8_t* src, size_t stride, size_t n, float* R, float* G, float* B)
+{
+	for (size_t i = 0; i < n; i++, src += stride)
+	{
+		uint32_t rgb;
+		std::memcpy(&rgb, src, sizeof(rgb));
+		R[i] = ((rgb >> 16) & 0xff) * (1.0f / 255);
+		G[i] = ((rgb >> 8) & 0xff) * (1.0f / 255);
+		B[i] = (rgb & 0xff) * (1.0f / 255);
+	}
+}
+
+uint32_t packRGB(float R, float G, float B)
+{
+	auto u8 = [](float v) {
+		return static_cast<uint32_t>(std::min(std::max(v, 0.0f), 1.0f) * 255);
+	};
+	return (u8(R) << 16) | (u8(G) << 8) | u8(B);
+}
+
+// Splits `line` into whitespace-separated tokens.
+std::vector<std::string_view> splitTokens(std::string_view line)
+{
+	std::vector<std::string_view> tokens;
+	size_t i = 0;
+	while (i < line.size())
+	{
+		while (i < line.size() && std::isspace(static_cast<uint8_t>(line[i])))
+			i++;
+		const size_t start = i;
+		while (i < line.size() && !std::isspace(static_cast<uint8_t>(line[i])))
+			i++;
+		if (i > start) tokens.push_back(line.substr(start, i - start));
+	}
+	return tokens;
+}
+
+// Returns the next line from `text` starting at `pos`, and moves `pos` to
+// the beginning of the following line. Returns false at the end of the text.
+bool nextLine(std::string_view text, size_t& pos, std::string_view& line)
+{
+	if (pos >= text.size()) return false;
+	size_t end = text.find('\n', pos);
+	if (end == std::string_view::npos) end = text.size();
+	line = text.substr(pos, end - pos);
+	if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+	pos = end + 1;
+	return true;
+}
+
+bool toSize(std::string_view s, size_t& out)
+{
+	const std::string str(s);
+	char* end = nullptr;
+	const auto v = std::strtoull(str.c_str(), &end, 10);
+	if (end == str.c_str() || *end != '\0') return false;
+	out = static_cast<size_t>(v);
+	return true;
+}
+
+// Product of sizes read from file headers, which may overflow. Returns false
+// in that case.
+bool checkedMul(size_t a, size_t b, size_t& out)
+{
+	if (a != 0 && b > std::numeric_limits<size_t>::max() / a) return false;
+	out = a * b;
+	return true;
+}
+
+// ---------------------------------------------------------------------------
+// LZF compression, as used by PCL "binary_compressed" PCD files. Compatible
+// with liblzf by Marc Lehmann (BSD license): each chunk starts with a control
+// byte `c`: literals run of `c+1` bytes if `c<32`, or a back-reference
+// otherwise (length in the top 3 bits, offset in the low 5 bits plus the next
+// byte, length extended by one more byte if it is 7).
+// ---------------------------------------------------------------------------
+bool lzfDecompress(
+	const uint8_t* in, size_t inLen, uint8_t* out, size_t outLen)
+{
+	const uint8_t* const inEnd = in + inLen;
+	uint8_t* op = out;
+	uint8_t* const outEnd = out + outLen;
+
+	while (in < inEnd)
+	{
+		size_t ctrl = *in++;
+		if (ctrl < 32)
+		{
+			ctrl++;	 // literal run
+			if (op + ctrl > outEnd || in + ctrl > inEnd) return false;
+			std::memcpy(op, in, ctrl);
+			op += ctrl;
+			in += ctrl;
+		}
+		else
+		{
+			size_t len = ctrl >> 5;
+			if (len == 7)
+			{
+				if (in >= inEnd) return false;
+				len += *in++;
+			}
+			if (in >= inEnd) return false;
+			const size_t off = ((ctrl & 0x1f) << 8) + *in++ + 1;
+			len += 2;
+			if (off > static_cast<size_t>(op - out) || op + len > outEnd)
+				return false;
+			// Byte by byte, since source and destination may overlap:
+			const uint8_t* ref = op - off;
+			for (size_t i = 0; i < len; i++)
+				*op++ = *ref++;
+		}
+	}
+	return op == outEnd;
+}
+
+// Max ratio of the decompressed to the compressed size: a back-reference
+// of 3 bytes expands into up to 264 bytes.
+constexpr size_t LZF_MAX_EXPANSION = 88;
+
+// Max size of the compressed data (that of incompressible input).
+size_t lzfMaxSize(size_t inLen) { return inLen + inLen / 32 + 1; }
+
+// Returns the compressed size. `out` must have room for lzfMaxSize(inLen).
+size_t lzfCompress(const uint8_t* in, size_t inLen, uint8_t* out)
+{
+	constexpr int HASH_LOG = 14;
+	constexpr size_t MAX_OFF = 1 << 13, MAX_REF = (1 << 8) + (1 << 3);
+	// Last position+1 of each 3-byte sequence hash (0=none):
+	std::vector<uint32_t> htab(1 << HASH_LOG, 0);
+	auto hash = [&](size_t i) {
+		const uint32_t v = (uint32_t(in[i]) << 16) |
+			(uint32_t(in[i + 1]) << 8) | in[i + 2];
+		return (v * 2654435761U) >> (32 - HASH_LOG);
+	};
+
+	size_t ip = 0, op = 0;
+	size_t litCtrl = op++, lit = 0;	 // Pending literals run
+	while (ip + 2 < inLen)
+	{
+		const uint32_t h = hash(ip);
+		const size_t ref = htab[h];
+		htab[h] = static_cast<uint32_t>(ip + 1);
+		if (ref && ip - (ref - 1) <= MAX_OFF &&
+			std::memcmp(in + ref - 1, in + ip, 3) == 0)
+		{
+			const size_t r = ref - 1, off = ip - r - 1;
+			const size_t maxLen = std::min(inLen - ip, MAX_REF);
+			size_t len = 3;
+			while (len < maxLen && in[r + len] == in[ip + len])
+				len++;
+
+			// Close the literals run, if any:
+			if (lit) out[litCtrl] = static_cast<uint8_t>(lit - 1);
+			else
+				op--;
+			const size_t l = len - 2;
+			if (l < 7) out[op++] = static_cast<uint8_t>((off >> 8) + (l << 5));
+			else
+			{
+				out[op++] = static_cast<uint8_t>((off >> 8) + (7 << 5));
+				out[op++] = static_cast<uint8_t>(l - 7);
+			}
+			out[op++] = static_cast<uint8_t>(off & 0xff);
+			litCtrl = op++;
+			lit = 0;
+			ip += len;
+			continue;
+		}
+		out[op++] = in[ip++];
+		if (++lit == 32)
+		{
+			out[litCtrl] = 31;
+			litCtrl = op++;
+			lit = 0;
+		}
+	}
+	while (ip < inLen)
+	{
+		out[op++] = in[ip++];
+		if (++lit == 32)
+		{
+			out[litCtrl] = 31;
+			litCtrl = op++;
+			lit = 0;
+		}
+	}
+	if (lit) out[litCtrl] = static_cast<uint8_t>(lit - 1);
+	else
+		op--;
+	return op;
+}
+
+// ---------------------------------------------------------------------------
+// PCD
+// ---------------------------------------------------------------------------
+struct PCDField
+{
+	std::string name;
+	ScalarType type = ScalarType::Unknown;
+	size_t size = 0, count = 1;
+	/** Offset in bytes within each point, in "binary" files */
+	size_t offset = 0;
+	/** Index of the first token of this field, in "ascii" files */
+	size_t tokenIndex = 0;
+};
+
+struct PCDHeader
+{
+	std::vector<PCDField> fields;
+	size_t points = 0, pointSize = 0, numTokens = 0;
+	std::string data;
+	/** Offset of the data section in the file */
+	size_t dataStart = 0;
+
+	const PCDField* field(const std::string& name) const
+	{
+		for (const auto& f : fields)
+			if (f.name == name) return &f;
+		return nullptr;
+	}
+};
+
+bool parsePCDHeader(std::string_view file, PCDHeader& h, std::string& err)
+{
+	size_t pos = 0, width = 0, height = 1;
+	bool hasPoints = false;
+	std::vector<std::string_view> sizes, types, counts;
+	for (std::string_view line; nextLine(file, pos, line);)
+	{
+		const auto tok = splitTokens(line);
+		if (tok.empty() || tok[0][0] == '#') continue;
+		const auto& key = tok[0];
+		if (key == "FIELDS" || key == "COLUMNS")
+		{
+			for (size_t i = 1; i < tok.size(); i++)
+				h.fields.emplace_back().name = tok[i];
+		}
+		else if (key == "SIZE")
+			sizes.assign(tok.begin() + 1, tok.end());
+		else if (key == "TYPE")
+			types.assign(tok.begin() + 1, tok.end());
+		else if (key == "COUNT")
+			counts.assign(tok.begin() + 1, tok.end());
+		else if (key == "WIDTH" && tok.size() == 2)
+			toSize(tok[1], width);
+		else if (key == "HEIGHT" && tok.size() == 2)
+			toSize(tok[1], height);
+		else if (key == "POINTS" && tok.size() == 2)
+			hasPoints = toSize(tok[1], h.points);
+		else if (key == "DATA" && tok.size() == 2)
+		{
+			h.data = tok[1];
+			h.dataStart = std::min(pos, file.size());
+			break;
+		}
+	}
+	if (h.data.empty())
+	{
+		err = "Missing DATA line";
+		return false;
+	}
+	if (!hasPoints && !checkedMul(width, height, h.points))
+	{
+		err = "Invalid WIDTH or HEIGHT";
+		return false;
+	}
+	if (h.fields.empty() || sizes.size() != h.fields.size() ||
+		types.size() != h.fields.size() ||
+		(!counts.empty() && counts.size() != h.fields.size()))
+	{
+		err = "Missing or inconsistent FIELDS, SIZE, TYPE or COUNT lines";
+		return false;
+	}
+	for (size_t i = 0; i < h.fields.size(); i++)
+	{
+		auto& f = h.fields[i];
+		size_t fieldSize = 0;
+		if (!toSize(sizes[i], f.size) ||
+			(!counts.empty() && !toSize(counts[i], f.count)) ||
+			f.count == 0 || !checkedMul(f.size, f.count, fieldSize) ||
+			fieldSize > std::numeric_limits<size_t>::max() - h.pointSize)
+		{
+			err = "Invalid SIZE or COUNT for field: " + f.name;
+			return false;
+		}
+		const char t = types[i].size() == 1 ? types[i][0] : '?';
+		switch (f.size)
+		{
+			case 1:
+				f.type = t == 'I' ? ScalarType::Int8
+					: t == 'U'	  ? ScalarType::UInt8
+								  : ScalarType::Unknown;
+				break;
+			case 2:
+				f.type = t == 'I' ? ScalarType::Int16
+					: t == 'U'	  ? ScalarType::UInt16
+								  : ScalarType::Unknown;
+				break;
+			case 4:
+				f.type = t == 'I' ? ScalarType::Int32
+					: t == 'U'	  ? ScalarType::UInt32
+					: t == 'F'	  ? ScalarType::Float32
+								  : ScalarType::Unknown;
+				break;
+			case 8:
+				f.type = t == 'I' ? ScalarType::Int64
+					: t == 'U'	  ? ScalarType::UInt64
+					: t == 'F'	  ? ScalarType::Float64
+								  : ScalarType::Unknown;
+				break;
+		};
+		if (f.type == ScalarType::Unknown)
+		{
+			err = "Unsupported SIZE/TYPE for field: " + f.name;
+			return false;
+		}
+		f.offset = h.pointSize;
+		f.tokenIndex = h.numTokens;
+		// No overflow here, since numTokens <= pointSize:
+		h.pointSize += fieldSize;
+		h.numTokens += f.count;
+	}
+	return true;
+}
+
+// Destination buffers for the fields we can load.
+struct PointBuffers
+{
+	float *x = nullptr, *y = nullptr, *z = nullptr, *intensity = nullptr;
+	float *R = nullptr, *G = nullptr, *B = nullptr;
+
+	// To be called after m.setSize(N):
+	PointBuffers(CPointsMap& m, size_t N, float* xs, float* ys, float* zs)
+		: x(xs), y(ys), z(zs)
+	{
+		if (auto* I = m.getPointsBufferRef_intensity(); I && I->size() == N)
+			intensity = I->data();
+		auto *r = m.getPointsBufferRef_color_R(),
+			 *g = m.getPointsBufferRef_color_G(),
+			 *b = m.getPointsBufferRef_color_B();
+		if (r && g && b && r->size() == N && g->size() == N && b->size() == N)
+		{
+			R = r->data();
+			G = g->data();
+			B = b->data();
+		}
+	}
+};
+
+// Copies the fields of "binary" (AoS, stride=pointSize) or the decompressed
+// "binary_compressed" (SoA, one array per field) point data.
+void loadPCDBinaryFields(
+	const PCDHeader& h, const uint8_t* data, bool isSoA, PointBuffers& dst)
+{
+	const size_t N = h.points;
+	struct Column
+	{
+		const PCDField* f;
+		float* dst;
+	};
+	std::vector<Column> cols;
+	for (const auto& [name, buf] :
+		 {std::make_pair("x", dst.x), std::make_pair("y", dst.y),
+		  std::make_pair("z", dst.z),
+		  std::make_pair("intensity", dst.intensity)})
+		if (const auto* f = h.field(name); f && buf) cols.push_back({f, buf});
+
+	const PCDField* rgb = h.field("rgb");
+	if (!rgb) rgb = h.field("rgba");
+	if (rgb && rgb->size != 4) rgb = nullptr;
+	if (!dst.R) rgb = nullptr;
+
+	// Start of the data of field `f` for point `i`:
+	auto fieldPtr = [&](const PCDField& f, size_t i) {
+		return isSoA ? data + f.offset * N + i * f.size * f.count
+					 : data + i * h.pointSize + f.offset;
+	};
+	auto stride = [&](const PCDField& f) {
+		return isSoA ? f.size * f.count : h.pointSize;
+	};
+
+	for (size_t i0 = 0; i0 < N; i0 += BLOCK_POINTS)
+	{
+		const size_t n = std::min(BLOCK_POINTS, N - i0);
+		for (const auto& c : cols)
+			copyColumn(
+				c.f->type, fieldPtr(*c.f, i0), stride(*c.f), n, c.dst + i0);
+		if (rgb)
+			copyPackedRGB(
+				fieldPtr(*rgb, i0), stride(*rgb), n, dst.R + i0, dst.G + i0,
+				dst.B + i0);
+	}
+}
+
+bool loadPCDAscii(
+	const PCDHeader& h, std::string_view text, PointBuffers& dst,
+	std::string& err)
+{
+	struct Column
+	{
+		size_t token;
+		float* dst;
+	};
+	std::vector<Column> cols;
+	for (const auto& [name, buf] :
+		 {std::make_pair("x", dst.x), std::make_pair("y", dst.y),
+		  std::make_pair("z", dst.z),
+		  std::make_pair("intensity", dst.intensity)})
+		if (const auto* f = h.field(name); f && buf)
+			cols.push_back({f->tokenIndex, buf});
+	const PCDField* rgb = h.field("rgb");
+	if (!rgb) rgb = h.field("rgba");
+	if (!dst.R) rgb = nullptr;
+
+	size_t pos = 0, i = 0;
+	std::string tokenStr;
+	for (std::string_view line; i < h.points && nextLine(text, pos, line);)
+	{
+		const auto tok = splitTokens(line);
+		if (tok.empty()) continue;
+		if (tok.size() < h.numTokens)
+		{
+			err = mrpt::format(
+				"Expected %zu values for point #%zu", h.numTokens, i);
+			return false;
+		}
+		for (const auto& c : cols)
+		{
+			tokenStr = tok[c.token];
+			c.dst[i] = std::strtof(tokenStr.c_str(), nullptr);
+		}
+		if (rgb)
+		{
+			// PCL writes packed colors as integers, but also accept them
+			// as the float with the same bit pattern:
+			tokenStr = tok[rgb->tokenIndex];
+			char* end = nullptr;
+			uint32_t v = static_cast<uint32_t>(
+				std::strtoul(tokenStr.c_str(), &end, 10));
+			if (*end != '\0')
+			{
+				const float f = std::strtof(tokenStr.c_str(), nullptr);
+				std::memcpy(&v, &f, sizeof(v));
+			}
+			copyPackedRGB(
+				reinterpret_cast<const uint8_t*>(&v), 0, 1, dst.R + i,
+				dst.G + i, dst.B + i);
+		}
+		i++;
+	}
+	if (i != h.points)
+	{
+		err = mrpt::format("Expected %zu points, found %zu", h.points, i);
+		return false;
+	}
+	return true;
+}
+
+// ---------------------------------------------------------------------------
+// PLY
+// ---------------------------------------------------------------------------
+ScalarType plyScalarType(std::string_view s)
+{
+	if (s == "char" || s == "int8") return ScalarType::Int8;
+	if (s == "uchar" || s == "uint8") return ScalarType::UInt8;
+	if (s == "short" || s == "int16") return ScalarType::Int16;
+	if (s == "ushort" || s == "uint16") return ScalarType::UInt16;
+	if (s == "int" || s == "int32") return ScalarType::Int32;
+	if (s == "uint" || s == "uint32") return ScalarType::UInt32;
+	if (s == "float" || s == "float32") return ScalarType::Float32;
+	if (s == "double" || s == "float64") return ScalarType::Float64;
+	return ScalarType::Unknown;
+}
+
+struct PLYElement
+{
+	std::string name;
+	size_t count = 0, recordSize = 0;
+	bool hasLists = false;
+	/** Scalar properties: name, type, offset in the record */
+	struct Property
+	{
+		std::string name;
+		ScalarType type;
+		size_t offset;
+	};
+	std::vector<Property> props;
+
+	const Property* prop(std::string_view n) const
+	{
+		for (const auto& p : props)
+			if (p.name == n) return &p;
+		return nullptr;
+	}
+};
+
+// Parses the header of a binary PLY file. Returns false if it is not a
+// binary PLY file, or its vertices cannot be located without parsing lists.
+bool parseBinaryPLYHeader(
+	std::string_view file, std::vector<PLYElement>& elements,
+	bool& bigEndian, size_t& dataStart)
+{
+	size_t pos = 0;
+	std::string_view line;
+	if (!nextLine(file, pos, line) || line != "ply") return false;
+	bool binary = false;
+	while (nextLine(file, pos, line))
+	{
+		const auto tok = splitTokens(line);
+		if (tok.empty()) continue;
+		if (tok[0] == "format" && tok.size() >= 2)
+		{
+			binary = tok[1] == "binary_little_endian" ||
+				tok[1] == "binary_big_endian";
+			bigEndian = tok[1] == "binary_big_endian";
+		}
+		else if (tok[0] == "element" && tok.size() == 3)
+		{
+			auto& e = elements.emplace_back();
+			e.name = tok[1];
+			if (!toSize(tok[2], e.count)) return false;
+		}
+		else if (tok[0] == "property" && tok.size() >= 3 && !elements.empty())
+		{
+			auto& e = elements.back();
+			if (tok[1] == "list")
+			{
+				e.hasLists = true;
+				continue;
+			}
+			const auto t = plyScalarType(tok[1]);
+			if (t == ScalarType::Unknown) return false;
+			e.props.push_back({std::string(tok[2]), t, e.recordSize});
+			e.recordSize += scalarSize(t);
+		}
+		else if (tok[0] == "end_header")
+		{
+			dataStart = pos;
+			return binary;
+		}
+	}
+	return false;
+}
+
+}  // namespace
+
+bool CPointsMap::savePCDFile(const std::string& filename, PCDFormat format)
+	const
+{
+	const size_t N = size();
+	const auto* I = getPointsBufferRef_intensity();
+	const auto *R = getPointsBufferRef_color_R(),
+			   *G = getPointsBufferRef_color_G(),
+			   *B = getPointsBufferRef_color_B();
+	if (I && I->size() != N) I = nullptr;
+	const bool hasRGB = R && G && B && R->size() == N && G->size() == N &&
+		B->size() == N;
+
+	FILE* f = mrpt::system::os::fopen(filename.c_str(), "wb");
+	if (!f) return false;
+
+	const size_t nFields = 3 + (I ? 1 : 0) + (hasRGB ? 1 : 0);
+
+	// The compressed format stores its sizes as 32-bit integers: clouds too
+	// large for it are written as plain binary instead.
+	if (format == PCDFormat::BinaryCompressed)
+	{
+		size_t rawSize = 0;
+		if (!checkedMul(N, nFields * 4, rawSize) ||
+			lzfMaxSize(rawSize) > std::numeric_limits<uint32_t>::max())
+			format = PCDFormat::Binary;
+	}
+
+	std::string hdr =
+		"# .PCD v0.7 - Point Cloud Data file format\n"
+		"VERSION 0.7\n"
+		"FIELDS x y z";
+	if (I) hdr += " intensity";
+	if (hasRGB) hdr += " rgb";
+	hdr += "\nSIZE";
+	for (size_t i = 0; i < nFields; i++)
+		hdr += " 4";
+	hdr += "\nTYPE";
+	for (size_t i = 0; i < nFields; i++)
+		hdr += (hasRGB && i == nFields - 1) ? " U" : " F";
+	hdr += "\nCOUNT";
+	for (size_t i = 0; i < nFields; i++)
+		hdr += " 1";
+	hdr += mrpt::format(
+		"\nWIDTH %zu\nHEIGHT 1\nVIEWPOINT 0 0 0 1 0 0 0\nPOINTS %zu\nDATA %s\n",
+		N, N,
+		format == PCDFormat::ASCII		 ? "ascii"
+			: format == PCDFormat::Binary ? "binary"
+										  : "binary_compressed");
+	bool ok = std::fwrite(hdr.data(), 1, hdr.size(), f) == hdr.size();
+
+	// Pointers to the fields, in order:
+	std::vector<const float*> cols = {m_x.data(), m_y.data(), m_z.data()};
+	if (I) cols.push_back(I->data());
+	auto rgbOf = [&](size_t i) {
+		return packRGB((*R)[i], (*G)[i], (*B)[i]);
+	};
+
+	switch (format)
+	{
+		case PCDFormat::ASCII:
+		{
+			std::string buf;
+			for (size_t i = 0; i < N && ok; i++)
+			{
+				for (const float* c : cols)
+					buf += mrpt::format("%.9g ", c[i]);
+				if (hasRGB) buf += std::to_string(rgbOf(i));
+				else
+					buf.pop_back();
+				buf += '\n';
+				if (buf.size() > (1 << 20) || i + 1 == N)
+				{
+					ok = buf.size() ==
+						std::fwrite(buf.data(), 1, buf.size(), f);
+					buf.clear();
+				}
+			}
+		}
+		break;
+		case PCDFormat::Binary:
+		{
+			// Interleave the fields of blocks of points:
+			std::vector<uint8_t> buf(BLOCK_POINTS * nFields * 4);
+			for (size_t i0 = 0; i0 < N && ok; i0 += BLOCK_POINTS)
+			{
+				const size_t n = std::min(BLOCK_POINTS, N - i0);
+				uint8_t* p = buf.data();
+				for (size_t i = i0; i < i0 + n; i++)
+				{
+					for (const float* c : cols)
+					{
+						std::memcpy(p, &c[i], 4);
+						p += 4;
+					}
+					if (hasRGB)
+					{
+						const uint32_t rgb = rgbOf(i);
+						std::memcpy(p, &rgb, 4);
+						p += 4;
+					}
+				}
+				const size_t len = p - buf.data();
+				ok = std::fwrite(buf.data(), 1, len, f) == len;
+			}
+		}
+		break;
+		case PCDFormat::BinaryCompressed:
+		{
+			// All values of each field, one field after the other:
+			const size_t rawSize = N * nFields * 4;
+			std::vector<uint8_t> raw(rawSize);
+			uint8_t* p = raw.data();
+			for (const float* c : cols)
+			{
+				if (N) std::memcpy(p, c, N * 4);
+				p += N * 4;
+			}
+			if (hasRGB)
+				for (size_t i = 0; i < N; i++, p += 4)
+				{
+					const uint32_t rgb = rgbOf(i);
+					std::memcpy(p, &rgb, 4);
+				}
+			std::vector<uint8_t> compressed(lzfMaxSize(rawSize));
+			const auto compSize = static_cast<uint32_t>(
+				lzfCompress(raw.data(), rawSize, compressed.data()));
+			const auto uncompSize = static_cast<uint32_t>(rawSize);
+			ok = ok && std::fwrite(&compSize, 4, 1, f) == 1 &&
+				std::fwrite(&uncompSize, 4, 1, f) == 1 &&
+				std::fwrite(compressed.data(), 1, compSize, f) == compSize;
+		}
+		break;
+	};
+	ok = (std::fclose(f) == 0) && ok;
+	return ok;
+}
+
+bool CPointsMap::loadPCDFile(
+	const std::string& filename, mrpt::optional_ref<std::string> outErrorMsg)
+{
+	MRPT_START
+
+	mark_as_modified();
+	this->clear();
+
+	std::string err;
+	auto onError = [&]() {
+		const auto msg = "[CPointsMap::loadPCDFile] '" + filename + "': " + err;
+		if (outErrorMsg) outErrorMsg.value().get() = msg;
+		this->clear();
+		return false;
+	};
+
+	mrpt::io::CMemoryMappedFile file;
+	if (!file.open(filename))
+	{
+		err = "Cannot open file";
+		return onError();
+	}
+	PCDHeader h;
+	if (!parsePCDHeader(file.asStringView(), h, err)) return onError();
+	if (!h.field("x") || !h.field("y") || !h.field("z"))
+	{
+		err = "Missing x, y or z fields";
+		return onError();
+	}
+
+	const uint8_t* data = file.data() + h.dataStart;
+	const size_t dataSize = file.size() - h.dataStart;
+	if (h.data == "binary")
+	{
+		size_t pointsSize = 0;
+		if (!checkedMul(h.points, h.pointSize, pointsSize) ||
+			dataSize < pointsSize)
+		{
+			err = "Truncated binary data";
+			return onError();
+		}
+		setSize(h.points);
+		PointBuffers dst(*this, h.points, m_x.data(), m_y.data(), m_z.data());
+		loadPCDBinaryFields(h, data, false, dst);
+	}
+	else if (h.data == "binary_compressed")
+	{
+		uint32_t compSize = 0, uncompSize = 0;
+		if (dataSize >= 8)
+		{
+			std::memcpy(&compSize, data, 4);
+			std::memcpy(&uncompSize, data + 4, 4);
+		}
+		size_t pointsSize = 0;
+		if (dataSize < 8 + size_t(compSize) ||
+			!checkedMul(h.points, h.pointSize, pointsSize) ||
+			uncompSize != pointsSize ||
+			uncompSize / LZF_MAX_EXPANSION > compSize)
+		{
+			err = "Truncated or inconsistent compressed data";
+			return onError();
+		}
+		std::vector<uint8_t> raw(uncompSize);
+		if (!lzfDecompress(data + 8, compSize, raw.data(), raw.size()))
+		{
+			err = "Corrupted compressed data";
+			return onError();
+		}
+		setSize(h.points);
+		PointBuffers dst(*this, h.points, m_x.data(), m_y.data(), m_z.data());
+		loadPCDBinaryFields(h, raw.data(), true, dst);
+	}
+	else if (h.data == "ascii")
+	{
+		// Each value takes at least one character and a separator, so
+		// don't allocate more points than the data may hold:
+		const auto text = file.asStringView().substr(h.dataStart);
+		if ((text.size() + 1) / 2 / h.numTokens < h.points)
+		{
+			err = mrpt::format("Truncated data for %zu points", h.points);
+			return onError();
+		}
+		setSize(h.points);
+		PointBuffers dst(*this, h.points, m_x.data(), m_y.data(), m_z.data());
+		if (!loadPCDAscii(h, text, dst, err)) return onError();
+	}
+	else
+	{
+		err = "Unknown DATA encoding: " + h.data;
+		return onError();
+	}
+	mark_as_modified();
+	return true;
+
+	MRPT_END
+}
+
+bool CPointsMap::savePLYFile(const std::string& filename) const
+{
+	const size_t N = size();
+	const auto* I = getPointsBufferRef_intensity();
+	const auto *R = getPointsBufferRef_color_R(),
+			   *G = getPointsBufferRef_color_G(),
+			   *B = getPointsBufferRef_color_B();
+	if (I && I->size() != N) I = nullptr;
+	const bool hasRGB = R && G && B && R->size() == N && G->size() == N &&
+		B->size() == N;
+
+	FILE* f = mrpt::system::os::fopen(filename.c_str(), "wb");
+	if (!f) return false;
+
+	std::string hdr = mrpt::format(
+		"ply\nformat %s 1.0\ncomment Generated by MRPT\n"
+		"element vertex %zu\n"
+		"property float x\nproperty float y\nproperty float z\n",
+		MRPT_IS_BIG_ENDIAN ? "binary_big_endian" : "binary_little_endian", N);
+	if (I) hdr += "property float intensity\n";
+	if (hasRGB)
+		hdr +=
+			"property uchar red\nproperty uchar green\n"
+			"property uchar blue\n";
+	hdr += "end_header\n";
+	bool ok = std::fwrite(hdr.data(), 1, hdr.size(), f) == hdr.size();
+
+	const size_t recordSize = 12 + (I ? 4 : 0) + (hasRGB ? 3 : 0);
+	std::vector<uint8_t> buf(BLOCK_POINTS * recordSize);
+	for (size_t i0 = 0; i0 < N && ok; i0 += BLOCK_POINTS)
+	{
+		const size_t n = std::min(BLOCK_POINTS, N - i0);
+		uint8_t* p = buf.data();
+		for (size_t i = i0; i < i0 + n; i++)
+		{
+			std::memcpy(p, &m_x[i], 4);
+			std::memcpy(p + 4, &m_y[i], 4);
+			std::memcpy(p + 8, &m_z[i], 4);
+			p += 12;
+			if (I)
+			{
+				std::memcpy(p, &(*I)[i], 4);
+				p += 4;
+			}
+			if (hasRGB)
+			{
+				const uint32_t rgb = packRGB((*R)[i], (*G)[i], (*B)[i]);
+				*p++ = static_cast<uint8_t>(rgb >> 16);
+				*p++ = static_cast<uint8_t>(rgb >> 8);
+				*p++ = static_cast<uint8_t>(rgb);
+			}
+		}
+		const size_t len = p - buf.data();
+		ok = std::fwrite(buf.data(), 1, len, f) == len;
+	}
+	ok = (std::fclose(f) == 0) && ok;
+	return ok;
+}
+
+bool CPointsMap::loadPLYFile(
+	const std::string& filename, mrpt::optional_ref<std::string> outErrorMsg)
+{
+	MRPT_START
+
+	mark_as_modified();
+	this->clear();
+
+	auto genericLoad = [&]() {
+		const bool ok = this->loadFromPlyFile(filename);
+		if (!ok && outErrorMsg)
+			outErrorMsg.value().get() = getLoadPLYErrorString();
+		return ok;
+	};
+
+	mrpt::io::CMemoryMappedFile file;
+	if (!file.open(filename))
+	{
+		if (outErrorMsg)
+			outErrorMsg.value().get() =
+				"[CPointsMap::loadPLYFile] Cannot open file: " + filename;
+		return false;
+	}
+
+	std::vector<PLYElement> elements;
+	bool bigEndian = false;
+	size_t dataStart = 0;
+	if (!parseBinaryPLYHeader(
+			file.asStringView(), elements, bigEndian, dataStart))
+		return genericLoad();
+
+	auto truncated = [&]() {
+		if (outErrorMsg)
+			outErrorMsg.value().get() =
+				"[CPointsMap::loadPLYFile] Truncated file: " + filename;
+		return false;
+	};
+
+	// Locate the vertices, skipping former elements of fixed-size records:
+	size_t offset = std::min(dataStart, file.size());
+	const PLYElement* vertex = nullptr;
+	for (const auto& e : elements)
+	{
+		if (e.hasLists) break;
+		if (e.name == "vertex")
+		{
+			vertex = &e;
+			break;
+		}
+		size_t elementSize = 0;
+		if (!checkedMul(e.count, e.recordSize, elementSize) ||
+			elementSize > file.size() - offset)
+			return truncated();
+		offset += elementSize;
+	}
+	if (!vertex || !vertex->prop("x") || !vertex->prop("y") ||
+		!vertex->prop("z"))
+		return genericLoad();
+	const size_t N = vertex->count, stride = vertex->recordSize;
+	if ((file.size() - offset) / stride < N) return truncated();
+
+	setSize(N);
+	PointBuffers dst(*this, N, m_x.data(), m_y.data(), m_z.data());
+	struct Column
+	{
+		const PLYElement::Property* p;
+		float* dst;
+		float scale;
+	};
+	std::vector<Column> cols;
+	auto addColumn = [&](const char* name, float* buf, bool isColor) {
+		const auto* p = vertex->prop(name);
+		if (!p || !buf) return;
+		float scale = 1.0f;
+		if (isColor && p->type == ScalarType::UInt8) scale = 1.0f / 255;
+		else if (isColor && p->type == ScalarType::UInt16)
+			scale = 1.0f / 65535;
+		cols.push_back({p, buf, scale});
+	};
+	addColumn("x", dst.x, false);
+	addColumn("y", dst.y, false);
+	addColumn("z", dst.z, false);
+	addColumn("intensity", dst.intensity, false);
+	addColumn("red", dst.R, true);
+	addColumn("green", dst.G, true);
+	addColumn("blue", dst.B, true);
+
+	const bool swapBytes = bigEndian != static_cast<bool>(MRPT_IS_BIG_ENDIAN);
+	const uint8_t* data = file.data() + offset;
+	for (size_t i0 = 0; i0 < N; i0 += BLOCK_POINTS)
+	{
+		const size_t n = std::min(BLOCK_POINTS, N - i0);
+		for (const auto& c : cols)
+			copyColumn(
+				c.p->type, data + i0 * stride + c.p->offset, stride, n,
+				c.dst + i0, c.scale, swapBytes);
+	}
+	mark_as_modified();
+	return true;
+
+	MRPT_END
+}
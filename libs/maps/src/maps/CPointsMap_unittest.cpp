@@ -13,7 +13,10 @@
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/maps/CWeightedPointsMap.h>
 #include <mrpt/poses/CPoint2D.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/filesystem.h>
 
+#include <fstream>
 #include <sstream>
 
 using namespace mrpt;
@@ -203,6 +206,138 @@ void do_tests_loadSaveStreams()
 	}
 }
 
+template <class MAP>
+void do_tests_loadSavePCDandPLY()
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(123);
+
+	MAP pts0;
+	for (size_t i = 0; i < 1000; i++)
+		pts0.insertPointRGB(
+			rng.drawUniform(-100.f, 100.f), rng.drawUniform(-100.f, 100.f),
+			rng.drawUniform(-10.f, 10.f), rng.drawUniform(0.f, 1.f),
+			rng.drawUniform(0.f, 1.f), rng.drawUniform(0.f, 1.f));
+
+	auto checkEqual = [&](const MAP& pts1) {
+		ASSERT_EQ(pts0.size(), pts1.size());
+		for (size_t i = 0; i < pts0.size(); i++)
+		{
+			float x0, y0, z0, R0, G0, B0, x1, y1, z1, R1, G1, B1;
+			pts0.getPointRGB(i, x0, y0, z0, R0, G0, B0);
+			pts1.getPointRGB(i, x1, y1, z1, R1, G1, B1);
+			EXPECT_EQ(x0, x1);
+			EXPECT_EQ(y0, y1);
+			EXPECT_EQ(z0, z1);
+			// Colors are saved as bytes:
+			const float tol =
+				pts0.getPointsBufferRef_intensity() ? 0 : 1.01f / 255;
+			EXPECT_NEAR(R0, R1, tol);
+			EXPECT_NEAR(G0, G1, tol);
+			EXPECT_NEAR(B0, B1, tol);
+		}
+	};
+
+	const auto fil = mrpt::system::getTempFileName();
+	for (const auto fmt :
+		 {CPointsMap::PCDFormat::ASCII, CPointsMap::PCDFormat::Binary,
+		  CPointsMap::PCDFormat::BinaryCompressed})
+	{
+		EXPECT_TRUE(pts0.savePCDFile(fil, fmt));
+		MAP pts1;
+		std::string errMsg;
+		EXPECT_TRUE(pts1.loadPCDFile(fil, errMsg)) << errMsg;
+		checkEqual(pts1);
+	}
+	{
+		EXPECT_TRUE(pts0.savePLYFile(fil));
+		MAP pts1;
+		std::string errMsg;
+		EXPECT_TRUE(pts1.loadPLYFile(fil, errMsg)) << errMsg;
+		checkEqual(pts1);
+	}
+	// ASCII PLY files are loaded through the generic PLY importer:
+	{
+		EXPECT_TRUE(pts0.saveToPlyFile(fil, false));
+		MAP pts1;
+		EXPECT_TRUE(pts1.loadPLYFile(fil));
+		EXPECT_EQ(pts0.size(), pts1.size());
+	}
+	// A cloud as saved by PCL, with extra fields and packed colors:
+	{
+		std::ofstream f(fil);
+		f << "# .PCD v0.7 - Point Cloud Data file format\n"
+			 "VERSION 0.7\n"
+			 "FIELDS x y z normal_x rgb\n"
+			 "SIZE 4 4 4 4 4\n"
+			 "TYPE F F F F F\n"
+			 "COUNT 1 1 1 1 1\n"
+			 "WIDTH 2\n"
+			 "HEIGHT 1\n"
+			 "VIEWPOINT 0 0 0 1 0 0 0\n"
+			 "POINTS 2\n"
+			 "DATA ascii\n"
+			 "1 2 3 0.5 16711680\n"
+			 "4.5 -5 6 0.5 4.2108e+06\n";
+		f.close();
+		MAP pts1;
+		std::string errMsg;
+		EXPECT_TRUE(pts1.loadPCDFile(fil, errMsg)) << errMsg;
+		ASSERT_EQ(pts1.size(), 2U);
+		float x, y, z, R, G, B;
+		pts1.getPointRGB(1, x, y, z, R, G, B);
+		EXPECT_EQ(x, 4.5f);
+		EXPECT_EQ(y, -5.0f);
+		EXPECT_EQ(z, 6.0f);
+		if (pts1.hasColorPoints() && !pts1.getPointsBufferRef_intensity())
+		{
+			pts1.getPointRGB(0, x, y, z, R, G, B);
+			EXPECT_NEAR(R, 1.0f, 1e-6);
+			EXPECT_NEAR(G, 0.0f, 1e-6);
+		}
+	}
+	// Errors:
+	{
+		MAP pts1;
+		std::string errMsg;
+		EXPECT_FALSE(pts1.loadPCDFile(fil + ".nonexistent", errMsg));
+		EXPECT_FALSE(errMsg.empty());
+	}
+	// Corrupted headers, with sizes that overflow or exceed the data:
+	for (const std::string data :
+		 {"COUNT 1 1 1\nPOINTS 4611686018427387904\nDATA binary\n",
+		  "COUNT 1 1 4611686018427387904\nPOINTS 4\nDATA binary\n",
+		  "COUNT 1 1 1\nPOINTS 1000000000000\nDATA ascii\n1 2 3\n",
+		  "COUNT 1 1 1\nPOINTS 4611686018427387904\nDATA "
+		  "binary_compressed\n"})
+	{
+		std::ofstream f(fil);
+		f << "VERSION 0.7\nFIELDS x y z\nSIZE 4 4 4\nTYPE F F F\n" << data
+		  << std::string(64, '\0');
+		f.close();
+		MAP pts1;
+		std::string errMsg;
+		EXPECT_FALSE(pts1.loadPCDFile(fil, errMsg)) << data;
+		EXPECT_FALSE(errMsg.empty());
+		EXPECT_EQ(pts1.size(), 0U);
+	}
+	{
+		std::ofstream f(fil);
+		f << "ply\nformat binary_little_endian 1.0\n"
+			 "element face 4611686018427387904\nproperty int a\n"
+			 "property int b\nproperty int c\nproperty int d\n"
+			 "element vertex 1\nproperty float x\nproperty float y\n"
+			 "property float z\nend_header\n"
+		  << std::string(12, '\0');
+		f.close();
+		MAP pts1;
+		std::string errMsg;
+		EXPECT_FALSE(pts1.loadPLYFile(fil, errMsg));
+		EXPECT_FALSE(errMsg.empty());
+	}
+	mrpt::system::deleteFile(fil);
+}
+
 TEST(CSimplePointsMapTests, insertPoints)
 {
 	do_test_insertPoints<CSimplePointsMap>();
@@ -264,3 +399,18 @@ TEST(CColouredPointsMapTests, loadSaveStreams)
 {
 	do_tests_loadSaveStreams<CColouredPointsMap>();
 }
+
+TEST(CSimplePointsMapTests, loadSavePCDandPLY)
+{
+	do_tests_loadSavePCDandPLY<CSimplePointsMap>();
+}
+
+TEST(CColouredPointsMapTests, loadSavePCDandPLY)
+{
+	do_tests_loadSavePCDandPLY<CColouredPointsMap>();
+}
+
+TEST(CPointsMapXYZI, loadSavePCDandPLY)
+{
+	do_tests_loadSavePCDandPLY<CPointsMapXYZI>();
+}
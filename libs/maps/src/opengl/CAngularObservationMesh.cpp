@@ -9,6 +9,7 @@
 
 #include "maps-precomp.h"  // Precomp header
 //
+#include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/opengl/CAngularObservationMesh.h>
 #include <mrpt/poses/CPoint3D.h>
 #include <mrpt/serialization/CArchive.h>
@@ -91,8 +92,11 @@ void CAngularObservationMesh::updateMesh() const
 		for (size_t i = 0; i < numRows; i++)
 			pitchs[i] = pitchBounds[i];
 	const bool rToL = scanSet[0].rightToLeft;
-	for (size_t i = 0; i < numRows; i++)
-	{
+
+	auto& pool = mrpt::WorkerThreadsPool::Default();
+
+	// Each scan is converted into a row of points in parallel:
+	pool.parallel_for(0, numRows, [&](size_t i) {
 		const auto& ss_i = scanSet[i];
 		const double pitchIncr = scanSet[i].deltaPitch;
 		const double aperture = scanSet[i].aperture;
@@ -112,50 +116,74 @@ void CAngularObservationMesh::updateMesh() const
 					 CPoint3D(ss_i.getScanRange(j), 0, 0))
 						.asTPoint();
 			}
-	}
-
-	triangles.reserve(2 * (numRows - 1) * (numCols - 1));
-	for (size_t k = 0; k < numRows - 1; k++)
-	{
-		for (size_t j = 0; j < numCols - 1; j++)
+	});
+
+	// Triangles of the cell (k,j), with k the scan index. If `out` is null,
+	// they are only counted.
+	const auto cellTriangles = [&](size_t k, size_t j,
+								   mrpt::opengl::TTriangle* out) -> int {
+		const auto add = [&](const TPoint3D& p1, const TPoint3D& p2,
+							 const TPoint3D& p3) {
+			if (!out) return;
+			out->vertices[0].xyzrgba.pt = p1;
+			out->vertices[1].xyzrgba.pt = p2;
+			out->vertices[2].xyzrgba.pt = p3;
+			out->computeNormals();
+			out->setColor(m_color);
+			out++;
+		};
+		int b1 = validityMatrix(k, j) ? 1 : 0;
+		int b2 = validityMatrix(k, j + 1) ? 1 : 0;
+		int b3 = validityMatrix(k + 1, j) ? 1 : 0;
+		int b4 = validityMatrix(k + 1, j + 1) ? 1 : 0;
+		switch (b1 + b2 + b3 + b4)
 		{
-			int b1 = validityMatrix(k, j) ? 1 : 0;
-			int b2 = validityMatrix(k, j + 1) ? 1 : 0;
-			int b3 = validityMatrix(k + 1, j) ? 1 : 0;
-			int b4 = validityMatrix(k + 1, j + 1) ? 1 : 0;
-			switch (b1 + b2 + b3 + b4)
-			{
-				case 0:
-				case 1:
-				case 2: break;
-				case 3:
-					if (!b1)
-						addTriangle(
-							actualMesh(k, j + 1), actualMesh(k + 1, j),
-							actualMesh(k + 1, j + 1));
-					else if (!b2)
-						addTriangle(
-							actualMesh(k, j), actualMesh(k + 1, j),
-							actualMesh(k + 1, j + 1));
-					else if (!b3)
-						addTriangle(
-							actualMesh(k, j), actualMesh(k, j + 1),
-							actualMesh(k + 1, j + 1));
-					else if (!b4)
-						addTriangle(
-							actualMesh(k, j), actualMesh(k, j + 1),
-							actualMesh(k + 1, j));
-					break;
-				case 4:
-					addTriangle(
-						actualMesh(k, j), actualMesh(k, j + 1),
-						actualMesh(k + 1, j));
-					addTriangle(
-						actualMesh(k + 1, j + 1), actualMesh(k, j + 1),
+			case 0:
+			case 1:
+			case 2: return 0;
+			case 3:
+				if (!b1)
+					add(actualMesh(k, j + 1), actualMesh(k + 1, j),
+						actualMesh(k + 1, j + 1));
+				else if (!b2)
+					add(actualMesh(k, j), actualMesh(k + 1, j),
+						actualMesh(k + 1, j + 1));
+				else if (!b3)
+					add(actualMesh(k, j), actualMesh(k, j + 1),
+						actualMesh(k + 1, j + 1));
+				else if (!b4)
+					add(actualMesh(k, j), actualMesh(k, j + 1),
 						actualMesh(k + 1, j));
-			}
+				return 1;
+			case 4:
+				add(actualMesh(k, j), actualMesh(k, j + 1),
+					actualMesh(k + 1, j));
+				add(actualMesh(k + 1, j + 1), actualMesh(k, j + 1),
+					actualMesh(k + 1, j));
+				return 2;
 		}
-	}
+		return 0;
+	};
+
+	// Count the triangles of each row of cells, then fill them in parallel
+	// into their final place, in the same order than a sequential loop:
+	std::vector<size_t> rowStart(numRows, 0);
+	pool.parallel_for(0, numRows - 1, [&](size_t k) {
+		size_t n = 0;
+		for (size_t j = 0; j < numCols - 1; j++)
+			n += cellTriangles(k, j, nullptr);
+		rowStart[k + 1] = n;
+	});
+	for (size_t k = 1; k < numRows; k++)
+		rowStart[k] += rowStart[k - 1];
+
+	triangles.resize(rowStart.back());
+	pool.parallel_for(0, numRows - 1, [&](size_t k) {
+		mrpt::opengl::TTriangle* out = triangles.data() + rowStart[k];
+		for (size_t j = 0; j < numCols - 1; j++)
+			out += cellTriangles(k, j, out);
+	});
+
 	meshUpToDate = true;
 }
 
@@ -173,10 +201,18 @@ void CAngularObservationMesh::render(const RenderContext& rc) const
 }
 void CAngularObservationMesh::renderUpdateBuffers() const
 {
+	if (!meshUpToDate) updateMesh();
+
 	CRenderizableShaderTriangles::renderUpdateBuffers();
 	CRenderizableShaderWireFrame::renderUpdateBuffers();
 }
 
+void CAngularObservationMesh::onUpdateCPUBuffers()
+{
+	if (!meshUpToDate) updateMesh();
+	CRenderizable::onUpdateCPUBuffers();
+}
+
 void CAngularObservationMesh::onUpdateBuffers_Wireframe()
 {
 	auto& vbd = CRenderizableShaderWireFrame::m_vertex_buffer_data;
@@ -200,14 +236,17 @@ void CAngularObservationMesh::onUpdateBuffers_Triangles()
 {
 	auto& tris = CRenderizableShaderTriangles::m_triangles;
 
-	tris = this->triangles;
-
-	// All faces, all vertices, same color:
-	for (auto& t : tris)
-	{
-		t.setColor(m_color);
-		t.computeNormals();
-	}
+	tris.resize(triangles.size());
+
+	// All faces, all vertices, same color. Normals were already computed in
+	// updateMesh().
+	mrpt::WorkerThreadsPool::Default().parallel_for(
+		0, triangles.size(),
+		[&](size_t i) {
+			tris[i] = triangles[i];
+			tris[i].setColor(m_color);
+		},
+		4096);
 }
 
 bool CAngularObservationMesh::traceRay(
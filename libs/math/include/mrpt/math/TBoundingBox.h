@@ -123,40 +123,59 @@ struct TBoundingBox_
 			p.y <= max.y && p.z <= max.z;
 	}
 
+	/** Returns the i-th corner of the box, for i in [0,7]: bits 0,1,2 of i
+	 * select the max (bit set) or min (bit clear) coordinate in x,y,z.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	mrpt::math::TPoint3D_<T> corner(unsigned int i) const
+	{
+		return {
+			(i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y,
+			(i & 4) ? max.z : min.z};
+	}
+
 	/** Returns a new bounding box, transforming `this` from local coordinates
-	 * to global coordinates, as if `this` was given with respect to `pose`, ie:
+	 * to global coordinates, as if `this` was given with respect to `pose`.
 	 *
-	 * \code
-	 *  return.min = pose \oplus this->min
-	 *  return.max = pose \oplus this->max
-	 * \endcode
-	 * \tparam POSE_T Can be mrpt::poses::CPose3D, or mrpt::math::TPose3D
+	 * The result is the smallest axis-aligned box containing the 8
+	 * transformed corners of `this`, so it is a conservative (larger)
+	 * approximation of the rotated box if `pose` has a rotation.
+	 * Boxes with `max<min` (e.g. PlusMinusInfinity()) are returned unchanged.
 	 *
-	 * \note If a rotation exists, the output bounding box will no longer be an
-	 * accurate representation of the actual 3D box.
+	 * \tparam POSE_T Can be mrpt::poses::CPose3D, or mrpt::math::TPose3D
 	 */
 	template <typename POSE_T>
 	TBoundingBox_<T> compose(const POSE_T& pose) const
 	{
-		return {pose.composePoint(min), pose.composePoint(max)};
+		if (!isValid()) return *this;
+		auto bb = PlusMinusInfinity();
+		for (unsigned int i = 0; i < 8; i++)
+			bb.updateWithPoint(pose.composePoint(corner(i)));
+		return bb;
 	}
 
 	/** Returns a new bounding box, transforming `this` from global coordinates
-	 * to local coordinates with respect to `pose`, ie:
+	 * to local coordinates with respect to `pose`, as the smallest
+	 * axis-aligned box containing the 8 corners of `this` as seen from
+	 * `pose`. See compose().
 	 *
-	 * \code
-	 *  return.min = this->min \ominus pose
-	 *  return.max = this->max \ominus pose
-	 * \endcode
 	 * \tparam POSE_T Can be mrpt::poses::CPose3D, or mrpt::math::TPose3D
-	 *
-	 * \note If a rotation exists, the output bounding box will no longer be an
-	 * accurate representation of the actual 3D box.
 	 */
 	template <typename POSE_T>
 	TBoundingBox_<T> inverseCompose(const POSE_T& pose) const
 	{
-		return {pose.inverseComposePoint(min), pose.inverseComposePoint(max)};
+		if (!isValid()) return *this;
+		auto bb = PlusMinusInfinity();
+		for (unsigned int i = 0; i < 8; i++)
+			bb.updateWithPoint(pose.inverseComposePoint(corner(i)));
+		return bb;
+	}
+
+	/** Returns false if `max<min` in any coordinate, e.g. for
+	 * PlusMinusInfinity() \note (New in MRPT 2.4.2) */
+	bool isValid() const
+	{
+		return max.x >= min.x && max.y >= min.y && max.z >= min.z;
 	}
 
 	/** Print bounding box as a string with format
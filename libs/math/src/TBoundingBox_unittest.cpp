@@ -8,6 +8,7 @@
    +------------------------------------------------------------------------+ */
 
 #include <gtest/gtest.h>
+#include <mrpt/core/bits_math.h>
 #include <mrpt/math/TBoundingBox.h>
 #include <mrpt/math/TPose3D.h>
 
@@ -125,6 +126,33 @@ TEST(TBoundingBox, compose)
 	EXPECT_EQ(bb2.max, mrpt::math::TPoint3D(13, 24, 35));
 }
 
+TEST(TBoundingBox, composeRotated)
+{
+	// 90 deg yaw: the box must contain all the rotated corners.
+	mrpt::math::TBoundingBox bb1({0, 1, 2}, {3, 4, 5});
+	const mrpt::math::TPose3D p(10, 20, 30, mrpt::DEG2RAD(90.0), 0, 0);
+	const auto bb2 = bb1.compose(p);
+
+	EXPECT_NEAR(bb2.min.x, 6, 1e-9);
+	EXPECT_NEAR(bb2.min.y, 20, 1e-9);
+	EXPECT_NEAR(bb2.min.z, 32, 1e-9);
+	EXPECT_NEAR(bb2.max.x, 9, 1e-9);
+	EXPECT_NEAR(bb2.max.y, 23, 1e-9);
+	EXPECT_NEAR(bb2.max.z, 35, 1e-9);
+
+	const auto bb3 = bb2.inverseCompose(p);
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		EXPECT_NEAR(bb3.corner(i).x, bb1.corner(i).x, 1e-9);
+		EXPECT_NEAR(bb3.corner(i).y, bb1.corner(i).y, 1e-9);
+		EXPECT_NEAR(bb3.corner(i).z, bb1.corner(i).z, 1e-9);
+	}
+
+	// Empty boxes remain empty:
+	const auto e = mrpt::math::TBoundingBox::PlusMinusInfinity();
+	EXPECT_FALSE(e.compose(p).isValid());
+}
+
 TEST(TBoundingBox, inverseCompose)
 {
 	mrpt::math::TBoundingBox bb1({0, 1, 2}, {3, 4, 5});
@@ -94,6 +94,20 @@ class CPTG_Holo_Blend : public CPTG_RobotShape_Circular
 	/** Evals expr_T_ramp */
 	double internal_get_T_ramp(const double dir) const;
 
+	/** internal_get_v(), internal_get_w() and internal_get_T_ramp() for each
+	 * path index, evaluated at once in internal_initialize() */
+	std::vector<double> m_pathV, m_pathW, m_pathTramp;
+
+	/** Like internal_get_v() for `dir=index2alpha(k)`, but cached */
+	double internal_path_v(uint16_t k) const;
+	/** Like internal_get_w() for `dir=index2alpha(k)`, but cached */
+	double internal_path_w(uint16_t k) const;
+	/** Like internal_get_T_ramp() for `dir=index2alpha(k)`, but cached */
+	double internal_path_T_ramp(uint16_t k) const;
+	/** Clears all the per-path cached values. Must be called whenever the
+	 * PTG parameters change. */
+	void internal_clear_path_cache();
+
 	void internal_construct_exprs();
 
 	void internal_processNewRobotShape() override;
@@ -86,36 +86,56 @@ int CMultiObjMotionOpt_Scalarization::impl_decide(
 		}
 	}
 
-	// Evaluate the formula for all candidates:
+	// Evaluate the formula for all eligible candidates at once, with one
+	// column of values per variable. Scores missing in a candidate keep the
+	// value of the previous one, as when evaluating them one by one:
 	const size_t N = extra_info.score_values.size();
 	final_evaluation.assign(N, .0);
-	int best_idx = -1;
-	double best_val = .0;
+
+	std::vector<size_t> eligible;
+	eligible.reserve(N);
 	for (size_t i = 0; i < N; i++)
+		if (!extra_info.score_values[i].empty()) eligible.push_back(i);
+	const size_t M = eligible.size();
+
+	std::map<std::string, std::vector<double>> columns;
+	for (const auto& v : m_expr_scalar_vars)
+		columns[v.first].resize(M);
+
+	for (size_t j = 0; j < M; j++)
 	{
-		if (extra_info.score_values[i].empty())
-			continue;  // this candidate is non-eligible.
+		for (auto& c : columns)
+			c.second[j] = j > 0 ? c.second[j - 1] : m_expr_scalar_vars[c.first];
 
-		// Update variables & evaluate formula:
-		for (const auto& score : extra_info.score_values[i])
+		for (const auto& score : extra_info.score_values[eligible[j]])
 		{
-			const auto& it = m_expr_scalar_vars.find(
-				score.first);  // this should never *create* a new entry...
-			if (it == m_expr_scalar_vars.cend())
+			const auto it = columns.find(score.first);
+			if (it == columns.end())
 			{
 				THROW_EXCEPTION_FMT(
 					"Error: found unexpected (unregistered) score named `%s`.",
 					score.first.c_str());
 			}
-			double& var = it->second;
-			var = score.second;
+			it->second[j] = score.second;
 		}
-		const double val = m_expr_scalar_formula.eval();
-		extra_info.final_evaluation[i] = val;
+	}
+
+	std::vector<std::pair<std::string, const double*>> inputs;
+	for (const auto& c : columns)
+		inputs.emplace_back(c.first, c.second.data());
+	std::vector<double> vals(M);
+	m_expr_scalar_formula.eval_batch(inputs, M, vals.data());
+
+	int best_idx = -1;
+	double best_val = .0;
+	for (size_t j = 0; j < M; j++)
+	{
+		const double val = vals[j];
+		final_evaluation[eligible[j]] = val;
 
 		if (val > 0 && (best_idx == -1 || val > best_val))
 		{
-			best_idx = i;
+			best_idx = eligible[j];
 			best_val = val;
 		}
 	}
@@ -55,9 +55,9 @@ double CPTG_Holo_Blend::eps = 1e-4;	 // epsilon for detecting 1/0 situation
 #define COMMON_PTG_DESIGN_PARAMS                                               \
 	const double vxi = m_nav_dyn_state.curVelLocal.vx,                         \
 				 vyi = m_nav_dyn_state.curVelLocal.vy;                         \
-	const double vf_mod = internal_get_v(dir);                                 \
+	const double vf_mod = internal_path_v(k);                                  \
 	const double vxf = vf_mod * cos(dir), vyf = vf_mod * sin(dir);             \
-	const double T_ramp = internal_get_T_ramp(dir);
+	const double T_ramp = internal_path_T_ramp(k);
 
 #if 0
 static double calc_trans_distance_t_below_Tramp_abc_analytic(double t, double a, double b, double c)
@@ -195,6 +195,7 @@ void CPTG_Holo_Blend::loadDefaultParams()
 	T_ramp_max = 0.9;
 	V_MAX = 1.0;
 	W_MAX = mrpt::DEG2RAD(40);
+	internal_clear_path_cache();
 }
 
 void CPTG_Holo_Blend::loadFromConfigFile(
@@ -214,6 +215,9 @@ void CPTG_Holo_Blend::loadFromConfigFile(
 	MRPT_LOAD_HERE_CONFIG_VAR(expr_V, string, expr_V, cfg, sSection);
 	MRPT_LOAD_HERE_CONFIG_VAR(expr_W, string, expr_W, cfg, sSection);
 	MRPT_LOAD_HERE_CONFIG_VAR(expr_T_ramp, string, expr_T_ramp, cfg, sSection);
+
+	// Cached for the former V_MAX, W_MAX...; recomputed upon initialize():
+	internal_clear_path_cache();
 }
 void CPTG_Holo_Blend::saveToConfigFile(
 	mrpt::config::CConfigFileBase& cfg, const std::string& sSection) const
@@ -288,6 +292,8 @@ void CPTG_Holo_Blend::serializeFrom(
 			break;
 		default: MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version);
 	};
+	// Computed for the former parameters:
+	internal_clear_path_cache();
 }
 
 uint8_t CPTG_Holo_Blend::serializeGetVersion() const { return 4; }
@@ -406,9 +412,14 @@ bool CPTG_Holo_Blend::PTG_IsIntoDomain(double x, double y) const
 	return inverseMap_WS2TP(x, y, k, d);
 }
 
-void CPTG_Holo_Blend::internal_deinitialize()
+void CPTG_Holo_Blend::internal_deinitialize() { internal_clear_path_cache(); }
+
+void CPTG_Holo_Blend::internal_clear_path_cache()
 {
-	// Nothing to do in a closed-form PTG.
+	m_pathV.clear();
+	m_pathW.clear();
+	m_pathTramp.clear();
+	m_pathStepCountCache.clear();
 }
 
 mrpt::kinematics::CVehicleVelCmd::Ptr CPTG_Holo_Blend::directionToMotionCommand(
@@ -417,10 +428,10 @@ mrpt::kinematics::CVehicleVelCmd::Ptr CPTG_Holo_Blend::directionToMotionCommand(
 	const double dir_local = CParameterizedTrajectoryGenerator::index2alpha(k);
 
 	auto* cmd = new mrpt::kinematics::CVehicleVelCmd_Holo();
-	cmd->vel = internal_get_v(dir_local);
+	cmd->vel = internal_path_v(k);
 	cmd->dir_local = dir_local;
-	cmd->ramp_time = internal_get_T_ramp(dir_local);
-	cmd->rot_speed = mrpt::signWithZero(dir_local) * internal_get_w(dir_local);
+	cmd->ramp_time = internal_path_T_ramp(k);
+	cmd->rot_speed = mrpt::signWithZero(dir_local) * internal_path_w(k);
 
 	return mrpt::kinematics::CVehicleVelCmd::Ptr(cmd);
 }
@@ -450,7 +461,7 @@ mrpt::math::TPose2D CPTG_Holo_Blend::getPathPose(
 	const double t = PATH_TIME_STEP * step;
 	const double dir = CParameterizedTrajectoryGenerator::index2alpha(k);
 	COMMON_PTG_DESIGN_PARAMS;
-	const double wf = mrpt::signWithZero(dir) * this->internal_get_w(dir);
+	const double wf = mrpt::signWithZero(dir) * this->internal_path_w(k);
 	const double TR2_ = 1.0 / (2 * T_ramp);
 
 	mrpt::math::TPose2D p;
@@ -819,6 +830,25 @@ double CPTG_Holo_Blend::internal_get_T_ramp(const double dir) const
 	return m_expr_T_ramp.eval();
 }
 
+double CPTG_Holo_Blend::internal_path_v(uint16_t k) const
+{
+	return m_pathV.size() == m_alphaValuesCount
+		? m_pathV[k]
+		: internal_get_v(index2alpha(k));
+}
+double CPTG_Holo_Blend::internal_path_w(uint16_t k) const
+{
+	return m_pathW.size() == m_alphaValuesCount
+		? m_pathW[k]
+		: internal_get_w(index2alpha(k));
+}
+double CPTG_Holo_Blend::internal_path_T_ramp(uint16_t k) const
+{
+	return m_pathTramp.size() == m_alphaValuesCount
+		? m_pathTramp[k]
+		: internal_get_T_ramp(index2alpha(k));
+}
+
 void CPTG_Holo_Blend::internal_initialize(
 	const std::string& cacheFilename, const bool verbose)
 {
@@ -835,6 +865,26 @@ void CPTG_Holo_Blend::internal_initialize(
 	m_expr_T_ramp.compile(
 		expr_T_ramp, std::map<std::string, double>(), "expr_T_ramp");
 
+	// Evaluate them for all paths at once:
+	const size_t N = m_alphaValuesCount;
+	std::vector<double> dirs(N);
+	for (uint16_t k = 0; k < N; k++)
+		dirs[k] = index2alpha(k);
+	const std::vector<std::pair<std::string, const double*>> in = {
+		{"dir", dirs.data()}};
+
+	m_pathV.resize(N);
+	m_pathW.resize(N);
+	m_pathTramp.resize(N);
+	m_expr_v.eval_batch(in, N, m_pathV.data());
+	m_expr_w.eval_batch(in, N, m_pathW.data());
+	m_expr_T_ramp.eval_batch(in, N, m_pathTramp.data());
+	for (size_t k = 0; k < N; k++)
+	{
+		m_pathV[k] = std::abs(m_pathV[k]);
+		m_pathW[k] = std::abs(m_pathW[k]);
+	}
+
 #ifdef DO_PERFORMANCE_BENCHMARK
 	tl.dumpAllStats();
 #endif
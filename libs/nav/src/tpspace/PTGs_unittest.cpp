@@ -9,7 +9,12 @@
 
 #include <gtest/gtest.h>
 #include <mrpt/config/CConfigFile.h>
+#include <mrpt/config/CConfigFileMemory.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/kinematics/CVehicleVelCmd_Holo.h>
+#include <mrpt/nav/tpspace/CPTG_Holo_Blend.h>
 #include <mrpt/nav/tpspace/CParameterizedTrajectoryGenerator.h>
+#include <mrpt/serialization/CArchive.h>
 #include <mrpt/system/filesystem.h>
 #include <test_mrpt_common.h>
 
@@ -186,3 +191,36 @@ TEST(NavTests, PTGs_tests)
 
 	}  // for each ptg
 }
+
+TEST(NavTests, PTG_Holo_Blend_serializeFrom)
+{
+	using namespace mrpt::nav;
+
+	const auto loadParams = [](CPTG_Holo_Blend& ptg, double vMax) {
+		mrpt::config::CConfigFileMemory cfg;
+		cfg.setContent(mrpt::format(
+			"[PTG]\nnum_paths=31\nrefDistance=5.0\nT_ramp_max=0.8\n"
+			"v_max_mps=%f\nw_max_dps=60\nrobot_radius=0.35\n",
+			vMax));
+		ptg.loadFromConfigFile(cfg, "PTG");
+	};
+
+	CPTG_Holo_Blend ptg, ptg2;
+	loadParams(ptg, 1.0);
+	loadParams(ptg2, 2.0);
+	ptg.initialize(std::string(), false /*verbose*/);
+
+	// Overwrite the initialized PTG with different parameters:
+	mrpt::io::CMemoryStream buf;
+	auto arch = mrpt::serialization::archiveFrom(buf);
+	arch << ptg2;
+	buf.Seek(0);
+	arch.ReadObject(&ptg);
+
+	ptg.initialize(std::string(), false /*verbose*/);
+	const auto cmd =
+		std::dynamic_pointer_cast<mrpt::kinematics::CVehicleVelCmd_Holo>(
+			ptg.directionToMotionCommand(15));
+	ASSERT_TRUE(cmd);
+	EXPECT_NEAR(cmd->vel, 2.0, 1e-9);
+}
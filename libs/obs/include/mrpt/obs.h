@@ -27,6 +27,7 @@ MRPT_WARNING(
 #include <mrpt/obs/CObservationBeaconRanges.h>
 #include <mrpt/obs/CObservationBearingRange.h>
 #include <mrpt/obs/CObservationCANBusJ1939.h>
+#include <mrpt/obs/CObservationCANBusJ1939Batch.h>
 #include <mrpt/obs/CObservationComment.h>
 #include <mrpt/obs/CObservationGPS.h>
 #include <mrpt/obs/CObservationGasSensors.h>
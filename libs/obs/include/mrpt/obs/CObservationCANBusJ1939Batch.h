@@ -0,0 +1,124 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/obs/CObservation.h>
+#include <mrpt/obs/CObservationCANBusJ1939.h>
+#include <mrpt/serialization/CSerializable.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace mrpt::obs
+{
+/** A batch of frames received from a CAN BUS, stored in contiguous arrays
+ * (one entry per frame) instead of one CObservationCANBusJ1939 object per
+ * frame, to reduce memory allocations and rawlog size at high frame rates.
+ *
+ * Frame `i` is described by `frameIds[i]`, `frameTimestamps[i]`,
+ * `frameDataLengths[i]` and the first `frameDataLengths[i]` bytes of
+ * `frameData` starting at `i * MAX_DATA_LENGTH`. Use push_back() to append
+ * frames keeping all arrays consistent.
+ *
+ * The observation `timestamp` is that of the first frame in the batch.
+ *
+ * Identifiers of extended (29-bit) frames have the EXTENDED_ID_FLAG bit set,
+ * as in Linux SocketCAN. The J1939 fields of a frame (PGN, priority, source
+ * address) can be retrieved with pgn(), priority() and srcAddress().
+ *
+ * \sa CObservationCANBusJ1939, mrpt::hwdrivers::CCANBusReader
+ * \ingroup mrpt_obs_grp
+ */
+class CObservationCANBusJ1939Batch : public CObservation
+{
+	DEFINE_SERIALIZABLE(CObservationCANBusJ1939Batch, mrpt::obs)
+
+   public:
+	/** Maximum payload length of a (classic) CAN frame */
+	static constexpr size_t MAX_DATA_LENGTH = 8;
+
+	/** Bit set in frameIds for extended (29-bit) identifiers */
+	static constexpr uint32_t EXTENDED_ID_FLAG = 0x80000000;
+
+	CObservationCANBusJ1939Batch() = default;
+	~CObservationCANBusJ1939Batch() override = default;
+
+	/** @name Frame data
+	 * @{ */
+
+	/** Frame identifiers, including the EXTENDED_ID_FLAG bit, if set. */
+	std::vector<uint32_t> frameIds;
+
+	/** Reception time of each frame. */
+	std::vector<mrpt::Clock::time_point> frameTimestamps;
+
+	/** Number of payload bytes of each frame (0-8) */
+	std::vector<uint8_t> frameDataLengths;
+
+	/** Payloads, MAX_DATA_LENGTH bytes per frame (unused bytes are 0) */
+	std::vector<uint8_t> frameData;
+
+	/** @} */
+
+	/** Number of frames in the batch */
+	size_t size() const { return frameIds.size(); }
+	bool empty() const { return frameIds.empty(); }
+
+	/** Removes all frames, keeping the reserved memory */
+	void clear();
+
+	/** Reserves memory for `n` frames */
+	void reserve(size_t n);
+
+	/** Appends a frame.
+	 * \param dataLength Number of bytes in `data` (0-8)
+	 * \exception std::exception If dataLength>MAX_DATA_LENGTH
+	 */
+	void push_back(
+		uint32_t id, mrpt::Clock::time_point t, uint8_t dataLength,
+		const uint8_t* data);
+
+	/** Pointer to the payload of the i-th frame (frameDataLengths[i] bytes) */
+	const uint8_t* data(size_t i) const
+	{
+		return &frameData[i * MAX_DATA_LENGTH];
+	}
+
+	/** The frame identifier, without the EXTENDED_ID_FLAG bit */
+	uint32_t id(size_t i) const { return frameIds[i] & ~EXTENDED_ID_FLAG; }
+
+	bool isExtendedId(size_t i) const
+	{
+		return (frameIds[i] & EXTENDED_ID_FLAG) != 0;
+	}
+
+	/** @name J1939 fields, decoded from the frame identifier
+	 * @{ */
+	uint8_t priority(size_t i) const { return (id(i) >> 26) & 0x07; }
+	uint8_t pduFormat(size_t i) const { return (id(i) >> 16) & 0xFF; }
+	uint8_t pduSpecific(size_t i) const { return (id(i) >> 8) & 0xFF; }
+	/** The Parameter Group Number, computed as in CObservationCANBusJ1939 */
+	uint16_t pgn(size_t i) const { return (id(i) >> 8) & 0xFFFF; }
+	uint8_t srcAddress(size_t i) const { return id(i) & 0xFF; }
+	/** @} */
+
+	/** Fills in a single-frame observation with the i-th frame of this batch.
+	 * The raw ASCII frame field is left empty. */
+	void getFrame(size_t i, CObservationCANBusJ1939& out) const;
+
+	/** Not used */
+	void getSensorPose(mrpt::poses::CPose3D&) const override {}
+	void setSensorPose(const mrpt::poses::CPose3D&) override {}
+	// See base class docs
+	void getDescriptionAsText(std::ostream& o) const override;
+
+};	// End of class def.
+
+}  // namespace mrpt::obs
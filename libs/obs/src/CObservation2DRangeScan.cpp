@@ -13,9 +13,13 @@
 #include <mrpt/math/CMatrixF.h>
 #include <mrpt/math/wrap2pi.h>
 #include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/obs/CSinCosLookUpTableFor2DScans.h>
 #include <mrpt/poses/CPosePDF.h>
 #include <mrpt/serialization/CArchive.h>
 
+#include <cmath>
+#include <limits>
+
 #if MRPT_HAS_MATLAB
 #include <mexplus.h>
 #endif
@@ -252,61 +256,107 @@ void CObservation2DRangeScan::setScanHasIntensity(bool setHasIntensityFlag)
 /*---------------------------------------------------------------
 						filterByExclusionAreas
  ---------------------------------------------------------------*/
-void CObservation2DRangeScan::filterByExclusionAreas(
-	const TListExclusionAreasWithRanges& areas)
+namespace
 {
-	if (areas.empty()) return;
-
-	MRPT_START
-
-	float Ang, dA;
-	const size_t sizeRangeScan = m_scan.size();
-
-	ASSERT_EQUAL_(m_scan.size(), m_validRange.size());
-
-	if (!sizeRangeScan) return;
+/** The 2D bounding box of one exclusion area, used as a quick rejection test
+ * before the (much more expensive) point-in-polygon test. */
+struct TAreaBBox
+{
+	double x_min, x_max, y_min, y_max, z_min, z_max;
+	const mrpt::math::CPolygon* poly;
+};
 
-	if (rightToLeft)
-	{
-		Ang = -0.5f * aperture;
-		dA = aperture / (sizeRangeScan - 1);
-	}
+// Marks as invalid, in-place, all ranges within any of the given areas.
+void filterByAreaBBoxes(
+	CObservation2DRangeScan& scan, const std::vector<TAreaBBox>& boxes)
+{
+	const size_t N = scan.getScanSize();
+	if (!N || boxes.empty()) return;
+
+	// Cached cos/sin tables, shared with all other scans with the same
+	// geometry. One cache per thread, since the returned reference is
+	// invalidated if another thread makes the cache drop old entries:
+	thread_local const CSinCosLookUpTableFor2DScans sincos_lut;
+	CSinCosLookUpTableFor2DScans::TSinCosValues single_ray;
+	const CSinCosLookUpTableFor2DScans::TSinCosValues* sc = &single_ray;
+	if (N >= 2)
+		sc = &sincos_lut.getSinCosForScan(scan);
 	else
 	{
-		Ang = +0.5f * aperture;
-		dA = -aperture / (sizeRangeScan - 1);
+		// Degenerate 1-ray scan: not supported by the LUT.
+		const float a = (scan.rightToLeft ? -0.5f : 0.5f) * scan.aperture;
+		single_ray.ccos.resize(1);
+		single_ray.csin.resize(1);
+		single_ray.ccos[0] = std::cos(a);
+		single_ray.csin[0] = std::sin(a);
 	}
 
-	auto valid_it = m_validRange.begin();
-	for (auto scan_it = m_scan.begin(); scan_it != m_scan.end();
-		 scan_it++, valid_it++)
+	for (size_t i = 0; i < N; i++)
 	{
-		if (!*valid_it)
-		{
-			Ang += dA;
-			continue;  // Already it's invalid
-		}
+		if (!scan.getScanRangeValidity(i)) continue;  // Already invalid
 
 		// Compute point in 2D, local to the laser center:
-		const auto Lx = *scan_it * cos(Ang);
-		const auto Ly = *scan_it * sin(Ang);
-		Ang += dA;
+		const float r = scan.getScanRange(i);
+		const double Lx = r * sc->ccos[i];
+		const double Ly = r * sc->csin[i];
 
 		// To real 3D pose:
 		double Gx, Gy, Gz;
-		this->sensorPose.composePoint(Lx, Ly, 0, Gx, Gy, Gz);
+		scan.sensorPose.composePoint(Lx, Ly, 0, Gx, Gy, Gz);
 
-		// Filter by X,Y:
-		for (const auto& area : areas)
+		for (const auto& b : boxes)
 		{
-			if (area.first.PointIntoPolygon(Gx, Gy) &&
-				(Gz >= area.second.first && Gz <= area.second.second))
+			if (Gx < b.x_min || Gx > b.x_max || Gy < b.y_min ||
+				Gy > b.y_max || Gz < b.z_min || Gz > b.z_max)
+				continue;
+			if (b.poly->PointIntoPolygon(Gx, Gy))
 			{
-				*valid_it = false;
+				scan.setScanRangeValidity(i, false);
 				break;	// Go for next point
 			}
 		}  // for each area
 	}  // for each point
+}
+
+TAreaBBox areaBBox(const mrpt::math::CPolygon& poly, double zMin, double zMax)
+{
+	TAreaBBox b;
+	b.poly = &poly;
+	b.z_min = zMin;
+	b.z_max = zMax;
+	if (poly.empty())
+	{
+		// Empty polygon: never matches
+		b.x_min = b.y_min = std::numeric_limits<double>::max();
+		b.x_max = b.y_max = -std::numeric_limits<double>::max();
+		return b;
+	}
+	mrpt::math::TPoint2D pMin, pMax;
+	poly.getBoundingBox(pMin, pMax);
+	b.x_min = pMin.x;
+	b.y_min = pMin.y;
+	b.x_max = pMax.x;
+	b.y_max = pMax.y;
+	return b;
+}
+}  // namespace
+
+void CObservation2DRangeScan::filterByExclusionAreas(
+	const TListExclusionAreasWithRanges& areas)
+{
+	if (areas.empty()) return;
+
+	MRPT_START
+
+	ASSERT_EQUAL_(m_scan.size(), m_validRange.size());
+
+	std::vector<TAreaBBox> boxes;
+	boxes.reserve(areas.size());
+	for (const auto& area : areas)
+		boxes.push_back(
+			areaBBox(area.first, area.second.first, area.second.second));
+
+	filterByAreaBBoxes(*this, boxes);
 
 	MRPT_END
 }
@@ -332,17 +382,20 @@ void CObservation2DRangeScan::filterByExclusionAreas(
 {
 	if (areas.empty()) return;
 
-	TListExclusionAreasWithRanges lst;
+	MRPT_START
+
+	ASSERT_EQUAL_(m_scan.size(), m_validRange.size());
+
+	std::vector<TAreaBBox> boxes;
+	boxes.reserve(areas.size());
 	for (const auto& area : areas)
-	{
-		TListExclusionAreasWithRanges::value_type dat;
-		dat.first = area;
-		dat.second.first = -std::numeric_limits<double>::max();
-		dat.second.second = std::numeric_limits<double>::max();
+		boxes.push_back(areaBBox(
+			area, -std::numeric_limits<double>::max(),
+			std::numeric_limits<double>::max()));
 
-		lst.push_back(dat);
-	}
-	filterByExclusionAreas(lst);
+	filterByAreaBBoxes(*this, boxes);
+
+	MRPT_END
 }
 
 /*---------------------------------------------------------------
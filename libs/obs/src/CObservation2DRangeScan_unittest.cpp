@@ -0,0 +1,82 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/math/CPolygon.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+
+#include <thread>
+#include <vector>
+
+using mrpt::obs::CObservation2DRangeScan;
+
+TEST(CObservation2DRangeScan, filterByExclusionAreas)
+{
+	CObservation2DRangeScan obs;
+	obs.aperture = static_cast<float>(M_PI);
+	obs.rightToLeft = true;
+	obs.resizeScanAndAssign(181, 2.0f, true);
+
+	// A box covering only the rays in front of the sensor (+X):
+	mrpt::math::CPolygon box;
+	box.AddVertex(1.0, -0.5);
+	box.AddVertex(3.0, -0.5);
+	box.AddVertex(3.0, 0.5);
+	box.AddVertex(1.0, 0.5);
+	obs.filterByExclusionAreas(std::vector<mrpt::math::CPolygon>({box}));
+
+	// Ray #90 points to +X; rays at +-90 deg must remain valid:
+	EXPECT_FALSE(obs.getScanRangeValidity(90));
+	EXPECT_TRUE(obs.getScanRangeValidity(0));
+	EXPECT_TRUE(obs.getScanRangeValidity(180));
+
+	// The Z range [1,2] does not include the scan plane, so no change:
+	CObservation2DRangeScan obs2;
+	obs2.aperture = static_cast<float>(M_PI);
+	obs2.resizeScanAndAssign(181, 2.0f, true);
+	obs2.filterByExclusionAreas(
+		CObservation2DRangeScan::TListExclusionAreasWithRanges(
+			{{box, {1.0, 2.0}}}));
+	for (size_t i = 0; i < obs2.getScanSize(); i++)
+		EXPECT_TRUE(obs2.getScanRangeValidity(i));
+}
+
+// The cached sin/cos tables must remain valid while other threads fill the
+// cache with many different scan geometries:
+TEST(CObservation2DRangeScan, filterByExclusionAreasMultithread)
+{
+	mrpt::math::CPolygon box;
+	box.AddVertex(1.0, -0.5);
+	box.AddVertex(3.0, -0.5);
+	box.AddVertex(3.0, 0.5);
+	box.AddVertex(1.0, 0.5);
+	const std::vector<mrpt::math::CPolygon> areas = {box};
+
+	std::vector<std::thread> threads;
+	std::vector<int> errors(4, 0);
+	for (size_t t = 0; t < errors.size(); t++)
+		threads.emplace_back([&, t]() {
+			for (size_t k = 0; k < 200; k++)
+			{
+				// Odd number of rays, so the central one points to +X:
+				const size_t N = 101 + 2 * ((k + 7 * t) % 30);
+				CObservation2DRangeScan obs;
+				obs.aperture = static_cast<float>(M_PI);
+				obs.resizeScanAndAssign(N, 2.0f, true);
+				obs.filterByExclusionAreas(areas);
+				if (obs.getScanRangeValidity(N / 2) ||
+					!obs.getScanRangeValidity(0))
+					errors[t]++;
+			}
+		});
+	for (auto& th : threads)
+		th.join();
+	for (const auto e : errors)
+		EXPECT_EQ(e, 0);
+}
@@ -199,13 +199,18 @@ bool CObservation3DRangeScan::EXTERNALS_AS_TEXT()
 // Data types for memory pooling CObservation3DRangeScan:
 #ifdef COBS3DRANGE_USE_MEMPOOL
 
-#include <mrpt/system/CGenericMemoryPool.h>
+#include <mrpt/system/CSizeClassMemoryPool.h>
 
 // Memory pool for XYZ points ----------------
 struct CObservation3DRangeScan_Points_MemPoolParams
 {
 	/** Width*Height, that is, the number of 3D points */
 	size_t WH{0};
+	/** Size of the block, in bytes */
+	inline size_t size() const
+	{
+		return WH * (3 * sizeof(float) + 2 * sizeof(uint16_t));
+	}
 	inline bool isSuitable(
 		const CObservation3DRangeScan_Points_MemPoolParams& req) const
 	{
@@ -218,7 +223,7 @@ struct CObservation3DRangeScan_Points_MemPoolData
 	/** for each point, the corresponding (x,y) pixel coordinates */
 	std::vector<uint16_t> idxs_x, idxs_y;
 };
-using TMyPointsMemPool = mrpt::system::CGenericMemoryPool<
+using TMyPointsMemPool = mrpt::system::CSizeClassMemoryPool<
 	CObservation3DRangeScan_Points_MemPoolParams,
 	CObservation3DRangeScan_Points_MemPoolData>;
 
@@ -227,6 +232,8 @@ struct CObservation3DRangeScan_Ranges_MemPoolParams
 {
 	/** Size of matrix */
 	int H{0}, W{0};
+	/** Size of the block, in bytes */
+	inline size_t size() const { return size_t(H) * W * sizeof(uint16_t); }
 	inline bool isSuitable(
 		const CObservation3DRangeScan_Ranges_MemPoolParams& req) const
 	{
@@ -237,7 +244,7 @@ struct CObservation3DRangeScan_Ranges_MemPoolData
 {
 	mrpt::math::CMatrix_u16 rangeImage;
 };
-using TMyRangesMemPool = mrpt::system::CGenericMemoryPool<
+using TMyRangesMemPool = mrpt::system::CSizeClassMemoryPool<
 	CObservation3DRangeScan_Ranges_MemPoolParams,
 	CObservation3DRangeScan_Ranges_MemPoolData>;
 
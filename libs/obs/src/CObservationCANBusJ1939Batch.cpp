@@ -0,0 +1,156 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "obs-precomp.h"  // Precompiled headers
+//
+#include <mrpt/core/format.h>
+#include <mrpt/obs/CObservationCANBusJ1939Batch.h>
+#include <mrpt/serialization/CArchive.h>
+
+#include <cstring>
+#include <iostream>
+
+using namespace mrpt::obs;
+
+// This must be added to any CSerializable class implementation file.
+IMPLEMENTS_SERIALIZABLE(CObservationCANBusJ1939Batch, CObservation, mrpt::obs)
+
+void CObservationCANBusJ1939Batch::clear()
+{
+	frameIds.clear();
+	frameTimestamps.clear();
+	frameDataLengths.clear();
+	frameData.clear();
+}
+
+void CObservationCANBusJ1939Batch::reserve(size_t n)
+{
+	frameIds.reserve(n);
+	frameTimestamps.reserve(n);
+	frameDataLengths.reserve(n);
+	frameData.reserve(n * MAX_DATA_LENGTH);
+}
+
+void CObservationCANBusJ1939Batch::push_back(
+	uint32_t id, mrpt::Clock::time_point t, uint8_t dataLength,
+	const uint8_t* data)
+{
+	ASSERT_LE_(dataLength, MAX_DATA_LENGTH);
+
+	if (frameIds.empty()) timestamp = t;
+
+	frameIds.push_back(id);
+	frameTimestamps.push_back(t);
+	frameDataLengths.push_back(dataLength);
+
+	const size_t idx = frameData.size();
+	frameData.resize(idx + MAX_DATA_LENGTH, 0);
+	if (dataLength) std::memcpy(&frameData[idx], data, dataLength);
+}
+
+void CObservationCANBusJ1939Batch::getFrame(
+	size_t i, CObservationCANBusJ1939& out) const
+{
+	ASSERT_LT_(i, size());
+
+	out.timestamp = frameTimestamps[i];
+	out.sensorLabel = sensorLabel;
+	out.m_priority = priority(i);
+	out.m_pdu_format = pduFormat(i);
+	out.m_pdu_spec = pduSpecific(i);
+	out.m_src_address = srcAddress(i);
+	out.m_pgn = pgn(i);
+	out.m_data_length = frameDataLengths[i];
+	out.m_data.assign(data(i), data(i) + frameDataLengths[i]);
+	out.m_raw_frame.clear();
+}
+
+uint8_t CObservationCANBusJ1939Batch::serializeGetVersion() const
+{
+	return 0;
+}
+void CObservationCANBusJ1939Batch::serializeTo(
+	mrpt::serialization::CArchive& out) const
+{
+	const uint32_t N = size();
+	ASSERT_EQUAL_(frameTimestamps.size(), N);
+	ASSERT_EQUAL_(frameDataLengths.size(), N);
+	ASSERT_EQUAL_(frameData.size(), N * MAX_DATA_LENGTH);
+
+	out << sensorLabel << timestamp;
+	out << N;
+	if (N)
+	{
+		out.WriteBufferFixEndianness(&frameIds[0], N);
+
+		std::vector<uint64_t> stamps(N);
+		for (uint32_t i = 0; i < N; i++)
+			stamps[i] = frameTimestamps[i].time_since_epoch().count();
+		out.WriteBufferFixEndianness(&stamps[0], N);
+
+		out.WriteBuffer(&frameDataLengths[0], N);
+		out.WriteBuffer(&frameData[0], frameData.size());
+	}
+}
+
+void CObservationCANBusJ1939Batch::serializeFrom(
+	mrpt::serialization::CArchive& in, uint8_t version)
+{
+	switch (version)
+	{
+		case 0:
+		{
+			in >> sensorLabel >> timestamp;
+
+			uint32_t N;
+			in >> N;
+			frameIds.resize(N);
+			frameTimestamps.resize(N);
+			frameDataLengths.resize(N);
+			frameData.resize(N * MAX_DATA_LENGTH);
+			if (N)
+			{
+				in.ReadBufferFixEndianness(&frameIds[0], N);
+
+				std::vector<uint64_t> stamps(N);
+				in.ReadBufferFixEndianness(&stamps[0], N);
+				for (uint32_t i = 0; i < N; i++)
+					frameTimestamps[i] = mrpt::Clock::time_point(
+						mrpt::Clock::duration(stamps[i]));
+
+				in.ReadBuffer(&frameDataLengths[0], N);
+				for (const uint8_t dataLength : frameDataLengths)
+					ASSERT_LE_(dataLength, MAX_DATA_LENGTH);
+				in.ReadBuffer(&frameData[0], frameData.size());
+			}
+		}
+		break;
+		default: MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version);
+	};
+}
+
+void CObservationCANBusJ1939Batch::getDescriptionAsText(std::ostream& o) const
+{
+	CObservation::getDescriptionAsText(o);
+
+	o << "Number of frames: " << size() << "\n";
+	o << "Frames (candump format):\n";
+	for (size_t i = 0; i < size(); i++)
+	{
+		o << mrpt::format(
+			"(%.06f) %s#", mrpt::Clock::toDouble(frameTimestamps[i]),
+			isExtendedId(i) ? mrpt::format("%08X", id(i)).c_str()
+							: mrpt::format("%03X", id(i)).c_str());
+		for (uint8_t k = 0; k < frameDataLengths[i]; k++)
+			o << mrpt::format("%02X", data(i)[k]);
+		o << mrpt::format(
+			"  [PGN: 0x%04X Prio: %u Src: 0x%02X]\n", pgn(i),
+			unsigned(priority(i)), unsigned(srcAddress(i)));
+	}
+}
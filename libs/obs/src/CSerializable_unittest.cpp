@@ -47,6 +47,7 @@ TEST_CLASS_MOVE_COPY_CTORS(CObservationImage);
 TEST_CLASS_MOVE_COPY_CTORS(CObservationStereoImages);
 #endif
 TEST_CLASS_MOVE_COPY_CTORS(CObservationCANBusJ1939);
+TEST_CLASS_MOVE_COPY_CTORS(CObservationCANBusJ1939Batch);
 TEST_CLASS_MOVE_COPY_CTORS(CObservationRawDAQ);
 TEST_CLASS_MOVE_COPY_CTORS(CObservation6DFeatures);
 TEST_CLASS_MOVE_COPY_CTORS(CObservationVelodyneScan);
@@ -67,7 +68,8 @@ const mrpt::rtti::TRuntimeClassId* lstClasses[] = {
 #if MRPT_HAS_OPENCV	 // These classes need CImage serialization
 	CLASS_ID(CObservationImage), CLASS_ID(CObservationStereoImages),
 #endif
-	CLASS_ID(CObservationCANBusJ1939), CLASS_ID(CObservationRawDAQ),
+	CLASS_ID(CObservationCANBusJ1939), CLASS_ID(CObservationCANBusJ1939Batch),
+	CLASS_ID(CObservationRawDAQ),
 	CLASS_ID(CObservation6DFeatures), CLASS_ID(CObservationVelodyneScan),
 	// Actions:
 	CLASS_ID(CActionRobotMovement2D), CLASS_ID(CActionRobotMovement3D)};
@@ -129,6 +131,25 @@ TEST(Observations, WriteReadToOctectVectors)
 	}
 }
 
+// Frames longer than MAX_DATA_LENGTH are rejected when read, as in push_back():
+TEST(Observations, CANBusJ1939BatchRejectsLongFrames)
+{
+	CObservationCANBusJ1939Batch batch;
+	const uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	batch.push_back(0x18FEF100, mrpt::Clock::now(), 8, data);
+
+	std::vector<uint8_t> buf;
+	mrpt::serialization::ObjectToOctetVector(&batch, buf);
+	CSerializable::Ptr recons;
+	EXPECT_NO_THROW(mrpt::serialization::OctetVectorToObject(buf, recons));
+
+	// The length of the frame precedes its 8 data bytes and the end flag:
+	ASSERT_GE(buf.size(), 10U);
+	ASSERT_EQ(buf[buf.size() - 10], 8);
+	buf[buf.size() - 10] = 9;
+	EXPECT_ANY_THROW(mrpt::serialization::OctetVectorToObject(buf, recons));
+}
+
 static bool aux_get_sample_data(mrpt::obs::CObservation&) { return false; }
 static bool aux_get_sample_data(mrpt::obs::CAction&) { return false; }
 
@@ -220,6 +241,7 @@ TEST(Observations, CopyCtorAssignOp)
 	run_copy_tests<CObservationStereoImages>();
 #endif
 	run_copy_tests<CObservationCANBusJ1939>();
+	run_copy_tests<CObservationCANBusJ1939Batch>();
 	run_copy_tests<CObservationRawDAQ>();
 	run_copy_tests<CObservation6DFeatures>();
 	run_copy_tests<CObservationVelodyneScan>();
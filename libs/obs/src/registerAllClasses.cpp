@@ -49,6 +49,7 @@ MRPT_INITIALIZER(registerAllClasses_mrpt_obs)
 	registerClass(CLASS_ID(CObservation6DFeatures));
 	registerClass(CLASS_ID(CObservationRobotPose));
 	registerClass(CLASS_ID(CObservationCANBusJ1939));
+	registerClass(CLASS_ID(CObservationCANBusJ1939Batch));
 	registerClass(CLASS_ID(CObservationRawDAQ));
 
 	registerClass(CLASS_ID(CSimpleMap));
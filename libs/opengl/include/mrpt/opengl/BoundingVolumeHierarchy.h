@@ -0,0 +1,235 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/math/TBoundingBox.h>
+#include <mrpt/math/TPoint3D.h>
+#include <mrpt/opengl/TTriangle.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace mrpt::opengl
+{
+/** A bounding volume hierarchy (BVH): a binary tree of axis-aligned bounding
+ * boxes over a set of primitives, used to find the closest primitive hit by a
+ * ray visiting only the few tree nodes whose boxes the ray goes through.
+ *
+ * The tree is built from the bounding box of each primitive, with the
+ * surface area heuristic (SAH). Primitives are not stored here: traceRay()
+ * invokes a user functor to intersect the ray with each candidate
+ * primitive, in order of increasing distance of the boxes containing them.
+ *
+ * The tree is immutable once built, so it can be queried from any number of
+ * threads at once.
+ *
+ * \sa TriangleBVH, COpenGLScene::traceRays()
+ * \ingroup mrpt_opengl_grp
+ */
+class BoundingVolumeHierarchy
+{
+   public:
+	/** A tree node. Nodes are stored in depth-first order, so the first child
+	 * of inner node `i` is `i+1`. */
+	struct Node
+	{
+		mrpt::math::TBoundingBoxf box;
+		/** For leaves, index in primitiveOrder() of the first primitive. For
+		 * inner nodes, index of the second child. */
+		uint32_t first = 0;
+		/** Number of primitives for leaves, 0 for inner nodes */
+		uint32_t count = 0;
+
+		bool isLeaf() const { return count != 0; }
+	};
+
+	BoundingVolumeHierarchy() = default;
+
+	/** Builds the tree for primitives with the given bounding boxes. Leaves
+	 * will have up to `maxLeafSize` primitives. */
+	void build(
+		const std::vector<mrpt::math::TBoundingBoxf>& boxes,
+		size_t maxLeafSize = 4);
+
+	void clear();
+	bool empty() const { return m_nodes.empty(); }
+
+	const std::vector<Node>& nodes() const { return m_nodes; }
+
+	/** Primitives sorted as referenced by the leaves: leaves refer to
+	 * primitives `primitiveOrder()[k]`, for `k` in `[first, first+count)`.
+	 * Users may store their primitives in this order, so the `k` passed to
+	 * the traceRay() functor indexes them directly. */
+	const std::vector<uint32_t>& primitiveOrder() const { return m_order; }
+
+	/** Finds the closest primitive hit by the ray from `origin` along
+	 * `unitDir` (a unit vector). `intersect(k, maxDist, d)` must return
+	 * whether the k-th primitive (in primitiveOrder()) is hit at a distance
+	 * `d<=maxDist`, and it is only called for primitives whose boxes are hit
+	 * closer than the best hit so far. Returns false if no primitive is hit.
+	 */
+	template <class INTERSECT>
+	bool traceRay(
+		const mrpt::math::TPoint3D& origin, const mrpt::math::TVector3D& unitDir,
+		double& dist, INTERSECT&& intersect) const
+	{
+		if (m_nodes.empty()) return false;
+		const Ray ray(origin, unitDir);
+
+		double best = std::numeric_limits<double>::max();
+		bool found = false;
+		if (ray.boxEntry(m_nodes[0].box, best) > best) return false;
+
+		uint32_t stack[MAX_DEPTH];
+		size_t stackSize = 0;
+		uint32_t ni = 0;
+		for (;;)
+		{
+			const Node& n = m_nodes[ni];
+			if (n.isLeaf())
+			{
+				for (uint32_t k = n.first; k < n.first + n.count; k++)
+				{
+					double d;
+					if (intersect(static_cast<size_t>(k), best, d) && d <= best)
+					{
+						best = d;
+						found = true;
+					}
+				}
+			}
+			else
+			{
+				// Visit the closest child first, and the other one later only
+				// if its box is still closer than the best hit:
+				uint32_t c1 = ni + 1, c2 = n.first;
+				double d1 = ray.boxEntry(m_nodes[c1].box, best);
+				double d2 = ray.boxEntry(m_nodes[c2].box, best);
+				if (d2 < d1)
+				{
+					std::swap(c1, c2);
+					std::swap(d1, d2);
+				}
+				if (d1 <= best)
+				{
+					if (d2 <= best) stack[stackSize++] = c2;
+					ni = c1;
+					continue;
+				}
+			}
+			// Pop the next node, skipping those farther than the best hit:
+			bool next = false;
+			while (stackSize && !next)
+			{
+				ni = stack[--stackSize];
+				next = ray.boxEntry(m_nodes[ni].box, best) <= best;
+			}
+			if (!next) break;
+		}
+		if (found) dist = best;
+		return found;
+	}
+
+	/** Max tree depth */
+	constexpr static size_t MAX_DEPTH = 64;
+
+   private:
+	std::vector<Node> m_nodes;
+	std::vector<uint32_t> m_order;
+
+	struct Ray
+	{
+		Ray(const mrpt::math::TPoint3D& o, const mrpt::math::TVector3D& d)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				orig[i] = o[i];
+				invDir[i] = d[i] != 0 ? 1.0 / d[i] : 0;
+				parallel[i] = d[i] == 0;
+			}
+		}
+		double orig[3], invDir[3];
+		bool parallel[3];
+
+		/** Distance along the ray where it enters the box (0 if the origin is
+		 * inside), or +inf if it does not hit the box before `maxDist`. */
+		double boxEntry(const mrpt::math::TBoundingBoxf& b, double maxDist) const
+		{
+			const double inf = std::numeric_limits<double>::infinity();
+			double tmin = 0, tmax = maxDist;
+			for (int i = 0; i < 3; i++)
+			{
+				if (parallel[i])
+				{
+					if (orig[i] < b.min[i] || orig[i] > b.max[i]) return inf;
+					continue;
+				}
+				double t1 = (b.min[i] - orig[i]) * invDir[i];
+				double t2 = (b.max[i] - orig[i]) * invDir[i];
+				if (t1 > t2) std::swap(t1, t2);
+				if (t1 > tmin) tmin = t1;
+				if (t2 < tmax) tmax = t2;
+				if (tmin > tmax) return inf;
+			}
+			return tmin;
+		}
+	};
+};
+
+/** A set of triangles indexed by a BoundingVolumeHierarchy, for fast ray
+ * tracing against meshes of any size. Used by the traceRay() methods of
+ * CMesh, CSetOfTriangles, CSetOfTexturedTriangles and CAssimpModel.
+ *
+ * \ingroup mrpt_opengl_grp
+ */
+class TriangleBVH
+{
+   public:
+	using triangle_t = std::array<mrpt::math::TPoint3Df, 3>;
+
+	TriangleBVH() = default;
+
+	/** Builds the index for the given triangles (a copy of their vertices
+	 * is kept). */
+	void build(const std::vector<triangle_t>& triangles);
+	/** \overload */
+	void build(const std::vector<mrpt::opengl::TTriangle>& triangles);
+
+	void clear();
+	bool empty() const { return m_tris.empty(); }
+	size_t size() const { return m_tris.size(); }
+
+	/** Closest triangle hit by the ray from `origin` along `unitDir` (a unit
+	 * vector), in the same frame than the triangles. Returns false if no
+	 * triangle is hit. */
+	bool traceRay(
+		const mrpt::math::TPoint3D& origin, const mrpt::math::TVector3D& unitDir,
+		double& dist) const;
+
+	/** Like mrpt::math::traceRay(): the ray starts at the pose origin and
+	 * goes along its +X axis. */
+	bool traceRay(const mrpt::poses::CPose3D& o, double& dist) const;
+
+   private:
+	/** Vertex 0 and edges 0->1, 0->2 of each triangle, in the order given
+	 * by m_bvh.primitiveOrder() */
+	struct Tri
+	{
+		mrpt::math::TPoint3Df v0;
+		mrpt::math::TVector3Df e1, e2;
+	};
+	std::vector<Tri> m_tris;
+	BoundingVolumeHierarchy m_bvh;
+};
+
+}  // namespace mrpt::opengl
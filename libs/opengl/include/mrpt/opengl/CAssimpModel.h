@@ -9,19 +9,19 @@
 #pragma once
 
 #include <mrpt/core/pimpl.h>
+#include <mrpt/opengl/BoundingVolumeHierarchy.h>
 #include <mrpt/opengl/CRenderizableShaderPoints.h>
 #include <mrpt/opengl/CRenderizableShaderTriangles.h>
 #include <mrpt/opengl/CRenderizableShaderWireFrame.h>
 #include <mrpt/opengl/CSetOfTexturedTriangles.h>
 
+#include <functional>
 #include <map>
 #include <optional>
 
 // Forward decls:
 // clang-format off
-struct aiScene;
-struct aiNode;
-namespace mrpt::opengl::internal { struct RenderElements; }
+namespace mrpt::opengl::internal { struct AssimpFlatModel; }
 // clang-format on
 
 namespace mrpt::opengl
@@ -34,7 +34,19 @@ namespace mrpt::opengl
  * .blend ), 3ds Max 3DS ( .3ds ), 3ds Max ASE ( .ase ), Quake I ( .mdl ), Quake
  * II ( .md2 ), Quake III Mesh ( .md3 ), etc.
  *
- *  Models are loaded via CAssimpModel::loadScene()
+ *  Models are loaded via CAssimpModel::loadScene(), or in a background
+ * thread with CAssimpModel::loadSceneAsync().
+ *
+ *  Importing big models with Assimp may take long. If a cache directory is
+ * set with CAssimpModel::setCacheDirectory() (or the environment variable
+ * `MRPT_ASSIMP_CACHE_DIR`), the geometry of each model, already flattened
+ * into triangles, lines and points, and its decoded texture images are saved
+ * there in a binary file after the first import. Later loads of the same
+ * model file with the same flags just map that file into memory, without
+ * invoking Assimp at all. Cache files are keyed by a hash of the contents of
+ * the model file. Texture images and any other file read by Assimp (e.g.
+ * .mtl materials or .bin buffers) are checked by their modification time.
+ * Use LoadFlags::IgnoreCache to bypass the cache for a given load.
  *
  * ![mrpt::opengl::CAssimpModel](preview_CAssimpModel.png)
  *
@@ -63,7 +75,9 @@ class CAssimpModel : public CRenderizableShaderTriangles,
 	void onUpdateBuffers_Wireframe() override;
 	void onUpdateBuffers_Triangles() override;
 	void onUpdateBuffers_Points() override;
-	void onUpdateBuffers_all();	 // special case for assimp
+	/** Special case for assimp: all buffers are built at once upon loading.
+	 * This only applies the results of loadSceneAsync(), if ready. */
+	void onUpdateBuffers_all();
 	void freeOpenGLResources() override
 	{
 		CRenderizableShaderTriangles::freeOpenGLResources();
@@ -91,6 +105,9 @@ class CAssimpModel : public CRenderizableShaderTriangles,
 			RealTimeMaxQuality = 0x0004,
 			/** See: aiProcess_FlipUVs */
 			FlipUVs = 0x0010,
+			/** Neither read nor write the cache of preprocessed models, even
+			 * if a cache directory is set. See setCacheDirectory() */
+			IgnoreCache = 0x0020,
 			/** Displays messages on loaded textures, etc. */
 			Verbose = 0x1000
 		};
@@ -107,10 +124,51 @@ class CAssimpModel : public CRenderizableShaderTriangles,
 		const int flags = LoadFlags::RealTimeMaxQuality | LoadFlags::FlipUVs |
 			LoadFlags::Verbose);
 
+	/** Callback for loadSceneAsync(). `errorMsg` is empty on success. */
+	using load_callback_t =
+		std::function<void(bool success, const std::string& errorMsg)>;
+
+	/** Like loadScene(), but the file is imported in a background thread and
+	 * this method returns immediately, with the object empty.
+	 *
+	 * Once loaded, the model is applied to this object by the next rendering
+	 * of it, from the rendering thread, or by waitForLoad(). The loader
+	 * thread never modifies the object. `onLoaded`, if provided, is invoked
+	 * from the loader thread when it finishes, e.g. to request a repaint of
+	 * the window showing the object.
+	 *
+	 * \note (New in MRPT 2.4.2)
+	 */
+	void loadSceneAsync(
+		const std::string& file_name,
+		const int flags = LoadFlags::RealTimeMaxQuality | LoadFlags::FlipUVs |
+			LoadFlags::Verbose,
+		const load_callback_t& onLoaded = {});
+
+	/** Returns true while a loadSceneAsync() is importing a file.
+	 * \note (New in MRPT 2.4.2) */
+	bool isLoading() const;
+
+	/** Blocks until the last loadSceneAsync(), if any, has finished, and
+	 * applies the loaded model to this object.
+	 * \exception std::runtime_error If the file could not be loaded.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	void waitForLoad();
+
+	/** Sets the directory for the cache of preprocessed models, for all
+	 * objects of this class. It is created if it does not exist. An empty
+	 * string (the default, unless the environment variable
+	 * `MRPT_ASSIMP_CACHE_DIR` is set) disables the cache.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	static void setCacheDirectory(const std::string& dir);
+	static std::string getCacheDirectory();
+
 	/** Empty the object */
 	void clear();
 
-	/* Simulation of ray-trace. */
+	/** Simulation of ray-trace, against all triangles in the model. */
 	bool traceRay(const mrpt::poses::CPose3D& o, double& dist) const override;
 
 	mrpt::math::TBoundingBox getBoundingBox() const override;
@@ -125,9 +183,9 @@ class CAssimpModel : public CRenderizableShaderTriangles,
 	};
 
    private:
-	/** The interface to the file: */
+	/** The state of background loading */
 	struct Impl;
-	mrpt::pimpl<Impl> m_assimp_scene;
+	mrpt::pimpl<Impl> m_impl;
 
 	/** Bounding box */
 	mrpt::math::TPoint3D m_bbox_min{0, 0, 0}, m_bbox_max{0, 0, 0};
@@ -139,12 +197,14 @@ class CAssimpModel : public CRenderizableShaderTriangles,
 	// We define a textured object per texture image, and delegate texture
 	// handling to that class:
 	mutable std::vector<CSetOfTexturedTriangles::Ptr> m_texturedObjects;
-	bool m_verboseLoad = false;
 
-	void recursive_render(
-		const aiScene* sc, const aiNode* nd, const mrpt::poses::CPose3D& transf,
-		mrpt::opengl::internal::RenderElements& re);
-	void process_textures(const aiScene* scene);
+	/** All triangles (textured or not), indexed for traceRay() */
+	TriangleBVH m_trianglesBVH;
+
+	/** Moves a loaded model into the rendering buffers of this object */
+	void applyModel(mrpt::opengl::internal::AssimpFlatModel&& m);
+	/** Waits for the loader thread, if any, to finish */
+	void joinLoader();
 
 };	// namespace mrpt::opengl
 
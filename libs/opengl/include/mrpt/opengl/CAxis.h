@@ -65,6 +65,12 @@ class CAxis : public CRenderizableShaderWireFrame
 
 	mrpt::math::TBoundingBox getBoundingBox() const override;
 
+	/** Axes with the same parameters share the buffers of one prototype */
+	bool instancingKey(
+		std::string& key,
+		mrpt::math::CMatrixFloat44& instanceTransform) const override;
+	CRenderizable::Ptr makeInstancingPrototype() const override;
+
    protected:
 	float m_xmin, m_ymin, m_zmin;
 	float m_xmax, m_ymax, m_zmax;
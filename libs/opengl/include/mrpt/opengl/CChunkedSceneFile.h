@@ -0,0 +1,151 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/io/CMemoryMappedFile.h>
+#include <mrpt/math/TBoundingBox.h>
+#include <mrpt/opengl/CRenderizable.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mrpt::opengl
+{
+class COpenGLScene;
+
+/** Reader and writer of ".3Dscene" files in the chunked format, where each
+ * object is compressed independently and indexed, so objects can be loaded
+ * in parallel, or one by one on demand, e.g. to show a huge scene while it
+ * is still being loaded.
+ *
+ * Layout of the file:
+ *  - An 8-byte signature.
+ *  - The scene with its viewports, cameras, lights, etc. but no objects (its
+ *    "skeleton"), serialized and compressed with zlib.
+ *  - Each object, serialized and compressed with zlib. Objects in
+ *    CSetOfObjects are stored apart from their parent, in depth-first order.
+ *  - The index: for each object, its class, name, bounding box, parent and
+ *    position in the file.
+ *  - The position of the index and the signature again.
+ *
+ * Files are memory-mapped while read, so only the parts actually loaded are
+ * read from disk.
+ *
+ * Usage:
+ * \code
+ * // Save:
+ * scene.saveToFile("big.3Dscene", true);
+ *
+ * // Load everything, in parallel:
+ * scene.loadFromFile("big.3Dscene"); // or:
+ * mrpt::opengl::CChunkedSceneFile f("big.3Dscene");
+ * f.loadScene(scene);
+ *
+ * // Load progressively:
+ * f.loadSkeleton(scene);
+ * for (size_t i = 0; i < f.objects().size(); i += 1000)
+ * {
+ *   const size_t last = std::min(i + 1000, f.objects().size());
+ *   const auto objs = f.loadObjects(i, last);
+ *   for (size_t k = i; k < last; k++) f.insertObject(scene, k, objs[k - i]);
+ * }
+ * \endcode
+ *
+ * \sa COpenGLScene::saveToFile(), COpenGLScene::loadFromFile()
+ * \ingroup mrpt_opengl_grp
+ * \note (New in MRPT 2.4.2)
+ */
+class CChunkedSceneFile
+{
+   public:
+	/** An entry in the index of objects */
+	struct ObjectEntry
+	{
+		/** Class name, e.g. "mrpt::opengl::CPointCloud" */
+		std::string className;
+		/** Object name (see CRenderizable::getName()) */
+		std::string name;
+		/** Index of the viewport, in the order of COpenGLScene::viewports()
+		 */
+		uint32_t viewport = 0;
+		/** Index of the CSetOfObjects entry containing this object, or -1 if
+		 * it is in the viewport list of objects. Parents always come before
+		 * their children. */
+		int32_t parent = -1;
+		/** Bounding box in the frame of the parent, including children, if
+		 * the object could provide one. */
+		mrpt::math::TBoundingBoxf bbox;
+		bool hasBoundingBox = false;
+		/** Position of the compressed object in the file, and its size
+		 * compressed and uncompressed */
+		uint64_t offset = 0, compressedSize = 0, size = 0;
+	};
+
+	CChunkedSceneFile() = default;
+	/** Constructor which calls open(), and throws on error */
+	explicit CChunkedSceneFile(const std::string& fileName);
+
+	/** Opens the file and reads its index.
+	 * \exception std::exception On any error reading the file, or if it is
+	 * not a chunked scene file. */
+	void open(const std::string& fileName);
+
+	bool isOpen() const { return m_file.isOpen(); }
+
+	/** Returns true if the file exists and starts with the signature of
+	 * chunked scene files */
+	static bool IsChunkedSceneFile(const std::string& fileName);
+
+	/** Saves a scene in this format. Objects are serialized and compressed
+	 * in parallel.
+	 * \exception std::exception On any error */
+	static void Save(const COpenGLScene& scene, const std::string& fileName);
+
+	/** All objects in the file */
+	const std::vector<ObjectEntry>& objects() const { return m_objects; }
+
+	/** Replaces the contents of `scene` with the viewports in the file,
+	 * without objects. Forgets the objects inserted with insertObject(). */
+	void loadSkeleton(COpenGLScene& scene);
+
+	/** Decompresses and deserializes one object. Objects stored as
+	 * CSetOfObjects are returned empty, see insertObject(). Thread-safe.
+	 */
+	CRenderizable::Ptr loadObject(size_t index) const;
+
+	/** Loads the objects with indices in [first,last) in parallel, with
+	 * mrpt::WorkerThreadsPool::Default(). */
+	std::vector<CRenderizable::Ptr> loadObjects(
+		size_t first, size_t last) const;
+
+	/** Inserts a loaded object into its viewport of a scene loaded with
+	 * loadSkeleton(), or into its parent CSetOfObjects.
+	 * \return false if the parent object has not been inserted before.
+	 */
+	bool insertObject(
+		COpenGLScene& scene, size_t index, const CRenderizable::Ptr& obj);
+
+	/** Loads the skeleton and all objects into `scene` */
+	void loadScene(COpenGLScene& scene);
+
+   private:
+	mrpt::io::CMemoryMappedFile m_file;
+	uint64_t m_indexOffset = 0;
+	ObjectEntry m_skeleton;
+	std::vector<ObjectEntry> m_objects;
+
+	/** Containers already inserted with insertObject(), by index */
+	std::vector<CRenderizable::Ptr> m_inserted;
+
+	/** Returns the serialized object of an entry */
+	std::vector<uint8_t> decompress(const ObjectEntry& e) const;
+};
+
+}  // namespace mrpt::opengl
@@ -57,6 +57,7 @@ class CColorBar : public CRenderizableShaderTriangles,
 	void onUpdateBuffers_Wireframe() override;
 	void onUpdateBuffers_Triangles() override;
 	void onUpdateBuffers_all();
+	void onUpdateCPUBuffers() override;
 	void freeOpenGLResources() override
 	{
 		CRenderizableShaderTriangles::freeOpenGLResources();
@@ -55,6 +55,7 @@ class CEllipsoid2D : public CGeneralizedEllipsoidTemplate<2>
 	void transformFromParameterSpace(
 		const std::vector<BASE::array_parameter_t>& in_pts,
 		std::vector<BASE::array_point_t>& out_pts) const override;
+	bool parameterSpaceIsRenderSpace() const override { return true; }
 };
 
 }  // namespace mrpt::opengl
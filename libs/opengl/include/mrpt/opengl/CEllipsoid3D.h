@@ -54,6 +54,7 @@ class CEllipsoid3D : public CGeneralizedEllipsoidTemplate<3>
 	void transformFromParameterSpace(
 		const std::vector<BASE::array_parameter_t>& in_pts,
 		std::vector<BASE::array_point_t>& out_pts) const override;
+	bool parameterSpaceIsRenderSpace() const override { return true; }
 };
 
 }  // namespace mrpt::opengl
@@ -13,6 +13,9 @@
 #include <mrpt/img/CImage.h>
 #include <mrpt/opengl/COpenGLFramebuffer.h>
 #include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/opengl/SoftwareRasterizer.h>
+
+#include <memory>
 
 namespace mrpt::opengl
 {
@@ -28,6 +31,10 @@ namespace mrpt::opengl
  *
  * The SE(3) pose from which the scene is rendered is defined by the scene
  * `"main"` viewport camera pose.
+ *
+ * Scenes can also be rendered without OpenGL, a GPU or a display (e.g. in
+ * headless servers) by setting Parameters::software in the constructor, so
+ * all rendering is done in the CPU by a SoftwareRasterizer.
  * See \ref gui_fbo_render_example for code examples.
  *
  * \sa \ref opengl_offscreen_render_example , \ref gui_fbo_render_example
@@ -36,6 +43,33 @@ namespace mrpt::opengl
 class CFBORender
 {
    public:
+	/** Parameters for the constructor */
+	struct Parameters
+	{
+		Parameters() = default;
+
+		unsigned int width = 800;  //!< Width of images, in pixels
+		unsigned int height = 600;	//!< Height of images, in pixels
+
+		/** Should be set to true only if another GUI windows already exist
+		 * with an associated OpenGL context. If left to false, a hidden GLUT
+		 * window will be created. Ignored in software mode. */
+		bool skip_glut_window = false;
+
+		/** Render in the CPU with a SoftwareRasterizer, without OpenGL nor
+		 * a display (Default: false) */
+		bool software = false;
+
+		/** Number of threads used in software mode, 0 means as many as
+		 * hardware threads. */
+		unsigned int softwareThreads = 0;
+	};
+
+	/** Constructor.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	explicit CFBORender(const Parameters& p);
+
 	/** Constructor.
 	 * \param[in] skip_glut_window Should be set to true only if another GUI
 	 * windows already exist with an associated OpenGL context. If left to
@@ -89,8 +123,12 @@ class CFBORender
 	void render_depth(
 		const COpenGLScene& scene, mrpt::math::CMatrixFloat& outDepth);
 
+	/** The renderer used in software mode, or nullptr otherwise. */
+	SoftwareRasterizer* softwareRasterizer() { return m_software.get(); }
+
    protected:
 	COpenGLFramebuffer m_fb;
+	std::unique_ptr<SoftwareRasterizer> m_software;
 
 	int m_win = 0;
 	unsigned int m_texRGB = 0;
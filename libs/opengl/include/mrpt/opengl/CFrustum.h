@@ -63,7 +63,10 @@ class CFrustum : public CRenderizableShaderTriangles,
 	virtual shader_list_t requiredShaders() const override
 	{
 		// May use up to two shaders (triangles and lines):
-		return {DefaultShaderID::WIREFRAME, DefaultShaderID::TRIANGLES};
+		shader_list_t lst;
+		if (m_draw_lines) lst.push_back(DefaultShaderID::WIREFRAME);
+		if (m_draw_planes) lst.push_back(DefaultShaderID::TRIANGLES);
+		return lst;
 	}
 	void onUpdateBuffers_Wireframe() override;
 	void onUpdateBuffers_Triangles() override;
@@ -61,25 +61,22 @@ class CGeneralizedEllipsoidTemplate
 	}
 
 	void renderUpdateBuffers() const override
+	{
+		updateRenderPoints();
+		CRenderizableShaderTriangles::renderUpdateBuffers();
+		CRenderizableShaderWireFrame::renderUpdateBuffers();
+	}
+	void onUpdateCPUBuffers() override
+	{
+		updateRenderPoints();
+		CRenderizable::onUpdateCPUBuffers();
+	}
+	/** Updates m_render_pts and the bounding box, before generating the
+	 * buffers */
+	void updateRenderPoints() const
 	{
 		// 1) Update eigenvectors/values:
-		if (m_needToRecomputeEigenVals)
-		{
-			m_needToRecomputeEigenVals = false;
-			// Handle the special case of an ellipsoid of volume = 0
-			const double d = m_cov.det();
-			// Note: "d!=d" is a great test for invalid numbers, don't remove!
-			if (std::abs(d) < 1e-20 || d != d)
-			{
-				// All zeros:
-				m_U.setZero(DIM, DIM);
-			}
-			else
-			{
-				// A valid matrix:
-				m_cov.chol(m_U);
-			}
-		}
+		updateCholesky();
 
 		// 2) Generate "standard" ellipsoid:
 		std::vector<array_parameter_t> params_pts;
@@ -90,7 +87,7 @@ class CGeneralizedEllipsoidTemplate
 		// 3) Transform into 2D/3D render space:
 		this->transformFromParameterSpace(params_pts, m_render_pts);
 
-		// 3.5) Save bounding box:
+		// 3.5) Save bounding box, in object local coordinates:
 		m_bb_min = mrpt::math::TPoint3D(
 			std::numeric_limits<double>::max(),
 			std::numeric_limits<double>::max(), 0);
@@ -103,12 +100,6 @@ class CGeneralizedEllipsoidTemplate
 				mrpt::keep_min(m_bb_min[k], m_render_pts[i][k]);
 				mrpt::keep_max(m_bb_max[k], m_render_pts[i][k]);
 			}
-		// Convert to coordinates of my parent:
-		m_pose.composePoint(m_bb_min, m_bb_min);
-		m_pose.composePoint(m_bb_max, m_bb_max);
-
-		CRenderizableShaderTriangles::renderUpdateBuffers();
-		CRenderizableShaderWireFrame::renderUpdateBuffers();
 	}
 	virtual shader_list_t requiredShaders() const override
 	{
@@ -214,7 +205,60 @@ class CGeneralizedEllipsoidTemplate
 	 * children) in the coordinate frame of the object parent. */
 	mrpt::math::TBoundingBox getBoundingBox() const override
 	{
-		return mrpt::math::TBoundingBox(m_bb_min, m_bb_max).compose(m_pose);
+		if (!parameterSpaceIsRenderSpace())
+			return mrpt::math::TBoundingBox(m_bb_min, m_bb_max).compose(m_pose);
+
+		// Exact box of the ellipsoid: mean +/- q*|row_k(U)| along each axis
+		updateCholesky();
+		mrpt::math::TBoundingBox bb({0, 0, 0}, {0, 0, 0});
+		for (int k = 0; k < DIM; k++)
+		{
+			double r2 = 0;
+			for (int c = 0; c < DIM; c++)
+				r2 += mrpt::square(m_U(k, c));
+			const double r = m_quantiles * std::sqrt(r2);
+			bb.min[k] = m_mean[k] - r;
+			bb.max[k] = m_mean[k] + r;
+		}
+		return bb.compose(m_pose);
+	}
+
+	/** Wireframe ellipsoids in classes whose parameter space is the
+	 * rendering space (CEllipsoid2D, CEllipsoid3D) are instances of a unit
+	 * circle or sphere, transformed with their mean and covariance. */
+	bool instancingKey(
+		std::string& key,
+		mrpt::math::CMatrixFloat44& instanceTransform) const override
+	{
+		if (!parameterSpaceIsRenderSpace() || m_drawSolid3D) return false;
+
+		key = this->GetRuntimeClass()->className;
+		CRenderizable::instancingKeyAppend(
+			key, m_numSegments, m_lineWidth, m_antiAliasing, m_color);
+
+		updateCholesky();
+		instanceTransform.setIdentity();
+		for (int r = 0; r < DIM; r++)
+		{
+			for (int c = 0; c < DIM; c++)
+				instanceTransform(r, c) = d2f(m_quantiles * m_U(r, c));
+			instanceTransform(r, 3) = d2f(m_mean[r]);
+		}
+		return true;
+	}
+
+	CRenderizable::Ptr makeInstancingPrototype() const override
+	{
+		auto o = std::dynamic_pointer_cast<CGeneralizedEllipsoidTemplate<DIM>>(
+			this->GetRuntimeClass()->createObject());
+		ASSERT_(o);
+		o->setCovMatrixAndMean(cov_matrix_t::Identity(), mean_vector_t::Zero());
+		o->m_quantiles = 1.0f;
+		o->m_numSegments = m_numSegments;
+		o->m_lineWidth = m_lineWidth;
+		o->m_antiAliasing = m_antiAliasing;
+		o->m_color = m_color;
+		return o;
 	}
 
 	/** Ray tracing  */
@@ -234,6 +278,30 @@ class CGeneralizedEllipsoidTemplate
 		const std::vector<array_point_t>& params_pts,
 		std::vector<array_point_t>& out_pts) const = 0;
 
+	/** Must return true in derived classes where transformFromParameterSpace()
+	 * is the identity, enabling an exact bounding box and instancing. */
+	virtual bool parameterSpaceIsRenderSpace() const { return false; }
+
+	/** Updates m_U from m_cov, if needed */
+	void updateCholesky() const
+	{
+		if (!m_needToRecomputeEigenVals) return;
+		m_needToRecomputeEigenVals = false;
+		// Handle the special case of an ellipsoid of volume = 0
+		const double d = m_cov.det();
+		// Note: "d!=d" is a great test for invalid numbers, don't remove!
+		if (std::abs(d) < 1e-20 || d != d)
+		{
+			// All zeros:
+			m_U.setZero(DIM, DIM);
+		}
+		else
+		{
+			// A valid matrix:
+			m_cov.chol(m_U);
+		}
+	}
+
 	mutable cov_matrix_t m_cov;
 	mean_vector_t m_mean;
 	mutable bool m_needToRecomputeEigenVals{true};
@@ -12,6 +12,7 @@
 #include <mrpt/img/CImage.h>
 #include <mrpt/img/color_maps.h>
 #include <mrpt/math/CMatrixF.h>
+#include <mrpt/opengl/BoundingVolumeHierarchy.h>
 #include <mrpt/opengl/CRenderizableShaderTexturedTriangles.h>
 #include <mrpt/opengl/CRenderizableShaderWireFrame.h>
 #include <mrpt/opengl/CSetOfTriangles.h>
@@ -45,12 +46,13 @@ class CMesh : public CRenderizableShaderTexturedTriangles,
 
 	virtual shader_list_t requiredShaders() const override
 	{
-		// May use up to two shaders (triangles and lines):
-		return {
-			DefaultShaderID::WIREFRAME, DefaultShaderID::TEXTURED_TRIANGLES};
+		// Either triangles or lines:
+		if (m_isWireFrame) return {DefaultShaderID::WIREFRAME};
+		return {DefaultShaderID::TEXTURED_TRIANGLES};
 	}
 	void onUpdateBuffers_Wireframe() override;
 	void onUpdateBuffers_TexturedTriangles() override;
+	void onUpdateCPUBuffers() override;
 	void freeOpenGLResources() override
 	{
 		CRenderizableShaderTexturedTriangles::freeOpenGLResources();
@@ -100,6 +102,28 @@ class CMesh : public CRenderizableShaderTexturedTriangles,
 		CRenderizable::notifyChange();
 	}
 
+	/** Enables merging rectangles of adjacent cells with the same height
+	 * (within `heightTolerance`) into just two triangles each, greatly
+	 * reducing the number of triangles of elevation maps with large flat
+	 * areas. It has no effect for meshes with a texture image, since each
+	 * cell has its own color then. Disabled by default.
+	 *
+	 * \warning The edges of a merged rectangle meet the vertices of their
+	 * unmerged neighbor cells in T-junctions. With `heightTolerance` > 0,
+	 * those vertices may be off the edge by up to `heightTolerance`,
+	 * leaving small cracks in the rendered surface. Keep the default of 0
+	 * for a watertight mesh.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	void enableQuadMerging(bool v, float heightTolerance = 0)
+	{
+		m_quadMerging = v;
+		m_quadMergingTolerance = heightTolerance;
+		m_trianglesUpToDate = false;
+		CRenderizable::notifyChange();
+	}
+	bool isQuadMergingEnabled() const { return m_quadMerging; }
+
 	/** This method sets the matrix of heights for each position (cell) in the
 	 * mesh grid */
 	void setZ(const mrpt::math::CMatrixDynamic<float>& in_Z);
@@ -193,6 +217,8 @@ class CMesh : public CRenderizableShaderTexturedTriangles,
 	bool m_colorFromZ{false};
 	bool m_isWireFrame{false};
 	bool m_isImage{false};
+	bool m_quadMerging{false};
+	float m_quadMergingTolerance{0};
 
 	/** Z(x,y): Z-coordinate of the point (x,y) */
 	math::CMatrixF Z;
@@ -222,8 +248,8 @@ class CMesh : public CRenderizableShaderTexturedTriangles,
 	void updateColorsMatrix() const;
 	/** Called internally to assure the triangle list is updated. */
 	void updateTriangles() const;
-	void updatePolygons() const;  //<!Called internally to assure that the
-	// polygon list is updated.
+	/** Called internally to assure the BVH for ray tracing is updated. */
+	void updatePolygons() const;
 
 	/** Mesh bounds */
 	float m_xMin, m_xMax, m_yMin, m_yMax;
@@ -236,10 +262,10 @@ class CMesh : public CRenderizableShaderTexturedTriangles,
 	mutable std::vector<std::pair<mrpt::math::TPoint3D, size_t>> vertex_normals;
 	/**Whether the actual mesh needs to be recalculated */
 	mutable bool m_trianglesUpToDate{false};
-	/**Whether the polygon mesh (auxiliary structure for ray tracing) needs to
-	 * be recalculated */
+	/**Whether the triangles BVH (auxiliary structure for ray tracing) needs
+	 * to be recalculated */
 	mutable bool m_polygonsUpToDate{false};
-	mutable std::vector<mrpt::math::TPolygonWithPlane> tmpPolys;
+	mutable mrpt::opengl::TriangleBVH m_trianglesBVH;
 };
 
 }  // namespace mrpt::opengl
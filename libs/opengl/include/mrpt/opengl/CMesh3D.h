@@ -47,9 +47,11 @@ class CMesh3D : public CRenderizableShaderTriangles,
 
 	virtual shader_list_t requiredShaders() const override
 	{
-		return {
-			DefaultShaderID::WIREFRAME, DefaultShaderID::TRIANGLES,
-			DefaultShaderID::POINTS};
+		shader_list_t lst;
+		if (m_showEdges) lst.push_back(DefaultShaderID::WIREFRAME);
+		if (m_showFaces) lst.push_back(DefaultShaderID::TRIANGLES);
+		if (m_showVertices) lst.push_back(DefaultShaderID::POINTS);
+		return lst;
 	}
 	void onUpdateBuffers_Wireframe() override;
 	void onUpdateBuffers_Triangles() override;
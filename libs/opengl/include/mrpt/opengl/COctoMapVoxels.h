@@ -13,6 +13,9 @@
 #include <mrpt/opengl/CRenderizableShaderTriangles.h>
 #include <mrpt/opengl/CRenderizableShaderWireFrame.h>
 
+#include <map>
+#include <set>
+
 namespace mrpt::opengl
 {
 enum predefined_voxel_sets_t
@@ -55,6 +58,13 @@ enum predefined_voxel_sets_t
  * Several coloring schemes can be selected with setVisualizationMode(). See
  *COctoMapVoxels::visualization_mode_t
  *
+ * Voxels and grid cubes can also be grouped into <b>blocks</b> (see
+ *setVoxelBlock()), e.g. regions of a map, which are replaced or removed as a
+ *whole. Each block keeps its own range of triangles, so replacing a few blocks
+ *only regenerates and uploads to the GPU the triangles of those blocks, as
+ *mrpt::maps::COctoMapBase::updateOctoMapVoxels() does for the regions of a map
+ *modified since its last call.
+ *
  * ![mrpt::opengl::COctoMapVoxels](preview_COctoMapVoxels.png)
  *
  * \sa opengl::COpenGLScene
@@ -128,6 +138,17 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 		TInfoPerVoxelSet() = default;
 	};
 
+	/** A group of voxels and grid cubes, replaced as a whole with
+	 * setVoxelBlock(). \note (New in MRPT 2.4.2) */
+	struct TVoxelBlock
+	{
+		/** The voxels of the block in each voxel set */
+		std::vector<std::vector<TVoxel>> voxels;
+		std::vector<TGridCube> gridCubes;
+
+		TVoxelBlock() = default;
+	};
+
    protected:
 	std::deque<TInfoPerVoxelSet> m_voxel_sets;
 	std::vector<TGridCube> m_grid_cubes;
@@ -143,6 +164,7 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 	float m_grid_width{1.0f};
 	mrpt::img::TColor m_grid_color;
 	visualization_mode_t m_visual_mode{COctoMapVoxels::COLOR_FROM_OCCUPANCY};
+	bool m_greedy_meshing{false};
 
    public:
 	/** @name Renderizable shader API virtual methods
@@ -152,10 +174,13 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 
 	virtual shader_list_t requiredShaders() const override
 	{
-		// May use up to two shaders (triangles and lines):
-		return {
-			DefaultShaderID::WIREFRAME, DefaultShaderID::POINTS,
-			DefaultShaderID::TRIANGLES};
+		// May use up to two shaders (triangles or points, and lines):
+		shader_list_t lst;
+		if (m_show_grids) lst.push_back(DefaultShaderID::WIREFRAME);
+		lst.push_back(
+			m_showVoxelsAsPoints ? DefaultShaderID::POINTS
+								 : DefaultShaderID::TRIANGLES);
+		return lst;
 	}
 	void onUpdateBuffers_Points() override;
 	void onUpdateBuffers_Wireframe() override;
@@ -168,7 +193,7 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 	}
 	/** @} */
 
-	/** Clears everything */
+	/** Clears everything, including all blocks */
 	void clear();
 
 	/** Select the visualization mode. To have any effect, this method has to be
@@ -202,6 +227,25 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 		return m_enable_cube_transparency;
 	}
 
+	/** Enables "greedy meshing" of voxels into triangles: faces shared by
+	 * two voxels of the same set are removed, and adjacent coplanar faces of
+	 * the same color are merged into larger rectangles. This greatly reduces
+	 * the number of triangles of large, dense maps.
+	 *
+	 * Only voxels with the smallest side length of each set and aligned to a
+	 * common grid are merged, as those of the leaves of an octomap at its
+	 * finest resolution; the rest are rendered as independent cubes. Since
+	 * hidden faces are removed, transparent voxels look different.
+	 * Disabled by default.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	inline void enableGreedyMeshing(bool enable)
+	{
+		m_greedy_meshing = enable;
+		CRenderizable::notifyChange();
+	}
+	inline bool isGreedyMeshingEnabled() const { return m_greedy_meshing; }
+
 	/** Shows/hides the grid lines */
 	inline void showGridLines(bool show)
 	{
@@ -260,15 +304,22 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 		return m_grid_color;
 	}
 
-	/** Returns the total count of grid cubes. */
-	inline size_t getGridCubeCount() const { return m_grid_cubes.size(); }
+	/** Returns the total count of grid cubes, including those in blocks. */
+	inline size_t getGridCubeCount() const
+	{
+		return m_grid_cubes.size() + m_blocksGridCubeCount;
+	}
 	/** Returns the number of voxel sets. */
 	inline size_t getVoxelSetCount() const { return m_voxel_sets.size(); }
-	/** Returns the total count of voxels in one voxel set. */
+	/** Returns the total count of voxels in one voxel set, including those in
+	 * blocks. */
 	inline size_t getVoxelCount(const size_t set_index) const
 	{
 		ASSERT_(set_index < m_voxel_sets.size());
-		return m_voxel_sets[set_index].voxels.size();
+		return m_voxel_sets[set_index].voxels.size() +
+			(set_index < m_blocksVoxelCount.size()
+				 ? m_blocksVoxelCount[set_index]
+				 : 0);
 	}
 
 	/** Manually changes the bounding box (normally the user doesn't need to
@@ -276,6 +327,7 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 	void setBoundingBox(
 		const mrpt::math::TPoint3D& bb_min, const mrpt::math::TPoint3D& bb_max);
 
+	/** Resizes the list of grid cubes not in any block */
 	inline void resizeGridCubes(const size_t nCubes)
 	{
 		m_grid_cubes.resize(nCubes);
@@ -286,6 +338,7 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 		m_voxel_sets.resize(nVoxelSets);
 		CRenderizable::notifyChange();
 	}
+	/** Resizes the list of voxels of a set not in any block */
 	inline void resizeVoxels(const size_t set_index, const size_t nVoxels)
 	{
 		ASSERT_(set_index < m_voxel_sets.size());
@@ -304,35 +357,15 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 		CRenderizable::notifyChange();
 	}
 
-	inline TGridCube& getGridCubeRef(const size_t idx)
-	{
-		ASSERTDEB_(idx < m_grid_cubes.size());
-		CRenderizable::notifyChange();
-		return m_grid_cubes[idx];
-	}
-	inline const TGridCube& getGridCube(const size_t idx) const
-	{
-		ASSERTDEB_(idx < m_grid_cubes.size());
-		return m_grid_cubes[idx];
-	}
+	/** Access to the grid cubes, those not in blocks first, then the ones of
+	 * each block, in the order of block IDs. */
+	TGridCube& getGridCubeRef(const size_t idx);
+	const TGridCube& getGridCube(const size_t idx) const;
 
-	inline TVoxel& getVoxelRef(const size_t set_index, const size_t idx)
-	{
-		ASSERTDEB_(
-			set_index < m_voxel_sets.size() &&
-			idx < m_voxel_sets[set_index].voxels.size());
-		CRenderizable::notifyChange();
-		return m_voxel_sets[set_index].voxels[idx];
-	}
-	inline const TVoxel& getVoxel(
-		const size_t set_index, const size_t idx) const
-	{
-		ASSERTDEB_(
-			set_index < m_voxel_sets.size() &&
-			idx < m_voxel_sets[set_index].voxels.size());
-		CRenderizable::notifyChange();
-		return m_voxel_sets[set_index].voxels[idx];
-	}
+	/** Access to the voxels of a set, those not in blocks first, then the
+	 * ones of each block, in the order of block IDs. */
+	TVoxel& getVoxelRef(const size_t set_index, const size_t idx);
+	const TVoxel& getVoxel(const size_t set_index, const size_t idx) const;
 
 	inline void push_back_GridCube(const TGridCube& c)
 	{
@@ -346,8 +379,40 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 		m_voxel_sets[set_index].voxels.push_back(v);
 	}
 
+	/** Sorts the voxels of each set by "z", as an approximation to a
+	 * far-to-near rendering order of transparent voxels. Voxels in blocks are
+	 * sorted within each block. */
 	void sort_voxels_by_z();
 
+	/** @name Blocks of voxels
+	 * @{ */
+
+	/** Sets the voxels and grid cubes of the block with the given ID,
+	 * replacing its former contents, if any. Only the triangles of modified
+	 * blocks are regenerated and copied to the GPU, so this is much faster
+	 * than rebuilding the whole object when just a few regions change.
+	 *
+	 * The triangles of each block are generated independently, hence with
+	 * enableGreedyMeshing() faces are only merged within a block, and the
+	 * faces shared by voxels of two neighbor blocks are not removed.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	void setVoxelBlock(uint64_t id, TVoxelBlock&& block);
+
+	/** Removes a block of voxels, if it exists. \sa setVoxelBlock() */
+	void removeVoxelBlock(uint64_t id);
+
+	/** Returns the voxels and grid cubes of a block, which must exist. */
+	const TVoxelBlock& getVoxelBlock(uint64_t id) const;
+
+	/** Returns the IDs of all blocks, in ascending order */
+	std::vector<uint64_t> getVoxelBlockIDs() const;
+
+	/** Returns the number of blocks of voxels */
+	inline size_t getVoxelBlockCount() const { return m_blocks.size(); }
+
+	/** @} */
+
 	mrpt::math::TBoundingBox getBoundingBox() const override;
 
 	/** Sets the contents of the object from a mrpt::maps::COctoMap object.
@@ -362,10 +427,65 @@ class COctoMapVoxels : public CRenderizableShaderTriangles,
 		m.getAsOctoMapVoxels(*this);
 	}
 
+	/** Like setFromOctoMap(), but only regenerates the voxels of the parts of
+	 * the map modified since the last call. See
+	 * mrpt::maps::COctoMapBase::updateOctoMapVoxels()
+	 * \note (New in MRPT 2.4.2)
+	 */
+	template <class OCTOMAP>
+	void updateFromOctoMap(OCTOMAP& m)
+	{
+		m.updateOctoMapVoxels(*this);
+	}
+
 	/** Constructor */
 	COctoMapVoxels();
 	/** Private, virtual destructor: only can be deleted from smart pointers. */
 	~COctoMapVoxels() override = default;
+
+   private:
+	/** A block of voxels, and its triangles:
+	 * m_triangles[trisFirst, trisFirst + trisCount), within a range of
+	 * trisCapacity triangles reserved for it. */
+	struct BlockInfo
+	{
+		TVoxelBlock block;
+		size_t trisFirst = 0, trisCount = 0, trisCapacity = 0;
+	};
+	std::map<uint64_t, BlockInfo> m_blocks;
+	std::vector<size_t> m_blocksVoxelCount;
+	size_t m_blocksGridCubeCount = 0;
+
+	/** Blocks modified since the last update of the triangles */
+	std::set<uint64_t> m_modifiedBlocks;
+	/** Ranges of triangles of removed blocks, to be cleared */
+	std::vector<std::pair<size_t, size_t>> m_freedTriangles;
+	/** Triangles in m_triangles not used by any voxel */
+	size_t m_unusedTriangles = 0;
+	/** Whether all triangles have to be regenerated, i.e. something else than
+	 * the contents of blocks changed since the last update */
+	bool m_regenerateAllTriangles = true;
+	/** changeGeneration() after the last change of blocks, or update of the
+	 * triangles. Any other change makes m_regenerateAllTriangles true. */
+	uint64_t m_knownChangeGeneration = 0;
+
+	/** Index of blocks for getVoxel() and getGridCube(): the IDs of all
+	 * blocks, and the number of voxels (of each set) and grid cubes in all
+	 * blocks before each one. Rebuilt after blocks are added or resized. */
+	mutable std::vector<uint64_t> m_indexBlockIDs;
+	mutable std::vector<std::vector<size_t>> m_indexVoxelsBefore;
+	mutable std::vector<size_t> m_indexGridCubesBefore;
+	mutable bool m_indexValid = false;
+
+	/** Calls notifyChange() for a change in the contents of blocks, which
+	 * does not require regenerating the triangles of other blocks */
+	void notifyBlocksChange();
+	void clearBlocks();
+	void updateBlocksIndex() const;
+	/** Finds the block holding the idx-th voxel or grid cube of all blocks,
+	 * returning its ID and the index within the block in `idx`. */
+	uint64_t findBlockOfVoxel(size_t set_index, size_t& idx) const;
+	uint64_t findBlockOfGridCube(size_t& idx) const;
 };
 
 }  // namespace mrpt::opengl
@@ -45,6 +45,10 @@ namespace opengl
 {
 /** Template class that implements the data structure and algorithms for
  * Octree-based efficient rendering.
+ *
+ * All points must be in memory. For clouds too large for that, see the
+ * out-of-core octree in mrpt::opengl::CPointCloudLOD.
+ *
  *  \sa mrpt::opengl::CPointCloud, mrpt::opengl::CPointCloudColoured,
  * https://www.mrpt.org/Efficiently_rendering_point_clouds_of_millions_of_points
  * \ingroup mrpt_opengl_grp
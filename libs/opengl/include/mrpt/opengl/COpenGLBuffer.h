@@ -81,6 +81,16 @@ class COpenGLBuffer
 		m_impl->allocate(data, byteCount);
 	}
 
+	/** Overwrites byteCount bytes of the buffer, starting at byte
+	 * byteOffset, with the provided data. The buffer size does not change,
+	 * so the range must be within the size given to allocate().
+	 * bind() must be called before using this method.
+	 */
+	void update(int byteOffset, const void* data, int byteCount)
+	{
+		m_impl->update(byteOffset, data, byteCount);
+	}
+
    private:
 	struct RAII_Impl
 	{
@@ -95,6 +105,7 @@ class COpenGLBuffer
 		void bind();
 		void unbind();
 		void allocate(const void* data, int byteCount);
+		void update(int byteOffset, const void* data, int byteCount);
 
 		bool created = false;
 		unsigned int buffer_id = 0;
@@ -12,6 +12,8 @@
 #include <mrpt/opengl/COpenGLViewport.h>
 #include <mrpt/opengl/CRenderizable.h>
 
+#include <optional>
+
 /** The namespace for 3D scene representation and rendering. See also the <a
  * href="mrpt-opengl.html" > summary page</a> of the mrpt-opengl library for
  * more info and thumbnails of many of the render primitive.
@@ -59,6 +61,7 @@ namespace mrpt::opengl
  */
 class COpenGLScene : public mrpt::serialization::CSerializable
 {
+	friend class CChunkedSceneFile;
 	DEFINE_SERIALIZABLE(COpenGLScene, mrpt::opengl)
    public:
 	using TListViewports = std::vector<COpenGLViewport::Ptr>;
@@ -193,21 +196,43 @@ class COpenGLScene : public mrpt::serialization::CSerializable
 
 	/** Saves the scene to a [".3Dscene" file](robotics_file_formats.html),
 	 * loadable by: \ref app_SceneViewer3D
+	 * \param chunked If true, objects are compressed and indexed one by one
+	 * (see CChunkedSceneFile), so big scenes are saved and loaded much
+	 * faster, in parallel, and can be shown while loading. Such files cannot
+	 * be read by MRPT versions older than 2.4.2 (New in MRPT 2.4.2).
 	 * \sa loadFromFile
 	 * \return false on any error.
 	 */
-	bool saveToFile(const std::string& fil) const;
+	bool saveToFile(const std::string& fil, bool chunked = false) const;
 
-	/** Loads the scene from a [".3Dscene" file](robotics_file_formats.html).
+	/** Loads the scene from a [".3Dscene" file](robotics_file_formats.html),
+	 * in any of the formats of saveToFile().
 	 * \sa saveToFile
 	 * \return false on any error.
 	 */
 	bool loadFromFile(const std::string& fil);
 
 	/** Traces a ray
+	 * \sa traceRays()
 	 */
 	bool traceRay(const mrpt::poses::CPose3D& o, double& dist) const;
 
+	/** Traces a batch of rays, with the same result than calling traceRay()
+	 * for each one, but much faster for many rays: objects are indexed in a
+	 * bounding volume hierarchy (BVH) of their bounding boxes, so each ray is
+	 * only traced against the objects whose boxes it goes through, and rays
+	 * are traced in parallel with mrpt::WorkerThreadsPool::Default().
+	 *
+	 * Ray `i` starts at the origin of `rays[i]` and goes along its +X axis.
+	 * Returns the distance to the closest hit for each ray, or an empty
+	 * optional if it hits nothing. Objects must not be modified while this
+	 * method runs.
+	 *
+	 * \note (New in MRPT 2.4.2)
+	 */
+	std::vector<std::optional<double>> traceRays(
+		const std::vector<mrpt::poses::CPose3D>& rays) const;
+
 	/** Evaluates the bounding box of the scene in the given viewport (default:
 	 * "main"). */
 	mrpt::math::TBoundingBox getBoundingBox(
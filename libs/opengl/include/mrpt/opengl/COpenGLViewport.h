@@ -15,6 +15,7 @@
 #include <mrpt/opengl/CSetOfObjects.h>
 #include <mrpt/opengl/CTextMessageCapable.h>
 #include <mrpt/opengl/CTexturedPlane.h>
+#include <mrpt/opengl/RenderQueue.h>
 #include <mrpt/opengl/Shader.h>
 #include <mrpt/opengl/TLightParameters.h>
 #include <mrpt/opengl/TRenderMatrices.h>
@@ -139,6 +140,35 @@ class COpenGLViewport : public mrpt::serialization::CSerializable,
 	const TLightParameters& lightParameters() const { return m_lights; }
 	TLightParameters& lightParameters() { return m_lights; }
 
+	/** Skip objects out of the camera view frustum, by testing their
+	 * bounding boxes on the CPU before sending them to the GPU
+	 * (Default: false). Objects whose bounding box is a single point (e.g.
+	 * CText, sized in pixels) are never skipped. Custom classes must return
+	 * an enclosing box from getBoundingBox() for this to be safe.
+	 * \sa lastCulledObjectsCount() */
+	void enableFrustumCulling(bool enable = true) { m_frustumCulling = enable; }
+	bool isFrustumCullingEnabled() const { return m_frustumCulling; }
+
+	/** Render objects with identical geometry (e.g. thousands of CAxis or
+	 * CEllipsoid3D objects) with the buffers of one shared prototype,
+	 * instead of generating and uploading buffers for each of them
+	 * (Default: true). \sa CRenderizable::instancingKey() */
+	void enableInstancing(bool enable = true) { m_instancing = enable; }
+	bool isInstancingEnabled() const { return m_instancing; }
+
+	/** Build the queue of objects to render in parallel, using the threads of
+	 * mrpt::WorkerThreadsPool::Default(), for lists of many objects
+	 * (Default: false). Objects must not be inserted more than once in the
+	 * scene if enabled. */
+	void enableParallelRenderQueue(bool enable = true)
+	{
+		m_parallelRenderQueue = enable;
+	}
+	bool isParallelRenderQueueEnabled() const { return m_parallelRenderQueue; }
+
+	/** Number of objects skipped by frustum culling in the last render. */
+	size_t lastCulledObjectsCount() const { return m_lastCulledObjects; }
+
 	/** @} */
 
 	/** @name Change or read viewport properties (except "viewport modes")
@@ -228,6 +258,9 @@ class COpenGLViewport : public mrpt::serialization::CSerializable,
 		return m_background_color;
 	}
 
+	/** Whether setCustomBackgroundColor() has been called */
+	bool hasCustomBackgroundColor() const { return m_custom_backgb_color; }
+
 	/** Compute the 3D ray corresponding to a given pixel; this can be used to
 	 * allow the user to pick and select 3D objects by clicking onto the 2D
 	 * image.
@@ -365,6 +398,19 @@ class COpenGLViewport : public mrpt::serialization::CSerializable,
 
 	void updateMatricesFromCamera() const;
 
+	/** Like updateMatricesFromCamera(), for a viewport of the given size in
+	 * pixels, so it can be used without calling render() first, e.g. from
+	 * renderers without OpenGL.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	void updateMatricesFromCamera(int viewportWidth, int viewportHeight) const;
+
+	/** The objects rendered in this viewport: its own objects, or those of
+	 * another viewport if it is a clone (see setCloneView()).
+	 * \note (New in MRPT 2.4.2)
+	 */
+	const CListOpenGLObjects& objectsToRender() const;
+
 	/** Provides read access to the opengl shaders */
 	const std::map<shader_id_t, mrpt::opengl::Program::Ptr>& shaders() const
 	{
@@ -452,7 +498,7 @@ class COpenGLViewport : public mrpt::serialization::CSerializable,
 	/** Default shader program */
 	mutable std::map<shader_id_t, mrpt::opengl::Program::Ptr> m_shaders;
 
-	/** Unload shader programs in m_shaders */
+	/** Unload shader programs in m_shaders, and instancing prototypes */
 	void unloadShaders();
 
 	/** The list of objects that comprise the 3D scene.
@@ -466,6 +512,12 @@ class COpenGLViewport : public mrpt::serialization::CSerializable,
 	// OpenGL global settings:
 	bool m_OpenGL_enablePolygonNicest{true};
 
+	bool m_frustumCulling{false};
+	bool m_instancing{true};
+	bool m_parallelRenderQueue{false};
+	mutable size_t m_lastCulledObjects{0};
+	mutable RenderInstancingCache m_instancingCache;
+
 	TLightParameters m_lights;
 
 	/** Renders all messages in the underlying class CTextMessageCapable */
@@ -14,6 +14,8 @@
 #include <mrpt/opengl/PLY_import_export.h>
 #include <mrpt/opengl/pointcloud_adapters.h>
 
+#include <array>
+
 namespace mrpt::opengl
 {
 /** A cloud of points, all with the same color or each depending on its value
@@ -98,9 +100,7 @@ class CPointCloud : public CRenderizableShaderPoints,
 	mrpt::math::TBoundingBox getBoundingBox() const override
 	{
 		if (empty()) return {};
-		if (auto bb = this->octree_getBoundingBox(); bb) return *bb;
-		else
-			return {};
+		return verticesBoundingBox().compose(m_pose);
 	}
 
 	/** @name Read/Write of the list of points to render
@@ -160,7 +160,9 @@ class CPointCloud : public CRenderizableShaderPoints,
 
 	bool empty() const { return m_points.empty(); }
 
-	/** Adds a new point to the cloud */
+	/** Adds a new point to the cloud. Only the new points are copied to the
+	 * GPU in the next render, unless the depth range used for colors grows.
+	 */
 	void insertPoint(float x, float y, float z);
 
 	void insertPoint(const mrpt::math::TPoint3Df& p)
@@ -197,7 +199,8 @@ class CPointCloud : public CRenderizableShaderPoints,
 	{
 		m_points[i] = {x, y, z};
 		m_minmax_valid = false;
-		markAllPointsAsNew();
+		octree_mark_as_outdated();
+		markPointsAsModified(i, i + 1);
 	}
 
 	/** Load the points from any other point map class supported by the
@@ -236,16 +239,19 @@ class CPointCloud : public CRenderizableShaderPoints,
 	void enableColorFromX(bool v = true)
 	{
 		m_colorFromDepth = v ? CPointCloud::colX : CPointCloud::colNone;
+		m_minmax_valid = false;
 		CRenderizable::notifyChange();
 	}
 	void enableColorFromY(bool v = true)
 	{
 		m_colorFromDepth = v ? CPointCloud::colY : CPointCloud::colNone;
+		m_minmax_valid = false;
 		CRenderizable::notifyChange();
 	}
 	void enableColorFromZ(bool v = true)
 	{
 		m_colorFromDepth = v ? CPointCloud::colZ : CPointCloud::colNone;
+		m_minmax_valid = false;
 		CRenderizable::notifyChange();
 	}
 
@@ -282,6 +288,10 @@ class CPointCloud : public CRenderizableShaderPoints,
 	/** Color linear function slope */
 	mutable mrpt::img::TColorf m_col_slop, m_col_slop_inv;
 	mutable bool m_minmax_valid{false};
+	/** Number of points (from the first one) included in m_min/m_max */
+	mutable size_t m_minmax_count{0};
+	/** The parameters the colors in the buffer were generated with */
+	std::array<float, 13> m_bufferColorParams{};
 
 	/** The colors used to interpolate when m_colorFromDepth is true. */
 	mrpt::img::TColorf m_colorFromDepth_min = {0, 0, 0},
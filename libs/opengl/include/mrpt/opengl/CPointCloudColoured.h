@@ -52,7 +52,7 @@ class CPointCloudColoured : public CRenderizableShaderPoints,
    public:
 	void onUpdateBuffers_Points() override;
 
-	CPointCloudColoured() = default;
+	CPointCloudColoured() { m_incrementalPointsUpdate = true; }
 	virtual ~CPointCloudColoured() override = default;
 
 	void markAllPointsAsNew();
@@ -63,15 +63,14 @@ class CPointCloudColoured : public CRenderizableShaderPoints,
 	mrpt::math::TBoundingBox getBoundingBox() const override
 	{
 		if (empty()) return {};
-		if (auto bb = this->octree_getBoundingBox(); bb) return *bb;
-		else
-			return {};
+		return verticesBoundingBox().compose(m_pose);
 	}
 
 	/** @name Read/Write of the list of points to render
 		@{ */
 
-	/** Inserts a new point into the point cloud. */
+	/** Inserts a new point into the point cloud. Only the new points are
+	 * copied to the GPU in the next render. */
 	void push_back(
 		float x, float y, float z, float R, float G, float B, float A = 1);
 
@@ -108,7 +107,8 @@ class CPointCloudColoured : public CRenderizableShaderPoints,
 	{
 		m_points[i] = p.pt;
 		m_point_colors[i] = mrpt::img::TColor(p.r, p.g, p.b, p.a);
-		markAllPointsAsNew();
+		octree_mark_as_outdated();
+		markPointsAsModified(i, i + 1);
 	}
 
 	/** Like \a setPoint() but does not check for index out of bounds */
@@ -116,7 +116,8 @@ class CPointCloudColoured : public CRenderizableShaderPoints,
 		const size_t i, const float x, const float y, const float z)
 	{
 		m_points[i] = {x, y, z};
-		markAllPointsAsNew();
+		octree_mark_as_outdated();
+		markPointsAsModified(i, i + 1);
 	}
 
 	/** Like \c setPointColor but without checking for out-of-index erors */
@@ -127,6 +128,7 @@ class CPointCloudColoured : public CRenderizableShaderPoints,
 		m_point_colors[index].G = f2u8(G);
 		m_point_colors[index].B = f2u8(B);
 		m_point_colors[index].A = f2u8(A);
+		markPointsAsModified(index, index + 1);
 	}
 	void setPointColor_u8_fast(
 		size_t index, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 0xff)
@@ -135,6 +137,7 @@ class CPointCloudColoured : public CRenderizableShaderPoints,
 		m_point_colors[index].G = g;
 		m_point_colors[index].B = b;
 		m_point_colors[index].A = a;
+		markPointsAsModified(index, index + 1);
 	}
 	/** Like \c getPointColor but without checking for out-of-index erors */
 	void getPointColor_fast(size_t index, float& R, float& G, float& B) const
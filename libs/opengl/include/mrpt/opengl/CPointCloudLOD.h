@@ -0,0 +1,85 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/opengl/CRenderizableShaderPoints.h>
+#include <mrpt/opengl/PointCloudLODOctree.h>
+
+namespace mrpt::opengl
+{
+/** A huge point cloud, streamed from a level-of-detail octree file created
+ * with PointCloudLODOctree::Build().
+ *
+ * Only the points of the octree nodes selected for the current view are
+ * kept in memory and in the GPU buffers, so clouds much larger than the
+ * available memory can be viewed. Each time it is rendered, this object
+ * selects the nodes for the view and asks for the missing ones to be loaded
+ * in the background; the buffers are updated with the new set of points in
+ * the next rendered frame, so views should be redrawn while nodes are being
+ * loaded (see PointCloudLODOctree::loadedNodesCounter()).
+ *
+ * The object only stores the octree file name when serialized.
+ *
+ * \sa PointCloudLODOctree, CPointCloudColoured
+ * \ingroup mrpt_opengl_grp
+ * \note (New in MRPT 2.4.2)
+ */
+class CPointCloudLOD : public CRenderizableShaderPoints
+{
+	DEFINE_SERIALIZABLE(CPointCloudLOD, mrpt::opengl)
+
+   public:
+	CPointCloudLOD() = default;
+	/** Constructor which calls loadFromFile() */
+	explicit CPointCloudLOD(const std::string& lodOctreeFile);
+	/** Copies open the same octree file. */
+	CPointCloudLOD(const CPointCloudLOD& o);
+	CPointCloudLOD& operator=(const CPointCloudLOD&) = delete;
+	virtual ~CPointCloudLOD() override = default;
+
+	/** Opens an octree file created with PointCloudLODOctree::Build().
+	 * \exception std::exception On I/O errors or invalid file format.
+	 */
+	void loadFromFile(const std::string& lodOctreeFile);
+	const std::string& getFileName() const { return m_fileName; }
+
+	/** Read-only access to the octree, e.g. to check the number of nodes
+	 * and points in memory. */
+	const PointCloudLODOctree& octree() const { return m_octree; }
+
+	/** Parameters of the LOD selection for each view */
+	PointCloudLODOctree::SelectionParameters selectionParameters;
+
+	/** See PointCloudLODOctree::setMemoryBudget() */
+	void setMemoryBudget(size_t bytes) { m_octree.setMemoryBudget(bytes); }
+
+	/** Number of points in the GPU buffers */
+	size_t getActuallyRenderedPointsCount() const
+	{
+		return m_vertex_buffer_data.size();
+	}
+
+	void render(const RenderContext& rc) const override;
+	void onUpdateBuffers_Points() override;
+
+	mrpt::math::TBoundingBox getBoundingBox() const override;
+
+   private:
+	std::string m_fileName;
+	mutable PointCloudLODOctree m_octree;
+
+	/** Nodes selected in the last render() */
+	mutable std::vector<uint32_t> m_selected;
+	/** Nodes selected, and value of loadedNodesCounter(), when the buffers
+	 * were last updated */
+	std::vector<uint32_t> m_bufferNodes;
+	uint64_t m_bufferLoadCounter = 0;
+};
+
+}  // namespace mrpt::opengl
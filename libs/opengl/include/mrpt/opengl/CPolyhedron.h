@@ -52,8 +52,9 @@ class CPolyhedron : public CRenderizableShaderWireFrame,
 
 	virtual shader_list_t requiredShaders() const override
 	{
-		// May use up to two shaders (triangles and lines):
-		return {DefaultShaderID::WIREFRAME, DefaultShaderID::TRIANGLES};
+		// Either triangles or lines:
+		if (m_Wireframe) return {DefaultShaderID::WIREFRAME};
+		return {DefaultShaderID::TRIANGLES};
 	}
 	void onUpdateBuffers_Wireframe() override;
 	void onUpdateBuffers_Triangles() override;
@@ -306,6 +306,7 @@ class CRenderizable : public mrpt::serialization::CSerializable
 	{
 		renderUpdateBuffers();
 		const_cast<CRenderizable&>(*this).m_outdatedBuffers = false;
+		m_cachedBBoxValid = false;
 	}
 
 	/** Call to enable calling renderUpdateBuffers() before the next
@@ -313,14 +314,43 @@ class CRenderizable : public mrpt::serialization::CSerializable
 	void notifyChange() const
 	{
 		const_cast<CRenderizable&>(*this).m_outdatedBuffers = true;
+		m_outdatedCPUBuffers = true;
+		m_cachedBBoxValid = false;
+		m_changeGeneration = NewChangeGeneration();
 	}
 
+	/** Returns a value unique among all objects, which changes with each
+	 * call to notifyChange(). Used by renderers to tell whether data cached
+	 * for an object (e.g. textures) is still valid, even if another object
+	 * has been created later at the same memory address.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	uint64_t changeGeneration() const { return m_changeGeneration; }
+
 	/** Returns whether notifyChange() has been invoked since the last call
 	 * to renderUpdateBuffers(), meaning the latter needs to be called again
 	 * before rendering.
 	 */
 	bool hasToUpdateBuffers() const { return m_outdatedBuffers; }
 
+	/** Regenerates the vertex data of all the shader base classes of this
+	 * object (e.g. the triangles returned by
+	 * CRenderizableShaderTriangles::shaderTexturedTrianglesBuffer()), without
+	 * uploading anything to OpenGL, if notifyChange() has been invoked since
+	 * the last call. Used by renderers without an OpenGL context, like the
+	 * software mode of CFBORender. Returns true if the data was regenerated.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	bool updateCPUBuffers() const;
+
+	/** Called from updateCPUBuffers(). The default implementation calls the
+	 * onUpdateBuffers_*() methods of all the shader base classes. Derived
+	 * classes doing additional work in renderUpdateBuffers() must override
+	 * it too.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	virtual void onUpdateCPUBuffers();
+
 	/** Simulation of ray-trace, given a pose. Returns true if the ray
 	 * effectively collisions with the object (returning the distance to the
 	 * origin of the ray in "dist"), or false in other case. "dist" variable
@@ -332,6 +362,13 @@ class CRenderizable : public mrpt::serialization::CSerializable
 	 * children) in the coordinate frame of the object parent. */
 	virtual auto getBoundingBox() const -> mrpt::math::TBoundingBox = 0;
 
+	/** Returns getBoundingBox(), which is only evaluated again after a call
+	 * to notifyChange() or a change in the object pose. Used for frustum
+	 * culling while rendering.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	const mrpt::math::TBoundingBox& cachedBoundingBox() const;
+
 	[[deprecated(
 		"Use getBoundingBox() const -> mrpt::math::TBoundingBox instead.")]]  //
 	void getBoundingBox(
@@ -362,6 +399,38 @@ class CRenderizable : public mrpt::serialization::CSerializable
 	 */
 	mrpt::opengl::CText& labelObject() const;
 
+	/** @name Instancing: sharing the OpenGL buffers of identical objects
+		@{ */
+
+	/** Derived classes supporting instancing return true, with a `key` that
+	 * uniquely identifies their geometry and appearance (including the
+	 * class name), and the transformation to apply to the prototype
+	 * returned by makeInstancingPrototype() for the same key, so it looks
+	 * like this object (in object local coordinates).
+	 *
+	 * Objects with the same key are then rendered with the buffers of a
+	 * single prototype, instead of generating and uploading their own.
+	 * Default: false (not supported).
+	 *
+	 * \sa RenderInstancingCache
+	 * \note (New in MRPT 2.4.2)
+	 */
+	virtual bool instancingKey(
+		[[maybe_unused]] std::string& key,
+		[[maybe_unused]] mrpt::math::CMatrixFloat44& instanceTransform) const
+	{
+		return false;
+	}
+
+	/** Creates the prototype for the key returned by instancingKey(). Only
+	 * called for classes supporting instancing. */
+	virtual CRenderizable::Ptr makeInstancingPrototype() const
+	{
+		THROW_EXCEPTION("Not implemented in derived class!");
+	}
+
+	/** @} */
+
 	/** Free opengl buffers */
 	virtual void freeOpenGLResources() = 0;
 
@@ -373,10 +442,29 @@ class CRenderizable : public mrpt::serialization::CSerializable
 	void readFromStreamRender(mrpt::serialization::CArchive& in);
 
 	bool m_outdatedBuffers = true;
+	/** Like m_outdatedBuffers, for updateCPUBuffers() */
+	mutable bool m_outdatedCPUBuffers = true;
 	mrpt::math::TPoint3Df m_representativePoint{0, 0, 0};
 
 	/** Optional pointer to a mrpt::opengl::CText */
 	mutable std::shared_ptr<mrpt::opengl::CText> m_label_obj;
+
+	/** Appends the raw bytes of the arguments to an instancing key */
+	template <typename... Args>
+	static void instancingKeyAppend(std::string& key, const Args&... args)
+	{
+		(key.append(reinterpret_cast<const char*>(&args), sizeof(args)), ...);
+	}
+
+   private:
+	static uint64_t NewChangeGeneration();
+	/** \sa changeGeneration() */
+	mutable uint64_t m_changeGeneration = NewChangeGeneration();
+
+	/** Cache for cachedBoundingBox() */
+	mutable bool m_cachedBBoxValid = false;
+	mutable mrpt::math::TBoundingBox m_cachedBBox;
+	mutable mrpt::poses::CPose3D m_cachedBBoxPose;
 };
 
 /** A list of smart pointers to renderizable objects */
@@ -400,17 +488,23 @@ enum class TCullFace : uint8_t
 @{ */
 
 /** Processes, recursively, all objects in the list, classifying them by shader
- * programs into a list suitable to be used within processPendingRendering()
+ * programs into a list suitable to be used within processRenderQueue()
  *
  * For each object in the list:
+ *   - updates its buffers, if needed
  *   - checks visibility of each object
+ *   - checks whether it is within the view frustum, if
+ * RenderQueue::frustumCulling is enabled
  *   - update the MODELVIEW matrix according to its coordinates
- *   - call its ::render()
+ *   - enqueues the object, or its instancing prototype if
+ * RenderQueue::instancing is set, and its children
  *   - shows its name (if enabled).
  *
+ * It does not call OpenGL functions by itself, except while updating buffers.
+ *
  * \note Used by CSetOfObjects and COpenGLViewport
  *
- * \sa processPendingRendering
+ * \sa processRenderQueue
  */
 void enqueForRendering(
 	const mrpt::opengl::CListOpenGLObjects& objs,
@@ -13,6 +13,9 @@
 #include <mrpt/opengl/COpenGLVertexArrayObject.h>
 #include <mrpt/opengl/CRenderizable.h>
 
+#include <limits>
+#include <utility>
+
 namespace mrpt::opengl
 {
 /** Renderizable generic renderer for objects using the points shader.
@@ -31,6 +34,14 @@ namespace mrpt::opengl
  * setVariablePointSize_k(), and setVariablePointSize_DepthScale(),
  * respectively.
  *
+ * By default, all points are uploaded to the GPU again after each change of
+ * the object. Derived classes may instead enable incremental updates (see
+ * m_incrementalPointsUpdate) and report which points changed with
+ * markPointsAsModified(), so that only those points are regenerated on the
+ * CPU and copied to the GPU buffers, e.g. the new points appended to a cloud
+ * which grows with each new scan. GPU buffers are then allocated with room
+ * for further points, so appending to them rarely requires reallocating.
+ *
  *  \sa opengl::COpenGLScene
  *
  * \ingroup mrpt_opengl_grp
@@ -54,6 +65,14 @@ class CRenderizableShaderPoints : public virtual CRenderizable
 	 * to be drawn in "m_*_buffer" fields. */
 	virtual void onUpdateBuffers_Points() = 0;
 
+	/** Calls onUpdateBuffers_Points() and returns the range of points
+	 * [first,last) which changed since the former call, i.e. those which have
+	 * to be copied to the GPU buffers. It is called from renderUpdateBuffers()
+	 * and does not use OpenGL, so the CPU cost of preparing the buffers can
+	 * be measured on its own.
+	 */
+	std::pair<size_t, size_t> prepareBuffers_Points() const;
+
 	/** By default is 1.0. \sa enableVariablePointSize() */
 	inline void setPointSize(float p) { m_pointSize = p; }
 	inline float getPointSize() const { return m_pointSize; }
@@ -85,6 +104,7 @@ class CRenderizableShaderPoints : public virtual CRenderizable
 	// See base docs
 	void freeOpenGLResources() override
 	{
+		m_buffersCapacity = 0;
 		m_vertexBuffer.destroy();
 		m_colorBuffer.destroy();
 		m_vao.destroy();
@@ -107,7 +127,9 @@ class CRenderizableShaderPoints : public virtual CRenderizable
 	mutable std::vector<mrpt::img::TColor> m_color_buffer_data;
 
 	/** Returns the bounding box of m_vertex_buffer_data, or (0,0,0)-(0,0,0) if
-	 * empty. */
+	 * empty. With m_incrementalPointsUpdate, only the points appended since
+	 * the former call are processed, unless markPointsAsModified() was called
+	 * for former points. */
 	const mrpt::math::TBoundingBox verticesBoundingBox() const;
 
 	float m_pointSize = 1.0f;
@@ -118,7 +140,41 @@ class CRenderizableShaderPoints : public virtual CRenderizable
 	void params_serialize(mrpt::serialization::CArchive& out) const;
 	void params_deserialize(mrpt::serialization::CArchive& in);
 
+	/** @name Incremental updates of the point buffers
+	 * @{ */
+
+	/** Derived classes set this to true if they report all the changes in
+	 * their points with markPointsAsModified() or markAllPointsAsModified().
+	 * If false (default), all points are regenerated and uploaded after any
+	 * call to notifyChange(). */
+	bool m_incrementalPointsUpdate = false;
+
+	/** Marks the points in [first,last) as modified, e.g. because they were
+	 * appended, and calls notifyChange(). Only the points marked since the
+	 * last buffers update are uploaded to the GPU. */
+	void markPointsAsModified(size_t first, size_t last) const;
+
+	/** All the points will be regenerated and uploaded again. Calls
+	 * notifyChange(). */
+	void markAllPointsAsModified() const;
+
+	/** The range [first,last) of points modified since the last buffers
+	 * update, to be used from onUpdateBuffers_Points(). It spans all points
+	 * after markAllPointsAsModified(), and it is empty if no point changed.
+	 */
+	std::pair<size_t, size_t> modifiedPointsRange() const;
+
+	/** @} */
+
    private:
+	mutable size_t m_modifiedFirst = 0;
+	mutable size_t m_modifiedLast = std::numeric_limits<size_t>::max();
+	/** Number of points which fit in the current GPU buffers */
+	mutable size_t m_buffersCapacity = 0;
+	/** verticesBoundingBox() of the first m_verticesBBoxCount points */
+	mutable mrpt::math::TBoundingBoxf m_verticesBBox;
+	mutable size_t m_verticesBBoxCount = 0;
+
 	mutable COpenGLBuffer m_vertexBuffer, m_colorBuffer;
 	mutable COpenGLVertexArrayObject m_vao;
 };
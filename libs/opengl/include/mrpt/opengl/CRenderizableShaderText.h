@@ -51,6 +51,19 @@ class CRenderizableShaderText : public virtual CRenderizable
 		m_vao.destroy();
 	}
 
+	/** @name Raw access to text shader buffer data
+	 * @{ */
+	const auto& shaderTextTrianglesBuffer() const { return m_triangles; }
+	const auto& shaderTextLinesVertexPointBuffer() const
+	{
+		return m_vertex_buffer_data;
+	}
+	const auto& shaderTextLinesVertexColorBuffer() const
+	{
+		return m_color_buffer_data;
+	}
+	/** @} */
+
    protected:
 	/** List of triangles  \sa TTriangle */
 	mutable std::vector<mrpt::opengl::TTriangle> m_triangles;
@@ -99,6 +99,10 @@ class CRenderizableShaderTexturedTriangles : public virtual CRenderizable
 	{
 		m_textureInterpolate = enable;
 	}
+	bool isTextureLinearInterpolationEnabled() const
+	{
+		return m_textureInterpolate;
+	}
 
 	/** @name Raw access to textured-triangle shader buffer data
 	 * @{ */
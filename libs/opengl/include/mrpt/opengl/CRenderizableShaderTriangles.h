@@ -14,9 +14,19 @@
 #include <mrpt/opengl/CRenderizable.h>
 #include <mrpt/opengl/TTriangle.h>
 
+#include <utility>
+#include <vector>
+
 namespace mrpt::opengl
 {
 /** Renderizable generic renderer for objects using the triangles shader.
+ *
+ * By default, all triangles are uploaded to the GPU again after each change
+ * of the object. Derived classes which regenerate only some of their
+ * triangles may instead enable incremental updates (see
+ * m_incrementalTrianglesUpdate) and report which triangles they rewrote with
+ * markTrianglesAsModified(), so that only those are copied to the GPU
+ * buffers. GPU buffers are then allocated with room for further triangles.
  *
  *  \sa opengl::COpenGLScene
  *
@@ -41,9 +51,18 @@ class CRenderizableShaderTriangles : public virtual CRenderizable
 	 * to be drawn in "m_*_buffer" fields. */
 	virtual void onUpdateBuffers_Triangles() = 0;
 
+	/** Calls onUpdateBuffers_Triangles() and returns the sorted, disjoint
+	 * ranges of triangles [first,last) which changed since the former call,
+	 * i.e. those which have to be copied to the GPU buffers. It is called
+	 * from renderUpdateBuffers() and does not use OpenGL.
+	 * \note (New in MRPT 2.4.2)
+	 */
+	std::vector<std::pair<size_t, size_t>> prepareBuffers_Triangles() const;
+
 	// See base docs
 	void freeOpenGLResources() override
 	{
+		m_buffersCapacity = 0;
 		m_trianglesBuffer.destroy();
 		m_vao.destroy();
 	}
@@ -71,7 +90,40 @@ class CRenderizableShaderTriangles : public virtual CRenderizable
 	void params_serialize(mrpt::serialization::CArchive& out) const;
 	void params_deserialize(mrpt::serialization::CArchive& in);
 
+	/** @name Incremental updates of the triangle buffers
+	 * @{ */
+
+	/** Derived classes set this to true if their onUpdateBuffers_Triangles()
+	 * reports all the triangles it rewrites with markTrianglesAsModified().
+	 * If false (default), all triangles are uploaded after any call to
+	 * notifyChange(). */
+	bool m_incrementalTrianglesUpdate = false;
+
+	/** Marks the triangles in [first,last) of m_triangles as modified. Only
+	 * the triangles marked since the last buffers update are uploaded to the
+	 * GPU. Unlike CRenderizableShaderPoints::markPointsAsModified(), it does
+	 * not call notifyChange(), since it is meant to be called from within
+	 * onUpdateBuffers_Triangles(). */
+	void markTrianglesAsModified(size_t first, size_t last) const;
+
+	/** All the triangles will be uploaded again. Does not call
+	 * notifyChange(). */
+	void markAllTrianglesAsModified() const;
+
+	/** The sorted, disjoint ranges [first,last) of triangles modified since
+	 * the last buffers update. A single range spans all triangles after
+	 * markAllTrianglesAsModified(), and it is empty if no triangle changed.
+	 */
+	std::vector<std::pair<size_t, size_t>> modifiedTrianglesRanges() const;
+
+	/** @} */
+
    private:
+	mutable std::vector<std::pair<size_t, size_t>> m_modifiedRanges;
+	mutable bool m_allRangesModified = true;
+	/** Number of triangles which fit in the current GPU buffer */
+	mutable size_t m_buffersCapacity = 0;
+
 	mutable COpenGLBuffer m_trianglesBuffer;
 	mutable COpenGLVertexArrayObject m_vao;
 
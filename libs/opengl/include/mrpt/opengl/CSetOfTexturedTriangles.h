@@ -8,6 +8,7 @@
    +------------------------------------------------------------------------+ */
 #pragma once
 
+#include <mrpt/opengl/BoundingVolumeHierarchy.h>
 #include <mrpt/opengl/CRenderizableShaderTexturedTriangles.h>
 
 namespace mrpt::opengl
@@ -38,6 +39,7 @@ class CSetOfTexturedTriangles : public CRenderizableShaderTexturedTriangles
 	void clearTriangles()
 	{
 		m_triangles.clear();
+		m_trianglesBVHUpToDate = false;
 		CRenderizable::notifyChange();
 	}
 	size_t getTrianglesCount() const { return m_triangles.size(); }
@@ -55,10 +57,26 @@ class CSetOfTexturedTriangles : public CRenderizableShaderTexturedTriangles
 	void insertTriangle(const TTriangle& t)
 	{
 		m_triangles.push_back(t);
+		m_trianglesBVHUpToDate = false;
+		CRenderizable::notifyChange();
+	}
+	/** Inserts a set of triangles, bounded by iterators.
+	 * \note (New in MRPT 2.4.2) */
+	template <class InputIterator>
+	void insertTriangles(const InputIterator& begin, const InputIterator& end)
+	{
+		m_triangles.insert(m_triangles.end(), begin, end);
+		m_trianglesBVHUpToDate = false;
 		CRenderizable::notifyChange();
 	}
 
 	bool traceRay(const mrpt::poses::CPose3D& o, double& dist) const override;
+
+   protected:
+	/** Triangles index used for ray tracing, and whether it needs to be
+	 * rebuilt */
+	mutable mrpt::opengl::TriangleBVH m_trianglesBVH;
+	mutable bool m_trianglesBVHUpToDate{false};
 };
 
 }  // namespace mrpt::opengl
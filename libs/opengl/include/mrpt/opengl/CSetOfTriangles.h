@@ -9,6 +9,7 @@
 #pragma once
 
 #include <mrpt/math/geometry.h>
+#include <mrpt/opengl/BoundingVolumeHierarchy.h>
 #include <mrpt/opengl/CRenderizableShaderTriangles.h>
 
 namespace mrpt::opengl
@@ -41,6 +42,7 @@ class CSetOfTriangles : public CRenderizableShaderTriangles
 	{
 		m_triangles.clear();
 		polygonsUpToDate = false;
+		m_trianglesBVHUpToDate = false;
 		CRenderizable::notifyChange();
 	}
 
@@ -58,6 +60,7 @@ class CSetOfTriangles : public CRenderizableShaderTriangles
 	{
 		m_triangles.push_back(t);
 		polygonsUpToDate = false;
+		m_trianglesBVHUpToDate = false;
 		CRenderizable::notifyChange();
 	}
 
@@ -69,6 +72,7 @@ class CSetOfTriangles : public CRenderizableShaderTriangles
 	{
 		m_triangles.insert(m_triangles.end(), begin, end);
 		polygonsUpToDate = false;
+		m_trianglesBVHUpToDate = false;
 		CRenderizable::notifyChange();
 	}
 
@@ -150,8 +154,13 @@ class CSetOfTriangles : public CRenderizableShaderTriangles
 	 */
 	mutable bool polygonsUpToDate{false};
 
-	/** Polygon cache, used for ray-tracing only */
+	/** Polygon cache, returned by getPolygons() */
 	mutable std::vector<mrpt::math::TPolygonWithPlane> m_polygons;
+
+	/** Triangles index used for ray tracing, and whether it needs to be
+	 * rebuilt */
+	mutable mrpt::opengl::TriangleBVH m_trianglesBVH;
+	mutable bool m_trianglesBVHUpToDate{false};
 };
 /** Inserts a set of triangles into the list; note that this method allows to
  * pass another CSetOfTriangles as argument. Allows call chaining.
@@ -26,6 +26,7 @@ class CSphere : public CGeneralizedEllipsoidTemplate<3>
 
    public:
 	void renderUpdateBuffers() const override;
+	void onUpdateCPUBuffers() override;
 
 	void setRadius(float r)
 	{
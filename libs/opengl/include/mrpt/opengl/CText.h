@@ -61,6 +61,15 @@ class CText : public CRenderizableShaderText
 	}
 	void render(const RenderContext& rc) const override;
 
+	/** Computes the matrix which transforms the text vertices into clip
+	 * coordinates, so the text faces the viewer with a constant height in
+	 * pixels, given the rendering matrices of this object. Returns false if
+	 * the text cannot be rendered (e.g. invalid viewport size).
+	 * \note (New in MRPT 2.4.2)
+	 */
+	bool computeTextMatrix(
+		const TRenderMatrices& state, mrpt::math::CMatrixFloat44& mv) const;
+
 	/** Evaluates the bounding box of this object (including possible children)
 	 * in the coordinate frame of the object parent. */
 	mrpt::math::TBoundingBox getBoundingBox() const override;
@@ -40,6 +40,7 @@ class CTexturedPlane : public CRenderizableShaderTexturedTriangles,
 	void renderUpdateBuffers() const override;
 	virtual void onUpdateBuffers_TexturedTriangles() override;
 	virtual void onUpdateBuffers_Triangles() override;
+	void onUpdateCPUBuffers() override;
 	virtual shader_list_t requiredShaders() const override
 	{
 		return {
@@ -0,0 +1,208 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/math/TBoundingBox.h>
+#include <mrpt/math/TPoint3D.h>
+#include <mrpt/opengl/TRenderMatrices.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mrpt::opengl
+{
+/** An out-of-core, level-of-detail (LOD) octree for point clouds too large to
+ * be kept in memory, e.g. survey maps of hundreds of millions of points.
+ *
+ * The octree is created once with Build(), which writes it to a file. Each
+ * node keeps a spatially uniform subsample of the points within its cubic
+ * cell (one point per cell of a `gridResolution`^3 grid), and the remaining
+ * points go down to its children, so the union of the points of a node and
+ * all its ancestors is the original cloud at full density over that cell.
+ *
+ * At run time, open() only reads the (small) table of nodes. Then, for each
+ * camera view:
+ *  - selectNodes() does frustum culling and LOD selection on the CPU: nodes
+ * are refined while the spacing of their points projects onto more than
+ * `maxPixelSpacing` pixels, largest nodes on screen first, until a point
+ * budget is reached. It only uses the node table, so it can be evaluated
+ * (and benchmarked) without any OpenGL context.
+ *  - requestNodes() tells the background loader thread which nodes are
+ * wanted, in priority order. Nodes not in memory are read from the file,
+ * while those not used recently are evicted to keep the point data under
+ * the memory budget (see setMemoryBudget()).
+ *  - nodePoints() returns the points of a node if already in memory.
+ *
+ * Usage:
+ * \code
+ * mrpt::opengl::PointCloudLODOctree::Build(points, "map.lodoctree");
+ *
+ * mrpt::opengl::PointCloudLODOctree lod;
+ * lod.open("map.lodoctree");
+ * std::vector<uint32_t> ids;
+ * lod.selectNodes(renderMatrices, ids);
+ * lod.requestNodes(ids);
+ * for (auto id : ids)
+ *   if (auto pts = lod.nodePoints(id); pts) { ... draw *pts ... }
+ * \endcode
+ *
+ * \sa CPointCloudLOD, COctreePointRenderer
+ * \ingroup mrpt_opengl_grp
+ * \note (New in MRPT 2.4.2)
+ */
+class PointCloudLODOctree
+{
+   public:
+	using point_t = mrpt::math::TPointXYZfRGBAu8;
+
+	/** Value in Node::child for nonexistent children. */
+	static constexpr uint32_t INVALID_NODE = 0xffffffff;
+
+	/** A node of the tree. The root is node 0, and nodes are stored in
+	 * depth-first order. */
+	struct Node
+	{
+		/** The cubic cell of this node */
+		mrpt::math::TBoundingBoxf box;
+		/** Children indices, or INVALID_NODE. The i-th child covers the
+		 * octant with x,y,z in the upper half for bits 0,1,2 of i set. */
+		std::array<uint32_t, 8> child;
+		/** Approximate distance between neighboring points of this node */
+		float spacing = 0;
+		uint32_t level = 0;
+		uint32_t pointCount = 0;
+		/** Offset of the first point of this node in the file */
+		uint64_t fileOffset = 0;
+
+		bool isLeaf() const
+		{
+			for (const auto c : child)
+				if (c != INVALID_NODE) return false;
+			return true;
+		}
+	};
+
+	struct BuildParameters
+	{
+		BuildParameters() = default;
+
+		/** Nodes with up to this number of points are not split. */
+		size_t maxLeafPoints = 20000;
+		/** Inner nodes keep one point per cell of a grid of this size
+		 * (along each axis) over their box. */
+		uint32_t gridResolution = 64;
+		/** Nodes at this depth are not split, whatever their size. */
+		uint32_t maxDepth = 16;
+	};
+
+	/** Creates the octree for the given points and saves it to a file.
+	 * The input cloud has to fit in memory while building the tree, but
+	 * not when using it afterwards.
+	 * \exception std::exception On I/O errors.
+	 */
+	static void Build(
+		const std::vector<point_t>& points, const std::string& fileName,
+		const BuildParameters& params);
+	/** \overload With default parameters */
+	static void Build(
+		const std::vector<point_t>& points, const std::string& fileName)
+	{
+		Build(points, fileName, BuildParameters());
+	}
+
+	PointCloudLODOctree();
+	~PointCloudLODOctree();
+
+	PointCloudLODOctree(const PointCloudLODOctree&) = delete;
+	PointCloudLODOctree& operator=(const PointCloudLODOctree&) = delete;
+
+	/** Reads the node table of a file created with Build() and starts the
+	 * loader thread. Former contents, if any, are closed first.
+	 * \exception std::exception On I/O errors or invalid file format.
+	 */
+	void open(const std::string& fileName);
+	/** Stops the loader thread and frees all nodes. */
+	void close();
+	bool isOpen() const;
+	const std::string& fileName() const;
+
+	const std::vector<Node>& nodes() const;
+	/** Total number of points in all nodes (the size of the original
+	 * cloud) */
+	uint64_t totalPointCount() const;
+	/** Box of the root node, or an empty box if the tree is empty */
+	mrpt::math::TBoundingBoxf boundingBox() const;
+
+	struct SelectionParameters
+	{
+		SelectionParameters() = default;
+
+		/** Nodes are refined while the spacing between their points
+		 * projects onto more than this number of pixels. */
+		float maxPixelSpacing = 2.0f;
+		/** Maximum number of points in all selected nodes. */
+		size_t pointBudget = 5'000'000;
+	};
+
+	/** Finds the nodes to draw for a camera, with frustum culling and LOD
+	 * selection as explained in the class description. The output is
+	 * sorted by decreasing priority (size on the screen), and a node is
+	 * only selected if its parent is selected too.
+	 *
+	 * \param[in] state The rendering matrices, where `mv_matrix` must
+	 * include the pose of the cloud, as for CRenderizable::render().
+	 */
+	void selectNodes(
+		const mrpt::opengl::TRenderMatrices& state,
+		std::vector<uint32_t>& selected,
+		const SelectionParameters& params) const;
+	/** \overload With default parameters */
+	void selectNodes(
+		const mrpt::opengl::TRenderMatrices& state,
+		std::vector<uint32_t>& selected) const
+	{
+		selectNodes(state, selected, SelectionParameters());
+	}
+
+	/** Maximum number of bytes of point data to keep in memory (Default:
+	 * 512 MiB). Nodes requested with requestNodes() are never evicted to
+	 * make room for others, so this should be larger than the point budget
+	 * of selectNodes() times sizeof(point_t). */
+	void setMemoryBudget(size_t bytes);
+	size_t getMemoryBudget() const;
+
+	/** Bytes of point data currently in memory */
+	size_t residentMemory() const;
+	size_t residentNodeCount() const;
+
+	/** Marks the given nodes as the ones in use, and queues the loading of
+	 * those not in memory, in the given order, replacing the former queue.
+	 * Returns immediately. */
+	void requestNodes(const std::vector<uint32_t>& ids);
+
+	/** Blocks until the loader thread has processed all requested nodes. */
+	void waitForPendingLoads() const;
+
+	/** The points of a node, or an empty pointer if they are not in memory.
+	 * The returned data remains valid even if the node is evicted later. */
+	std::shared_ptr<const std::vector<point_t>> nodePoints(uint32_t id) const;
+
+	/** Number of nodes read from the file so far. It can be polled to find
+	 * out whether new nodes are available. */
+	uint64_t loadedNodesCounter() const;
+
+   private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
+
+}  // namespace mrpt::opengl
@@ -14,6 +14,11 @@
 #include <cstdint>
 #include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace mrpt::opengl
 {
@@ -27,23 +32,160 @@ struct RenderQueueElement
 	RenderQueueElement() = default;
 
 	RenderQueueElement(
-		const mrpt::opengl::CRenderizable* obj,
-		const mrpt::opengl::TRenderMatrices& state)
-		: object(obj), renderState(state)
+		const mrpt::opengl::CRenderizable* obj, uint32_t stateIdx,
+		mrpt::opengl::shader_id_t shaderId, float eyeDepth, uint32_t seq)
+		: object(obj),
+		  stateIndex(stateIdx),
+		  sequence(seq),
+		  depth(eyeDepth),
+		  shader(shaderId)
 	{
 	}
 
 	const mrpt::opengl::CRenderizable* object = nullptr;
-	mrpt::opengl::TRenderMatrices renderState = {};
+	/** Index of the rendering matrices in RenderQueue::state() */
+	uint32_t stateIndex = 0;
+	/** Order of insertion in the queue */
+	uint32_t sequence = 0;
+	/** Eye-to-object depth, used to render from back to front */
+	float depth = 0;
+	mrpt::opengl::shader_id_t shader = 0;
+};
+
+/** Prototype objects shared by all the instances of objects with identical
+ * geometry, e.g. thousands of CAxis or CEllipsoid3D which only differ in
+ * their poses or covariances. See CRenderizable::instancingKey().
+ *
+ * Owned by COpenGLViewport. Prototypes not used in one frame are freed in the
+ * next call to beginFrame().
+ *
+ * \ingroup mrpt_opengl_grp
+ * \note (New in MRPT 2.4.2)
+ */
+class RenderInstancingCache
+{
+   public:
+	RenderInstancingCache() = default;
+	/** Copies are created empty: prototypes are not shared */
+	RenderInstancingCache(const RenderInstancingCache&) {}
+	RenderInstancingCache& operator=(const RenderInstancingCache&)
+	{
+		return *this;
+	}
+
+	/** Returns the prototype for the given key, creating it from `obj` if
+	 * it does not exist yet, in which case `created` is set to true.
+	 * Thread-safe. */
+	const CRenderizable* prototype(
+		const std::string& key, const CRenderizable& obj, bool& created);
+
+	/** Frees the prototypes not used since the former call. */
+	void beginFrame();
+
+	/** Frees all prototypes. */
+	void clear();
+
+	/** Number of prototypes in the cache */
+	size_t size() const;
+
+   private:
+	struct Entry
+	{
+		std::shared_ptr<CRenderizable> prototype;
+		bool used = true;
+	};
+	std::unordered_map<std::string, Entry> m_prototypes;
+	mutable std::mutex m_mtx;
 };
 
 /** A queue for rendering, sorted by shader program to minimize changes of
  * OpenGL shader programs while rendering a scene.
  * Within each shader, objects are sorted by eye-to-object distance, so we can
- * later render them from back to front to render transparencies properly Filled
- * by sortRenderObjectsByShader() \ingroup mrpt_opengl_grp
+ * later render them from back to front to render transparencies properly.
+ *
+ * Filled by enqueForRendering(), and rendered by processRenderQueue().
+ * Elements are kept in a flat vector and the rendering matrices of each
+ * object are stored only once, no matter how many shaders it requires. The
+ * queue is sorted once, the first time sorted() is called after adding
+ * elements.
+ *
+ * The public fields are options for enqueForRendering(), to be set before
+ * filling the queue.
+ *
+ * \ingroup mrpt_opengl_grp
  */
-using RenderQueue =
-	std::map<shader_id_t, std::multimap<float, RenderQueueElement>>;
+class RenderQueue
+{
+   public:
+	RenderQueue() = default;
+
+	/** Skip objects whose bounding box lies out of the view frustum
+	 * (Default: false). */
+	bool frustumCulling = false;
+
+	/** Process long lists of objects in parallel, using the
+	 * mrpt::WorkerThreadsPool::Default() threads (Default: false). */
+	bool parallel = false;
+
+	/** If not null, objects which support it are rendered as instances of
+	 * a shared prototype. See CRenderizable::instancingKey(). */
+	RenderInstancingCache* instancing = nullptr;
+
+	/** Do not call CRenderizable::updateBuffers() while enqueuing objects,
+	 * but store them in pendingBufferUpdates instead. Used internally for
+	 * queues filled from threads without an OpenGL context. */
+	bool deferBufferUpdates = false;
+
+	/** Objects whose buffers have to be updated (Only used if
+	 * deferBufferUpdates=true) */
+	std::vector<const CRenderizable*> pendingBufferUpdates;
+
+	/** Number of objects skipped by frustum culling. */
+	size_t culledObjects = 0;
+
+	/** Stores a copy of the rendering matrices of an object, and returns
+	 * its index, to be used in add(). */
+	uint32_t addState(const mrpt::opengl::TRenderMatrices& state)
+	{
+		m_states.push_back(state);
+		return static_cast<uint32_t>(m_states.size() - 1);
+	}
+
+	/** Enqueues an object to be rendered with the given shader. */
+	void add(
+		const CRenderizable* obj, uint32_t stateIndex,
+		mrpt::opengl::shader_id_t shader, float depth)
+	{
+		m_elements.emplace_back(
+			obj, stateIndex, shader, depth,
+			static_cast<uint32_t>(m_elements.size()));
+		m_sorted = false;
+	}
+
+	/** Moves all elements of `o` to the end of this queue, as if they were
+	 * added after the existing ones. */
+	void append(RenderQueue&& o);
+
+	/** Returns all elements, sorted by shader, then by decreasing depth
+	 * (back to front), then by decreasing insertion order. */
+	const std::vector<RenderQueueElement>& sorted() const;
+
+	const mrpt::opengl::TRenderMatrices& state(uint32_t stateIndex) const
+	{
+		return m_states[stateIndex];
+	}
+
+	size_t size() const { return m_elements.size(); }
+	bool empty() const { return m_elements.empty(); }
+
+	/** Removes all elements, states, pending buffer updates and the culling
+	 * counter. Options are kept. */
+	void clear();
+
+   private:
+	mutable std::vector<RenderQueueElement> m_elements;
+	std::vector<mrpt::opengl::TRenderMatrices> m_states;
+	mutable bool m_sorted = true;
+};
 
 }  // namespace mrpt::opengl
@@ -0,0 +1,119 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/core/optional_ref.h>
+#include <mrpt/img/CImage.h>
+#include <mrpt/math/CMatrixDynamic.h>
+#include <mrpt/opengl/RenderQueue.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace mrpt::opengl
+{
+class COpenGLViewport;
+class CRenderizable;
+namespace internal
+{
+struct RasterizerChunk;
+struct RasterizerTexture;
+}  // namespace internal
+
+/** Renders the objects of a COpenGLViewport into RGB and depth images on the
+ * CPU, without OpenGL, a GPU or a display. Used by CFBORender when
+ * constructed in software mode (see CFBORender::Parameters).
+ *
+ * Objects are queued as for OpenGL rendering (see RenderQueue) and drawn in
+ * the same order, with the equivalent of the default shaders: lit
+ * triangles, textured triangles, lines, points and text. The pipeline:
+ *  - Vertices are transformed, clipped against the view frustum, and the
+ *    resulting primitives binned into square screen tiles, in parallel for
+ *    consecutive ranges of primitives.
+ *  - Tiles are rasterized in parallel, with depth test and alpha blending,
+ *    each one processing its primitives in queue order. Hence, results do
+ *    not depend on the number of threads.
+ *
+ * Differences with OpenGL rendering: lighting is evaluated per vertex and
+ * interpolated, lines are not antialiased, and the 2D text messages of the
+ * viewport (see CTextMessageCapable) are not drawn.
+ *
+ * Vertex data is regenerated with CRenderizable::updateCPUBuffers(), so
+ * objects are never required to upload OpenGL buffers.
+ *
+ * \sa CFBORender
+ * \ingroup mrpt_opengl_grp
+ * \note (New in MRPT 2.4.2)
+ */
+class SoftwareRasterizer
+{
+   public:
+	/** \param numThreads Number of threads rendering, including the calling
+	 * one. 0 means as many as hardware threads. */
+	SoftwareRasterizer(
+		unsigned int width = 640, unsigned int height = 480,
+		unsigned int numThreads = 0);
+	~SoftwareRasterizer();
+
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+	SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+	void setResolution(unsigned int width, unsigned int height);
+	unsigned int width() const { return m_width; }
+	unsigned int height() const { return m_height; }
+
+	/** See constructor */
+	void setNumThreads(unsigned int numThreads);
+	unsigned int numThreads() const { return m_numThreads; }
+
+	/** Renders the viewport, as seen from its camera, into an RGB image
+	 * and/or a depth image, resized if needed to the configured resolution.
+	 * Depth images have the same meaning than in CFBORender::render_RGBD():
+	 * linear depth along the camera view direction, or 0 for pixels without
+	 * any object within the viewport clip distances.
+	 */
+	void render(
+		const COpenGLViewport& viewport,
+		const mrpt::optional_ref<mrpt::img::CImage>& outRGB,
+		const mrpt::optional_ref<mrpt::math::CMatrixFloat>& outDepth);
+
+	/** Number of primitives drawn in the last call to render(), after
+	 * clipping and face culling */
+	struct Stats
+	{
+		size_t triangles = 0, lines = 0, points = 0;
+	};
+	const Stats& lastRenderStats() const { return m_stats; }
+
+   private:
+	unsigned int m_width, m_height;
+	unsigned int m_numThreads = 1;
+	mrpt::WorkerThreadsPool m_pool;
+	RenderInstancingCache m_instancing;
+	Stats m_stats;
+
+	/** Textures, as RGBA8 texels, kept while their images do not change */
+	std::map<const CRenderizable*, std::unique_ptr<internal::RasterizerTexture>>
+		m_textures;
+
+	/** Framebuffer: RGB colors and window depths in [0,1] */
+	std::vector<uint8_t> m_color;
+	std::vector<float> m_depth;
+
+	/** Primitives in screen coordinates, binned into tiles. Reused between
+	 * calls, to save memory allocations. */
+	std::vector<internal::RasterizerChunk> m_chunks;
+
+	const internal::RasterizerTexture& texture(const CRenderizable* obj);
+};
+
+}  // namespace mrpt::opengl
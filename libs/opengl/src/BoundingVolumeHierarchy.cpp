@@ -0,0 +1,277 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "opengl-precomp.h"	 // Precompiled header
+//
+#include <mrpt/opengl/BoundingVolumeHierarchy.h>
+
+#include <algorithm>
+
+using namespace mrpt::opengl;
+using mrpt::math::TBoundingBoxf;
+
+namespace
+{
+TBoundingBoxf emptyBox()
+{
+	return TBoundingBoxf::PlusMinusInfinity();
+}
+void extend(TBoundingBoxf& b, const mrpt::math::TPoint3Df& p)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		mrpt::keep_min(b.min[i], p[i]);
+		mrpt::keep_max(b.max[i], p[i]);
+	}
+}
+void extend(TBoundingBoxf& b, const TBoundingBoxf& o)
+{
+	extend(b, o.min);
+	extend(b, o.max);
+}
+double dot(const mrpt::math::TVector3D& a, const mrpt::math::TVector3D& b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+mrpt::math::TVector3D cross(
+	const mrpt::math::TVector3D& a, const mrpt::math::TVector3D& b)
+{
+	return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+float halfArea(const TBoundingBoxf& b)
+{
+	const float dx = b.max.x - b.min.x, dy = b.max.y - b.min.y,
+				dz = b.max.z - b.min.z;
+	return dx * dy + dy * dz + dz * dx;
+}
+
+// Binned SAH builder. See e.g.: I. Wald, "On fast Construction of SAH-based
+// Bounding Volume Hierarchies", 2007.
+struct Builder
+{
+	const std::vector<TBoundingBoxf>& boxes;
+	std::vector<mrpt::math::TPoint3Df> centroids;
+	std::vector<uint32_t>& order;
+	std::vector<BoundingVolumeHierarchy::Node>& nodes;
+	size_t maxLeafSize;
+
+	constexpr static int NUM_BINS = 16;
+
+	// Builds the subtree for order[first:last), returns its node index.
+	uint32_t build(uint32_t first, uint32_t last, size_t depth)
+	{
+		const uint32_t ni = static_cast<uint32_t>(nodes.size());
+		nodes.emplace_back();
+
+		TBoundingBoxf box = emptyBox(), cbox = emptyBox();
+		for (uint32_t i = first; i < last; i++)
+		{
+			extend(box, boxes[order[i]]);
+			extend(cbox, centroids[order[i]]);
+		}
+		nodes[ni].box = box;
+
+		const uint32_t n = last - first;
+		uint32_t mid = first;
+		if (n > maxLeafSize && depth + 1 < BoundingVolumeHierarchy::MAX_DEPTH)
+			mid = split(first, last, box, cbox);
+
+		if (mid == first)
+		{
+			nodes[ni].first = first;
+			nodes[ni].count = n;
+			return ni;
+		}
+		build(first, mid, depth + 1);
+		const uint32_t second = build(mid, last, depth + 1);
+		nodes[ni].first = second;
+		nodes[ni].count = 0;
+		return ni;
+	}
+
+	// Returns the split position, or `first` to make a leaf.
+	uint32_t split(
+		uint32_t first, uint32_t last, const TBoundingBoxf& box,
+		const TBoundingBoxf& cbox)
+	{
+		const uint32_t n = last - first;
+		float bestCost = std::numeric_limits<float>::max();
+		int bestAxis = -1, bestBin = 0;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float lo = cbox.min[axis], ext = cbox.max[axis] - lo;
+			if (!(ext > 0)) continue;
+
+			TBoundingBoxf binBox[NUM_BINS];
+			uint32_t binCount[NUM_BINS] = {0};
+			for (auto& b : binBox)
+				b = emptyBox();
+			for (uint32_t i = first; i < last; i++)
+			{
+				const int b = binOf(centroids[order[i]][axis], lo, ext);
+				binCount[b]++;
+				extend(binBox[b], boxes[order[i]]);
+			}
+			// Sweep from the right, then from the left evaluating the cost of
+			// splitting after each bin:
+			float rightArea[NUM_BINS];
+			uint32_t rightCount[NUM_BINS];
+			TBoundingBoxf acc = emptyBox();
+			uint32_t cnt = 0;
+			for (int b = NUM_BINS - 1; b > 0; b--)
+			{
+				extend(acc, binBox[b]);
+				cnt += binCount[b];
+				rightArea[b] = cnt ? halfArea(acc) : 0;
+				rightCount[b] = cnt;
+			}
+			acc = emptyBox();
+			cnt = 0;
+			for (int b = 0; b < NUM_BINS - 1; b++)
+			{
+				extend(acc, binBox[b]);
+				cnt += binCount[b];
+				if (!cnt || !rightCount[b + 1]) continue;
+				const float cost =
+					cnt * halfArea(acc) + rightCount[b + 1] * rightArea[b + 1];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = b;
+				}
+			}
+		}
+
+		if (bestAxis < 0)
+		{
+			// All centroids coincide: split in halves if the leaf would be
+			// too large anyway.
+			return n > 4 * maxLeafSize ? first + n / 2 : first;
+		}
+		// Do not split if intersecting all primitives is cheaper (in the
+		// SAH sense, with the cost of a box test = cost of a primitive):
+		const float leafCost = n * halfArea(box);
+		if (n <= 4 * maxLeafSize && bestCost + halfArea(box) >= leafCost)
+			return first;
+
+		const float lo = cbox.min[bestAxis],
+					ext = cbox.max[bestAxis] - cbox.min[bestAxis];
+		const auto it = std::partition(
+			order.begin() + first, order.begin() + last, [&](uint32_t p) {
+				return binOf(centroids[p][bestAxis], lo, ext) <= bestBin;
+			});
+		return static_cast<uint32_t>(it - order.begin());
+	}
+
+	static int binOf(float c, float lo, float ext)
+	{
+		const int b = static_cast<int>(NUM_BINS * ((c - lo) / ext));
+		return std::min(std::max(b, 0), NUM_BINS - 1);
+	}
+};
+}  // namespace
+
+void BoundingVolumeHierarchy::build(
+	const std::vector<TBoundingBoxf>& boxes, size_t maxLeafSize)
+{
+	ASSERT_GT_(maxLeafSize, 0U);
+	clear();
+	if (boxes.empty()) return;
+
+	m_order.resize(boxes.size());
+	for (size_t i = 0; i < boxes.size(); i++)
+		m_order[i] = static_cast<uint32_t>(i);
+
+	Builder b{boxes, {}, m_order, m_nodes, maxLeafSize};
+	b.centroids.resize(boxes.size());
+	for (size_t i = 0; i < boxes.size(); i++)
+		b.centroids[i] = (boxes[i].min + boxes[i].max) * 0.5f;
+
+	m_nodes.reserve(2 * boxes.size() / maxLeafSize + 1);
+	b.build(0, static_cast<uint32_t>(boxes.size()), 0);
+	m_nodes.shrink_to_fit();
+}
+
+void BoundingVolumeHierarchy::clear()
+{
+	m_nodes.clear();
+	m_order.clear();
+}
+
+void TriangleBVH::build(const std::vector<triangle_t>& triangles)
+{
+	std::vector<TBoundingBoxf> boxes;
+	boxes.reserve(triangles.size());
+	for (const auto& t : triangles)
+	{
+		TBoundingBoxf b = emptyBox();
+		for (const auto& p : t)
+			extend(b, p);
+		boxes.push_back(b);
+	}
+	m_bvh.build(boxes);
+
+	const auto& order = m_bvh.primitiveOrder();
+	m_tris.resize(order.size());
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		const auto& t = triangles[order[k]];
+		m_tris[k] = {t[0], t[1] - t[0], t[2] - t[0]};
+	}
+}
+
+void TriangleBVH::build(const std::vector<mrpt::opengl::TTriangle>& triangles)
+{
+	std::vector<triangle_t> tris;
+	tris.reserve(triangles.size());
+	for (const auto& t : triangles)
+		tris.push_back({t.vertex(0), t.vertex(1), t.vertex(2)});
+	build(tris);
+}
+
+void TriangleBVH::clear()
+{
+	m_tris.clear();
+	m_bvh.clear();
+}
+
+bool TriangleBVH::traceRay(
+	const mrpt::math::TPoint3D& origin, const mrpt::math::TVector3D& dir,
+	double& dist) const
+{
+	// Möller-Trumbore ray-triangle intersection:
+	return m_bvh.traceRay(
+		origin, dir, dist, [&](size_t k, double maxDist, double& d) {
+			const Tri& t = m_tris[k];
+			const mrpt::math::TVector3D e1 = t.e1.cast<double>(),
+										e2 = t.e2.cast<double>();
+			const auto p = cross(dir, e2);
+			const double det = dot(e1, p);
+			if (std::abs(det) < 1e-12) return false;  // parallel
+			const double invDet = 1.0 / det;
+			const mrpt::math::TVector3D s = origin - t.v0.cast<double>();
+			const double u = dot(s, p) * invDet;
+			if (u < 0 || u > 1) return false;
+			const auto q = cross(s, e1);
+			const double v = dot(dir, q) * invDet;
+			if (v < 0 || u + v > 1) return false;
+			d = dot(e2, q) * invDet;
+			return d >= 0 && d <= maxDist;
+		});
+}
+
+bool TriangleBVH::traceRay(const mrpt::poses::CPose3D& o, double& dist) const
+{
+	const auto& R = o.getRotationMatrix();
+	return traceRay(
+		o.translation(), mrpt::math::TVector3D(R(0, 0), R(1, 0), R(2, 0)),
+		dist);
+}
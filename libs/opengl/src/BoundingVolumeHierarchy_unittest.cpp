@@ -0,0 +1,162 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/math/geometry.h>
+#include <mrpt/opengl/BoundingVolumeHierarchy.h>
+#include <mrpt/opengl/CBox.h>
+#include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <mrpt/opengl/CSetOfTriangles.h>
+#include <mrpt/opengl/CSphere.h>
+#include <mrpt/random/RandomGenerators.h>
+
+using namespace mrpt::opengl;
+using mrpt::math::TPoint3Df;
+using mrpt::poses::CPose3D;
+
+static std::vector<TTriangle> randomTriangles(size_t N, double side)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	std::vector<TTriangle> tris;
+	for (size_t i = 0; i < N; i++)
+	{
+		const TPoint3Df c(
+			rng.drawUniform(-side, side), rng.drawUniform(-side, side),
+			rng.drawUniform(-side, side));
+		TPoint3Df v[3];
+		for (auto& p : v)
+			p = c +
+				TPoint3Df(
+					rng.drawUniform(-1.0, 1.0), rng.drawUniform(-1.0, 1.0),
+					rng.drawUniform(-1.0, 1.0));
+		tris.emplace_back(v[0], v[1], v[2]);
+	}
+	return tris;
+}
+
+static std::vector<CPose3D> randomRays(size_t N, double side)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	std::vector<CPose3D> rays;
+	for (size_t i = 0; i < N; i++)
+		rays.emplace_back(
+			rng.drawUniform(-side, side), rng.drawUniform(-side, side),
+			rng.drawUniform(-side, side), rng.drawUniform(-M_PI, M_PI),
+			rng.drawUniform(-1.5, 1.5), rng.drawUniform(-M_PI, M_PI));
+	return rays;
+}
+
+TEST(TriangleBVH, sameResultsThanLinearSearch)
+{
+	mrpt::random::getRandomGenerator().randomize(123);
+
+	const auto tris = randomTriangles(3000, 20.0);
+	std::vector<mrpt::math::TPolygonWithPlane> polys;
+	for (const auto& t : tris)
+	{
+		mrpt::math::TPolygon3D p(3);
+		for (int i = 0; i < 3; i++)
+			p[i] = t.vertex(i);
+		polys.emplace_back(p);
+	}
+
+	TriangleBVH bvh;
+	bvh.build(tris);
+	EXPECT_EQ(bvh.size(), tris.size());
+
+	size_t nHits = 0;
+	for (const auto& ray : randomRays(1000, 25.0))
+	{
+		double d1 = 0, d2 = 0;
+		const bool hit1 = mrpt::math::traceRay(polys, ray.asTPose(), d1);
+		const bool hit2 = bvh.traceRay(ray, d2);
+		EXPECT_EQ(hit1, hit2) << "ray: " << ray;
+		if (hit1 && hit2)
+		{
+			EXPECT_NEAR(d1, d2, 1e-4) << "ray: " << ray;
+			nHits++;
+		}
+	}
+	// Make sure the test is meaningful:
+	EXPECT_GT(nHits, 100U);
+
+	bvh.clear();
+	double d;
+	EXPECT_FALSE(bvh.traceRay(CPose3D(), d));
+}
+
+TEST(COpenGLScene, traceRays)
+{
+	mrpt::random::getRandomGenerator().randomize(456);
+
+	COpenGLScene scene;
+
+	auto tris = CSetOfTriangles::Create();
+	tris->insertTriangles(randomTriangles(500, 10.0));
+	scene.insert(tris);
+
+	auto set = CSetOfObjects::Create();
+	set->setPose(CPose3D(5.0, -3.0, 1.0, 0.3, 0.2, 0.1));
+	auto tris2 = CSetOfTriangles::Create();
+	tris2->insertTriangles(randomTriangles(200, 5.0));
+	set->insert(tris2);
+	auto sphere = CSphere::Create(2.0);
+	sphere->setLocation(-4.0, 2.0, 0.0);
+	set->insert(sphere);
+	scene.insert(set);
+
+	auto box = CBox::Create(
+		mrpt::math::TPoint3D(8, 8, -2), mrpt::math::TPoint3D(10, 12, 3));
+	scene.insert(box);
+
+	const auto rays = randomRays(2000, 15.0);
+	const auto dists = scene.traceRays(rays);
+	ASSERT_EQ(dists.size(), rays.size());
+
+	size_t nHits = 0;
+	for (size_t i = 0; i < rays.size(); i++)
+	{
+		double d = 0;
+		const bool hit = scene.traceRay(rays[i], d);
+		EXPECT_EQ(hit, dists[i].has_value()) << "ray: " << rays[i];
+		if (hit && dists[i])
+		{
+			EXPECT_NEAR(d, *dists[i], 1e-6) << "ray: " << rays[i];
+			nHits++;
+		}
+	}
+	EXPECT_GT(nHits, 100U);
+
+	// Modifying an object invalidates its ray tracing BVH:
+	tris->clearTriangles();
+	for (size_t i = 0; i < 200; i++)
+	{
+		double d = 0;
+		const bool hit = scene.traceRay(rays[i], d);
+		EXPECT_EQ(hit, scene.traceRays({rays[i]})[0].has_value());
+	}
+}
+
+TEST(CBox, traceRay)
+{
+	CBox box(mrpt::math::TPoint3D(1, -1, -1), mrpt::math::TPoint3D(3, 1, 1));
+	box.setPose(CPose3D(0, 0, 1.0, 0, 0, 0));
+	double d = 0;
+	EXPECT_TRUE(box.traceRay(CPose3D(0, 0, 1.0, 0, 0, 0), d));
+	EXPECT_NEAR(d, 1.0, 1e-9);
+	// From inside:
+	EXPECT_TRUE(box.traceRay(CPose3D(2.0, 0, 1.0, 0, 0, 0), d));
+	EXPECT_NEAR(d, 1.0, 1e-9);
+	// Looking backwards, and missing it:
+	EXPECT_TRUE(box.traceRay(CPose3D(5.0, 0, 1.0, M_PI, 0, 0), d));
+	EXPECT_NEAR(d, 2.0, 1e-9);
+	EXPECT_FALSE(box.traceRay(CPose3D(0, 0, 3.0, 0, 0, 0), d));
+	EXPECT_FALSE(box.traceRay(CPose3D(0, 0, 1.0, M_PI, 0, 0), d));
+}
@@ -200,10 +200,12 @@ void CArrow::serializeFrom(mrpt::serialization::CSchemeArchiveBase& in)
 }
 auto CArrow::getBoundingBox() const -> mrpt::math::TBoundingBox
 {
+	// Enlarged by the radius of the head and body, in all directions:
+	const double r = std::max(m_smallRadius, m_largeRadius);
 	return mrpt::math::TBoundingBox(
-			   {std::min(m_x0, m_x1), std::min(m_y0, m_y1),
-				std::min(m_z0, m_z1)},
-			   {std::max(m_x0, m_x1), std::max(m_y0, m_y1),
-				std::max(m_z0, m_z1)})
+			   {std::min(m_x0, m_x1) - r, std::min(m_y0, m_y1) - r,
+				std::min(m_z0, m_z1) - r},
+			   {std::max(m_x0, m_x1) + r, std::max(m_y0, m_y1) + r,
+				std::max(m_z0, m_z1) + r})
 		.compose(m_pose);
 }
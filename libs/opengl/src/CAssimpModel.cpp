@@ -25,18 +25,29 @@
 #include <assimp/scene.h>
 #include <assimp/types.h>
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/DefaultLogger.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/LogStream.hpp>
 #endif
 #endif
 
+#include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/core/lock_helper.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/CMemoryMappedFile.h>
 #include <mrpt/opengl/opengl_api.h>
 #include <mrpt/serialization/CArchive.h>
 #include <mrpt/system/filesystem.h>
 
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
 #include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <type_traits>
 
 using namespace mrpt;
 using namespace mrpt::opengl;
@@ -62,15 +73,21 @@ class TexturesCache
 		bool load_attempted = false;
 		mrpt::img::CImage img_rgb;
 		std::optional<mrpt::img::CImage> img_alpha;
+		/** Held while loading, so different textures are decoded in
+		 * parallel */
+		std::mutex mtx;
 	};
 
-	CachedTexturesInfo& get(
+	const CachedTexturesInfo& get(
 		const CAssimpModel::filepath_t& texturePath, bool verboseLoad)
 	{
 		using namespace std::string_literals;
 
-		auto lck = mrpt::lockHelper(gTextureCacheMtx);
+		auto lckAll = mrpt::lockHelper(gTextureCacheMtx);
 		auto& entry = gTextureCache[texturePath];
+		lckAll.unlock();
+
+		auto lck = mrpt::lockHelper(entry.mtx);
 		if (entry.load_attempted) return entry;
 
 		// Load images:
@@ -115,23 +132,39 @@ class TexturesCache
 	std::mutex gTextureCacheMtx;
 };
 
-struct RenderElements
+/** A model already flattened into lists of primitives, as imported by a
+ * loader thread or read from the cache, before moving it into the buffers of
+ * a CAssimpModel */
+struct AssimpFlatModel
 {
-	std::vector<mrpt::math::TPoint3Df>* lines_vbd = nullptr;
-	std::vector<mrpt::img::TColor>* lines_cbd = nullptr;
-	std::vector<mrpt::math::TPoint3Df>* pts_vbd = nullptr;
-	std::vector<mrpt::img::TColor>* pts_cbd = nullptr;
-	std::vector<mrpt::opengl::TTriangle>* tris = nullptr;
+	mrpt::math::TPoint3D bbox_min{0, 0, 0}, bbox_max{0, 0, 0};
+	std::vector<mrpt::math::TPoint3Df> lines_vbd, pts_vbd;
+	std::vector<mrpt::img::TColor> lines_cbd, pts_cbd;
+	std::vector<mrpt::opengl::TTriangle> tris;
+
+	struct Texture
+	{
+		std::string name;  //!< As referenced by the model materials
+		std::string fileloc;  //!< Path of the image file
+		int64_t fileTime = 0;  //!< Modification time of the image file
+		bool load_ok = false;
+		mrpt::img::CImage img_rgb;
+		std::optional<mrpt::img::CImage> img_alpha;
+		std::vector<mrpt::opengl::TTriangle> tris;
+	};
+	/** Sorted by name */
+	std::vector<Texture> textures;
 
-	// textures:
-	const std::map<std::string, CAssimpModel::TInfoPerTexture>* ipt = nullptr;
-	const std::vector<CSetOfTexturedTriangles::Ptr>* textObjs = nullptr;
+	/** Other files read by Assimp, apart from the model file (e.g. .mtl
+	 * materials or .bin buffers), and their modification times */
+	std::vector<std::pair<std::string, int64_t>> companionFiles;
 };
 }  // namespace mrpt::opengl::internal
 
+using mrpt::opengl::internal::AssimpFlatModel;
+
 struct CAssimpModel::Impl
 {
-#if MRPT_HAS_OPENGL_GLUT && MRPT_HAS_ASSIMP
 	Impl() = default;
 	~Impl() = default;
 
@@ -143,11 +176,30 @@ struct CAssimpModel::Impl
 		return *this;
 	}
 
-	Assimp::Importer importer;
-	const aiScene* scene = nullptr;	 // Memory owned by "importer"
-#endif
+	std::thread loader;
+	std::atomic_bool loading{false};
+	/** Set by the loader when finished, until the result is applied */
+	std::atomic_bool hasResult{false};
+	std::mutex resultMtx;
+	std::optional<AssimpFlatModel> result;  //!< Or empty on errors
+	std::string resultError;
 };
 
+static AssimpFlatModel importModel(const std::string& filepath, int flags);
+
+namespace
+{
+std::mutex cacheDirMtx;
+std::string& cacheDirectory()
+{
+	static std::string dir = []() -> std::string {
+		const char* s = ::getenv("MRPT_ASSIMP_CACHE_DIR");
+		return s ? s : "";
+	}();
+	return dir;
+}
+}  // namespace
+
 #if MRPT_HAS_OPENGL_GLUT && MRPT_HAS_ASSIMP
 
 // Just return the diffuse color:
@@ -176,60 +228,98 @@ void CAssimpModel::render(const RenderContext& rc) const
 }
 void CAssimpModel::renderUpdateBuffers() const
 {
-	// onUpdateBuffers_all: already called upon loading of the model from file.
+	// The buffers are built upon loading of the model from file, or in
+	// onUpdateBuffers_all() for models loaded in the background.
 
 	CRenderizableShaderPoints::renderUpdateBuffers();
 	CRenderizableShaderTriangles::renderUpdateBuffers();
 	CRenderizableShaderWireFrame::renderUpdateBuffers();
 }
 
-// special case for assimp: update all buffers within one run over the scene
-// structure.
+// special case for assimp: all buffers are built at once upon loading, or
+// here, if a model loaded in the background is ready.
 void CAssimpModel::onUpdateBuffers_all()
 {
-	auto& lines_vbd = CRenderizableShaderWireFrame::m_vertex_buffer_data;
-	auto& lines_cbd = CRenderizableShaderWireFrame::m_color_buffer_data;
-	lines_vbd.clear();
-	lines_cbd.clear();
+	if (!m_impl->hasResult) return;
 
-	auto& pts_vbd = CRenderizableShaderPoints::m_vertex_buffer_data;
-	auto& pts_cbd = CRenderizableShaderPoints::m_color_buffer_data;
-	pts_vbd.clear();
-	pts_cbd.clear();
+	auto lck = mrpt::lockHelper(m_impl->resultMtx);
+	if (!m_impl->hasResult) return;
+	auto result = std::move(m_impl->result);
+	m_impl->result.reset();
+	m_impl->hasResult = false;
+	lck.unlock();
 
-	auto& tris = CRenderizableShaderTriangles::m_triangles;
-	tris.clear();
+	if (result) applyModel(std::move(*result));
+}
 
-#if MRPT_HAS_OPENGL_GLUT && MRPT_HAS_ASSIMP
-	if (!m_assimp_scene->scene) return;	 // No scene
+void CAssimpModel::applyModel(AssimpFlatModel&& m)
+{
+	m_bbox_min = m.bbox_min;
+	m_bbox_max = m.bbox_max;
 
-	mrpt::opengl::internal::RenderElements re;
-	re.lines_vbd = &lines_vbd;
-	re.lines_cbd = &lines_cbd;
-	re.pts_vbd = &pts_vbd;
-	re.pts_cbd = &pts_cbd;
-	re.tris = &tris;
-	re.ipt = &m_textureIdMap;
-	re.textObjs = &m_texturedObjects;
+	CRenderizableShaderWireFrame::m_vertex_buffer_data =
+		std::move(m.lines_vbd);
+	CRenderizableShaderWireFrame::m_color_buffer_data = std::move(m.lines_cbd);
+	CRenderizableShaderPoints::m_vertex_buffer_data = std::move(m.pts_vbd);
+	CRenderizableShaderPoints::m_color_buffer_data = std::move(m.pts_cbd);
+	CRenderizableShaderTriangles::m_triangles = std::move(m.tris);
 
-	ASSERT_(m_assimp_scene->scene);
+	// We define a textured object per texture image:
+	m_textureIdMap.clear();
+	m_texturedObjects.clear();
+	for (auto& t : m.textures)
+	{
+		TInfoPerTexture& ipt = m_textureIdMap[t.name];
+		ipt.id_idx = m_texturedObjects.size();
 
-	process_textures(m_assimp_scene->scene);
+		auto& texturedObj =
+			m_texturedObjects.emplace_back(CSetOfTexturedTriangles::Create());
+		texturedObj->insertTriangles(
+			std::make_move_iterator(t.tris.begin()),
+			std::make_move_iterator(t.tris.end()));
+		if (!t.load_ok) continue;
 
-	const auto transf = mrpt::poses::CPose3D();
-	recursive_render(
-		m_assimp_scene->scene, m_assimp_scene->scene->mRootNode, transf, re);
-#endif
+		if (t.img_alpha.has_value())
+			texturedObj->assignImage(t.img_rgb, *t.img_alpha);
+		else
+			texturedObj->assignImage(t.img_rgb);
+		ipt.img_rgb = t.img_rgb;
+		ipt.img_alpha = t.img_alpha;
+	}
+
+	// Index all triangles for ray tracing:
+	std::vector<TriangleBVH::triangle_t> allTris;
+	const auto appendTris = [&](const std::vector<TTriangle>& v) {
+		for (const auto& t : v)
+			allTris.push_back({t.vertex(0), t.vertex(1), t.vertex(2)});
+	};
+	appendTris(CRenderizableShaderTriangles::m_triangles);
+	for (const auto& o : m_texturedObjects)
+		appendTris(o->shaderTexturedTrianglesBuffer());
+	m_trianglesBVH.build(allTris);
+
+	CRenderizable::notifyChange();
 }
 
-// These ones: already done in onUpdateBuffers_all()
-void CAssimpModel::onUpdateBuffers_Wireframe() {}
-void CAssimpModel::onUpdateBuffers_Points() {}
-void CAssimpModel::onUpdateBuffers_Triangles() {}
+// These ones: already done upon loading, or in onUpdateBuffers_all()
+void CAssimpModel::onUpdateBuffers_Wireframe() { onUpdateBuffers_all(); }
+void CAssimpModel::onUpdateBuffers_Points() { onUpdateBuffers_all(); }
+void CAssimpModel::onUpdateBuffers_Triangles() { onUpdateBuffers_all(); }
 
 void CAssimpModel::enqueForRenderRecursive(
 	const mrpt::opengl::TRenderMatrices& state, RenderQueue& rq) const
 {
+	// A model loaded in the background is applied here, in the rendering
+	// thread, so it is shown in this same frame. (The bounding box of an
+	// empty model is a point, hence never frustum-culled):
+	if (m_impl->hasResult)
+	{
+		const_cast<CAssimpModel*>(this)->onUpdateBuffers_all();
+		if (rq.deferBufferUpdates) rq.pendingBufferUpdates.push_back(this);
+		else
+			updateBuffers();
+	}
+
 	// Enque rendering all textured meshes:
 	mrpt::opengl::CListOpenGLObjects lst;
 	for (const auto& o : m_texturedObjects)
@@ -244,7 +334,7 @@ void CAssimpModel::serializeTo(mrpt::serialization::CArchive& out) const
 {
 	writeToStreamRender(out);
 #if MRPT_HAS_OPENGL_GLUT && MRPT_HAS_ASSIMP
-	const bool empty = m_assimp_scene->scene != nullptr;
+	const bool empty = m_modelPath.empty();
 	out << empty;
 	if (!empty)
 	{
@@ -275,77 +365,101 @@ void CAssimpModel::serializeFrom(
 	CRenderizable::notifyChange();
 }
 
-CAssimpModel::CAssimpModel()
-	: m_assimp_scene(mrpt::make_impl<CAssimpModel::Impl>())
+CAssimpModel::CAssimpModel() : m_impl(mrpt::make_impl<CAssimpModel::Impl>())
 {
 }
 
 CAssimpModel::~CAssimpModel() { clear(); }
 
-void CAssimpModel::clear()
+void CAssimpModel::joinLoader()
 {
-	CRenderizable::notifyChange();
+	auto& t = m_impl->loader;
+	if (!t.joinable()) return;
+	// The loading callback may drop the last reference to this object:
+	if (t.get_id() == std::this_thread::get_id()) t.detach();
+	else
+		t.join();
+}
 
-#if MRPT_HAS_OPENGL_GLUT && MRPT_HAS_ASSIMP
-	m_assimp_scene->importer.FreeScene();
-#endif
+void CAssimpModel::clear()
+{
+	joinLoader();
+	{
+		auto lck = mrpt::lockHelper(m_impl->resultMtx);
+		m_impl->result.reset();
+		m_impl->resultError.clear();
+		m_impl->hasResult = false;
+	}
+	applyModel({});
 	m_modelPath.clear();
-	m_textureIdMap.clear();
-	m_texturedObjects.clear();
 }
 
 void CAssimpModel::loadScene(const std::string& filepath, int flags)
 {
-#if MRPT_HAS_OPENGL_GLUT && MRPT_HAS_ASSIMP
 	clear();
-	CRenderizable::notifyChange();
 
-	// Assimp flags:
-	const std::vector<std::pair<uint32_t, unsigned int>> flagMap = {
-		{LoadFlags::RealTimeFast, aiProcessPreset_TargetRealtime_Fast},
-		{LoadFlags::RealTimeQuality, aiProcessPreset_TargetRealtime_Quality},
-		{LoadFlags::RealTimeMaxQuality,
-		 aiProcessPreset_TargetRealtime_MaxQuality},
-		{LoadFlags::FlipUVs, aiProcess_FlipUVs}};
+	applyModel(importModel(filepath, flags));
+	m_modelPath = filepath;
+}
 
-	unsigned int pFlags = 0;
-	for (const auto& p : flagMap)
-		if (flags & p.first) pFlags |= p.second;
+void CAssimpModel::loadSceneAsync(
+	const std::string& filepath, int flags, const load_callback_t& onLoaded)
+{
+	clear();
 
-	// Own flags:
-	m_verboseLoad = !!(flags & LoadFlags::Verbose);
+	m_modelPath = filepath;
+	m_impl->loading = true;
+	m_impl->loader = std::thread([this, filepath, flags, onLoaded]() {
+		std::optional<AssimpFlatModel> m;
+		std::string errorMsg;
+		try
+		{
+			m = importModel(filepath, flags);
+		}
+		catch (const std::exception& e)
+		{
+			errorMsg = mrpt::exception_to_str(e);
+		}
+		{
+			auto lck = mrpt::lockHelper(m_impl->resultMtx);
+			m_impl->result = std::move(m);
+			m_impl->resultError = errorMsg;
+			m_impl->hasResult = true;
+		}
+		// Only the atomic flags are touched here. The result is applied
+		// from the rendering thread, in enqueForRenderRecursive():
+		m_impl->loading = false;
 
-	m_assimp_scene->scene =
-		m_assimp_scene->importer.ReadFile(filepath.c_str(), pFlags);
+		if (onLoaded) onLoaded(errorMsg.empty(), errorMsg);
+	});
+}
 
-	if (!m_assimp_scene->scene)
-	{
-		THROW_EXCEPTION_FMT(
-			"Error importing '%s': %s", filepath.c_str(),
-			m_assimp_scene->importer.GetErrorString());
-	}
-	m_modelPath = filepath;
+bool CAssimpModel::isLoading() const { return m_impl->loading; }
 
-	// Evaluate overall bbox:
+void CAssimpModel::waitForLoad()
+{
+	joinLoader();
+
+	std::string errorMsg;
 	{
-		aiVector3D scene_min, scene_max;
-		get_bounding_box(m_assimp_scene->scene, &scene_min, &scene_max);
-		m_bbox_min.x = scene_min.x;
-		m_bbox_min.y = scene_min.y;
-		m_bbox_min.z = scene_min.z;
-		m_bbox_max.x = scene_max.x;
-		m_bbox_max.y = scene_max.y;
-		m_bbox_max.z = scene_max.z;
+		auto lck = mrpt::lockHelper(m_impl->resultMtx);
+		errorMsg = std::move(m_impl->resultError);
+		m_impl->resultError.clear();
 	}
+	onUpdateBuffers_all();
+	if (!errorMsg.empty()) THROW_EXCEPTION(errorMsg);
+}
 
-	// Process all elements at once:
-	// This populates the structures that will be attached to opengl
-	// buffers
-	const_cast<CAssimpModel&>(*this).onUpdateBuffers_all();
+void CAssimpModel::setCacheDirectory(const std::string& dir)
+{
+	auto lck = mrpt::lockHelper(cacheDirMtx);
+	cacheDirectory() = dir;
+}
 
-#else
-	THROW_EXCEPTION("MRPT compiled without OpenGL and/or Assimp");
-#endif
+std::string CAssimpModel::getCacheDirectory()
+{
+	auto lck = mrpt::lockHelper(cacheDirMtx);
+	return cacheDirectory();
 }
 
 auto CAssimpModel::getBoundingBox() const -> mrpt::math::TBoundingBox
@@ -353,12 +467,9 @@ auto CAssimpModel::getBoundingBox() const -> mrpt::math::TBoundingBox
 	return mrpt::math::TBoundingBox(m_bbox_min, m_bbox_max).compose(m_pose);
 }
 
-bool CAssimpModel::traceRay(
-	[[maybe_unused]] const mrpt::poses::CPose3D& o,
-	[[maybe_unused]] double& dist) const
+bool CAssimpModel::traceRay(const mrpt::poses::CPose3D& o, double& dist) const
 {
-	// TODO
-	return false;
+	return m_trianglesBVH.traceRay(o - this->m_pose, dist);
 }
 
 #if MRPT_HAS_OPENGL_GLUT && MRPT_HAS_ASSIMP
@@ -457,9 +568,12 @@ static mrpt::math::TPoint3Df to_mrpt(const aiVector3D& v)
 	return {v.x, v.y, v.z};
 }
 
-void CAssimpModel::recursive_render(
+using texture_indices_t = std::map<std::string, size_t>;
+
+// Appends all the primitives of a node and its children to the model:
+static void flatten_node(
 	const aiScene* sc, const aiNode* nd, const mrpt::poses::CPose3D& transf,
-	mrpt::opengl::internal::RenderElements& re)
+	const texture_indices_t& texIdx, AssimpFlatModel& out)
 {
 	const aiMatrix4x4& m = nd->mTransformation;
 
@@ -491,9 +605,9 @@ void CAssimpModel::recursive_render(
 							color =
 								color4_to_TColor(mesh->mColors[0][vertexIndex]);
 
-						re.pts_vbd->emplace_back(curTf.composePoint(
+						out.pts_vbd.emplace_back(curTf.composePoint(
 							to_mrpt(mesh->mVertices[vertexIndex])));
-						re.pts_cbd->emplace_back(color);
+						out.pts_cbd.emplace_back(color);
 					}
 					break;
 
@@ -507,9 +621,9 @@ void CAssimpModel::recursive_render(
 							color =
 								color4_to_TColor(mesh->mColors[0][vertexIndex]);
 
-						re.lines_vbd->emplace_back(curTf.composePoint(
+						out.lines_vbd.emplace_back(curTf.composePoint(
 							to_mrpt(mesh->mVertices[vertexIndex])));
-						re.lines_cbd->emplace_back(color);
+						out.lines_cbd.emplace_back(color);
 					}
 					break;
 
@@ -529,15 +643,15 @@ void CAssimpModel::recursive_render(
 							sc->mMaterials[mesh->mMaterialIndex]->GetTexture(
 								aiTextureType_DIFFUSE, texIndex, &path))
 						{
-							auto itIpt = re.ipt->find(path.data);
+							auto itIdx = texIdx.find(path.data);
 							ASSERTMSG_(
-								itIpt != re.ipt->end(),
+								itIdx != texIdx.end(),
 								mrpt::format(
 									"Inconsistent texture data structure for "
 									"texture with path: '%s'",
 									path.data));
 
-							textureIdIndex = itIpt->second.id_idx;
+							textureIdIndex = itIdx->second;
 						}
 					}
 
@@ -581,13 +695,13 @@ void CAssimpModel::recursive_render(
 						if (textureIdIndex == std::string::npos)
 						{
 							// Append to default non-textured mesh:
-							re.tris->emplace_back(std::move(tri));
+							out.tris.emplace_back(std::move(tri));
 						}
 						else
 						{
 							// Append to its corresponding textured object:
-							re.textObjs->at(textureIdIndex)
-								->insertTriangle(tri);
+							out.textures.at(textureIdIndex)
+								.tris.emplace_back(std::move(tri));
 						}
 					}
 				}
@@ -602,24 +716,23 @@ void CAssimpModel::recursive_render(
 
 	// draw all children
 	for (unsigned int n = 0; n < nd->mNumChildren; ++n)
-		recursive_render(sc, nd->mChildren[n], curTf, re);
+		flatten_node(sc, nd->mChildren[n], curTf, texIdx, out);
 }
 
-void CAssimpModel::process_textures(const aiScene* scene)
+// Finds all the texture files of the model, and decodes them in parallel:
+static void process_textures(
+	const aiScene* scene, const std::string& modelPath, bool verboseLoad,
+	AssimpFlatModel& m)
 {
-	using namespace std::string_literals;
-
 	if (scene->HasTextures())
 		THROW_EXCEPTION(
 			"Support for meshes with *embedded* textures is not implemented. "
 			"Please, use external texture files or contribute a PR to mrpt "
 			"with this feature.");
 
-	m_textureIdMap.clear();
-	m_texturedObjects.clear();
-
 	/* getTexture Filenames and no. of Textures */
-	for (unsigned int m = 0; m < scene->mNumMaterials; m++)
+	std::set<std::string> names;
+	for (unsigned int mat = 0; mat < scene->mNumMaterials; mat++)
 	{
 		for (int texIndex = 0;; texIndex++)
 		{
@@ -631,12 +744,11 @@ void CAssimpModel::process_textures(const aiScene* scene)
 			for (const auto texType : texTypes)
 			{
 				aiString path;	// filename
-				aiReturn texFound =
-					scene->mMaterials[m]->GetTexture(texType, texIndex, &path);
+				aiReturn texFound = scene->mMaterials[mat]->GetTexture(
+					texType, texIndex, &path);
 				if (texFound != AI_SUCCESS) break;
 
-				CAssimpModel::TInfoPerTexture& ipt = m_textureIdMap[path.data];
-				ipt.id_idx = std::string::npos;	 // pending
+				names.insert(path.data);
 				anyFound = true;
 			}
 			if (!anyFound) break;
@@ -644,35 +756,475 @@ void CAssimpModel::process_textures(const aiScene* scene)
 	}
 
 	const auto basepath = mrpt::system::filePathSeparatorsToNative(
-		mrpt::system::extractFileDirectory(m_modelPath));
+		mrpt::system::extractFileDirectory(modelPath));
 
-	for (auto& kv : m_textureIdMap)
+	m.textures.clear();
+	for (const auto& name : names)
 	{
-		// save image ID
-		std::string filename = kv.first;  // get filename
-		CAssimpModel::TInfoPerTexture& ipt = kv.second;
-		// save texture id for filename in map:
-		ipt.id_idx = m_texturedObjects.size();
+		auto& t = m.textures.emplace_back();
+		t.name = name;
+		t.fileloc = mrpt::system::filePathSeparatorsToNative(basepath + name);
+	}
 
-		// Create "children" textured objects:
-		auto& texturedObj =
-			m_texturedObjects.emplace_back(CSetOfTexturedTriangles::Create());
+	mrpt::WorkerThreadsPool::Default().parallel_for(
+		0, m.textures.size(),
+		[&](std::size_t i) {
+			auto& t = m.textures[i];
+			t.fileTime = mrpt::system::getFileModificationTime(t.fileloc);
+
+			// Query textureCache:
+			auto& cache = mrpt::opengl::internal::TexturesCache::Instance();
+			const auto& tc = cache.get(t.fileloc, verboseLoad);
+			t.load_ok = tc.load_ok;
+			if (!tc.load_ok) return;
+			t.img_rgb = tc.img_rgb;
+			t.img_alpha = tc.img_alpha;
+		},
+		1 /*one texture per task*/);
+}
+
+// ------------------------------------------------------------------------
+// Cache of preprocessed models. Each file holds one AssimpFlatModel
+// as raw arrays (colors, byte by byte), copied from the mapped file without
+// any parsing:
+//  - Header: magic, version, key, sizeof(TTriangle)
+//  - Companion files read by Assimp: path and modification time.
+//  - Bounding box, points, lines and non-textured triangles.
+//  - Per texture: name, file, modification time, the image pixels (8 bit
+//    grayscale or RGB, as stored in memory) and its triangles.
+// ------------------------------------------------------------------------
+namespace
+{
+constexpr char CACHE_MAGIC[8] = {'M', 'R', 'P', 'T', 'A', 'S', 'S', 'M'};
+constexpr uint32_t CACHE_VERSION = 2;
+
+// Hash of the contents of the model file, its directory (textures are
+// relative to it) and the import flags. Empty if the file cannot be read.
+std::optional<uint64_t> cacheKey(const std::string& filepath, int flags)
+{
+	mrpt::io::CMemoryMappedFile f;
+	if (!f.open(filepath)) return {};
+
+	// FNV-1a, 8 bytes at a time, with an extra shift to mix the high bits:
+	uint64_t h = 0xcbf29ce484222325ULL;
+	const auto mix = [&h](uint64_t w) {
+		h = (h ^ w) * 0x100000001b3ULL;
+		h ^= h >> 32;
+	};
+	using LF = CAssimpModel::LoadFlags;
+	mix(CACHE_VERSION);
+	mix(flags & ~(LF::Verbose | LF::IgnoreCache));
+	mix(std::hash<std::string>()(
+		mrpt::system::extractFileDirectory(filepath)));
+	mix(f.size());
+
+	const uint8_t* d = f.data();
+	const size_t n = f.size();
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+	{
+		uint64_t w;
+		std::memcpy(&w, d + i, sizeof(w));
+		mix(w);
+	}
+	uint64_t w = 0;
+	if (i < n) std::memcpy(&w, d + i, n - i);
+	mix(w);
+	return h;
+}
 
-		const std::string fileloc =
-			mrpt::system::filePathSeparatorsToNative(basepath + filename);
+std::string cacheFileName(const std::string& dir, uint64_t key)
+{
+	return mrpt::system::filePathSeparatorsToNative(
+		dir + "/" +
+		mrpt::format(
+			"%016llx.assimp-cache", static_cast<unsigned long long>(key)));
+}
 
-		// Query textureCache:
-		auto& cache = internal::TexturesCache::Instance();
-		auto& tc = cache.get(fileloc, m_verboseLoad);
+class CacheWriter
+{
+   public:
+	std::vector<uint8_t> buf;
 
-		if (tc.load_ok)
+	void write(const void* p, size_t n)
+	{
+		const auto* b = reinterpret_cast<const uint8_t*>(p);
+		buf.insert(buf.end(), b, b + n);
+	}
+	template <typename T>
+	void put(const T& v)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		write(&v, sizeof(T));
+	}
+	template <typename T>
+	void put(const std::vector<T>& v)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		put<uint64_t>(v.size());
+		write(v.data(), v.size() * sizeof(T));
+	}
+	// TColor is not trivially copyable (user-defined copy constructor):
+	void put(const std::vector<mrpt::img::TColor>& v)
+	{
+		put<uint64_t>(v.size());
+		for (const auto& c : v)
 		{
-			if (tc.img_alpha.has_value())
-				texturedObj->assignImage(tc.img_rgb, *tc.img_alpha);
-			else
-				texturedObj->assignImage(tc.img_rgb);
+			const uint8_t rgba[4] = {c.R, c.G, c.B, c.A};
+			write(rgba, sizeof(rgba));
 		}
 	}
+	void put(const std::string& s)
+	{
+		put<uint64_t>(s.size());
+		write(s.data(), s.size());
+	}
+	void put(const CImage& img)
+	{
+		const uint32_t w = img.getWidth(), h = img.getHeight(),
+					   ch = img.channelCount();
+		put(w);
+		put(h);
+		put(ch);
+		for (uint32_t r = 0; r < h; r++)
+			write(img.ptrLine<uint8_t>(r), w * ch);
+	}
+};
+
+class CacheReader
+{
+   public:
+	CacheReader(const uint8_t* data, size_t size)
+		: m_p(data), m_end(data + size)
+	{
+	}
+
+	void read(void* p, size_t n)
+	{
+		if (n > static_cast<size_t>(m_end - m_p))
+			THROW_EXCEPTION("Unexpected end of file");
+		if (n) std::memcpy(p, m_p, n);
+		m_p += n;
+	}
+	template <typename T>
+	void get(T& v)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		read(&v, sizeof(T));
+	}
+	template <typename T>
+	void get(std::vector<T>& v)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		uint64_t n = 0;
+		get(n);
+		ASSERT_LE_(n, static_cast<uint64_t>(m_end - m_p) / sizeof(T));
+		v.resize(n);
+		read(v.data(), n * sizeof(T));
+	}
+	void get(std::vector<mrpt::img::TColor>& v)
+	{
+		uint64_t n = 0;
+		get(n);
+		ASSERT_LE_(n, static_cast<uint64_t>(m_end - m_p) / 4);
+		v.resize(n);
+		for (auto& c : v)
+		{
+			uint8_t rgba[4];
+			read(rgba, sizeof(rgba));
+			c = mrpt::img::TColor(rgba[0], rgba[1], rgba[2], rgba[3]);
+		}
+	}
+	void get(std::string& s)
+	{
+		uint64_t n = 0;
+		get(n);
+		ASSERT_LE_(n, static_cast<uint64_t>(m_end - m_p));
+		s.assign(reinterpret_cast<const char*>(m_p), n);
+		m_p += n;
+	}
+	void get(CImage& img)
+	{
+		uint32_t w = 0, h = 0, ch = 0;
+		get(w);
+		get(h);
+		get(ch);
+		ASSERT_(ch == 1 || ch == 3);
+		ASSERT_LE_(
+			static_cast<uint64_t>(w) * h * ch,
+			static_cast<uint64_t>(m_end - m_p));
+		img.resize(w, h, ch == 1 ? mrpt::img::CH_GRAY : mrpt::img::CH_RGB);
+		for (uint32_t r = 0; r < h; r++)
+			read(img.ptrLine<uint8_t>(r), w * ch);
+	}
+
+   private:
+	const uint8_t *m_p, *m_end;
+};
+
+// Only 8 bit grayscale or RGB images are stored in cache files:
+bool isCacheableImage(const CImage& img)
+{
+	return img.getPixelDepth() == mrpt::img::PixelDepth::D8U &&
+		(img.channelCount() == 1 || img.channelCount() == 3);
 }
 
+bool writeCacheFile(
+	const std::string& fileName, uint64_t key,
+	const AssimpFlatModel& m)
+{
+	for (const auto& t : m.textures)
+		if (t.load_ok &&
+			(!isCacheableImage(t.img_rgb) ||
+			 (t.img_alpha && !isCacheableImage(*t.img_alpha))))
+			return false;
+
+	CacheWriter w;
+	w.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	w.put(CACHE_VERSION);
+	w.put(key);
+	w.put<uint32_t>(sizeof(TTriangle));
+	w.put<uint64_t>(m.companionFiles.size());
+	for (const auto& f : m.companionFiles)
+	{
+		w.put(f.first);
+		w.put(f.second);
+	}
+	w.put(m.bbox_min);
+	w.put(m.bbox_max);
+	w.put(m.pts_vbd);
+	w.put(m.pts_cbd);
+	w.put(m.lines_vbd);
+	w.put(m.lines_cbd);
+	w.put(m.tris);
+	w.put<uint64_t>(m.textures.size());
+	for (const auto& t : m.textures)
+	{
+		w.put(t.name);
+		w.put(t.fileloc);
+		w.put(t.fileTime);
+		w.put<uint8_t>(t.load_ok ? 1 : 0);
+		if (t.load_ok)
+		{
+			w.put(t.img_rgb);
+			w.put<uint8_t>(t.img_alpha.has_value() ? 1 : 0);
+			if (t.img_alpha) w.put(*t.img_alpha);
+		}
+		w.put(t.tris);
+	}
+
+	// Write a temporary file first, so other processes loading the same
+	// model never see incomplete files:
+	const std::string tmpFile =
+		fileName + mrpt::format(".%08x.tmp", std::random_device()());
+	{
+		mrpt::io::CFileOutputStream f;
+		if (!f.open(tmpFile)) return false;
+		if (f.Write(w.buf.data(), w.buf.size()) != w.buf.size())
+		{
+			f.close();
+			mrpt::system::deleteFile(tmpFile);
+			return false;
+		}
+	}
+	if (!mrpt::system::renameFile(tmpFile, fileName))
+	{
+		mrpt::system::deleteFile(tmpFile);
+		return false;
+	}
+	return true;
+}
+
+// Whether a file used by a cached model has not been modified since then:
+bool isUnchanged(const std::string& file, int64_t fileTime, bool verboseLoad)
+{
+	if (fileTime == mrpt::system::getFileModificationTime(file)) return true;
+	if (verboseLoad)
+		std::cout << "[CAssimpModel] File changed since it was cached: "
+				  << file << "\n";
+	return false;
+}
+
+// Empty if there is no valid cache file for the model:
+std::optional<AssimpFlatModel> readCacheFile(
+	const std::string& fileName, uint64_t key, bool verboseLoad)
+{
+	mrpt::io::CMemoryMappedFile f;
+	if (!f.open(fileName)) return {};
+
+	try
+	{
+		CacheReader rd(f.data(), f.size());
+		char magic[sizeof(CACHE_MAGIC)];
+		rd.read(magic, sizeof(magic));
+		uint32_t version = 0, triangleSize = 0;
+		uint64_t fileKey = 0;
+		rd.get(version);
+		rd.get(fileKey);
+		rd.get(triangleSize);
+		if (0 != std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) ||
+			version != CACHE_VERSION || fileKey != key ||
+			triangleSize != sizeof(TTriangle))
+			return {};
+
+		AssimpFlatModel m;
+		uint64_t nCompanions = 0;
+		rd.get(nCompanions);
+		for (uint64_t i = 0; i < nCompanions; i++)
+		{
+			auto& c = m.companionFiles.emplace_back();
+			rd.get(c.first);
+			rd.get(c.second);
+			if (!isUnchanged(c.first, c.second, verboseLoad)) return {};
+		}
+		rd.get(m.bbox_min);
+		rd.get(m.bbox_max);
+		rd.get(m.pts_vbd);
+		rd.get(m.pts_cbd);
+		rd.get(m.lines_vbd);
+		rd.get(m.lines_cbd);
+		rd.get(m.tris);
+		uint64_t nTextures = 0;
+		rd.get(nTextures);
+		for (uint64_t i = 0; i < nTextures; i++)
+		{
+			auto& t = m.textures.emplace_back();
+			rd.get(t.name);
+			rd.get(t.fileloc);
+			rd.get(t.fileTime);
+			if (!isUnchanged(t.fileloc, t.fileTime, verboseLoad)) return {};
+			uint8_t loadOk = 0, hasAlpha = 0;
+			rd.get(loadOk);
+			t.load_ok = loadOk != 0;
+			if (t.load_ok)
+			{
+				rd.get(t.img_rgb);
+				rd.get(hasAlpha);
+				if (hasAlpha) rd.get(t.img_alpha.emplace());
+			}
+			rd.get(t.tris);
+		}
+		return m;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "[CAssimpModel] Ignoring invalid cache file '" << fileName
+				  << "': " << mrpt::exception_to_str(e) << "\n";
+		return {};
+	}
+}
+
+// Assimp file system which records all the files opened by the importer, so
+// cache files are validated against the companion files of the model too:
+class RecordingIOSystem : public Assimp::DefaultIOSystem
+{
+   public:
+	RecordingIOSystem(std::set<std::string>& opened) : m_opened(opened) {}
+
+	Assimp::IOStream* Open(const char* file, const char* mode) override
+	{
+		Assimp::IOStream* s = Assimp::DefaultIOSystem::Open(file, mode);
+		if (s) m_opened.insert(file);
+		return s;
+	}
+
+   private:
+	std::set<std::string>& m_opened;
+};
+}  // namespace
+
 #endif	// MRPT_HAS_OPENGL_GLUT && MRPT_HAS_ASSIMP
+
+// Imports a model from a file, or from the cache. Does not access any
+// CAssimpModel object, so it can run in a loader thread.
+static AssimpFlatModel importModel(const std::string& filepath, int flags)
+{
+#if MRPT_HAS_OPENGL_GLUT && MRPT_HAS_ASSIMP
+	using LoadFlags = CAssimpModel::LoadFlags;
+	const bool verboseLoad = !!(flags & LoadFlags::Verbose);
+
+	// Try the cache first:
+	const std::string cacheDir = CAssimpModel::getCacheDirectory();
+	std::optional<uint64_t> key;
+	if (!cacheDir.empty() && !(flags & LoadFlags::IgnoreCache))
+		key = cacheKey(filepath, flags);
+	if (key)
+	{
+		auto m =
+			readCacheFile(cacheFileName(cacheDir, *key), *key, verboseLoad);
+		if (m)
+		{
+			if (verboseLoad)
+				std::cout << "[CAssimpModel] Loaded from cache: " << filepath
+						  << "\n";
+			return std::move(*m);
+		}
+	}
+
+	// Assimp flags:
+	const std::vector<std::pair<uint32_t, unsigned int>> flagMap = {
+		{LoadFlags::RealTimeFast, aiProcessPreset_TargetRealtime_Fast},
+		{LoadFlags::RealTimeQuality, aiProcessPreset_TargetRealtime_Quality},
+		{LoadFlags::RealTimeMaxQuality,
+		 aiProcessPreset_TargetRealtime_MaxQuality},
+		{LoadFlags::FlipUVs, aiProcess_FlipUVs}};
+
+	unsigned int pFlags = 0;
+	for (const auto& p : flagMap)
+		if (flags & p.first) pFlags |= p.second;
+
+	std::set<std::string> openedFiles;
+	Assimp::Importer importer;
+	// The importer takes ownership of the file system object:
+	importer.SetIOHandler(new RecordingIOSystem(openedFiles));
+	const aiScene* scene = importer.ReadFile(filepath.c_str(), pFlags);
+	if (!scene)
+	{
+		THROW_EXCEPTION_FMT(
+			"Error importing '%s': %s", filepath.c_str(),
+			importer.GetErrorString());
+	}
+
+	AssimpFlatModel m;
+
+	// Evaluate overall bbox:
+	{
+		aiVector3D scene_min, scene_max;
+		get_bounding_box(scene, &scene_min, &scene_max);
+		m.bbox_min.x = scene_min.x;
+		m.bbox_min.y = scene_min.y;
+		m.bbox_min.z = scene_min.z;
+		m.bbox_max.x = scene_max.x;
+		m.bbox_max.y = scene_max.y;
+		m.bbox_max.z = scene_max.z;
+	}
+
+	// Process all elements at once:
+	process_textures(scene, filepath, verboseLoad, m);
+
+	texture_indices_t texIdx;
+	for (size_t i = 0; i < m.textures.size(); i++)
+		texIdx[m.textures[i].name] = i;
+
+	flatten_node(scene, scene->mRootNode, mrpt::poses::CPose3D(), texIdx, m);
+
+	openedFiles.erase(filepath);
+	for (const auto& f : openedFiles)
+		m.companionFiles.emplace_back(
+			f, mrpt::system::getFileModificationTime(f));
+
+	if (key)
+	{
+		mrpt::system::createDirectory(cacheDir);
+		const bool ok = writeCacheFile(cacheFileName(cacheDir, *key), *key, m);
+		if (verboseLoad)
+			std::cout << "[CAssimpModel] "
+					  << (ok ? "Saved to cache: " : "Could not cache: ")
+					  << filepath << "\n";
+	}
+
+	return m;
+#else
+	THROW_EXCEPTION("MRPT compiled without OpenGL and/or Assimp");
+#endif
+}
@@ -0,0 +1,142 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/config.h>
+#include <mrpt/opengl/CAssimpModel.h>
+#include <mrpt/opengl/RenderQueue.h>
+#include <mrpt/system/CDirectoryExplorer.h>
+#include <mrpt/system/filesystem.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+using namespace mrpt::opengl;
+
+#if MRPT_HAS_ASSIMP && MRPT_HAS_OPENGL_GLUT
+
+// A unit cube in Wavefront OBJ format:
+static std::string cubeModelFile()
+{
+	const auto fil = mrpt::system::getTempFileName() + ".obj";
+	std::ofstream f(fil);
+	f << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+		 "v 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\n"
+		 "f 1 3 2\nf 1 4 3\nf 5 6 7\nf 5 7 8\n"
+		 "f 1 2 6\nf 1 6 5\nf 2 3 7\nf 2 7 6\n"
+		 "f 3 4 8\nf 3 8 7\nf 4 1 5\nf 4 5 8\n";
+	return fil;
+}
+
+static void checkCube(const CAssimpModel& m)
+{
+	const auto& tris = m.shaderTexturedTrianglesBuffer();
+	ASSERT_EQ(tris.size(), 12U);
+	const auto bbox = m.getBoundingBox();
+	EXPECT_NEAR(bbox.min.x, 0.0, 1e-6);
+	EXPECT_NEAR(bbox.max.z, 1.0, 1e-6);
+
+	double dist = 0;
+	EXPECT_TRUE(m.traceRay(mrpt::poses::CPose3D(-2, 0.5, 0.5, 0, 0, 0), dist));
+	EXPECT_NEAR(dist, 2.0, 1e-5);
+}
+
+constexpr int flags = CAssimpModel::LoadFlags::RealTimeFast;
+
+TEST(CAssimpModel, loadFromCache)
+{
+	const auto fil = cubeModelFile();
+	const auto cacheDir = mrpt::system::getTempFileName() + "_cache";
+	CAssimpModel::setCacheDirectory(cacheDir);
+
+	CAssimpModel m1;
+	m1.loadScene(fil, flags);
+	checkCube(m1);
+
+	mrpt::system::CDirectoryExplorer::TFileInfoList files;
+	mrpt::system::CDirectoryExplorer::explore(
+		cacheDir, FILE_ATTRIB_ARCHIVE, files);
+	EXPECT_EQ(files.size(), 1U);
+
+	// Loaded again, from the cache:
+	CAssimpModel m2;
+	m2.loadScene(fil, flags);
+	checkCube(m2);
+	const auto &t1 = m1.shaderTexturedTrianglesBuffer(),
+			   &t2 = m2.shaderTexturedTrianglesBuffer();
+	for (size_t i = 0; i < t1.size(); i++)
+		for (int v = 0; v < 3; v++)
+			EXPECT_EQ(t1[i].vertex(v), t2[i].vertex(v));
+
+	// Not cached again with other flags:
+	m2.loadScene(fil, flags | CAssimpModel::LoadFlags::IgnoreCache);
+	checkCube(m2);
+	mrpt::system::CDirectoryExplorer::explore(
+		cacheDir, FILE_ATTRIB_ARCHIVE, files);
+	EXPECT_EQ(files.size(), 1U);
+
+	CAssimpModel::setCacheDirectory({});
+	mrpt::system::deleteFilesInDirectory(cacheDir, true);
+	mrpt::system::deleteFile(fil);
+}
+
+TEST(CAssimpModel, loadSceneAsync)
+{
+	const auto fil = cubeModelFile();
+
+	CAssimpModel m;
+	std::atomic_bool called = false, success = false;
+	m.loadSceneAsync(fil, flags, [&](bool ok, const std::string&) {
+		success = ok;
+		called = true;
+	});
+	m.waitForLoad();
+	EXPECT_FALSE(m.isLoading());
+	EXPECT_TRUE(called);
+	EXPECT_TRUE(success);
+	checkCube(m);
+
+	// Applied upon the next rendering, even if the buffers were updated
+	// while loading:
+	called = false;
+	m.loadSceneAsync(fil, flags, [&](bool, const std::string&) {
+		called = true;
+	});
+	EXPECT_EQ(m.shaderTexturedTrianglesBuffer().size(), 0U);
+	m.updateCPUBuffers();
+	while (!called)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	RenderQueue rq;
+	rq.deferBufferUpdates = true;
+	m.enqueForRenderRecursive(TRenderMatrices(), rq);
+	ASSERT_EQ(rq.pendingBufferUpdates.size(), 1U);
+	EXPECT_EQ(rq.pendingBufferUpdates[0], &m);
+	checkCube(m);
+
+	// Errors:
+	called = false;
+	m.loadSceneAsync(
+		fil + ".missing.obj", flags,
+		[&](bool ok, const std::string& errorMsg) {
+			success = ok;
+			EXPECT_FALSE(errorMsg.empty());
+			called = true;
+		});
+	EXPECT_ANY_THROW(m.waitForLoad());
+	EXPECT_TRUE(called);
+	EXPECT_FALSE(success);
+	EXPECT_EQ(m.shaderTexturedTrianglesBuffer().size(), 0U);
+	// Reported only once:
+	EXPECT_NO_THROW(m.waitForLoad());
+
+	mrpt::system::deleteFile(fil);
+}
+#endif
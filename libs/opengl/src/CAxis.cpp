@@ -145,8 +145,8 @@ void CAxis::onUpdateBuffers_Wireframe()
 
 	cbd.assign(vbd.size(), m_color);
 
-	for (auto& lb : m_gl_labels)
-		lb->updateBuffers();
+	// The buffers of the labels are updated when they are enqueued for
+	// rendering, which is also safe without an OpenGL context.
 }
 
 void CAxis::enqueForRenderRecursive(
@@ -217,11 +217,43 @@ void CAxis::serializeFrom(mrpt::serialization::CArchive& in, uint8_t version)
 
 auto CAxis::getBoundingBox() const -> mrpt::math::TBoundingBox
 {
+	// Leave room for the tick marks and the text labels:
+	const double d = m_frequency + 3 * m_textScale;
 	return mrpt::math::TBoundingBox(
-			   {m_xmin, m_ymin, m_zmin}, {m_xmax, m_ymax, m_zmax})
+			   {m_xmin - d, m_ymin - d, m_zmin - d},
+			   {m_xmax + d, m_ymax + d, m_zmax + d})
 		.compose(m_pose);
 }
 
+bool CAxis::instancingKey(
+	std::string& key, mrpt::math::CMatrixFloat44& instanceTransform) const
+{
+	key = GetRuntimeClass()->className;
+	instancingKeyAppend(
+		key, m_xmin, m_ymin, m_zmin, m_xmax, m_ymax, m_zmax, m_frequency,
+		m_marks, m_textScale, m_textRot, m_markLen, m_lineWidth,
+		m_antiAliasing, m_color);
+	instanceTransform.setIdentity();
+	return true;
+}
+
+CRenderizable::Ptr CAxis::makeInstancingPrototype() const
+{
+	// A new object, not a copy, which would share our OpenGL buffers:
+	auto o = CAxis::Create(
+		m_xmin, m_ymin, m_zmin, m_xmax, m_ymax, m_zmax, m_frequency,
+		m_lineWidth);
+	o->m_marks = m_marks;
+	o->m_textScale = m_textScale;
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			o->m_textRot[i][j] = m_textRot[i][j];
+	o->m_markLen = m_markLen;
+	o->m_antiAliasing = m_antiAliasing;
+	o->m_color = m_color;
+	return o;
+}
+
 void CAxis::setFrequency(float f)
 {
 	ASSERT_(f > 0);
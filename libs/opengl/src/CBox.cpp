@@ -185,11 +185,31 @@ void CBox::setBoxCorners(
 	m_corner_max.z = std::max(corner1.z, corner2.z);
 }
 
-bool CBox::traceRay(
-	[[maybe_unused]] const mrpt::poses::CPose3D& o,
-	[[maybe_unused]] double& dist) const
+bool CBox::traceRay(const mrpt::poses::CPose3D& o, double& dist) const
 {
-	THROW_EXCEPTION("TO DO");
+	// Slab test in the box local frame, where the ray goes along +X:
+	const mrpt::poses::CPose3D ray = o - this->m_pose;
+	const auto& R = ray.getRotationMatrix();
+	double tmin = -std::numeric_limits<double>::max(),
+		   tmax = std::numeric_limits<double>::max();
+	for (int i = 0; i < 3; i++)
+	{
+		const double orig = ray.translation()[i], dir = R(i, 0);
+		if (std::abs(dir) < 1e-12)
+		{
+			if (orig < m_corner_min[i] || orig > m_corner_max[i]) return false;
+			continue;
+		}
+		double t1 = (m_corner_min[i] - orig) / dir,
+			   t2 = (m_corner_max[i] - orig) / dir;
+		if (t1 > t2) std::swap(t1, t2);
+		tmin = std::max(tmin, t1);
+		tmax = std::min(tmax, t2);
+	}
+	if (tmin > tmax || tmax < 0) return false;
+	// From inside the box, the ray hits the face it goes out through:
+	dist = tmin >= 0 ? tmin : tmax;
+	return true;
 }
 
 auto CBox::getBoundingBox() const -> mrpt::math::TBoundingBox
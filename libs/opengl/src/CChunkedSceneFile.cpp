@@ -0,0 +1,377 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "opengl-precomp.h"	 // Precompiled header
+//
+#include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/io/CFileInputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/io/zip.h>
+#include <mrpt/opengl/CChunkedSceneFile.h>
+#include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <mrpt/serialization/CArchive.h>
+
+#include <cmath>
+#include <cstring>
+
+using namespace mrpt::opengl;
+
+namespace
+{
+constexpr char SIGNATURE[8] = {'M', 'R', 'P', 'T', 'S', 'C', 'N', 'C'};
+constexpr uint8_t INDEX_VERSION = 0;
+// Objects serialized and compressed in parallel, before writing them:
+constexpr size_t SAVE_BATCH_SIZE = 256;
+
+// An object to be saved, with its entry in the index:
+struct SaveItem
+{
+	CChunkedSceneFile::ObjectEntry entry;
+	// What is serialized: a copy without children for CSetOfObjects:
+	mrpt::serialization::CSerializable::Ptr payload;
+	CRenderizable::Ptr object;
+	std::vector<uint8_t> compressed;
+	// Whether this is a set whose children are stored apart:
+	bool isSplitSet = false;
+};
+
+// Lists objects and their children in depth-first order:
+void flatten(
+	const CRenderizable::Ptr& o, uint32_t viewport, int32_t parent,
+	std::vector<SaveItem>& items)
+{
+	if (!o) return;
+	SaveItem it;
+	it.entry.className = o->GetRuntimeClass()->className;
+	it.entry.name = o->getName();
+	it.entry.viewport = viewport;
+	it.entry.parent = parent;
+	it.object = o;
+
+	// Only plain sets of objects are split, not derived classes:
+	auto set = std::dynamic_pointer_cast<CSetOfObjects>(o);
+	if (!set || o->GetRuntimeClass() != CLASS_ID(CSetOfObjects))
+	{
+		it.payload = o;
+		items.push_back(std::move(it));
+		return;
+	}
+	auto empty = std::make_shared<CSetOfObjects>(*set);
+	empty->clear();
+	it.payload = empty;
+	it.isSplitSet = true;
+	const auto index = static_cast<int32_t>(items.size());
+	items.push_back(std::move(it));
+	for (const auto& child : *set)
+		flatten(child, viewport, index, items);
+}
+
+void compress(
+	const mrpt::serialization::CSerializable& o,
+	CChunkedSceneFile::ObjectEntry& e, std::vector<uint8_t>& out)
+{
+	mrpt::io::CMemoryStream buf;
+	mrpt::serialization::archiveFrom(buf) << o;
+	e.size = buf.getTotalBytesCount();
+	mrpt::io::zip::compress(buf.getRawBufferData(), e.size, out);
+	e.compressedSize = out.size();
+}
+
+bool isValid(const mrpt::math::TBoundingBox& bb)
+{
+	return std::isfinite(
+			   bb.min.x + bb.min.y + bb.min.z + bb.max.x + bb.max.y +
+			   bb.max.z) &&
+		bb.min.x <= bb.max.x && bb.min.y <= bb.max.y && bb.min.z <= bb.max.z;
+}
+
+void writeEntry(
+	mrpt::serialization::CArchive& out, const CChunkedSceneFile::ObjectEntry& e)
+{
+	out << e.className << e.name << e.viewport << e.parent << e.hasBoundingBox
+		<< e.bbox.min.x << e.bbox.min.y << e.bbox.min.z << e.bbox.max.x
+		<< e.bbox.max.y << e.bbox.max.z << e.offset << e.compressedSize
+		<< e.size;
+}
+
+void readEntry(
+	mrpt::serialization::CArchive& in, CChunkedSceneFile::ObjectEntry& e)
+{
+	in >> e.className >> e.name >> e.viewport >> e.parent >>
+		e.hasBoundingBox >> e.bbox.min.x >> e.bbox.min.y >> e.bbox.min.z >>
+		e.bbox.max.x >> e.bbox.max.y >> e.bbox.max.z >> e.offset >>
+		e.compressedSize >> e.size;
+}
+}  // namespace
+
+CChunkedSceneFile::CChunkedSceneFile(const std::string& fileName)
+{
+	open(fileName);
+}
+
+bool CChunkedSceneFile::IsChunkedSceneFile(const std::string& fileName)
+{
+	mrpt::io::CFileInputStream f;
+	char sig[sizeof(SIGNATURE)];
+	return f.open(fileName) && f.Read(sig, sizeof(sig)) == sizeof(sig) &&
+		std::memcmp(sig, SIGNATURE, sizeof(sig)) == 0;
+}
+
+void CChunkedSceneFile::Save(
+	const COpenGLScene& scene, const std::string& fileName)
+{
+	MRPT_START
+
+	// The scene without objects:
+	COpenGLScene skeleton;
+	skeleton.m_followCamera = scene.m_followCamera;
+	skeleton.m_viewports.clear();
+	std::vector<SaveItem> items;
+	for (const auto& vp : scene.m_viewports)
+	{
+		auto empty = std::make_shared<COpenGLViewport>(*vp);
+		empty->clear();
+		skeleton.m_viewports.push_back(empty);
+
+		const auto vpIndex =
+			static_cast<uint32_t>(skeleton.m_viewports.size() - 1);
+		for (const auto& o : *vp)
+			flatten(o, vpIndex, -1, items);
+	}
+
+	mrpt::io::CFileOutputStream f;
+	if (!f.open(fileName))
+		THROW_EXCEPTION_FMT("Cannot create file: '%s'", fileName.c_str());
+	auto out = mrpt::serialization::archiveFrom(f);
+	f.Write(SIGNATURE, sizeof(SIGNATURE));
+
+	ObjectEntry skeletonEntry;
+	std::vector<uint8_t> buf;
+	compress(skeleton, skeletonEntry, buf);
+	skeletonEntry.offset = f.getPosition();
+	f.Write(buf.data(), buf.size());
+
+	// Serialize, compress and find the bounding box of objects in parallel,
+	// then write them in order:
+	auto& pool = mrpt::WorkerThreadsPool::Default();
+	for (size_t first = 0; first < items.size(); first += SAVE_BATCH_SIZE)
+	{
+		const size_t last = std::min(first + SAVE_BATCH_SIZE, items.size());
+		pool.parallel_for(
+			first, last,
+			[&](size_t i) {
+				auto& it = items[i];
+				compress(*it.payload, it.entry, it.compressed);
+				// Sets are done later, from their children:
+				if (it.isSplitSet) return;
+				try
+				{
+					const auto bb = it.object->getBoundingBox();
+					it.entry.hasBoundingBox = isValid(bb);
+					if (it.entry.hasBoundingBox)
+						it.entry.bbox = {
+							bb.min.cast<float>(), bb.max.cast<float>()};
+				}
+				catch (const std::exception&)
+				{
+					// No bounding box for this one.
+				}
+			},
+			1);
+		for (size_t i = first; i < last; i++)
+		{
+			auto& it = items[i];
+			it.entry.offset = f.getPosition();
+			f.Write(it.compressed.data(), it.compressed.size());
+			it.compressed = std::vector<uint8_t>();
+		}
+	}
+
+	// Bounding boxes of sets, from their children (which always come after
+	// their parents):
+	std::vector<mrpt::math::TBoundingBox> childrenBoxes(items.size());
+	std::vector<bool> hasChildrenBox(items.size(), false);
+	for (size_t i = items.size(); i-- > 0;)
+	{
+		auto& e = items[i].entry;
+		if (items[i].isSplitSet && hasChildrenBox[i])
+		{
+			const auto bb =
+				childrenBoxes[i].compose(items[i].object->getPose());
+			e.hasBoundingBox = true;
+			e.bbox = {bb.min.cast<float>(), bb.max.cast<float>()};
+		}
+		if (e.parent < 0 || !e.hasBoundingBox) continue;
+		const mrpt::math::TBoundingBox bb(
+			e.bbox.min.cast<double>(), e.bbox.max.cast<double>());
+		auto& pb = childrenBoxes[e.parent];
+		pb = hasChildrenBox[e.parent] ? pb.unionWith(bb) : bb;
+		hasChildrenBox[e.parent] = true;
+	}
+
+	// The index, its position and the signature again:
+	const uint64_t indexOffset = f.getPosition();
+	out << INDEX_VERSION;
+	writeEntry(out, skeletonEntry);
+	out.WriteAs<uint64_t>(items.size());
+	for (const auto& it : items)
+		writeEntry(out, it.entry);
+	out << indexOffset;
+	f.Write(SIGNATURE, sizeof(SIGNATURE));
+
+	MRPT_END
+}
+
+void CChunkedSceneFile::open(const std::string& fileName)
+{
+	MRPT_START
+
+	m_objects.clear();
+	m_inserted.clear();
+	m_indexOffset = 0;
+	if (!m_file.open(fileName))
+		THROW_EXCEPTION_FMT("Cannot open file: '%s'", fileName.c_str());
+
+	const uint8_t* data = m_file.data();
+	const size_t n = m_file.size();
+	const size_t sigSize = sizeof(SIGNATURE);
+	if (n < 2 * sigSize + sizeof(uint64_t) ||
+		std::memcmp(data, SIGNATURE, sigSize) != 0 ||
+		std::memcmp(data + n - sigSize, SIGNATURE, sigSize) != 0)
+	{
+		m_file.close();
+		THROW_EXCEPTION_FMT(
+			"Not a chunked scene file, or truncated: '%s'", fileName.c_str());
+	}
+
+	const size_t footer = n - sigSize - sizeof(uint64_t);
+	uint64_t indexOffset = 0;
+	{
+		mrpt::io::CMemoryStream ms;
+		ms.assignMemoryNotOwn(data + footer, sizeof(uint64_t));
+		auto in = mrpt::serialization::archiveFrom(ms);
+		in >> indexOffset;
+	}
+	ASSERT_GE_(indexOffset, sigSize);
+	ASSERT_LT_(indexOffset, footer);
+	m_indexOffset = indexOffset;
+
+	mrpt::io::CMemoryStream ms;
+	ms.assignMemoryNotOwn(data + indexOffset, footer - indexOffset);
+	auto in = mrpt::serialization::archiveFrom(ms);
+	uint8_t version;
+	in >> version;
+	if (version != INDEX_VERSION)
+		THROW_EXCEPTION_FMT(
+			"Unsupported chunked scene file version: %u",
+			static_cast<unsigned>(version));
+	readEntry(in, m_skeleton);
+	uint64_t count;
+	in >> count;
+	ASSERT_LE_(count, (footer - indexOffset) / sizeof(uint64_t));
+	m_objects.resize(count);
+	for (auto& e : m_objects)
+	{
+		readEntry(in, e);
+		ASSERT_LT_(e.parent, static_cast<int32_t>(&e - m_objects.data()));
+	}
+
+	MRPT_END
+}
+
+std::vector<uint8_t> CChunkedSceneFile::decompress(const ObjectEntry& e) const
+{
+	ASSERTMSG_(isOpen(), "No file is open");
+	ASSERT_GE_(e.offset, sizeof(SIGNATURE));
+	// Written so that corrupted values cannot overflow:
+	ASSERT_LE_(e.compressedSize, m_indexOffset);
+	ASSERT_LE_(e.offset, m_indexOffset - e.compressedSize);
+	// zlib expands data by at most 1032:1, so don't allocate more:
+	ASSERT_LE_(e.size / 1032, e.compressedSize);
+	std::vector<uint8_t> buf(e.size);
+	size_t actualSize = 0;
+	mrpt::io::zip::decompress(
+		const_cast<uint8_t*>(m_file.data() + e.offset), e.compressedSize,
+		buf.data(), buf.size(), actualSize);
+	ASSERT_EQUAL_(actualSize, buf.size());
+	return buf;
+}
+
+void CChunkedSceneFile::loadSkeleton(COpenGLScene& scene)
+{
+	auto buf = decompress(m_skeleton);
+	mrpt::io::CMemoryStream ms;
+	ms.assignMemoryNotOwn(buf.data(), buf.size());
+	auto in = mrpt::serialization::archiveFrom(ms);
+	in >> scene;
+	m_inserted.assign(m_objects.size(), nullptr);
+}
+
+CRenderizable::Ptr CChunkedSceneFile::loadObject(size_t index) const
+{
+	ASSERT_LT_(index, m_objects.size());
+	auto buf = decompress(m_objects[index]);
+	mrpt::io::CMemoryStream ms;
+	ms.assignMemoryNotOwn(buf.data(), buf.size());
+	auto obj = std::dynamic_pointer_cast<CRenderizable>(
+		mrpt::serialization::archiveFrom(ms).ReadObject());
+	ASSERTMSG_(obj, "Stored object is not a CRenderizable");
+	return obj;
+}
+
+std::vector<CRenderizable::Ptr> CChunkedSceneFile::loadObjects(
+	size_t first, size_t last) const
+{
+	ASSERT_LE_(first, last);
+	ASSERT_LE_(last, m_objects.size());
+	std::vector<CRenderizable::Ptr> objs(last - first);
+	mrpt::WorkerThreadsPool::Default().parallel_for(
+		first, last, [&](size_t i) { objs[i - first] = loadObject(i); }, 1);
+	return objs;
+}
+
+bool CChunkedSceneFile::insertObject(
+	COpenGLScene& scene, size_t index, const CRenderizable::Ptr& obj)
+{
+	ASSERT_LT_(index, m_objects.size());
+	ASSERTMSG_(
+		m_inserted.size() == m_objects.size(),
+		"loadSkeleton() must be called first");
+	const auto& e = m_objects[index];
+	if (!obj) return false;
+
+	if (e.parent < 0)
+	{
+		ASSERT_LT_(e.viewport, scene.viewportsCount());
+		scene.viewports()[e.viewport]->insert(obj);
+	}
+	else
+	{
+		auto parent =
+			std::dynamic_pointer_cast<CSetOfObjects>(m_inserted[e.parent]);
+		if (!parent) return false;
+		parent->insert(obj);
+	}
+	// Only containers are kept, for their children:
+	if (std::dynamic_pointer_cast<CSetOfObjects>(obj)) m_inserted[index] = obj;
+	return true;
+}
+
+void CChunkedSceneFile::loadScene(COpenGLScene& scene)
+{
+	MRPT_START
+	loadSkeleton(scene);
+	const auto objs = loadObjects(0, m_objects.size());
+	for (size_t i = 0; i < objs.size(); i++)
+		insertObject(scene, i, objs[i]);
+	m_inserted.assign(m_objects.size(), nullptr);
+	MRPT_END
+}
@@ -0,0 +1,155 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/io/CFileInputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/opengl/CAxis.h>
+#include <mrpt/opengl/CBox.h>
+#include <mrpt/opengl/CChunkedSceneFile.h>
+#include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/opengl/CPointCloud.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <mrpt/opengl/CSphere.h>
+#include <mrpt/system/filesystem.h>
+
+using namespace mrpt::opengl;
+
+static COpenGLScene::Ptr testScene()
+{
+	auto scene = COpenGLScene::Create();
+	scene->enableFollowCamera(true);
+	scene->getViewport()->getCamera().setZoomDistance(42);
+
+	auto box = CBox::Create(
+		mrpt::math::TPoint3D(0, 0, 0), mrpt::math::TPoint3D(1, 2, 3));
+	box->setName("box");
+	scene->insert(box);
+
+	// Nested sets:
+	auto set = CSetOfObjects::Create();
+	set->setName("set");
+	set->setLocation(10, 0, 0);
+	auto axis = CAxis::Create(-1, -1, -1, 1, 1, 1, 1, 1, false);
+	axis->setName("axis");
+	set->insert(axis);
+	auto inner = CSetOfObjects::Create();
+	inner->setName("inner");
+	inner->insert(CSphere::Create(0.5f));
+	set->insert(inner);
+	scene->insert(set);
+
+	auto vp = scene->createViewport("small");
+	vp->setViewportPosition(0, 0, 0.2, 0.2);
+	auto pc = CPointCloud::Create();
+	for (int i = 0; i < 1000; i++)
+		pc->insertPoint(i * 0.1f, 0, 0);
+	pc->setName("cloud");
+	scene->insert(pc, "small");
+	return scene;
+}
+
+TEST(CChunkedSceneFile, saveAndLoad)
+{
+	const auto scene = testScene();
+	const auto fil = mrpt::system::getTempFileName();
+	ASSERT_TRUE(scene->saveToFile(fil, true));
+	EXPECT_TRUE(CChunkedSceneFile::IsChunkedSceneFile(fil));
+
+	CChunkedSceneFile f(fil);
+	const auto& objs = f.objects();
+	ASSERT_EQ(objs.size(), 6U);
+	EXPECT_EQ(objs[0].name, "box");
+	EXPECT_EQ(objs[0].className, "mrpt::opengl::CBox");
+	EXPECT_TRUE(objs[0].hasBoundingBox);
+	EXPECT_NEAR(objs[0].bbox.max.z, 3.0f, 1e-5f);
+	EXPECT_EQ(objs[1].name, "set");
+	EXPECT_EQ(objs[1].parent, -1);
+	EXPECT_EQ(objs[2].name, "axis");
+	EXPECT_EQ(objs[2].parent, 1);
+	EXPECT_EQ(objs[3].name, "inner");
+	EXPECT_EQ(objs[3].parent, 1);
+	EXPECT_EQ(objs[4].parent, 3);
+	EXPECT_EQ(objs[5].name, "cloud");
+	EXPECT_EQ(objs[5].viewport, 1U);
+	// The box of a set includes its children, in the frame of its parent:
+	ASSERT_TRUE(objs[1].hasBoundingBox);
+	EXPECT_GT(objs[1].bbox.min.x, 5.0f);
+
+	// Same scene as saved:
+	COpenGLScene loaded;
+	ASSERT_TRUE(loaded.loadFromFile(fil));
+	EXPECT_TRUE(loaded.followCamera());
+	ASSERT_EQ(loaded.viewportsCount(), 2U);
+	EXPECT_EQ(loaded.getViewport()->getCamera().getZoomDistance(), 42.0f);
+	EXPECT_EQ(loaded.getViewport()->size(), 2U);
+	auto set = loaded.getByClass<CSetOfObjects>();
+	ASSERT_TRUE(set);
+	EXPECT_EQ(set->size(), 2U);
+	EXPECT_EQ(set->getPoseX(), 10.0);
+	auto pc = loaded.getViewport("small")->getByClass<CPointCloud>();
+	ASSERT_TRUE(pc);
+	EXPECT_EQ(pc->size(), 1000U);
+	EXPECT_EQ(loaded.asYAML().size(), scene->asYAML().size());
+
+	mrpt::system::deleteFile(fil);
+}
+
+TEST(CChunkedSceneFile, progressiveLoad)
+{
+	const auto fil = mrpt::system::getTempFileName();
+	ASSERT_TRUE(testScene()->saveToFile(fil, true));
+
+	CChunkedSceneFile f(fil);
+	COpenGLScene scene;
+	f.loadSkeleton(scene);
+	EXPECT_EQ(scene.viewportsCount(), 2U);
+	EXPECT_EQ(scene.getViewport()->size(), 0U);
+
+	// Children cannot be inserted before their parents:
+	EXPECT_FALSE(f.insertObject(scene, 2, f.loadObject(2)));
+
+	const auto objs = f.loadObjects(0, f.objects().size());
+	for (size_t i = 0; i < objs.size(); i++)
+		EXPECT_TRUE(f.insertObject(scene, i, objs[i]));
+	EXPECT_EQ(scene.getViewport()->size(), 2U);
+	EXPECT_EQ(scene.getViewport("small")->size(), 1U);
+
+	mrpt::system::deleteFile(fil);
+}
+
+TEST(CChunkedSceneFile, formatDetection)
+{
+	const auto fil = mrpt::system::getTempFileName();
+	ASSERT_TRUE(testScene()->saveToFile(fil));
+	EXPECT_FALSE(CChunkedSceneFile::IsChunkedSceneFile(fil));
+	COpenGLScene scene;
+	EXPECT_TRUE(scene.loadFromFile(fil));
+	EXPECT_EQ(scene.viewportsCount(), 2U);
+
+	// Truncated files are detected:
+	ASSERT_TRUE(testScene()->saveToFile(fil, true));
+	{
+		CChunkedSceneFile f(fil);
+		EXPECT_EQ(f.objects().size(), 6U);
+	}
+	const auto sz = mrpt::system::getFileSize(fil);
+	{
+		std::vector<char> buf(sz - 3, 0);
+		mrpt::io::CFileInputStream in(fil);
+		in.Read(buf.data(), buf.size());
+		in.close();
+		mrpt::io::CFileOutputStream out(fil);
+		out.Write(buf.data(), buf.size());
+	}
+	EXPECT_ANY_THROW(CChunkedSceneFile f(fil));
+	EXPECT_FALSE(scene.loadFromFile(fil));
+
+	mrpt::system::deleteFile(fil);
+}
@@ -83,6 +83,12 @@ void CColorBar::renderUpdateBuffers() const
 	CRenderizableShaderWireFrame::renderUpdateBuffers();
 }
 
+void CColorBar::onUpdateCPUBuffers()
+{
+	onUpdateBuffers_all();
+	CRenderizable::onUpdateCPUBuffers();
+}
+
 void CColorBar::onUpdateBuffers_all()
 {
 	auto& tris = CRenderizableShaderTriangles::m_triangles;
@@ -22,12 +22,30 @@ using mrpt::img::CImage;
 ---------------------------------------------------------------*/
 CFBORender::CFBORender(
 	unsigned int width, unsigned int height, const bool skip_glut_window)
+	: CFBORender([=]() {
+		  Parameters p;
+		  p.width = width;
+		  p.height = height;
+		  p.skip_glut_window = skip_glut_window;
+		  return p;
+	  }())
 {
+}
+
+CFBORender::CFBORender(const Parameters& p)
+{
+	if (p.software)
+	{
+		m_software = std::make_unique<SoftwareRasterizer>(
+			p.width, p.height, p.softwareThreads);
+		return;
+	}
+
 #if MRPT_HAS_OPENCV && MRPT_HAS_OPENGL_GLUT
 
 	MRPT_START
 
-	if (!skip_glut_window)
+	if (!p.skip_glut_window)
 	{
 		// check a previous initialization of the GLUT
 		if (!glutGet(GLUT_INIT_STATE))
@@ -46,7 +64,7 @@ CFBORender::CFBORender(
 	// -------------------------------
 	// Create frame buffer object:
 	// -------------------------------
-	m_fb.create(width, height);
+	m_fb.create(p.width, p.height);
 	const auto oldFB = m_fb.bind();
 
 	// -------------------------------
@@ -85,6 +103,8 @@ CFBORender::CFBORender(
 
 CFBORender::~CFBORender()
 {
+	if (m_software) return;
+
 #if MRPT_HAS_OPENGL_GLUT
 	// delete the current texture, the framebuffer object and the GLUT window
 	glDeleteTextures(1, &m_texRGB);
@@ -94,11 +114,16 @@ CFBORender::~CFBORender()
 }
 
 void CFBORender::internal_render_RGBD(
-	[[maybe_unused]] const COpenGLScene& scene,
-	[[maybe_unused]] const mrpt::optional_ref<mrpt::img::CImage>& optoutRGB,
-	[[maybe_unused]] const mrpt::optional_ref<mrpt::math::CMatrixFloat>&
-		optoutDepth)
+	const COpenGLScene& scene,
+	const mrpt::optional_ref<mrpt::img::CImage>& optoutRGB,
+	const mrpt::optional_ref<mrpt::math::CMatrixFloat>& optoutDepth)
 {
+	if (m_software)
+	{
+		m_software->render(*scene.getViewport(), optoutRGB, optoutDepth);
+		return;
+	}
+
 #if MRPT_HAS_OPENCV && MRPT_HAS_OPENGL_GLUT
 
 	MRPT_START
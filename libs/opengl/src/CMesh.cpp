@@ -9,6 +9,7 @@
 
 #include "opengl-precomp.h"	 // Precompiled header
 //
+#include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/img/color_maps.h>
 #include <mrpt/math/ops_containers.h>
 #include <mrpt/opengl/CMesh.h>
@@ -18,6 +19,8 @@
 #include <mrpt/serialization/CArchive.h>
 
 #include <Eigen/Dense>
+#include <algorithm>
+#include <array>
 
 using namespace mrpt;
 using namespace mrpt::opengl;
@@ -54,25 +57,24 @@ CMesh::CMesh(
 
 CMesh::~CMesh() = default;
 
+// Normal of a triangle, with a length proportional to its area:
+static TPoint3D faceNormal(
+	const TPoint3Df& p0, const TPoint3Df& p1, const TPoint3Df& p2)
+{
+	// A = P1 - P0, B = P2 - P0
+	const float ax = p1.x - p0.x, ay = p1.y - p0.y, az = p1.z - p0.z;
+	const float bx = p2.x - p0.x, by = p2.y - p0.y, bz = p2.z - p0.z;
+	return TPoint3D(ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx);
+}
+
 void CMesh::updateTriangles() const
 {
 	using mrpt::img::colormap;
 
 	CRenderizable::notifyChange();
 
-	// Remember:
-	/** List of triangles in the mesh */
-	// mutable
-	// std::vector<std::pair<mrpt::opengl::TTriangle,TTriangleVertexIndices>
-	// > actualMesh;
-
-	/** The accumulated normals & counts for each vertex, so normals can be
-	 * averaged. */
-	// mutable std::vector<std::pair<mrpt::math::TPoint3D,size_t> >
-	// vertex_normals;
-
-	const auto cols = Z.cols();
-	const auto rows = Z.rows();
+	const int cols = static_cast<int>(Z.cols());
+	const int rows = static_cast<int>(Z.rows());
 
 	actualMesh.clear();
 	if (cols == 0 && rows == 0) return;	 // empty mesh
@@ -97,196 +99,191 @@ void CMesh::updateTriangles() const
 	const float sCellX = (m_xMax - m_xMin) / (rows - 1);
 	const float sCellY = (m_yMax - m_yMin) / (cols - 1);
 
-	mrpt::opengl::TTriangle tri;
+	const auto vertex = [&](int iX, int iY) {
+		return TPoint3Df(
+			m_xMin + iX * sCellX, m_yMin + iY * sCellY, Z(iX, iY));
+	};
+
+	// Each cell (iX,iY) has up to 2 triangles, with vertices:
+	//  A: (iX,iY), (iX+1,iY), (iX+1,iY+1)
+	//  B: (iX,iY), (iX+1,iY+1), (iX,iY+1)
+	const auto hasA = [&](int iX, int iY) {
+		return !useMask ||
+			(mask(iX, iY) && mask(iX + 1, iY + 1) && mask(iX + 1, iY));
+	};
+	const auto hasB = [&](int iX, int iY) {
+		return !useMask ||
+			(mask(iX, iY) && mask(iX + 1, iY + 1) && mask(iX, iY + 1));
+	};
+	const auto normalA = [&](int iX, int iY) {
+		return faceNormal(
+			vertex(iX, iY), vertex(iX + 1, iY), vertex(iX + 1, iY + 1));
+	};
+	const auto normalB = [&](int iX, int iY) {
+		return faceNormal(
+			vertex(iX, iY), vertex(iX + 1, iY + 1), vertex(iX, iY + 1));
+	};
+
+	auto& pool = mrpt::WorkerThreadsPool::Default();
 
-	for (int iX = 0; iX < rows - 1; iX++)
-		for (int iY = 0; iY < cols - 1; iY++)
+	// Average the normals of all triangles around each vertex. Each vertex
+	// gathers them from its (up to) 4 neighbor cells, so all vertices can be
+	// processed in parallel:
+	pool.parallel_for(0, rows, [&](size_t i) {
+		const int iX = static_cast<int>(i);
+		for (int iY = 0; iY < cols; iY++)
 		{
-			if (useMask && (!mask(iX, iY) || !mask(iX + 1, iY + 1))) continue;
-			tri.x(0) = m_xMin + iX * sCellX;
-			tri.y(0) = m_yMin + iY * sCellY;
-			tri.z(0) = Z(iX, iY);
-			tri.x(2) = tri.x(0) + sCellX;
-			tri.y(2) = tri.y(0) + sCellY;
-			tri.z(2) = Z(iX + 1, iY + 1);
-
-			// Vertex indices:
-			TTriangleVertexIndices tvi;
-			tvi.vind[0] = iX + rows * iY;
-			tvi.vind[2] = (iX + 1) + rows * (iY + 1);
-
-			// Each quadrangle has up to 2 triangles:
-			//  [0]
-			//   |
-			//   |
-			//  [1]--[2]
-			// Order: 0,1,2
-			if (!useMask || mask(iX + 1, iY))
+			auto& [n, count] = vertex_normals[iX + rows * iY];
+			const auto add = [&](const TPoint3D& v) {
+				n += v;
+				count++;
+			};
+			const bool lastX = iX + 1 >= rows, lastY = iY + 1 >= cols;
+			if (!lastX && !lastY)
 			{
-				tri.x(1) = tri.x(2);
-				tri.y(1) = tri.y(0);
-				tri.z(1) = Z(iX + 1, iY);
-				// Assign alpha channel
-				for (int i = 0; i < 3; i++)
-					tri.a(i) = m_color.A;
-
-				if (m_colorFromZ)
-				{
-					mrpt::img::TColorf col(0, 0, 0, 1);
-					colormap(m_colorMap, C(iX, iY), col.R, col.G, col.B);
-					tri.r(0) = f2u8(col.R);
-					tri.g(0) = f2u8(col.G);
-					tri.b(0) = f2u8(col.B);
-					colormap(m_colorMap, C(iX + 1, iY), col.R, col.G, col.B);
-					tri.r(1) = f2u8(col.R);
-					tri.g(1) = f2u8(col.G);
-					tri.b(1) = f2u8(col.B);
-					colormap(
-						m_colorMap, C(iX + 1, iY + 1), col.R, col.G, col.B);
-					tri.r(2) = f2u8(col.R);
-					tri.g(2) = f2u8(col.G);
-					tri.b(2) = f2u8(col.B);
-				}
-				else if (m_isImage)
-				{
-					if (getTextureImage().isColor())
-					{
-						tri.r(0) = tri.r(1) = tri.r(2) = C_r(iX, iY);
-						tri.g(0) = tri.g(1) = tri.g(2) = C_g(iX, iY);
-						tri.b(0) = tri.b(1) = tri.b(2) = C_b(iX, iY);
-					}
-					else
-					{
-						tri.r(0) = tri.r(1) = tri.r(2) = C(iX, iY);
-						tri.g(0) = tri.g(1) = tri.g(2) = C(iX, iY);
-						tri.b(0) = tri.b(1) = tri.b(2) = C(iX, iY);
-					}
-				}
-				else
-				{
-					tri.r(0) = tri.r(1) = tri.r(2) = m_color.R / 255.f;
-					tri.g(0) = tri.g(1) = tri.g(2) = m_color.G / 255.f;
-					tri.b(0) = tri.b(1) = tri.b(2) = m_color.B / 255.f;
-				}
-
-				// Compute normal of this triangle, and add it up to the 3
-				// neighboring vertices:
-				// A = P1 - P0, B = P2 - P0
-				float ax = tri.x(1) - tri.x(0);
-				float bx = tri.x(2) - tri.x(0);
-				float ay = tri.y(1) - tri.y(0);
-				float by = tri.y(2) - tri.y(0);
-				float az = tri.z(1) - tri.z(0);
-				float bz = tri.z(2) - tri.z(0);
-				const TPoint3D this_normal(
-					ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx);
-
-				// Vertex indices:
-				tvi.vind[1] = iX + 1 + rows * iY;
-
-				// Add triangle:
-				actualMesh.emplace_back(tri, tvi);
-
-				// For averaging normals:
-				for (unsigned long k : tvi.vind)
-				{
-					vertex_normals[k].first += this_normal;
-					vertex_normals[k].second++;
-				}
+				if (hasA(iX, iY)) add(normalA(iX, iY));
+				if (hasB(iX, iY)) add(normalB(iX, iY));
 			}
-			// 2:
-			//  [0]--[1->2]
-			//     \  |
-			//       \|
-			//       [2->1]
-			// Order: 0,2,1
-			if (!useMask || mask(iX, iY + 1))
+			if (iX > 0 && !lastY && hasA(iX - 1, iY))
+				add(normalA(iX - 1, iY));
+			if (iX > 0 && iY > 0)
 			{
-				tri.x(1) = tri.x(2);
-				tri.y(1) = tri.y(2);
-				tri.z(1) = tri.z(2);
-
-				tri.x(2) = tri.x(0);
-				// tri.y(2)=tri.y(1);
-				tri.z(2) = Z(iX, iY + 1);
-				if (m_colorFromZ)
-				{
-					mrpt::img::TColorf col(0, 0, 0, 1);
-
-					colormap(m_colorMap, C(iX, iY), col.R, col.G, col.B);
-					tri.r(0) = f2u8(col.R);
-					tri.g(0) = f2u8(col.G);
-					tri.b(0) = f2u8(col.B);
-					colormap(
-						m_colorMap, C(iX + 1, iY + 1), col.R, col.G, col.B);
-					tri.r(1) = f2u8(col.R);
-					tri.g(1) = f2u8(col.G);
-					tri.b(1) = f2u8(col.B);
-					colormap(m_colorMap, C(iX, iY + 1), col.R, col.G, col.B);
-					tri.r(2) = f2u8(col.R);
-					tri.g(2) = f2u8(col.G);
-					tri.b(2) = f2u8(col.B);
-				}
-				else if (m_isImage)
-				{
-					if (getTextureImage().isColor())
-					{
-						tri.r(0) = tri.r(1) = tri.r(2) = C_r(iX, iY);
-						tri.g(0) = tri.g(1) = tri.g(2) = C_g(iX, iY);
-						tri.b(0) = tri.b(1) = tri.b(2) = C_b(iX, iY);
-					}
-					else
-					{
-						tri.r(0) = tri.r(1) = tri.r(2) = C(iX, iY);
-						tri.g(0) = tri.g(1) = tri.g(2) = C(iX, iY);
-						tri.b(0) = tri.b(1) = tri.b(2) = C(iX, iY);
-					}
-				}
-				else
-				{
-					tri.r(0) = tri.r(1) = tri.r(2) = m_color.R / 255.f;
-					tri.g(0) = tri.g(1) = tri.g(2) = m_color.G / 255.f;
-					tri.b(0) = tri.b(1) = tri.b(2) = m_color.B / 255.f;
-				}
+				if (hasA(iX - 1, iY - 1)) add(normalA(iX - 1, iY - 1));
+				if (hasB(iX - 1, iY - 1)) add(normalB(iX - 1, iY - 1));
+			}
+			if (iY > 0 && !lastX && hasB(iX, iY - 1))
+				add(normalB(iX, iY - 1));
 
-				// Compute normal of this triangle, and add it up to the 3
-				// neighboring vertices:
-				// A = P1 - P0, B = P2 - P0
-				float ax = tri.x(1) - tri.x(0);
-				float bx = tri.x(2) - tri.x(0);
-				float ay = tri.y(1) - tri.y(0);
-				float by = tri.y(2) - tri.y(0);
-				float az = tri.z(1) - tri.z(0);
-				float bz = tri.z(2) - tri.z(0);
-				const TPoint3D this_normal(
-					ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx);
-
-				// Vertex indices:
-				tvi.vind[1] = tvi.vind[2];
-				tvi.vind[2] = iX + rows * (iY + 1);
-
-				// Add triangle:
-				actualMesh.emplace_back(tri, tvi);
-
-				// For averaging normals:
-				for (unsigned long k : tvi.vind)
-				{
-					vertex_normals[k].first += this_normal;
-					vertex_normals[k].second++;
-				}
+			if (count > 0)
+			{
+				n *= 1.0 / count;
+				n = n.unitarize();
 			}
 		}
+	});
 
-	// Average normals:
-	for (auto& vertex_normal : vertex_normals)
-	{
-		const size_t N = vertex_normal.second;
-		if (N > 0)
+	using mesh_triangle_t = std::pair<TTriangle, TTriangleVertexIndices>;
+
+	// Appends the triangle with grid vertices (x[k],y[k]), k=0,1,2, with the
+	// texture color of the cell of its first vertex:
+	const auto addTriangle = [&](std::vector<mesh_triangle_t>& out,
+								 const std::array<int, 3>& x,
+								 const std::array<int, 3>& y) {
+		auto& [tri, tvi] = out.emplace_back();
+		for (int k = 0; k < 3; k++)
 		{
-			vertex_normal.first *= 1.0 / N;
-			vertex_normal.first = vertex_normal.first.unitarize();
+			tri.vertices[k].xyzrgba.pt = vertex(x[k], y[k]);
+			tvi.vind[k] = x[k] + rows * y[k];
+
+			mrpt::img::TColorf col(
+				m_color.R / 255.f, m_color.G / 255.f, m_color.B / 255.f);
+			if (m_colorFromZ)
+				colormap(m_colorMap, C(x[k], y[k]), col.R, col.G, col.B);
+			else if (m_isImage && getTextureImage().isColor())
+				col = mrpt::img::TColorf(
+					C_r(x[0], y[0]), C_g(x[0], y[0]), C_b(x[0], y[0]));
+			else if (m_isImage)
+				col = mrpt::img::TColorf(
+					C(x[0], y[0]), C(x[0], y[0]), C(x[0], y[0]));
+			tri.r(k) = f2u8(col.R);
+			tri.g(k) = f2u8(col.G);
+			tri.b(k) = f2u8(col.B);
+			tri.a(k) = m_color.A;
 		}
-	}
+	};
+
+	// Merging cells is only possible without per-cell texture colors:
+	const bool merge = m_quadMerging && !m_isImage;
+
+	// Whether the 4 corners of a cell have both triangles and a height of
+	// `z` (within the merging tolerance):
+	const auto isFlat = [&](int iX, int iY, float z) {
+		if (!hasA(iX, iY) || !hasB(iX, iY)) return false;
+		for (int dx = 0; dx < 2; dx++)
+			for (int dy = 0; dy < 2; dy++)
+				if (std::abs(Z(iX + dx, iY + dy) - z) >
+					m_quadMergingTolerance)
+					return false;
+		return true;
+	};
+
+	// Triangles are generated in parallel for blocks of rows of cells, each
+	// one into its own buffer. Merged rectangles never span across blocks,
+	// so the result is the same for any number of threads.
+	const int BLOCK_ROWS = 32;
+	const int nCellRows = rows - 1, nCellCols = cols - 1;
+	const size_t nBlocks = (std::max(nCellRows, 0) + BLOCK_ROWS - 1) /
+		BLOCK_ROWS;
+	std::vector<std::vector<mesh_triangle_t>> blocks(nBlocks);
+
+	pool.parallel_for(
+		0, nBlocks,
+		[&](size_t b) {
+			const int x0 = static_cast<int>(b) * BLOCK_ROWS;
+			const int x1 = std::min(x0 + BLOCK_ROWS, nCellRows);
+			auto& out = blocks[b];
+			out.reserve(2 * (x1 - x0) * nCellCols);
+
+			// Cells already in a merged rectangle:
+			std::vector<bool> done;
+			if (merge) done.assign((x1 - x0) * nCellCols, false);
+			const auto isDone = [&](int iX, int iY) {
+				return done[(iX - x0) * nCellCols + iY];
+			};
+
+			for (int iX = x0; iX < x1; iX++)
+				for (int iY = 0; iY < nCellCols; iY++)
+				{
+					if (merge && isDone(iX, iY)) continue;
+
+					const float z = Z(iX, iY);
+					if (merge && isFlat(iX, iY, z))
+					{
+						// Greedy: grow along Y first, then along X while
+						// whole rows of the rectangle are flat:
+						int lenY = 1;
+						while (iY + lenY < nCellCols &&
+							   !isDone(iX, iY + lenY) &&
+							   isFlat(iX, iY + lenY, z))
+							lenY++;
+						int lenX = 1;
+						for (; iX + lenX < x1; lenX++)
+						{
+							bool rowOk = true;
+							for (int k = 0; k < lenY && rowOk; k++)
+								rowOk = !isDone(iX + lenX, iY + k) &&
+									isFlat(iX + lenX, iY + k, z);
+							if (!rowOk) break;
+						}
+						for (int dx = 0; dx < lenX; dx++)
+							for (int dy = 0; dy < lenY; dy++)
+								done[(iX + dx - x0) * nCellCols + iY + dy] =
+									true;
+
+						const int xe = iX + lenX, ye = iY + lenY;
+						addTriangle(out, {iX, xe, xe}, {iY, iY, ye});
+						addTriangle(out, {iX, xe, iX}, {iY, ye, ye});
+						continue;
+					}
+
+					if (hasA(iX, iY))
+						addTriangle(
+							out, {iX, iX + 1, iX + 1}, {iY, iY, iY + 1});
+					if (hasB(iX, iY))
+						addTriangle(
+							out, {iX, iX + 1, iX}, {iY, iY + 1, iY + 1});
+				}
+		},
+		1);
+
+	size_t nTriangles = 0;
+	for (const auto& b : blocks)
+		nTriangles += b.size();
+	actualMesh.reserve(nTriangles);
+	for (auto& b : blocks)
+		actualMesh.insert(
+			actualMesh.end(), std::make_move_iterator(b.begin()),
+			std::make_move_iterator(b.end()));
 
 	m_trianglesUpToDate = true;
 	m_polygonsUpToDate = false;
@@ -313,61 +310,62 @@ void CMesh::renderUpdateBuffers() const
 	CRenderizableShaderWireFrame::renderUpdateBuffers();
 }
 
+void CMesh::onUpdateCPUBuffers()
+{
+	if (!m_trianglesUpToDate) updateTriangles();
+	CRenderizable::onUpdateCPUBuffers();
+}
+
 void CMesh::onUpdateBuffers_Wireframe()
 {
 	auto& vbd = CRenderizableShaderWireFrame::m_vertex_buffer_data;
 	auto& cbd = CRenderizableShaderWireFrame::m_color_buffer_data;
-	vbd.clear();
-	cbd.clear();
 
-	for (auto& i : actualMesh)
-	{
-		const mrpt::opengl::TTriangle& t = i.first;
-
-		for (int kk = 0; kk <= 3; kk++)
-		{
-			int k = kk % 3;
-			int k1 = (kk + 1) % 3;
+	// 4 segments (8 vertices) per triangle:
+	vbd.resize(8 * actualMesh.size());
+	cbd.resize(8 * actualMesh.size());
 
-			vbd.emplace_back(t.x(k), t.y(k), t.z(k));
-			cbd.emplace_back(t.r(k), t.g(k), t.b(k), t.a(k));
-
-			vbd.emplace_back(t.x(k1), t.y(k1), t.z(k1));
-			cbd.emplace_back(t.r(k1), t.g(k1), t.b(k1), t.a(k1));
-		}
-	}
+	mrpt::WorkerThreadsPool::Default().parallel_for(
+		0, actualMesh.size(),
+		[&](size_t i) {
+			const mrpt::opengl::TTriangle& t = actualMesh[i].first;
+			size_t idx = 8 * i;
+			for (int kk = 0; kk <= 3; kk++)
+			{
+				for (const int k : {kk % 3, (kk + 1) % 3})
+				{
+					vbd[idx] = {t.x(k), t.y(k), t.z(k)};
+					cbd[idx] = {t.r(k), t.g(k), t.b(k), t.a(k)};
+					idx++;
+				}
+			}
+		},
+		1024);
 }
 
 void CMesh::onUpdateBuffers_TexturedTriangles()
 {
 	auto& tris = CRenderizableShaderTexturedTriangles::m_triangles;
-	tris.clear();
-
-	for (auto& i : actualMesh)
-	{
-		const mrpt::opengl::TTriangle& t = i.first;
-		const TTriangleVertexIndices& tvi = i.second;
-
-		const auto& n0 = vertex_normals.at(tvi.vind[0]).first;
-		const auto& n1 = vertex_normals.at(tvi.vind[1]).first;
-		const auto& n2 = vertex_normals.at(tvi.vind[2]).first;
-
-		auto tri = t;
-
-		tri.vertices[0].normal = n0;
-		tri.vertices[1].normal = n1;
-		tri.vertices[2].normal = n2;
-
-		for (int k = 0; k < 3; k++)
-		{
-			tri.vertices[k].uv.x =
-				(tri.vertices[k].xyzrgba.pt.x - m_xMin) / (m_xMax - m_xMin);
-			tri.vertices[k].uv.y =
-				(tri.vertices[k].xyzrgba.pt.y - m_yMin) / (m_yMax - m_yMin);
-		}
-
-		tris.emplace_back(std::move(tri));
-	}
+	tris.resize(actualMesh.size());
+
+	mrpt::WorkerThreadsPool::Default().parallel_for(
+		0, actualMesh.size(),
+		[&](size_t i) {
+			const auto& [t, tvi] = actualMesh[i];
+			auto& tri = tris[i];
+			tri = t;
+			for (int k = 0; k < 3; k++)
+			{
+				tri.vertices[k].normal = vertex_normals[tvi.vind[k]].first;
+				tri.vertices[k].uv.x =
+					(tri.vertices[k].xyzrgba.pt.x - m_xMin) /
+					(m_xMax - m_xMin);
+				tri.vertices[k].uv.y =
+					(tri.vertices[k].xyzrgba.pt.y - m_yMin) /
+					(m_yMax - m_yMin);
+			}
+		},
+		1024);
 }
 
 /*---------------------------------------------------------------
@@ -419,7 +417,7 @@ void CMesh::assignImageAndZ(
 	MRPT_END
 }
 
-uint8_t CMesh::serializeGetVersion() const { return 1; }
+uint8_t CMesh::serializeGetVersion() const { return 2; }
 void CMesh::serializeTo(mrpt::serialization::CArchive& out) const
 {
 	writeToStreamRender(out);
@@ -433,6 +431,8 @@ void CMesh::serializeTo(mrpt::serialization::CArchive& out) const
 	// new in v1
 	out << m_isWireFrame;
 	out << int16_t(m_colorMap);
+	// new in v2
+	out << m_quadMerging << m_quadMergingTolerance;
 }
 
 void CMesh::serializeFrom(mrpt::serialization::CArchive& in, uint8_t version)
@@ -441,6 +441,7 @@ void CMesh::serializeFrom(mrpt::serialization::CArchive& in, uint8_t version)
 	{
 		case 0:
 		case 1:
+		case 2:
 		{
 			readFromStreamRender(in);
 			readFromStreamTexturedObject(in);
@@ -464,6 +465,11 @@ void CMesh::serializeFrom(mrpt::serialization::CArchive& in, uint8_t version)
 			else
 				m_isWireFrame = false;
 
+			if (version >= 2)
+				in >> m_quadMerging >> m_quadMergingTolerance;
+			else
+				m_quadMerging = false;
+
 			m_modified_Z = true;
 		}
 			m_trianglesUpToDate = false;
@@ -567,29 +573,18 @@ void CMesh::setMask(const mrpt::math::CMatrixDynamic<float>& in_mask)
 bool CMesh::traceRay(const mrpt::poses::CPose3D& o, double& dist) const
 {
 	if (!m_trianglesUpToDate || !m_polygonsUpToDate) updatePolygons();
-	return mrpt::math::traceRay(tmpPolys, (o - this->m_pose).asTPose(), dist);
-}
-
-static math::TPolygon3D tmpPoly(3);
-mrpt::math::TPolygonWithPlane createPolygonFromTriangle(
-	const std::pair<mrpt::opengl::TTriangle, CMesh::TTriangleVertexIndices>& p)
-{
-	const mrpt::opengl::TTriangle& t = p.first;
-	for (size_t i = 0; i < 3; i++)
-		tmpPoly[i] = t.vertex(i);
-	return mrpt::math::TPolygonWithPlane(tmpPoly);
+	return m_trianglesBVH.traceRay(o - this->m_pose, dist);
 }
 
 void CMesh::updatePolygons() const
 {
 	if (!m_trianglesUpToDate) updateTriangles();
-	size_t N = actualMesh.size();
-	tmpPolys.resize(N);
-	transform(
-		actualMesh.begin(), actualMesh.end(), tmpPolys.begin(),
-		createPolygonFromTriangle);
+	std::vector<TriangleBVH::triangle_t> tris;
+	tris.reserve(actualMesh.size());
+	for (const auto& [t, idxs] : actualMesh)
+		tris.push_back({t.vertex(0), t.vertex(1), t.vertex(2)});
+	m_trianglesBVH.build(tris);
 	m_polygonsUpToDate = true;
-	CRenderizable::notifyChange();
 }
 
 auto CMesh::getBoundingBox() const -> mrpt::math::TBoundingBox
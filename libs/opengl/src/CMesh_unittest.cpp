@@ -0,0 +1,100 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/config.h>
+#include <mrpt/opengl/CMesh.h>
+
+using namespace mrpt::opengl;
+
+#if MRPT_HAS_OPENCV	 // CMesh needs CImage
+
+// Area of the projection of all triangles onto the XY plane:
+static double projectedArea(const std::vector<TTriangle>& tris)
+{
+	double area = 0;
+	for (const auto& t : tris)
+	{
+		const double ax = t.x(1) - t.x(0), ay = t.y(1) - t.y(0);
+		const double bx = t.x(2) - t.x(0), by = t.y(2) - t.y(0);
+		area += 0.5 * std::abs(ax * by - ay * bx);
+	}
+	return area;
+}
+
+TEST(CMesh, trianglesAndNormals)
+{
+	const int rows = 20, cols = 30;
+	mrpt::math::CMatrixFloat Z(rows, cols);
+	Z.fill(1.0f);
+
+	CMesh mesh(false, 0.0f, 10.0f, 0.0f, 20.0f);
+	mesh.setZ(Z);
+	mesh.updateCPUBuffers();
+	const auto& tris = mesh.shaderTexturedTrianglesBuffer();
+	ASSERT_EQ(tris.size(), 2U * (rows - 1) * (cols - 1));
+	EXPECT_NEAR(projectedArea(tris), 200.0, 1e-3);
+	for (const auto& t : tris)
+		for (const auto& v : t.vertices)
+		{
+			EXPECT_NEAR(v.normal.z, 1.0f, 1e-5f);
+			EXPECT_NEAR(v.xyzrgba.pt.z, 1.0f, 1e-5f);
+		}
+
+	// Masking out one inner vertex removes its 6 triangles:
+	mrpt::math::CMatrixFloat mask(rows, cols);
+	mask.fill(1.0f);
+	mask(5, 7) = 0;
+	mesh.setMask(mask);
+	mesh.updateCPUBuffers();
+	EXPECT_EQ(
+		mesh.shaderTexturedTrianglesBuffer().size(),
+		2U * (rows - 1) * (cols - 1) - 6);
+}
+
+TEST(CMesh, quadMerging)
+{
+	const int rows = 100, cols = 80;
+	mrpt::math::CMatrixFloat Z(rows, cols);
+	Z.fill(0.0f);
+	// A bump and a plateau:
+	for (int r = 10; r < 20; r++)
+		for (int c = 10; c < 20; c++)
+			Z(r, c) = 0.1f * (r + c);
+	for (int r = 50; r < 70; r++)
+		for (int c = 30; c < 60; c++)
+			Z(r, c) = 2.0f;
+
+	CMesh mesh(false, -5.0f, 5.0f, -4.0f, 4.0f);
+	mesh.setZ(Z);
+	mesh.updateCPUBuffers();
+	const auto allTris = mesh.shaderTexturedTrianglesBuffer();
+	const auto bbox = mesh.getBoundingBox();
+	ASSERT_EQ(allTris.size(), 2U * (rows - 1) * (cols - 1));
+
+	mesh.enableQuadMerging(true);
+	mesh.updateCPUBuffers();
+	const auto& tris = mesh.shaderTexturedTrianglesBuffer();
+	EXPECT_LT(tris.size(), allTris.size() / 10);
+
+	// Same surface:
+	EXPECT_NEAR(projectedArea(tris), projectedArea(allTris), 1e-3);
+	const auto bbox2 = mesh.getBoundingBox();
+	EXPECT_NEAR(bbox2.min.z, bbox.min.z, 1e-5);
+	EXPECT_NEAR(bbox2.max.z, bbox.max.z, 1e-5);
+
+	// A fully flat mesh becomes one quad per block of rows:
+	Z.fill(3.0f);
+	mesh.setZ(Z);
+	mesh.updateCPUBuffers();
+	EXPECT_LE(mesh.shaderTexturedTrianglesBuffer().size(), 8U);
+	EXPECT_NEAR(
+		projectedArea(mesh.shaderTexturedTrianglesBuffer()), 80.0, 1e-3);
+}
+#endif
@@ -9,11 +9,18 @@
 
 #include "opengl-precomp.h"	 // Precompiled header
 //
+#include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/opengl/COctoMapVoxels.h>
 #include <mrpt/opengl/opengl_api.h>
 #include <mrpt/serialization/CArchive.h>
 #include <mrpt/serialization/stl_serialization.h>
 
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
 using namespace mrpt;
 using namespace mrpt::opengl;
 using namespace mrpt::math;
@@ -22,14 +29,206 @@ using namespace std;
 IMPLEMENTS_SERIALIZABLE(COctoMapVoxels, CRenderizable, mrpt::opengl)
 
 /** Ctor */
-COctoMapVoxels::COctoMapVoxels() : m_grid_color(0xE0, 0xE0, 0xE0, 0x90) {}
+COctoMapVoxels::COctoMapVoxels() : m_grid_color(0xE0, 0xE0, 0xE0, 0x90)
+{
+	m_incrementalTrianglesUpdate = true;
+}
 /** Clears everything */
 void COctoMapVoxels::clear()
 {
 	m_voxel_sets.clear();
 	m_grid_cubes.clear();
+	clearBlocks();
+
+	CRenderizable::notifyChange();
+}
+
+void COctoMapVoxels::clearBlocks()
+{
+	m_blocks.clear();
+	m_blocksVoxelCount.clear();
+	m_blocksGridCubeCount = 0;
+	m_modifiedBlocks.clear();
+	m_freedTriangles.clear();
+	m_indexValid = false;
+	m_regenerateAllTriangles = true;
+}
+
+void COctoMapVoxels::notifyBlocksChange()
+{
+	// Changes not reported through blocks since the last known one:
+	if (changeGeneration() != m_knownChangeGeneration)
+		m_regenerateAllTriangles = true;
 
 	CRenderizable::notifyChange();
+	m_knownChangeGeneration = changeGeneration();
+}
+
+void COctoMapVoxels::setVoxelBlock(uint64_t id, TVoxelBlock&& block)
+{
+	ASSERT_LE_(block.voxels.size(), m_voxel_sets.size());
+
+	BlockInfo& b = m_blocks[id];
+
+	if (m_blocksVoxelCount.size() < block.voxels.size())
+		m_blocksVoxelCount.resize(block.voxels.size(), 0);
+	for (size_t set = 0; set < b.block.voxels.size(); set++)
+		m_blocksVoxelCount[set] -= b.block.voxels[set].size();
+	for (size_t set = 0; set < block.voxels.size(); set++)
+		m_blocksVoxelCount[set] += block.voxels[set].size();
+	m_blocksGridCubeCount -= b.block.gridCubes.size();
+	m_blocksGridCubeCount += block.gridCubes.size();
+
+	b.block = std::move(block);
+
+	m_modifiedBlocks.insert(id);
+	m_indexValid = false;
+	notifyBlocksChange();
+}
+
+void COctoMapVoxels::removeVoxelBlock(uint64_t id)
+{
+	const auto it = m_blocks.find(id);
+	if (it == m_blocks.end()) return;
+	const BlockInfo& b = it->second;
+
+	for (size_t set = 0; set < b.block.voxels.size(); set++)
+		m_blocksVoxelCount[set] -= b.block.voxels[set].size();
+	m_blocksGridCubeCount -= b.block.gridCubes.size();
+
+	// Its triangles are cleared in the next update:
+	if (b.trisCapacity)
+	{
+		m_freedTriangles.emplace_back(
+			b.trisFirst, b.trisFirst + b.trisCapacity);
+		m_unusedTriangles += b.trisCount;
+	}
+
+	m_modifiedBlocks.erase(id);
+	m_blocks.erase(it);
+	m_indexValid = false;
+	notifyBlocksChange();
+}
+
+auto COctoMapVoxels::getVoxelBlock(uint64_t id) const -> const TVoxelBlock&
+{
+	const auto it = m_blocks.find(id);
+	ASSERTMSG_(it != m_blocks.end(), "No voxel block with the given ID");
+	return it->second.block;
+}
+
+std::vector<uint64_t> COctoMapVoxels::getVoxelBlockIDs() const
+{
+	std::vector<uint64_t> ids;
+	ids.reserve(m_blocks.size());
+	for (const auto& id_block : m_blocks)
+		ids.push_back(id_block.first);
+	return ids;
+}
+
+void COctoMapVoxels::updateBlocksIndex() const
+{
+	if (m_indexValid) return;
+
+	m_indexBlockIDs.clear();
+	m_indexGridCubesBefore.clear();
+	m_indexVoxelsBefore.assign(m_blocksVoxelCount.size(), {});
+
+	std::vector<size_t> nVoxels(m_blocksVoxelCount.size(), 0);
+	size_t nGridCubes = 0;
+	for (const auto& [id, b] : m_blocks)
+	{
+		m_indexBlockIDs.push_back(id);
+		m_indexGridCubesBefore.push_back(nGridCubes);
+		nGridCubes += b.block.gridCubes.size();
+		for (size_t set = 0; set < nVoxels.size(); set++)
+		{
+			m_indexVoxelsBefore[set].push_back(nVoxels[set]);
+			if (set < b.block.voxels.size())
+				nVoxels[set] += b.block.voxels[set].size();
+		}
+	}
+	m_indexValid = true;
+}
+
+// The last block with "before" <= idx, skipping empty blocks:
+static size_t findInIndex(const std::vector<size_t>& before, size_t& idx)
+{
+	const size_t k =
+		std::upper_bound(before.begin(), before.end(), idx) - before.begin() -
+		1;
+	idx -= before[k];
+	return k;
+}
+
+uint64_t COctoMapVoxels::findBlockOfVoxel(size_t set_index, size_t& idx) const
+{
+	updateBlocksIndex();
+	ASSERTDEB_(
+		set_index < m_blocksVoxelCount.size() &&
+		idx < m_blocksVoxelCount[set_index]);
+	return m_indexBlockIDs[findInIndex(m_indexVoxelsBefore[set_index], idx)];
+}
+
+uint64_t COctoMapVoxels::findBlockOfGridCube(size_t& idx) const
+{
+	updateBlocksIndex();
+	ASSERTDEB_(idx < m_blocksGridCubeCount);
+	return m_indexBlockIDs[findInIndex(m_indexGridCubesBefore, idx)];
+}
+
+auto COctoMapVoxels::getGridCubeRef(const size_t idx) -> TGridCube&
+{
+	ASSERTDEB_(idx < getGridCubeCount());
+	if (idx < m_grid_cubes.size())
+	{
+		CRenderizable::notifyChange();
+		return m_grid_cubes[idx];
+	}
+	size_t i = idx - m_grid_cubes.size();
+	const uint64_t id = findBlockOfGridCube(i);
+	// Grid cubes do not change the triangles of the block:
+	notifyBlocksChange();
+	return m_blocks.at(id).block.gridCubes[i];
+}
+
+auto COctoMapVoxels::getGridCube(const size_t idx) const -> const TGridCube&
+{
+	ASSERTDEB_(idx < getGridCubeCount());
+	if (idx < m_grid_cubes.size()) return m_grid_cubes[idx];
+	size_t i = idx - m_grid_cubes.size();
+	const uint64_t id = findBlockOfGridCube(i);
+	return m_blocks.at(id).block.gridCubes[i];
+}
+
+auto COctoMapVoxels::getVoxelRef(const size_t set_index, const size_t idx)
+	-> TVoxel&
+{
+	ASSERTDEB_(
+		set_index < m_voxel_sets.size() && idx < getVoxelCount(set_index));
+	auto& voxels = m_voxel_sets[set_index].voxels;
+	if (idx < voxels.size())
+	{
+		CRenderizable::notifyChange();
+		return voxels[idx];
+	}
+	size_t i = idx - voxels.size();
+	const uint64_t id = findBlockOfVoxel(set_index, i);
+	m_modifiedBlocks.insert(id);
+	notifyBlocksChange();
+	return m_blocks.at(id).block.voxels[set_index][i];
+}
+
+auto COctoMapVoxels::getVoxel(const size_t set_index, const size_t idx) const
+	-> const TVoxel&
+{
+	ASSERTDEB_(
+		set_index < m_voxel_sets.size() && idx < getVoxelCount(set_index));
+	const auto& voxels = m_voxel_sets[set_index].voxels;
+	if (idx < voxels.size()) return voxels[idx];
+	size_t i = idx - voxels.size();
+	const uint64_t id = findBlockOfVoxel(set_index, i);
+	return m_blocks.at(id).block.voxels[set_index][i];
 }
 
 void COctoMapVoxels::setBoundingBox(
@@ -105,13 +304,12 @@ void COctoMapVoxels::onUpdateBuffers_Wireframe()
 	auto& vbd = CRenderizableShaderWireFrame::m_vertex_buffer_data;
 	auto& cbd = CRenderizableShaderWireFrame::m_color_buffer_data;
 	vbd.clear();
+	cbd.clear();
+	if (!m_show_grids) return;
 
 	CRenderizableShaderWireFrame::setLineWidth(m_grid_width);
 
-	const size_t nGrids = m_grid_cubes.size();
-	for (size_t i = 0; i < nGrids; i++)
-	{
-		const TGridCube& c = m_grid_cubes[i];
+	const auto appendGridCube = [&](const TGridCube& c) {
 
 		const mrpt::math::TPoint3Df vs[8] = {
 			{c.max.x, c.max.y, c.max.z}, {c.max.x, c.min.y, c.max.z},
@@ -127,86 +325,439 @@ void COctoMapVoxels::onUpdateBuffers_Wireframe()
 			vbd.emplace_back(vs[gli[k]]);
 			vbd.emplace_back(vs[gli[k + 1]]);
 		}
-	}
+	};
+	for (const auto& c : m_grid_cubes)
+		appendGridCube(c);
+	for (const auto& id_block : m_blocks)
+		for (const auto& c : id_block.second.block.gridCubes)
+			appendGridCube(c);
 
 	cbd.assign(vbd.size(), m_grid_color);
 }
 
-void COctoMapVoxels::onUpdateBuffers_Triangles()
+// Writes the 12 triangles of the cube of one voxel:
+static void voxelCubeTriangles(
+	const COctoMapVoxels::TVoxel& vx, mrpt::opengl::TTriangle* out)
 {
-	auto& tris = CRenderizableShaderTriangles::m_triangles;
-	tris.clear();
+	const mrpt::img::TColor& vx_col = vx.color;
+	const mrpt::math::TPoint3Df& c = vx.coords;
+	const float L = vx.side_length * 0.5f;
+
+	// Render as cubes:
+	const mrpt::math::TPoint3Df vs[8] = {
+		{c.x + L, c.y + L, c.z + L}, {c.x + L, c.y - L, c.z + L},
+		{c.x + L, c.y - L, c.z - L}, {c.x + L, c.y + L, c.z - L},
+		{c.x - L, c.y + L, c.z - L}, {c.x - L, c.y + L, c.z + L},
+		{c.x - L, c.y - L, c.z + L}, {c.x - L, c.y - L, c.z - L}};
 
-	for (const auto& m_voxel_set : m_voxel_sets)
+	const auto& ci = cube_indices;
+	const auto& ns = normals_cube;
+
+	for (size_t k = 0; k < sizeof(ci) / sizeof(ci[0]); k += 3)
 	{
-		if (!m_voxel_set.visible) continue;
+		mrpt::opengl::TTriangle& tri = out[k / 3];
+		tri = mrpt::opengl::TTriangle(
+			// vertices:
+			vs[ci[k]], vs[ci[k + 1]], vs[ci[k + 2]],
+			// normals:
+			ns[k / 3], ns[k / 3], ns[k / 3]);
+
+		for (int p = 0; p < 3; p++)
+		{
+			tri.vertices[p].xyzrgba.r = vx_col.R;
+			tri.vertices[p].xyzrgba.g = vx_col.G;
+			tri.vertices[p].xyzrgba.b = vx_col.B;
+			tri.vertices[p].xyzrgba.a = vx_col.A;
+		}
+	}
+}
+
+namespace
+{
+// Integer coordinates of voxels for greedy meshing, packed in 21 bits each:
+constexpr int GRID_MAX = (1 << 20) - 2;
 
-		const std::vector<TVoxel>& voxels = m_voxel_set.voxels;
-		const size_t N = voxels.size();
-		for (size_t j = 0; j < N; j++)
+uint64_t packCell(int x, int y, int z)
+{
+	constexpr int off = 1 << 20;
+	return (static_cast<uint64_t>(x + off) << 42) |
+		(static_cast<uint64_t>(y + off) << 21) | static_cast<uint64_t>(z + off);
+}
+
+struct GridVoxel
+{
+	std::array<int, 3> cell;
+	mrpt::img::TColor color;
+};
+
+// A visible face of a voxel: "w" is the voxel coordinate along the face
+// normal, (u,v) the coordinates along the other two axes.
+struct VoxelFace
+{
+	int w, u, v;
+	mrpt::img::TColor color;
+};
+}  // namespace
+
+// Appends the triangles of the faces of voxels along direction `s` (+1 or
+// -1) of axis `a`, merged into rectangles:
+static void greedyMeshDirection(
+	const std::vector<GridVoxel>& gvs,
+	const std::unordered_set<uint64_t>& occupied, int a, int s,
+	const mrpt::math::TPoint3Df& origin, float L,
+	std::vector<mrpt::opengl::TTriangle>& out)
+{
+	const int ua = (a + 1) % 3, va = (a + 2) % 3;
+
+	// Visible faces, without a neighbor voxel in front of them:
+	std::vector<VoxelFace> faces;
+	for (const auto& gv : gvs)
+	{
+		auto n = gv.cell;
+		n[a] += s;
+		if (occupied.count(packCell(n[0], n[1], n[2]))) continue;
+		faces.push_back({gv.cell[a], gv.cell[ua], gv.cell[va], gv.color});
+	}
+	std::sort(
+		faces.begin(), faces.end(),
+		[](const VoxelFace& f1, const VoxelFace& f2) {
+			if (f1.w != f2.w) return f1.w < f2.w;
+			if (f1.v != f2.v) return f1.v < f2.v;
+			return f1.u < f2.u;
+		});
+
+	std::unordered_map<uint64_t, size_t> faceIdx;
+	faceIdx.reserve(faces.size());
+	for (size_t i = 0; i < faces.size(); i++)
+		faceIdx[packCell(faces[i].w, faces[i].u, faces[i].v)] = i;
+	std::vector<bool> used(faces.size(), false);
+
+	const auto mergeable = [&](int w, int u, int v,
+								 const mrpt::img::TColor& col) -> size_t {
+		const auto it = faceIdx.find(packCell(w, u, v));
+		if (it == faceIdx.end() || used[it->second] ||
+			!(faces[it->second].color == col))
+			return faces.size();
+		return it->second;
+	};
+
+	mrpt::math::TVector3Df normal(0, 0, 0);
+	normal[a] = s;
+
+	for (size_t i = 0; i < faces.size(); i++)
+	{
+		if (used[i]) continue;
+		const VoxelFace& f = faces[i];
+
+		// Grow along "u" (the next faces in sorted order), then along "v"
+		// while whole rows can be added:
+		int u1 = f.u;
+		for (size_t j = i + 1; j < faces.size() && !used[j] &&
+			 faces[j].w == f.w && faces[j].v == f.v && faces[j].u == u1 + 1 &&
+			 faces[j].color == f.color;
+			 j++)
+			u1++;
+		for (int u = f.u; u <= u1; u++)
+			used[mergeable(f.w, u, f.v, f.color)] = true;
+
+		int v1 = f.v;
+		for (;;)
+		{
+			bool rowOk = true;
+			for (int u = f.u; u <= u1 && rowOk; u++)
+				rowOk = mergeable(f.w, u, v1 + 1, f.color) < faces.size();
+			if (!rowOk) break;
+			v1++;
+			for (int u = f.u; u <= u1; u++)
+				used[mergeable(f.w, u, v1, f.color)] = true;
+		}
+
+		// Corners of the rectangle:
+		mrpt::math::TPoint3Df p00, p10, p11, p01;
+		const float w = origin[a] + (f.w + 0.5f * s) * L;
+		const float u0 = origin[ua] + (f.u - 0.5f) * L;
+		const float uu1 = origin[ua] + (u1 + 0.5f) * L;
+		const float v0 = origin[va] + (f.v - 0.5f) * L;
+		const float vv1 = origin[va] + (v1 + 0.5f) * L;
+		p00[a] = p10[a] = p11[a] = p01[a] = w;
+		p00[ua] = p01[ua] = u0;
+		p10[ua] = p11[ua] = uu1;
+		p00[va] = p10[va] = v0;
+		p01[va] = p11[va] = vv1;
+
+		// Counterclockwise, seen from the side the face looks at:
+		if (s > 0)
 		{
-			const mrpt::img::TColor& vx_j_col = voxels[j].color;
-			// Was: glColor4ub(vx_j_col.R, vx_j_col.G, vx_j_col.B, vx_j_col.A);
+			out.emplace_back(p00, p10, p11, normal, normal, normal);
+			out.emplace_back(p00, p11, p01, normal, normal, normal);
+		}
+		else
+		{
+			out.emplace_back(p00, p11, p10, normal, normal, normal);
+			out.emplace_back(p00, p01, p11, normal, normal, normal);
+		}
+		for (size_t k = out.size() - 2; k < out.size(); k++)
+			for (auto& vert : out[k].vertices)
+			{
+				vert.xyzrgba.r = f.color.R;
+				vert.xyzrgba.g = f.color.G;
+				vert.xyzrgba.b = f.color.B;
+				vert.xyzrgba.a = f.color.A;
+			}
+	}
+}
 
-			const mrpt::math::TPoint3Df& c = voxels[j].coords;
-			const float L = voxels[j].side_length * 0.5f;
+// Greedy meshing of one set of voxels. See enableGreedyMeshing().
+static void greedyMeshVoxels(
+	const std::vector<COctoMapVoxels::TVoxel>& voxels,
+	std::vector<mrpt::opengl::TTriangle>& tris)
+{
+	if (voxels.empty()) return;
+
+	double side = voxels[0].side_length;
+	for (const auto& vx : voxels)
+		side = std::min(side, vx.side_length);
+	const float L = static_cast<float>(side);
+	ASSERT_GT_(L, 0);
+
+	// Voxels of the smallest size, in the grid of the first one of them:
+	std::optional<mrpt::math::TPoint3Df> origin;
+	std::vector<GridVoxel> gvs;
+	std::unordered_set<uint64_t> occupied;
+	std::vector<size_t> others;
+	gvs.reserve(voxels.size());
+	occupied.reserve(voxels.size());
+	for (size_t i = 0; i < voxels.size(); i++)
+	{
+		const auto& vx = voxels[i];
+		if (vx.side_length > side * 1.001)
+		{
+			others.push_back(i);
+			continue;
+		}
+		if (!origin) origin = vx.coords;
 
-			// Render as cubes:
-			const mrpt::math::TPoint3Df vs[8] = {
-				{c.x + L, c.y + L, c.z + L}, {c.x + L, c.y - L, c.z + L},
-				{c.x + L, c.y - L, c.z - L}, {c.x + L, c.y + L, c.z - L},
-				{c.x - L, c.y + L, c.z - L}, {c.x - L, c.y + L, c.z + L},
-				{c.x - L, c.y - L, c.z + L}, {c.x - L, c.y - L, c.z - L}};
+		GridVoxel gv;
+		bool aligned = true;
+		for (int k = 0; k < 3; k++)
+		{
+			const double c = (vx.coords[k] - (*origin)[k]) / L;
+			gv.cell[k] = static_cast<int>(std::lround(c));
+			aligned = aligned && std::abs(c - gv.cell[k]) < 1e-2 &&
+				std::abs(gv.cell[k]) < GRID_MAX;
+		}
+		// Duplicated voxels are rendered as cubes, too:
+		if (!aligned ||
+			!occupied.insert(packCell(gv.cell[0], gv.cell[1], gv.cell[2]))
+				 .second)
+		{
+			others.push_back(i);
+			continue;
+		}
+		gv.color = vx.color;
+		gvs.push_back(gv);
+	}
 
-			// Was: glDrawElements(
-			// GL_TRIANGLES, sizeof(cube_indices) / sizeof(cube_indices[0]),
-			// GL_UNSIGNED_BYTE, cube_indices);
-			// glDrawElements(GL_LINES, , GL_UNSIGNED_BYTE, grid_line_indices);
+	// The 6 directions, in parallel:
+	std::array<std::vector<mrpt::opengl::TTriangle>, 6> dirTris;
+	if (origin)
+	{
+		mrpt::WorkerThreadsPool::Default().parallel_for(
+			0, 6,
+			[&](size_t d) {
+				greedyMeshDirection(
+					gvs, occupied, d / 2, (d % 2) ? -1 : 1, *origin, L,
+					dirTris[d]);
+			},
+			1);
+	}
 
-			const auto& ci = cube_indices;
-			const auto& ns = normals_cube;
+	size_t n = tris.size();
+	for (const auto& dt : dirTris)
+		n += dt.size();
+	tris.reserve(n + 12 * others.size());
+	for (const auto& dt : dirTris)
+		tris.insert(tris.end(), dt.begin(), dt.end());
+	for (const size_t i : others)
+	{
+		tris.resize(tris.size() + 12);
+		voxelCubeTriangles(voxels[i], &tris[tris.size() - 12]);
+	}
+}
 
-			for (size_t k = 0; k < sizeof(ci) / sizeof(ci[0]); k += 3)
+// Appends the triangles of a list of voxels:
+static void voxelsTriangles(
+	const std::vector<COctoMapVoxels::TVoxel>& voxels, bool greedyMeshing,
+	std::vector<mrpt::opengl::TTriangle>& tris)
+{
+	if (greedyMeshing)
+	{
+		greedyMeshVoxels(voxels, tris);
+		return;
+	}
+	const size_t first = tris.size();
+	tris.resize(first + 12 * voxels.size());
+	for (size_t j = 0; j < voxels.size(); j++)
+		voxelCubeTriangles(voxels[j], &tris[first + 12 * j]);
+}
+
+void COctoMapVoxels::onUpdateBuffers_Triangles()
+{
+	auto& tris = CRenderizableShaderTriangles::m_triangles;
+
+	// Any change other than in the contents of blocks regenerates all:
+	if (changeGeneration() != m_knownChangeGeneration)
+		m_regenerateAllTriangles = true;
+	m_knownChangeGeneration = changeGeneration();
+
+	// Also compact the triangles if too many of them are unused:
+	if (m_unusedTriangles > 1024 && m_unusedTriangles > tris.size() / 2)
+		m_regenerateAllTriangles = true;
+
+	// Triangles of the blocks to update, in parallel:
+	std::vector<BlockInfo*> blocks;
+	if (m_regenerateAllTriangles)
+		for (auto& id_block : m_blocks)
+			blocks.push_back(&id_block.second);
+	else
+		for (const uint64_t id : m_modifiedBlocks)
+			blocks.push_back(&m_blocks.at(id));
+	m_modifiedBlocks.clear();
+
+	std::vector<std::vector<mrpt::opengl::TTriangle>> blockTris(blocks.size());
+	mrpt::WorkerThreadsPool::Default().parallel_for(
+		0, blocks.size(), [&](size_t k) {
+			const auto& voxels = blocks[k]->block.voxels;
+			for (size_t set = 0; set < voxels.size(); set++)
+				if (set < m_voxel_sets.size() && m_voxel_sets[set].visible)
+					voxelsTriangles(voxels[set], m_greedy_meshing, blockTris[k]);
+		});
+
+	if (!m_regenerateAllTriangles)
+	{
+		// Clear the triangles of removed blocks:
+		for (const auto& [first, last] : m_freedTriangles)
+		{
+			std::fill(
+				tris.begin() + first, tris.begin() + last,
+				mrpt::opengl::TTriangle());
+			markTrianglesAsModified(first, last);
+		}
+		m_freedTriangles.clear();
+
+		// Rewrite the triangles of modified blocks in their range, or move
+		// them to a new, larger one at the end:
+		for (size_t k = 0; k < blocks.size(); k++)
+		{
+			BlockInfo& b = *blocks[k];
+			const auto& bt = blockTris[k];
+			if (bt.size() > b.trisCapacity)
 			{
-				mrpt::opengl::TTriangle tri(
-					// vertices:
-					vs[ci[k]], vs[ci[k + 1]], vs[ci[k + 2]],
-					// normals:
-					ns[k / 3], ns[k / 3], ns[k / 3]);
-
-				for (int p = 0; p < 3; p++)
-				{
-					tri.vertices[p].xyzrgba.r = vx_j_col.R;
-					tri.vertices[p].xyzrgba.g = vx_j_col.G;
-					tri.vertices[p].xyzrgba.b = vx_j_col.B;
-					tri.vertices[p].xyzrgba.a = vx_j_col.A;
-				}
-
-				tris.emplace_back(std::move(tri));
+				std::fill(
+					tris.begin() + b.trisFirst,
+					tris.begin() + b.trisFirst + b.trisCapacity,
+					mrpt::opengl::TTriangle());
+				markTrianglesAsModified(
+					b.trisFirst, b.trisFirst + b.trisCapacity);
+				m_unusedTriangles += b.trisCount;
+
+				// The whole new range is uploaded, including its unused part:
+				b.trisFirst = tris.size();
+				b.trisCount = 0;
+				b.trisCapacity = bt.size() + bt.size() / 2;
+				m_unusedTriangles += b.trisCapacity;
+				tris.resize(tris.size() + b.trisCapacity);
+				markTrianglesAsModified(
+					b.trisFirst, b.trisFirst + b.trisCapacity);
 			}
+			std::copy(bt.begin(), bt.end(), tris.begin() + b.trisFirst);
+			if (b.trisCount > bt.size())
+				std::fill(
+					tris.begin() + b.trisFirst + bt.size(),
+					tris.begin() + b.trisFirst + b.trisCount,
+					mrpt::opengl::TTriangle());
+			markTrianglesAsModified(
+				b.trisFirst,
+				b.trisFirst + std::max<size_t>(bt.size(), b.trisCount));
+			m_unusedTriangles = m_unusedTriangles + b.trisCount - bt.size();
+			b.trisCount = bt.size();
+		}
+		return;
+	}
+
+	// Regenerate everything: first, voxels not in blocks.
+	tris.clear();
+	if (m_greedy_meshing)
+	{
+		for (const auto& m_voxel_set : m_voxel_sets)
+			if (m_voxel_set.visible) greedyMeshVoxels(m_voxel_set.voxels, tris);
+	}
+	else
+	{
+		// 12 triangles per voxel, generated in parallel:
+		size_t nTris = 0;
+		for (const auto& m_voxel_set : m_voxel_sets)
+			if (m_voxel_set.visible) nTris += 12 * m_voxel_set.voxels.size();
+		tris.resize(nTris);
+
+		size_t first = 0;
+		for (const auto& m_voxel_set : m_voxel_sets)
+		{
+			if (!m_voxel_set.visible) continue;
+
+			const std::vector<TVoxel>& voxels = m_voxel_set.voxels;
+			mrpt::WorkerThreadsPool::Default().parallel_for(
+				0, voxels.size(),
+				[&](size_t j) {
+					voxelCubeTriangles(voxels[j], &tris[first + 12 * j]);
+				},
+				1024);
+			first += 12 * voxels.size();
 		}
 	}
+
+	// Then, blocks, each in a range of the exact size of its triangles:
+	size_t nTris = tris.size();
+	for (const auto& bt : blockTris)
+		nTris += bt.size();
+	tris.reserve(nTris);
+	for (size_t k = 0; k < blocks.size(); k++)
+	{
+		BlockInfo& b = *blocks[k];
+		b.trisFirst = tris.size();
+		b.trisCount = b.trisCapacity = blockTris[k].size();
+		tris.insert(tris.end(), blockTris[k].begin(), blockTris[k].end());
+	}
+
+	m_freedTriangles.clear();
+	m_unusedTriangles = 0;
+	m_regenerateAllTriangles = false;
+	markAllTrianglesAsModified();
 }
 
 void COctoMapVoxels::onUpdateBuffers_Points()
 {
 	auto& vbd = CRenderizableShaderPoints::m_vertex_buffer_data;
 	auto& cbd = CRenderizableShaderPoints::m_color_buffer_data;
+	vbd.clear();
+	cbd.clear();
+	if (!m_showVoxelsAsPoints) return;
 
-	for (const auto& m_voxel_set : m_voxel_sets)
-	{
-		if (!m_voxel_set.visible) continue;
-
-		const std::vector<TVoxel>& voxels = m_voxel_set.voxels;
-		const size_t N = voxels.size();
-		for (size_t j = 0; j < N; j++)
+	const auto appendVoxels = [&](const std::vector<TVoxel>& voxels) {
+		for (const auto& vx : voxels)
 		{
-			const mrpt::img::TColor& vx_j_col = voxels[j].color;
-			const mrpt::math::TPoint3D& c = voxels[j].coords;
-
-			vbd.emplace_back(c);
-			cbd.emplace_back(vx_j_col);
+			vbd.emplace_back(vx.coords);
+			cbd.emplace_back(vx.color);
 		}
+	};
+	for (size_t set = 0; set < m_voxel_sets.size(); set++)
+	{
+		if (!m_voxel_sets[set].visible) continue;
+
+		appendVoxels(m_voxel_sets[set].voxels);
+		for (const auto& id_block : m_blocks)
+			if (set < id_block.second.block.voxels.size())
+				appendVoxels(id_block.second.block.voxels[set]);
 	}
 }
 
@@ -251,17 +802,36 @@ CArchive& operator>>(CArchive& in, COctoMapVoxels::TVoxel& a)
 }
 }  // end of namespace mrpt::opengl
 
-uint8_t COctoMapVoxels::serializeGetVersion() const { return 3; }
+uint8_t COctoMapVoxels::serializeGetVersion() const { return 4; }
 void COctoMapVoxels::serializeTo(CArchive& out) const
 {
 	writeToStreamRender(out);
 
-	out << m_voxel_sets << m_grid_cubes << m_bb_min << m_bb_max
+	// Voxels in blocks are stored as the rest:
+	if (m_blocks.empty()) out << m_voxel_sets << m_grid_cubes;
+	else
+	{
+		auto voxel_sets = m_voxel_sets;
+		auto grid_cubes = m_grid_cubes;
+		for (const auto& id_block : m_blocks)
+		{
+			const TVoxelBlock& b = id_block.second.block;
+			for (size_t set = 0; set < b.voxels.size(); set++)
+				voxel_sets[set].voxels.insert(
+					voxel_sets[set].voxels.end(), b.voxels[set].begin(),
+					b.voxels[set].end());
+			grid_cubes.insert(
+				grid_cubes.end(), b.gridCubes.begin(), b.gridCubes.end());
+		}
+		out << voxel_sets << grid_cubes;
+	}
+	out << m_bb_min << m_bb_max
 		<< m_enable_lighting << m_showVoxelsAsPoints << m_showVoxelsAsPointsSize
 		<< m_show_grids << m_grid_width << m_grid_color
 		<< m_enable_cube_transparency  // added in v1
 		<< uint32_t(m_visual_mode);	 // added in v2
 	CRenderizableShaderTriangles::params_serialize(out);  // v3
+	out << m_greedy_meshing;  // v4
 }
 
 void COctoMapVoxels::serializeFrom(CArchive& in, uint8_t version)
@@ -272,9 +842,11 @@ void COctoMapVoxels::serializeFrom(CArchive& in, uint8_t version)
 		case 1:
 		case 2:
 		case 3:
+		case 4:
 		{
 			readFromStreamRender(in);
 
+			clearBlocks();
 			in >> m_voxel_sets >> m_grid_cubes >> m_bb_min >> m_bb_max >>
 				m_enable_lighting >> m_showVoxelsAsPoints >>
 				m_showVoxelsAsPointsSize >> m_show_grids >> m_grid_width >>
@@ -296,6 +868,10 @@ void COctoMapVoxels::serializeFrom(CArchive& in, uint8_t version)
 
 			if (version >= 3)
 				CRenderizableShaderTriangles::params_deserialize(in);
+
+			if (version >= 4) in >> m_greedy_meshing;
+			else
+				m_greedy_meshing = false;
 		}
 		break;
 		default: MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version);
@@ -323,4 +899,9 @@ void COctoMapVoxels::sort_voxels_by_z()
 			m_voxel_set.voxels.begin(), m_voxel_set.voxels.end(),
 			&sort_voxels_z);
 	}
+	for (auto& id_block : m_blocks)
+		for (auto& voxels : id_block.second.block.voxels)
+			std::sort(voxels.begin(), voxels.end(), &sort_voxels_z);
+
+	CRenderizable::notifyChange();
 }
@@ -0,0 +1,202 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/math/geometry.h>
+#include <mrpt/opengl/COctoMapVoxels.h>
+
+#include <algorithm>
+#include <array>
+
+using namespace mrpt::opengl;
+using mrpt::math::TPoint3Df;
+
+static float dot(const TPoint3Df& a, const TPoint3Df& b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// Total area of all triangles:
+static double totalArea(const std::vector<TTriangle>& tris)
+{
+	double area = 0;
+	for (const auto& t : tris)
+	{
+		const auto a = t.vertices[1].xyzrgba.pt - t.vertices[0].xyzrgba.pt;
+		const auto b = t.vertices[2].xyzrgba.pt - t.vertices[0].xyzrgba.pt;
+		area += 0.5 * mrpt::math::crossProduct3D(a, b).norm();
+	}
+	return area;
+}
+
+// A solid block of nx*ny*nz voxels of side L:
+static void fillBlock(
+	COctoMapVoxels& v, int nx, int ny, int nz, double L,
+	const mrpt::img::TColor& color)
+{
+	v.resizeVoxelSets(2);
+	for (int ix = 0; ix < nx; ix++)
+		for (int iy = 0; iy < ny; iy++)
+			for (int iz = 0; iz < nz; iz++)
+				v.push_back_Voxel(
+					VOXEL_SET_OCCUPIED,
+					COctoMapVoxels::TVoxel(
+						TPoint3Df(
+							(ix + 0.5) * L, (iy + 0.5) * L, (iz + 0.5) * L),
+						L, color));
+}
+
+TEST(COctoMapVoxels, cubeTriangles)
+{
+	COctoMapVoxels v;
+	fillBlock(v, 4, 5, 6, 0.1, mrpt::img::TColor::red());
+	v.updateCPUBuffers();
+	const auto& tris = v.shaderTexturedTrianglesBuffer();
+	ASSERT_EQ(tris.size(), 12U * 4 * 5 * 6);
+	EXPECT_NEAR(totalArea(tris), 4 * 5 * 6 * 6 * 0.01, 1e-4);
+	for (const auto& t : tris)
+		for (const auto& vert : t.vertices)
+			EXPECT_EQ(vert.xyzrgba.r, 0xff);
+
+	// Hidden sets are not rendered:
+	v.showVoxels(VOXEL_SET_OCCUPIED, false);
+	v.updateCPUBuffers();
+	EXPECT_EQ(v.shaderTexturedTrianglesBuffer().size(), 0U);
+}
+
+TEST(COctoMapVoxels, greedyMeshing)
+{
+	COctoMapVoxels v;
+	fillBlock(v, 10, 10, 10, 0.2, mrpt::img::TColor::red());
+	v.enableGreedyMeshing(true);
+	v.updateCPUBuffers();
+
+	// A solid block is rendered as its 6 faces:
+	const auto& tris = v.shaderTexturedTrianglesBuffer();
+	ASSERT_EQ(tris.size(), 12U);
+	EXPECT_NEAR(totalArea(tris), 6 * 2.0 * 2.0, 1e-4);
+	for (const auto& t : tris)
+	{
+		// Normals point outwards:
+		const auto c = (t.vertices[0].xyzrgba.pt + t.vertices[1].xyzrgba.pt +
+						t.vertices[2].xyzrgba.pt) *
+			(1.0f / 3);
+		const auto d = c - TPoint3Df(1.0f, 1.0f, 1.0f);
+		EXPECT_GT(dot(d, t.vertices[0].normal), 0);
+		// And triangles are counterclockwise seen from outside:
+		const auto n = mrpt::math::crossProduct3D(
+			t.vertices[1].xyzrgba.pt - t.vertices[0].xyzrgba.pt,
+			t.vertices[2].xyzrgba.pt - t.vertices[0].xyzrgba.pt);
+		EXPECT_GT(dot(n, t.vertices[0].normal), 0);
+	}
+
+	// Voxels of other colors or sizes are not merged:
+	v.push_back_Voxel(
+		VOXEL_SET_OCCUPIED,
+		COctoMapVoxels::TVoxel(
+			TPoint3Df(2.1f, 0.1f, 0.1f), 0.2,
+			mrpt::img::TColor::blue()));
+	v.push_back_Voxel(
+		VOXEL_SET_OCCUPIED,
+		COctoMapVoxels::TVoxel(
+			TPoint3Df(-0.2f, 1.0f, 1.0f), 0.4,
+			mrpt::img::TColor::red()));
+	v.updateCPUBuffers();
+	// The blue voxel: 5 visible faces, and the +X face of the block is split
+	// into 2 rectangles around its hidden face. The big one is a cube.
+	EXPECT_EQ(
+		v.shaderTexturedTrianglesBuffer().size(),
+		12U - 2 + 2 * 2 + 2 * 5 + 12);
+
+	// Each set is meshed independently:
+	v.clear();
+	fillBlock(v, 10, 10, 10, 0.2, mrpt::img::TColor::red());
+	v.push_back_Voxel(
+		VOXEL_SET_FREESPACE,
+		COctoMapVoxels::TVoxel(
+			TPoint3Df(2.1f, 0.1f, 0.1f), 0.2,
+			mrpt::img::TColor::blue()));
+	v.updateCPUBuffers();
+	EXPECT_EQ(v.shaderTexturedTrianglesBuffer().size(), 12U + 12);
+}
+
+// Non-degenerate triangles, sorted, to compare meshes regardless of the order
+// of their triangles:
+static std::vector<std::array<float, 12>> sortedTriangles(
+	const std::vector<TTriangle>& tris)
+{
+	std::vector<std::array<float, 12>> ts;
+	for (const auto& t : tris)
+	{
+		if (totalArea({t}) == 0) continue;
+		std::array<float, 12> a;
+		for (int i = 0; i < 3; i++)
+		{
+			const auto& p = t.vertices[i].xyzrgba;
+			a[4 * i + 0] = p.pt.x;
+			a[4 * i + 1] = p.pt.y;
+			a[4 * i + 2] = p.pt.z;
+			a[4 * i + 3] = p.r;
+		}
+		ts.push_back(a);
+	}
+	std::sort(ts.begin(), ts.end());
+	return ts;
+}
+
+TEST(COctoMapVoxels, voxelBlocks)
+{
+	using ranges_t = std::vector<std::pair<size_t, size_t>>;
+
+	// Block "i" with a row of "n" voxels:
+	const auto block = [](int i, int n, const mrpt::img::TColor& color) {
+		COctoMapVoxels::TVoxelBlock b;
+		b.voxels.resize(1);
+		for (int k = 0; k < n; k++)
+			b.voxels[0].emplace_back(
+				TPoint3Df(k + 0.5f, i + 0.5f, 0.5f), 1.0, color);
+		return b;
+	};
+
+	COctoMapVoxels v;
+	v.resizeVoxelSets(2);
+	for (int i = 0; i < 10; i++)
+		v.setVoxelBlock(i, block(i, 5, mrpt::img::TColor::red()));
+	EXPECT_EQ(v.getVoxelCount(VOXEL_SET_OCCUPIED), 50U);
+	EXPECT_EQ(v.prepareBuffers_Triangles(), ranges_t({{0, 12 * 50}}));
+
+	// Only the triangles of modified blocks are rewritten:
+	v.setVoxelBlock(3, block(3, 4, mrpt::img::TColor::blue()));
+	EXPECT_EQ(v.prepareBuffers_Triangles(), ranges_t({{180, 240}}));
+	EXPECT_EQ(v.getVoxel(VOXEL_SET_OCCUPIED, 15).color.B, 0xff);
+
+	// Blocks which grow are moved to the end, with room to grow further:
+	v.setVoxelBlock(5, block(5, 8, mrpt::img::TColor::red()));
+	EXPECT_EQ(
+		v.prepareBuffers_Triangles(), ranges_t({{300, 360}, {600, 744}}));
+	v.removeVoxelBlock(7);
+	EXPECT_EQ(v.prepareBuffers_Triangles(), ranges_t({{420, 480}}));
+	EXPECT_EQ(v.prepareBuffers_Triangles(), ranges_t());
+	EXPECT_EQ(v.getVoxelCount(VOXEL_SET_OCCUPIED), 47U);
+
+	// Same triangles than all voxels generated at once:
+	COctoMapVoxels full;
+	full.resizeVoxelSets(2);
+	for (size_t i = 0; i < v.getVoxelCount(VOXEL_SET_OCCUPIED); i++)
+		full.push_back_Voxel(
+			VOXEL_SET_OCCUPIED, v.getVoxel(VOXEL_SET_OCCUPIED, i));
+	full.updateCPUBuffers();
+	EXPECT_EQ(
+		sortedTriangles(v.shaderTexturedTrianglesBuffer()),
+		sortedTriangles(full.shaderTexturedTrianglesBuffer()));
+
+	// Any other change regenerates everything, without unused triangles:
+	v.enableGreedyMeshing(true);
+	EXPECT_EQ(v.prepareBuffers_Triangles(), ranges_t({{0, 9 * 12}}));
+}
@@ -107,3 +107,12 @@ void COpenGLBuffer::RAII_Impl::allocate(const void* data, int byteCount)
 		static_cast<GLenum>(type), byteCount, data, static_cast<GLenum>(usage));
 #endif
 }
+
+void COpenGLBuffer::RAII_Impl::update(
+	int byteOffset, const void* data, int byteCount)
+{
+#if MRPT_HAS_OPENGL_GLUT
+	ASSERT_(created);
+	glBufferSubData(static_cast<GLenum>(type), byteOffset, byteCount, data);
+#endif
+}
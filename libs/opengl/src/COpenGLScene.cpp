@@ -9,8 +9,11 @@
 
 #include "opengl-precomp.h"	 // Precompiled header
 //
+#include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/opengl/BoundingVolumeHierarchy.h>
+#include <mrpt/opengl/CChunkedSceneFile.h>
 #include <mrpt/opengl/COpenGLScene.h>
 #include <mrpt/opengl/CRenderizable.h>
 #include <mrpt/opengl/opengl_api.h>
@@ -302,10 +305,94 @@ bool COpenGLScene::traceRay(const mrpt::poses::CPose3D& o, double& dist) const
 	return found;
 }
 
-bool COpenGLScene::saveToFile(const std::string& fil) const
+std::vector<std::optional<double>> COpenGLScene::traceRays(
+	const std::vector<mrpt::poses::CPose3D>& rays) const
+{
+	std::vector<std::optional<double>> dists(rays.size());
+	if (rays.empty()) return dists;
+
+	// Index objects with a finite bounding box in a BVH. The rest are traced
+	// against all rays:
+	std::vector<const CRenderizable*> objs, unbounded;
+	std::vector<TBoundingBoxf> boxes;
+	for (const auto& vp : m_viewports)
+	{
+		for (const auto& o : vp->m_objects)
+		{
+			if (!o) continue;
+			// Trace one ray against each object first, from this thread, so
+			// lazily-built data (polygons, triangle BVHs,...) is ready before
+			// tracing rays in parallel:
+			double d;
+			o->traceRay(rays[0], d);
+
+			TBoundingBox bb;
+			try
+			{
+				bb = o->getBoundingBox();
+			}
+			catch (const std::exception&)
+			{
+				unbounded.push_back(o.get());
+				continue;
+			}
+			if (!std::isfinite(bb.min.x + bb.min.y + bb.min.z + bb.max.x +
+							   bb.max.y + bb.max.z) ||
+				bb.min.x > bb.max.x || bb.min.y > bb.max.y ||
+				bb.min.z > bb.max.z)
+			{
+				unbounded.push_back(o.get());
+				continue;
+			}
+			// Pad boxes to make up for float rounding:
+			const double pad = 1e-4 * (1.0 + (bb.max - bb.min).norm());
+			const TVector3D padding(pad, pad, pad);
+			objs.push_back(o.get());
+			boxes.emplace_back(
+				(bb.min - padding).cast<float>(),
+				(bb.max + padding).cast<float>());
+		}
+	}
+	BoundingVolumeHierarchy bvh;
+	bvh.build(boxes, 1);
+	const auto& order = bvh.primitiveOrder();
+
+	mrpt::WorkerThreadsPool::Default().parallel_for(
+		0, rays.size(),
+		[&](size_t i) {
+			const auto& ray = rays[i];
+			const auto& R = ray.getRotationMatrix();
+			double dist = 0;
+			bool found = bvh.traceRay(
+				ray.translation(), TVector3D(R(0, 0), R(1, 0), R(2, 0)), dist,
+				[&](size_t k, double maxDist, double& d) {
+					return objs[order[k]]->traceRay(ray, d) && d <= maxDist;
+				});
+			for (const auto* o : unbounded)
+			{
+				double d;
+				if (o->traceRay(ray, d) && (!found || d < dist))
+				{
+					found = true;
+					dist = d;
+				}
+			}
+			if (found) dists[i] = dist;
+		},
+		64 /* rays per task */);
+
+	return dists;
+}
+
+bool COpenGLScene::saveToFile(const std::string& fil, bool chunked) const
 {
 	try
 	{
+		if (chunked)
+		{
+			CChunkedSceneFile::Save(*this, fil);
+			return true;
+		}
 		mrpt::io::CFileGZOutputStream f(fil);
 		mrpt::serialization::archiveFrom(f) << *this;
 		return true;
@@ -320,6 +407,11 @@ bool COpenGLScene::loadFromFile(const std::string& fil)
 {
 	try
 	{
+		if (CChunkedSceneFile::IsChunkedSceneFile(fil))
+		{
+			CChunkedSceneFile(fil).loadScene(*this);
+			return true;
+		}
 		mrpt::io::CFileGZInputStream f(fil);
 		mrpt::serialization::archiveFrom(f) >> *this;
 		return true;
@@ -185,7 +185,27 @@ void COpenGLViewport::renderImageMode() const
 #endif
 }
 
-void COpenGLViewport::unloadShaders() { m_shaders.clear(); }
+const CListOpenGLObjects& COpenGLViewport::objectsToRender() const
+{
+	if (!m_isCloned) return m_objects;
+
+	// Clone: render someone's else objects.
+	ASSERT_(m_parent.get() != nullptr);
+
+	const auto view = m_parent->getViewport(m_clonedViewport);
+	if (!view)
+		THROW_EXCEPTION_FMT(
+			"Cloned viewport '%s' not found in parent COpenGLScene",
+			m_clonedViewport.c_str());
+
+	return view->m_objects;
+}
+
+void COpenGLViewport::unloadShaders()
+{
+	m_shaders.clear();
+	m_instancingCache.clear();
+}
 
 void COpenGLViewport::loadDefaultShaders() const
 {
@@ -220,24 +240,7 @@ void COpenGLViewport::renderNormalSceneMode() const
 	auto& _ = m_state;
 
 	// Get objects to render:
-	const CListOpenGLObjects* objectsToRender = nullptr;
-
-	if (m_isCloned)
-	{  // Clone: render someone's else objects.
-		ASSERT_(m_parent.get() != nullptr);
-
-		const auto view = m_parent->getViewport(m_clonedViewport);
-		if (!view)
-			THROW_EXCEPTION_FMT(
-				"Cloned viewport '%s' not found in parent COpenGLScene",
-				m_clonedViewport.c_str());
-
-		objectsToRender = &view->m_objects;
-	}
-	else
-	{  // Normal case: render our own objects:
-		objectsToRender = &m_objects;
-	}
+	const CListOpenGLObjects& lstObjects = objectsToRender();
 
 	// Optional pre-Render user code:
 	if (hasSubscribers())
@@ -273,7 +276,18 @@ void COpenGLViewport::renderNormalSceneMode() const
 
 	// Pass 1: Process all objects (recursively for sets of objects):
 	mrpt::opengl::RenderQueue rq;
-	mrpt::opengl::enqueForRendering(*objectsToRender, _, rq);
+	rq.frustumCulling = m_frustumCulling;
+	rq.parallel = m_parallelRenderQueue;
+	if (m_instancing)
+	{
+		m_instancingCache.beginFrame();
+		rq.instancing = &m_instancingCache;
+	}
+	else
+		m_instancingCache.clear();
+
+	mrpt::opengl::enqueForRendering(lstObjects, _, rq);
+	m_lastCulledObjects = rq.culledObjects;
 
 	// pass 2: render, sorted by shader program:
 	mrpt::opengl::processRenderQueue(rq, m_shaders, m_lights);
@@ -1039,3 +1053,12 @@ void COpenGLViewport::updateMatricesFromCamera() const
 
 	_.initialized = true;
 }
+
+void COpenGLViewport::updateMatricesFromCamera(
+	int viewportWidth, int viewportHeight) const
+{
+	ASSERT_(viewportWidth > 0 && viewportHeight > 0);
+	m_state.viewport_width = viewportWidth;
+	m_state.viewport_height = viewportHeight;
+	updateMatricesFromCamera();
+}
@@ -46,7 +46,11 @@ void mrpt::global_settings::OCTREE_RENDER_MAX_POINTS_PER_NODE(size_t value)
 
 IMPLEMENTS_SERIALIZABLE(CPointCloud, CRenderizable, mrpt::opengl)
 
-CPointCloud::CPointCloud() { markAllPointsAsNew(); }
+CPointCloud::CPointCloud()
+{
+	m_incrementalPointsUpdate = true;
+	markAllPointsAsNew();
+}
 
 void CPointCloud::onUpdateBuffers_Points()
 {
@@ -63,36 +67,40 @@ void CPointCloud::onUpdateBuffers_Points()
 
 	const auto N = m_points.size();
 
-	octree_assure_uptodate();  // Rebuild octree if needed
+	// Note: the octree is only used for bounding boxes, and it is rebuilt
+	// on demand from octree_getBoundingBox().
 	m_last_rendered_count_ongoing = 0;
 
+	float depthMin = 0;
 	if (m_colorFromDepth != colNone)
 	{
-		if (!m_minmax_valid)
+		if (!m_minmax_valid || m_minmax_count > N)
 		{
 			m_minmax_valid = true;
-			if (!m_points.empty())
+			m_minmax_count = 0;
+		}
+		if (N == 0) m_max = m_min = 0;
+		else
+		{
+			// Only points appended since the last update need to be checked:
+			const float* vs = m_colorFromDepth == CPointCloud::colZ
+				? &m_points[0].z
+				: (m_colorFromDepth == CPointCloud::colY ? &m_points[0].y
+														 : &m_points[0].x);
+			if (m_minmax_count == 0) m_min = m_max = vs[0];
+			for (size_t i = m_minmax_count; i < N; i++)
 			{
-				const float* vs = m_colorFromDepth == CPointCloud::colZ
-					? &m_points[0].z
-					: (m_colorFromDepth == CPointCloud::colY ? &m_points[0].y
-															 : &m_points[0].x);
-				m_min = m_max = vs[0];
-				for (size_t i = 1; i < N; i++)
-				{
-					float v = vs[3 * i];
-					if (v < m_min) m_min = v;
-					if (v > m_max) m_max = v;
-				}
+				float v = vs[3 * i];
+				if (v < m_min) m_min = v;
+				if (v > m_max) m_max = v;
 			}
-			else
-				m_max = m_min = 0;
 		}
+		m_minmax_count = N;
 
 		m_max_m_min = m_max - m_min;
 		if (std::abs(m_max_m_min) < 1e-4) m_max_m_min = -1;
 		else
-			m_min = m_max - m_max_m_min * 1.01f;
+			depthMin = m_max - m_max_m_min * 1.01f;
 		m_max_m_min_inv = 1.0f / m_max_m_min;
 	}
 
@@ -114,15 +122,38 @@ void CPointCloud::onUpdateBuffers_Points()
 	// "CRenderizableShaderPoints::m_vertex_buffer_data" is already done, since
 	// "m_points" is an alias for it.
 
+	// If anything the colors depend on changed (e.g. the depth range grew
+	// with new points), all colors must be regenerated. Otherwise, only those
+	// of the modified or appended points:
+	const std::array<float, 13> colorParams = {
+		static_cast<float>(m_colorFromDepth),
+		depthMin,
+		m_max_m_min_inv,
+		m_colorFromDepth_min.R,
+		m_colorFromDepth_min.G,
+		m_colorFromDepth_min.B,
+		m_col_slop_inv.R,
+		m_col_slop_inv.G,
+		m_col_slop_inv.B,
+		m_color.R,
+		m_color.G,
+		m_color.B,
+		m_color.A};
+	if (colorParams != m_bufferColorParams)
+	{
+		m_bufferColorParams = colorParams;
+		markAllPointsAsModified();
+	}
+	const auto [first, last] = modifiedPointsRange();
+
 	// color buffer:
 	auto& cbd = CRenderizableShaderPoints::m_color_buffer_data;
-	cbd.clear();
-	cbd.reserve(N);
+	cbd.resize(N);
 
 	// color for each point:
 	if (m_colorFromDepth != colNone && m_max_m_min > 0)
 	{
-		for (size_t i = 0; i < N; i++)
+		for (size_t i = first; i < last; i++)
 		{
 			const float depthCol =
 				(m_colorFromDepth == colX
@@ -130,20 +161,20 @@ void CPointCloud::onUpdateBuffers_Points()
 					 : (m_colorFromDepth == colY ? m_points[i].y
 												 : m_points[i].z));
 
-			float f = (depthCol - m_min) * m_max_m_min_inv;
+			float f = (depthCol - depthMin) * m_max_m_min_inv;
 			f = std::max(0.0f, min(1.0f, f));
 
-			cbd.push_back(
-				{f2u8(m_colorFromDepth_min.R + f * m_col_slop_inv.R),
-				 f2u8(m_colorFromDepth_min.G + f * m_col_slop_inv.G),
-				 f2u8(m_colorFromDepth_min.B + f * m_col_slop_inv.B),
-				 m_color.A});
+			cbd[i] = {
+				f2u8(m_colorFromDepth_min.R + f * m_col_slop_inv.R),
+				f2u8(m_colorFromDepth_min.G + f * m_col_slop_inv.G),
+				f2u8(m_colorFromDepth_min.B + f * m_col_slop_inv.B),
+				m_color.A};
 		}
 	}
 	else
 	{
 		// all points: same color
-		cbd.assign(N, m_color);
+		std::fill(cbd.begin() + first, cbd.begin() + last, m_color);
 	}
 
 	m_last_rendered_count = m_last_rendered_count_ongoing;
@@ -358,12 +389,10 @@ void CPointCloud::insertPoint(float x, float y, float z)
 {
 	m_points.emplace_back(x, y, z);
 
-	m_minmax_valid = false;
-
-	// JL: TODO note: Well, this can be clearly done much more efficiently
-	// but...I don't have time! :-(
-	markAllPointsAsNew();
-	CRenderizable::notifyChange();
+	// Only the new point has to be uploaded, and the depth range is
+	// extended with it in the next buffers update:
+	octree_mark_as_outdated();
+	markPointsAsModified(m_points.size() - 1, m_points.size());
 }
 
 /** Write an individual point (checks for "i" in the valid range only in
@@ -373,13 +402,7 @@ void CPointCloud::setPoint(
 	size_t i, const float x, const float y, const float z)
 {
 	m_points.at(i) = {x, y, z};
-
-	m_minmax_valid = false;
-
-	// JL: TODO note: Well, this can be clearly done much more efficiently
-	// but...I don't have time! :-(
-	markAllPointsAsNew();
-	CRenderizable::notifyChange();
+	setPoint_fast(i, x, y, z);
 }
 
 /*---------------------------------------------------------------
@@ -390,6 +413,7 @@ void CPointCloud::setGradientColors(
 {
 	m_colorFromDepth_min = colorMin;
 	m_colorFromDepth_max = colorMax;
+	CRenderizable::notifyChange();
 }
 
 // Do needed internal work if all points are new (octree rebuilt,...)
@@ -397,7 +421,7 @@ void CPointCloud::markAllPointsAsNew()
 {
 	m_minmax_valid = false;
 	octree_mark_as_outdated();
-	CRenderizable::notifyChange();
+	markAllPointsAsModified();
 }
 
 /** In a base class, reserve memory to prepare subsequent calls to
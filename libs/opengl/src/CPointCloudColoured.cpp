@@ -26,7 +26,6 @@ IMPLEMENTS_SERIALIZABLE(CPointCloudColoured, CRenderizable, mrpt::opengl)
 
 void CPointCloudColoured::onUpdateBuffers_Points()
 {
-	octree_assure_uptodate();  // Rebuild octree if needed
 	m_last_rendered_count_ongoing = 0;
 
 	{
@@ -42,7 +41,8 @@ void CPointCloudColoured::onUpdateBuffers_Points()
 
 	// const auto N = m_points.size();
 
-	octree_assure_uptodate();  // Rebuild octree if needed
+	// Note: the octree is only used for bounding boxes, and it is rebuilt
+	// on demand from octree_getBoundingBox().
 	m_last_rendered_count_ongoing = 0;
 
 	// TODO: Restore rendering using octrees?
@@ -150,10 +150,8 @@ void CPointCloudColoured::setPoint(size_t i, const TPointXYZfRGBAu8& p)
 	c.B = p.b;
 	c.A = p.a;
 
-	// JL: TODO note: Well, this can be clearly done much more efficiently
-	// but...I don't have time! :-(
-	markAllPointsAsNew();
-	CRenderizable::notifyChange();
+	octree_mark_as_outdated();
+	markPointsAsModified(i, i + 1);
 }
 
 /** Inserts a new point into the point cloud. */
@@ -163,10 +161,9 @@ void CPointCloudColoured::push_back(
 	m_points.emplace_back(x, y, z);
 	m_point_colors.emplace_back(f2u8(R), f2u8(G), f2u8(B), f2u8(A));
 
-	// JL: TODO note: Well, this can be clearly done much more efficiently
-	// but...I don't have time! :-(
-	markAllPointsAsNew();
-	CRenderizable::notifyChange();
+	// Only the new point has to be uploaded:
+	octree_mark_as_outdated();
+	markPointsAsModified(m_points.size() - 1, m_points.size());
 }
 
 void CPointCloudColoured::insertPoint(const mrpt::math::TPointXYZfRGBAu8& p)
@@ -174,15 +171,15 @@ void CPointCloudColoured::insertPoint(const mrpt::math::TPointXYZfRGBAu8& p)
 	m_points.emplace_back(p.pt);
 	m_point_colors.emplace_back(p.r, p.g, p.b, p.a);
 
-	markAllPointsAsNew();
-	CRenderizable::notifyChange();
+	octree_mark_as_outdated();
+	markPointsAsModified(m_points.size() - 1, m_points.size());
 }
 
 // Do needed internal work if all points are new (octree rebuilt,...)
 void CPointCloudColoured::markAllPointsAsNew()
 {
 	octree_mark_as_outdated();
-	CRenderizable::notifyChange();
+	markAllPointsAsModified();
 }
 /** In a base class, reserve memory to prepare subsequent calls to
  * PLY_import_set_vertex */
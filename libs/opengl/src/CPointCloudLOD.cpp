@@ -0,0 +1,127 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "opengl-precomp.h"	 // Precompiled header
+//
+#include <mrpt/opengl/CPointCloudLOD.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/filesystem.h>
+
+using namespace mrpt;
+using namespace mrpt::opengl;
+
+IMPLEMENTS_SERIALIZABLE(CPointCloudLOD, CRenderizable, mrpt::opengl)
+
+CPointCloudLOD::CPointCloudLOD(const std::string& lodOctreeFile)
+{
+	loadFromFile(lodOctreeFile);
+}
+
+CPointCloudLOD::CPointCloudLOD(const CPointCloudLOD& o)
+	: CRenderizable(o),
+	  CRenderizableShaderPoints(o),
+	  selectionParameters(o.selectionParameters)
+{
+	m_octree.setMemoryBudget(o.m_octree.getMemoryBudget());
+	if (o.m_octree.isOpen()) loadFromFile(o.m_fileName);
+	else
+		m_fileName = o.m_fileName;
+}
+
+void CPointCloudLOD::loadFromFile(const std::string& lodOctreeFile)
+{
+	m_octree.open(lodOctreeFile);
+	m_fileName = lodOctreeFile;
+	m_selected.clear();
+	m_bufferNodes.clear();
+	m_bufferLoadCounter = 0;
+	CRenderizable::notifyChange();
+}
+
+void CPointCloudLOD::render(const RenderContext& rc) const
+{
+	if (m_octree.isOpen())
+	{
+		// Select the nodes for this view and request them. The buffers will
+		// be updated with them before the next render, if there are changes.
+		m_octree.selectNodes(*rc.state, m_selected, selectionParameters);
+		m_octree.requestNodes(m_selected);
+		if (m_selected != m_bufferNodes ||
+			m_octree.loadedNodesCounter() != m_bufferLoadCounter)
+			CRenderizable::notifyChange();
+	}
+	CRenderizableShaderPoints::render(rc);
+}
+
+void CPointCloudLOD::onUpdateBuffers_Points()
+{
+	// Read the counter first, so nodes loaded meanwhile are uploaded later:
+	m_bufferLoadCounter = m_octree.loadedNodesCounter();
+	m_bufferNodes = m_selected;
+
+	auto& vbd = CRenderizableShaderPoints::m_vertex_buffer_data;
+	auto& cbd = CRenderizableShaderPoints::m_color_buffer_data;
+	vbd.clear();
+	cbd.clear();
+	for (const auto id : m_bufferNodes)
+	{
+		const auto pts = m_octree.nodePoints(id);
+		if (!pts) continue;
+		for (const auto& p : *pts)
+		{
+			vbd.push_back(p.pt);
+			cbd.emplace_back(p.r, p.g, p.b, p.a);
+		}
+	}
+}
+
+auto CPointCloudLOD::getBoundingBox() const -> mrpt::math::TBoundingBox
+{
+	if (m_octree.nodes().empty()) return {};
+	const auto bb = m_octree.boundingBox();
+	return mrpt::math::TBoundingBox(
+			   mrpt::math::TPoint3D(bb.min), mrpt::math::TPoint3D(bb.max))
+		.compose(m_pose);
+}
+
+uint8_t CPointCloudLOD::serializeGetVersion() const { return 0; }
+void CPointCloudLOD::serializeTo(mrpt::serialization::CArchive& out) const
+{
+	writeToStreamRender(out);
+	out << m_fileName << selectionParameters.maxPixelSpacing;
+	out.WriteAs<uint64_t>(selectionParameters.pointBudget);
+	out.WriteAs<uint64_t>(m_octree.getMemoryBudget());
+	CRenderizableShaderPoints::params_serialize(out);
+}
+
+void CPointCloudLOD::serializeFrom(
+	mrpt::serialization::CArchive& in, uint8_t version)
+{
+	switch (version)
+	{
+		case 0:
+		{
+			readFromStreamRender(in);
+			std::string fileName;
+			in >> fileName >> selectionParameters.maxPixelSpacing;
+			selectionParameters.pointBudget = in.ReadAs<uint64_t>();
+			m_octree.setMemoryBudget(in.ReadAs<uint64_t>());
+			CRenderizableShaderPoints::params_deserialize(in);
+
+			// The octree file may not exist in this computer:
+			m_octree.close();
+			m_fileName = fileName;
+			if (!fileName.empty() && mrpt::system::fileExists(fileName))
+				loadFromFile(fileName);
+		}
+		break;
+		default: MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version);
+	};
+	CRenderizable::notifyChange();
+}
@@ -0,0 +1,111 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/opengl/CPointCloud.h>
+#include <mrpt/opengl/CPointCloudColoured.h>
+
+using range_t = std::pair<size_t, size_t>;
+
+// Adds points with z in [0,1]:
+static void appendScan(mrpt::opengl::CPointCloud& pc, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		pc.insertPoint(i * 0.1f, pc.size() * 0.01f, (i % 11) * 0.1f);
+}
+
+static void expectSameBuffers(
+	const mrpt::opengl::CPointCloud& a, const mrpt::opengl::CPointCloud& b)
+{
+	const auto &va = a.shaderPointsVertexPointBuffer(),
+			   &vb = b.shaderPointsVertexPointBuffer();
+	const auto &ca = a.shaderPointsVertexColorBuffer(),
+			   &cb = b.shaderPointsVertexColorBuffer();
+	ASSERT_EQ(va.size(), vb.size());
+	ASSERT_EQ(ca.size(), cb.size());
+	ASSERT_EQ(ca.size(), va.size());
+	for (size_t i = 0; i < va.size(); i++)
+	{
+		EXPECT_EQ(va[i], vb[i]);
+		EXPECT_EQ(ca[i], cb[i]) << "i=" << i;
+	}
+}
+
+TEST(CPointCloud, incrementalBuffersUpdate)
+{
+	for (const bool colorFromZ : {false, true})
+	{
+		mrpt::opengl::CPointCloud pc;
+		pc.enableColorFromZ(colorFromZ);
+
+		appendScan(pc, 100);
+		EXPECT_EQ(pc.prepareBuffers_Points(), range_t(0, 100));
+		// Nothing changed:
+		const auto r0 = pc.prepareBuffers_Points();
+		EXPECT_EQ(r0.first, r0.second);
+
+		// New points within the former depth range: only those are updated.
+		appendScan(pc, 50);
+		EXPECT_EQ(pc.prepareBuffers_Points(), range_t(100, 150));
+
+		pc.setPoint(20, 1.0f, 2.0f, 0.5f);
+		EXPECT_EQ(pc.prepareBuffers_Points(), range_t(20, 21));
+
+		// The buffers are the same as those built from scratch:
+		mrpt::opengl::CPointCloud pc2;
+		pc2.enableColorFromZ(colorFromZ);
+		auto pts = pc.getArrayPoints();
+		pc2.setAllPointsFast(pts);
+		pc2.prepareBuffers_Points();
+		expectSameBuffers(pc, pc2);
+
+		// A point out of the depth range changes all colors:
+		pc.insertPoint(0, 0, 10.0f);
+		const auto r = pc.prepareBuffers_Points();
+		EXPECT_EQ(r.first, colorFromZ ? 0U : 150U);
+		EXPECT_EQ(r.second, 151U);
+
+		// And so does any change in the color:
+		pc.setColor_u8(10, 20, 30);
+		EXPECT_EQ(pc.prepareBuffers_Points(), range_t(0, 151));
+
+		pc2.insertPoint(0, 0, 10.0f);
+		pc2.setColor_u8(10, 20, 30);
+		pc2.prepareBuffers_Points();
+		expectSameBuffers(pc, pc2);
+
+		pc.clear();
+		EXPECT_EQ(pc.prepareBuffers_Points(), range_t(0, 0));
+		EXPECT_TRUE(pc.shaderPointsVertexColorBuffer().empty());
+	}
+}
+
+TEST(CPointCloudColoured, incrementalBuffersUpdate)
+{
+	mrpt::opengl::CPointCloudColoured pc;
+	for (int i = 0; i < 10; i++)
+		pc.push_back(i, 0, 0, 1, 0, 0);
+	EXPECT_EQ(pc.prepareBuffers_Points(), range_t(0, 10));
+
+	pc.insertPoint({10.0f, 0, 0, 0, 0xff, 0});
+	pc.push_back(11, 0, 0, 0, 0, 1);
+	EXPECT_EQ(pc.prepareBuffers_Points(), range_t(10, 12));
+
+	pc.setPointColor_fast(3, 0, 1, 0);
+	pc.setPoint_fast(5, 0, 0, 0);
+	EXPECT_EQ(pc.prepareBuffers_Points(), range_t(3, 6));
+
+	// Changes in the object pose do not affect the buffers:
+	pc.setLocation(1, 2, 3);
+	const auto r = pc.prepareBuffers_Points();
+	EXPECT_EQ(r.first, r.second);
+
+	pc.resize(5);
+	EXPECT_EQ(pc.prepareBuffers_Points(), range_t(0, 5));
+}
@@ -1946,7 +1946,13 @@ void CPolyhedron::serializeFrom(
 
 auto CPolyhedron::getBoundingBox() const -> mrpt::math::TBoundingBox
 {
-	return mrpt::math::TBoundingBox({0, 0, 0}, {0, 0, 0}).compose(m_pose);
+	if (m_Vertices.empty())
+		return mrpt::math::TBoundingBox({0, 0, 0}, {0, 0, 0}).compose(m_pose);
+
+	auto bb = mrpt::math::TBoundingBox::PlusMinusInfinity();
+	for (const auto& v : m_Vertices)
+		bb.updateWithPoint(v);
+	return bb.compose(m_pose);
 }
 
 /*CPolyhedron::Ptr CPolyhedron::CreateCuboctahedron(double radius)	{
@@ -12,6 +12,11 @@
 #include <mrpt/math/TPose3D.h>
 #include <mrpt/math/utils.h>
 #include <mrpt/opengl/CRenderizable.h>	// Include these before windows.h!!
+#include <mrpt/opengl/CRenderizableShaderPoints.h>
+#include <mrpt/opengl/CRenderizableShaderText.h>
+#include <mrpt/opengl/CRenderizableShaderTexturedTriangles.h>
+#include <mrpt/opengl/CRenderizableShaderTriangles.h>
+#include <mrpt/opengl/CRenderizableShaderWireFrame.h>
 #include <mrpt/opengl/CText.h>
 #include <mrpt/opengl/opengl_api.h>
 #include <mrpt/poses/CPoint2D.h>
@@ -19,6 +24,7 @@
 #include <mrpt/poses/CPose3D.h>
 #include <mrpt/serialization/CArchive.h>
 
+#include <atomic>
 #include <mutex>
 
 using namespace std;
@@ -40,6 +46,12 @@ CRenderizable::CRenderizable()
 // Destructor:
 CRenderizable::~CRenderizable() = default;
 
+uint64_t CRenderizable::NewChangeGeneration()
+{
+	static std::atomic<uint64_t> counter{0};
+	return ++counter;
+}
+
 void CRenderizable::writeToStreamRender(
 	mrpt::serialization::CArchive& out) const
 {
@@ -240,3 +252,41 @@ CText& CRenderizable::labelObject() const
 	}
 	return *m_label_obj;
 }
+
+const mrpt::math::TBoundingBox& CRenderizable::cachedBoundingBox() const
+{
+	if (!m_cachedBBoxValid || m_cachedBBoxPose != m_pose)
+	{
+		m_cachedBBox = getBoundingBox();
+		m_cachedBBoxPose = m_pose;
+		m_cachedBBoxValid = true;
+	}
+	return m_cachedBBox;
+}
+
+bool CRenderizable::updateCPUBuffers() const
+{
+	if (!m_outdatedCPUBuffers) return false;
+
+	const_cast<CRenderizable&>(*this).onUpdateCPUBuffers();
+
+	m_outdatedCPUBuffers = false;
+	m_cachedBBoxValid = false;
+	return true;
+}
+
+void CRenderizable::onUpdateCPUBuffers()
+{
+	// The same methods renderUpdateBuffers() calls in each shader base
+	// class, which do not require an OpenGL context:
+	if (auto p = dynamic_cast<CRenderizableShaderPoints*>(this); p)
+		p->onUpdateBuffers_Points();
+	if (auto p = dynamic_cast<CRenderizableShaderWireFrame*>(this); p)
+		p->onUpdateBuffers_Wireframe();
+	if (auto p = dynamic_cast<CRenderizableShaderTriangles*>(this); p)
+		p->onUpdateBuffers_Triangles();
+	if (auto p = dynamic_cast<CRenderizableShaderTexturedTriangles*>(this); p)
+		p->onUpdateBuffers_TexturedTriangles();
+	if (auto p = dynamic_cast<CRenderizableShaderText*>(this); p)
+		p->onUpdateBuffers_Text();
+}
@@ -23,26 +23,102 @@ IMPLEMENTS_VIRTUAL_SERIALIZABLE(
 // Dtor:
 CRenderizableShaderPoints::~CRenderizableShaderPoints() = default;
 
+std::pair<size_t, size_t> CRenderizableShaderPoints::prepareBuffers_Points()
+	const
+{
+	// Generate vertices & colors:
+	const_cast<CRenderizableShaderPoints&>(*this).onUpdateBuffers_Points();
+
+	const auto range = modifiedPointsRange();
+
+	// Start tracking changes for the next update:
+	if (m_incrementalPointsUpdate)
+	{
+		m_modifiedFirst = std::numeric_limits<size_t>::max();
+		m_modifiedLast = 0;
+	}
+	else
+	{
+		m_modifiedFirst = 0;
+		m_modifiedLast = std::numeric_limits<size_t>::max();
+	}
+	return range;
+}
+
+void CRenderizableShaderPoints::markPointsAsModified(
+	size_t first, size_t last) const
+{
+	m_modifiedFirst = std::min(m_modifiedFirst, first);
+	m_modifiedLast = std::max(m_modifiedLast, last);
+	if (first < m_verticesBBoxCount) m_verticesBBoxCount = 0;
+	CRenderizable::notifyChange();
+}
+
+void CRenderizableShaderPoints::markAllPointsAsModified() const
+{
+	markPointsAsModified(0, std::numeric_limits<size_t>::max());
+}
+
+std::pair<size_t, size_t> CRenderizableShaderPoints::modifiedPointsRange()
+	const
+{
+	const size_t N = m_vertex_buffer_data.size();
+	const size_t last = std::min(m_modifiedLast, N);
+	return {std::min(m_modifiedFirst, last), last};
+}
+
 void CRenderizableShaderPoints::renderUpdateBuffers() const
 {
 #if MRPT_HAS_OPENGL_GLUT
 
-	// Generate vertices & colors:
-	const_cast<CRenderizableShaderPoints&>(*this).onUpdateBuffers_Points();
+	const auto [first, last] = prepareBuffers_Points();
 
-	// Define OpenGL buffers:
 	m_vertexBuffer.createOnce();
-	m_vertexBuffer.bind();
-	m_vertexBuffer.allocate(
-		m_vertex_buffer_data.data(),
-		sizeof(m_vertex_buffer_data[0]) * m_vertex_buffer_data.size());
-
-	// color buffer:
 	m_colorBuffer.createOnce();
-	m_colorBuffer.bind();
-	m_colorBuffer.allocate(
-		m_color_buffer_data.data(),
-		sizeof(m_color_buffer_data[0]) * m_color_buffer_data.size());
+
+	const size_t N = m_vertex_buffer_data.size();
+	const size_t vSize = sizeof(mrpt::math::TPoint3Df);
+	const size_t cSize = sizeof(mrpt::img::TColor);
+
+	if (!m_incrementalPointsUpdate || m_color_buffer_data.size() != N)
+	{
+		// Define OpenGL buffers with exactly all points:
+		m_buffersCapacity = 0;
+		m_vertexBuffer.bind();
+		m_vertexBuffer.allocate(m_vertex_buffer_data.data(), vSize * N);
+
+		// color buffer:
+		m_colorBuffer.bind();
+		m_colorBuffer.allocate(
+			m_color_buffer_data.data(),
+			cSize * m_color_buffer_data.size());
+	}
+	else if (N > m_buffersCapacity || N < m_buffersCapacity / 4)
+	{
+		// (Re)allocate, leaving room for further points to be appended
+		// without reallocating, and upload all points:
+		m_buffersCapacity = std::max<size_t>(N + N / 2, 1024);
+
+		m_vertexBuffer.bind();
+		m_vertexBuffer.allocate(nullptr, vSize * m_buffersCapacity);
+		m_vertexBuffer.update(0, m_vertex_buffer_data.data(), vSize * N);
+
+		m_colorBuffer.bind();
+		m_colorBuffer.allocate(nullptr, cSize * m_buffersCapacity);
+		m_colorBuffer.update(0, m_color_buffer_data.data(), cSize * N);
+	}
+	else if (first < last)
+	{
+		// Only upload the modified points:
+		m_vertexBuffer.bind();
+		m_vertexBuffer.update(
+			vSize * first, &m_vertex_buffer_data[first],
+			vSize * (last - first));
+
+		m_colorBuffer.bind();
+		m_colorBuffer.update(
+			cSize * first, &m_color_buffer_data[first], cSize * (last - first));
+	}
 
 	// VAO: required to use glEnableVertexAttribArray()
 	m_vao.createOnce();
@@ -138,26 +214,20 @@ void CRenderizableShaderPoints::params_deserialize(
 const mrpt::math::TBoundingBox CRenderizableShaderPoints::verticesBoundingBox()
 	const
 {
-	mrpt::math::TBoundingBox bb;
-
-	if (m_vertex_buffer_data.empty()) return bb;
-
-	bb.min = mrpt::math::TPoint3D(
-		std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
-		std::numeric_limits<double>::max());
-	bb.max = mrpt::math::TPoint3D(
-		-std::numeric_limits<double>::max(),
-		-std::numeric_limits<double>::max(),
-		-std::numeric_limits<double>::max());
-
-	for (const auto& p : m_vertex_buffer_data)
-	{
-		keep_min(bb.min.x, p.x);
-		keep_max(bb.max.x, p.x);
-		keep_min(bb.min.y, p.y);
-		keep_max(bb.max.y, p.y);
-		keep_min(bb.min.z, p.z);
-		keep_max(bb.max.z, p.z);
-	}
-	return bb;
+	const auto& pts = m_vertex_buffer_data;
+	if (pts.empty()) return {};
+
+	// Start over, unless only new points were appended:
+	if (!m_incrementalPointsUpdate || m_verticesBBoxCount > pts.size())
+		m_verticesBBoxCount = 0;
+	if (m_verticesBBoxCount == 0)
+		m_verticesBBox = mrpt::math::TBoundingBoxf::PlusMinusInfinity();
+
+	for (size_t i = m_verticesBBoxCount; i < pts.size(); i++)
+		m_verticesBBox.updateWithPoint(pts[i]);
+	m_verticesBBoxCount = pts.size();
+
+	return {
+		mrpt::math::TPoint3D(m_verticesBBox.min),
+		mrpt::math::TPoint3D(m_verticesBBox.max)};
 }
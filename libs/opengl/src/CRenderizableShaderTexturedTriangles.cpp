@@ -174,13 +174,14 @@ void CRenderizableShaderTexturedTriangles::render(const RenderContext& rc) const
 // Data types for memory pooling CRenderizableShaderTexturedTriangles:
 #ifdef TEXTUREOBJ_USE_MEMPOOL
 
-#include <mrpt/system/CGenericMemoryPool.h>
+#include <mrpt/system/CSizeClassMemoryPool.h>
 
 struct CRenderizableShaderTexturedTriangles_MemPoolParams
 {
 	/** size of the vector<unsigned char> */
 	size_t len = 0;
 
+	inline size_t size() const { return len; }
 	inline bool isSuitable(
 		const CRenderizableShaderTexturedTriangles_MemPoolParams& req) const
 	{
@@ -192,7 +193,7 @@ struct CRenderizableShaderTexturedTriangles_MemPoolData
 	vector<unsigned char> data;
 };
 
-using TMyMemPool = mrpt::system::CGenericMemoryPool<
+using TMyMemPool = mrpt::system::CSizeClassMemoryPool<
 	CRenderizableShaderTexturedTriangles_MemPoolParams,
 	CRenderizableShaderTexturedTriangles_MemPoolData>;
 #endif
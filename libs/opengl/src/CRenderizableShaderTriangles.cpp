@@ -15,6 +15,8 @@
 #include <mrpt/opengl/opengl_api.h>
 #include <mrpt/serialization/CArchive.h>
 
+#include <algorithm>
+
 using namespace mrpt;
 using namespace mrpt::opengl;
 
@@ -24,19 +26,92 @@ IMPLEMENTS_VIRTUAL_SERIALIZABLE(
 // Dtor:
 CRenderizableShaderTriangles::~CRenderizableShaderTriangles() = default;
 
-void CRenderizableShaderTriangles::renderUpdateBuffers() const
+std::vector<std::pair<size_t, size_t>>
+	CRenderizableShaderTriangles::prepareBuffers_Triangles() const
 {
-#if MRPT_HAS_OPENGL_GLUT
 	// Generate vertices & colors into m_triangles
 	const_cast<CRenderizableShaderTriangles&>(*this)
 		.onUpdateBuffers_Triangles();
 
-	const auto n = m_triangles.size();
+	auto ranges = modifiedTrianglesRanges();
+
+	// Start tracking changes for the next update:
+	m_modifiedRanges.clear();
+	m_allRangesModified = !m_incrementalTrianglesUpdate;
+
+	return ranges;
+}
+
+void CRenderizableShaderTriangles::markTrianglesAsModified(
+	size_t first, size_t last) const
+{
+	if (m_allRangesModified || first >= last) return;
+	m_modifiedRanges.emplace_back(first, last);
+}
+
+void CRenderizableShaderTriangles::markAllTrianglesAsModified() const
+{
+	m_modifiedRanges.clear();
+	m_allRangesModified = true;
+}
+
+std::vector<std::pair<size_t, size_t>>
+	CRenderizableShaderTriangles::modifiedTrianglesRanges() const
+{
+	const size_t N = m_triangles.size();
+	std::vector<std::pair<size_t, size_t>> ranges;
+	if (m_allRangesModified)
+	{
+		if (N) ranges.emplace_back(0, N);
+		return ranges;
+	}
+
+	// Sort, and merge overlapping or adjacent ranges:
+	auto sorted = m_modifiedRanges;
+	std::sort(sorted.begin(), sorted.end());
+	for (auto [first, last] : sorted)
+	{
+		last = std::min(last, N);
+		if (first >= last) continue;
+		if (!ranges.empty() && first <= ranges.back().second)
+			ranges.back().second = std::max(ranges.back().second, last);
+		else
+			ranges.emplace_back(first, last);
+	}
+	return ranges;
+}
+
+void CRenderizableShaderTriangles::renderUpdateBuffers() const
+{
+#if MRPT_HAS_OPENGL_GLUT
+	const auto ranges = prepareBuffers_Triangles();
+
+	const size_t n = m_triangles.size();
+	const size_t tSize = sizeof(m_triangles[0]);
 
 	// Define OpenGL buffers:
 	m_trianglesBuffer.createOnce();
 	m_trianglesBuffer.bind();
-	m_trianglesBuffer.allocate(m_triangles.data(), sizeof(m_triangles[0]) * n);
+
+	if (!m_incrementalTrianglesUpdate)
+	{
+		m_buffersCapacity = 0;
+		m_trianglesBuffer.allocate(m_triangles.data(), tSize * n);
+	}
+	else if (n > m_buffersCapacity || n < m_buffersCapacity / 4)
+	{
+		// (Re)allocate, leaving room for further triangles, and upload all:
+		m_buffersCapacity = std::max<size_t>(n + n / 2, 1024);
+		m_trianglesBuffer.allocate(nullptr, tSize * m_buffersCapacity);
+		m_trianglesBuffer.update(0, m_triangles.data(), tSize * n);
+	}
+	else
+	{
+		// Only upload the modified triangles:
+		for (const auto& [first, last] : ranges)
+			m_trianglesBuffer.update(
+				tSize * first, &m_triangles[first], tSize * (last - first));
+	}
 
 	// VAO: required to use glEnableVertexAttribArray()
 	m_vao.createOnce();
@@ -68,15 +68,19 @@ void CSetOfTexturedTriangles::serializeFrom(
 		break;
 		default: MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version);
 	};
+	m_trianglesBVHUpToDate = false;
 	CRenderizable::notifyChange();
 }
 
 bool CSetOfTexturedTriangles::traceRay(
-	[[maybe_unused]] const mrpt::poses::CPose3D& o,
-	[[maybe_unused]] double& dist) const
+	const mrpt::poses::CPose3D& o, double& dist) const
 {
-	throw std::runtime_error(
-		"TODO: TraceRay not implemented in CSetOfTexturedTriangles");
+	if (!m_trianglesBVHUpToDate)
+	{
+		m_trianglesBVH.build(m_triangles);
+		m_trianglesBVHUpToDate = true;
+	}
+	return m_trianglesBVH.traceRay(o - this->m_pose, dist);
 }
 
 auto CSetOfTexturedTriangles::getBoundingBox() const -> mrpt::math::TBoundingBox
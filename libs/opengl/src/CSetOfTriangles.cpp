@@ -56,14 +56,19 @@ void CSetOfTriangles::serializeFrom(
 		default: MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version);
 	};
 	polygonsUpToDate = false;
+	m_trianglesBVHUpToDate = false;
 	CRenderizable::notifyChange();
 }
 
 bool CSetOfTriangles::traceRay(
 	const mrpt::poses::CPose3D& o, double& dist) const
 {
-	if (!polygonsUpToDate) updatePolygons();
-	return mrpt::math::traceRay(m_polygons, (o - this->m_pose).asTPose(), dist);
+	if (!m_trianglesBVHUpToDate)
+	{
+		m_trianglesBVH.build(m_triangles);
+		m_trianglesBVHUpToDate = true;
+	}
+	return m_trianglesBVH.traceRay(o - this->m_pose, dist);
 }
 CRenderizable& CSetOfTriangles::setColor_u8(const mrpt::img::TColor& c)
 {
@@ -148,5 +153,6 @@ void CSetOfTriangles::insertTriangles(const CSetOfTriangles::Ptr& p)
 	m_triangles.insert(
 		m_triangles.end(), p->m_triangles.begin(), p->m_triangles.end());
 	polygonsUpToDate = false;
+	m_trianglesBVHUpToDate = false;
 	CRenderizable::notifyChange();
 }
@@ -96,3 +96,9 @@ void CSphere::renderUpdateBuffers() const
 	const_cast<CSphere*>(this)->regenerateBaseParams();
 	BASE::renderUpdateBuffers();
 }
+
+void CSphere::onUpdateCPUBuffers()
+{
+	regenerateBaseParams();
+	BASE::onUpdateCPUBuffers();
+}
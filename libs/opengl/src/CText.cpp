@@ -46,48 +46,56 @@ void CText::onUpdateBuffers_Text()
 		tri.setColor(m_color);
 }
 
-void CText::render(const RenderContext& rc) const
+bool CText::computeTextMatrix(
+	const TRenderMatrices& state, mrpt::math::CMatrixFloat44& mv) const
 {
-#if MRPT_HAS_OPENGL_GLUT
-
 	// Compute pixel of (0,0,0) for this object:
 	// "px" will be given in the range:
 	//     [-1,-1] (left-bottom) - [+1,+1] (top-right)
 	//
-	const auto& pmv = rc.state->pmv_matrix;
-	if (std::abs(pmv(3, 3)) < 1e-10) return;
+	const auto& pmv = state.pmv_matrix;
+	if (std::abs(pmv(3, 3)) < 1e-10) return false;
 
 	const auto px =
 		mrpt::math::TPoint2Df(pmv(0, 3) / pmv(3, 3), pmv(1, 3) / pmv(3, 3));
 
-	// Load matrices in shader:
-	const GLint u_pmat = rc.shader->uniformId("p_matrix");
-	const GLint u_mvmat = rc.shader->uniformId("mv_matrix");
-
-	// Projection: identity
-	static const auto eye4 = mrpt::math::CMatrixFloat44::Identity();
-	glUniformMatrix4fv(u_pmat, 1, true, eye4.data());
-
 	// Model-view: translate and scale
-	auto mv = mrpt::math::CMatrixFloat44::Identity();
+	mv = mrpt::math::CMatrixFloat44::Identity();
 	mv(0, 3) = px.x;
 	mv(1, 3) = px.y;
 	mv(2, 3) = pmv(2, 3) / pmv(3, 3);  // depth
 
-	if (rc.state->viewport_height <= 0 || rc.state->viewport_width <= 0)
+	if (state.viewport_height <= 0 || state.viewport_width <= 0)
 	{
 		std::cerr << "[CText] Warning: invalid viewport size!\n";
-		return;
+		return false;
 	}
 
 	// Find scale according to font height in pixels:
 	const float scale =
-		this->m_fontHeight / static_cast<float>(rc.state->viewport_height);
+		this->m_fontHeight / static_cast<float>(state.viewport_height);
 
-	const float aspect =
-		rc.state->viewport_width / double(rc.state->viewport_height);
+	const float aspect = state.viewport_width / double(state.viewport_height);
 	mv(0, 0) *= scale / aspect;
 	mv(1, 1) *= scale;
+	return true;
+}
+
+void CText::render(const RenderContext& rc) const
+{
+#if MRPT_HAS_OPENGL_GLUT
+
+	// Model-view: translate and scale
+	mrpt::math::CMatrixFloat44 mv;
+	if (!computeTextMatrix(*rc.state, mv)) return;
+
+	// Load matrices in shader:
+	const GLint u_pmat = rc.shader->uniformId("p_matrix");
+	const GLint u_mvmat = rc.shader->uniformId("mv_matrix");
+
+	// Projection: identity
+	static const auto eye4 = mrpt::math::CMatrixFloat44::Identity();
+	glUniformMatrix4fv(u_pmat, 1, true, eye4.data());
 
 	glUniformMatrix4fv(u_mvmat, 1, true, mv.data());
 
@@ -129,6 +137,8 @@ void CText::serializeFrom(mrpt::serialization::CArchive& in, uint8_t version)
 	};
 }
 
+// The text size is given in pixels, hence unknown in scene units. A box
+// reduced to a point is never frustum-culled.
 auto CText::getBoundingBox() const -> mrpt::math::TBoundingBox
 {
 	return mrpt::math::TBoundingBox({0, 0, 0}, {0, 0, 0}).compose(m_pose);
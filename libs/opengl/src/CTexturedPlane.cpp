@@ -56,6 +56,25 @@ void CTexturedPlane::renderUpdateBuffers() const
 		CRenderizableShaderTexturedTriangles::renderUpdateBuffers();
 }
 
+void CTexturedPlane::onUpdateCPUBuffers()
+{
+	// Only one of the two shaders draws something, as in
+	// renderUpdateBuffers():
+	const bool hasTexture =
+		textureImageHasBeenAssigned() && !getTextureImage().isEmpty();
+
+	if (!hasTexture)
+	{
+		onUpdateBuffers_Triangles();
+		CRenderizableShaderTexturedTriangles::m_triangles.clear();
+	}
+	else
+	{
+		onUpdateBuffers_TexturedTriangles();
+		CRenderizableShaderTriangles::m_triangles.clear();
+	}
+}
+
 void CTexturedPlane::onUpdateBuffers_TexturedTriangles()
 {
 	MRPT_START
@@ -0,0 +1,593 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "opengl-precomp.h"	 // Precompiled header
+//
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/io/CFileInputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/opengl/PointCloudLODOctree.h>
+#include <mrpt/serialization/CArchive.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+using namespace mrpt::opengl;
+using mrpt::math::TBoundingBoxf;
+using mrpt::math::TPoint3Df;
+
+using point_t = PointCloudLODOctree::point_t;
+using Node = PointCloudLODOctree::Node;
+
+// Points are saved and loaded as raw memory blocks:
+static_assert(sizeof(point_t) == 16, "Unexpected size of TPointXYZfRGBAu8");
+
+static const char* LOD_OCTREE_FILE_MAGIC = "MRPT_LOD_OCTREE";
+static constexpr uint8_t LOD_OCTREE_FILE_VERSION = 0;
+
+namespace
+{
+// The box of the i-th octant of a node box:
+TBoundingBoxf octantBox(const TBoundingBoxf& b, int i)
+{
+	const TPoint3Df c = (b.min + b.max) * 0.5f;
+	TBoundingBoxf o = b;
+	(i & 1 ? o.min.x : o.max.x) = c.x;
+	(i & 2 ? o.min.y : o.max.y) = c.y;
+	(i & 4 ? o.min.z : o.max.z) = c.z;
+	return o;
+}
+
+// Builds the tree over a permutation of the input points. Each node owns a
+// contiguous range of the permutation, and the depth-first order of nodes
+// follows the order of their ranges, so the permuted points can be written
+// to the file in one pass.
+struct LODOctreeBuilder
+{
+	LODOctreeBuilder(
+		const std::vector<point_t>& points,
+		const PointCloudLODOctree::BuildParameters& params)
+		: pts(points), p(params)
+	{
+		ASSERT_(p.gridResolution > 0 && p.gridResolution <= 1024);
+		ASSERT_(pts.size() < std::numeric_limits<uint32_t>::max());
+		idx.resize(pts.size());
+		for (size_t i = 0; i < idx.size(); i++)
+			idx[i] = static_cast<uint32_t>(i);
+		const size_t G = p.gridResolution;
+		cellStamp.assign(G * G * G, 0);
+	}
+
+	const std::vector<point_t>& pts;
+	const PointCloudLODOctree::BuildParameters& p;
+
+	std::vector<uint32_t> idx;
+	std::vector<Node> nodes;
+
+	// Grid cells taken in the current node are those with the current stamp,
+	// so the grid does not have to be cleared for each node:
+	std::vector<uint32_t> cellStamp;
+	uint32_t curStamp = 0;
+
+	uint32_t build(
+		size_t first, size_t last, const TBoundingBoxf& box, uint32_t level)
+	{
+		const auto id = static_cast<uint32_t>(nodes.size());
+		{
+			Node& n = nodes.emplace_back();
+			n.box = box;
+			n.child.fill(PointCloudLODOctree::INVALID_NODE);
+			n.level = level;
+			n.spacing = (box.max.x - box.min.x) / p.gridResolution;
+			// Index of the first point, turned into a file offset later on:
+			n.fileOffset = first;
+		}
+
+		const size_t count = last - first;
+		if (count <= p.maxLeafPoints || level >= p.maxDepth)
+		{
+			nodes[id].pointCount = static_cast<uint32_t>(count);
+			return id;
+		}
+
+		// Keep the first point found in each cell of the subsampling grid,
+		// moving it to the front of the range:
+		const int G = static_cast<int>(p.gridResolution);
+		const float s = G / (box.max.x - box.min.x);
+		curStamp++;
+		size_t nSampled = 0;
+		for (size_t k = first; k < last; k++)
+		{
+			const TPoint3Df& pt = pts[idx[k]].pt;
+			const int cx = std::clamp(
+				static_cast<int>((pt.x - box.min.x) * s), 0, G - 1);
+			const int cy = std::clamp(
+				static_cast<int>((pt.y - box.min.y) * s), 0, G - 1);
+			const int cz = std::clamp(
+				static_cast<int>((pt.z - box.min.z) * s), 0, G - 1);
+			uint32_t& stamp = cellStamp[(cz * G + cy) * G + cx];
+			if (stamp == curStamp) continue;
+			stamp = curStamp;
+			std::swap(idx[first + nSampled], idx[k]);
+			nSampled++;
+		}
+		nodes[id].pointCount = static_cast<uint32_t>(nSampled);
+
+		// Split the remaining points among the octants, sorted by the octant
+		// index (bit 2=z, bit 1=y, bit 0=x):
+		const TPoint3Df c = (box.min + box.max) * 0.5f;
+		const auto it0 = idx.begin();
+		std::array<size_t, 9> bounds;
+		bounds[0] = first + nSampled;
+		bounds[8] = last;
+		bounds[4] = std::partition(
+						it0 + bounds[0], it0 + bounds[8],
+						[&](uint32_t i) { return pts[i].pt.z < c.z; }) -
+			it0;
+		for (int h = 0; h < 8; h += 4)
+		{
+			bounds[h + 2] = std::partition(
+								it0 + bounds[h], it0 + bounds[h + 4],
+								[&](uint32_t i) { return pts[i].pt.y < c.y; }) -
+				it0;
+			for (int q = h; q < h + 4; q += 2)
+				bounds[q + 1] =
+					std::partition(
+						it0 + bounds[q], it0 + bounds[q + 2],
+						[&](uint32_t i) { return pts[i].pt.x < c.x; }) -
+					it0;
+		}
+
+		for (int i = 0; i < 8; i++)
+		{
+			if (bounds[i] == bounds[i + 1]) continue;
+			const uint32_t childId =
+				build(bounds[i], bounds[i + 1], octantBox(box, i), level + 1);
+			nodes[id].child[i] = childId;
+		}
+		return id;
+	}
+};
+
+}  // namespace
+
+void PointCloudLODOctree::Build(
+	const std::vector<point_t>& points, const std::string& fileName,
+	const BuildParameters& params)
+{
+	MRPT_START
+
+	LODOctreeBuilder b(points, params);
+
+	if (!points.empty())
+	{
+		// The root is a cube around all points:
+		auto bb = TBoundingBoxf::PlusMinusInfinity();
+		for (const auto& p : points)
+			bb.updateWithPoint(p.pt);
+		const TPoint3Df c = (bb.min + bb.max) * 0.5f;
+		const float halfSide = 0.5f *
+			std::max(
+				{bb.max.x - bb.min.x, bb.max.y - bb.min.y, bb.max.z - bb.min.z,
+				 1e-3f});
+		const TPoint3Df d(halfSide, halfSide, halfSide);
+		b.build(0, points.size(), TBoundingBoxf(c - d, c + d), 0);
+	}
+
+	mrpt::io::CFileOutputStream f;
+	if (!f.open(fileName))
+		THROW_EXCEPTION_FMT("Cannot create file: '%s'", fileName.c_str());
+	auto out = mrpt::serialization::archiveFrom(f);
+
+	out << std::string(LOD_OCTREE_FILE_MAGIC) << LOD_OCTREE_FILE_VERSION;
+	out.WriteAs<uint32_t>(b.nodes.size());
+	out.WriteAs<uint64_t>(points.size());
+	for (const Node& n : b.nodes)
+	{
+		out << n.box.min.x << n.box.min.y << n.box.min.z << n.box.max.x
+			<< n.box.max.y << n.box.max.z << n.spacing << n.level
+			<< n.pointCount << n.fileOffset;
+		for (const auto c : n.child)
+			out << c;
+	}
+
+	// The points, in the order of the nodes:
+	std::vector<point_t> buf;
+	const size_t BLOCK = 1 << 16;
+	for (size_t i = 0; i < b.idx.size(); i += BLOCK)
+	{
+		buf.clear();
+		for (size_t k = i; k < std::min(i + BLOCK, b.idx.size()); k++)
+			buf.push_back(points[b.idx[k]]);
+		f.Write(buf.data(), sizeof(point_t) * buf.size());
+	}
+
+	MRPT_END
+}
+
+struct PointCloudLODOctree::Impl
+{
+	std::string fileName;
+	std::vector<Node> nodes;
+	uint64_t totalPoints = 0;
+
+	// All fields below are protected by the mutex:
+	mutable std::mutex mtx;
+	mutable std::condition_variable cvWork, cvIdle;
+
+	std::vector<std::shared_ptr<const std::vector<point_t>>> data;
+	// Last value of "frame" when each node was requested:
+	std::vector<uint64_t> lastUsed;
+	// IDs of nodes with data:
+	std::vector<uint32_t> resident;
+	std::deque<uint32_t> queue;
+	uint64_t frame = 0;
+	size_t residentBytes = 0;
+	size_t budget = size_t(512) << 20;
+	bool busy = false, quit = false;
+
+	std::atomic<uint64_t> loadedCount{0};
+	std::thread thread;
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			quit = true;
+		}
+		cvWork.notify_all();
+		cvIdle.notify_all();
+		if (thread.joinable()) thread.join();
+		quit = false;
+	}
+
+	// Evicts least recently used nodes, except those of the last request,
+	// until there is room for "bytes" more. Must be called with the mutex
+	// locked.
+	bool makeRoom(size_t bytes)
+	{
+		while (residentBytes + bytes > budget)
+		{
+			size_t best = resident.size();
+			for (size_t i = 0; i < resident.size(); i++)
+			{
+				const auto u = lastUsed[resident[i]];
+				if (u < frame &&
+					(best == resident.size() ||
+					 u < lastUsed[resident[best]]))
+					best = i;
+			}
+			if (best == resident.size()) return false;
+
+			const uint32_t id = resident[best];
+			residentBytes -= sizeof(point_t) * nodes[id].pointCount;
+			data[id].reset();
+			resident[best] = resident.back();
+			resident.pop_back();
+		}
+		return true;
+	}
+
+	void loaderThread()
+	{
+		mrpt::io::CFileInputStream f;
+		const bool fileOk = f.open(fileName);
+
+		std::unique_lock<std::mutex> lck(mtx);
+		for (;;)
+		{
+			cvWork.wait(lck, [this]() { return quit || !queue.empty(); });
+			if (quit) break;
+
+			const uint32_t id = queue.front();
+			queue.pop_front();
+			const Node& n = nodes[id];
+			const size_t bytes = sizeof(point_t) * n.pointCount;
+			if (!data[id] && fileOk)
+			{
+				if (!makeRoom(bytes))
+				{
+					// Out of memory budget: drop the rest of this request.
+					queue.clear();
+				}
+				else
+				{
+					busy = true;
+					lck.unlock();
+
+					auto pts = std::make_shared<std::vector<point_t>>(
+						n.pointCount);
+					const bool readOk = f.Seek(n.fileOffset) == n.fileOffset &&
+						f.Read(pts->data(), bytes) == bytes;
+
+					lck.lock();
+					busy = false;
+					if (readOk)
+					{
+						data[id] = std::move(pts);
+						resident.push_back(id);
+						residentBytes += bytes;
+						loadedCount++;
+					}
+				}
+			}
+			if (queue.empty()) cvIdle.notify_all();
+		}
+	}
+};
+
+PointCloudLODOctree::PointCloudLODOctree()
+	: m_impl(std::make_unique<PointCloudLODOctree::Impl>())
+{
+}
+
+PointCloudLODOctree::~PointCloudLODOctree() { close(); }
+
+void PointCloudLODOctree::open(const std::string& fileName)
+{
+	MRPT_START
+
+	close();
+
+	mrpt::io::CFileInputStream f;
+	if (!f.open(fileName))
+		THROW_EXCEPTION_FMT("Cannot open file: '%s'", fileName.c_str());
+	auto in = mrpt::serialization::archiveFrom(f);
+
+	std::string magic;
+	in >> magic;
+	if (magic != LOD_OCTREE_FILE_MAGIC)
+		THROW_EXCEPTION_FMT(
+			"Not a LOD octree file: '%s'", fileName.c_str());
+	const auto version = in.ReadAs<uint8_t>();
+	if (version != LOD_OCTREE_FILE_VERSION)
+		THROW_EXCEPTION_FMT(
+			"Unsupported LOD octree file version: %u",
+			static_cast<unsigned>(version));
+
+	const auto nNodes = in.ReadAs<uint32_t>();
+	const auto nPoints = in.ReadAs<uint64_t>();
+	std::vector<Node> nodes(nNodes);
+	for (Node& n : nodes)
+	{
+		in >> n.box.min.x >> n.box.min.y >> n.box.min.z >> n.box.max.x >>
+			n.box.max.y >> n.box.max.z >> n.spacing >> n.level >>
+			n.pointCount >> n.fileOffset;
+		for (auto& c : n.child)
+		{
+			in >> c;
+			ASSERT_(c == INVALID_NODE || c < nNodes);
+		}
+	}
+
+	// Turn point indices into file offsets:
+	const uint64_t dataStart = f.getPosition();
+	const uint64_t fileSize = f.getTotalBytesCount();
+	ASSERTMSG_(dataStart <= fileSize, "Truncated LOD octree file");
+	// Check in number of points, so corrupt values cannot overflow:
+	const uint64_t filePoints = (fileSize - dataStart) / sizeof(point_t);
+	for (Node& n : nodes)
+	{
+		ASSERTMSG_(
+			n.fileOffset <= filePoints &&
+				n.pointCount <= filePoints - n.fileOffset,
+			"Truncated LOD octree file");
+		n.fileOffset = dataStart + sizeof(point_t) * n.fileOffset;
+	}
+
+	auto& d = *m_impl;
+	d.fileName = fileName;
+	d.nodes = std::move(nodes);
+	d.totalPoints = nPoints;
+	d.data.assign(nNodes, {});
+	d.lastUsed.assign(nNodes, 0);
+	d.frame = 0;
+
+	d.thread = std::thread([&d]() { d.loaderThread(); });
+
+	MRPT_END
+}
+
+void PointCloudLODOctree::close()
+{
+	auto& d = *m_impl;
+	d.stop();
+	d.fileName.clear();
+	d.nodes.clear();
+	d.totalPoints = 0;
+	d.data.clear();
+	d.lastUsed.clear();
+	d.resident.clear();
+	d.queue.clear();
+	d.residentBytes = 0;
+}
+
+bool PointCloudLODOctree::isOpen() const { return m_impl->thread.joinable(); }
+
+const std::string& PointCloudLODOctree::fileName() const
+{
+	return m_impl->fileName;
+}
+
+const std::vector<Node>& PointCloudLODOctree::nodes() const
+{
+	return m_impl->nodes;
+}
+
+uint64_t PointCloudLODOctree::totalPointCount() const
+{
+	return m_impl->totalPoints;
+}
+
+TBoundingBoxf PointCloudLODOctree::boundingBox() const
+{
+	if (m_impl->nodes.empty()) return {};
+	return m_impl->nodes[0].box;
+}
+
+void PointCloudLODOctree::selectNodes(
+	const mrpt::opengl::TRenderMatrices& state,
+	std::vector<uint32_t>& selected, const SelectionParameters& params) const
+{
+	selected.clear();
+	const auto& nodes = m_impl->nodes;
+	if (nodes.empty()) return;
+
+	const auto& pmv = state.pmv_matrix;
+	const auto& mv = state.mv_matrix;
+
+	// A box is out of the view frustum if all its corners are on the outer
+	// side of one of its planes, in clip coordinates:
+	auto isVisible = [&](const TBoundingBoxf& b) {
+		unsigned int outside = 0x3f;
+		for (int i = 0; i < 8 && outside; i++)
+		{
+			const float x = i & 1 ? b.max.x : b.min.x;
+			const float y = i & 2 ? b.max.y : b.min.y;
+			const float z = i & 4 ? b.max.z : b.min.z;
+			float cl[4];
+			for (int r = 0; r < 4; r++)
+				cl[r] = pmv(r, 0) * x + pmv(r, 1) * y + pmv(r, 2) * z +
+					pmv(r, 3);
+			const float w = cl[3];
+			outside &= (cl[0] < -w ? 0x01 : 0) | (cl[0] > w ? 0x02 : 0) |
+				(cl[1] < -w ? 0x04 : 0) | (cl[1] > w ? 0x08 : 0) |
+				(cl[2] < -w ? 0x10 : 0) | (cl[2] > w ? 0x20 : 0);
+		}
+		return outside == 0;
+	};
+
+	// Pixels spanned by one unit of length, at unit distance for projective
+	// cameras (see TRenderMatrices::computeProjectionMatrix()):
+	float pxPerUnit;
+	const bool projective = state.is_projective || state.pinhole_model;
+	if (state.pinhole_model) pxPerUnit = state.pinhole_model->fy();
+	else if (state.is_projective)
+		pxPerUnit = 0.5f * state.viewport_height /
+			std::tan(mrpt::DEG2RAD(0.5f * state.FOV));
+	else
+	{
+		const float ratio =
+			state.viewport_width / (1.0f * state.viewport_height);
+		float Ay = state.eyeDistance * 0.5f;
+		if (ratio < 1 && ratio != 0) Ay /= ratio;
+		pxPerUnit = state.viewport_height / Ay;
+	}
+	const TPoint3Df eye(state.eye);
+
+	// Approximate size of the spacing of node points on the screen. The
+	// model matrix "mv_matrix" takes node coordinates to world coordinates:
+	auto pixelSpacing = [&](const Node& n) {
+		if (!projective) return n.spacing * pxPerUnit;
+
+		const TPoint3Df c = (n.box.min + n.box.max) * 0.5f;
+		float d2 = 0;
+		for (int r = 0; r < 3; r++)
+			d2 += mrpt::square(
+				mv(r, 0) * c.x + mv(r, 1) * c.y + mv(r, 2) * c.z + mv(r, 3) -
+				eye[r]);
+		const float radius = 0.5f * (n.box.max - n.box.min).norm();
+		const float dist = std::sqrt(d2) - radius;
+		// The eye is within the node:
+		if (dist <= 0) return std::numeric_limits<float>::max();
+		return n.spacing * pxPerUnit / dist;
+	};
+
+	// Visit nodes in decreasing order of screen-space size:
+	std::priority_queue<std::pair<float, uint32_t>> q;
+	if (isVisible(nodes[0].box)) q.emplace(pixelSpacing(nodes[0]), 0);
+
+	size_t nPoints = 0;
+	while (!q.empty())
+	{
+		const auto [px, id] = q.top();
+		q.pop();
+		const Node& n = nodes[id];
+		if (nPoints + n.pointCount > params.pointBudget) break;
+
+		nPoints += n.pointCount;
+		selected.push_back(id);
+
+		if (px <= params.maxPixelSpacing) continue;
+		for (const auto c : n.child)
+			if (c != INVALID_NODE && isVisible(nodes[c].box))
+				q.emplace(pixelSpacing(nodes[c]), c);
+	}
+}
+
+void PointCloudLODOctree::setMemoryBudget(size_t bytes)
+{
+	std::lock_guard<std::mutex> lck(m_impl->mtx);
+	m_impl->budget = bytes;
+}
+
+size_t PointCloudLODOctree::getMemoryBudget() const
+{
+	std::lock_guard<std::mutex> lck(m_impl->mtx);
+	return m_impl->budget;
+}
+
+size_t PointCloudLODOctree::residentMemory() const
+{
+	std::lock_guard<std::mutex> lck(m_impl->mtx);
+	return m_impl->residentBytes;
+}
+
+size_t PointCloudLODOctree::residentNodeCount() const
+{
+	std::lock_guard<std::mutex> lck(m_impl->mtx);
+	return m_impl->resident.size();
+}
+
+void PointCloudLODOctree::requestNodes(const std::vector<uint32_t>& ids)
+{
+	auto& d = *m_impl;
+	{
+		std::lock_guard<std::mutex> lck(d.mtx);
+		d.frame++;
+		d.queue.clear();
+		for (const auto id : ids)
+		{
+			ASSERT_LT_(id, d.nodes.size());
+			d.lastUsed[id] = d.frame;
+			if (!d.data[id]) d.queue.push_back(id);
+		}
+	}
+	d.cvWork.notify_one();
+}
+
+void PointCloudLODOctree::waitForPendingLoads() const
+{
+	auto& d = *m_impl;
+	std::unique_lock<std::mutex> lck(d.mtx);
+	d.cvIdle.wait(lck, [&d]() {
+		return d.quit || !d.thread.joinable() ||
+			(d.queue.empty() && !d.busy);
+	});
+}
+
+std::shared_ptr<const std::vector<point_t>> PointCloudLODOctree::nodePoints(
+	uint32_t id) const
+{
+	std::lock_guard<std::mutex> lck(m_impl->mtx);
+	if (id >= m_impl->data.size()) return {};
+	return m_impl->data[id];
+}
+
+uint64_t PointCloudLODOctree::loadedNodesCounter() const
+{
+	return m_impl->loadedCount;
+}
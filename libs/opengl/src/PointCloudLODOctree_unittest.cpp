@@ -0,0 +1,254 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/opengl/PointCloudLODOctree.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/filesystem.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+using mrpt::opengl::PointCloudLODOctree;
+using point_t = PointCloudLODOctree::point_t;
+
+// A 100x100 m bumpy terrain:
+static std::vector<point_t> terrainCloud(size_t N)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(123);
+	std::vector<point_t> pts;
+	for (size_t i = 0; i < N; i++)
+	{
+		const float x = rng.drawUniform(-50.0f, 50.0f),
+					y = rng.drawUniform(-50.0f, 50.0f);
+		pts.emplace_back(
+			x, y, std::sin(0.2f * x) * std::cos(0.1f * y), i & 0xff,
+			(i >> 8) & 0xff, (i >> 16) & 0xff);
+	}
+	return pts;
+}
+
+static mrpt::opengl::TRenderMatrices camera(
+	const mrpt::math::TPoint3D& eye, const mrpt::math::TPoint3D& pointing)
+{
+	mrpt::opengl::TRenderMatrices rm;
+	rm.viewport_width = 640;
+	rm.viewport_height = 480;
+	rm.FOV = 60;
+	rm.is_projective = true;
+	rm.eye = eye;
+	rm.pointing = pointing;
+	rm.up = {0, 0, 1};
+	rm.computeProjectionMatrix(0.1f, 1000.0f);
+	rm.applyLookAt();
+	rm.mv_matrix.setIdentity();
+	rm.pmv_matrix.asEigen() = rm.p_matrix.asEigen() * rm.mv_matrix.asEigen();
+	return rm;
+}
+
+static bool pointLess(const point_t& a, const point_t& b)
+{
+	return std::tie(a.pt.x, a.pt.y, a.pt.z) < std::tie(b.pt.x, b.pt.y, b.pt.z);
+}
+
+class PointCloudLODOctreeTest : public ::testing::Test
+{
+   protected:
+	void SetUp() override
+	{
+		points = terrainCloud(100000);
+		PointCloudLODOctree::BuildParameters bp;
+		bp.maxLeafPoints = 2000;
+		bp.gridResolution = 16;
+		PointCloudLODOctree::Build(points, fileName, bp);
+		lod.open(fileName);
+	}
+	void TearDown() override
+	{
+		lod.close();
+		mrpt::system::deleteFile(fileName);
+	}
+
+	const std::string fileName = mrpt::system::getTempFileName();
+	std::vector<point_t> points;
+	PointCloudLODOctree lod;
+};
+
+TEST_F(PointCloudLODOctreeTest, buildAndLoadAll)
+{
+	const auto& nodes = lod.nodes();
+	ASSERT_GT(nodes.size(), 8U);
+	EXPECT_EQ(lod.totalPointCount(), points.size());
+
+	size_t total = 0;
+	std::vector<uint32_t> all;
+	for (uint32_t i = 0; i < nodes.size(); i++)
+	{
+		total += nodes[i].pointCount;
+		all.push_back(i);
+		for (const auto c : nodes[i].child)
+		{
+			if (c == PointCloudLODOctree::INVALID_NODE) continue;
+			EXPECT_GT(c, i);
+			EXPECT_EQ(nodes[c].level, nodes[i].level + 1);
+			EXPECT_TRUE(nodes[i].box.containsPoint(nodes[c].box.min));
+			EXPECT_TRUE(nodes[i].box.containsPoint(nodes[c].box.max));
+		}
+	}
+	EXPECT_EQ(total, points.size());
+
+	lod.requestNodes(all);
+	lod.waitForPendingLoads();
+	EXPECT_EQ(lod.residentNodeCount(), nodes.size());
+	EXPECT_EQ(lod.residentMemory(), sizeof(point_t) * points.size());
+
+	// All nodes together have all the input points:
+	std::vector<point_t> loaded;
+	for (uint32_t i = 0; i < nodes.size(); i++)
+	{
+		const auto pts = lod.nodePoints(i);
+		ASSERT_TRUE(pts);
+		ASSERT_EQ(pts->size(), nodes[i].pointCount);
+		for (const auto& p : *pts)
+		{
+			EXPECT_TRUE(nodes[i].box.containsPoint(p.pt));
+			loaded.push_back(p);
+		}
+	}
+	std::sort(loaded.begin(), loaded.end(), pointLess);
+	auto expected = points;
+	std::sort(expected.begin(), expected.end(), pointLess);
+	ASSERT_EQ(loaded.size(), expected.size());
+	for (size_t i = 0; i < loaded.size(); i++)
+	{
+		EXPECT_EQ(loaded[i].pt, expected[i].pt);
+		EXPECT_EQ(loaded[i].r, expected[i].r);
+		EXPECT_EQ(loaded[i].g, expected[i].g);
+		EXPECT_EQ(loaded[i].b, expected[i].b);
+	}
+}
+
+TEST_F(PointCloudLODOctreeTest, selectNodes)
+{
+	const auto& nodes = lod.nodes();
+	auto countPoints = [&](const std::vector<uint32_t>& ids) {
+		size_t n = 0;
+		for (const auto id : ids)
+			n += nodes[id].pointCount;
+		return n;
+	};
+
+	std::vector<uint32_t> parent(nodes.size(), 0);
+	for (uint32_t i = 0; i < nodes.size(); i++)
+		for (const auto c : nodes[i].child)
+			if (c != PointCloudLODOctree::INVALID_NODE) parent[c] = i;
+
+	// Looking at the whole cloud, from far away:
+	std::vector<uint32_t> farSel;
+	lod.selectNodes(camera({300, 0, 100}, {0, 0, 0}), farSel);
+	ASSERT_FALSE(farSel.empty());
+	EXPECT_EQ(farSel[0], 0U);
+	for (const auto id : farSel)
+		EXPECT_TRUE(
+			std::find(farSel.begin(), farSel.end(), parent[id]) !=
+			farSel.end());
+
+	// Closer views need more detail:
+	std::vector<uint32_t> nearSel;
+	lod.selectNodes(camera({60, 0, 20}, {0, 0, 0}), nearSel);
+	EXPECT_GT(countPoints(nearSel), countPoints(farSel));
+
+	// Nothing behind the camera is selected:
+	std::vector<uint32_t> sel;
+	lod.selectNodes(camera({60, 0, 2}, {100, 0, 2}), sel);
+	EXPECT_TRUE(sel.empty());
+
+	// Point budget:
+	PointCloudLODOctree::SelectionParameters sp;
+	sp.maxPixelSpacing = 0.1f;
+	sp.pointBudget = 10000;
+	lod.selectNodes(camera({60, 0, 20}, {0, 0, 0}), sel, sp);
+	EXPECT_FALSE(sel.empty());
+	EXPECT_LE(countPoints(sel), sp.pointBudget);
+}
+
+TEST_F(PointCloudLODOctreeTest, memoryBudget)
+{
+	const auto& nodes = lod.nodes();
+
+	const size_t budget = sizeof(point_t) * 12000;
+	lod.setMemoryBudget(budget);
+
+	// Request nodes in groups, the former ones must be evicted:
+	std::vector<uint32_t> ids;
+	size_t groupPoints = 0;
+	for (uint32_t i = 0; i < nodes.size(); i++)
+	{
+		if (groupPoints + nodes[i].pointCount > 6000)
+		{
+			lod.requestNodes(ids);
+			lod.waitForPendingLoads();
+			EXPECT_LE(lod.residentMemory(), budget);
+			for (const auto id : ids)
+				EXPECT_TRUE(lod.nodePoints(id));
+			ids.clear();
+			groupPoints = 0;
+		}
+		ids.push_back(i);
+		groupPoints += nodes[i].pointCount;
+	}
+	EXPECT_GT(lod.loadedNodesCounter(), 0U);
+
+	// Requests beyond the budget are only loaded partially:
+	std::vector<uint32_t> all(nodes.size());
+	std::iota(all.begin(), all.end(), 0);
+	lod.requestNodes(all);
+	lod.waitForPendingLoads();
+	EXPECT_LE(lod.residentMemory(), budget);
+	EXPECT_LT(lod.residentNodeCount(), nodes.size());
+}
+
+TEST_F(PointCloudLODOctreeTest, corruptNodeRanges)
+{
+	lod.close();
+
+	// Location of the pointCount and fileOffset of the root node: after the
+	// header (magic string, version, node and point counts), and the box,
+	// spacing and level of the node.
+	uint32_t magicLen = 0;
+	{
+		std::ifstream f(fileName, std::ios::binary);
+		f.read(reinterpret_cast<char*>(&magicLen), sizeof(magicLen));
+	}
+	const std::streamoff countPos = 4 + magicLen + 1 + 4 + 8 + 7 * 4 + 4;
+	const std::streamoff offsetPos = countPos + 4;
+
+	auto patch = [&](std::streamoff pos, auto value) {
+		std::fstream f(
+			fileName, std::ios::binary | std::ios::in | std::ios::out);
+		f.seekp(pos);
+		f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	};
+
+	// An offset whose size in bytes wraps around 64 bits:
+	patch(
+		offsetPos,
+		static_cast<uint64_t>(
+			std::numeric_limits<uint64_t>::max() / sizeof(point_t) + 1));
+	EXPECT_ANY_THROW(lod.open(fileName));
+
+	// Too many points:
+	patch(offsetPos, uint64_t(0));
+	patch(countPos, std::numeric_limits<uint32_t>::max());
+	EXPECT_ANY_THROW(lod.open(fileName));
+}
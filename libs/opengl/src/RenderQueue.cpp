@@ -9,6 +9,7 @@
 
 #include "opengl-precomp.h"	 // Precompiled header
 //
+#include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/opengl/CSetOfObjects.h>
 #include <mrpt/opengl/CText.h>
 #include <mrpt/opengl/RenderQueue.h>
@@ -16,7 +17,9 @@
 #include <mrpt/system/os.h>
 
 #include <Eigen/Dense>
+#include <algorithm>
 #include <map>
+#include <optional>
 
 using namespace std;
 using namespace mrpt;
@@ -25,95 +28,288 @@ using namespace mrpt::poses;
 using namespace mrpt::system;
 using namespace mrpt::opengl;
 
-// Render a set of objects
-void mrpt::opengl::enqueForRendering(
-	const mrpt::opengl::CListOpenGLObjects& objs,
-	const mrpt::opengl::TRenderMatrices& state, RenderQueue& rq)
+const CRenderizable* RenderInstancingCache::prototype(
+	const std::string& key, const CRenderizable& obj, bool& created)
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	auto& e = m_prototypes[key];
+	created = !e.prototype;
+	if (created) e.prototype = obj.makeInstancingPrototype();
+	e.used = true;
+	return e.prototype.get();
+}
+
+void RenderInstancingCache::beginFrame()
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	for (auto it = m_prototypes.begin(); it != m_prototypes.end();)
+	{
+		if (!it->second.used) it = m_prototypes.erase(it);
+		else
+		{
+			it->second.used = false;
+			++it;
+		}
+	}
+}
+
+void RenderInstancingCache::clear()
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	m_prototypes.clear();
+}
+
+size_t RenderInstancingCache::size() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_prototypes.size();
+}
+
+void RenderQueue::append(RenderQueue&& o)
+{
+	const auto stateOffset = static_cast<uint32_t>(m_states.size());
+	const auto seqOffset = static_cast<uint32_t>(m_elements.size());
+
+	m_states.insert(
+		m_states.end(), std::make_move_iterator(o.m_states.begin()),
+		std::make_move_iterator(o.m_states.end()));
+
+	m_elements.reserve(m_elements.size() + o.m_elements.size());
+	for (auto e : o.m_elements)
+	{
+		e.stateIndex += stateOffset;
+		e.sequence += seqOffset;
+		m_elements.push_back(e);
+	}
+	if (!o.m_elements.empty()) m_sorted = false;
+
+	pendingBufferUpdates.insert(
+		pendingBufferUpdates.end(), o.pendingBufferUpdates.begin(),
+		o.pendingBufferUpdates.end());
+	culledObjects += o.culledObjects;
+
+	o.clear();
+}
+
+const std::vector<RenderQueueElement>& RenderQueue::sorted() const
+{
+	if (!m_sorted)
+	{
+		std::sort(
+			m_elements.begin(), m_elements.end(),
+			[](const RenderQueueElement& a, const RenderQueueElement& b) {
+				if (a.shader != b.shader) return a.shader < b.shader;
+				if (a.depth != b.depth) return a.depth > b.depth;
+				return a.sequence > b.sequence;
+			});
+		m_sorted = true;
+	}
+	return m_elements;
+}
+
+void RenderQueue::clear()
+{
+	m_elements.clear();
+	m_states.clear();
+	m_sorted = true;
+	pendingBufferUpdates.clear();
+	culledObjects = 0;
+}
+
+namespace
+{
+// Lists with at least this number of objects are split into chunks of this
+// size, processed in parallel if RenderQueue::parallel is set:
+constexpr size_t PARALLEL_CHUNK_SIZE = 256;
+
+// Returns true if the box, in the coordinates that `pmv` projects, lies
+// entirely out of the view frustum. That is, if all its corners are out of
+// the same clipping plane, which is conservative: some boxes out of the
+// frustum may not be detected, but visible boxes are never discarded.
+bool isOutOfFrustum(const TBoundingBox& bb, const Eigen::Matrix4f& pmv)
+{
+	// Boxes with undefined size (e.g. CCamera) are never culled, neither
+	// are those reduced to a point: objects sized in pixels (CText) or
+	// still empty (e.g. a CAssimpModel loading in the background):
+	if (!bb.isValid() || bb.min == bb.max) return false;
+
+	// Bits for the planes of clip coordinates: x<-w, x>w, y<-w, y>w, z<-w,
+	// z>w.
+	unsigned int outAll = 0x3f;
+	for (unsigned int i = 0; i < 8 && outAll != 0; i++)
+	{
+		const auto c = bb.corner(i);
+		const Eigen::Vector4f p =
+			pmv * Eigen::Vector4f(d2f(c.x), d2f(c.y), d2f(c.z), 1.0f);
+		unsigned int out = 0;
+		if (p[0] < -p[3]) out |= 0x01;
+		if (p[0] > p[3]) out |= 0x02;
+		if (p[1] < -p[3]) out |= 0x04;
+		if (p[1] > p[3]) out |= 0x08;
+		if (p[2] < -p[3]) out |= 0x10;
+		if (p[2] > p[3]) out |= 0x20;
+		outAll &= out;
+	}
+	return outAll != 0;
+}
+
+// Either updates the buffers now, or leave it to the thread with the
+// OpenGL context:
+void updateBuffersOrDefer(const CRenderizable* obj, RenderQueue& rq)
+{
+	if (rq.deferBufferUpdates) rq.pendingBufferUpdates.push_back(obj);
+	else
+		obj->updateBuffers();
+}
+
+void enqueObject(
+	const CRenderizable* obj, const mrpt::opengl::TRenderMatrices& state,
+	const Eigen::Matrix4f& parentPMV, RenderQueue& rq)
 {
-#if MRPT_HAS_OPENGL_GLUT
 	using mrpt::math::CMatrixDouble44;
 
+	// Can we use a prototype shared with identical objects? (The key buffer
+	// is reused, to avoid one memory allocation per object)
+	thread_local std::string instKey;
+	instKey.clear();
+	CMatrixFloat44 instTransform;
+	const bool isInstance = rq.instancing && obj->isVisible() &&
+		obj->instancingKey(instKey, instTransform);
+
+	// Regenerate opengl vertex buffers?
+	if (!isInstance && obj->hasToUpdateBuffers())
+		updateBuffersOrDefer(obj, rq);
+
+	if (!obj->isVisible()) return;
+
+	// Frustum culling. Containers are never culled as a whole, since they
+	// are cheap to process and their children are tested one by one:
+	if (rq.frustumCulling && !IS_DERIVED(*obj, CSetOfObjects) &&
+		obj->getScaleX() == 1 && obj->getScaleY() == 1 &&
+		obj->getScaleZ() == 1 && (isInstance || !obj->hasToUpdateBuffers()))
+	{
+		bool out = false;
+		try
+		{
+			out = isOutOfFrustum(obj->cachedBoundingBox(), parentPMV);
+		}
+		catch (const std::exception&)
+		{
+			// Invalid bounding box: render the object anyway
+		}
+		if (out)
+		{
+			rq.culledObjects++;
+			return;
+		}
+	}
+
+	const CPose3D& thisPose = obj->getPoseRef();
+	CMatrixFloat44 HM =
+		thisPose.getHomogeneousMatrixVal<CMatrixDouble44>().cast_float();
+
+	// Scaling:
+	if (obj->getScaleX() != 1 || obj->getScaleY() != 1 ||
+		obj->getScaleZ() != 1)
+	{
+		auto scale = CMatrixFloat44::Identity();
+		scale(0, 0) = obj->getScaleX();
+		scale(1, 1) = obj->getScaleY();
+		scale(2, 2) = obj->getScaleZ();
+		HM.asEigen() = HM.asEigen() * scale.asEigen();
+	}
+
+	// Make a copy of rendering state, so we always have the original
+	// version of my parent intact.
+	auto _ = state;
+
+	// Compose relative to my parent pose:
+	_.mv_matrix.asEigen() = _.mv_matrix.asEigen() * HM.asEigen();
+
+	// Precompute pmv_matrix to be used in shaders:
+	_.pmv_matrix.asEigen() = _.p_matrix.asEigen() * _.mv_matrix.asEigen();
+
+	// Get a representative depth for this object (to sort objects from
+	// eye-distance):
+	mrpt::math::TPoint3Df lrp = obj->getLocalRepresentativePoint();
+
+	Eigen::Vector4f lrp_hm(lrp.x, lrp.y, lrp.z, 1.0f);
+	const auto lrp_proj = (_.pmv_matrix.asEigen() * lrp_hm).eval();
+	const float depth = (lrp_proj(3) != 0) ? lrp_proj(2) / lrp_proj(3) : .001f;
+
+	// Rendering state of the object itself (not needed for instances, but
+	// for their labels):
+	uint32_t stateIdx = 0;
+
+	if (isInstance)
+	{
+		// Render the prototype, as seen from this object:
+		bool created = false;
+		const CRenderizable* proto =
+			rq.instancing->prototype(instKey, *obj, created);
+		if (created) updateBuffersOrDefer(proto, rq);
+
+		auto instState = _;
+		instState.mv_matrix.asEigen() =
+			instState.mv_matrix.asEigen() * instTransform.asEigen();
+		instState.pmv_matrix.asEigen() =
+			instState.p_matrix.asEigen() * instState.mv_matrix.asEigen();
+		const uint32_t instStateIdx = rq.addState(instState);
+
+		for (const auto shader_id : proto->requiredShaders())
+			rq.add(proto, instStateIdx, shader_id, depth);
+
+		proto->enqueForRenderRecursive(instState, rq);
+	}
+	else
+	{
+		stateIdx = rq.addState(_);
+
+		// Enqeue this object...
+		for (const auto shader_id : obj->requiredShaders())
+			rq.add(obj, stateIdx, shader_id, depth);
+
+		// ...and its children:
+		obj->enqueForRenderRecursive(_, rq);
+	}
+
+	if (obj->isShowNameEnabled())
+	{
+		if (isInstance) stateIdx = rq.addState(_);
+
+		CText& label = obj->labelObject();
+
+		// Update the label, only if it changed:
+		if (label.getString() != obj->getName())
+			label.setString(obj->getName());
+
+		// Regenerate opengl vertex buffers, if first time or label
+		// changed:
+		if (label.hasToUpdateBuffers()) updateBuffersOrDefer(&label, rq);
+
+		rq.add(&label, stateIdx, DefaultShaderID::TEXT, depth);
+	}
+}
+
+void enqueRange(
+	const mrpt::opengl::CListOpenGLObjects& objs, size_t first, size_t last,
+	const mrpt::opengl::TRenderMatrices& state,
+	const Eigen::Matrix4f& parentPMV, RenderQueue& rq)
+{
 	const char* curClassName = nullptr;
 	try
 	{
-		for (const auto& objPtr : objs)
+		for (size_t i = first; i < last; i++)
 		{
-			if (!objPtr) continue;
+			if (!objs[i]) continue;
 			// Use plain pointers, faster than smart pointers:
-			const CRenderizable* obj = objPtr.get();
+			const CRenderizable* obj = objs[i].get();
 			// Save class name: just in case we have an exception, for error
 			// reporting:
 			curClassName = obj->GetRuntimeClass()->className;
 
-			// Regenerate opengl vertex buffers?
-			if (obj->hasToUpdateBuffers()) obj->updateBuffers();
-
-			if (!obj->isVisible()) continue;
-
-			const CPose3D& thisPose = obj->getPoseRef();
-			CMatrixFloat44 HM =
-				thisPose.getHomogeneousMatrixVal<CMatrixDouble44>()
-					.cast_float();
-
-			// Scaling:
-			if (obj->getScaleX() != 1 || obj->getScaleY() != 1 ||
-				obj->getScaleZ() != 1)
-			{
-				auto scale = CMatrixFloat44::Identity();
-				scale(0, 0) = obj->getScaleX();
-				scale(1, 1) = obj->getScaleY();
-				scale(2, 2) = obj->getScaleZ();
-				HM.asEigen() = HM.asEigen() * scale.asEigen();
-			}
-
-			// Make a copy of rendering state, so we always have the original
-			// version of my parent intact.
-			auto _ = state;
-
-			// Compose relative to my parent pose:
-			_.mv_matrix.asEigen() = _.mv_matrix.asEigen() * HM.asEigen();
-
-			// Precompute pmv_matrix to be used in shaders:
-			_.pmv_matrix.asEigen() =
-				_.p_matrix.asEigen() * _.mv_matrix.asEigen();
-
-			// Get a representative depth for this object (to sort objects from
-			// eye-distance):
-			mrpt::math::TPoint3Df lrp = obj->getLocalRepresentativePoint();
-
-			Eigen::Vector4f lrp_hm(lrp.x, lrp.y, lrp.z, 1.0f);
-			const auto lrp_proj = (_.pmv_matrix.asEigen() * lrp_hm).eval();
-			const float depth =
-				(lrp_proj(3) != 0) ? lrp_proj(2) / lrp_proj(3) : .001f;
-
-			// Enqeue this object...
-			const auto lst_shaders = obj->requiredShaders();
-			for (const auto shader_id : lst_shaders)
-			{
-				// eye-to-object depth:
-				rq[shader_id].emplace(depth, RenderQueueElement(obj, _));
-			}
-
-			// ...and its children:
-			obj->enqueForRenderRecursive(_, rq);
-
-			if (obj->isShowNameEnabled())
-			{
-				CText& label = obj->labelObject();
-
-				// Update the label, only if it changed:
-				if (label.getString() != obj->getName())
-					label.setString(obj->getName());
-
-				// Regenerate opengl vertex buffers, if first time or label
-				// changed:
-				if (label.hasToUpdateBuffers()) label.updateBuffers();
-
-				rq[DefaultShaderID::TEXT].emplace(
-					depth, RenderQueueElement(&label, _));
-			}
-
-		}  // end foreach object
+			enqueObject(obj, state, parentPMV, rq);
+		}
 	}
 	catch (const exception& e)
 	{
@@ -121,7 +317,59 @@ void mrpt::opengl::enqueForRendering(
 			"Exception while rendering class '%s':\n%s",
 			curClassName ? curClassName : "(undefined)", e.what());
 	}
-#endif
+}
+
+}  // namespace
+
+// Render a set of objects
+void mrpt::opengl::enqueForRendering(
+	const mrpt::opengl::CListOpenGLObjects& objs,
+	const mrpt::opengl::TRenderMatrices& state, RenderQueue& rq)
+{
+	// Bounding boxes are given in the frame of the parent:
+	const Eigen::Matrix4f parentPMV =
+		state.p_matrix.asEigen() * state.mv_matrix.asEigen();
+
+	if (!rq.parallel || objs.size() < 2 * PARALLEL_CHUNK_SIZE)
+	{
+		enqueRange(objs, 0, objs.size(), state, parentPMV, rq);
+		return;
+	}
+
+	// Parallel version: each chunk is enqueued into its own queue, and they
+	// are joined in order, so the result is the same as in the serial case.
+	// Worker threads lack the OpenGL context, hence buffer updates are
+	// deferred:
+	RenderQueue chunkOptions;
+	chunkOptions.frustumCulling = rq.frustumCulling;
+	chunkOptions.instancing = rq.instancing;
+	chunkOptions.deferBufferUpdates = true;
+
+	RenderQueue partial = mrpt::WorkerThreadsPool::Default().parallel_reduce(
+		0, objs.size(), chunkOptions,
+		[&](size_t first, size_t last, RenderQueue q) {
+			enqueRange(objs, first, last, state, parentPMV, q);
+			return q;
+		},
+		[](RenderQueue a, RenderQueue b) {
+			a.append(std::move(b));
+			return a;
+		},
+		PARALLEL_CHUNK_SIZE);
+
+	if (!partial.pendingBufferUpdates.empty() && !rq.deferBufferUpdates)
+	{
+		// Some buffers must be regenerated first, and that may change the
+		// children of some objects (e.g. CAxis labels), so enqueue again,
+		// serially, once they are up to date:
+		for (const auto o : partial.pendingBufferUpdates)
+			if (o->hasToUpdateBuffers()) o->updateBuffers();
+
+		enqueRange(objs, 0, objs.size(), state, parentPMV, rq);
+		return;
+	}
+
+	rq.append(std::move(partial));
 }
 
 void mrpt::opengl::processRenderQueue(
@@ -131,49 +379,50 @@ void mrpt::opengl::processRenderQueue(
 {
 #if MRPT_HAS_OPENGL_GLUT
 
-	for (const auto& rqSet : rq)
+	mrpt::opengl::Program* shader = nullptr;
+	std::optional<shader_id_t> curShaderId;
+
+	// Sorted by shader, then in reverse depth order:
+	for (const RenderQueueElement& rqe : rq.sorted())
 	{
-		// bind the shader for this sequence of objects:
-		mrpt::opengl::Program& shader = *shaders.at(rqSet.first);
+		if (curShaderId != rqe.shader)
+		{
+			// bind the shader for this sequence of objects:
+			curShaderId = rqe.shader;
+			shader = shaders.at(rqe.shader).get();
 
-		glUseProgram(shader.programId());
-		CHECK_OPENGL_ERROR();
+			glUseProgram(shader->programId());
+			CHECK_OPENGL_ERROR();
+		}
 
-		// Process all objects using this shader:
-		const auto& rqMap = rqSet.second;
+		const TRenderMatrices& renderState = rq.state(rqe.stateIndex);
 
-		// Render in reverse depth order:
-		for (auto it = rqMap.rbegin(); it != rqMap.rend(); ++it)
-		{
-			const RenderQueueElement& rqe = it->second;
+		// Load matrices in shader:
+		const auto IS_TRANSPOSED = GL_TRUE;
+		glUniformMatrix4fv(
+			shader->uniformId("p_matrix"), 1, IS_TRANSPOSED,
+			renderState.p_matrix.data());
 
-			// Load matrices in shader:
-			const auto IS_TRANSPOSED = GL_TRUE;
-			glUniformMatrix4fv(
-				shader.uniformId("p_matrix"), 1, IS_TRANSPOSED,
-				rqe.renderState.p_matrix.data());
+		glUniformMatrix4fv(
+			shader->uniformId("mv_matrix"), 1, IS_TRANSPOSED,
+			renderState.mv_matrix.data());
 
+		if (shader->hasUniform("pmv_matrix"))
 			glUniformMatrix4fv(
-				shader.uniformId("mv_matrix"), 1, IS_TRANSPOSED,
-				rqe.renderState.mv_matrix.data());
-
-			if (shader.hasUniform("pmv_matrix"))
-				glUniformMatrix4fv(
-					shader.uniformId("pmv_matrix"), 1, IS_TRANSPOSED,
-					rqe.renderState.pmv_matrix.data());
-
-			CRenderizable::RenderContext rc;
-			rc.shader = &shader;
-			rc.shader_id = rqSet.first;
-			rc.state = &rqe.renderState;
-			rc.lights = &lights;
-
-			// Render object:
-			ASSERT_(rqe.object != nullptr);
-			{
-				rqe.object->render(rc);
-				CHECK_OPENGL_ERROR();
-			}
+				shader->uniformId("pmv_matrix"), 1, IS_TRANSPOSED,
+				renderState.pmv_matrix.data());
+
+		CRenderizable::RenderContext rc;
+		rc.shader = shader;
+		rc.shader_id = rqe.shader;
+		rc.state = &renderState;
+		rc.lights = &lights;
+
+		// Render object:
+		ASSERT_(rqe.object != nullptr);
+		{
+			rqe.object->render(rc);
+			CHECK_OPENGL_ERROR();
 		}
 	}
 
@@ -0,0 +1,276 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/math/CMatrixFixed.h>
+#include <mrpt/opengl/CArrow.h>
+#include <mrpt/opengl/CAxis.h>
+#include <mrpt/opengl/CEllipsoid3D.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <mrpt/opengl/RenderQueue.h>
+
+#include <Eigen/Dense>
+
+using namespace mrpt::opengl;
+
+// Camera at the origin, looking along +X:
+static TRenderMatrices camera()
+{
+	TRenderMatrices rm;
+	rm.viewport_width = 640;
+	rm.viewport_height = 480;
+	rm.FOV = 60;
+	rm.is_projective = true;
+	rm.eye = {0, 0, 0};
+	rm.pointing = {1, 0, 0};
+	rm.up = {0, 0, 1};
+	rm.computeProjectionMatrix(0.1f, 1000.0f);
+	rm.applyLookAt();
+	rm.mv_matrix.setIdentity();
+	rm.pmv_matrix.asEigen() = rm.p_matrix.asEigen() * rm.mv_matrix.asEigen();
+	return rm;
+}
+
+static CEllipsoid3D::Ptr ellipsoid(double x, double y, double z, double s)
+{
+	auto e = CEllipsoid3D::Create();
+	mrpt::math::CMatrixDouble33 cov;
+	cov.setDiagonal(std::vector<double>{s * s, 4 * s * s, 0.25 * s * s});
+	e->setCovMatrix(cov);
+	e->setLocation(x, y, z);
+	return e;
+}
+
+// OpenGL buffers cannot be updated in unit tests:
+static RenderQueue headlessQueue()
+{
+	RenderQueue rq;
+	rq.deferBufferUpdates = true;
+	return rq;
+}
+
+TEST(RenderQueue, sortedByShaderAndDepth)
+{
+	RenderQueue rq;
+	const auto s = rq.addState(camera());
+	CAxis a, b, c;
+	rq.add(&a, s, DefaultShaderID::TRIANGLES, 0.5f);
+	rq.add(&b, s, DefaultShaderID::WIREFRAME, 0.2f);
+	rq.add(&c, s, DefaultShaderID::WIREFRAME, 0.9f);
+	rq.add(&a, s, DefaultShaderID::WIREFRAME, 0.2f);
+
+	const auto& e = rq.sorted();
+	ASSERT_EQ(e.size(), 4U);
+	// Shaders in ascending order, each one from back to front, and objects
+	// at the same depth in reverse order of insertion:
+	EXPECT_EQ(e[0].object, &c);
+	EXPECT_EQ(e[1].object, &a);
+	EXPECT_EQ(e[2].object, &b);
+	EXPECT_EQ(e[3].object, &a);
+	EXPECT_EQ(e[3].shader, DefaultShaderID::TRIANGLES);
+
+	// Joining queues is like adding the elements of the second one later:
+	RenderQueue rq2;
+	auto st = camera();
+	st.mv_matrix(0, 3) = 5;
+	const auto s2 = rq2.addState(st);
+	rq2.add(&b, s2, DefaultShaderID::WIREFRAME, 0.2f);
+	rq.append(std::move(rq2));
+	EXPECT_TRUE(rq2.empty());
+
+	const auto& e2 = rq.sorted();
+	ASSERT_EQ(e2.size(), 5U);
+	EXPECT_EQ(e2[1].object, &b);
+	EXPECT_EQ(rq.state(e2[1].stateIndex).mv_matrix(0, 3), 5);
+	EXPECT_EQ(e2[2].object, &a);
+}
+
+TEST(RenderQueue, frustumCulling)
+{
+	CListOpenGLObjects objs;
+	// In front of the camera:
+	objs.push_back(ellipsoid(10, 0, 0, 1));
+	objs.push_back(ellipsoid(50, 5, -2, 0.5));
+	// Partly within the view:
+	objs.push_back(ellipsoid(10, 7, 0, 1));
+	// Out of the view:
+	objs.push_back(ellipsoid(-10, 0, 0, 1));
+	objs.push_back(ellipsoid(10, 30, 0, 1));
+	auto axis = CAxis::Create(-1, -1, -1, 1, 1, 1, 1, 1, false);
+	axis->setLocation(0, 0, 20);
+	objs.push_back(axis);
+
+	RenderInstancingCache cache;
+	for (const bool culling : {false, true})
+	{
+		RenderQueue rq = headlessQueue();
+		rq.frustumCulling = culling;
+		rq.instancing = &cache;
+		enqueForRendering(objs, camera(), rq);
+
+		EXPECT_EQ(rq.culledObjects, culling ? 3U : 0U);
+		// Two shaders per ellipsoid, one for the axis:
+		EXPECT_EQ(rq.size(), culling ? 6U : 11U);
+	}
+
+	// Without instancing, objects whose buffers are not up to date are never
+	// culled, since their bounding boxes may depend on those buffers:
+	RenderQueue rq = headlessQueue();
+	rq.frustumCulling = true;
+	enqueForRendering(objs, camera(), rq);
+	EXPECT_EQ(rq.culledObjects, 0U);
+	EXPECT_EQ(rq.pendingBufferUpdates.size(), objs.size());
+}
+
+TEST(RenderQueue, instancing)
+{
+	CListOpenGLObjects objs;
+	for (int i = 0; i < 20; i++)
+		objs.push_back(ellipsoid(10 + i, i, 0, 0.1 * (i + 1)));
+	// Different appearance, different prototype:
+	auto red = ellipsoid(10, 0, 5, 1);
+	red->setColor_u8(0xff, 0, 0);
+	objs.push_back(red);
+	// Solid ellipsoids are not instanced, since their normals would change:
+	auto solid = ellipsoid(10, 0, -5, 1);
+	solid->enableDrawSolid3D(true);
+	objs.push_back(solid);
+
+	RenderInstancingCache cache;
+	RenderQueue rq = headlessQueue();
+	rq.instancing = &cache;
+	enqueForRendering(objs, camera(), rq);
+
+	EXPECT_EQ(cache.size(), 2U);
+	// Only the two prototypes and the solid ellipsoid need buffers:
+	EXPECT_EQ(rq.pendingBufferUpdates.size(), 3U);
+
+	// Each prototype is a unit sphere, seen through the transformation of
+	// an instance: the tip of the first principal axis is at q*sigma_x.
+	size_t nInstances = 0;
+	for (const auto& e : rq.sorted())
+	{
+		if (e.object == solid.get() || e.shader != DefaultShaderID::WIREFRAME)
+			continue;
+		nInstances++;
+		const auto& mv = rq.state(e.stateIndex).mv_matrix.asEigen();
+		const Eigen::Vector4f tip = mv * Eigen::Vector4f(1, 0, 0, 1);
+		const Eigen::Vector4f center = mv * Eigen::Vector4f(0, 0, 0, 1);
+		const float sx = (tip - center).norm();
+		// One of the objects has this center and size:
+		bool found = false;
+		for (const auto& o : objs)
+		{
+			const auto ell = std::dynamic_pointer_cast<CEllipsoid3D>(o);
+			if (std::abs(center[0] - o->getPoseX()) > 1e-4 ||
+				std::abs(center[1] - o->getPoseY()) > 1e-4 ||
+				std::abs(center[2] - o->getPoseZ()) > 1e-4)
+				continue;
+			const double sigma = std::sqrt(ell->getCovMatrix()(0, 0));
+			found = std::abs(sx - ell->getQuantiles() * sigma) < 1e-4;
+		}
+		EXPECT_TRUE(found) << "center=" << center.transpose();
+	}
+	EXPECT_EQ(nInstances, objs.size() - 1);
+
+	// Unused prototypes are freed:
+	cache.beginFrame();
+	EXPECT_EQ(cache.size(), 2U);
+	objs.pop_front();
+	red->setColor_u8(0, 0, 0xff);
+	rq.clear();
+	enqueForRendering(objs, camera(), rq);
+	EXPECT_EQ(cache.size(), 3U);
+	cache.beginFrame();
+	EXPECT_EQ(cache.size(), 2U);
+}
+
+TEST(RenderQueue, parallelSameAsSerial)
+{
+	// Many objects, within a set of objects too:
+	CListOpenGLObjects objs;
+	auto set = CSetOfObjects::Create();
+	for (int i = 0; i < 3000; i++)
+	{
+		CRenderizable::Ptr o;
+		if (i % 3 == 0) o = CAxis::Create(-1, -1, -1, 1, 1, 1, 1, 1, false);
+		else
+			o = ellipsoid(0, 0, 0, 0.01 * (1 + i % 7));
+		o->setLocation(-50 + (i % 100), -50 + (i / 30) % 100, i % 5);
+		if (i < 1500) objs.push_back(o);
+		else
+			set->insert(o);
+	}
+	objs.push_back(set);
+
+	RenderInstancingCache cache;
+	auto render = [&](bool parallel) {
+		RenderQueue rq = headlessQueue();
+		rq.frustumCulling = true;
+		rq.parallel = parallel;
+		rq.instancing = &cache;
+		enqueForRendering(objs, camera(), rq);
+		return rq;
+	};
+	const RenderQueue serial = render(false), parallel = render(true);
+
+	EXPECT_GT(serial.culledObjects, 0U);
+	EXPECT_EQ(serial.culledObjects, parallel.culledObjects);
+	const auto &a = serial.sorted(), &b = parallel.sorted();
+	ASSERT_EQ(a.size(), b.size());
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		EXPECT_EQ(a[i].object, b[i].object);
+		EXPECT_EQ(a[i].depth, b[i].depth);
+		EXPECT_EQ(a[i].shader, b[i].shader);
+		EXPECT_TRUE(
+			serial.state(a[i].stateIndex).mv_matrix ==
+			parallel.state(b[i].stateIndex).mv_matrix);
+	}
+}
+
+TEST(CEllipsoid3D, boundingBox)
+{
+	auto e = ellipsoid(1, 2, 3, 1);
+	e->setQuantiles(2);
+	const auto bb = e->getBoundingBox();
+	EXPECT_NEAR(bb.min.x, 1 - 2, 1e-9);
+	EXPECT_NEAR(bb.max.x, 1 + 2, 1e-9);
+	EXPECT_NEAR(bb.min.y, 2 - 4, 1e-9);
+	EXPECT_NEAR(bb.max.y, 2 + 4, 1e-9);
+	EXPECT_NEAR(bb.min.z, 3 - 1, 1e-9);
+	EXPECT_NEAR(bb.max.z, 3 + 1, 1e-9);
+}
+
+TEST(CEllipsoid3D, virtualBaseAlignment)
+{
+	// Only the virtual base CRenderizable holds over-aligned members (the
+	// CPose3D poses). Other base subobjects may lie at addresses not multiple
+	// of alignof(CRenderizable), which is valid as per the C++ ABI even if
+	// -fsanitize=alignment reports them.
+	const auto e = ellipsoid(1, 2, 3, 1);
+	const CRenderizable* r = e.get();
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(r) % alignof(CRenderizable), 0U);
+
+	const auto bb1 = e->cachedBoundingBox();
+	e->setLocation(2, 2, 3);
+	const auto bb2 = e->cachedBoundingBox();
+	EXPECT_NEAR(bb2.min.x - bb1.min.x, 1.0, 1e-6);
+}
+
+TEST(CArrow, boundingBox)
+{
+	// The head is wider than the segment between both ends:
+	const auto a = CArrow::Create(0, 0, 0, 1, 0, 0, 0.2f, 0.05f, 0.3f);
+	const auto bb = a->getBoundingBox();
+	EXPECT_NEAR(bb.min.x, -0.3, 1e-6);
+	EXPECT_NEAR(bb.max.x, 1.3, 1e-6);
+	EXPECT_NEAR(bb.min.y, -0.3, 1e-6);
+	EXPECT_NEAR(bb.max.z, 0.3, 1e-6);
+}
@@ -0,0 +1,1065 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "opengl-precomp.h"	 // Precompiled header
+//
+#include <mrpt/opengl/COpenGLViewport.h>
+#include <mrpt/opengl/CRenderizableShaderPoints.h>
+#include <mrpt/opengl/CRenderizableShaderText.h>
+#include <mrpt/opengl/CRenderizableShaderTexturedTriangles.h>
+#include <mrpt/opengl/CRenderizableShaderTriangles.h>
+#include <mrpt/opengl/CRenderizableShaderWireFrame.h>
+#include <mrpt/opengl/CText.h>
+#include <mrpt/opengl/SoftwareRasterizer.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
+
+using namespace mrpt::opengl;
+using mrpt::opengl::internal::RasterizerChunk;
+using mrpt::opengl::internal::RasterizerTexture;
+
+namespace mrpt::opengl::internal
+{
+/** A texture, as RGBA8 texels, row 0 being v=0 as in OpenGL */
+struct RasterizerTexture
+{
+	const void* sourceData = nullptr;
+	const void* sourceAlpha = nullptr;
+	/** CRenderizable::changeGeneration() of the object */
+	uint64_t generation = 0;
+	int width = 0, height = 0;
+	bool linearInterpolation = false;
+	bool used = false;
+	std::vector<uint8_t> rgba;
+
+	/** Returns the color in [0,1] at (u,v), repeating the texture out of
+	 * [0,1] (GL_REPEAT) */
+	std::array<float, 4> sample(float u, float v) const
+	{
+		if (rgba.empty()) return {1.0f, 1.0f, 1.0f, 1.0f};
+
+		const float x = (u - std::floor(u)) * width,
+					y = (v - std::floor(v)) * height;
+		const auto texel = [this](int c, int r) {
+			c = (c % width + width) % width;
+			r = (r % height + height) % height;
+			return &rgba[4 * (r * width + c)];
+		};
+		std::array<float, 4> ret;
+		if (!linearInterpolation)
+		{
+			const uint8_t* t = texel(static_cast<int>(x), static_cast<int>(y));
+			for (int k = 0; k < 4; k++)
+				ret[k] = t[k] * (1.0f / 255);
+			return ret;
+		}
+		const float fx = x - 0.5f, fy = y - 0.5f;
+		const int c0 = static_cast<int>(std::floor(fx)),
+				  r0 = static_cast<int>(std::floor(fy));
+		const float ax = fx - c0, ay = fy - r0;
+		const uint8_t *t00 = texel(c0, r0), *t01 = texel(c0 + 1, r0),
+					  *t10 = texel(c0, r0 + 1), *t11 = texel(c0 + 1, r0 + 1);
+		for (int k = 0; k < 4; k++)
+			ret[k] = ((1 - ay) * ((1 - ax) * t00[k] + ax * t01[k]) +
+					  ay * ((1 - ax) * t10[k] + ax * t11[k])) *
+				(1.0f / 255);
+		return ret;
+	}
+};
+
+/** A vertex in screen coordinates: pixels, with +Y downwards, and window
+ * depth in [0,1]. For triangles, attributes are divided by the clip "w", for
+ * perspective-correct interpolation. */
+struct ScreenVertex
+{
+	float x, y, z, invW;
+	float r, g, b, a, u, v;
+};
+
+struct RasterTriangle
+{
+	/** The barycentric coordinate of vertex k at pixel (x,y) is
+	 * `e[k][0]*x+e[k][1]*y+e[k][2]` */
+	std::array<std::array<float, 3>, 3> e;
+	/** Pixels exactly on edges are only drawn for top or left edges, so
+	 * pixels shared by adjacent triangles are drawn once */
+	std::array<bool, 3> topLeft;
+	ScreenVertex v[3];
+	const RasterizerTexture* texture;
+	/** Pixels whose centers may be inside (inclusive) */
+	int x0, y0, x1, y1;
+};
+
+struct RasterLine
+{
+	ScreenVertex v[2];
+	float width;
+};
+
+struct RasterPoint
+{
+	float x, y, z, size;
+	float r, g, b, a;
+};
+
+struct RasterizerChunk
+{
+	std::vector<RasterTriangle> triangles;
+	std::vector<RasterLine> lines;
+	std::vector<RasterPoint> points;
+
+	/** For each tile, the primitives overlapping it, in order: the type in
+	 * the two most significant bits, and the index in the rest */
+	std::vector<std::vector<uint32_t>> bins;
+
+	void clear(size_t nTiles)
+	{
+		triangles.clear();
+		lines.clear();
+		points.clear();
+		bins.resize(nTiles);
+		for (auto& b : bins)
+			b.clear();
+	}
+};
+}  // namespace mrpt::opengl::internal
+
+namespace
+{
+using mrpt::opengl::internal::RasterLine;
+using mrpt::opengl::internal::RasterPoint;
+using mrpt::opengl::internal::RasterTriangle;
+using mrpt::opengl::internal::ScreenVertex;
+
+constexpr int TILE_SIZE = 64;
+
+// Minimum number of primitives processed by each parallel task, while
+// transforming and binning them:
+constexpr size_t MIN_PRIMITIVES_PER_CHUNK = 4096;
+
+constexpr uint32_t PRIM_TRIANGLE = 0, PRIM_LINE = 1, PRIM_POINT = 2;
+constexpr uint32_t PRIM_TYPE_SHIFT = 30;
+constexpr uint32_t PRIM_INDEX_MASK = (1U << PRIM_TYPE_SHIFT) - 1;
+
+// A vertex in clip coordinates, with its color and texture coordinates:
+struct ClipVertex
+{
+	float x, y, z, w;
+	float r, g, b, a, u, v;
+};
+
+ClipVertex lerp(const ClipVertex& p, const ClipVertex& q, float t)
+{
+	const auto l = [t](float a, float b) { return a + t * (b - a); };
+	return {l(p.x, q.x), l(p.y, q.y), l(p.z, q.z), l(p.w, q.w),
+			l(p.r, q.r), l(p.g, q.g), l(p.b, q.b), l(p.a, q.a),
+			l(p.u, q.u), l(p.v, q.v)};
+}
+
+// Signed distance (scaled) to the i-th plane of the view volume: positive
+// inside.
+float planeDistance(const ClipVertex& p, int i)
+{
+	switch (i)
+	{
+		case 0: return p.w + p.x;
+		case 1: return p.w - p.x;
+		case 2: return p.w + p.y;
+		case 3: return p.w - p.y;
+		case 4: return p.w + p.z;
+		default: return p.w - p.z;
+	};
+}
+
+unsigned int outCode(const ClipVertex& p)
+{
+	unsigned int c = 0;
+	for (int i = 0; i < 6; i++)
+		if (planeDistance(p, i) < 0) c |= 1U << i;
+	return c;
+}
+
+// Clips a convex polygon against the view volume (Sutherland-Hodgman).
+// `poly` must have room for n+6 vertices. Returns the new number of
+// vertices.
+int clipPolygon(ClipVertex* poly, int n, unsigned int planes)
+{
+	ClipVertex tmp[9];
+	for (int i = 0; i < 6 && n >= 3; i++)
+	{
+		if (!(planes & (1U << i))) continue;
+		int m = 0;
+		for (int k = 0; k < n; k++)
+		{
+			const ClipVertex &p = poly[k], &q = poly[(k + 1) % n];
+			const float dp = planeDistance(p, i), dq = planeDistance(q, i);
+			if (dp >= 0) tmp[m++] = p;
+			if ((dp >= 0) != (dq >= 0)) tmp[m++] = lerp(p, q, dp / (dp - dq));
+		}
+		std::copy(tmp, tmp + m, poly);
+		n = m;
+	}
+	return n;
+}
+
+struct FrameContext
+{
+	int width = 0, height = 0;
+	int tilesX = 0, tilesY = 0;
+
+	ScreenVertex toScreen(const ClipVertex& c, bool perspective) const
+	{
+		const float iw = 1.0f / c.w;
+		const float k = perspective ? iw : 1.0f;
+		return {(c.x * iw * 0.5f + 0.5f) * width,
+				(0.5f - c.y * iw * 0.5f) * height,
+				c.z * iw * 0.5f + 0.5f,
+				iw,
+				c.r * k,
+				c.g * k,
+				c.b * k,
+				c.a * k,
+				c.u * k,
+				c.v * k};
+	}
+
+	// Adds a primitive to all tiles overlapped by the given pixel range,
+	// already clamped to the image:
+	void bin(
+		RasterizerChunk& chunk, uint32_t ref, int x0, int y0, int x1,
+		int y1) const
+	{
+		for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++)
+			for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++)
+				chunk.bins[ty * tilesX + tx].push_back(ref);
+	}
+};
+
+// Elements of the render queue, with their matrices and primitives count:
+struct ElementInfo
+{
+	const RenderQueueElement* e = nullptr;
+	const TRenderMatrices* state = nullptr;
+	Eigen::Matrix4f pmv;
+	const RasterizerTexture* texture = nullptr;
+	size_t count = 0;
+};
+
+void addTriangle(
+	const FrameContext& fc, RasterizerChunk& chunk, const ClipVertex& c0,
+	const ClipVertex& c1, const ClipVertex& c2, TCullFace cull,
+	const RasterizerTexture* texture)
+{
+	RasterTriangle t;
+	t.v[0] = fc.toScreen(c0, true);
+	t.v[1] = fc.toScreen(c1, true);
+	t.v[2] = fc.toScreen(c2, true);
+	t.texture = texture;
+	const ScreenVertex *v = t.v;
+
+	const float area2 = (v[1].x - v[0].x) * (v[2].y - v[0].y) -
+		(v[2].x - v[0].x) * (v[1].y - v[0].y);
+	if (!(std::abs(area2) > 0)) return;
+
+	// Counter-clockwise in OpenGL window coordinates (+Y upwards) is front:
+	const bool front = area2 < 0;
+	if ((cull == TCullFace::BACK && !front) ||
+		(cull == TCullFace::FRONT && front))
+		return;
+
+	const float minX = std::min({v[0].x, v[1].x, v[2].x}),
+				maxX = std::max({v[0].x, v[1].x, v[2].x}),
+				minY = std::min({v[0].y, v[1].y, v[2].y}),
+				maxY = std::max({v[0].y, v[1].y, v[2].y});
+	t.x0 = std::max(0, static_cast<int>(std::ceil(minX - 0.5f)));
+	t.y0 = std::max(0, static_cast<int>(std::ceil(minY - 0.5f)));
+	t.x1 = std::min(fc.width - 1, static_cast<int>(std::floor(maxX - 0.5f)));
+	t.y1 = std::min(fc.height - 1, static_cast<int>(std::floor(maxY - 0.5f)));
+	if (t.x1 < t.x0 || t.y1 < t.y0) return;
+
+	// Edge functions, normalized so they give barycentric coordinates:
+	const float inv = 1.0f / area2;
+	for (int k = 0; k < 3; k++)
+	{
+		const ScreenVertex &a = v[(k + 1) % 3], &b = v[(k + 2) % 3];
+		auto& e = t.e[k];
+		e[0] = -(b.y - a.y) * inv;
+		e[1] = (b.x - a.x) * inv;
+		e[2] = ((b.y - a.y) * a.x - (b.x - a.x) * a.y) * inv;
+		t.topLeft[k] = e[0] > 0 || (e[0] == 0 && e[1] > 0);
+	}
+
+	fc.bin(
+		chunk,
+		(PRIM_TRIANGLE << PRIM_TYPE_SHIFT) |
+			static_cast<uint32_t>(chunk.triangles.size()),
+		t.x0, t.y0, t.x1, t.y1);
+	chunk.triangles.push_back(t);
+}
+
+// Clips, culls and bins one triangle, given in clip coordinates:
+void processTriangle(
+	const FrameContext& fc, RasterizerChunk& chunk, const ClipVertex* in,
+	TCullFace cull, const RasterizerTexture* texture)
+{
+	const unsigned int c0 = outCode(in[0]), c1 = outCode(in[1]),
+					   c2 = outCode(in[2]);
+	if (c0 & c1 & c2) return;  // Out of the view
+
+	if (!(c0 | c1 | c2))
+	{
+		addTriangle(fc, chunk, in[0], in[1], in[2], cull, texture);
+		return;
+	}
+
+	ClipVertex poly[9] = {in[0], in[1], in[2]};
+	const int n = clipPolygon(poly, 3, c0 | c1 | c2);
+	for (int k = 1; k + 1 < n; k++)
+		addTriangle(fc, chunk, poly[0], poly[k], poly[k + 1], cull, texture);
+}
+
+void processLine(
+	const FrameContext& fc, RasterizerChunk& chunk, ClipVertex p, ClipVertex q,
+	float width)
+{
+	const unsigned int cp = outCode(p), cq = outCode(q);
+	if (cp & cq) return;
+
+	if (cp | cq)
+	{
+		// Parametric clipping (Liang-Barsky):
+		float t0 = 0, t1 = 1;
+		for (int i = 0; i < 6; i++)
+		{
+			const float dp = planeDistance(p, i), dq = planeDistance(q, i);
+			if (dp < 0 && dq < 0) return;
+			if (dp < 0) t0 = std::max(t0, dp / (dp - dq));
+			else if (dq < 0)
+				t1 = std::min(t1, dp / (dp - dq));
+		}
+		if (t0 > t1) return;
+		const ClipVertex p0 = p;
+		p = lerp(p0, q, t0);
+		q = lerp(p0, q, t1);
+	}
+
+	RasterLine l;
+	l.v[0] = fc.toScreen(p, false);
+	l.v[1] = fc.toScreen(q, false);
+	l.width = std::max(1.0f, width);
+
+	const float hw = 0.5f * l.width + 1;
+	const int x0 = std::max(
+				  0, static_cast<int>(std::min(l.v[0].x, l.v[1].x) - hw)),
+			  y0 = std::max(
+				  0, static_cast<int>(std::min(l.v[0].y, l.v[1].y) - hw)),
+			  x1 = std::min(
+				  fc.width - 1,
+				  static_cast<int>(std::max(l.v[0].x, l.v[1].x) + hw)),
+			  y1 = std::min(
+				  fc.height - 1,
+				  static_cast<int>(std::max(l.v[0].y, l.v[1].y) + hw));
+	if (x1 < x0 || y1 < y0) return;
+
+	fc.bin(
+		chunk,
+		(PRIM_LINE << PRIM_TYPE_SHIFT) |
+			static_cast<uint32_t>(chunk.lines.size()),
+		x0, y0, x1, y1);
+	chunk.lines.push_back(l);
+}
+
+void processPoint(
+	const FrameContext& fc, RasterizerChunk& chunk, const ClipVertex& c,
+	float size)
+{
+	if (outCode(c)) return;
+
+	const ScreenVertex s = fc.toScreen(c, false);
+	RasterPoint p{s.x, s.y, s.z, std::max(1.0f, std::round(size)),
+				  s.r, s.g, s.b, s.a};
+
+	const int x0 = std::max(0, static_cast<int>(p.x - 0.5f * p.size)),
+			  y0 = std::max(0, static_cast<int>(p.y - 0.5f * p.size)),
+			  x1 = std::min(
+				  fc.width - 1, static_cast<int>(p.x + 0.5f * p.size)),
+			  y1 = std::min(
+				  fc.height - 1, static_cast<int>(p.y + 0.5f * p.size));
+	if (x1 < x0 || y1 < y0) return;
+
+	fc.bin(
+		chunk,
+		(PRIM_POINT << PRIM_TYPE_SHIFT) |
+			static_cast<uint32_t>(chunk.points.size()),
+		x0, y0, x1, y1);
+	chunk.points.push_back(p);
+}
+
+ClipVertex transform(
+	const Eigen::Matrix4f& pmv, const mrpt::math::TPoint3Df& pt,
+	const mrpt::img::TColor& c)
+{
+	const Eigen::Vector4f p = pmv * Eigen::Vector4f(pt.x, pt.y, pt.z, 1.0f);
+	constexpr float k = 1.0f / 255;
+	return {p[0], p[1], p[2], p[3], c.R * k, c.G * k, c.B * k, c.A * k, 0, 0};
+}
+
+// Transforms, clips and bins the primitives [first,last) of an element of
+// the queue. For the TEXT shader, triangles go first, then lines.
+void processElement(
+	const FrameContext& fc, const ElementInfo& info,
+	const TLightParameters& lights, size_t first, size_t last,
+	RasterizerChunk& chunk)
+{
+	const CRenderizable* obj = info.e->object;
+	const auto& pmv = info.pmv;
+
+	const auto processTriangles =
+		[&](const std::vector<TTriangle>& tris, size_t i0, size_t i1,
+			bool light, TCullFace cull, const RasterizerTexture* texture) {
+			const Eigen::Matrix3f R =
+				info.state->mv_matrix.asEigen().block<3, 3>(0, 0);
+			const Eigen::Vector3f lightDir(
+				lights.direction.x, lights.direction.y, lights.direction.z);
+			for (size_t i = i0; i < i1; i++)
+			{
+				ClipVertex c[3];
+				for (int k = 0; k < 3; k++)
+				{
+					const auto& vtx = tris[i].vertices[k];
+					const auto& q = vtx.xyzrgba;
+					c[k] = transform(pmv, q.pt, {q.r, q.g, q.b, q.a});
+					c[k].u = vtx.uv.x;
+					c[k].v = vtx.uv.y;
+					// The color of textured triangles only has the lighting:
+					if (texture) c[k].r = c[k].g = c[k].b = c[k].a = 1;
+					if (!light) continue;
+
+					// As in the shaders, per vertex:
+					Eigen::Vector3f n(vtx.normal.x, vtx.normal.y, vtx.normal.z);
+					if (n.squaredNorm() > 0) n.normalize();
+					const float diff =
+						std::max(-(R * n).normalized().dot(lightDir), 0.0f);
+					c[k].r *= diff * lights.diffuse.R + lights.ambient.R;
+					c[k].g *= diff * lights.diffuse.G + lights.ambient.G;
+					c[k].b *= diff * lights.diffuse.B + lights.ambient.B;
+					c[k].a *= diff * lights.diffuse.A + lights.ambient.A;
+				}
+				processTriangle(fc, chunk, c, cull, texture);
+			}
+		};
+	const auto processLines = [&](const std::vector<mrpt::math::TPoint3Df>& pts,
+								  const std::vector<mrpt::img::TColor>& colors,
+								  size_t i0, size_t i1, float width) {
+		for (size_t i = i0; i < i1; i++)
+			processLine(
+				fc, chunk, transform(pmv, pts[2 * i], colors[2 * i]),
+				transform(pmv, pts[2 * i + 1], colors[2 * i + 1]), width);
+	};
+
+	switch (info.e->shader)
+	{
+		case DefaultShaderID::POINTS:
+		{
+			const auto* o = dynamic_cast<const CRenderizableShaderPoints*>(obj);
+			const auto& pts = o->shaderPointsVertexPointBuffer();
+			const auto& colors = o->shaderPointsVertexColorBuffer();
+			const bool variable = o->isEnabledVariablePointSize();
+			const float K = o->getVariablePointSize_k(),
+						scale = o->getVariablePointSize_DepthScale();
+			for (size_t i = first; i < last; i++)
+			{
+				const ClipVertex c = transform(pmv, pts[i], colors[i]);
+				float size = o->getPointSize();
+				if (variable) size += K / (scale * std::abs(c.z) + 0.01f);
+				processPoint(fc, chunk, c, size);
+			}
+		}
+		break;
+
+		case DefaultShaderID::WIREFRAME:
+		{
+			const auto* o =
+				dynamic_cast<const CRenderizableShaderWireFrame*>(obj);
+			processLines(
+				o->shaderWireframeVertexPointBuffer(),
+				o->shaderWireframeVertexColorBuffer(), first, last,
+				o->getLineWidth());
+		}
+		break;
+
+		case DefaultShaderID::TRIANGLES:
+		{
+			const auto* o =
+				dynamic_cast<const CRenderizableShaderTriangles*>(obj);
+			processTriangles(
+				o->shaderTexturedTrianglesBuffer(), first, last,
+				o->isLightEnabled(), o->cullFaces(), nullptr);
+		}
+		break;
+
+		case DefaultShaderID::TEXTURED_TRIANGLES:
+		{
+			const auto* o =
+				dynamic_cast<const CRenderizableShaderTexturedTriangles*>(obj);
+			processTriangles(
+				o->shaderTexturedTrianglesBuffer(), first, last,
+				o->isLightEnabled(), o->cullFaces(), info.texture);
+		}
+		break;
+
+		case DefaultShaderID::TEXT:
+		{
+			const auto* o = dynamic_cast<const CRenderizableShaderText*>(obj);
+			const auto& tris = o->shaderTextTrianglesBuffer();
+			const size_t nTris = tris.size();
+			processTriangles(
+				tris, std::min(first, nTris), std::min(last, nTris), false,
+				TCullFace::NONE, nullptr);
+			processLines(
+				o->shaderTextLinesVertexPointBuffer(),
+				o->shaderTextLinesVertexColorBuffer(),
+				std::max(first, nTris) - nTris, std::max(last, nTris) - nTris,
+				1.0f);
+		}
+		break;
+	};
+}
+
+// Number of primitives of the element, or 0 if its shader is not supported:
+size_t primitiveCount(const RenderQueueElement& e)
+{
+	const CRenderizable* obj = e.object;
+	switch (e.shader)
+	{
+		case DefaultShaderID::POINTS:
+			if (auto o = dynamic_cast<const CRenderizableShaderPoints*>(obj); o)
+				return std::min(
+					o->shaderPointsVertexPointBuffer().size(),
+					o->shaderPointsVertexColorBuffer().size());
+			break;
+		case DefaultShaderID::WIREFRAME:
+			if (auto o = dynamic_cast<const CRenderizableShaderWireFrame*>(obj);
+				o)
+				return std::min(
+						   o->shaderWireframeVertexPointBuffer().size(),
+						   o->shaderWireframeVertexColorBuffer().size()) /
+					2;
+			break;
+		case DefaultShaderID::TRIANGLES:
+			if (auto o = dynamic_cast<const CRenderizableShaderTriangles*>(obj);
+				o)
+				return o->shaderTexturedTrianglesBuffer().size();
+			break;
+		case DefaultShaderID::TEXTURED_TRIANGLES:
+			if (auto o = dynamic_cast<
+					const CRenderizableShaderTexturedTriangles*>(obj);
+				o)
+				return o->shaderTexturedTrianglesBuffer().size();
+			break;
+		case DefaultShaderID::TEXT:
+			if (auto o = dynamic_cast<const CRenderizableShaderText*>(obj); o)
+				return o->shaderTextTrianglesBuffer().size() +
+					std::min(
+						o->shaderTextLinesVertexPointBuffer().size(),
+						o->shaderTextLinesVertexColorBuffer().size()) /
+					2;
+			break;
+	};
+	return 0;
+}
+
+// The framebuffer region of one tile:
+struct TileTarget
+{
+	uint8_t* color;
+	float* depth;
+	int stride;	 // image width
+	int x0, y0, x1, y1;	 // inclusive
+
+	// Depth test (GL_LEQUAL) and alpha blending:
+	void fragment(int x, int y, float z, float r, float g, float b, float a)
+	{
+		const int idx = y * stride + x;
+		if (!(z <= depth[idx])) return;
+		depth[idx] = z;
+
+		const auto clamp = [](float v) {
+			return v < 0 ? 0.0f : (v > 1 ? 1.0f : v);
+		};
+		r = clamp(r);
+		g = clamp(g);
+		b = clamp(b);
+		a = clamp(a);
+		uint8_t* c = color + 3 * idx;
+		if (a >= 1)
+		{
+			c[0] = static_cast<uint8_t>(r * 255 + 0.5f);
+			c[1] = static_cast<uint8_t>(g * 255 + 0.5f);
+			c[2] = static_cast<uint8_t>(b * 255 + 0.5f);
+			return;
+		}
+		c[0] = static_cast<uint8_t>(r * 255 * a + c[0] * (1 - a) + 0.5f);
+		c[1] = static_cast<uint8_t>(g * 255 * a + c[1] * (1 - a) + 0.5f);
+		c[2] = static_cast<uint8_t>(b * 255 * a + c[2] * (1 - a) + 0.5f);
+	}
+
+	void rasterize(const RasterTriangle& t)
+	{
+		const int xa = std::max(t.x0, x0), xb = std::min(t.x1, x1);
+		const int ya = std::max(t.y0, y0), yb = std::min(t.y1, y1);
+		if (xb < xa || yb < ya) return;
+
+		const ScreenVertex *v = t.v;
+		for (int y = ya; y <= yb; y++)
+		{
+			const float fy = y + 0.5f, fx = xa + 0.5f;
+			float l[3];
+			for (int k = 0; k < 3; k++)
+				l[k] = t.e[k][0] * fx + t.e[k][1] * fy + t.e[k][2];
+
+			for (int x = xa; x <= xb; x++)
+			{
+				bool inside = true;
+				for (int k = 0; k < 3 && inside; k++)
+					inside = l[k] > 0 || (l[k] == 0 && t.topLeft[k]);
+				if (inside)
+				{
+					const float z = l[0] * v[0].z + l[1] * v[1].z +
+						l[2] * v[2].z;
+					if (z <= depth[y * stride + x])
+					{
+						// Perspective-correct attributes:
+						const float w = 1.0f /
+							(l[0] * v[0].invW + l[1] * v[1].invW +
+							 l[2] * v[2].invW);
+						const auto attr = [&](float ScreenVertex::*m) {
+							return (l[0] * (v[0].*m) + l[1] * (v[1].*m) +
+									l[2] * (v[2].*m)) *
+								w;
+						};
+						float r = attr(&ScreenVertex::r),
+							  g = attr(&ScreenVertex::g),
+							  b = attr(&ScreenVertex::b),
+							  a = attr(&ScreenVertex::a);
+						if (t.texture)
+						{
+							const auto tex = t.texture->sample(
+								attr(&ScreenVertex::u), attr(&ScreenVertex::v));
+							r *= tex[0];
+							g *= tex[1];
+							b *= tex[2];
+							a *= tex[3];
+						}
+						fragment(x, y, z, r, g, b, a);
+					}
+				}
+				for (int k = 0; k < 3; k++)
+					l[k] += t.e[k][0];
+			}
+		}
+	}
+
+	void rasterize(const RasterLine& l)
+	{
+		const ScreenVertex &p = l.v[0], &q = l.v[1];
+		const float dx = q.x - p.x, dy = q.y - p.y;
+		const bool xMajor = std::abs(dx) >= std::abs(dy);
+		const float major0 = xMajor ? p.x : p.y, dMajor = xMajor ? dx : dy;
+		const float minor0 = xMajor ? p.y : p.x, dMinor = xMajor ? dy : dx;
+
+		// One run of "width" pixels, across the line, for each pixel along
+		// its major axis:
+		int m0 = static_cast<int>(
+				std::ceil(std::min(major0, major0 + dMajor) - 0.5f)),
+			m1 = static_cast<int>(
+				std::floor(std::max(major0, major0 + dMajor) - 0.5f));
+		if (m1 < m0)
+		{
+			// Shorter than one pixel: draw its center.
+			m0 = m1 = static_cast<int>(std::floor(major0 + 0.5f * dMajor));
+		}
+		m0 = std::max(m0, xMajor ? x0 : y0);
+		m1 = std::min(m1, xMajor ? x1 : y1);
+
+		const int n = static_cast<int>(std::round(l.width));
+		for (int m = m0; m <= m1; m++)
+		{
+			const float t = dMajor != 0
+				? std::clamp((m + 0.5f - major0) / dMajor, 0.0f, 1.0f)
+				: 0.5f;
+			const float minor = minor0 + t * dMinor;
+			const auto lerp = [t](float a, float b) { return a + t * (b - a); };
+			const float z = lerp(p.z, q.z), r = lerp(p.r, q.r),
+						g = lerp(p.g, q.g), b = lerp(p.b, q.b),
+						a = lerp(p.a, q.a);
+
+			const int first =
+				static_cast<int>(std::floor(minor - 0.5f * n + 0.5f));
+			const int lo = std::max(first, xMajor ? y0 : x0),
+					  hi = std::min(first + n - 1, xMajor ? y1 : x1);
+			for (int k = lo; k <= hi; k++)
+			{
+				if (xMajor) fragment(m, k, z, r, g, b, a);
+				else
+					fragment(k, m, z, r, g, b, a);
+			}
+		}
+	}
+
+	void rasterize(const RasterPoint& p)
+	{
+		const int n = static_cast<int>(p.size);
+		const int fx = static_cast<int>(std::floor(p.x - 0.5f * n + 0.5f)),
+				  fy = static_cast<int>(std::floor(p.y - 0.5f * n + 0.5f));
+		const int xa = std::max(fx, x0), xb = std::min(fx + n - 1, x1);
+		const int ya = std::max(fy, y0), yb = std::min(fy + n - 1, y1);
+		for (int y = ya; y <= yb; y++)
+			for (int x = xa; x <= xb; x++)
+				fragment(x, y, p.z, p.r, p.g, p.b, p.a);
+	}
+};
+
+}  // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(
+	unsigned int width, unsigned int height, unsigned int numThreads)
+{
+	setResolution(width, height);
+	setNumThreads(numThreads);
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() = default;
+
+void SoftwareRasterizer::setResolution(unsigned int width, unsigned int height)
+{
+	ASSERT_(width > 0 && height > 0);
+	m_width = width;
+	m_height = height;
+}
+
+void SoftwareRasterizer::setNumThreads(unsigned int numThreads)
+{
+	if (numThreads == 0)
+		numThreads = std::max(1U, std::thread::hardware_concurrency());
+	m_numThreads = numThreads;
+
+	// The calling thread works too:
+	m_pool.clear();
+	m_pool.resize(numThreads - 1);
+}
+
+const RasterizerTexture& SoftwareRasterizer::texture(const CRenderizable* obj)
+{
+	const auto* o =
+		dynamic_cast<const CRenderizableShaderTexturedTriangles*>(obj);
+	ASSERT_(o);
+
+	auto& tex = m_textures[obj];
+	if (!tex) tex = std::make_unique<RasterizerTexture>();
+	auto& t = *tex;
+	t.used = true;
+	t.linearInterpolation = o->isTextureLinearInterpolationEnabled();
+
+	const mrpt::img::CImage& img = o->getTextureImage();
+	const mrpt::img::CImage& alpha = o->getTextureAlphaImage();
+	img.forceLoad();
+	if (img.isEmpty())
+	{
+		t.rgba.clear();
+		return t;
+	}
+	const int w = static_cast<int>(img.getWidth()),
+			  h = static_cast<int>(img.getHeight());
+	const bool hasAlpha = !alpha.isEmpty() && !alpha.isColor() &&
+		alpha.getWidth() == img.getWidth() &&
+		alpha.getHeight() == img.getHeight();
+
+	// Images are copied when assigned to objects, so the same buffers mean
+	// the same images. The generation tells apart a new object (and image)
+	// that reuses the addresses of a deleted one:
+	const void* data = img.ptrLine<uint8_t>(0);
+	const void* alphaData = hasAlpha ? alpha.ptrLine<uint8_t>(0) : nullptr;
+	if (o->changeGeneration() == t.generation && data == t.sourceData &&
+		alphaData == t.sourceAlpha && w == t.width && h == t.height &&
+		!t.rgba.empty())
+		return t;
+
+	t.generation = o->changeGeneration();
+	t.sourceData = data;
+	t.sourceAlpha = alphaData;
+	t.width = w;
+	t.height = h;
+	t.rgba.resize(4 * w * h);
+
+	const int nCh = img.channelCount();
+	const bool bgr = img.getChannelsOrder() != std::string("RGB");
+	for (int y = 0; y < h; y++)
+	{
+		const uint8_t* src = img.ptrLine<uint8_t>(y);
+		const uint8_t* srcAlpha =
+			hasAlpha ? alpha.ptrLine<uint8_t>(y) : nullptr;
+		uint8_t* dst = &t.rgba[4 * y * w];
+		for (int x = 0; x < w; x++, src += nCh, dst += 4)
+		{
+			if (nCh < 3) dst[0] = dst[1] = dst[2] = src[0];
+			else if (bgr || nCh == 4)
+			{
+				dst[0] = src[2];
+				dst[1] = src[1];
+				dst[2] = src[0];
+			}
+			else
+			{
+				dst[0] = src[0];
+				dst[1] = src[1];
+				dst[2] = src[2];
+			}
+			dst[3] = srcAlpha ? srcAlpha[x] : (nCh == 4 ? src[3] : 0xff);
+		}
+	}
+	return t;
+}
+
+void SoftwareRasterizer::render(
+	const COpenGLViewport& viewport,
+	const mrpt::optional_ref<mrpt::img::CImage>& outRGB,
+	const mrpt::optional_ref<mrpt::math::CMatrixFloat>& outDepth)
+{
+	MRPT_START
+
+	ASSERT_(outRGB.has_value() || outDepth.has_value());
+
+	FrameContext fc;
+	fc.width = static_cast<int>(m_width);
+	fc.height = static_cast<int>(m_height);
+	fc.tilesX = (fc.width + TILE_SIZE - 1) / TILE_SIZE;
+	fc.tilesY = (fc.height + TILE_SIZE - 1) / TILE_SIZE;
+	const size_t nTiles = static_cast<size_t>(fc.tilesX) * fc.tilesY;
+
+	// 1) Queue the objects, as for OpenGL rendering. Regenerating vertex data
+	// may change the children of some objects (e.g. CAxis labels), so the
+	// queue is built again until nothing changes:
+	viewport.updateMatricesFromCamera(fc.width, fc.height);
+	const TRenderMatrices camState = viewport.getRenderMatrices();
+
+	RenderQueue rq;
+	rq.deferBufferUpdates = true;
+	rq.frustumCulling = viewport.isFrustumCullingEnabled();
+	rq.parallel = viewport.isParallelRenderQueueEnabled();
+	if (viewport.isInstancingEnabled())
+	{
+		m_instancing.beginFrame();
+		rq.instancing = &m_instancing;
+	}
+	else
+		m_instancing.clear();
+
+	for (int pass = 0;; pass++)
+	{
+		rq.clear();
+		enqueForRendering(viewport.objectsToRender(), camState, rq);
+
+		bool changed = false;
+		for (const CRenderizable* o : rq.pendingBufferUpdates)
+			changed = o->updateCPUBuffers() || changed;
+		if (!changed || pass == 3) break;
+	}
+
+	// 2) Primitive counts and matrices of each element:
+	const auto& elements = rq.sorted();
+	std::vector<ElementInfo> infos;
+	infos.reserve(elements.size());
+	std::vector<size_t> firstPrimitive;	 // Prefix sums of counts
+	size_t total = 0;
+
+	for (auto& t : m_textures)
+		t.second->used = false;
+
+	for (const auto& e : elements)
+	{
+		ElementInfo info;
+		info.e = &e;
+		info.state = &rq.state(e.stateIndex);
+		info.count = primitiveCount(e);
+		if (!info.count) continue;
+
+		info.pmv = info.state->pmv_matrix.asEigen();
+		if (e.shader == DefaultShaderID::TEXT)
+		{
+			// Labels face the viewer, with their own matrix:
+			if (const auto* txt = dynamic_cast<const CText*>(e.object); txt)
+			{
+				mrpt::math::CMatrixFloat44 m;
+				if (!txt->computeTextMatrix(*info.state, m)) continue;
+				info.pmv = m.asEigen();
+			}
+		}
+		if (e.shader == DefaultShaderID::TEXTURED_TRIANGLES)
+			info.texture = &texture(e.object);
+
+		firstPrimitive.push_back(total);
+		total += info.count;
+		infos.push_back(info);
+	}
+
+	// Free the textures of objects no longer rendered:
+	for (auto it = m_textures.begin(); it != m_textures.end();)
+	{
+		if (!it->second->used) it = m_textures.erase(it);
+		else
+			++it;
+	}
+
+	// 3) Transform, clip and bin consecutive ranges of primitives, in
+	// parallel:
+	const size_t chunkSize = std::max(
+		MIN_PRIMITIVES_PER_CHUNK, total / (4 * m_numThreads) + 1);
+	const size_t nChunks =
+		std::max<size_t>(1, (total + chunkSize - 1) / chunkSize);
+	if (m_chunks.size() < nChunks) m_chunks.resize(nChunks);
+
+	const auto& lights = viewport.lightParameters();
+	m_pool.parallel_for(
+		0, nChunks,
+		[&](size_t k) {
+			RasterizerChunk& chunk = m_chunks[k];
+			chunk.clear(nTiles);
+			const size_t first = k * chunkSize,
+						 last = std::min(total, first + chunkSize);
+			size_t i = std::upper_bound(
+						   firstPrimitive.begin(), firstPrimitive.end(),
+						   first) -
+				firstPrimitive.begin() - 1;
+			for (size_t p = first; p < last; i++)
+			{
+				const size_t i0 = p - firstPrimitive[i];
+				const size_t i1 =
+					std::min(infos[i].count, last - firstPrimitive[i]);
+				processElement(fc, infos[i], lights, i0, i1, chunk);
+				p = firstPrimitive[i] + i1;
+			}
+		},
+		1);
+
+	m_stats = Stats();
+	for (size_t k = 0; k < nChunks; k++)
+	{
+		m_stats.triangles += m_chunks[k].triangles.size();
+		m_stats.lines += m_chunks[k].lines.size();
+		m_stats.points += m_chunks[k].points.size();
+	}
+
+	// 4) Rasterize tiles in parallel, and write the output images:
+	const auto bg = viewport.hasCustomBackgroundColor()
+		? viewport.getCustomBackgroundColor()
+		: mrpt::img::TColorf(0, 0, 0, 0);
+	const uint8_t bgColor[3] = {
+		static_cast<uint8_t>(std::clamp(bg.R, 0.0f, 1.0f) * 255 + 0.5f),
+		static_cast<uint8_t>(std::clamp(bg.G, 0.0f, 1.0f) * 255 + 0.5f),
+		static_cast<uint8_t>(std::clamp(bg.B, 0.0f, 1.0f) * 255 + 0.5f)};
+
+	m_color.resize(3 * m_width * m_height);
+	m_depth.resize(m_width * m_height);
+
+	mrpt::img::CImage* rgb = nullptr;
+	bool rgbOrder = false;
+	if (outRGB.has_value())
+	{
+		rgb = &outRGB.value().get();
+		if (rgb->isEmpty() || rgb->getWidth() != m_width ||
+			rgb->getHeight() != m_height || rgb->getChannelCount() != 3)
+			rgb->resize(m_width, m_height, mrpt::img::CH_RGB);
+		rgbOrder = rgb->getChannelsOrder() == std::string("RGB");
+	}
+	mrpt::math::CMatrixFloat* depth = nullptr;
+	if (outDepth.has_value())
+	{
+		depth = &outDepth.value().get();
+		depth->resize(m_height, m_width);
+	}
+
+	// Depth buffer -> linear depth:
+	const float zn = camState.getLastClipZNear(),
+				zf = camState.getLastClipZFar();
+	const bool perspective =
+		camState.is_projective || camState.pinhole_model.has_value();
+	const auto linearDepth = [=](float d) -> float {
+		if (d >= 1) return 0;  // no "echo return"
+		if (!perspective) return zn + d * (zf - zn);
+		d = 2 * d - 1;
+		return 2 * zn * zf / (zf + zn - d * (zf - zn));
+	};
+
+	m_pool.parallel_for(
+		0, nTiles,
+		[&](size_t tile) {
+			TileTarget tt;
+			tt.color = m_color.data();
+			tt.depth = m_depth.data();
+			tt.stride = fc.width;
+			tt.x0 = static_cast<int>(tile % fc.tilesX) * TILE_SIZE;
+			tt.y0 = static_cast<int>(tile / fc.tilesX) * TILE_SIZE;
+			tt.x1 = std::min(tt.x0 + TILE_SIZE, fc.width) - 1;
+			tt.y1 = std::min(tt.y0 + TILE_SIZE, fc.height) - 1;
+
+			for (int y = tt.y0; y <= tt.y1; y++)
+				for (int x = tt.x0; x <= tt.x1; x++)
+				{
+					const int idx = y * tt.stride + x;
+					std::copy(bgColor, bgColor + 3, &tt.color[3 * idx]);
+					tt.depth[idx] = 1.0f;
+				}
+
+			for (size_t k = 0; k < nChunks; k++)
+			{
+				const RasterizerChunk& chunk = m_chunks[k];
+				for (const uint32_t ref : chunk.bins[tile])
+				{
+					const uint32_t idx = ref & PRIM_INDEX_MASK;
+					switch (ref >> PRIM_TYPE_SHIFT)
+					{
+						case PRIM_TRIANGLE:
+							tt.rasterize(chunk.triangles[idx]);
+							break;
+						case PRIM_LINE: tt.rasterize(chunk.lines[idx]); break;
+						default: tt.rasterize(chunk.points[idx]); break;
+					};
+				}
+			}
+
+			for (int y = tt.y0; y <= tt.y1; y++)
+			{
+				if (rgb)
+				{
+					const uint8_t* src = &tt.color[3 * (y * tt.stride + tt.x0)];
+					uint8_t* dst = rgb->ptr<uint8_t>(tt.x0, y);
+					for (int x = tt.x0; x <= tt.x1; x++, src += 3, dst += 3)
+					{
+						dst[0] = src[rgbOrder ? 0 : 2];
+						dst[1] = src[1];
+						dst[2] = src[rgbOrder ? 2 : 0];
+					}
+				}
+				if (depth)
+				{
+					for (int x = tt.x0; x <= tt.x1; x++)
+						(*depth)(y, x) =
+							linearDepth(tt.depth[y * tt.stride + x]);
+				}
+			}
+		},
+		1);
+
+	MRPT_END
+}
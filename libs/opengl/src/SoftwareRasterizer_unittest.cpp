@@ -0,0 +1,212 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/opengl/CBox.h>
+#include <mrpt/opengl/CFBORender.h>
+#include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/opengl/CPointCloud.h>
+#include <mrpt/opengl/CSetOfLines.h>
+#include <mrpt/opengl/CSetOfTriangles.h>
+#include <mrpt/opengl/CTexturedPlane.h>
+#include <mrpt/opengl/SoftwareRasterizer.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <new>
+
+using namespace mrpt::opengl;
+
+#if MRPT_HAS_OPENCV
+static mrpt::img::TColor pixel(const mrpt::img::CImage& img, int x, int y)
+{
+	const bool bgr = img.getChannelsOrder()[0] == 'B';
+	const auto c = [&](int ch) { return img.at<uint8_t>(x, y, ch); };
+	return {c(bgr ? 2 : 0), c(1), c(bgr ? 0 : 2)};
+}
+#endif
+
+// Camera at (10,0,0), looking at the origin:
+static COpenGLScene::Ptr sceneWithCamera()
+{
+	auto scene = COpenGLScene::Create();
+	auto& cam = scene->getViewport()->getCamera();
+	cam.setPointingAt(0, 0, 0);
+	cam.setZoomDistance(10);
+	cam.setAzimuthDegrees(0);
+	cam.setElevationDegrees(0);
+	scene->getViewport()->setCustomBackgroundColor({0, 0, 1.0f});
+	return scene;
+}
+
+TEST(SoftwareRasterizer, colorAndDepth)
+{
+	auto scene = sceneWithCamera();
+	auto box = CBox::Create();
+	box->setBoxCorners({-1, -1, -1}, {1, 1, 1});
+	box->enableBoxBorder(false);
+	box->setColor_u8(0xff, 0, 0);
+	scene->insert(box);
+
+	CFBORender::Parameters p;
+	p.width = 320;
+	p.height = 240;
+	p.software = true;
+	CFBORender render(p);
+	ASSERT_TRUE(render.softwareRasterizer() != nullptr);
+
+	mrpt::math::CMatrixFloat depth;
+	render.render_depth(*scene, depth);
+	ASSERT_EQ(depth.cols(), 320);
+	ASSERT_EQ(depth.rows(), 240);
+
+	// The face x=1 of the box, at 9 units from the camera, and background:
+	EXPECT_NEAR(depth(120, 160), 9.0f, 0.01f);
+	EXPECT_EQ(depth(2, 2), 0.0f);
+
+	const auto& stats = render.softwareRasterizer()->lastRenderStats();
+	EXPECT_GT(stats.triangles, 0U);
+	EXPECT_EQ(stats.lines, 0U);
+
+#if MRPT_HAS_OPENCV
+	mrpt::img::CImage rgb;
+	render.render_RGB(*scene, rgb);
+	ASSERT_EQ(rgb.getWidth(), 320U);
+	ASSERT_EQ(rgb.getHeight(), 240U);
+
+	const auto center = pixel(rgb, 160, 120);
+	EXPECT_GT(center.R, 0);
+	EXPECT_EQ(center.G, 0);
+	EXPECT_EQ(center.B, 0);
+
+	const auto corner = pixel(rgb, 2, 2);
+	EXPECT_EQ(corner.R, 0);
+	EXPECT_EQ(corner.G, 0);
+	EXPECT_EQ(corner.B, 0xff);
+#endif
+}
+
+TEST(SoftwareRasterizer, sameResultsWithAnyNumberOfThreads)
+{
+	auto scene = sceneWithCamera();
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(123);
+
+	auto tris = CSetOfTriangles::Create();
+	for (int i = 0; i < 2000; i++)
+	{
+		mrpt::opengl::TTriangle t;
+		for (int k = 0; k < 3; k++)
+		{
+			t.vertices[k].xyzrgba.pt = {
+				rng.drawUniform<float>(-3, 3), rng.drawUniform<float>(-3, 3),
+				rng.drawUniform<float>(-3, 3)};
+			t.vertices[k].xyzrgba.r = static_cast<uint8_t>(i);
+			t.vertices[k].xyzrgba.a = (i % 3) ? 0xff : 0x80;
+		}
+		t.computeNormals();
+		tris->insertTriangle(t);
+	}
+	scene->insert(tris);
+
+	auto pts = CPointCloud::Create();
+	pts->setPointSize(3);
+	for (int i = 0; i < 5000; i++)
+		pts->insertPoint(
+			rng.drawUniform<float>(-4, 4), rng.drawUniform<float>(-4, 4),
+			rng.drawUniform<float>(-4, 4));
+	scene->insert(pts);
+
+	auto lines = CSetOfLines::Create();
+	lines->setLineWidth(2);
+	for (int i = 0; i < 300; i++)
+		lines->appendLine(
+			rng.drawUniform<float>(-8, 8), rng.drawUniform<float>(-8, 8),
+			rng.drawUniform<float>(-8, 8), rng.drawUniform<float>(-8, 8),
+			rng.drawUniform<float>(-8, 8), rng.drawUniform<float>(-8, 8));
+	scene->insert(lines);
+
+#if MRPT_HAS_OPENCV
+	mrpt::img::CImage tex(64, 64, mrpt::img::CH_RGB);
+	for (int y = 0; y < 64; y++)
+		for (int x = 0; x < 64; x++)
+			tex.setPixel(x, y, ((x / 8 + y / 8) % 2) ? 0xffffff : 0x0000ff);
+	auto plane = CTexturedPlane::Create(-5, 5, -5, 5);
+	plane->assignImage(tex);
+	// Facing the camera, behind the other objects:
+	plane->setPose(
+		mrpt::poses::CPose3D(-2, 0, 0, 0, mrpt::DEG2RAD(90.0), 0));
+	scene->insert(plane);
+#endif
+
+	SoftwareRasterizer sr(640, 480, 1);
+	mrpt::math::CMatrixFloat depth1, depthN;
+	sr.render(*scene->getViewport(), std::nullopt, depth1);
+	const auto stats = sr.lastRenderStats();
+	EXPECT_GT(stats.triangles, 1000U);
+	EXPECT_GT(stats.lines, 0U);
+	EXPECT_GT(stats.points, 0U);
+#if MRPT_HAS_OPENCV
+	mrpt::img::CImage rgb1, rgbN;
+	sr.render(*scene->getViewport(), rgb1, std::nullopt);
+#endif
+
+	for (const unsigned int nThreads : {2U, 5U})
+	{
+		sr.setNumThreads(nThreads);
+		sr.render(*scene->getViewport(), std::nullopt, depthN);
+		EXPECT_EQ(sr.lastRenderStats().triangles, stats.triangles);
+		EXPECT_TRUE(depth1 == depthN) << "nThreads=" << nThreads;
+#if MRPT_HAS_OPENCV
+		sr.render(*scene->getViewport(), rgbN, std::nullopt);
+		size_t differentPixels = 0;
+		for (int y = 0; y < 480; y++)
+			for (int x = 0; x < 640; x++)
+				if (!(pixel(rgb1, x, y) == pixel(rgbN, x, y)))
+					differentPixels++;
+		EXPECT_EQ(differentPixels, 0U) << "nThreads=" << nThreads;
+#endif
+	}
+}
+
+TEST(SoftwareRasterizer, texturesOfObjectsAtReusedAddresses)
+{
+#if MRPT_HAS_OPENCV
+	auto scene = sceneWithCamera();
+	SoftwareRasterizer sr(320, 240, 1);
+
+	// Planes created one after the other at the same address, with images
+	// of the same size:
+	alignas(alignof(CTexturedPlane)) unsigned char
+		storage[sizeof(CTexturedPlane)];
+	for (const unsigned int color : {0xff0000U, 0x00ff00U})
+	{
+		mrpt::img::CImage tex(16, 16, mrpt::img::CH_RGB);
+		for (int y = 0; y < 16; y++)
+			for (int x = 0; x < 16; x++)
+				tex.setPixel(x, y, color);
+
+		auto* plane = new (storage) CTexturedPlane(-5, 5, -5, 5);
+		plane->assignImage(tex);
+		plane->setPose(
+			mrpt::poses::CPose3D(0, 0, 0, 0, mrpt::DEG2RAD(90.0), 0));
+		const auto ptr = CTexturedPlane::Ptr(plane, [](CTexturedPlane*) {});
+		scene->insert(ptr);
+
+		// Same result as a new rasterizer, without cached textures:
+		mrpt::img::CImage rgb, expected;
+		sr.render(*scene->getViewport(), rgb, std::nullopt);
+		SoftwareRasterizer(320, 240, 1)
+			.render(*scene->getViewport(), expected, std::nullopt);
+		EXPECT_EQ(pixel(rgb, 160, 120), pixel(expected, 160, 120));
+
+		scene->removeObject(ptr);
+		plane->~CTexturedPlane();
+	}
+#endif
+}
@@ -43,6 +43,7 @@ MRPT_INITIALIZER(registerAllClasses_mrpt_opengl)
 	registerClass(CLASS_ID(COpenGLViewport));
 	registerClass(CLASS_ID(CPointCloud));
 	registerClass(CLASS_ID(CPointCloudColoured));
+	registerClass(CLASS_ID(CPointCloudLOD));
 	registerClass(CLASS_ID(CPolyhedron));
 	registerClass(CLASS_ID(CRenderizable));
 	registerClass(CLASS_ID(CSetOfLines));
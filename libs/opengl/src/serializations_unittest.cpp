@@ -37,6 +37,7 @@ TEST(SerializeTestOpenGL, WriteReadToMem)
 		CLASS_ID(COpenGLViewport),
 		CLASS_ID(CPointCloud),
 		CLASS_ID(CPointCloudColoured),
+		CLASS_ID(CPointCloudLOD),
 		CLASS_ID(CSetOfLines),
 		CLASS_ID(CSetOfTriangles),
 		CLASS_ID(CSphere),
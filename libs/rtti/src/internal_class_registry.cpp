@@ -11,10 +11,15 @@
 //
 #include <mrpt/rtti/CObject.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdarg>
+#include <deque>
 #include <iostream>
-#include <map>
-#include <shared_mutex>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
 
 #include "internal_class_registry.h"
 
@@ -42,10 +47,15 @@ queue_register_functions_t& mrpt::rtti::pending_class_registers()
 
 namespace mrpt::rtti
 {
-using TClassnameToRuntimeId = std::map<std::string, const TRuntimeClassId*>;
-
 /** A singleton with the central registry for CSerializable run-time classes:
  * users do not use this class in any direct way.
+ *
+ * Registering a class only appends it to a list, so the static initializers
+ * of all MRPT libraries take almost no time at program startup. The lookup
+ * tables are built upon the first query, and rebuilt only if more classes are
+ * registered afterwards. They are flat arrays sorted by the hash of class
+ * names, immutable once built, so queries do not lock any mutex.
+ *
  * \note Class is thread-safe.
  */
 class CClassRegistry
@@ -59,82 +69,187 @@ class CClassRegistry
 		return obj;
 	}
 
-	void Add(const std::string& className, const TRuntimeClassId& id)
+	/** Class names must remain valid until the end of the program, unless
+	 * `copyName` is true */
+	void Add(const char* className, const TRuntimeClassId& id, bool copyName)
 	{
-		std::unique_lock<std::shared_mutex> lk(m_mtx);
-
-		// Sanity check: don't allow registering twice the same class name!
-		const auto it = m_ns_classes.find(className);
-		if (it != m_ns_classes.cend())
-		{
-			if (it->second != &id)
-			{
-				std::cerr << mrpt::format(
-					"[MRPT class registry] Warning: overwriting already "
-					"registered className=`%s` with different "
-					"`TRuntimeClassId`!\n",
-					className.c_str());
-			}
-		}
-		m_ns_classes[className] = &id;
-
-		// Also register without NS (backwards compatible datasets):
-		m_no_ns_classes[stripNamespace(className)] = &id;
+		std::lock_guard<std::mutex> lk(m_mtx);
+		std::string_view name = className;
+		if (copyName) name = m_customNames.emplace_back(className);
+		m_registered.push_back({0, name, &id});
+		m_dirty.store(true, std::memory_order_release);
 	}
 
 	const TRuntimeClassId* Get(
 		const std::string& className, const bool allow_ignore_namespace)
 	{
-		std::shared_lock<std::shared_mutex> lk(m_mtx);
-		const TRuntimeClassId* ret = nullptr;
-		const auto itEntry = m_ns_classes.find(className);
-		if (itEntry != m_ns_classes.end())
-		{
-			// found:
-			ret = itEntry->second;
-		}
-		else if (allow_ignore_namespace)
-		{
+		return withTables([&](const Tables& t) -> const TRuntimeClassId* {
+			if (const auto* id = find(t.byName, className); id) return id;
+
 			// 2nd attempt: search for class name only:
-			const auto itEntry2 =
-				m_no_ns_classes.find(stripNamespace(className));
-			if (itEntry2 != m_no_ns_classes.end())
-			{
-				// found:
-				ret = itEntry2->second;
-			}
-		}
-		return ret;
+			if (allow_ignore_namespace)
+				return find(t.byNameNoNamespace, stripNamespace(className));
+			return nullptr;
+		});
 	}
 
 	std::vector<const TRuntimeClassId*> getListOfAllRegisteredClasses()
 	{
-		std::shared_lock<std::shared_mutex> lk(m_mtx);
-
+		auto entries =
+			withTables([](const Tables& t) { return t.byName; });
+		std::sort(entries.begin(), entries.end(), [](auto& a, auto& b) {
+			return a.name < b.name;
+		});
 		std::vector<const TRuntimeClassId*> ret;
-		for (auto& registeredClasse : m_ns_classes)
-			ret.push_back(registeredClasse.second);
+		ret.reserve(entries.size());
+		for (const auto& e : entries)
+			ret.push_back(e.id);
 		return ret;
 	}
 
    private:
-	static std::string stripNamespace(const std::string& n)
+	struct Entry
 	{
-		std::string ret = n;
-		const auto pos = ret.rfind("::");
-		if (pos != std::string::npos) { return ret.substr(pos + 2); }
-		return ret;
+		size_t hash;
+		std::string_view name;
+		const TRuntimeClassId* id;
+
+		bool operator<(const Entry& o) const
+		{
+			return hash != o.hash ? hash < o.hash : name < o.name;
+		}
+	};
+	struct Tables
+	{
+		std::vector<Entry> byName, byNameNoNamespace;
+	};
+
+	static std::string_view stripNamespace(std::string_view n)
+	{
+		const auto pos = n.rfind("::");
+		if (pos != std::string::npos) { return n.substr(pos + 2); }
+		return n;
+	}
+	static size_t hash(std::string_view n)
+	{
+		return std::hash<std::string_view>()(n);
 	}
 
-	// This must be static since we can be called from C startup
-	// functions and it cannot be assured that classesKeeper will be
-	// initialized before other classes that call it...
-	TClassnameToRuntimeId m_ns_classes;
+	static const TRuntimeClassId* find(
+		const std::vector<Entry>& table, std::string_view name)
+	{
+		const Entry key{hash(name), name, nullptr};
+		const auto it = std::lower_bound(table.begin(), table.end(), key);
+		if (it == table.end() || it->hash != key.hash || it->name != name)
+			return nullptr;
+		return it->id;
+	}
+
+	/** Calls `f(const Tables&)` with the current tables, which are not freed
+	 * meanwhile even if other thread rebuilds them. */
+	template <typename F>
+	auto withTables(F&& f) -> decltype(f(std::declval<const Tables&>()))
+	{
+		if (m_dirty.load(std::memory_order_acquire)) rebuildTables();
+
+		// Must be seq_cst, along with the store of m_tables and the load of
+		// m_readers in rebuildTables():
+		m_readers.fetch_add(1);
+		struct Leave
+		{
+			std::atomic<int>& readers;
+			~Leave() { readers.fetch_sub(1); }
+		} leave{m_readers};
+		return f(*m_tables.load());
+	}
+
+	void rebuildTables()
+	{
+		std::lock_guard<std::mutex> lk(m_mtx);
+		if (!m_dirty.load(std::memory_order_relaxed)) return;
+
+		for (auto& e : m_registered)
+			e.hash = hash(e.name);
+
+		// Remove all but the last registration of each name, keeping the
+		// order of registrations:
+		const size_t N = m_registered.size();
+		std::vector<size_t> idxs(N);
+		for (size_t i = 0; i < N; i++)
+			idxs[i] = i;
+		std::stable_sort(idxs.begin(), idxs.end(), [this](size_t a, size_t b) {
+			return m_registered[a] < m_registered[b];
+		});
+		std::vector<bool> keep(N, false);
+		for (size_t i = 0; i < N; i++)
+		{
+			const Entry& e = m_registered[idxs[i]];
+			if (i + 1 < N && !(e < m_registered[idxs[i + 1]]))
+			{
+				if (e.id != m_registered[idxs[i + 1]].id)
+				{
+					std::cerr << mrpt::format(
+						"[MRPT class registry] Warning: overwriting already "
+						"registered className=`%.*s` with different "
+						"`TRuntimeClassId`!\n",
+						static_cast<int>(e.name.size()), e.name.data());
+				}
+				continue;
+			}
+			keep[idxs[i]] = true;
+		}
+		size_t nKept = 0;
+		for (size_t i = 0; i < N; i++)
+			if (keep[i]) m_registered[nKept++] = m_registered[i];
+		m_registered.resize(nKept);
+
+		auto t = std::make_unique<Tables>();
+		t->byName = m_registered;
+		std::sort(t->byName.begin(), t->byName.end());
+
+		// Also index classes without NS (backwards compatible datasets). If
+		// several classes have the same name, the last one registered wins:
+		std::vector<Entry> noNS;
+		noNS.reserve(m_registered.size());
+		for (const auto& e : m_registered)
+		{
+			const auto n = stripNamespace(e.name);
+			noNS.push_back({hash(n), n, e.id});
+		}
+		std::stable_sort(noNS.begin(), noNS.end());
+		for (size_t i = 0; i < noNS.size(); i++)
+		{
+			if (i + 1 < noNS.size() && noNS[i + 1].hash == noNS[i].hash &&
+				noNS[i + 1].name == noNS[i].name)
+				continue;
+			t->byNameNoNamespace.push_back(noNS[i]);
+		}
+
+		// Former tables are freed once no other thread may be reading them.
+		// Any reader not seen here will load the new pointer:
+		m_tables.store(t.get());
+		m_allTables.push_back(std::move(t));
+		if (m_readers.load() == 0)
+			m_allTables.erase(m_allTables.begin(), m_allTables.end() - 1);
+		m_dirty.store(false, std::memory_order_release);
+	}
+
+	CClassRegistry() { m_tables.store(&m_emptyTables); }
+
+	/** All registered classes, in order of registration */
+	std::vector<Entry> m_registered;
+	/** Storage of names given to registerClassCustomName() */
+	std::deque<std::string> m_customNames;
 
-	// The auxiliary copy of "m_ns_classes", w/o namespace prefixes:
-	TClassnameToRuntimeId m_no_ns_classes;
+	Tables m_emptyTables;
+	std::atomic<const Tables*> m_tables{nullptr};
+	/** The current tables, and former ones that readers may still hold */
+	std::vector<std::unique_ptr<Tables>> m_allTables;
+	/** Number of threads within withTables() */
+	std::atomic<int> m_readers{0};
+	std::atomic_bool m_dirty{false};
 
-	std::shared_mutex m_mtx;
+	std::mutex m_mtx;
 };
 
 }  // namespace mrpt::rtti
@@ -167,7 +282,7 @@ void mrpt::rtti::registerClass(const TRuntimeClassId* pNewClass)
 	if (pNewClass && pNewClass->className)
 	{
 		CClassRegistry::Instance().Add(
-			std::string(pNewClass->className), *pNewClass);
+			pNewClass->className, *pNewClass, false);
 	}
 	else
 	{
@@ -188,7 +303,7 @@ void mrpt::rtti::registerClassCustomName(
 	const char* customName, const TRuntimeClassId* pNewClass)
 {
 	// Register it:
-	CClassRegistry::Instance().Add(customName, *pNewClass);
+	CClassRegistry::Instance().Add(customName, *pNewClass, true);
 
 	// Automatically register all classes when the first one is registered.
 	registerAllPendingClasses();
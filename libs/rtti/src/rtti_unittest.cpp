@@ -12,6 +12,12 @@
 #include <mrpt/rtti/CListOfClasses.h>
 #include <mrpt/rtti/CObject.h>
 
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 namespace MyNS
 {
 class MyDerived1 : public mrpt::rtti::CObject
@@ -152,3 +158,68 @@ TEST(rtti, CListOfClasses)
 		EXPECT_ANY_THROW(l.fromString("foooo"));
 	}
 }
+
+TEST(rtti, findRegisteredClass)
+{
+	do_register();
+	using mrpt::rtti::findRegisteredClass;
+
+	EXPECT_EQ(
+		findRegisteredClass("MyNS::MyDerived1"), CLASS_ID(MyNS::MyDerived1));
+	EXPECT_EQ(
+		findRegisteredClass("MyNS::MyDerived2"), CLASS_ID(MyNS::MyDerived2));
+	EXPECT_EQ(findRegisteredClass("MyNS::MyDerived3"), nullptr);
+
+	// Without namespace:
+	EXPECT_EQ(findRegisteredClass("MyDerived1"), CLASS_ID(MyNS::MyDerived1));
+	EXPECT_EQ(findRegisteredClass("MyDerived1", false), nullptr);
+	EXPECT_EQ(
+		findRegisteredClass("OtherNS::MyDerived2"), CLASS_ID(MyNS::MyDerived2));
+
+	// Registered after the first lookups:
+	EXPECT_EQ(findRegisteredClass("MyOldName1"), nullptr);
+	mrpt::rtti::registerClassCustomName(
+		std::string("MyOldName1").c_str(), CLASS_ID(MyNS::MyDerived1));
+	EXPECT_EQ(findRegisteredClass("MyOldName1"), CLASS_ID(MyNS::MyDerived1));
+
+	// Registering again does not duplicate entries:
+	const auto nClasses = mrpt::rtti::getAllRegisteredClasses().size();
+	do_register();
+	EXPECT_EQ(mrpt::rtti::getAllRegisteredClasses().size(), nClasses);
+
+	const auto children = mrpt::rtti::getAllRegisteredClassesChildrenOf(
+		CLASS_ID(mrpt::rtti::CObject));
+	EXPECT_NE(
+		std::find(children.begin(), children.end(), CLASS_ID(MyNS::MyDerived2)),
+		children.end());
+}
+
+TEST(rtti, findRegisteredClassWhileRegistering)
+{
+	do_register();
+	using mrpt::rtti::findRegisteredClass;
+
+	// Lookups from other threads while the tables are rebuilt (and former
+	// ones freed) many times:
+	std::atomic_bool done{false};
+	std::atomic<int> errors{0};
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; i++)
+		readers.emplace_back([&]() {
+			while (!done)
+				if (findRegisteredClass("MyNS::MyDerived1") !=
+					CLASS_ID(MyNS::MyDerived1))
+					errors++;
+		});
+	for (int i = 0; i < 200; i++)
+	{
+		const std::string name = "MyTmpName" + std::to_string(i);
+		mrpt::rtti::registerClassCustomName(
+			name.c_str(), CLASS_ID(MyNS::MyDerived2));
+		EXPECT_EQ(findRegisteredClass(name), CLASS_ID(MyNS::MyDerived2));
+	}
+	done = true;
+	for (auto& t : readers)
+		t.join();
+	EXPECT_EQ(errors, 0);
+}
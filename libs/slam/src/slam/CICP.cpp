@@ -9,7 +9,7 @@
 
 #include "slam-precomp.h"  // Precompiled headers
 //
-#include <mrpt/config/CConfigFileBase.h>  // MRPT_LOAD_*()
+#include <mrpt/config/CConfigBindings.h>
 #include <mrpt/math/TPose2D.h>
 #include <mrpt/math/ops_containers.h>
 #include <mrpt/math/wrap2pi.h>
@@ -81,47 +81,50 @@ CPosePDF::Ptr CICP::AlignPDF(
 void CICP::TConfigParams::loadFromConfigFile(
 	const mrpt::config::CConfigFileBase& iniFile, const std::string& section)
 {
-	MRPT_LOAD_CONFIG_VAR(maxIterations, int, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(minAbsStep_trans, float, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(minAbsStep_rot, float, iniFile, section);
-
-	ICP_algorithm = iniFile.read_enum<TICPAlgorithm>(
-		section, "ICP_algorithm", ICP_algorithm);
-	ICP_covariance_method = iniFile.read_enum<TICPCovarianceMethod>(
-		section, "ICP_covariance_method", ICP_covariance_method);
-
-	MRPT_LOAD_CONFIG_VAR(thresholdDist, float, iniFile, section);
-	thresholdAng = DEG2RAD(iniFile.read_float(
-		section.c_str(), "thresholdAng_DEG", RAD2DEG(thresholdAng)));
-
-	MRPT_LOAD_CONFIG_VAR(ALFA, float, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(smallestThresholdDist, float, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(onlyUniqueRobust, bool, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(doRANSAC, bool, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(covariance_varPoints, float, iniFile, section);
-
-	MRPT_LOAD_CONFIG_VAR(ransac_minSetSize, int, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(ransac_maxSetSize, int, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(
-		ransac_mahalanobisDistanceThreshold, float, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(ransac_nSimulations, int, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(normalizationStd, float, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(ransac_fuseByCorrsMatch, bool, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(ransac_fuseMaxDiffXY, float, iniFile, section);
-	ransac_fuseMaxDiffPhi = DEG2RAD(iniFile.read_float(
-		section.c_str(), "ransac_fuseMaxDiffPhi_DEG",
-		RAD2DEG(ransac_fuseMaxDiffPhi)));
-
-	MRPT_LOAD_CONFIG_VAR(kernel_rho, float, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(use_kernel, bool, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(Axy_aprox_derivatives, float, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(LM_initial_lambda, float, iniFile, section);
-
-	MRPT_LOAD_CONFIG_VAR(skip_cov_calculation, bool, iniFile, section);
-	MRPT_LOAD_CONFIG_VAR(skip_quality_calculation, bool, iniFile, section);
-
-	MRPT_LOAD_CONFIG_VAR(
-		corresponding_points_decimation, int, iniFile, section);
+	static const auto bindings =
+		mrpt::config::CConfigBindings<TConfigParams>()
+			.bind("maxIterations", &TConfigParams::maxIterations)
+			.bind("minAbsStep_trans", &TConfigParams::minAbsStep_trans)
+			.bind("minAbsStep_rot", &TConfigParams::minAbsStep_rot)
+			.bind("ICP_algorithm", &TConfigParams::ICP_algorithm)
+			.bind(
+				"ICP_covariance_method", &TConfigParams::ICP_covariance_method)
+			.bind("thresholdDist", &TConfigParams::thresholdDist)
+			.bindDegrees("thresholdAng_DEG", &TConfigParams::thresholdAng)
+			.bind("ALFA", &TConfigParams::ALFA)
+			.bind(
+				"smallestThresholdDist", &TConfigParams::smallestThresholdDist)
+			.bind("onlyUniqueRobust", &TConfigParams::onlyUniqueRobust)
+			.bind("doRANSAC", &TConfigParams::doRANSAC)
+			.bind("covariance_varPoints", &TConfigParams::covariance_varPoints)
+			.bind("ransac_minSetSize", &TConfigParams::ransac_minSetSize)
+			.bind("ransac_maxSetSize", &TConfigParams::ransac_maxSetSize)
+			.bind(
+				"ransac_mahalanobisDistanceThreshold",
+				&TConfigParams::ransac_mahalanobisDistanceThreshold)
+			.bind("ransac_nSimulations", &TConfigParams::ransac_nSimulations)
+			.bind("normalizationStd", &TConfigParams::normalizationStd)
+			.bind(
+				"ransac_fuseByCorrsMatch",
+				&TConfigParams::ransac_fuseByCorrsMatch)
+			.bind("ransac_fuseMaxDiffXY", &TConfigParams::ransac_fuseMaxDiffXY)
+			.bindDegrees(
+				"ransac_fuseMaxDiffPhi_DEG",
+				&TConfigParams::ransac_fuseMaxDiffPhi)
+			.bind("kernel_rho", &TConfigParams::kernel_rho)
+			.bind("use_kernel", &TConfigParams::use_kernel)
+			.bind(
+				"Axy_aprox_derivatives", &TConfigParams::Axy_aprox_derivatives)
+			.bind("LM_initial_lambda", &TConfigParams::LM_initial_lambda)
+			.bind("skip_cov_calculation", &TConfigParams::skip_cov_calculation)
+			.bind(
+				"skip_quality_calculation",
+				&TConfigParams::skip_quality_calculation)
+			.bind(
+				"corresponding_points_decimation",
+				&TConfigParams::corresponding_points_decimation);
+
+	bindings.load(iniFile, section, *this);
 }
 
 void CICP::TConfigParams::saveToConfigFile(
@@ -33,6 +33,9 @@ namespace mrpt::system
  *   For an example of how to handle a memory pool, see the class
  *mrpt::obs::CObservation3DRangeScan
  *
+ *   For pools shared by several threads, prefer CSizeClassMemoryPool, which
+ *avoids the global lock and keeps per-thread caches of blocks.
+ *
  *  \tparam POOLABLE_DATA A struct with user-defined objects which actually
  *contain the memory blocks (e.g. one or more std::vector).
  *  \tparam DATA_PARAMS A struct with user information about each memory block
@@ -117,6 +117,23 @@ using output_logger_callback_t = std::function<void(
  * logging_enable_console_output class variable if that's not the desired
  * behavior
  *
+ * <b>Asynchronous mode:</b> By default, logStr() formats the message and
+ * writes it to the console, the history and all user callbacks before
+ * returning. After logEnableAsyncMode(), logStr() only copies the message into
+ * a preallocated slot of a process-wide lock-free queue, and one background
+ * thread (shared by all loggers) does the formatting, console output, history
+ * update and callback invocations, in the same order in which messages were
+ * queued. If the queue is full, messages are dropped and counted (see
+ * logGetDroppedMessages()). Methods reading the history (getLogAsString(),
+ * etc.) first wait for pending messages with logFlush(). Callbacks are
+ * invoked from the background thread, so exceptions thrown by them cannot
+ * reach the caller of logStr(): they are printed to `std::cerr` and the
+ * remaining callbacks are still invoked. In the default (synchronous) mode,
+ * instead, an exception thrown by a callback propagates out of logStr(), and
+ * the remaining callbacks for that message are skipped. The async mode can
+ * be enabled by default for all new loggers with setDefaultAsyncMode() or the
+ * environment variable `MRPT_LOG_ASYNC=1`.
+ *
  * \note [New in MRPT 1.5.0]
  * \sa TMsg
  * \ingroup mrpt_system_grp
@@ -252,11 +269,53 @@ class COutputLogger
 	 * writeLogToFile, getLogAsString */
 	bool logging_enable_keep_record{false};
 
+	/** [Default=0] If not zero, only the most recent messages up to this
+	 * number are kept in the history. \sa logging_enable_keep_record */
+	size_t logging_max_history_size{0};
+
+	/** Registers a callback for all displayed messages. Exceptions thrown by
+	 * callbacks propagate to the logStr() caller only in synchronous mode
+	 * (see the class docs). */
 	void logRegisterCallback(output_logger_callback_t userFunc);
 	/** \return true if an entry was found and deleted. */
 	bool logDeregisterCallback(output_logger_callback_t userFunc);
 	/** @} */
 
+	/** @name Asynchronous logging
+	 * @{ */
+
+	/** Enables or disables the asynchronous mode (see class docs). Disabling
+	 * it waits for all pending messages first. Copies of a logger made while
+	 * in async mode share the history of the original one. */
+	void logEnableAsyncMode(bool enable = true);
+	bool logIsAsyncModeEnabled() const { return m_async != nullptr; }
+
+	/** In async mode, blocks until all messages logged so far (by any
+	 * logger) have been processed by the background thread. Does nothing in
+	 * synchronous mode. */
+	void logFlush() const;
+
+	/** Number of messages of this logger dropped because the async queue was
+	 * full. \sa getAsyncStats */
+	size_t logGetDroppedMessages() const;
+
+	/** Global statistics of the asynchronous logging backend */
+	struct TAsyncStats
+	{
+		/** Capacity (in messages) of the process-wide queue */
+		size_t queue_capacity{0};
+		size_t queued{0}, processed{0}, dropped{0};
+	};
+	static TAsyncStats getAsyncStats();
+
+	/** Sets whether new COutputLogger objects use the asynchronous mode by
+	 * default. Initial value is taken from the environment variable
+	 * `MRPT_LOG_ASYNC` (default: false). */
+	static void setDefaultAsyncMode(bool enable);
+	static bool getDefaultAsyncMode();
+
+	/** @} */
+
    protected:
 	/** \brief Provided messages with VerbosityLevel smaller than this value
 	 * shall be ignored */
@@ -284,6 +343,9 @@ class COutputLogger
 		TMsg(
 			const mrpt::system::VerbosityLevel level, std::string_view msg,
 			const COutputLogger& logger);
+		TMsg(
+			const mrpt::system::VerbosityLevel level, std::string_view msg,
+			std::string_view loggerName, const mrpt::Clock::time_point t);
 		/** \brief  Default Destructor */
 		~TMsg();
 
@@ -323,6 +385,38 @@ class COutputLogger
 	std::shared_ptr<std::mutex> m_historyMtx = std::make_shared<std::mutex>();
 
 	std::deque<output_logger_callback_t> m_listCallbacks;
+
+	/** Process-wide queue and thread of the async mode (defined in the .cpp
+	 * file) */
+	struct AsyncBackend;
+	/** Async mode state of one logger, kept alive by pending messages */
+	struct TAsyncState;
+	/** Owner of the async state of one logger. Copies of a logger get their
+	 * own copy of the state, and a state released by its logger flushes its
+	 * pending messages and drops its callbacks, so they are never invoked
+	 * once the logger is gone. */
+	struct TAsyncStatePtr : public std::shared_ptr<TAsyncState>
+	{
+		TAsyncStatePtr() = default;
+		TAsyncStatePtr(std::shared_ptr<TAsyncState>&& p)
+			: std::shared_ptr<TAsyncState>(std::move(p))
+		{
+		}
+		TAsyncStatePtr(const TAsyncStatePtr& o);
+		TAsyncStatePtr(TAsyncStatePtr&&) = default;
+		TAsyncStatePtr& operator=(const TAsyncStatePtr& o);
+		TAsyncStatePtr& operator=(TAsyncStatePtr&& o);
+		~TAsyncStatePtr();
+
+	   private:
+		void release();
+	};
+	TAsyncStatePtr m_async = defaultAsyncState();
+	static std::shared_ptr<TAsyncState> defaultAsyncState();
+
+	/** Runs `f` on the message history, with its mutex locked. In async
+	 * mode, waits for pending messages first. */
+	void withHistory(const std::function<void(std::deque<TMsg>&)>& f) const;
 };
 
 /** For use in MRPT_LOG_DEBUG_STREAM(), etc. */
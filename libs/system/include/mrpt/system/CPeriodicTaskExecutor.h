@@ -0,0 +1,206 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/system/COutputLogger.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mrpt::system
+{
+/** Runs many periodic tasks on a fixed set of worker threads, with
+ * earliest-deadline-first (EDF) scheduling and timing statistics for each
+ * task. It is intended to replace one thread per periodic loop (each with its
+ * own CRateTimer or CControlledRateTimer) in processes with many of them.
+ *
+ * Each task is released once per period, at absolute times (`phase`,
+ * `phase+period`, `phase+2*period`...) so the rate does not drift, and has to
+ * finish before its relative deadline (by default, its period). Among the
+ * released tasks, a free worker thread runs the one with the earliest
+ * absolute deadline. A task is never run by two threads at once: if a job is
+ * still running when the next release time comes, that release is delayed,
+ * and if whole periods are missed, those releases are skipped and counted.
+ *
+ * For each task, these statistics are kept (see getTaskStats()):
+ *  - Start latency (jitter): time between the release and the actual start.
+ *  - Execution time.
+ *  - Overruns: jobs finished after their deadline, with a histogram of how
+ *    late they finished.
+ *
+ * Worker threads can optionally use the real-time `SCHED_FIFO` scheduler and
+ * be bound to some CPU cores (see TParameters), which requires permissions
+ * for the former (see changeCurrentThreadRealTimePriority()). Failures to set
+ * them are reported as warnings via the COutputLogger interface.
+ *
+ * Usage:
+ * \code
+ * mrpt::system::CPeriodicTaskExecutor exec;
+ * CPeriodicTaskExecutor::TTaskOptions opts;
+ * opts.name = "control";
+ * opts.period = 0.01; // 100 Hz
+ * exec.addTask(opts, [&]() { controlStep(); });
+ * exec.start();
+ * ...
+ * std::cout << exec.getStatsAsText();
+ * \endcode
+ *
+ * \sa CControlledRateTimer, changeCurrentThreadRealTimePriority,
+ * changeCurrentThreadAffinity
+ * \ingroup mrpt_system_grp
+ */
+class CPeriodicTaskExecutor : public mrpt::system::COutputLogger
+{
+   public:
+	using task_id_t = uint32_t;
+	using task_t = std::function<void()>;
+
+	struct TParameters
+	{
+		/** Number of worker threads */
+		size_t numThreads = 1;
+		/** If >0, worker threads use the `SCHED_FIFO` scheduler with this
+		 * priority [1,99] */
+		int realTimePriority = 0;
+		/** If not empty, worker threads only run on these CPU cores */
+		std::vector<int> cpuAffinity;
+		/** Name of worker threads (plus an index) */
+		std::string threadName = "periodicExec";
+	};
+
+	struct TTaskOptions
+	{
+		/** Name, for reports */
+		std::string name;
+		/** Period (seconds) */
+		double period = 0.1;
+		/** Relative deadline (seconds), 0 means equal to the period */
+		double deadline = 0;
+		/** Delay of the first release after start() or addTask() (seconds) */
+		double phase = 0;
+		/** Number of bins of the histograms */
+		size_t histogramBins = 20;
+		/** Width of each histogram bin (seconds), 0 means
+		 * period/histogramBins. The last bin also counts larger values. */
+		double histogramBinWidth = 0;
+	};
+
+	/** Timing statistics of a task. All times in seconds. */
+	struct TTaskStats
+	{
+		std::string name;
+		double period = 0, deadline = 0;
+		/** Number of completed executions */
+		uint64_t executions = 0;
+		/** Executions finished after their deadline */
+		uint64_t overruns = 0;
+		/** Releases skipped because a whole period was missed */
+		uint64_t skipped = 0;
+		/** Start latency (from release to start) */
+		double latencyMin = 0, latencyMax = 0, latencyMean = 0;
+		/** Execution time */
+		double execMin = 0, execMax = 0, execMean = 0;
+		/** Width of histogram bins */
+		double histogramBinWidth = 0;
+		/** Histogram of start latencies */
+		std::vector<uint64_t> latencyHistogram;
+		/** Histogram of overrun times (finish time minus deadline) */
+		std::vector<uint64_t> overrunHistogram;
+	};
+
+	/** Default ctor: one worker thread, default parameters */
+	CPeriodicTaskExecutor();
+	explicit CPeriodicTaskExecutor(const TParameters& params);
+	/** Dtor: calls stop() */
+	~CPeriodicTaskExecutor() override;
+
+	CPeriodicTaskExecutor(const CPeriodicTaskExecutor&) = delete;
+	CPeriodicTaskExecutor& operator=(const CPeriodicTaskExecutor&) = delete;
+
+	/** Changes the parameters. It must be called before start().
+	 * \exception std::exception If the executor is running. */
+	void setParameters(const TParameters& params);
+	const TParameters& getParameters() const { return m_params; }
+
+	/** Adds a new task. It can be called before or after start(). Its first
+	 * release will be after `opts.phase` seconds from now or from start(),
+	 * whatever comes later.
+	 * \exception std::exception On invalid period, deadline or histogram
+	 * options.
+	 * \return An ID to refer to this task later on.
+	 */
+	task_id_t addTask(const TTaskOptions& opts, const task_t& task);
+
+	/** Removes a task. A running execution of the task is not interrupted,
+	 * but it will not be released again.
+	 * \return false if the ID was not found. */
+	bool removeTask(task_id_t id);
+
+	/** Launches the worker threads. Does nothing if already running. */
+	void start();
+
+	/** Stops the worker threads, waiting for running tasks to finish. Tasks
+	 * are kept and will be released again after the next start(). */
+	void stop();
+
+	bool isRunning() const;
+
+	/** Returns the timing statistics of a task.
+	 * \exception std::exception If the ID was not found. */
+	TTaskStats getTaskStats(task_id_t id) const;
+
+	/** Returns the statistics of all tasks, sorted by ID */
+	std::vector<TTaskStats> getAllTaskStats() const;
+
+	/** Resets the statistics of all tasks */
+	void resetStats();
+
+	/** Returns a table with the statistics of all tasks (times in ms) */
+	std::string getStatsAsText() const;
+
+   private:
+	using steady_clock_t = std::chrono::steady_clock;
+
+	struct TTask
+	{
+		TTaskOptions opts;
+		task_t func;
+		steady_clock_t::duration period{}, deadline{};
+		steady_clock_t::time_point nextRelease;
+		bool running = false, removed = false;
+		TTaskStats stats;
+		double latencySum = 0, execSum = 0;
+	};
+
+	TParameters m_params;
+	std::map<task_id_t, TTask> m_tasks;
+	task_id_t m_nextId = 0;
+	mutable std::mutex m_mtx;
+	std::condition_variable m_cv;
+	std::vector<std::thread> m_threads;
+	bool m_running = false;
+
+	void workerThread(size_t index);
+
+	/** Updates the stats and next release of a task after one execution */
+	void onTaskDone(
+		TTask& t, steady_clock_t::time_point release,
+		steady_clock_t::time_point start, steady_clock_t::time_point end);
+
+	static void resetStats(TTask& t);
+};
+
+}  // namespace mrpt::system
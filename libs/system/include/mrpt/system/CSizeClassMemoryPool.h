@@ -0,0 +1,337 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mrpt::system
+{
+/** A memory pool for recycling large memory blocks (e.g. the buffers of
+ * observations) with per-thread caches and size classes, a faster alternative
+ * to CGenericMemoryPool when many threads allocate and free blocks.
+ *
+ * This class implements the singleton pattern so a unique instance exists
+ * for each combination of template parameters. All methods are thread-safe.
+ *
+ * Blocks are classified by the binary logarithm of their size in bytes, as
+ * reported by `DATA_PARAMS::size()`. Each thread keeps a small cache of
+ * blocks for each size class, accessed without any lock. When a thread cache
+ * is full, its oldest block of that size class goes to a shared depot (one
+ * mutex per size class), from which other threads take blocks once their own
+ * caches are empty. The capacity of each thread cache grows with the number
+ * of requests not served from it, so threads which only free blocks (e.g. a
+ * consumer of observations) pass them directly to the depot, where threads
+ * which allocate them (e.g. the sensor driver) find them, without contention
+ * on a single global lock or list.
+ *
+ * The usage is the same than for CGenericMemoryPool:
+ *  - When needed, call request_memory() to check the availability of
+ *    memory in the pool.
+ *  - At your class destructor, donate the memory to the pool with
+ *    dump_to_pool().
+ *
+ * `DATA_PARAMS` must provide these methods:
+ * \code
+ *  // Size of the block, in bytes:
+ *  size_t size() const;
+ *  // Whether this block can be used to fulfil the request `req`:
+ *  bool isSuitable(const DATA_PARAMS& req) const;
+ * \endcode
+ * Blocks are searched in the size class of the request and the next one, so
+ * `isSuitable()` may accept blocks equal or larger than requested.
+ *
+ * For an example of usage, see the class mrpt::obs::CObservation3DRangeScan
+ *
+ * \tparam DATA_PARAMS A struct with user information about each memory block
+ * (e.g. size of a std::vector)
+ * \tparam POOLABLE_DATA A struct with user-defined objects which actually
+ * contain the memory blocks (e.g. one or more std::vector).
+ * \ingroup mrpt_memory
+ */
+template <class DATA_PARAMS, class POOLABLE_DATA>
+class CSizeClassMemoryPool
+{
+   public:
+	using self_t = CSizeClassMemoryPool<DATA_PARAMS, POOLABLE_DATA>;
+
+	/** Number of size classes: one per bit of `size_t` */
+	static constexpr size_t NUM_SIZE_CLASSES = sizeof(size_t) * 8;
+
+	/** Usage statistics, accumulated for all threads \sa getStats */
+	struct TStats
+	{
+		size_t requests{0};
+		/** Requests served from the calling thread cache */
+		size_t local_hits{0};
+		/** Requests served from the shared depot */
+		size_t shared_hits{0};
+		size_t donations{0};
+		/** Donated blocks freed because the shared depot was full */
+		size_t discarded{0};
+
+		size_t misses() const { return requests - local_hits - shared_hits; }
+	};
+
+	/** Construct-on-first-use (~singleton) pattern: Return the unique instance
+	 * of this class for a given template arguments, or nullptr if it was once
+	 * created but it's been destroyed (which means we're in the program global
+	 * destruction phase).
+	 */
+	static self_t* getInstance()
+	{
+		static bool was_destroyed = false;
+		static self_t inst(was_destroyed);
+		return was_destroyed ? nullptr : &inst;
+	}
+
+	/** Maximum number of blocks of each size class kept by each thread
+	 * (Default=4) */
+	void setMaxLocalEntriesPerClass(size_t n) { m_maxLocal = n; }
+	size_t getMaxLocalEntriesPerClass() const { return m_maxLocal; }
+
+	/** Maximum number of blocks of each size class kept in the shared depot.
+	 * If exceeded, the oldest blocks are freed (Default=8) */
+	void setMaxSharedEntriesPerClass(size_t n) { m_maxShared = n; }
+	size_t getMaxSharedEntriesPerClass() const { return m_maxShared; }
+
+	/** Size class of a block of `bytes` bytes: floor(log2(bytes)) */
+	static size_t sizeClassOf(size_t bytes)
+	{
+		size_t c = 0;
+		while (bytes >>= 1)
+			c++;
+		return c;
+	}
+
+	/** Request a block of data which fulfils the size requirements stated in
+	 * \a params. The decision on the suitability of each block is done by
+	 * DATA_PARAMS::isSuitable().
+	 *  \return The block of data, or nullptr if none suitable was found in the
+	 * pool.
+	 *  \note It is a responsibility of the user to free with "delete" the
+	 * "POOLABLE_DATA" object itself once the memory has been extracted from its
+	 * elements.
+	 */
+	POOLABLE_DATA* request_memory(const DATA_PARAMS& params)
+	{
+		TThreadCache& tc = threadCache();
+		inc(tc.requests);
+
+		const size_t c0 = sizeClassOf(params.size());
+		const size_t c1 = std::min(c0 + 1, NUM_SIZE_CLASSES - 1);
+
+		// 1st: the thread cache (most recent blocks first):
+		for (size_t c = c0; c <= c1; c++)
+		{
+			auto& lst = tc.classes[c];
+			for (size_t i = lst.size(); i-- > 0;)
+			{
+				if (!lst[i].params.isSuitable(params)) continue;
+				POOLABLE_DATA* ret = lst[i].block.release();
+				lst.erase(lst.begin() + i);
+				inc(tc.local_hits);
+				return ret;
+			}
+		}
+		// This thread needs blocks of this class: let it cache more of them
+		if (tc.capacity[c0] < m_maxLocal) tc.capacity[c0]++;
+
+		// 2nd: the shared depot:
+		for (size_t c = c0; c <= c1; c++)
+		{
+			TSharedClass& sc = m_shared[c];
+			if (!sc.count.load(std::memory_order_relaxed)) continue;
+
+			std::lock_guard<std::mutex> lck(sc.mtx);
+			for (size_t i = sc.entries.size(); i-- > 0;)
+			{
+				if (!sc.entries[i].params.isSuitable(params)) continue;
+				POOLABLE_DATA* ret = sc.entries[i].block.release();
+				sc.entries.erase(sc.entries.begin() + i);
+				sc.count = sc.entries.size();
+				inc(tc.shared_hits);
+				return ret;
+			}
+		}
+		return nullptr;
+	}
+
+	/** Saves the passed data block (characterized by \a params) to the pool.
+	 *  \note It is a responsibility of the user to allocate in dynamic memory
+	 * the "POOLABLE_DATA" object with "new".
+	 */
+	void dump_to_pool(const DATA_PARAMS& params, POOLABLE_DATA* block)
+	{
+		TEntry e{params, std::unique_ptr<POOLABLE_DATA>(block)};
+		TThreadCache& tc = threadCache();
+		inc(tc.donations);
+
+		const size_t c = sizeClassOf(params.size());
+		auto& lst = tc.classes[c];
+		lst.push_back(std::move(e));
+		if (lst.size() <= std::min<size_t>(tc.capacity[c], m_maxLocal))
+			return;
+
+		// Thread cache full: move its oldest block to the shared depot
+		TEntry oldest = std::move(lst.front());
+		lst.erase(lst.begin());
+		inc(tc.discarded, pushShared(c, std::move(oldest)));
+	}
+
+	/** Returns the statistics of all threads since the pool creation */
+	TStats getStats() const
+	{
+		std::lock_guard<std::mutex> lck(m_cachesMtx);
+		TStats s = m_retiredStats;
+		for (const TThreadCache* tc : m_caches)
+			tc->addStatsTo(s);
+		return s;
+	}
+
+	/** Frees all blocks in the shared depot and in the calling thread
+	 * cache. */
+	void clear()
+	{
+		for (auto& lst : threadCache().classes)
+			lst.clear();
+		for (auto& sc : m_shared)
+		{
+			std::vector<TEntry> old;
+			{
+				std::lock_guard<std::mutex> lck(sc.mtx);
+				old.swap(sc.entries);
+				sc.count = 0;
+			}
+		}
+	}
+
+	~CSizeClassMemoryPool()
+	{
+		m_was_destroyed = true;
+		std::lock_guard<std::mutex> lck(m_cachesMtx);
+		for (TThreadCache* tc : m_caches)
+			tc->pool = nullptr;
+	}
+
+	CSizeClassMemoryPool(const self_t&) = delete;
+	self_t& operator=(const self_t&) = delete;
+
+   private:
+	struct TEntry
+	{
+		DATA_PARAMS params;
+		std::unique_ptr<POOLABLE_DATA> block;
+	};
+
+	struct TSharedClass
+	{
+		std::mutex mtx;
+		std::vector<TEntry> entries;
+		std::atomic<size_t> count{0};  //!< to skip the lock if empty
+	};
+
+	/** Per-thread cache. Counters are only written by the owner thread, but
+	 * read by getStats() */
+	struct TThreadCache
+	{
+		explicit TThreadCache(self_t* p) : pool(p)
+		{
+			if (!pool) return;
+			std::lock_guard<std::mutex> lck(pool->m_cachesMtx);
+			pool->m_caches.push_back(this);
+		}
+		~TThreadCache()
+		{
+			// Pool destroyed already? (program termination)
+			if (!self_t::getInstance() || !pool) return;
+
+			std::lock_guard<std::mutex> lck(pool->m_cachesMtx);
+			addStatsTo(pool->m_retiredStats);
+			auto& cs = pool->m_caches;
+			cs.erase(std::find(cs.begin(), cs.end(), this));
+
+			// Let other threads reuse the blocks:
+			for (size_t c = 0; c < NUM_SIZE_CLASSES; c++)
+				for (auto& e : classes[c])
+					pool->m_retiredStats.discarded +=
+						pool->pushShared(c, std::move(e));
+		}
+
+		void addStatsTo(TStats& s) const
+		{
+			s.requests += requests.load(std::memory_order_relaxed);
+			s.local_hits += local_hits.load(std::memory_order_relaxed);
+			s.shared_hits += shared_hits.load(std::memory_order_relaxed);
+			s.donations += donations.load(std::memory_order_relaxed);
+			s.discarded += discarded.load(std::memory_order_relaxed);
+		}
+
+		self_t* pool;
+		std::array<std::vector<TEntry>, NUM_SIZE_CLASSES> classes;
+		/** Current limit of blocks per class, which grows from 0 up to
+		 * m_maxLocal with the local cache misses */
+		std::array<size_t, NUM_SIZE_CLASSES> capacity{};
+		std::atomic<size_t> requests{0}, local_hits{0}, shared_hits{0},
+			donations{0}, discarded{0};
+	};
+
+	static TThreadCache& threadCache()
+	{
+		thread_local TThreadCache tc(getInstance());
+		return tc;
+	}
+
+	/** Increments a counter only written by its owner thread */
+	static void inc(std::atomic<size_t>& v, size_t n = 1)
+	{
+		v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+
+	/** Returns the number of blocks freed because the depot was full */
+	size_t pushShared(size_t c, TEntry&& e)
+	{
+		std::vector<TEntry> toFree;	 // Free them without holding the lock
+		TSharedClass& sc = m_shared[c];
+		{
+			std::lock_guard<std::mutex> lck(sc.mtx);
+			sc.entries.push_back(std::move(e));
+			while (sc.entries.size() > m_maxShared)
+			{
+				toFree.push_back(std::move(sc.entries.front()));
+				sc.entries.erase(sc.entries.begin());
+			}
+			sc.count = sc.entries.size();
+		}
+		return toFree.size();
+	}
+
+	explicit CSizeClassMemoryPool(bool& was_destroyed)
+		: m_was_destroyed(was_destroyed)
+	{
+		m_was_destroyed = false;
+	}
+
+	std::array<TSharedClass, NUM_SIZE_CLASSES> m_shared;
+	std::atomic<size_t> m_maxLocal{4}, m_maxShared{8};
+
+	mutable std::mutex m_cachesMtx;
+	std::vector<TThreadCache*> m_caches;
+	TStats m_retiredStats;
+
+	/** With this trick we get rid of the "global destruction order fiasco" */
+	bool& m_was_destroyed;
+};
+
+}  // namespace mrpt::system
@@ -8,6 +8,8 @@
    +------------------------------------------------------------------------+ */
 #pragma once
 
+#include <vector>
+
 namespace mrpt::system
 {
 // clang-format off
@@ -65,6 +67,27 @@ void changeCurrentThreadPriority(TThreadPriority priority);
   */
 void changeCurrentProcessPriority(TProcessPriority priority);
 
+/** Switches the current thread to the real-time FIFO scheduler
+ * (`SCHED_FIFO`) with the given priority, in the range [1,99] in Linux.
+ * - Windows: The priority is mapped to THREAD_PRIORITY_TIME_CRITICAL (>=50)
+ * or THREAD_PRIORITY_HIGHEST.
+ * - Linux (pthreads): Requires `root` permissions or the `CAP_SYS_NICE`
+ * capability (or a suitable `RLIMIT_RTPRIO`). Read
+ * [sched_setscheduler](http://linux.die.net/man/2/sched_setscheduler).
+ * \return false if the policy could not be changed (e.g. not enough
+ * permissions).
+ * \sa changeCurrentThreadPriority, changeCurrentThreadAffinity
+ */
+bool changeCurrentThreadRealTimePriority(int priority);
+
+/** Restricts the current thread to run only on the given CPU cores (0-based
+ * indices). An empty list means all cores.
+ * \return false if the affinity could not be changed (e.g. invalid CPU
+ * index), or if not supported in this platform.
+ * \sa changeCurrentThreadRealTimePriority
+ */
+bool changeCurrentThreadAffinity(const std::vector<int>& cpus);
+
 /**  @} */
 
 }  // namespace mrpt::system
@@ -10,16 +10,22 @@
 #include "system-precomp.h"	 // Precompiled headers
 //
 #include <mrpt/core/exceptions.h>
+#include <mrpt/core/get_env.h>
 #include <mrpt/core/lock_helper.h>
 #include <mrpt/system/COutputLogger.h>
 #include <mrpt/system/datetime.h>
 #include <mrpt/system/filesystem.h>
+#include <mrpt/system/thread_name.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdarg>	// for logFmt
 #include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #ifdef _MSC_VER
@@ -66,17 +72,406 @@ std::array<std::string, NUMBER_OF_VERBOSITY_LEVELS>&
 	return ::logging_levels_to_names;
 }
 
+// Asynchronous mode
+// ////////////////////////////////////////////////////////////
+
+struct COutputLogger::TAsyncState
+{
+	std::mutex historyMtx;
+	std::deque<TMsg> history;
+
+	std::mutex callbacksMtx;
+	std::deque<output_logger_callback_t> callbacks;
+
+	std::atomic<size_t> dropped{0};
+};
+
+namespace
+{
+enum AsyncMsgFlags : uint8_t
+{
+	MSG_TO_HISTORY = 0x01,
+	MSG_SHOW = 0x02	 // console and callbacks
+};
+
+std::atomic_bool& defaultAsyncModeFlag()
+{
+	static std::atomic_bool flag{mrpt::get_env<bool>("MRPT_LOG_ASYNC", false)};
+	return flag;
+}
+}  // namespace
+
+/** A bounded multiple-producer single-consumer queue of messages, with
+ * preallocated slots (D. Vyukov's algorithm), plus the consumer thread. */
+struct COutputLogger::AsyncBackend
+{
+	static constexpr size_t QUEUE_CAPACITY = 8192;	// Must be a power of 2
+
+	struct Slot
+	{
+		std::atomic<uint64_t> seq{0};
+		mrpt::Clock::time_point timestamp;
+		VerbosityLevel level{LVL_INFO};
+		uint8_t flags{0};
+		size_t maxHistory{0};
+		std::shared_ptr<TAsyncState> state;
+		// Strings keep their capacity, so normally no memory is allocated
+		// when pushing messages:
+		std::string name, body;
+	};
+
+	AsyncBackend() : slots(new Slot[QUEUE_CAPACITY])
+	{
+		for (size_t i = 0; i < QUEUE_CAPACITY; i++)
+		{
+			slots[i].seq = i;
+			slots[i].name.reserve(64);
+			slots[i].body.reserve(256);
+		}
+		thread = std::thread([this]() { run(); });
+		mrpt::system::thread_name("mrptLogger", thread);
+		instance() = this;
+	}
+	~AsyncBackend()
+	{
+		instance() = nullptr;
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			exitThread = true;
+		}
+		cv.notify_all();
+		if (thread.joinable()) thread.join();
+	}
+	AsyncBackend(const AsyncBackend&) = delete;
+	AsyncBackend& operator=(const AsyncBackend&) = delete;
+
+	/** Returns the backend, creating it on first use, or nullptr if it has
+	 * been already destroyed (during program termination). */
+	static AsyncBackend* Get()
+	{
+		static AsyncBackend inst;
+		return instance().load(std::memory_order_acquire);
+	}
+	/** Like Get(), without creating it. */
+	static std::atomic<AsyncBackend*>& instance()
+	{
+		static std::atomic<AsyncBackend*> ptr{nullptr};
+		return ptr;
+	}
+
+	std::unique_ptr<Slot[]> slots;
+	alignas(64) std::atomic<uint64_t> enqueuePos{0};
+	alignas(64) std::atomic<uint64_t> dequeuePos{0};
+	std::atomic<size_t> dropped{0};
+
+	std::thread thread;
+	std::mutex mtx;
+	std::condition_variable cv;	 //!< wakes up the thread and flush() calls
+	std::atomic_bool sleeping{false};
+	std::atomic<int> flushWaiters{0};
+	bool exitThread{false};
+
+	void push(
+		const std::shared_ptr<TAsyncState>& state, VerbosityLevel level,
+		std::string_view name, std::string_view body, uint8_t flags,
+		size_t maxHistory)
+	{
+		const auto now = mrpt::Clock::now();
+
+		uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+		Slot* s;
+		for (;;)
+		{
+			s = &slots[pos & (QUEUE_CAPACITY - 1)];
+			const uint64_t seq = s->seq.load(std::memory_order_acquire);
+			const auto dif =
+				static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+			if (dif == 0)
+			{
+				if (enqueuePos.compare_exchange_weak(
+						pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (dif < 0)
+			{
+				// Queue full:
+				dropped++;
+				state->dropped++;
+				return;
+			}
+			else
+				pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+
+		s->timestamp = now;
+		s->level = level;
+		s->flags = flags;
+		s->maxHistory = maxHistory;
+		s->state = state;
+		s->name.assign(name);
+		s->body.assign(body);
+		s->seq.store(pos + 1, std::memory_order_release);
+
+		// Wake up the thread only if it was sleeping:
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (sleeping.load(std::memory_order_relaxed)) wakeUp();
+	}
+
+	void wakeUp()
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		sleeping = false;
+		cv.notify_all();
+	}
+
+	void flush()
+	{
+		// Callbacks calling flush() must not wait for themselves:
+		if (std::this_thread::get_id() == thread.get_id()) return;
+
+		const uint64_t target = enqueuePos.load(std::memory_order_acquire);
+		flushWaiters++;
+		wakeUp();
+		std::unique_lock<std::mutex> lck(mtx);
+		while (dequeuePos.load(std::memory_order_acquire) < target &&
+			   !exitThread)
+			cv.wait_for(lck, std::chrono::milliseconds(10));
+		flushWaiters--;
+	}
+
+	void run()
+	{
+		for (;;)
+		{
+			const uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+			Slot& s = slots[pos & (QUEUE_CAPACITY - 1)];
+			if (s.seq.load(std::memory_order_acquire) == pos + 1)
+			{
+				process(
+					*s.state,
+					TMsg(s.level, s.body, s.name, s.timestamp), s.flags,
+					s.maxHistory);
+				s.state.reset();
+				s.seq.store(pos + QUEUE_CAPACITY, std::memory_order_release);
+				dequeuePos.store(pos + 1, std::memory_order_release);
+
+				if (flushWaiters.load()) wakeUp();
+				continue;
+			}
+
+			// Empty queue: sleep until a producer wakes us up.
+			std::unique_lock<std::mutex> lck(mtx);
+			if (exitThread) return;
+			sleeping = true;
+			if (s.seq.load() == pos + 1)
+			{
+				sleeping = false;
+				continue;
+			}
+			cv.wait_for(lck, std::chrono::milliseconds(100), [this]() {
+				return !sleeping || exitThread;
+			});
+			sleeping = false;
+		}
+	}
+
+	static void process(
+		TAsyncState& st, const TMsg& msg, uint8_t flags, size_t maxHistory)
+	{
+		if (flags & MSG_TO_HISTORY)
+		{
+			auto lck = mrpt::lockHelper(st.historyMtx);
+			st.history.push_back(msg);
+			while (maxHistory && st.history.size() > maxHistory)
+				st.history.pop_front();
+		}
+		if (flags & MSG_SHOW)
+		{
+			msg.dumpToConsole();
+
+			auto lck = mrpt::lockHelper(st.callbacksMtx);
+			for (const auto& c : st.callbacks)
+			{
+				try
+				{
+					c(msg.body, msg.level, msg.name, msg.timestamp);
+				}
+				catch (const std::exception& e)
+				{
+					std::cerr << "[COutputLogger] Exception in callback:\n"
+							  << mrpt::exception_to_str(e);
+				}
+			}
+		}
+	}
+};
+
+std::shared_ptr<COutputLogger::TAsyncState> COutputLogger::defaultAsyncState()
+{
+	if (!defaultAsyncModeFlag()) return {};
+	return std::make_shared<TAsyncState>();
+}
+
+void COutputLogger::setDefaultAsyncMode(bool enable)
+{
+	defaultAsyncModeFlag() = enable;
+}
+bool COutputLogger::getDefaultAsyncMode() { return defaultAsyncModeFlag(); }
+
+void COutputLogger::logEnableAsyncMode(bool enable)
+{
+	if (enable == (m_async != nullptr)) return;
+	if (enable)
+	{
+		auto st = std::make_shared<TAsyncState>();
+		{
+			auto lck = mrpt::lockHelper(*m_historyMtx);
+			st->history = std::move(m_history);
+			m_history.clear();
+		}
+		st->callbacks = m_listCallbacks;
+		m_async = std::move(st);
+	}
+	else
+	{
+		logFlush();
+		auto st = std::move(m_async);
+		m_async.reset();
+
+		auto lckSt = mrpt::lockHelper(st->historyMtx);
+		auto lck = mrpt::lockHelper(*m_historyMtx);
+		m_history = st->history;
+	}
+}
+
+COutputLogger::TAsyncStatePtr::TAsyncStatePtr(const TAsyncStatePtr& o)
+{
+	*this = o;
+}
+
+COutputLogger::TAsyncStatePtr& COutputLogger::TAsyncStatePtr::operator=(
+	const TAsyncStatePtr& o)
+{
+	if (this == &o) return *this;
+	release();
+	if (!o)
+	{
+		reset();
+		return *this;
+	}
+	if (auto* b = AsyncBackend::instance().load(); b) b->flush();
+
+	auto st = std::make_shared<TAsyncState>();
+	{
+		auto lck = mrpt::lockHelper(o->historyMtx);
+		st->history = o->history;
+	}
+	{
+		auto lck = mrpt::lockHelper(o->callbacksMtx);
+		st->callbacks = o->callbacks;
+	}
+	std::shared_ptr<TAsyncState>::operator=(std::move(st));
+	return *this;
+}
+
+COutputLogger::TAsyncStatePtr& COutputLogger::TAsyncStatePtr::operator=(
+	TAsyncStatePtr&& o)
+{
+	if (this == &o) return *this;
+	release();
+	std::shared_ptr<TAsyncState>::operator=(std::move(o));
+	return *this;
+}
+
+COutputLogger::TAsyncStatePtr::~TAsyncStatePtr() { release(); }
+
+void COutputLogger::TAsyncStatePtr::release()
+{
+	if (!*this) return;
+	// Queued messages keep the state alive: deliver them now and make sure
+	// no callback runs once its logger is gone.
+	if (auto* b = AsyncBackend::instance().load(); b) b->flush();
+	auto lck = mrpt::lockHelper((*this)->callbacksMtx);
+	(*this)->callbacks.clear();
+}
+
+void COutputLogger::logFlush() const
+{
+	if (!m_async) return;
+	if (auto* b = AsyncBackend::instance().load(); b) b->flush();
+}
+
+size_t COutputLogger::logGetDroppedMessages() const
+{
+	return m_async ? m_async->dropped.load() : 0;
+}
+
+COutputLogger::TAsyncStats COutputLogger::getAsyncStats()
+{
+	TAsyncStats st;
+	st.queue_capacity = AsyncBackend::QUEUE_CAPACITY;
+	if (auto* b = AsyncBackend::instance().load(); b)
+	{
+		st.processed = b->dequeuePos.load();
+		st.dropped = b->dropped.load();
+		st.queued = b->enqueuePos.load() - st.processed;
+	}
+	return st;
+}
+
+void COutputLogger::withHistory(
+	const std::function<void(std::deque<TMsg>&)>& f) const
+{
+	if (m_async)
+	{
+		logFlush();
+		auto lck = mrpt::lockHelper(m_async->historyMtx);
+		f(m_async->history);
+	}
+	else
+	{
+		auto lck = mrpt::lockHelper(*m_historyMtx);
+		f(m_history);
+	}
+}
+
+// COutputLogger
+// ////////////////////////////////////////////////////////////
+
 COutputLogger::~COutputLogger() = default;
 
 void COutputLogger::logStr(
 	const VerbosityLevel level, std::string_view msg_str) const
 {
+	if (m_async)
+	{
+		const bool show =
+			level >= m_min_verbosity_level && logging_enable_console_output;
+		if (!show && !logging_enable_keep_record) return;
+
+		const uint8_t flags = (show ? MSG_SHOW : 0) |
+			(logging_enable_keep_record ? MSG_TO_HISTORY : 0);
+
+		if (auto* b = AsyncBackend::Get(); b)
+			b->push(
+				m_async, level, m_logger_name, msg_str, flags,
+				logging_max_history_size);
+		else  // During program termination:
+			AsyncBackend::process(
+				*m_async, TMsg(level, msg_str, *this), flags,
+				logging_max_history_size);
+		return;
+	}
+
 	// initialize a TMsg object
 	TMsg msg(level, msg_str, *this);
 	if (logging_enable_keep_record)
 	{
 		auto lck = mrpt::lockHelper(*m_historyMtx);
 		m_history.push_back(msg);
+		while (logging_max_history_size &&
+			   m_history.size() > logging_max_history_size)
+			m_history.pop_front();
 	}
 
 	if (level >= m_min_verbosity_level && logging_enable_console_output)
@@ -152,9 +547,10 @@ void COutputLogger::setVerbosityLevel(const VerbosityLevel level)
 void COutputLogger::getLogAsString(std::string& fname) const
 {
 	fname.clear();
-	auto lck = mrpt::lockHelper(*m_historyMtx);
-	for (const auto& h : m_history)
-		fname += h.getAsString();
+	withHistory([&](const std::deque<TMsg>& history) {
+		for (const auto& h : history)
+			fname += h.getAsString();
+	});
 }
 std::string COutputLogger::getLogAsString() const
 {
@@ -186,16 +582,20 @@ void COutputLogger::writeLogToFile(const std::optional<string> fname_in) const
 
 void COutputLogger::dumpLogToConsole() const
 {
-	auto lck = mrpt::lockHelper(*m_historyMtx);
-	for (const auto& h : m_history)
-		h.dumpToConsole();
+	withHistory([](const std::deque<TMsg>& history) {
+		for (const auto& h : history)
+			h.dumpToConsole();
+	});
 }
 
 std::string COutputLogger::getLoggerLastMsg() const
 {
-	auto lck = mrpt::lockHelper(*m_historyMtx);
-	TMsg last_msg = m_history.back();
-	return last_msg.getAsString();
+	std::string s;
+	withHistory([&](const std::deque<TMsg>& history) {
+		ASSERT_(!history.empty());
+		s = history.back().getAsString();
+	});
+	return s;
 }
 
 void COutputLogger::getLoggerLastMsg(std::string& msg_str) const
@@ -218,6 +618,13 @@ COutputLogger::TMsg::TMsg(
 {
 }
 
+COutputLogger::TMsg::TMsg(
+	const mrpt::system::VerbosityLevel in_level, std::string_view msg_str,
+	std::string_view loggerName, const mrpt::Clock::time_point t)
+	: timestamp(t), level(in_level), name(loggerName), body(msg_str)
+{
+}
+
 COutputLogger::TMsg::~TMsg() = default;
 
 std::string COutputLogger::TMsg::getAsString() const
@@ -271,25 +678,42 @@ void COutputLogger::TMsg::dumpToConsole() const
 void COutputLogger::logRegisterCallback(output_logger_callback_t userFunc)
 {
 	m_listCallbacks.emplace_back(userFunc);
+	if (m_async)
+	{
+		auto lck = mrpt::lockHelper(m_async->callbacksMtx);
+		m_async->callbacks.emplace_back(userFunc);
+	}
 }
 
 template <typename T, typename... U>
 size_t getAddress(std::function<T(U...)> f)
 {
 	using fnType = T (*)(U...);
-	auto** fnPointer = f.template target<fnType*>();
-	return (size_t)*fnPointer;
+	// nullptr if the callback is not a plain function pointer:
+	auto* fnPointer = f.template target<fnType>();
+	return fnPointer ? (size_t)*fnPointer : 0;
 }
 
 bool COutputLogger::logDeregisterCallback(output_logger_callback_t userFunc)
 {
-	for (auto it = m_listCallbacks.begin(); it != m_listCallbacks.end(); ++it)
+	const size_t addr = getAddress(userFunc);
+	if (!addr) return false;
+	const auto sameTarget = [addr](const output_logger_callback_t& f) {
+		return getAddress(f) == addr;
+	};
+
+	auto it = std::find_if(
+		m_listCallbacks.begin(), m_listCallbacks.end(), sameTarget);
+	if (it == m_listCallbacks.end()) return false;
+	m_listCallbacks.erase(it);
+
+	if (m_async)
 	{
-		if (getAddress(*it) == getAddress(userFunc))
-		{
-			m_listCallbacks.erase(it);
-			return true;
-		}
+		auto lck = mrpt::lockHelper(m_async->callbacksMtx);
+		auto& cbs = m_async->callbacks;
+		if (auto itA = std::find_if(cbs.begin(), cbs.end(), sameTarget);
+			itA != cbs.end())
+			cbs.erase(itA);
 	}
-	return false;
+	return true;
 }
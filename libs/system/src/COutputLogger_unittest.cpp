@@ -0,0 +1,273 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/core/format.h>
+#include <mrpt/system/COutputLogger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using mrpt::system::COutputLogger;
+using mrpt::system::VerbosityLevel;
+
+namespace
+{
+// Saves all messages received via callbacks:
+std::mutex rxMtx;
+std::vector<std::string> rxMsgs;
+std::vector<std::thread::id> rxThreads;
+
+void rxCallback(
+	std::string_view msg, const VerbosityLevel, std::string_view,
+	const mrpt::Clock::time_point)
+{
+	std::lock_guard<std::mutex> lck(rxMtx);
+	rxMsgs.emplace_back(msg);
+	rxThreads.push_back(std::this_thread::get_id());
+}
+
+void throwingCallback(
+	std::string_view, const VerbosityLevel, std::string_view,
+	const mrpt::Clock::time_point)
+{
+	throw std::runtime_error("callback error");
+}
+
+// Blocks the async logger thread while locked:
+std::mutex blockMtx;
+void blockingCallback(
+	std::string_view, const VerbosityLevel, std::string_view,
+	const mrpt::Clock::time_point)
+{
+	std::lock_guard<std::mutex> lck(blockMtx);
+}
+}  // namespace
+
+TEST(COutputLogger, boundedHistory)
+{
+	for (const bool async : {false, true})
+	{
+		COutputLogger logger("test");
+		logger.logEnableAsyncMode(async);
+		logger.logging_enable_console_output = false;
+		logger.logging_enable_keep_record = true;
+		logger.logging_max_history_size = 10;
+
+		for (int i = 0; i < 100; i++)
+			logger.logFmt(mrpt::system::LVL_INFO, "msg #%i\n", i);
+
+		const std::string s = logger.getLogAsString();
+		EXPECT_EQ(std::count(s.begin(), s.end(), '\n'), 10);
+		EXPECT_EQ(s.find("msg #89\n"), std::string::npos);
+		EXPECT_NE(s.find("msg #90\n"), std::string::npos);
+		EXPECT_NE(
+			logger.getLoggerLastMsg().find("msg #99"), std::string::npos);
+	}
+}
+
+TEST(COutputLogger, asyncCallbacksInOrder)
+{
+	{
+		std::lock_guard<std::mutex> lck(rxMtx);
+		rxMsgs.clear();
+		rxThreads.clear();
+	}
+	COutputLogger logger("test");
+	logger.logEnableAsyncMode();
+	EXPECT_TRUE(logger.logIsAsyncModeEnabled());
+	logger.setMinLoggingLevel(mrpt::system::LVL_ERROR);
+	logger.logRegisterCallback(&rxCallback);
+
+	// Two threads, with their messages in order:
+	auto task = [&logger](const char* prefix) {
+		for (int i = 0; i < 20; i++)
+			logger.logFmt(mrpt::system::LVL_ERROR, "%s%i", prefix, i);
+		// Not visible, so not sent to callbacks:
+		logger.logStr(mrpt::system::LVL_INFO, "hidden");
+	};
+	std::thread t1(task, "A"), t2(task, "B");
+	t1.join();
+	t2.join();
+	logger.logFlush();
+
+	{
+		std::lock_guard<std::mutex> lck(rxMtx);
+		ASSERT_EQ(rxMsgs.size(), 40U);
+		for (const char* prefix : {"A", "B"})
+		{
+			int next = 0;
+			for (const auto& m : rxMsgs)
+				if (m[0] == prefix[0])
+					EXPECT_EQ(m, mrpt::format("%s%i", prefix, next++));
+			EXPECT_EQ(next, 20);
+		}
+		// Callbacks are invoked from the background thread:
+		for (const auto& id : rxThreads)
+			EXPECT_NE(id, std::this_thread::get_id());
+	}
+
+	EXPECT_TRUE(logger.logDeregisterCallback(&rxCallback));
+	logger.logEnableAsyncMode(false);
+	EXPECT_FALSE(logger.logIsAsyncModeEnabled());
+}
+
+TEST(COutputLogger, asyncDropsWhenQueueIsFull)
+{
+	// A logger whose callback blocks the background thread:
+	COutputLogger blocker("blocker");
+	blocker.logEnableAsyncMode();
+	blocker.setMinLoggingLevel(mrpt::system::LVL_ERROR);
+	blocker.logRegisterCallback(&blockingCallback);
+
+	COutputLogger logger("test");
+	logger.logEnableAsyncMode();
+	logger.logging_enable_console_output = false;
+	logger.logging_enable_keep_record = true;
+
+	const size_t N = COutputLogger::getAsyncStats().queue_capacity + 100;
+	{
+		std::lock_guard<std::mutex> lck(blockMtx);
+		blocker.logStr(mrpt::system::LVL_ERROR, "blocking");
+		for (size_t i = 0; i < N; i++)
+			logger.logStr(mrpt::system::LVL_INFO, "msg");
+		EXPECT_GT(logger.logGetDroppedMessages(), 0U);
+		EXPECT_EQ(blocker.logGetDroppedMessages(), 0U);
+	}
+
+	const std::string s = logger.getLogAsString();
+	const auto nSaved =
+		static_cast<size_t>(std::count(s.begin(), s.end(), '\n'));
+	EXPECT_EQ(nSaved + logger.logGetDroppedMessages(), N);
+	EXPECT_GE(COutputLogger::getAsyncStats().dropped, 100U);
+	EXPECT_TRUE(blocker.logDeregisterCallback(&blockingCallback));
+}
+
+TEST(COutputLogger, callbackExceptions)
+{
+	for (const bool async : {false, true})
+	{
+		{
+			std::lock_guard<std::mutex> lck(rxMtx);
+			rxMsgs.clear();
+		}
+		COutputLogger logger("test");
+		logger.logEnableAsyncMode(async);
+		logger.logging_enable_console_output = true;
+		logger.setMinLoggingLevel(mrpt::system::LVL_ERROR);
+		logger.logRegisterCallback(&throwingCallback);
+		logger.logRegisterCallback(&rxCallback);
+
+		if (async)
+		{
+			// Reported to std::cerr, the next callback is still invoked:
+			EXPECT_NO_THROW(logger.logStr(mrpt::system::LVL_ERROR, "msg"));
+			logger.logFlush();
+			std::lock_guard<std::mutex> lck(rxMtx);
+			EXPECT_EQ(rxMsgs.size(), 1U);
+		}
+		else
+		{
+			// Propagated to the caller:
+			EXPECT_THROW(
+				logger.logStr(mrpt::system::LVL_ERROR, "msg"),
+				std::runtime_error);
+			std::lock_guard<std::mutex> lck(rxMtx);
+			EXPECT_EQ(rxMsgs.size(), 0U);
+		}
+	}
+}
+
+TEST(COutputLogger, asyncNoCallbacksAfterDestruction)
+{
+	// A logger whose callback blocks the background thread:
+	COutputLogger blocker("blocker");
+	blocker.logEnableAsyncMode();
+	blocker.setMinLoggingLevel(mrpt::system::LVL_ERROR);
+	blocker.logRegisterCallback(&blockingCallback);
+
+	std::atomic_bool destroyed{false};
+	std::atomic<int> calls{0}, lateCalls{0};
+
+	auto logger = std::make_unique<COutputLogger>("test");
+	logger->logEnableAsyncMode();
+	logger->logging_enable_console_output = true;
+	logger->setMinLoggingLevel(mrpt::system::LVL_ERROR);
+	logger->logRegisterCallback(
+		[&](std::string_view, const VerbosityLevel, std::string_view,
+			const mrpt::Clock::time_point) {
+			calls++;
+			if (destroyed) lateCalls++;
+		});
+
+	std::thread destroyer;
+	{
+		std::lock_guard<std::mutex> lck(blockMtx);
+		blocker.logStr(mrpt::system::LVL_ERROR, "blocking");
+		for (int i = 0; i < 10; i++)
+			logger->logStr(mrpt::system::LVL_ERROR, "queued");
+
+		// Destroy the logger while its messages are still queued:
+		destroyer = std::thread([&]() {
+			logger.reset();
+			destroyed = true;
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		EXPECT_FALSE(destroyed);
+	}
+	destroyer.join();
+
+	// Make sure the queue is empty before checking:
+	blocker.logStr(mrpt::system::LVL_ERROR, "end");
+	blocker.logFlush();
+
+	EXPECT_EQ(calls, 10);
+	EXPECT_EQ(lateCalls, 0);
+	EXPECT_TRUE(blocker.logDeregisterCallback(&blockingCallback));
+}
+
+TEST(COutputLogger, asyncCopiesHaveTheirOwnCallbacks)
+{
+	{
+		std::lock_guard<std::mutex> lck(rxMtx);
+		rxMsgs.clear();
+	}
+	COutputLogger logger("test");
+	logger.logEnableAsyncMode();
+	logger.setMinLoggingLevel(mrpt::system::LVL_ERROR);
+	logger.logRegisterCallback(&rxCallback);
+
+	// Destroying a copy does not affect the original:
+	{
+		const COutputLogger tmp = logger;
+	}
+	// Nor (de)registering callbacks in a copy:
+	{
+		COutputLogger copy = logger;
+		copy.logRegisterCallback(&blockingCallback);
+		EXPECT_TRUE(copy.logDeregisterCallback(&rxCallback));
+		EXPECT_FALSE(copy.logDeregisterCallback(&rxCallback));
+		copy.logStr(mrpt::system::LVL_ERROR, "copy");
+	}
+
+	logger.logStr(mrpt::system::LVL_ERROR, "original");
+	logger.logFlush();
+	{
+		std::lock_guard<std::mutex> lck(rxMtx);
+		ASSERT_EQ(rxMsgs.size(), 1U);
+		EXPECT_EQ(rxMsgs[0], "original");
+	}
+	EXPECT_TRUE(logger.logDeregisterCallback(&rxCallback));
+}
@@ -0,0 +1,328 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include "system-precomp.h"	 // Precompiled headers
+//
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/system/CPeriodicTaskExecutor.h>
+#include <mrpt/system/scheduler.h>
+#include <mrpt/system/thread_name.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+using namespace mrpt::system;
+
+namespace
+{
+double toSeconds(std::chrono::steady_clock::duration d)
+{
+	return std::chrono::duration<double>(d).count();
+}
+
+void addToHistogram(std::vector<uint64_t>& h, double binWidth, double val)
+{
+	if (h.empty()) return;
+	const auto bin = static_cast<size_t>(std::max(.0, val) / binWidth);
+	h[std::min(bin, h.size() - 1)]++;
+}
+}  // namespace
+
+CPeriodicTaskExecutor::CPeriodicTaskExecutor()
+	: CPeriodicTaskExecutor(TParameters())
+{
+}
+
+CPeriodicTaskExecutor::CPeriodicTaskExecutor(const TParameters& params)
+	: COutputLogger("CPeriodicTaskExecutor")
+{
+	setParameters(params);
+}
+
+CPeriodicTaskExecutor::~CPeriodicTaskExecutor() { stop(); }
+
+void CPeriodicTaskExecutor::setParameters(const TParameters& params)
+{
+	ASSERTMSG_(!isRunning(), "Cannot change parameters while running");
+	ASSERT_GE_(params.numThreads, 1U);
+	m_params = params;
+}
+
+void CPeriodicTaskExecutor::resetStats(TTask& t)
+{
+	const size_t nBins = t.opts.histogramBins;
+
+	t.stats = TTaskStats();
+	t.stats.name = t.opts.name;
+	t.stats.period = t.opts.period;
+	t.stats.deadline = toSeconds(t.deadline);
+	t.stats.histogramBinWidth = t.opts.histogramBinWidth > 0
+		? t.opts.histogramBinWidth
+		: t.opts.period / nBins;
+	t.stats.latencyHistogram.assign(nBins, 0);
+	t.stats.overrunHistogram.assign(nBins, 0);
+	t.latencySum = 0;
+	t.execSum = 0;
+}
+
+CPeriodicTaskExecutor::task_id_t CPeriodicTaskExecutor::addTask(
+	const TTaskOptions& opts, const task_t& task)
+{
+	ASSERT_GT_(opts.period, .0);
+	ASSERT_GE_(opts.deadline, .0);
+	ASSERT_GE_(opts.phase, .0);
+	ASSERT_GE_(opts.histogramBins, 1U);
+	ASSERT_GE_(opts.histogramBinWidth, .0);
+	ASSERT_(task);
+
+	const auto fromSeconds = [](double s) {
+		return std::chrono::duration_cast<steady_clock_t::duration>(
+			std::chrono::duration<double>(s));
+	};
+
+	std::lock_guard<std::mutex> lck(m_mtx);
+	const task_id_t id = m_nextId++;
+	TTask& t = m_tasks[id];
+	t.opts = opts;
+	t.func = task;
+	t.period = fromSeconds(opts.period);
+	t.deadline = fromSeconds(opts.deadline > 0 ? opts.deadline : opts.period);
+	t.nextRelease = steady_clock_t::now() + fromSeconds(opts.phase);
+	resetStats(t);
+
+	m_cv.notify_all();
+	return id;
+}
+
+bool CPeriodicTaskExecutor::removeTask(task_id_t id)
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	auto it = m_tasks.find(id);
+	if (it == m_tasks.end() || it->second.removed) return false;
+
+	// If running, it will be deleted by its worker thread once done:
+	if (it->second.running)
+		it->second.removed = true;
+	else
+		m_tasks.erase(it);
+	return true;
+}
+
+void CPeriodicTaskExecutor::start()
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	if (m_running) return;
+	m_running = true;
+
+	const auto now = steady_clock_t::now();
+	for (auto& e : m_tasks)
+	{
+		TTask& t = e.second;
+		t.nextRelease = now +
+			std::chrono::duration_cast<steady_clock_t::duration>(
+							std::chrono::duration<double>(t.opts.phase));
+	}
+
+	for (size_t i = 0; i < m_params.numThreads; i++)
+		m_threads.emplace_back(&CPeriodicTaskExecutor::workerThread, this, i);
+}
+
+void CPeriodicTaskExecutor::stop()
+{
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		m_running = false;
+		m_cv.notify_all();
+	}
+	for (auto& th : m_threads)
+		if (th.joinable()) th.join();
+	m_threads.clear();
+}
+
+bool CPeriodicTaskExecutor::isRunning() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_running;
+}
+
+void CPeriodicTaskExecutor::workerThread(size_t index)
+{
+	thread_name(
+		mrpt::format("%s%u", m_params.threadName.c_str(), unsigned(index)));
+
+	if (!m_params.cpuAffinity.empty() &&
+		!changeCurrentThreadAffinity(m_params.cpuAffinity))
+		MRPT_LOG_WARN("Could not set the CPU affinity of worker threads");
+
+	if (m_params.realTimePriority > 0 &&
+		!changeCurrentThreadRealTimePriority(m_params.realTimePriority))
+		MRPT_LOG_WARN_FMT(
+			"Could not set SCHED_FIFO priority %i for worker threads (not "
+			"enough permissions?)",
+			m_params.realTimePriority);
+
+	std::unique_lock<std::mutex> lck(m_mtx);
+	while (m_running)
+	{
+		// EDF: pick the released task with the earliest absolute deadline:
+		const auto now = steady_clock_t::now();
+		auto best = m_tasks.end();
+		auto nextWakeUp = steady_clock_t::time_point::max();
+		for (auto it = m_tasks.begin(); it != m_tasks.end(); ++it)
+		{
+			const TTask& t = it->second;
+			if (t.running || t.removed) continue;
+			if (t.nextRelease > now)
+			{
+				nextWakeUp = std::min(nextWakeUp, t.nextRelease);
+				continue;
+			}
+			if (best == m_tasks.end() ||
+				t.nextRelease + t.deadline <
+					best->second.nextRelease + best->second.deadline)
+				best = it;
+		}
+
+		if (best == m_tasks.end())
+		{
+			if (nextWakeUp == steady_clock_t::time_point::max())
+				m_cv.wait(lck);
+			else
+				m_cv.wait_until(lck, nextWakeUp);
+			continue;
+		}
+
+		// std::map nodes are not invalidated by insertions or erasures of
+		// other tasks, and this one cannot be erased while running:
+		TTask& t = best->second;
+		const task_id_t id = best->first;
+		const auto release = t.nextRelease;
+		t.running = true;
+		lck.unlock();
+
+		const auto tStart = steady_clock_t::now();
+		try
+		{
+			t.func();
+		}
+		catch (const std::exception& e)
+		{
+			MRPT_LOG_ERROR_STREAM(
+				"Exception in task '" << t.opts.name
+									  << "':\n" << mrpt::exception_to_str(e));
+		}
+		const auto tEnd = steady_clock_t::now();
+
+		lck.lock();
+		t.running = false;
+		if (t.removed)
+			m_tasks.erase(id);
+		else
+			onTaskDone(t, release, tStart, tEnd);
+
+		// Its next release may be earlier than other threads wake-up times:
+		m_cv.notify_all();
+	}
+}
+
+void CPeriodicTaskExecutor::onTaskDone(
+	TTask& t, steady_clock_t::time_point release,
+	steady_clock_t::time_point start, steady_clock_t::time_point end)
+{
+	TTaskStats& s = t.stats;
+	const double latency = toSeconds(start - release);
+	const double exec = toSeconds(end - start);
+
+	if (s.executions == 0)
+	{
+		s.latencyMin = s.latencyMax = latency;
+		s.execMin = s.execMax = exec;
+	}
+	s.executions++;
+	s.latencyMin = std::min(s.latencyMin, latency);
+	s.latencyMax = std::max(s.latencyMax, latency);
+	s.execMin = std::min(s.execMin, exec);
+	s.execMax = std::max(s.execMax, exec);
+	t.latencySum += latency;
+	t.execSum += exec;
+	s.latencyMean = t.latencySum / s.executions;
+	s.execMean = t.execSum / s.executions;
+	addToHistogram(s.latencyHistogram, s.histogramBinWidth, latency);
+
+	const auto absDeadline = release + t.deadline;
+	if (end > absDeadline)
+	{
+		s.overruns++;
+		addToHistogram(
+			s.overrunHistogram, s.histogramBinWidth,
+			toSeconds(end - absDeadline));
+	}
+
+	// Next release, skipping whole periods already missed:
+	auto next = release + t.period;
+	if (next + t.period <= end)
+	{
+		const auto missed = (end - next) / t.period;
+		next += missed * t.period;
+		s.skipped += static_cast<uint64_t>(missed);
+	}
+	t.nextRelease = next;
+}
+
+CPeriodicTaskExecutor::TTaskStats CPeriodicTaskExecutor::getTaskStats(
+	task_id_t id) const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	auto it = m_tasks.find(id);
+	ASSERTMSG_(
+		it != m_tasks.end(), mrpt::format("Unknown task ID: %u", unsigned(id)));
+	return it->second.stats;
+}
+
+std::vector<CPeriodicTaskExecutor::TTaskStats>
+	CPeriodicTaskExecutor::getAllTaskStats() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	std::vector<TTaskStats> ret;
+	ret.reserve(m_tasks.size());
+	for (const auto& e : m_tasks)
+		if (!e.second.removed) ret.push_back(e.second.stats);
+	return ret;
+}
+
+void CPeriodicTaskExecutor::resetStats()
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	for (auto& e : m_tasks)
+		resetStats(e.second);
+}
+
+std::string CPeriodicTaskExecutor::getStatsAsText() const
+{
+	std::stringstream ss;
+	ss << mrpt::format(
+		"%-20s %9s %9s %8s %8s %25s %25s\n", "Task", "Period", "Execs",
+		"Overruns", "Skipped", "Latency min/mean/max", "Exec min/mean/max");
+	for (const auto& s : getAllTaskStats())
+	{
+		ss << mrpt::format(
+			"%-20s %9.3f %9lu %8lu %8lu %7.3f/%7.3f/%9.3f "
+				"%7.3f/%7.3f/%9.3f\n",
+			s.name.c_str(), 1e3 * s.period,
+			static_cast<unsigned long>(s.executions),
+			static_cast<unsigned long>(s.overruns),
+			static_cast<unsigned long>(s.skipped), 1e3 * s.latencyMin,
+			1e3 * s.latencyMean, 1e3 * s.latencyMax, 1e3 * s.execMin,
+			1e3 * s.execMean, 1e3 * s.execMax);
+	}
+	ss << "(All times in milliseconds)\n";
+	return ss.str();
+}
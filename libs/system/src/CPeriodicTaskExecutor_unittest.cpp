@@ -0,0 +1,137 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/system/CPeriodicTaskExecutor.h>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+using mrpt::system::CPeriodicTaskExecutor;
+using namespace std::chrono_literals;
+
+TEST(CPeriodicTaskExecutor, periodicRates)
+{
+	CPeriodicTaskExecutor::TParameters p;
+	p.numThreads = 2;
+	CPeriodicTaskExecutor exec(p);
+
+	std::atomic_int cnt1{0}, cnt2{0};
+	CPeriodicTaskExecutor::TTaskOptions o;
+	o.name = "fast";
+	o.period = 0.01;
+	const auto id1 = exec.addTask(o, [&]() { cnt1++; });
+	o.name = "slow";
+	o.period = 0.05;
+	const auto id2 = exec.addTask(o, [&]() { cnt2++; });
+
+	const auto t0 = std::chrono::steady_clock::now();
+	exec.start();
+	EXPECT_TRUE(exec.isRunning());
+	std::this_thread::sleep_for(500ms);
+	exec.stop();
+	const double elapsed = std::chrono::duration<double>(
+							   std::chrono::steady_clock::now() - t0)
+							   .count();
+	EXPECT_FALSE(exec.isRunning());
+
+	// At most one execution per release (the first one at start()), however
+	// long the test thread slept. Be very tolerant with loaded CI machines
+	// regarding the minimum:
+	const auto checkCount = [elapsed](int cnt, double period) {
+		const double releases = elapsed / period;
+		EXPECT_LE(cnt, static_cast<int>(releases) + 1) << "T=" << period;
+		EXPECT_GE(cnt, static_cast<int>(releases / 4)) << "T=" << period;
+	};
+	checkCount(cnt1.load(), 0.01);
+	checkCount(cnt2.load(), 0.05);
+
+	const auto s1 = exec.getTaskStats(id1);
+	EXPECT_EQ(s1.name, "fast");
+	EXPECT_EQ(s1.executions, uint64_t(cnt1));
+	EXPECT_NEAR(s1.deadline, 0.01, 1e-6);
+	EXPECT_LE(s1.latencyMin, s1.latencyMean);
+	EXPECT_LE(s1.latencyMean, s1.latencyMax);
+	EXPECT_EQ(
+		std::accumulate(
+			s1.latencyHistogram.begin(), s1.latencyHistogram.end(),
+			uint64_t(0)),
+		s1.executions);
+	EXPECT_EQ(exec.getTaskStats(id2).executions, uint64_t(cnt2));
+
+	EXPECT_EQ(exec.getAllTaskStats().size(), 2U);
+	EXPECT_NE(exec.getStatsAsText().find("slow"), std::string::npos);
+
+	EXPECT_TRUE(exec.removeTask(id1));
+	EXPECT_FALSE(exec.removeTask(id1));
+	EXPECT_THROW(exec.getTaskStats(id1), std::exception);
+}
+
+TEST(CPeriodicTaskExecutor, earliestDeadlineFirst)
+{
+	CPeriodicTaskExecutor exec;  // 1 thread
+	std::vector<int> order;
+	std::mutex orderMtx;
+
+	// Released at the same time, different deadlines:
+	CPeriodicTaskExecutor::TTaskOptions o;
+	o.period = 10.0;
+	o.phase = 0.05;
+	for (int i : {3, 1, 2})
+	{
+		o.deadline = 0.1 * i;
+		exec.addTask(o, [&, i]() {
+			std::lock_guard<std::mutex> lck(orderMtx);
+			order.push_back(i);
+		});
+	}
+	exec.start();
+	std::this_thread::sleep_for(300ms);
+	exec.stop();
+
+	std::lock_guard<std::mutex> lck(orderMtx);
+	EXPECT_EQ(order, std::vector<int>({1, 2, 3}));
+}
+
+TEST(CPeriodicTaskExecutor, overrunsAndSkips)
+{
+	CPeriodicTaskExecutor exec;
+	CPeriodicTaskExecutor::TTaskOptions o;
+	o.name = "late";
+	o.period = 0.02;
+	o.deadline = 0.01;
+	const auto id =
+		exec.addTask(o, []() { std::this_thread::sleep_for(50ms); });
+	exec.start();
+	std::this_thread::sleep_for(300ms);
+	exec.stop();
+
+	const auto s = exec.getTaskStats(id);
+	ASSERT_GE(s.executions, 2U);
+	EXPECT_EQ(s.overruns, s.executions);
+	EXPECT_GE(s.skipped, s.executions);
+	EXPECT_GE(s.execMin, 0.045);
+	// All overruns are >=40 ms: in the last bin (1 ms wide bins)
+	EXPECT_EQ(s.overrunHistogram.back(), s.overruns);
+
+	exec.resetStats();
+	EXPECT_EQ(exec.getTaskStats(id).executions, 0U);
+}
+
+TEST(CPeriodicTaskExecutor, invalidOptions)
+{
+	CPeriodicTaskExecutor exec;
+	CPeriodicTaskExecutor::TTaskOptions o;
+	o.period = 0;
+	EXPECT_THROW(exec.addTask(o, []() {}), std::exception);
+	o.period = 1;
+	EXPECT_THROW(exec.addTask(o, nullptr), std::exception);
+}
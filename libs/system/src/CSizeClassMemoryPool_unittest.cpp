@@ -0,0 +1,151 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          https://www.mrpt.org/                         |
+   |                                                                        |
+   | Copyright (c) 2005-2022, Individual contributors, see AUTHORS file     |
+   | See: https://www.mrpt.org/Authors - All rights reserved.               |
+   | Released under BSD License. See: https://www.mrpt.org/License          |
+   +------------------------------------------------------------------------+ */
+
+#include <gtest/gtest.h>
+#include <mrpt/system/CSizeClassMemoryPool.h>
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct TestParams
+{
+	size_t len = 0;
+	size_t size() const { return len; }
+	bool isSuitable(const TestParams& req) const { return len >= req.len; }
+};
+struct TestData
+{
+	std::vector<uint8_t> buf;
+};
+
+// A different pool per test, to have independent statistics:
+template <int ID>
+struct TestParamsN : public TestParams
+{
+};
+template <int ID>
+using pool_t = mrpt::system::CSizeClassMemoryPool<TestParamsN<ID>, TestData>;
+
+template <int ID>
+TestParamsN<ID> params(size_t len)
+{
+	TestParamsN<ID> p;
+	p.len = len;
+	return p;
+}
+
+template <int ID>
+TestData* newBlock(size_t len)
+{
+	auto* b = new TestData;
+	b->buf.resize(len);
+	return b;
+}
+}  // namespace
+
+TEST(CSizeClassMemoryPool, sizeClassOf)
+{
+	using pool = pool_t<0>;
+	EXPECT_EQ(pool::sizeClassOf(0), 0U);
+	EXPECT_EQ(pool::sizeClassOf(1), 0U);
+	EXPECT_EQ(pool::sizeClassOf(2), 1U);
+	EXPECT_EQ(pool::sizeClassOf(1023), 9U);
+	EXPECT_EQ(pool::sizeClassOf(1024), 10U);
+}
+
+TEST(CSizeClassMemoryPool, localReuse)
+{
+	auto* pool = pool_t<1>::getInstance();
+	ASSERT_TRUE(pool != nullptr);
+	EXPECT_EQ(pool->request_memory(params<1>(1000)), nullptr);
+
+	TestData* b = newBlock<1>(1000);
+	const uint8_t* mem = b->buf.data();
+	pool->dump_to_pool(params<1>(1000), b);
+
+	// Too large for the block:
+	EXPECT_EQ(pool->request_memory(params<1>(1001)), nullptr);
+	// Smaller requests, in the same or the previous size class, are fine:
+	TestData* b2 = pool->request_memory(params<1>(600));
+	ASSERT_EQ(b2, b);
+	EXPECT_EQ(b2->buf.data(), mem);
+	delete b2;
+
+	const auto st = pool->getStats();
+	EXPECT_EQ(st.requests, 3U);
+	EXPECT_EQ(st.local_hits, 1U);
+	EXPECT_EQ(st.shared_hits, 0U);
+	EXPECT_EQ(st.misses(), 2U);
+	EXPECT_EQ(st.donations, 1U);
+}
+
+TEST(CSizeClassMemoryPool, crossThreadReuse)
+{
+	auto* pool = pool_t<2>::getInstance();
+	pool->setMaxLocalEntriesPerClass(2);
+	pool->setMaxSharedEntriesPerClass(3);
+
+	// Blocks freed in other threads go to the shared depot, either when the
+	// thread cache is full or when the thread exits:
+	std::thread t([pool]() {
+		for (int i = 0; i < 10; i++)
+			pool->dump_to_pool(params<2>(4096), newBlock<2>(4096));
+	});
+	t.join();
+
+	auto st = pool->getStats();
+	EXPECT_EQ(st.donations, 10U);
+	EXPECT_EQ(st.discarded, 7U);
+
+	for (int i = 0; i < 3; i++)
+	{
+		TestData* b = pool->request_memory(params<2>(4096));
+		ASSERT_TRUE(b != nullptr);
+		EXPECT_EQ(b->buf.size(), 4096U);
+		delete b;
+	}
+	EXPECT_EQ(pool->request_memory(params<2>(4096)), nullptr);
+
+	st = pool->getStats();
+	EXPECT_EQ(st.shared_hits, 3U);
+	EXPECT_EQ(st.local_hits, 0U);
+	EXPECT_EQ(st.requests, 4U);
+}
+
+TEST(CSizeClassMemoryPool, producerConsumer)
+{
+	auto* pool = pool_t<3>::getInstance();
+	const int N = 1000;
+
+	// Each thread allocates and frees blocks of different size classes:
+	auto task = [pool](size_t len) {
+		for (int i = 0; i < N; i++)
+		{
+			TestData* b = pool->request_memory(params<3>(len));
+			if (!b) b = newBlock<3>(len);
+			EXPECT_GE(b->buf.size(), len);
+			b->buf[len - 1] = 1;
+			pool->dump_to_pool(params<3>(b->buf.size()), b);
+		}
+	};
+	std::vector<std::thread> threads;
+	for (size_t len : {100, 1000, 1000, 100000})
+		threads.emplace_back(task, len);
+	for (auto& t : threads)
+		t.join();
+
+	const auto st = pool->getStats();
+	EXPECT_EQ(st.requests, 4U * N);
+	EXPECT_EQ(st.donations, 4U * N);
+	// At most one allocation per thread:
+	EXPECT_LE(st.misses(), 4U);
+	pool->clear();
+}
@@ -15,10 +15,19 @@
 #include <mrpt/system/datetime.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/string_utils.h>
+#include <mrpt/system/thread_name.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 using namespace mrpt;
 using namespace mrpt::system;
@@ -31,7 +40,7 @@ struct MyGlobalProfiler : public mrpt::system::CTimeLogger
 	{
 		try
 		{
-			if (!m_data.empty())
+			if (!m_data.empty() || hasProfilerData())
 			{
 				const std::string sFil("mrpt-global-profiler.csv");
 				this->saveToCSVFile(sFil);
@@ -63,6 +72,648 @@ void global_profiler_leave(const char* func_name) noexcept
 }
 }  // namespace mrpt::system
 
+std::string aux_format_string_multilines(const std::string& s, const size_t len);
+
+// ------------------------------------------------------------------------
+//  Profiler mode
+// ------------------------------------------------------------------------
+namespace
+{
+inline uint64_t profilerNow() noexcept
+{
+	return static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch())
+			.count());
+}
+
+// Global table of interned section names. Never destroyed, so it can be used
+// from the destructors of static CTimeLogger objects.
+struct SectionRegistry
+{
+	std::mutex mtx;
+	// Names are stored in a deque so their addresses never change:
+	std::deque<std::string> names;
+	std::unordered_map<std::string_view, uint32_t> ids;
+
+	static SectionRegistry& Instance()
+	{
+		static auto* r = new SectionRegistry();
+		return *r;
+	}
+
+	uint32_t intern(const std::string_view& name, const std::string*& stored)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		if (auto it = ids.find(name); it != ids.end())
+		{
+			stored = &names[it->second];
+			return it->second;
+		}
+		const auto id = static_cast<uint32_t>(names.size());
+		names.emplace_back(name);
+		ids.emplace(names.back(), id);
+		stored = &names.back();
+		return id;
+	}
+
+	std::optional<uint32_t> find(const std::string_view& name)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		if (auto it = ids.find(name); it != ids.end()) return it->second;
+		return {};
+	}
+
+	// Views remain valid since names are never removed:
+	std::vector<std::string_view> snapshot()
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		return {names.begin(), names.end()};
+	}
+};
+
+// Per-thread cache of name => ID, indexed by the address of the name buffer,
+// and verified against the stored name, so the mutex of the registry is only
+// locked the first time a call site is seen.
+struct InternCacheEntry
+{
+	const char* ptr{nullptr};
+	const std::string* name{nullptr};
+	uint32_t id{0};
+};
+thread_local std::array<InternCacheEntry, 256> tlInternCache;
+
+uint32_t internSectionCached(const std::string_view& name)
+{
+	auto& e = tlInternCache
+		[((reinterpret_cast<uintptr_t>(name.data()) >> 3) ^ name.size()) &
+		 (tlInternCache.size() - 1)];
+	if (e.ptr == name.data() && e.name && name == *e.name) return e.id;
+
+	e.id = SectionRegistry::Instance().intern(name, e.name);
+	e.ptr = name.data();
+	return e.id;
+}
+
+std::string jsonEscape(const std::string_view& s)
+{
+	std::string r;
+	r.reserve(s.size());
+	for (const char c : s)
+	{
+		switch (c)
+		{
+			case '"': r += "\\\""; break;
+			case '\\': r += "\\\\"; break;
+			case '\n': r += "\\n"; break;
+			case '\t': r += "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+					r += mrpt::format("\\u%04x", static_cast<unsigned>(c));
+				else
+					r += c;
+		}
+	}
+	return r;
+}
+
+std::atomic<uint64_t> profilerUidCounter{0};
+}  // namespace
+
+/** A single-producer (the owner thread), single-consumer (the aggregator)
+ * ring buffer of enter/leave events. */
+struct CTimeLogger::ProfilerBuffer
+{
+	enum EventKind : uint32_t
+	{
+		EV_ENTER = 0,
+		EV_LEAVE
+	};
+	struct Event
+	{
+		uint64_t t;
+		uint32_t id;
+		uint32_t kind;
+	};
+
+	ProfilerBuffer(size_t capacity, uint32_t index)
+		: events(mrpt::round2up(std::max<size_t>(capacity, 16))),
+		  mask(events.size() - 1),
+		  threadIndex(index)
+	{
+		open.reserve(64);
+	}
+
+	std::vector<Event> events;
+	const uint64_t mask;
+
+	// Written by the owner thread:
+	alignas(64) std::atomic<uint64_t> head{0};
+	std::atomic<uint64_t> dropped{0};
+	// Set by the owner thread upon exit, after its last event:
+	std::atomic<bool> ownerExited{false};
+	// Written by the aggregator:
+	alignas(64) std::atomic<uint64_t> tail{0};
+
+	// Only accessed by the owner thread: the stack of open scopes, and the
+	// number of slots reserved for their leave events.
+	struct OpenScope
+	{
+		uint32_t id;
+		bool recorded;
+		uint64_t t;
+	};
+	std::vector<OpenScope> open;
+	uint64_t reserved{0};
+
+	// Only accessed by the aggregator: call tree nodes and entry times of
+	// the open scopes of this thread.
+	std::vector<std::pair<uint32_t, uint64_t>> aggStack;
+
+	const uint32_t threadIndex;
+
+	inline void push(uint64_t h, uint64_t t, uint32_t id, uint32_t kind)
+	{
+		events[h & mask] = {t, id, kind};
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	void enter(uint32_t id) noexcept
+	{
+		const uint64_t t = profilerNow();
+		const uint64_t h = head.load(std::memory_order_relaxed);
+		const uint64_t used = h - tail.load(std::memory_order_acquire);
+		// Only record the scope if there is room for its leave event too,
+		// so the aggregator always sees balanced pairs:
+		const bool recorded = used + reserved + 2 <= events.size();
+		if (recorded)
+		{
+			push(h, t, id, EV_ENTER);
+			reserved++;
+		}
+		else
+			dropped.store(
+				dropped.load(std::memory_order_relaxed) + 1,
+				std::memory_order_relaxed);
+		open.push_back({id, recorded, t});
+	}
+
+	double leave(uint32_t id) noexcept
+	{
+		const uint64_t t = profilerNow();
+		// Normally, the innermost scope:
+		size_t k = open.size();
+		while (k > 0 && open[k - 1].id != id)
+			k--;
+		if (k == 0) return 0;  // leave() without enter()
+
+		// Also close inner scopes without a leave() call, if any:
+		double dt = 0;
+		while (open.size() >= k)
+		{
+			const OpenScope s = open.back();
+			open.pop_back();
+			if (s.recorded)
+			{
+				push(head.load(std::memory_order_relaxed), t, s.id, EV_LEAVE);
+				reserved--;
+			}
+			dt = (t - s.t) * 1e-9;
+		}
+		return dt;
+	}
+};
+
+struct CTimeLogger::ProfilerImpl
+	: public std::enable_shared_from_this<CTimeLogger::ProfilerImpl>
+{
+	explicit ProfilerImpl(const TProfilerOptions& o)
+		: opts(o), uid(++profilerUidCounter), t0(profilerNow())
+	{
+		nodes.emplace_back();  // root
+		if (opts.aggregationPeriod > 0)
+		{
+			aggThread = std::thread([this]() { aggregatorLoop(); });
+			mrpt::system::thread_name("CTimeLoggerAgg", aggThread);
+		}
+	}
+	~ProfilerImpl()
+	{
+		{
+			std::lock_guard<std::mutex> lck(aggThreadMtx);
+			aggThreadExit = true;
+		}
+		aggThreadCV.notify_all();
+		if (aggThread.joinable()) aggThread.join();
+	}
+	ProfilerImpl(const ProfilerImpl&) = delete;
+	ProfilerImpl& operator=(const ProfilerImpl&) = delete;
+
+	const TProfilerOptions opts;
+	const uint64_t uid;
+	const uint64_t t0;
+
+	struct Stats
+	{
+		size_t n_calls{0};
+		uint64_t total{0}, min{0}, max{0}, last{0};
+
+		void add(uint64_t dt)
+		{
+			if (n_calls++ == 0) min = max = dt;
+			else
+			{
+				mrpt::keep_min(min, dt);
+				mrpt::keep_max(max, dt);
+			}
+			total += dt;
+			last = dt;
+		}
+	};
+	struct Node
+	{
+		uint32_t section{0};
+		uint32_t parent{0};
+		std::vector<uint32_t> children;
+		Stats stats;
+	};
+	struct TraceEvent
+	{
+		uint32_t section;
+		uint32_t thread;
+		uint64_t start, duration;
+	};
+
+	// All these are protected by mtx:
+	std::mutex mtx;
+	std::vector<std::shared_ptr<ProfilerBuffer>> buffers;
+	// Indexed by threadIndex-1. Kept after the buffers of exited threads are
+	// released, for the trace:
+	std::vector<std::string> threadNames;
+	uint64_t retiredDropped{0};	 //!< dropped events of released buffers
+	std::vector<Node> nodes;  //!< [0] is the root
+	std::vector<Stats> flat;  //!< indexed by section ID
+	std::deque<TraceEvent> trace;
+
+	std::thread aggThread;
+	std::mutex aggThreadMtx;
+	std::condition_variable aggThreadCV;
+	bool aggThreadExit{false};
+
+	void aggregatorLoop()
+	{
+		const auto period = std::chrono::duration<double>(opts.aggregationPeriod);
+		std::unique_lock<std::mutex> lck(aggThreadMtx);
+		while (!aggThreadCV.wait_for(
+			lck, period, [this]() { return aggThreadExit; }))
+		{
+			lck.unlock();
+			aggregate();
+			lck.lock();
+		}
+	}
+
+	/** The ring buffer of the calling thread (created the first time) */
+	const std::shared_ptr<ProfilerBuffer>& threadBuffer()
+	{
+		struct CacheEntry
+		{
+			uint64_t uid;
+			std::weak_ptr<ProfilerImpl> owner;
+			std::shared_ptr<ProfilerBuffer> buffer;
+		};
+		// Upon thread exit, flag the buffers of this thread so the aggregator
+		// releases them once drained:
+		struct Cache : public std::vector<CacheEntry>
+		{
+			~Cache()
+			{
+				for (auto& e : *this)
+					e.buffer->ownerExited.store(
+						true, std::memory_order_release);
+			}
+		};
+		thread_local uint64_t lastUid = 0;
+		thread_local std::shared_ptr<ProfilerBuffer> lastBuffer;
+		thread_local Cache cache;
+
+		if (lastUid == uid) return lastBuffer;
+
+		auto it = std::find_if(cache.begin(), cache.end(), [this](auto& e) {
+			return e.uid == uid;
+		});
+		if (it == cache.end())
+		{
+			// Forget buffers of destroyed profilers:
+			cache.erase(
+				std::remove_if(
+					cache.begin(), cache.end(),
+					[](const auto& e) { return e.owner.expired(); }),
+				cache.end());
+
+			std::lock_guard<std::mutex> lck(mtx);
+			threadNames.push_back(mrpt::system::thread_name());
+			auto b = std::make_shared<ProfilerBuffer>(
+				opts.ringBufferSize, static_cast<uint32_t>(threadNames.size()));
+			buffers.push_back(b);
+			it = cache.insert(cache.end(), {uid, weak_from_this(), b});
+		}
+		lastUid = uid;
+		lastBuffer = it->buffer;
+		return lastBuffer;
+	}
+
+	uint32_t childNode(uint32_t parent, uint32_t section)
+	{
+		for (const uint32_t c : nodes[parent].children)
+			if (nodes[c].section == section) return c;
+		const auto idx = static_cast<uint32_t>(nodes.size());
+		nodes.emplace_back();
+		nodes.back().section = section;
+		nodes.back().parent = parent;
+		nodes[parent].children.push_back(idx);
+		return idx;
+	}
+
+	void aggregate()
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		for (auto& b : buffers)
+		{
+			// Read before head, so no event can follow an observed exit:
+			const bool exited = b->ownerExited.load(std::memory_order_acquire);
+			const uint64_t h = b->head.load(std::memory_order_acquire);
+			for (uint64_t i = b->tail.load(std::memory_order_relaxed); i != h;
+				 ++i)
+			{
+				const auto& e = b->events[i & b->mask];
+				if (e.kind == ProfilerBuffer::EV_ENTER)
+				{
+					const uint32_t parent =
+						b->aggStack.empty() ? 0 : b->aggStack.back().first;
+					b->aggStack.emplace_back(childNode(parent, e.id), e.t);
+					continue;
+				}
+				if (b->aggStack.empty()) continue;	// Should not happen
+				const auto [node, tEnter] = b->aggStack.back();
+				b->aggStack.pop_back();
+				const uint64_t dt = e.t - tEnter;
+
+				nodes[node].stats.add(dt);
+				if (flat.size() <= e.id) flat.resize(e.id + 1);
+				flat[e.id].add(dt);
+
+				if (opts.maxTraceEvents)
+				{
+					if (trace.size() >= opts.maxTraceEvents) trace.pop_front();
+					trace.push_back({e.id, b->threadIndex, tEnter, dt});
+				}
+			}
+			b->tail.store(h, std::memory_order_release);
+
+			// Fully drained and no more events to come: release its memory.
+			// Scopes still open at thread exit are lost.
+			if (exited)
+			{
+				retiredDropped += b->dropped.load(std::memory_order_relaxed);
+				b.reset();
+			}
+		}
+		buffers.erase(
+			std::remove(buffers.begin(), buffers.end(), nullptr),
+			buffers.end());
+	}
+
+	void clearStats()
+	{
+		aggregate();
+		std::lock_guard<std::mutex> lck(mtx);
+		for (auto& n : nodes)
+			n.stats = Stats();
+		flat.clear();
+		trace.clear();
+		for (auto& b : buffers)
+			b->dropped = 0;
+		retiredDropped = 0;
+	}
+};
+
+CTimeLogger::TSectionId CTimeLogger::internSection(const std::string_view& name)
+{
+	const std::string* stored;
+	return {SectionRegistry::Instance().intern(name, stored)};
+}
+
+std::string_view CTimeLogger::sectionName(const TSectionId& id)
+{
+	// Per-thread copy of the (append-only) table of names, so the registry
+	// mutex is only locked for IDs not seen before by this thread:
+	thread_local std::vector<const std::string*> tlNames;
+	if (id.id < tlNames.size()) return *tlNames[id.id];
+
+	auto& r = SectionRegistry::Instance();
+	std::lock_guard<std::mutex> lck(r.mtx);
+	ASSERT_LT_(id.id, r.names.size());
+	for (size_t i = tlNames.size(); i < r.names.size(); i++)
+		tlNames.push_back(&r.names[i]);
+	return *tlNames[id.id];
+}
+
+void CTimeLogger::enableProfilerMode(bool enable, const TProfilerOptions& opts)
+{
+	if (enable)
+	{
+		if (!m_profiler) m_profiler = std::make_shared<ProfilerImpl>(opts);
+		return;
+	}
+	if (!m_profiler) return;
+
+	// Keep the stats as regular sections:
+	std::map<std::string, TCallData> stats;
+	collectStats(stats);
+	m_profiler.reset();
+	for (auto& s : stats)
+	{
+		TCallData* d = m_data.find_or_alloc(s.first);
+		auto lck = mrpt::lockHelper(d->mtx);
+		*d = s.second;
+	}
+}
+
+void CTimeLogger::profilerFlush() const
+{
+	if (m_profiler) m_profiler->aggregate();
+}
+
+bool CTimeLogger::hasProfilerData() const
+{
+	if (!m_profiler) return false;
+	m_profiler->aggregate();
+	std::lock_guard<std::mutex> lck(m_profiler->mtx);
+	for (const auto& s : m_profiler->flat)
+		if (s.n_calls) return true;
+	return false;
+}
+
+size_t CTimeLogger::getProfilerDroppedEvents() const
+{
+	if (!m_profiler) return 0;
+	std::lock_guard<std::mutex> lck(m_profiler->mtx);
+	size_t n = m_profiler->retiredDropped;
+	for (const auto& b : m_profiler->buffers)
+		n += b->dropped.load(std::memory_order_relaxed);
+	return n;
+}
+
+void CTimeLogger::collectStats(std::map<std::string, TCallData>& out) const
+{
+	out.clear();
+	m_data.for_each([&](const std::string& name, const TCallData& d) {
+		auto lck = mrpt::lockHelper(d.mtx);
+		out[name] = d;
+	});
+	if (!m_profiler) return;
+
+	m_profiler->aggregate();
+	const auto names = SectionRegistry::Instance().snapshot();
+	std::lock_guard<std::mutex> lck(m_profiler->mtx);
+	const auto& flat = m_profiler->flat;
+	for (size_t id = 0; id < flat.size(); id++)
+	{
+		const auto& s = flat[id];
+		if (!s.n_calls) continue;
+		// Merge with legacy stats of the same section, if any:
+		TCallData& d = out[std::string(names[id])];
+		const double min_t = s.min * 1e-9, max_t = s.max * 1e-9;
+		if (d.n_calls == 0)
+		{
+			d.min_t = min_t;
+			d.max_t = max_t;
+		}
+		else
+		{
+			mrpt::keep_min(d.min_t, min_t);
+			mrpt::keep_max(d.max_t, max_t);
+		}
+		d.n_calls += s.n_calls;
+		d.mean_t += s.total * 1e-9;
+		d.last_t = s.last * 1e-9;
+		d.has_time_units = true;
+	}
+}
+
+std::string CTimeLogger::getCallTreeAsText(const size_t column_width) const
+{
+	using namespace std::string_literals;
+
+	if (!m_profiler) return {};
+	m_profiler->aggregate();
+	const auto names = SectionRegistry::Instance().snapshot();
+
+	std::string top_header = (m_name.empty() ? " "s : " "s + m_name + ": "s) +
+		"MRPT CTimeLogger call tree "s;
+	if (top_header.size() < column_width)
+	{
+		const size_t n = column_width - top_header.size();
+		top_header = std::string(n / 2, '-') + top_header +
+			std::string(n - n / 2, '-');
+	}
+
+	std::string s = top_header + "\n"s;
+	s += mrpt::format(
+		"%s %7s %7s %7s %7s\n",
+		aux_format_string_multilines("           SECTION", 39).c_str(),
+		"#CALLS", "MEAN.T", "TOTAL.T", "%PARENT");
+	s += std::string(column_width, '-') + "\n"s;
+
+	std::lock_guard<std::mutex> lck(m_profiler->mtx);
+	const auto& nodes = m_profiler->nodes;
+
+	// Depth-first, children sorted by decreasing total time:
+	std::function<void(uint32_t, const std::string&)> printChildren;
+	printChildren = [&](uint32_t parent, const std::string& prefix) {
+		std::vector<uint32_t> children = nodes[parent].children;
+		std::sort(
+			children.begin(), children.end(), [&](uint32_t a, uint32_t b) {
+				return nodes[a].stats.total > nodes[b].stats.total;
+			});
+		const double parentTotal = nodes[parent].stats.total;
+		for (size_t k = 0; k < children.size(); k++)
+		{
+			const auto& n = nodes[children[k]];
+			if (!n.stats.n_calls) continue;
+			const bool last = (k + 1 == children.size());
+			const std::string label = (parent == 0 ? ""s : prefix + "+-> "s) +
+				std::string(names[n.section]);
+			const double total = n.stats.total * 1e-9;
+
+			s += mrpt::format(
+				"%s %7u %6ss %6ss %7s\n",
+				aux_format_string_multilines(label, 39).c_str(),
+				static_cast<unsigned int>(n.stats.n_calls),
+				unitsFormat(total / n.stats.n_calls, 1, false).c_str(),
+				unitsFormat(total, 1, false).c_str(),
+				parent == 0 ? ""
+							: mrpt::format(
+								  "%5.1f%%", 100.0 * n.stats.total / parentTotal)
+								  .c_str());
+
+			printChildren(
+				children[k],
+				parent == 0 ? ""s : prefix + (last ? "    "s : "|   "s));
+		}
+	};
+	printChildren(0, ""s);
+
+	s += top_header + "\n"s;
+	return s;
+}
+
+void CTimeLogger::saveToChromeTrace(const std::string& json_file) const
+{
+	ASSERTMSG_(m_profiler, "Profiler mode is not enabled");
+
+	m_profiler->aggregate();
+	const auto names = SectionRegistry::Instance().snapshot();
+
+	std::ofstream f(json_file);
+	if (!f.is_open())
+		THROW_EXCEPTION_FMT("Error creating file: `%s`", json_file.c_str());
+
+	std::lock_guard<std::mutex> lck(m_profiler->mtx);
+	const std::string cat = jsonEscape(m_name.empty() ? "CTimeLogger" : m_name);
+
+	f << "{\"traceEvents\":[\n";
+	bool first = true;
+	for (size_t i = 0; i < m_profiler->threadNames.size(); i++)
+	{
+		const auto& name = m_profiler->threadNames[i];
+		const auto idx = static_cast<unsigned>(i + 1);
+		f << (first ? "" : ",\n")
+		  << mrpt::format(
+				 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+				 "\"args\":{\"name\":\"%s\"}}",
+				 idx,
+				 jsonEscape(
+					 name.empty() ? mrpt::format("thread #%u", idx) : name)
+					 .c_str());
+		first = false;
+	}
+	const uint64_t t0 = m_profiler->t0;
+	for (const auto& e : m_profiler->trace)
+	{
+		// Timestamps in microseconds:
+		f << (first ? "" : ",\n")
+		  << mrpt::format(
+				 "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,"
+				 "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				 jsonEscape(names[e.section]).c_str(), cat.c_str(), e.thread,
+				 (e.start - t0) * 1e-3, e.duration * 1e-3);
+		first = false;
+	}
+	f << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
 CTimeLogger::CTimeLogger(
 	bool enabled, const std::string& name, const bool keep_whole_history)
 	: m_enabled(enabled), m_keep_whole_history(keep_whole_history)
@@ -82,21 +733,42 @@ void CTimeLogger::setName(const std::string& name) noexcept
 CTimeLogger::~CTimeLogger()
 {
 	// Dump all stats:
-	if (!m_data.empty())  // If logging is disabled, do nothing...
+	if (!m_data.empty() || hasProfilerData())  // If logging is disabled, do
+											   // nothing...
 		dumpAllStats();
 }
 
 void CTimeLogger::clear(bool deep_clear)
 {
-	if (deep_clear) m_data.clear();
+	if (m_profiler) m_profiler->clearStats();
+
+	if (deep_clear)
+	{
+		// Free all entries but those of open sections (entered but not left
+		// yet), which are reset in place so their pending leave() is timed:
+		std::vector<std::string> closed;
+		m_data.for_each([&](const std::string& name, TCallData& d) {
+			auto lck = mrpt::lockHelper(d.mtx);
+			if (d.open_calls.empty())
+			{
+				closed.push_back(name);
+				return;
+			}
+			auto open = std::move(d.open_calls);
+			d = TCallData();
+			d.n_calls = open.size();
+			d.open_calls = std::move(open);
+		});
+		for (const auto& name : closed)
+			m_data.erase(name);
+	}
 	else
 	{
-		for (auto& e : m_data)
-		{
-			e.second.mtx.lock();
-			e.second.mtx.unlock();
-			e.second = TCallData();
-		}
+		m_data.for_each([](const std::string&, TCallData& d) {
+			d.mtx.lock();
+			d.mtx.unlock();
+			d = TCallData();
+		});
 	}
 }
 
@@ -114,12 +786,13 @@ std::string aux_format_string_multilines(const std::string& s, const size_t len)
 
 void CTimeLogger::getStats(std::map<std::string, TCallStats>& out_stats) const
 {
+	std::map<std::string, TCallData> all;
+	collectStats(all);
+
 	out_stats.clear();
-	for (const auto& e : m_data)
+	for (const auto& e : all)
 	{
-		auto lck = mrpt::lockHelper(e.second.mtx);
-
-		TCallStats& cs = out_stats[std::string(e.first)];
+		TCallStats& cs = out_stats[e.first];
 		cs.min_t = e.second.min_t;
 		cs.max_t = e.second.max_t;
 		cs.total_t = e.second.mean_t;
@@ -162,10 +835,8 @@ std::string CTimeLogger::getStatsAsText(const size_t column_width) const
 	stats_text += bottom_header + "\n"s;
 
 	// for all the timed sections: sort by inserting into a std::map
-	using NameAndCallData = std::map<std::string_view, TCallData>;
-	NameAndCallData stat_strs;
-	for (const auto& i : m_data)
-		stat_strs[i.first] = i.second;
+	std::map<std::string, TCallData> stat_strs;
+	collectStats(stat_strs);
 
 	// format tree-like patterns like:
 	//  ----------
@@ -182,8 +853,6 @@ std::string CTimeLogger::getStatsAsText(const size_t column_width) const
 	std::string last_parent;
 	for (const auto& i : stat_strs)
 	{
-		auto lck = mrpt::lockHelper(i.second.mtx);
-
 		string line = string(i.first);	// make a copy
 
 		const auto dot_pos = line.find(".");
@@ -223,10 +892,10 @@ void CTimeLogger::saveToCSVFile(const std::string& csv_file) const
 	std::string s;
 	s += "FUNCTION, #CALLS, LAST.T, MIN.T, MEAN.T, MAX.T, TOTAL.T [, "
 		 "WHOLE_HISTORY]\n";
-	for (const auto& i : m_data)
+	std::map<std::string, TCallData> all;
+	collectStats(all);
+	for (const auto& i : all)
 	{
-		auto lck = mrpt::lockHelper(i.second.mtx);
-
 		s += format(
 			"\"%.*s\",%7u,%e,%e,%e,%e,%e", static_cast<int>(i.first.size()),
 			i.first.data(), static_cast<unsigned int>(i.second.n_calls),
@@ -265,10 +934,10 @@ void CTimeLogger::saveToMFile(const std::string& file) const
 	std::string s_maxs = "s.max=["s;
 	std::string s_means = "s.mean=["s;
 
-	for (const auto& i : m_data)
+	std::map<std::string, TCallData> all;
+	collectStats(all);
+	for (const auto& i : all)
 	{
-		auto lck = mrpt::lockHelper(i.second.mtx);
-
 		s_names += "'"s + i.first + "',"s;
 		s_counts += std::to_string(i.second.n_calls) + ","s;
 		s_mins += mrpt::format("%e,", i.second.min_t);
@@ -314,14 +983,13 @@ void CTimeLogger::dumpAllStats(const size_t column_width) const
 
 void CTimeLogger::do_enter(const std::string_view& func_name) noexcept
 {
-	TCallData* d_ptr = m_data.find_or_alloc(std::string(func_name));
-	if (!d_ptr)
+	if (m_profiler)
 	{
-		std::cerr << "[CTimeLogger::do_enter] Warning: skipping due to hash "
-					 "collision.\n";
+		m_profiler->threadBuffer()->enter(internSectionCached(func_name));
 		return;
 	}
-	auto& d = *d_ptr;
+
+	auto& d = *m_data.find_or_alloc(func_name);
 	auto lck = mrpt::lockHelper(d.mtx);
 	d.n_calls++;
 	d.open_calls.push(0);  // Dummy value, it'll be written below
@@ -330,16 +998,13 @@ void CTimeLogger::do_enter(const std::string_view& func_name) noexcept
 
 double CTimeLogger::do_leave(const std::string_view& func_name) noexcept
 {
+	if (m_profiler)
+		return m_profiler->threadBuffer()->leave(
+			internSectionCached(func_name));
+
 	const double tim = m_tictac.Tac();
 
-	TCallData* d_ptr = m_data.find_or_alloc(std::string(func_name));
-	if (!d_ptr)
-	{
-		std::cerr << "[CTimeLogger::do_enter] Warning: skipping due to hash "
-					 "collision.\n";
-		return .0;
-	}
-	auto& d = *d_ptr;
+	auto& d = *m_data.find_or_alloc(func_name);
 	auto lck = mrpt::lockHelper(d.mtx);
 
 	if (!d.open_calls.empty())
@@ -373,19 +1038,26 @@ double CTimeLogger::do_leave(const std::string_view& func_name) noexcept
 		return 0;  // This shouldn't happen!
 }
 
+void CTimeLogger::do_enter(const TSectionId& section) noexcept
+{
+	if (m_profiler) m_profiler->threadBuffer()->enter(section.id);
+	else
+		do_enter(sectionName(section));
+}
+
+double CTimeLogger::do_leave(const TSectionId& section) noexcept
+{
+	if (m_profiler) return m_profiler->threadBuffer()->leave(section.id);
+	else
+		return do_leave(sectionName(section));
+}
+
 void CTimeLogger::registerUserMeasure(
 	const std::string_view& event_name, const double value,
 	const bool is_time) noexcept
 {
 	if (!m_enabled) return;
-	TCallData* d_ptr = m_data.find_or_alloc(std::string(event_name));
-	if (!d_ptr)
-	{
-		std::cerr << "[CTimeLogger::do_enter] Warning: skipping due to hash "
-					 "collision.\n";
-		return;
-	}
-	auto& d = *d_ptr;
+	auto& d = *m_data.find_or_alloc(event_name);
 	auto lck = mrpt::lockHelper(d.mtx);
 
 	d.has_time_units = is_time;
@@ -413,40 +1085,97 @@ void CTimeLogger::registerUserMeasure(
 
 double CTimeLogger::getMeanTime(const std::string& name) const
 {
-	TDataMap::const_iterator it = m_data.find(name);
-	if (it == m_data.end()) return 0;
+	if (m_profiler)
+	{
+		if (const auto id = SectionRegistry::Instance().find(name); id)
+		{
+			m_profiler->aggregate();
+			std::lock_guard<std::mutex> lck(m_profiler->mtx);
+			const auto& flat = m_profiler->flat;
+			if (*id < flat.size() && flat[*id].n_calls)
+				return flat[*id].total * 1e-9 / flat[*id].n_calls;
+		}
+	}
+
+	const TCallData* d = m_data.find_ptr(name);
+	if (!d) return 0;
 	else
 	{
-		auto lck = mrpt::lockHelper(it->second.mtx);
+		auto lck = mrpt::lockHelper(d->mtx);
 
-		return it->second.n_calls ? it->second.mean_t / it->second.n_calls : 0;
+		return d->n_calls ? d->mean_t / d->n_calls : 0;
 	}
 }
 double CTimeLogger::getLastTime(const std::string& name) const
 {
-	TDataMap::const_iterator it = m_data.find(name);
-	if (it == m_data.end()) return 0;
+	if (m_profiler)
+	{
+		if (const auto id = SectionRegistry::Instance().find(name); id)
+		{
+			m_profiler->aggregate();
+			std::lock_guard<std::mutex> lck(m_profiler->mtx);
+			const auto& flat = m_profiler->flat;
+			if (*id < flat.size() && flat[*id].n_calls)
+				return flat[*id].last * 1e-9;
+		}
+	}
+
+	const TCallData* d = m_data.find_ptr(name);
+	if (!d) return 0;
 	else
 	{
-		auto lck = mrpt::lockHelper(it->second.mtx);
-		return it->second.last_t;
+		auto lck = mrpt::lockHelper(d->mtx);
+		return d->last_t;
 	}
 }
 
 CTimeLoggerEntry::CTimeLoggerEntry(
 	const CTimeLogger& logger, const std::string_view& section_name)
-	: m_logger(const_cast<CTimeLogger&>(logger)), m_section_name(section_name)
+	: m_logger(const_cast<CTimeLogger&>(logger))
+{
+	if (logger.m_profiler)
+	{
+		stopped_ = !logger.m_enabled;
+		if (stopped_) return;
+		m_buffer = logger.m_profiler->threadBuffer();
+		m_section_id = internSectionCached(section_name);
+		m_buffer->enter(m_section_id);
+		return;
+	}
+	m_section_name = section_name;
+	m_entry = logger.m_tictac.Tac();
+}
+
+CTimeLoggerEntry::CTimeLoggerEntry(
+	const CTimeLogger& logger, const CTimeLogger::TSectionId& section)
+	: m_logger(const_cast<CTimeLogger&>(logger))
 {
+	if (logger.m_profiler)
+	{
+		stopped_ = !logger.m_enabled;
+		if (stopped_) return;
+		m_buffer = logger.m_profiler->threadBuffer();
+		m_section_id = section.id;
+		m_buffer->enter(m_section_id);
+		return;
+	}
+	m_section_name = CTimeLogger::sectionName(section);
 	m_entry = logger.m_tictac.Tac();
 }
+
 void CTimeLoggerEntry::stop()
 {
 	if (stopped_) return;
+	stopped_ = true;
+	if (m_buffer)
+	{
+		m_buffer->leave(m_section_id);
+		return;
+	}
 	const double leave = m_logger.m_tictac.Tac();
 	const double dt = leave - m_entry;
 
 	m_logger.registerUserMeasure(m_section_name, dt, true);
-	stopped_ = true;
 }
 
 CTimeLoggerEntry::~CTimeLoggerEntry()
@@ -9,8 +9,12 @@
 
 #include <gtest/gtest.h>
 #include <mrpt/system/CTimeLogger.h>
+#include <mrpt/core/format.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/system/thread_name.h>
 
 #include <chrono>
+#include <fstream>
 #include <mutex>
 #include <thread>
 
@@ -49,6 +53,30 @@ TEST(CTimeLogger, getLastTime)
 	tl.clear(true);	 // to silent console output upon dtor
 }
 
+TEST(CTimeLogger, deepClearWithOpenSection)
+{
+	mrpt::system::CTimeLogger tl;
+	doTimLogEntry(tl, "foo", 1);
+	doTimLogEntry(tl, "bar", 1);
+	tl.enter("bar");
+	EXPECT_NO_THROW(tl.clear(true));
+	EXPECT_EQ(tl.getLastTime("foo"), 0);
+	EXPECT_EQ(tl.getLastTime("bar"), 0);
+
+	// The open section was reset, but its leave() still counts:
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	EXPECT_GT(tl.leave("bar"), 0);
+	std::map<std::string, mrpt::system::CTimeLogger::TCallStats> stats;
+	tl.getStats(stats);
+	EXPECT_EQ(stats.count("foo"), 0U);
+	EXPECT_EQ(stats["bar"].n_calls, 1U);
+	EXPECT_GT(stats["bar"].min_t, 0);
+
+	EXPECT_NO_THROW(tl.clear(true));
+	tl.getStats(stats);
+	EXPECT_TRUE(stats.empty());
+}
+
 TEST(CTimeLogger, getMeanTime)
 {
 	mrpt::system::CTimeLogger tl;
@@ -123,3 +151,229 @@ TEST(CTimeLogger, multithread)
 	tl.clear(true);	 // to silent console output upon dtor
 	EXPECT_EQ(std::count(s.begin(), s.end(), '\n'), 9U);
 }
+
+TEST(CTimeLogger, profilerModeCallTree)
+{
+	mrpt::system::CTimeLogger tl;
+	tl.enableProfilerMode();
+	EXPECT_TRUE(tl.isProfilerModeEnabled());
+
+	for (int i = 0; i < 10; i++)
+	{
+		MRPT_PROFILE_SCOPE(tl, "outer");
+		for (int j = 0; j < 3; j++)
+		{
+			mrpt::system::CTimeLoggerEntry tle(tl, "inner");
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+		doTimLogEntry(tl, "inner2", 1);
+	}
+	// The same section at the top level:
+	doTimLogEntry(tl, "inner", 1);
+
+	std::map<std::string, mrpt::system::CTimeLogger::TCallStats> stats;
+	tl.getStats(stats);
+	ASSERT_EQ(stats.size(), 3U);
+	EXPECT_EQ(stats["outer"].n_calls, 10U);
+	EXPECT_EQ(stats["inner"].n_calls, 31U);
+	EXPECT_EQ(stats["inner2"].n_calls, 10U);
+	EXPECT_GT(stats["inner"].min_t, 50e-6);
+	EXPECT_GT(stats["outer"].total_t, stats["inner2"].total_t);
+	EXPECT_GT(tl.getMeanTime("inner2"), 0.5e-3);
+	EXPECT_GT(tl.getLastTime("inner"), 0.5e-3);
+
+	// "inner" appears twice in the tree: under "outer" and as a root:
+	const std::string s = tl.getCallTreeAsText();
+	EXPECT_NE(s.find("+-> inner2"), std::string::npos) << s;
+	EXPECT_EQ(std::count(s.begin(), s.end(), '\n'), 8U) << s;
+	EXPECT_EQ(tl.getProfilerDroppedEvents(), 0U);
+
+	// Disabling the profiler mode keeps the stats:
+	tl.enableProfilerMode(false);
+	EXPECT_FALSE(tl.isProfilerModeEnabled());
+	EXPECT_GT(tl.getMeanTime("inner2"), 0.5e-3);
+
+	tl.clear(true);
+}
+
+TEST(CTimeLogger, profilerModeMultithread)
+{
+	mrpt::system::CTimeLogger tl;
+	mrpt::system::CTimeLogger::TProfilerOptions opts;
+	opts.aggregationPeriod = 1e-3;
+	tl.enableProfilerMode(true, opts);
+
+	const int nThreads = 8, nScopes = 20000;
+	std::vector<std::thread> ths;
+	for (int i = 0; i < nThreads; i++)
+		ths.emplace_back([&tl]() {
+			for (int k = 0; k < nScopes; k++)
+			{
+				MRPT_PROFILE_SCOPE(tl, "work");
+				MRPT_PROFILE_SCOPE(tl, "work.detail");
+			}
+		});
+	for (auto& t : ths)
+		t.join();
+
+	std::map<std::string, mrpt::system::CTimeLogger::TCallStats> stats;
+	tl.getStats(stats);
+	const size_t dropped = tl.getProfilerDroppedEvents();
+	EXPECT_EQ(
+		stats["work"].n_calls + stats["work.detail"].n_calls + dropped,
+		size_t(2 * nThreads * nScopes));
+	EXPECT_LE(stats["work.detail"].n_calls, stats["work"].n_calls);
+
+	tl.clear(true);
+	tl.getStats(stats);
+	EXPECT_TRUE(stats.empty());
+}
+
+TEST(CTimeLogger, profilerModeFullRingDropsWholeScopes)
+{
+	mrpt::system::CTimeLogger tl;
+	mrpt::system::CTimeLogger::TProfilerOptions opts;
+	opts.ringBufferSize = 16;
+	opts.aggregationPeriod = 0;	 // no background aggregation
+	tl.enableProfilerMode(true, opts);
+
+	tl.enter("a");
+	for (int i = 0; i < 100; i++)
+	{
+		tl.enter("b");
+		EXPECT_GE(tl.leave("b"), 0);
+	}
+	// Missing leave("c") is closed by leave("a"):
+	tl.enter("c");
+	EXPECT_GT(tl.leave("a"), 0);
+	EXPECT_EQ(tl.leave("a"), 0);
+
+	std::map<std::string, mrpt::system::CTimeLogger::TCallStats> stats;
+	tl.getStats(stats);
+	EXPECT_EQ(stats["a"].n_calls, 1U);
+	EXPECT_GT(tl.getProfilerDroppedEvents(), 0U);
+	EXPECT_EQ(
+		stats["b"].n_calls + stats["c"].n_calls + tl.getProfilerDroppedEvents(),
+		101U);
+
+	// Once aggregated, there is room again:
+	const size_t dropped = tl.getProfilerDroppedEvents();
+	doTimLogEntry(tl, "b", 0);
+	EXPECT_EQ(tl.getProfilerDroppedEvents(), dropped);
+
+	tl.clear(true);
+}
+
+TEST(CTimeLogger, profilerModeExitedThreads)
+{
+	mrpt::system::CTimeLogger tl;
+	mrpt::system::CTimeLogger::TProfilerOptions opts;
+	opts.ringBufferSize = 16;
+	opts.aggregationPeriod = 1e-3;
+	tl.enableProfilerMode(true, opts);
+
+	// Many short-lived threads: their ring buffers are released once
+	// aggregated, but their statistics, dropped events and names remain.
+	const int nThreads = 50, nScopes = 20;
+	for (int i = 0; i < nThreads; i++)
+	{
+		std::thread t([&tl, i]() {
+			mrpt::system::thread_name(mrpt::format("short%d", i));
+			for (int k = 0; k < nScopes; k++)
+				tl.enter("work");
+			for (int k = 0; k < nScopes; k++)
+				tl.leave("work");
+		});
+		t.join();
+	}
+
+	std::map<std::string, mrpt::system::CTimeLogger::TCallStats> stats;
+	tl.getStats(stats);
+	const size_t dropped = tl.getProfilerDroppedEvents();
+	EXPECT_GT(dropped, 0U);
+	EXPECT_EQ(stats["work"].n_calls + dropped, size_t(nThreads * nScopes));
+
+	const std::string fil = mrpt::system::getTempFileName();
+	tl.saveToChromeTrace(fil);
+	std::ifstream f(fil);
+	const std::string json(
+		(std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	f.close();
+	mrpt::system::deleteFile(fil);
+	EXPECT_NE(json.find("\"name\":\"short0\""), std::string::npos);
+	EXPECT_NE(json.find("\"name\":\"short49\""), std::string::npos);
+
+	tl.clear(true);
+	EXPECT_EQ(tl.getProfilerDroppedEvents(), 0U);
+}
+
+TEST(CTimeLogger, profilerModeChromeTrace)
+{
+	mrpt::system::CTimeLogger tl(true, "test");
+	EXPECT_THROW(tl.saveToChromeTrace("none.json"), std::exception);
+
+	tl.enableProfilerMode();
+	{
+		MRPT_PROFILE_SCOPE(tl, "quoted \"name\"");
+		doTimLogEntry(tl, "child", 1);
+	}
+
+	const std::string fil = mrpt::system::getTempFileName();
+	tl.saveToChromeTrace(fil);
+	tl.clear(true);
+
+	std::ifstream f(fil);
+	const std::string json(
+		(std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	f.close();
+	mrpt::system::deleteFile(fil);
+
+	EXPECT_EQ(json.find("{\"traceEvents\":["), 0U);
+	EXPECT_NE(json.find("\"ph\":\"M\""), std::string::npos);
+	EXPECT_NE(json.find("\"name\":\"quoted \\\"name\\\"\""), std::string::npos)
+		<< json;
+	EXPECT_NE(json.find("\"name\":\"child\",\"cat\":\"test\",\"ph\":\"X\""),
+			  std::string::npos)
+		<< json;
+}
+
+TEST(CTimeLogger, internSection)
+{
+	using mrpt::system::CTimeLogger;
+	const auto id1 = CTimeLogger::internSection("CTimeLogger.test1");
+	const auto id2 = CTimeLogger::internSection("CTimeLogger.test2");
+	EXPECT_NE(id1.id, id2.id);
+	EXPECT_EQ(CTimeLogger::internSection("CTimeLogger.test1").id, id1.id);
+	EXPECT_EQ(CTimeLogger::sectionName(id2), "CTimeLogger.test2");
+
+	// Interned IDs also work in the legacy mode:
+	CTimeLogger tl;
+	tl.enter(id1);
+	tl.leave(id1);
+	EXPECT_EQ(
+		tl.getStatsAsText().find("CTimeLogger.test1") != std::string::npos,
+		true);
+	tl.clear(true);
+}
+
+TEST(CTimeLogger, profilerModeDisabledWithOpenScope)
+{
+	mrpt::system::CTimeLogger tl;
+	tl.enableProfilerMode();
+	{
+		MRPT_PROFILE_SCOPE(tl, "outer");
+		mrpt::system::CTimeLoggerEntry tle(tl, "inner");
+		tl.enableProfilerMode(false);
+		// A new profiler, so this thread forgets its former ring buffer:
+		tl.enableProfilerMode();
+		{
+			MRPT_PROFILE_SCOPE(tl, "other");
+		}
+		// The open scopes must be closed safely, and are not recorded.
+	}
+	std::map<std::string, mrpt::system::CTimeLogger::TCallStats> stats;
+	tl.getStats(stats);
+	EXPECT_EQ(stats.size(), 1U);
+	EXPECT_EQ(stats.count("other"), 1U);
+	tl.clear(true);
+}
@@ -126,3 +126,53 @@ void mrpt::system::changeCurrentProcessPriority(TProcessPriority priority)
 	}
 #endif
 }
+
+bool mrpt::system::changeCurrentThreadRealTimePriority(int priority)
+{
+#ifdef MRPT_OS_WINDOWS
+	return 0 != SetThreadPriority(
+					GetCurrentThread(), priority >= 50
+											? THREAD_PRIORITY_TIME_CRITICAL
+											: THREAD_PRIORITY_HIGHEST);
+#else
+	struct sched_param param
+	{
+	};
+	const int min_prio = sched_get_priority_min(SCHED_FIFO),
+			  max_prio = sched_get_priority_max(SCHED_FIFO);
+	param.sched_priority = priority;
+	if (min_prio >= 0 && priority < min_prio) param.sched_priority = min_prio;
+	if (max_prio >= 0 && priority > max_prio) param.sched_priority = max_prio;
+
+	return 0 == pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+}
+
+bool mrpt::system::changeCurrentThreadAffinity(const std::vector<int>& cpus)
+{
+#if defined(MRPT_OS_WINDOWS)
+	DWORD_PTR mask = 0;
+	for (const int c : cpus)
+	{
+		if (c < 0 || c >= static_cast<int>(sizeof(DWORD_PTR) * 8))
+			return false;
+		mask |= DWORD_PTR(1) << c;
+	}
+	if (cpus.empty()) mask = ~DWORD_PTR(0);
+	return 0 != SetThreadAffinityMask(GetCurrentThread(), mask);
+#elif defined(MRPT_OS_LINUX)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (const int c : cpus)
+	{
+		if (c < 0 || c >= CPU_SETSIZE) return false;
+		CPU_SET(c, &set);
+	}
+	if (cpus.empty())
+		for (int c = 0; c < CPU_SETSIZE; c++)
+			CPU_SET(c, &set);
+	return 0 == pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	return cpus.empty();
+#endif
+}